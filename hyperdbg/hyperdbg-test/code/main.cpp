@@ -58,6 +58,113 @@ main(int argc, char * argv[])
             printf("\n[x] The script semantic test cases failed\n");
         }
     }
+    else if (!strcmp(argv[1], TEST_CASE_PARAMETER_FOR_COMPRESSION))
+    {
+        //
+        // # Test case 3
+        // Testing the compression of messages (round-trip and throughput)
+        //
+        if (TestCompression())
+        {
+            printf("\n[*] The compression test cases passed successfully\n");
+        }
+        else
+        {
+            printf("\n[x] The compression test cases failed\n");
+        }
+    }
+    else if (!strcmp(argv[1], TEST_CASE_PARAMETER_FOR_FRAMING))
+    {
+        //
+        // # Test case 4
+        // Testing the framing of the remote packets (loopback and throughput)
+        //
+        if (TestFraming())
+        {
+            printf("\n[*] The framing test cases passed successfully\n");
+        }
+        else
+        {
+            printf("\n[x] The framing test cases failed\n");
+        }
+    }
+    else if (!strcmp(argv[1], TEST_CASE_PARAMETER_FOR_PIPELINE))
+    {
+        //
+        // # Test case 5
+        // Testing the pipelined requests (simulated latency and speedup)
+        //
+        if (TestPipeline())
+        {
+            printf("\n[*] The pipeline test cases passed successfully\n");
+        }
+        else
+        {
+            printf("\n[x] The pipeline test cases failed\n");
+        }
+    }
+    else if (!strcmp(argv[1], TEST_CASE_PARAMETER_FOR_SEARCH))
+    {
+        //
+        // # Test case 6
+        // Testing the search of memory blocks (correctness and throughput)
+        //
+        if (TestSearch())
+        {
+            printf("\n[*] The search test cases passed successfully\n");
+        }
+        else
+        {
+            printf("\n[x] The search test cases failed\n");
+        }
+    }
+    else if (!strcmp(argv[1], TEST_CASE_PARAMETER_FOR_TRANSPORT))
+    {
+        //
+        // # Test case 7
+        // Testing the transports of the kernel debugger (simulated debuggee
+        // over a loopback socket, fuzzing and throughput)
+        //
+        if (TestTransport())
+        {
+            printf("\n[*] The transport test cases passed successfully\n");
+        }
+        else
+        {
+            printf("\n[x] The transport test cases failed\n");
+        }
+    }
+    else if (!strcmp(argv[1], TEST_CASE_PARAMETER_FOR_RING))
+    {
+        //
+        // # Test case 8
+        // Testing the rings of the logs (wrap markers, full rings, fairness
+        // and concurrent producers)
+        //
+        if (TestRing())
+        {
+            printf("\n[*] The ring test cases passed successfully\n");
+        }
+        else
+        {
+            printf("\n[x] The ring test cases failed\n");
+        }
+    }
+    else if (!strcmp(argv[1], TEST_CASE_PARAMETER_FOR_SCRIPT_ENGINE))
+    {
+        //
+        // # Test case 9
+        // Testing the (local) evaluation of scripts
+        //
+        if (TestScriptEngine())
+        {
+            printf("\n[*] The script engine test cases passed successfully\n");
+        }
+        else
+        {
+            printf("\n[x] The script engine test cases failed\n");
+        }
+    }
     else if (!strcmp(argv[1], TEST_HWDBG_FUNCTIONALITIES))
     {
         //
@@ -0,0 +1,131 @@
+/**
+ * @file test-common.cpp
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief The shared routines of the tests
+ * @details The loopback is a connected pair of sockets (the socket
+ * transport), the framing reads and writes it through the routines of
+ * this file
+ * @version 0.14
+ * @date 2025-07-20
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief State of the pseudo-random generator
+ */
+static UINT64 TestCommonSeed;
+
+/**
+ * @brief Create a loopback
+ *
+ * @param First
+ * @param Second
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TestCommonCreateLoopback(TEST_COMMON_CHANNEL * First, TEST_COMMON_CHANNEL * Second)
+{
+    memset(First, 0, sizeof(TEST_COMMON_CHANNEL));
+    memset(Second, 0, sizeof(TEST_COMMON_CHANNEL));
+
+    return TransportCreateSocketPair(&First->Transport, &Second->Transport);
+}
+
+/**
+ * @brief Read routine of the framing
+ *
+ * @param Context The channel
+ * @param Buffer
+ * @param Length
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TestCommonRead(PVOID Context, VOID * Buffer, UINT32 Length)
+{
+    return TransportReceiveAll(&((TEST_COMMON_CHANNEL *)Context)->Transport, Buffer, Length);
+}
+
+/**
+ * @brief Write routine of the framing
+ * @details If it's requested, the last byte is changed (as if it's
+ * corrupted on the line)
+ *
+ * @param Context The channel
+ * @param Buffer
+ * @param Length
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TestCommonWrite(PVOID Context, const VOID * Buffer, UINT32 Length)
+{
+    TEST_COMMON_CHANNEL * Channel = (TEST_COMMON_CHANNEL *)Context;
+    UINT8                 LastByte;
+
+    if (Channel->SendLock != NULL && *Channel->SendLock == FALSE)
+    {
+        Channel->NumberOfUnlockedWrites++;
+    }
+
+    if (Channel->CorruptNextWrite && Length != 0)
+    {
+        Channel->CorruptNextWrite = FALSE;
+        LastByte                  = ((const UINT8 *)Buffer)[Length - 1] ^ 0x80;
+
+        return TransportSend(&Channel->Transport, Buffer, Length - 1) &&
+               TransportSend(&Channel->Transport, &LastByte, 1);
+    }
+
+    return TransportSend(&Channel->Transport, Buffer, Length);
+}
+
+/**
+ * @brief Generate the content of a page (or a packet)
+ * @details The content never contains the end of buffer characters,
+ * so the same content can be sent without framing
+ *
+ * @param Index Index of the page
+ * @param Buffer
+ * @param Length
+ *
+ * @return VOID
+ */
+VOID
+TestCommonFillPage(UINT32 Index, UINT8 * Buffer, UINT32 Length)
+{
+    for (UINT32 i = 0; i < Length; i++)
+    {
+        Buffer[i] = (UINT8)((Index * 31 + i) % 0x7f + 1);
+    }
+}
+
+/**
+ * @brief Set the state of the pseudo-random generator
+ *
+ * @param Seed
+ *
+ * @return VOID
+ */
+VOID
+TestCommonSetSeed(UINT64 Seed)
+{
+    TestCommonSeed = Seed;
+}
+
+/**
+ * @brief Generate a pseudo-random number
+ *
+ * @return UINT64
+ */
+UINT64
+TestCommonRandom()
+{
+    TestCommonSeed = TestCommonSeed * 6364136223846793005 + 1442695040888963407;
+
+    return TestCommonSeed >> 16;
+}
@@ -0,0 +1,291 @@
+/**
+ * @file test-compression.cpp
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Perform test on the compression of the messages of the debuggee
+ * @details
+ * @version 0.14
+ * @date 2025-06-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Number of synthetic messages in the test
+ */
+#define TEST_COMPRESSION_NUMBER_OF_MESSAGES 200000
+
+/**
+ * @brief Generate a synthetic log stream
+ * @details Most of the messages are the output of scripts (the same format
+ * strings with different numbers), some of them are random data (not
+ * compressible) and some of them are large repetitive messages
+ *
+ * @param Messages The generated messages
+ *
+ * @return VOID
+ */
+VOID
+TestCompressionGenerateMessages(std::vector<std::string> & Messages)
+{
+    CHAR         Buffer[PacketChunkSize] = {0};
+    int          Length;
+    const CHAR * ProcessNames[] = {"explorer.exe", "svchost.exe", "lsass.exe", "notepad.exe"};
+
+    //
+    // Use a constant seed, so the results are comparable
+    //
+    srand(0x48444247);
+
+    for (UINT32 i = 0; i < TEST_COMPRESSION_NUMBER_OF_MESSAGES; i++)
+    {
+        switch (rand() % 8)
+        {
+        case 0:
+        case 1:
+        case 2:
+            Length = sprintf_s(Buffer,
+                               sizeof(Buffer),
+                               "syscall number: %x, process: %s, rcx: %llx, rdx: %llx\n",
+                               rand() % 0x200,
+                               ProcessNames[rand() % 4],
+                               ((UINT64)rand() << 32) | rand(),
+                               (UINT64)rand());
+            break;
+
+        case 3:
+        case 4:
+            Length = sprintf_s(Buffer,
+                               sizeof(Buffer),
+                               "(%02d:%02d:%02d.%03d - core : %d - vmx-root? %s)\t epthook triggered at %llx\n",
+                               rand() % 24,
+                               rand() % 60,
+                               rand() % 60,
+                               rand() % 1000,
+                               rand() % 8,
+                               rand() % 2 ? "yes" : "no",
+                               0xfffff80000000000ull | ((UINT64)rand() << 12));
+            break;
+
+        case 5:
+            Length = sprintf_s(Buffer, sizeof(Buffer), "thread id: %x\n", rand());
+            break;
+
+        case 6:
+            //
+            // Random data (not compressible)
+            //
+            Length = rand() % (PacketChunkSize - 1) + 1;
+
+            for (int j = 0; j < Length; j++)
+            {
+                Buffer[j] = (CHAR)(rand() % 255 + 1);
+            }
+
+            break;
+
+        default:
+            //
+            // Large repetitive message (e.g., a memory dump)
+            //
+            Length = rand() % (PacketChunkSize - 1) + 1;
+
+            for (int j = 0; j < Length; j++)
+            {
+                Buffer[j] = "0123456789abcdef "[(j * 7 + (rand() % 4 == 0)) % 17];
+            }
+
+            break;
+        }
+
+        Messages.push_back(std::string(Buffer, Length));
+    }
+}
+
+/**
+ * @brief Test the round-trip of messages and measure the throughput
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TestCompression()
+{
+    std::vector<std::string> Messages;
+    std::vector<UINT8>       CompressedBlocks;
+    std::vector<size_t>      BlockOffsets;
+    std::vector<UINT32>      CompressedLengths;
+    COMPRESSION_STREAM *     Compressor   = NULL;
+    COMPRESSION_STREAM *     Decompressor = NULL;
+    COMPRESSION_STREAM *     TestStream   = NULL;
+    UINT8 *                  Block        = NULL;
+    UINT8                    Output[PacketChunkSize];
+    CHAR                     Message[PacketChunkSize];
+    UINT64                   RawLength = 0;
+    UINT32                   CompressedLength;
+    UINT32                   ResetIndex = 0;
+    BOOLEAN                  Result     = TRUE;
+    LARGE_INTEGER            Frequency;
+    LARGE_INTEGER            Start;
+    LARGE_INTEGER            CompressionEnd;
+    LARGE_INTEGER            DecompressionEnd;
+
+    Compressor   = (COMPRESSION_STREAM *)malloc(sizeof(COMPRESSION_STREAM));
+    Decompressor = (COMPRESSION_STREAM *)malloc(sizeof(COMPRESSION_STREAM));
+    TestStream   = (COMPRESSION_STREAM *)malloc(sizeof(COMPRESSION_STREAM));
+
+    if (Compressor == NULL || Decompressor == NULL || TestStream == NULL)
+    {
+        cout << "[-] Could not allocate the compression streams" << endl;
+        free(Compressor);
+        free(Decompressor);
+        free(TestStream);
+        return FALSE;
+    }
+
+    TestCompressionGenerateMessages(Messages);
+
+    for (UINT32 i = 0; i < TEST_COMPRESSION_NUMBER_OF_MESSAGES; i++)
+    {
+        RawLength += Messages[i].size();
+    }
+
+    //
+    // Blocks are never larger than the messages
+    //
+    CompressedBlocks.reserve((size_t)RawLength);
+    BlockOffsets.reserve(TEST_COMPRESSION_NUMBER_OF_MESSAGES);
+    CompressedLengths.reserve(TEST_COMPRESSION_NUMBER_OF_MESSAGES);
+
+    QueryPerformanceFrequency(&Frequency);
+
+    //
+    // Compress the messages in the same way as the debuggee (the stream is
+    // reset periodically and blocks that are not compressible are stored)
+    //
+    CompressionResetStream(Compressor);
+
+    QueryPerformanceCounter(&Start);
+
+    for (UINT32 i = 0; i < TEST_COMPRESSION_NUMBER_OF_MESSAGES; i++)
+    {
+        if (i % DEBUGGEE_COMPRESSION_RESET_INTERVAL == 0)
+        {
+            CompressionResetStream(Compressor);
+        }
+
+        CompressedLength = CompressionCompress(Compressor,
+                                               Messages[i].data(),
+                                               (UINT32)Messages[i].size(),
+                                               Output,
+                                               (UINT32)Messages[i].size() - 1);
+
+        BlockOffsets.push_back(CompressedBlocks.size());
+
+        if (CompressedLength == 0)
+        {
+            CompressedLength = (UINT32)Messages[i].size();
+            CompressedBlocks.insert(CompressedBlocks.end(), Messages[i].begin(), Messages[i].end());
+        }
+        else
+        {
+            CompressedBlocks.insert(CompressedBlocks.end(), Output, Output + CompressedLength);
+        }
+
+        CompressedLengths.push_back(CompressedLength);
+    }
+
+    QueryPerformanceCounter(&CompressionEnd);
+
+    //
+    // Decompress the messages and compare them with the original messages
+    //
+    for (UINT32 i = 0; i < TEST_COMPRESSION_NUMBER_OF_MESSAGES; i++)
+    {
+        if (i % DEBUGGEE_COMPRESSION_RESET_INTERVAL == 0)
+        {
+            CompressionResetStream(Decompressor);
+        }
+
+        Block = &CompressedBlocks[BlockOffsets[i]];
+
+        if (CompressedLengths[i] == Messages[i].size())
+        {
+            memcpy(Message, Block, CompressedLengths[i]);
+
+            Result = CompressionStoreBlock(Decompressor, Block, CompressedLengths[i]);
+        }
+        else
+        {
+            Result = CompressionDecompress(Decompressor,
+                                           Block,
+                                           CompressedLengths[i],
+                                           Message,
+                                           (UINT32)Messages[i].size());
+        }
+
+        if (!Result || memcmp(Message, Messages[i].data(), Messages[i].size()) != 0)
+        {
+            cout << "[-] Message " << i << " is not decompressed correctly" << endl;
+            Result = FALSE;
+            break;
+        }
+    }
+
+    QueryPerformanceCounter(&DecompressionEnd);
+
+    //
+    // Truncated blocks should be detected
+    //
+    for (UINT32 i = 0; Result && i < TEST_COMPRESSION_NUMBER_OF_MESSAGES; i++)
+    {
+        if (i % DEBUGGEE_COMPRESSION_RESET_INTERVAL == 0)
+        {
+            ResetIndex = i;
+        }
+
+        if (CompressedLengths[i] == Messages[i].size() || i - ResetIndex > 2)
+        {
+            continue;
+        }
+
+        //
+        // Rebuild the stream up to this message and decompress a truncated block
+        //
+        CompressionResetStream(TestStream);
+
+        for (UINT32 j = ResetIndex; j < i; j++)
+        {
+            CompressionStoreBlock(TestStream, Messages[j].data(), (UINT32)Messages[j].size());
+        }
+
+        if (CompressionDecompress(TestStream,
+                                  &CompressedBlocks[BlockOffsets[i]],
+                                  CompressedLengths[i] - 1,
+                                  Message,
+                                  (UINT32)Messages[i].size()))
+        {
+            cout << "[-] Truncated block of message " << i << " is not detected" << endl;
+            Result = FALSE;
+        }
+    }
+
+    if (Result)
+    {
+        printf("[*] %u messages, %llu bytes are compressed to %llu bytes (ratio: %.3f)\n",
+               TEST_COMPRESSION_NUMBER_OF_MESSAGES,
+               RawLength,
+               (UINT64)CompressedBlocks.size(),
+               (double)CompressedBlocks.size() / (double)RawLength);
+
+        printf("[*] compression: %.1f MB/s, decompression: %.1f MB/s\n",
+               (double)RawLength / 1000000.0 / ((double)(CompressionEnd.QuadPart - Start.QuadPart) / Frequency.QuadPart),
+               (double)RawLength / 1000000.0 / ((double)(DecompressionEnd.QuadPart - CompressionEnd.QuadPart) / Frequency.QuadPart));
+    }
+
+    free(Compressor);
+    free(Decompressor);
+    free(TestStream);
+
+    return Result;
+}
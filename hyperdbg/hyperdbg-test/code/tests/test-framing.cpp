@@ -0,0 +1,466 @@
+/**
+ * @file test-framing.cpp
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Perform test on the framing of the remote packets
+ * @details The frames are sent over a loopback (a connected pair of sockets)
+ * by another thread and NAKs are sent back over the same loopback
+ * @version 0.14
+ * @date 2025-06-24
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Number of packets in the test
+ */
+#define TEST_FRAMING_NUMBER_OF_PACKETS 20000
+
+/**
+ * @brief Maximum size of a packet in the test
+ */
+#define TEST_FRAMING_MAXIMUM_PACKET_SIZE 8192
+
+/**
+ * @brief Size of the receiving buffer
+ */
+#define TEST_FRAMING_BUFFER_SIZE (TEST_FRAMING_MAXIMUM_PACKET_SIZE * 2)
+
+/**
+ * @brief Each of these packets is preceded by some garbage bytes
+ */
+#define TEST_FRAMING_GARBAGE_INTERVAL 1000
+
+/**
+ * @brief This packet is corrupted once and should be retransmitted
+ */
+#define TEST_FRAMING_CORRUPTED_PACKET 12345
+
+/**
+ * @brief The garbage bytes (contains a part of the magic)
+ */
+static const CHAR TestFramingGarbage[] = "garbage HDFR";
+
+/**
+ * @brief Acquire the send lock of the test transport
+ *
+ * @param Lock
+ *
+ * @return VOID
+ */
+static void
+TestFramingAcquireSendLock(volatile LONG * Lock)
+{
+    while (InterlockedCompareExchange(Lock, TRUE, FALSE) != FALSE)
+    {
+        YieldProcessor();
+    }
+}
+
+/**
+ * @brief Release the send lock of the test transport
+ *
+ * @param Lock
+ *
+ * @return VOID
+ */
+static void
+TestFramingReleaseSendLock(volatile LONG * Lock)
+{
+    InterlockedExchange(Lock, FALSE);
+}
+
+/**
+ * @brief Length of a packet
+ *
+ * @param Index Index of the packet
+ *
+ * @return UINT32
+ */
+static UINT32
+TestFramingPacketLength(UINT32 Index)
+{
+    return (Index * 2654435761u) % TEST_FRAMING_MAXIMUM_PACKET_SIZE + 1;
+}
+
+/**
+ * @brief The thread that sends the framed packets
+ * @details One packet is corrupted on the way and the thread waits for the
+ * NAK and the acknowledgement of the receiver, then a large frame (that doesn't
+ * fit in the buffer of the receiver) is sent before the last packet. All of the
+ * writes (including the retransmission) should hold the send lock
+ *
+ * @param Parameter The channel of the sender
+ *
+ * @return DWORD
+ */
+static DWORD WINAPI
+TestFramingSenderThread(LPVOID Parameter)
+{
+    TEST_COMMON_CHANNEL * Channel = (TEST_COMMON_CHANNEL *)Parameter;
+    FRAMING_TRANSPORT     Transport;
+    UINT8 *               Buffer               = (UINT8 *)malloc(TEST_FRAMING_BUFFER_SIZE + 1);
+    UINT8 *               RetransmissionBuffer = (UINT8 *)malloc(TEST_FRAMING_BUFFER_SIZE + sizeof(FRAMING_HEADER));
+    const VOID *          Buffers[2];
+    UINT32                Lengths[2];
+    UINT32                Length;
+    volatile LONG         SendLock = FALSE;
+
+    if (Buffer == NULL || RetransmissionBuffer == NULL)
+    {
+        goto Exit;
+    }
+
+    //
+    // The large frame doesn't fit in the retransmission buffer, so it's sent without it
+    //
+    FramingInitialize(&Transport,
+                      Channel,
+                      TestCommonRead,
+                      TestCommonWrite,
+                      RetransmissionBuffer,
+                      TEST_FRAMING_BUFFER_SIZE + sizeof(FRAMING_HEADER));
+
+    FramingSetSendLock(&Transport, &SendLock, TestFramingAcquireSendLock, TestFramingReleaseSendLock);
+    Channel->SendLock = &SendLock;
+
+    for (UINT32 i = 0; i < TEST_FRAMING_NUMBER_OF_PACKETS; i++)
+    {
+        if (i % TEST_FRAMING_GARBAGE_INTERVAL == TEST_FRAMING_GARBAGE_INTERVAL - 1)
+        {
+            TestFramingAcquireSendLock(&SendLock);
+            TestCommonWrite(Channel, TestFramingGarbage, sizeof(TestFramingGarbage));
+            TestFramingReleaseSendLock(&SendLock);
+        }
+
+        Length = TestFramingPacketLength(i);
+        TestCommonFillPage(i, Buffer, Length);
+
+        //
+        // The index of the packet is sent in a separate buffer
+        //
+        Buffers[0] = &i;
+        Lengths[0] = sizeof(UINT32);
+        Buffers[1] = Buffer;
+        Lengths[1] = Length;
+
+        Channel->CorruptNextWrite = i == TEST_FRAMING_CORRUPTED_PACKET;
+
+        if (!FramingSendBuffers(&Transport, Buffers, Lengths, 2))
+        {
+            break;
+        }
+
+        if (i == TEST_FRAMING_CORRUPTED_PACKET)
+        {
+            //
+            // The NAK is handled (and the packet is sent again) while waiting
+            // for the acknowledgement
+            //
+            if (FramingReceive(&Transport, Buffer, TEST_FRAMING_BUFFER_SIZE, &Length) != FRAMING_STATUS_SUCCESS ||
+                Transport.NumberOfRetransmittedFrames != 1)
+            {
+                break;
+            }
+        }
+    }
+
+    //
+    // A frame that is larger than the buffer of the receiver
+    //
+    Buffers[0] = Buffer;
+    Lengths[0] = TEST_FRAMING_BUFFER_SIZE + 1;
+    FramingSendBuffers(&Transport, Buffers, Lengths, 1);
+
+    //
+    // The last packet
+    //
+    Length     = MAXUINT32;
+    Buffers[0] = &Length;
+    Lengths[0] = sizeof(UINT32);
+    FramingSendBuffers(&Transport, Buffers, Lengths, 1);
+
+Exit:
+    Channel->SendLock = NULL;
+
+    free(Buffer);
+    free(RetransmissionBuffer);
+    TransportClose(&Channel->Transport);
+
+    return 0;
+}
+
+/**
+ * @brief The thread that sends the packets without framing
+ * @details Each packet is followed by the end of buffer characters
+ *
+ * @param Parameter The channel of the sender
+ *
+ * @return DWORD
+ */
+static DWORD WINAPI
+TestFramingUnframedSenderThread(LPVOID Parameter)
+{
+    TEST_COMMON_CHANNEL * Channel = (TEST_COMMON_CHANNEL *)Parameter;
+    UINT8 *               Buffer  = (UINT8 *)malloc(TEST_FRAMING_MAXIMUM_PACKET_SIZE + SERIAL_END_OF_BUFFER_CHARS_COUNT);
+    UINT32                Length;
+
+    if (Buffer == NULL)
+    {
+        TransportClose(&Channel->Transport);
+        return 0;
+    }
+
+    for (UINT32 i = 0; i < TEST_FRAMING_NUMBER_OF_PACKETS; i++)
+    {
+        Length = TestFramingPacketLength(i);
+        TestCommonFillPage(i, Buffer, Length);
+
+        Buffer[Length]     = SERIAL_END_OF_BUFFER_CHAR_1;
+        Buffer[Length + 1] = SERIAL_END_OF_BUFFER_CHAR_2;
+        Buffer[Length + 2] = SERIAL_END_OF_BUFFER_CHAR_3;
+        Buffer[Length + 3] = SERIAL_END_OF_BUFFER_CHAR_4;
+
+        if (!TestCommonWrite(Channel, Buffer, Length + SERIAL_END_OF_BUFFER_CHARS_COUNT))
+        {
+            break;
+        }
+    }
+
+    free(Buffer);
+    TransportClose(&Channel->Transport);
+
+    return 0;
+}
+
+/**
+ * @brief Receive the packets without framing (one byte per read, the same
+ * as the receivers of the end of buffer characters)
+ *
+ * @param Channel The channel of the receiver
+ * @param Buffer The receiving buffer
+ * @param TotalLength Total length of the received packets
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestFramingReceiveUnframed(TEST_COMMON_CHANNEL * Channel, UINT8 * Buffer, UINT64 * TotalLength)
+{
+    UINT32 Loop;
+
+    for (UINT32 i = 0; i < TEST_FRAMING_NUMBER_OF_PACKETS; i++)
+    {
+        Loop = 0;
+
+        while (TRUE)
+        {
+            if (Loop >= TEST_FRAMING_BUFFER_SIZE || !TestCommonRead(Channel, &Buffer[Loop], 1))
+            {
+                return FALSE;
+            }
+
+            if (Loop >= 3 &&
+                Buffer[Loop] == SERIAL_END_OF_BUFFER_CHAR_4 &&
+                Buffer[Loop - 1] == SERIAL_END_OF_BUFFER_CHAR_3 &&
+                Buffer[Loop - 2] == SERIAL_END_OF_BUFFER_CHAR_2 &&
+                Buffer[Loop - 3] == SERIAL_END_OF_BUFFER_CHAR_1)
+            {
+                Loop -= 3;
+                break;
+            }
+
+            Loop++;
+        }
+
+        if (Loop != TestFramingPacketLength(i))
+        {
+            cout << "[-] Unframed packet " << i << " has an invalid length" << endl;
+            return FALSE;
+        }
+
+        *TotalLength += Loop;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Test the framing over a loopback and compare its throughput with
+ * the packets that are not framed
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TestFraming()
+{
+    FRAMING_TRANSPORT   Transport;
+    TEST_COMMON_CHANNEL Receiver     = {0};
+    TEST_COMMON_CHANNEL Sender       = {0};
+    HANDLE              SenderThread = NULL;
+    UINT8 *             Buffer       = NULL;
+    UINT8 *             Expected     = NULL;
+    UINT32              Length;
+    UINT32              Index;
+    UINT32              NumberOfPackets = 0;
+    UINT64              FramedLength    = 0;
+    UINT64              UnframedLength  = 0;
+    FRAMING_STATUS      Status;
+    BOOLEAN             Result             = TRUE;
+    BOOLEAN             LargeFrameSkipped  = FALSE;
+    BOOLEAN             CorruptionDetected = FALSE;
+    LARGE_INTEGER       Frequency;
+    LARGE_INTEGER       Start;
+    LARGE_INTEGER       FramedEnd;
+    LARGE_INTEGER       UnframedStart;
+    LARGE_INTEGER       UnframedEnd;
+
+    Buffer   = (UINT8 *)malloc(TEST_FRAMING_BUFFER_SIZE);
+    Expected = (UINT8 *)malloc(TEST_FRAMING_MAXIMUM_PACKET_SIZE);
+
+    //
+    // The packets and the NAKs are sent on a connected pair of sockets
+    //
+    if (Buffer == NULL || Expected == NULL || !TestCommonCreateLoopback(&Receiver, &Sender))
+    {
+        cout << "[-] Could not create the loopback" << endl;
+        free(Buffer);
+        free(Expected);
+        return FALSE;
+    }
+
+    QueryPerformanceFrequency(&Frequency);
+    QueryPerformanceCounter(&Start);
+
+    SenderThread = CreateThread(NULL, 0, TestFramingSenderThread, &Sender, 0, NULL);
+
+    FramingInitialize(&Transport, &Receiver, TestCommonRead, TestCommonWrite, NULL, 0);
+
+    while (TRUE)
+    {
+        Status = FramingReceive(&Transport, Buffer, TEST_FRAMING_BUFFER_SIZE, &Length);
+
+        if (Status == FRAMING_STATUS_BUFFER_TOO_SMALL)
+        {
+            LargeFrameSkipped = TRUE;
+            continue;
+        }
+
+        if (Status == FRAMING_STATUS_INVALID_CHECKSUM)
+        {
+            //
+            // A NAK is sent, so the next frame is the retransmitted one
+            //
+            CorruptionDetected = TRUE;
+            continue;
+        }
+
+        if (Status != FRAMING_STATUS_SUCCESS || Length < sizeof(UINT32))
+        {
+            cout << "[-] Could not receive the packet " << NumberOfPackets << endl;
+            Result = FALSE;
+            break;
+        }
+
+        memcpy(&Index, Buffer, sizeof(UINT32));
+
+        if (Index == MAXUINT32)
+        {
+            break;
+        }
+
+        //
+        // Packets should be received in order and without any change
+        //
+        TestCommonFillPage(Index, Expected, TestFramingPacketLength(Index));
+
+        if (Index != NumberOfPackets ||
+            Length != sizeof(UINT32) + TestFramingPacketLength(Index) ||
+            memcmp(Buffer + sizeof(UINT32), Expected, Length - sizeof(UINT32)) != 0)
+        {
+            cout << "[-] Packet " << NumberOfPackets << " is not received correctly" << endl;
+            Result = FALSE;
+            break;
+        }
+
+        NumberOfPackets++;
+        FramedLength += Length;
+
+        //
+        // The sender waits for an acknowledgement of the retransmitted packet
+        //
+        if (Index == TEST_FRAMING_CORRUPTED_PACKET && !FramingSendBuffers(&Transport, NULL, NULL, 0))
+        {
+            cout << "[-] Could not acknowledge the retransmitted packet" << endl;
+            Result = FALSE;
+            break;
+        }
+    }
+
+    QueryPerformanceCounter(&FramedEnd);
+
+    //
+    // Closing the side of the receiver unblocks the sender if the test is failed
+    //
+    TransportClose(&Receiver.Transport);
+    WaitForSingleObject(SenderThread, INFINITE);
+    CloseHandle(SenderThread);
+
+    if (Result &&
+        (NumberOfPackets != TEST_FRAMING_NUMBER_OF_PACKETS || !LargeFrameSkipped || !CorruptionDetected ||
+         Transport.NumberOfOutOfSequenceFrames != 0 ||
+         Transport.NumberOfDiscardedBytes != (TEST_FRAMING_NUMBER_OF_PACKETS / TEST_FRAMING_GARBAGE_INTERVAL) * sizeof(TestFramingGarbage)))
+    {
+        cout << "[-] Invalid frames are not detected correctly" << endl;
+        Result = FALSE;
+    }
+
+    if (Result && Sender.NumberOfUnlockedWrites != 0)
+    {
+        cout << "[-] Frames are written without holding the send lock" << endl;
+        Result = FALSE;
+    }
+
+    //
+    // Send the same packets without framing
+    //
+    if (Result)
+    {
+        if (!TestCommonCreateLoopback(&Receiver, &Sender))
+        {
+            cout << "[-] Could not create the loopback" << endl;
+            free(Buffer);
+            free(Expected);
+            return FALSE;
+        }
+
+        QueryPerformanceCounter(&UnframedStart);
+
+        SenderThread = CreateThread(NULL, 0, TestFramingUnframedSenderThread, &Sender, 0, NULL);
+
+        Result = TestFramingReceiveUnframed(&Receiver, Buffer, &UnframedLength);
+
+        QueryPerformanceCounter(&UnframedEnd);
+
+        TransportClose(&Receiver.Transport);
+        WaitForSingleObject(SenderThread, INFINITE);
+        CloseHandle(SenderThread);
+    }
+
+    if (Result)
+    {
+        printf("[*] %u packets, %llu bytes, %llu bytes are discarded to find the frames\n",
+               NumberOfPackets,
+               FramedLength,
+               Transport.NumberOfDiscardedBytes);
+
+        printf("[*] framed: %.1f MB/s, end of buffer characters: %.1f MB/s\n",
+               (double)FramedLength / 1000000.0 / ((double)(FramedEnd.QuadPart - Start.QuadPart) / Frequency.QuadPart),
+               (double)UnframedLength / 1000000.0 / ((double)(UnframedEnd.QuadPart - UnframedStart.QuadPart) / Frequency.QuadPart));
+    }
+
+    free(Buffer);
+    free(Expected);
+
+    return Result;
+}
@@ -0,0 +1,447 @@
+/**
+ * @file test-pipeline.cpp
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Perform test on the pipelined requests
+ * @details A simulated debuggee answers the read requests over a loopback
+ * of framed packets (a connected pair of sockets), each response is sent
+ * after a simulated latency from the time that its request is sent
+ * @version 0.14
+ * @date 2025-06-25
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Number of pages that are read in each run
+ */
+#define TEST_PIPELINE_NUMBER_OF_REQUESTS 256
+
+/**
+ * @brief Size of each page
+ */
+#define TEST_PIPELINE_PAGE_SIZE 4096
+
+/**
+ * @brief The simulated round-trip latency (in milliseconds)
+ */
+#define TEST_PIPELINE_LATENCY 2
+
+/**
+ * @brief The window size of the pipelined run
+ */
+#define TEST_PIPELINE_WINDOW_SIZE 8
+
+/**
+ * @brief The minimum speedup of the pipelined run
+ */
+#define TEST_PIPELINE_MINIMUM_SPEEDUP 2.0
+
+/**
+ * @brief A read request
+ *
+ */
+typedef struct _TEST_PIPELINE_REQUEST
+{
+    UINT32 RequestId;
+    UINT32 Index;
+    UINT64 SendTime; // In microseconds
+
+} TEST_PIPELINE_REQUEST, *PTEST_PIPELINE_REQUEST;
+
+/**
+ * @brief The header of a response (followed by the page)
+ *
+ */
+typedef struct _TEST_PIPELINE_RESPONSE
+{
+    UINT32 RequestId;
+    UINT32 Index;
+
+} TEST_PIPELINE_RESPONSE, *PTEST_PIPELINE_RESPONSE;
+
+/**
+ * @brief The state of the debugger side
+ *
+ */
+typedef struct _TEST_PIPELINE_DEBUGGER
+{
+    TEST_COMMON_CHANNEL     Channel;
+    FRAMING_TRANSPORT       Transport;
+    PIPELINE_WINDOW         Window;
+    std::mutex              ResponseLock;
+    std::condition_variable ResponseCondition; // Signaled once a response is received
+    BOOLEAN                 IsResponseReceived;
+    UINT8 *                 Pages;
+    UINT32                  NumberOfStaleResponses;
+
+} TEST_PIPELINE_DEBUGGER, *PTEST_PIPELINE_DEBUGGER;
+
+/**
+ * @brief Get the time (in microseconds)
+ *
+ * @return UINT64
+ */
+static UINT64
+TestPipelineGetTime()
+{
+    return (UINT64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief The thread of the simulated debuggee
+ * @details Requests are answered in order, as the debuggee does while
+ * it's halted, a frame that is not a request stops the debuggee
+ *
+ * @param Channel The channel of the debuggee
+ *
+ * @return VOID
+ */
+static VOID
+TestPipelineDebuggeeThread(TEST_COMMON_CHANNEL * Channel)
+{
+    FRAMING_TRANSPORT      Transport;
+    TEST_PIPELINE_REQUEST  Request;
+    TEST_PIPELINE_RESPONSE Response;
+    UINT8 *                Page = (UINT8 *)malloc(TEST_PIPELINE_PAGE_SIZE);
+    const VOID *           Buffers[2];
+    UINT32                 Lengths[2];
+    UINT32                 Length;
+
+    FramingInitialize(&Transport, Channel, TestCommonRead, TestCommonWrite, NULL, 0);
+
+    while (Page != NULL &&
+           FramingReceive(&Transport, &Request, sizeof(TEST_PIPELINE_REQUEST), &Length) == FRAMING_STATUS_SUCCESS &&
+           Length == sizeof(TEST_PIPELINE_REQUEST))
+    {
+        //
+        // Wait until the round-trip latency is passed from the time that
+        // the request is sent
+        //
+        while (TestPipelineGetTime() - Request.SendTime < TEST_PIPELINE_LATENCY * 1000)
+        {
+            std::this_thread::yield();
+        }
+
+        Response.RequestId = Request.RequestId;
+        Response.Index     = Request.Index;
+
+        TestCommonFillPage(Request.Index, Page, TEST_PIPELINE_PAGE_SIZE);
+
+        Buffers[0] = &Response;
+        Lengths[0] = sizeof(TEST_PIPELINE_RESPONSE);
+        Buffers[1] = Page;
+        Lengths[1] = TEST_PIPELINE_PAGE_SIZE;
+
+        if (!FramingSendBuffers(&Transport, Buffers, Lengths, 2))
+        {
+            break;
+        }
+    }
+
+    free(Page);
+
+    //
+    // Closing the channel stops the receiver of the debugger
+    //
+    TransportClose(&Channel->Transport);
+}
+
+/**
+ * @brief Wake up the sender of the requests
+ *
+ * @param Debugger The state of the debugger
+ *
+ * @return VOID
+ */
+static VOID
+TestPipelineSignalResponse(TEST_PIPELINE_DEBUGGER * Debugger)
+{
+    std::lock_guard<std::mutex> Lock(Debugger->ResponseLock);
+
+    Debugger->IsResponseReceived = TRUE;
+    Debugger->ResponseCondition.notify_one();
+}
+
+/**
+ * @brief The thread that receives the responses in the debugger
+ *
+ * @param Debugger The state of the debugger
+ *
+ * @return VOID
+ */
+static VOID
+TestPipelineReceiverThread(TEST_PIPELINE_DEBUGGER * Debugger)
+{
+    UINT8 *                  Buffer   = (UINT8 *)malloc(sizeof(TEST_PIPELINE_RESPONSE) + TEST_PIPELINE_PAGE_SIZE);
+    TEST_PIPELINE_RESPONSE * Response = (TEST_PIPELINE_RESPONSE *)Buffer;
+    UINT32                   Length;
+    UINT32                   Index;
+
+    while (Buffer != NULL &&
+           FramingReceive(&Debugger->Transport,
+                          Buffer,
+                          sizeof(TEST_PIPELINE_RESPONSE) + TEST_PIPELINE_PAGE_SIZE,
+                          &Length) == FRAMING_STATUS_SUCCESS)
+    {
+        if (Length != sizeof(TEST_PIPELINE_RESPONSE) + TEST_PIPELINE_PAGE_SIZE ||
+            !PipelineMatchResponse(&Debugger->Window, Response->RequestId, &Index))
+        {
+            Debugger->NumberOfStaleResponses++;
+
+            //
+            // Wake up the sender if a lost request is detected
+            //
+            if (Debugger->Window.IsLossDetected)
+            {
+                TestPipelineSignalResponse(Debugger);
+            }
+
+            continue;
+        }
+
+        memcpy(Debugger->Pages + (SIZE_T)Index * TEST_PIPELINE_PAGE_SIZE,
+               Buffer + sizeof(TEST_PIPELINE_RESPONSE),
+               TEST_PIPELINE_PAGE_SIZE);
+
+        PipelineCompleteResponse(&Debugger->Window);
+        TestPipelineSignalResponse(Debugger);
+    }
+
+    free(Buffer);
+}
+
+/**
+ * @brief Send routine of the window
+ *
+ * @param Context The state of the debugger
+ * @param Index
+ * @param RequestId
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestPipelineSend(PVOID Context, UINT32 Index, UINT32 RequestId)
+{
+    TEST_PIPELINE_DEBUGGER * Debugger = (TEST_PIPELINE_DEBUGGER *)Context;
+    TEST_PIPELINE_REQUEST    Request;
+    const VOID *             Buffers[1];
+    UINT32                   Lengths[1];
+
+    Request.RequestId = RequestId;
+    Request.Index     = Index;
+    Request.SendTime  = TestPipelineGetTime();
+
+    Buffers[0] = &Request;
+    Lengths[0] = sizeof(TEST_PIPELINE_REQUEST);
+
+    return FramingSendBuffers(&Debugger->Transport, Buffers, Lengths, 1);
+}
+
+/**
+ * @brief Wait routine of the window
+ *
+ * @param Context The state of the debugger
+ * @param Timeout
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestPipelineWait(PVOID Context, UINT32 Timeout)
+{
+    TEST_PIPELINE_DEBUGGER *     Debugger = (TEST_PIPELINE_DEBUGGER *)Context;
+    std::unique_lock<std::mutex> Lock(Debugger->ResponseLock);
+
+    Debugger->ResponseCondition.wait_for(Lock, std::chrono::milliseconds(Timeout), [Debugger] { return Debugger->IsResponseReceived != FALSE; });
+    Debugger->IsResponseReceived = FALSE;
+
+    return TRUE;
+}
+
+/**
+ * @brief Read all of the pages by the window and check them
+ * @details Shared by the tests of the pipelined requests
+ *
+ * @param Window
+ * @param WindowSize
+ * @param SendRoutine
+ * @param WaitRoutine
+ * @param Context Context of the routines
+ * @param Pages Buffer for the received pages
+ * @param NumberOfPages
+ * @param PageSize
+ * @param FillRoutine Generates the expected content of a page
+ * @param Milliseconds The time of the run
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TestPipelineReadPages(PIPELINE_WINDOW *          Window,
+                      UINT32                     WindowSize,
+                      PIPELINE_SEND_ROUTINE      SendRoutine,
+                      PIPELINE_WAIT_ROUTINE      WaitRoutine,
+                      PVOID                      Context,
+                      UINT8 *                    Pages,
+                      UINT32                     NumberOfPages,
+                      UINT32                     PageSize,
+                      TEST_PIPELINE_FILL_ROUTINE FillRoutine,
+                      double *                   Milliseconds)
+{
+    UINT8 * Expected = (UINT8 *)malloc(PageSize);
+    UINT64  Start;
+    BOOLEAN Result = FALSE;
+
+    if (Expected == NULL)
+    {
+        return FALSE;
+    }
+
+    memset(Pages, 0, (SIZE_T)NumberOfPages * PageSize);
+
+    Start = TestPipelineGetTime();
+
+    if (!PipelineRun(Window, NumberOfPages, WindowSize, SendRoutine, WaitRoutine, Context))
+    {
+        cout << "[-] Could not read the pages with the window size " << WindowSize << endl;
+        goto Exit;
+    }
+
+    *Milliseconds = (double)(TestPipelineGetTime() - Start) / 1000.0;
+
+    for (UINT32 i = 0; i < NumberOfPages; i++)
+    {
+        FillRoutine(i, Expected, PageSize);
+
+        if (memcmp(Pages + (SIZE_T)i * PageSize, Expected, PageSize) != 0)
+        {
+            cout << "[-] Page " << i << " is not received correctly with the window size " << WindowSize << endl;
+            goto Exit;
+        }
+    }
+
+    Result = TRUE;
+
+Exit:
+
+    free(Expected);
+
+    return Result;
+}
+
+/**
+ * @brief Read all of the pages from the simulated debuggee
+ *
+ * @param Debugger The state of the debugger
+ * @param WindowSize
+ * @param Milliseconds The time of the run
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestPipelineRun(TEST_PIPELINE_DEBUGGER * Debugger, UINT32 WindowSize, double * Milliseconds)
+{
+    return TestPipelineReadPages(&Debugger->Window,
+                                 WindowSize,
+                                 TestPipelineSend,
+                                 TestPipelineWait,
+                                 Debugger,
+                                 Debugger->Pages,
+                                 TEST_PIPELINE_NUMBER_OF_REQUESTS,
+                                 TEST_PIPELINE_PAGE_SIZE,
+                                 TestCommonFillPage,
+                                 Milliseconds);
+}
+
+/**
+ * @brief Test the pipelined requests over a loopback with a simulated
+ * latency and compare them with waiting for each response
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TestPipeline()
+{
+    TEST_PIPELINE_DEBUGGER * Debugger;
+    TEST_COMMON_CHANNEL      Debuggee;
+    std::thread              DebuggeeThread;
+    std::thread              ReceiverThread;
+    UINT32                   Index;
+    UINT8                    StopFrame       = 0;
+    const VOID *             StopBuffers[1]  = {&StopFrame};
+    UINT32                   StopLengths[1]  = {sizeof(StopFrame)};
+    double                   StopAndWaitTime = 0;
+    double                   PipelinedTime   = 0;
+    BOOLEAN                  Result          = FALSE;
+
+    Debugger = new TEST_PIPELINE_DEBUGGER();
+
+    Debugger->Pages = (UINT8 *)malloc((SIZE_T)TEST_PIPELINE_NUMBER_OF_REQUESTS * TEST_PIPELINE_PAGE_SIZE);
+
+    //
+    // The requests and the responses are sent on a connected pair of sockets
+    //
+    if (Debugger->Pages == NULL || !TestCommonCreateLoopback(&Debugger->Channel, &Debuggee))
+    {
+        cout << "[-] Could not create the loopback" << endl;
+        free(Debugger->Pages);
+        delete Debugger;
+        return FALSE;
+    }
+
+    FramingInitialize(&Debugger->Transport, &Debugger->Channel, TestCommonRead, TestCommonWrite, NULL, 0);
+    PipelineInitialize(&Debugger->Window);
+
+    DebuggeeThread = std::thread(TestPipelineDebuggeeThread, &Debuggee);
+    ReceiverThread = std::thread(TestPipelineReceiverThread, Debugger);
+
+    if (!TestPipelineRun(Debugger, 1, &StopAndWaitTime) ||
+        !TestPipelineRun(Debugger, TEST_PIPELINE_WINDOW_SIZE, &PipelinedTime))
+    {
+        goto Exit;
+    }
+
+    //
+    // Responses are not accepted once the run is finished
+    //
+    if (PipelineMatchResponse(&Debugger->Window, Debugger->Window.FirstRequestId, &Index) ||
+        Debugger->NumberOfStaleResponses != 0)
+    {
+        cout << "[-] Stale responses are not handled correctly" << endl;
+        goto Exit;
+    }
+
+    printf("[*] %u pages, %u ms of latency, window of 1: %.1f ms, window of %u: %.1f ms, speedup: %.1fx\n",
+           TEST_PIPELINE_NUMBER_OF_REQUESTS,
+           TEST_PIPELINE_LATENCY,
+           StopAndWaitTime,
+           TEST_PIPELINE_WINDOW_SIZE,
+           PipelinedTime,
+           StopAndWaitTime / PipelinedTime);
+
+    if (StopAndWaitTime / PipelinedTime < TEST_PIPELINE_MINIMUM_SPEEDUP)
+    {
+        cout << "[-] The pipelined requests are not faster than waiting for each response" << endl;
+        goto Exit;
+    }
+
+    Result = TRUE;
+
+Exit:
+
+    //
+    // The stop frame stops the debuggee, and then the receiver (the channel
+    // of the debugger is closed once no thread uses it)
+    //
+    FramingSendBuffers(&Debugger->Transport, StopBuffers, StopLengths, 1);
+
+    DebuggeeThread.join();
+    ReceiverThread.join();
+
+    TransportClose(&Debugger->Channel.Transport);
+
+    free(Debugger->Pages);
+    delete Debugger;
+
+    return Result;
+}
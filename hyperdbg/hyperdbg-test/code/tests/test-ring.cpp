@@ -0,0 +1,623 @@
+/**
+ * @file test-ring.cpp
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Perform stress test on the rings of the logs
+ * @details The producers and the consumer are user-mode threads, the test
+ * only uses the standard library so it can be also compiled on other
+ * platforms (together with the ring component)
+ * @version 0.14
+ * @date 2025-07-02
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Number of producers (rings) in the stress test
+ */
+#define TEST_RING_NUMBER_OF_PRODUCERS 4
+
+/**
+ * @brief Number of records that each producer writes in the stress test
+ */
+#define TEST_RING_RECORDS_PER_PRODUCER 200000
+
+/**
+ * @brief Size of each ring (small, so the records wrap frequently)
+ */
+#define TEST_RING_SIZE (16 * 1024)
+
+/**
+ * @brief Maximum length of the body of the records
+ */
+#define TEST_RING_MAXIMUM_RECORD_LENGTH 700
+
+/**
+ * @brief Number of operations of the single-threaded test
+ */
+#define TEST_RING_NUMBER_OF_OPERATIONS 1000000
+
+/**
+ * @brief A producer of the stress test
+ *
+ */
+typedef struct _TEST_RING_PRODUCER
+{
+    RING_BUFFER *        Ring;
+    UINT32               RingIndex;
+    BOOLEAN              IsFlooding; // Drops the records if the ring is full (as the logs do)
+    UINT64               Written;    // Only accessed by the producer until it's finished
+    UINT64               Dropped;    // Only accessed by the producer until it's finished
+    std::atomic<BOOLEAN> IsFinished;
+
+} TEST_RING_PRODUCER, *PTEST_RING_PRODUCER;
+
+/**
+ * @brief Get the length of a record from its sequence number, so the
+ * consumer can verify it
+ *
+ * @param RingIndex
+ * @param Sequence
+ *
+ * @return UINT32
+ */
+static UINT32
+TestRingGetLength(UINT32 RingIndex, UINT64 Sequence)
+{
+    UINT64 Value = (Sequence + 1) * 0x9e3779b97f4a7c15ull ^ RingIndex;
+
+    Value ^= Value >> 29;
+
+    return (UINT32)(Value % (TEST_RING_MAXIMUM_RECORD_LENGTH + 1));
+}
+
+/**
+ * @brief Fill the body of a record from its sequence number
+ *
+ * @param Buffer
+ * @param RingIndex
+ * @param Sequence
+ * @param Length
+ *
+ * @return VOID
+ */
+static VOID
+TestRingFillBody(UINT8 * Buffer, UINT32 RingIndex, UINT64 Sequence, UINT32 Length)
+{
+    for (UINT32 i = 0; i < Length; i++)
+    {
+        Buffer[i] = (UINT8)(Sequence * 31 + RingIndex * 7 + i);
+    }
+}
+
+/**
+ * @brief Write a record with a sequence number
+ *
+ * @param Ring
+ * @param RingIndex
+ * @param Sequence
+ *
+ * @return BOOLEAN FALSE if the ring is full
+ */
+static BOOLEAN
+TestRingWrite(RING_BUFFER * Ring, UINT32 RingIndex, UINT64 Sequence)
+{
+    RING_RECORD_HEADER Header = {0};
+    UINT8              Body[TEST_RING_MAXIMUM_RECORD_LENGTH];
+
+    Header.TimeStamp    = Sequence;
+    Header.BufferLength = TestRingGetLength(RingIndex, Sequence);
+    Header.CoreId       = RingIndex;
+
+    TestRingFillBody(Body, RingIndex, Sequence, Header.BufferLength);
+
+    return RingWrite(Ring, &Header, Body);
+}
+
+/**
+ * @brief Check a record that is read from the ring
+ *
+ * @param Header
+ * @param RingIndex
+ * @param Sequence The expected sequence number
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestRingCheckRecord(RING_RECORD_HEADER * Header, UINT32 RingIndex, UINT64 Sequence)
+{
+    UINT8   Body[TEST_RING_MAXIMUM_RECORD_LENGTH];
+    UINT8 * RecordBody = (UINT8 *)Header + sizeof(RING_RECORD_HEADER);
+
+    if (Header->TimeStamp != Sequence ||
+        Header->CoreId != RingIndex ||
+        Header->BufferLength != TestRingGetLength(RingIndex, Sequence))
+    {
+        cout << "[-] Unexpected record in ring " << RingIndex << " (expected: " << Sequence
+             << ", received: " << Header->TimeStamp << ")" << endl;
+        return FALSE;
+    }
+
+    TestRingFillBody(Body, RingIndex, Sequence, Header->BufferLength);
+
+    if (memcmp(RecordBody, Body, Header->BufferLength) != 0 || RecordBody[Header->BufferLength] != '\0')
+    {
+        cout << "[-] The body of the record " << Sequence << " in ring " << RingIndex << " is corrupted" << endl;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Allocate the rings (and their indexes)
+ *
+ * @param Rings
+ * @param Indexes Two indexes for each ring
+ * @param Buffers
+ * @param NumberOfRings
+ * @param Size
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestRingInitializeRings(RING_BUFFER *             Rings,
+                        std::vector<RING_INDEX> & Indexes,
+                        std::vector<UINT8> &      Buffers,
+                        UINT32                    NumberOfRings,
+                        UINT32                    Size)
+{
+    Indexes.assign(NumberOfRings * 2, RING_INDEX {});
+    Buffers.assign((size_t)NumberOfRings * Size, 0);
+
+    for (UINT32 i = 0; i < NumberOfRings; i++)
+    {
+        if (!RingInitialize(&Rings[i],
+                            &Indexes[i * 2],
+                            &Indexes[i * 2 + 1],
+                            &Buffers[(size_t)i * Size],
+                            Size,
+                            TEST_RING_MAXIMUM_RECORD_LENGTH))
+        {
+            cout << "[-] Could not initialize the ring " << i << endl;
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Write and read the records in a random order (single thread) and
+ * check the wrap markers and the full ring
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestRingSingleThread()
+{
+    RING_BUFFER             Ring;
+    std::vector<RING_INDEX> Indexes;
+    std::vector<UINT8>      Buffers;
+    RING_RECORD_HEADER *    Header;
+    UINT8 *                 LastRecord    = NULL;
+    UINT64                  NextWrite     = 0;
+    UINT64                  NextRead      = 0;
+    UINT64                  NumberOfWraps = 0;
+    UINT64                  NumberOfDrops = 0;
+    UINT32                  State         = 0x52696e67;
+    UINT32                  Length;
+
+    if (!TestRingInitializeRings(&Ring, Indexes, Buffers, 1, TEST_RING_SIZE))
+    {
+        return FALSE;
+    }
+
+    for (UINT32 i = 0; i < TEST_RING_NUMBER_OF_OPERATIONS; i++)
+    {
+        State = State * 1103515245 + 12345;
+
+        //
+        // Write more than read, so the ring becomes full frequently
+        //
+        if ((State >> 16) % 5 < 3)
+        {
+            Length = TestRingGetLength(0, NextWrite);
+
+            if (TestRingWrite(&Ring, 0, NextWrite))
+            {
+                NextWrite++;
+            }
+            else
+            {
+                //
+                // A record is only dropped if it doesn't fit (even if the rest
+                // of the ring is wasted by a wrap marker)
+                //
+                if (RingGetUsedSize(&Ring) + 2 * RingGetRecordSize(Length) <= Ring.Size)
+                {
+                    cout << "[-] A record is dropped while the ring is not full" << endl;
+                    return FALSE;
+                }
+
+                NumberOfDrops++;
+            }
+        }
+        else
+        {
+            Header = RingPeek(&Ring);
+
+            if (Header == NULL)
+            {
+                if (NextRead != NextWrite || !RingIsEmpty(&Ring))
+                {
+                    cout << "[-] The ring is empty while there are unread records" << endl;
+                    return FALSE;
+                }
+
+                continue;
+            }
+
+            if (!TestRingCheckRecord(Header, 0, NextRead))
+            {
+                return FALSE;
+            }
+
+            //
+            // The next record is at the start of the ring after a wrap marker
+            //
+            if (LastRecord != NULL && (UINT8 *)Header < LastRecord)
+            {
+                NumberOfWraps++;
+            }
+
+            LastRecord = (UINT8 *)Header;
+            NextRead++;
+
+            RingConsume(&Ring);
+        }
+    }
+
+    //
+    // The rest of the records
+    //
+    while ((Header = RingPeek(&Ring)) != NULL)
+    {
+        if (!TestRingCheckRecord(Header, 0, NextRead++))
+        {
+            return FALSE;
+        }
+
+        RingConsume(&Ring);
+    }
+
+    if (NextRead != NextWrite || NumberOfWraps == 0 || NumberOfDrops == 0)
+    {
+        cout << "[-] The single-threaded test didn't cover the wrap markers and the full ring" << endl;
+        return FALSE;
+    }
+
+    printf("[*] single thread: %llu records, %llu wraps, %llu drops (full ring)\n",
+           NextWrite,
+           NumberOfWraps,
+           NumberOfDrops);
+
+    return TRUE;
+}
+
+/**
+ * @brief Check that deficit round-robin shares the consumer between the
+ * rings that have records by their size (not by their number of records)
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestRingFairness()
+{
+    RING_BUFFER             Rings[3];
+    std::vector<RING_INDEX> Indexes;
+    std::vector<UINT8>      Buffers;
+    RING_FAIR_DRAINING      Draining;
+    UINT32                  Deficits[3];
+    UINT64                  ServedBytes[3] = {0};
+    UINT64                  Sequences[3]   = {0};
+    RING_RECORD_HEADER *    Header;
+    UINT32                  RingIndex;
+    UINT32                  Quantum = RingGetRecordSize(TEST_RING_MAXIMUM_RECORD_LENGTH);
+    UINT64                  Minimum;
+    UINT64                  Maximum;
+
+    if (!TestRingInitializeRings(Rings, Indexes, Buffers, 3, TEST_RING_SIZE))
+    {
+        return FALSE;
+    }
+
+    //
+    // Fill all of the rings until they drop the records (the lengths of the
+    // records of each ring have a different distribution)
+    //
+    for (UINT32 i = 0; i < 3; i++)
+    {
+        while (TestRingWrite(&Rings[i], i, Sequences[i]))
+        {
+            Sequences[i]++;
+        }
+
+        if (!RingIsFull(&Rings[i]))
+        {
+            cout << "[-] The ring " << i << " dropped a record but it's not full" << endl;
+            return FALSE;
+        }
+    }
+
+    RingInitializeFairDraining(&Draining, Deficits, 3, Quantum);
+
+    memset(Sequences, 0, sizeof(Sequences));
+
+    //
+    // While all of the rings have records, the bytes that are served from
+    // each ring should not differ more than two quanta
+    //
+    while ((Header = RingPeekFair(Rings, 3, &Draining, &RingIndex)) != NULL)
+    {
+        if (!TestRingCheckRecord(Header, RingIndex, Sequences[RingIndex]))
+        {
+            return FALSE;
+        }
+
+        Sequences[RingIndex]++;
+        ServedBytes[RingIndex] += RingGetRecordSize(Header->BufferLength);
+
+        RingConsumeFair(Rings, &Draining, RingIndex);
+
+        if (RingIsEmpty(&Rings[0]) || RingIsEmpty(&Rings[1]) || RingIsEmpty(&Rings[2]))
+        {
+            break;
+        }
+
+        Minimum = ServedBytes[0];
+        Maximum = ServedBytes[0];
+
+        for (UINT32 i = 1; i < 3; i++)
+        {
+            Minimum = ServedBytes[i] < Minimum ? ServedBytes[i] : Minimum;
+            Maximum = ServedBytes[i] > Maximum ? ServedBytes[i] : Maximum;
+        }
+
+        if (Maximum - Minimum > 2 * Quantum)
+        {
+            cout << "[-] The rings are not drained fairly (served bytes: " << ServedBytes[0] << ", "
+                 << ServedBytes[1] << ", " << ServedBytes[2] << ")" << endl;
+            return FALSE;
+        }
+    }
+
+    printf("[*] fairness: served %llu, %llu and %llu bytes before the first ring became empty\n",
+           ServedBytes[0],
+           ServedBytes[1],
+           ServedBytes[2]);
+
+    return TRUE;
+}
+
+/**
+ * @brief The producer thread of the stress test
+ *
+ * @param Producer
+ *
+ * @return VOID
+ */
+static VOID
+TestRingProducer(TEST_RING_PRODUCER * Producer)
+{
+    while (Producer->Written < TEST_RING_RECORDS_PER_PRODUCER)
+    {
+        if (TestRingWrite(Producer->Ring, Producer->RingIndex, Producer->Written))
+        {
+            Producer->Written++;
+        }
+        else if (Producer->IsFlooding)
+        {
+            //
+            // Dropped, the same sequence number is used for the next record
+            // so the consumer can check the order
+            //
+            Producer->Dropped++;
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    Producer->IsFinished.store(TRUE);
+}
+
+/**
+ * @brief Stress the rings with a producer thread for each ring and a
+ * consumer that drains them by deficit round-robin
+ * @details One of the producers floods its ring and drops the records
+ * that don't fit, the other ones wait for the consumer
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestRingStress()
+{
+    RING_BUFFER              Rings[TEST_RING_NUMBER_OF_PRODUCERS];
+    std::vector<RING_INDEX>  Indexes;
+    std::vector<UINT8>       Buffers;
+    TEST_RING_PRODUCER       Producers[TEST_RING_NUMBER_OF_PRODUCERS];
+    std::vector<std::thread> Threads;
+    RING_FAIR_DRAINING       Draining;
+    UINT32                   Deficits[TEST_RING_NUMBER_OF_PRODUCERS];
+    UINT64                   Sequences[TEST_RING_NUMBER_OF_PRODUCERS]   = {0};
+    UINT8 *                  LastRecords[TEST_RING_NUMBER_OF_PRODUCERS] = {0};
+    UINT64                   NumberOfWraps                              = 0;
+    UINT64                   NumberOfDrops                              = 0;
+    UINT64                   NumberOfRecords                            = 0;
+    UINT64                   NumberOfBytes                              = 0;
+    RING_RECORD_HEADER *     Header;
+    UINT32                   RingIndex;
+    BOOLEAN                  IsFinished;
+    BOOLEAN                  Result = TRUE;
+    double                   Time;
+
+    if (!TestRingInitializeRings(Rings, Indexes, Buffers, TEST_RING_NUMBER_OF_PRODUCERS, TEST_RING_SIZE))
+    {
+        return FALSE;
+    }
+
+    RingInitializeFairDraining(&Draining, Deficits, TEST_RING_NUMBER_OF_PRODUCERS, RingGetRecordSize(TEST_RING_MAXIMUM_RECORD_LENGTH));
+
+    auto Start = std::chrono::steady_clock::now();
+
+    for (UINT32 i = 0; i < TEST_RING_NUMBER_OF_PRODUCERS; i++)
+    {
+        Producers[i].Ring       = &Rings[i];
+        Producers[i].RingIndex  = i;
+        Producers[i].IsFlooding = i == 0;
+        Producers[i].Written    = 0;
+        Producers[i].Dropped    = 0;
+        Producers[i].IsFinished.store(FALSE);
+
+        Threads.emplace_back(TestRingProducer, &Producers[i]);
+    }
+
+    while (TRUE)
+    {
+        //
+        // The state of the producers should be read before checking the rings,
+        // as they publish their last record before finishing
+        //
+        IsFinished = TRUE;
+
+        for (UINT32 i = 0; i < TEST_RING_NUMBER_OF_PRODUCERS; i++)
+        {
+            if (!Producers[i].IsFinished.load())
+            {
+                IsFinished = FALSE;
+            }
+        }
+
+        Header = RingPeekFair(Rings, TEST_RING_NUMBER_OF_PRODUCERS, &Draining, &RingIndex);
+
+        if (Header == NULL)
+        {
+            if (IsFinished)
+            {
+                break;
+            }
+
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (!TestRingCheckRecord(Header, RingIndex, Sequences[RingIndex]))
+        {
+            Result = FALSE;
+            break;
+        }
+
+        if (LastRecords[RingIndex] != NULL && (UINT8 *)Header < LastRecords[RingIndex])
+        {
+            NumberOfWraps++;
+        }
+
+        LastRecords[RingIndex] = (UINT8 *)Header;
+        Sequences[RingIndex]++;
+        NumberOfRecords++;
+        NumberOfBytes += Header->BufferLength;
+
+        RingConsumeFair(Rings, &Draining, RingIndex);
+    }
+
+    if (!Result)
+    {
+        //
+        // Let the producers finish (the rings are drained without checking)
+        //
+        do
+        {
+            IsFinished = TRUE;
+
+            for (UINT32 i = 0; i < TEST_RING_NUMBER_OF_PRODUCERS; i++)
+            {
+                IsFinished = Producers[i].IsFinished.load() && IsFinished;
+                RingDiscardAll(&Rings[i]);
+            }
+
+        } while (!IsFinished);
+    }
+
+    for (auto & Thread : Threads)
+    {
+        Thread.join();
+    }
+
+    if (!Result)
+    {
+        return FALSE;
+    }
+
+    Time = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+    for (UINT32 i = 0; i < TEST_RING_NUMBER_OF_PRODUCERS; i++)
+    {
+        if (Sequences[i] != Producers[i].Written)
+        {
+            cout << "[-] The ring " << i << " lost records (written: " << Producers[i].Written
+                 << ", received: " << Sequences[i] << ")" << endl;
+            return FALSE;
+        }
+
+        NumberOfDrops += Producers[i].Dropped;
+    }
+
+    if (NumberOfWraps == 0)
+    {
+        cout << "[-] The stress test didn't cover the wrap markers" << endl;
+        return FALSE;
+    }
+
+    printf("[*] stress: %u producers, %llu records, %llu wraps, %llu drops (full ring), %.1f MB/s, %.1f M records/s\n",
+           TEST_RING_NUMBER_OF_PRODUCERS,
+           NumberOfRecords,
+           NumberOfWraps,
+           NumberOfDrops,
+           NumberOfBytes / Time / (1024 * 1024),
+           NumberOfRecords / Time / 1000000);
+
+    return TRUE;
+}
+
+/**
+ * @brief Test the rings of the logs (wrap markers, full rings, fairness and
+ * concurrent producers and consumer)
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TestRing()
+{
+    BOOLEAN Result = TRUE;
+
+    if (!TestRingSingleThread())
+    {
+        Result = FALSE;
+    }
+
+    if (!TestRingFairness())
+    {
+        Result = FALSE;
+    }
+
+    if (!TestRingStress())
+    {
+        Result = FALSE;
+    }
+
+    return Result;
+}
@@ -0,0 +1,246 @@
+/**
+ * @file test-script-engine.cpp
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Perform test on the (local) evaluation of scripts
+ * @details The scripts are evaluated by libhyperdbg in user-mode (with the
+ * simulated registers), the result of each script is the value that is passed
+ * to the 'formats' function
+ * @version 0.14
+ * @date 2025-07-14
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Number of local variables of the large script (more than the
+ * slots of the default stack buffer)
+ */
+#define TEST_SCRIPT_ENGINE_NUMBER_OF_LARGE_SCRIPT_VARIABLES (MAX_STACK_BUFFER_COUNT + 0x40)
+
+/**
+ * @brief Evaluate a script and check its result
+ *
+ * @param Script
+ * @param ExpectedResult
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestScriptEngineCheck(const std::string & Script, UINT64 ExpectedResult)
+{
+    BOOLEAN HasError = FALSE;
+    UINT64  Result;
+
+    Result = hyperdbg_u_eval_script_locally(Script.c_str(), NULL, &HasError);
+
+    if (HasError)
+    {
+        cout << "[-] Unable to evaluate the script : " << Script.substr(0, 80) << endl;
+        return FALSE;
+    }
+
+    if (Result != ExpectedResult)
+    {
+        cout << "[-] Unexpected result of the script : " << Script.substr(0, 80) << " (expected: 0x" << hex
+             << ExpectedResult << ", received: 0x" << Result << ")" << dec << endl;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Test a script whose stack footprint is larger than the default
+ * stack buffer
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestScriptEngineLargeStack()
+{
+    std::stringstream Script;
+    UINT64            Expected = 0;
+
+    //
+    // Each local variable takes a slot of the stack
+    //
+    for (UINT32 i = 0; i < TEST_SCRIPT_ENGINE_NUMBER_OF_LARGE_SCRIPT_VARIABLES; i++)
+    {
+        Script << "v" << i << " = 0x" << hex << (i * 3 + 1) << dec << "; ";
+    }
+
+    //
+    // Read the first, the middle and the last variables
+    //
+    Script << "formats(v0 + v" << MAX_STACK_BUFFER_COUNT / 2 << " + v"
+           << TEST_SCRIPT_ENGINE_NUMBER_OF_LARGE_SCRIPT_VARIABLES - 1 << ");";
+
+    Expected = 1 + (MAX_STACK_BUFFER_COUNT / 2) * 3 + 1 + (TEST_SCRIPT_ENGINE_NUMBER_OF_LARGE_SCRIPT_VARIABLES - 1) * 3 + 1;
+
+    if (!TestScriptEngineCheck(Script.str(), Expected))
+    {
+        return FALSE;
+    }
+
+    cout << "[+] Script with " << TEST_SCRIPT_ENGINE_NUMBER_OF_LARGE_SCRIPT_VARIABLES << " local variables is evaluated" << endl;
+
+    return TRUE;
+}
+
+/**
+ * @brief Test that the local variables are zero before they are assigned,
+ * even if the previous script left its values on the stack
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestScriptEngineZeroedStack()
+{
+    if (!TestScriptEngineCheck("v1 = 55; v2 = 66; formats(v1 + v2);", 0xbb))
+    {
+        return FALSE;
+    }
+
+    if (!TestScriptEngineCheck("if (0) { v1 = 5; v2 = 6; } formats(v1 + v2 + 1);", 1))
+    {
+        return FALSE;
+    }
+
+    cout << "[+] Local variables are zero before they are assigned" << endl;
+
+    return TRUE;
+}
+
+/**
+ * @brief Test that the predicates that are lowered from the condition of
+ * the scripts give the same result as running the scripts
+ * @details The lowered scripts call 'formats(1)' only if their condition
+ * is met
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestScriptEngineConditionPredicates()
+{
+    const CHAR * LoweredScripts[] = {
+        "if (@rcx == 5 && @rdx > 3) { formats(1); }",
+        "if (@rcx & 0x10) { formats(1); }",
+        "if (@rdx < 0) { formats(1); }",
+        "if (@rcx != @rdx && @rcx >= 0x10 && @rdx <= 0x20) { formats(1); }",
+        "if (0x20 > @rcx) { v1 = @rcx + 1; formats(v1 - @rcx); }",
+    };
+
+    const CHAR * NotLoweredScripts[] = {
+        "if (@rcx == 5) { formats(1); } else { formats(2); }",
+        "if (@rcx == 5 || @rdx == 5) { formats(1); }",
+        "v1 = 5; if (@rcx == v1) { formats(1); }",
+        "if (@rcx == 5) { formats(1); } formats(2);",
+        "if (@rcx & 4 && @rdx == 1) { formats(1); }",
+        "if (@rcx == 1 && @rdx == 2 && @rax == 3 && @rbx == 4 && @rsi == 5) { formats(1); }",
+        "if (@rcx + 1 == 5) { formats(1); }",
+    };
+
+    //
+    // Values of (@rcx, @rdx), including the values on the edge of the
+    // (signed) comparisons
+    //
+    const UINT64 RegisterValues[][2] = {
+        {5, 4},
+        {5, 3},
+        {4, 4},
+        {0, 0},
+        {0xffffffffffffffff, 0xffffffffffffffff},
+        {0x8000000000000000, 0x7fffffffffffffff},
+        {0x10, 0x20},
+        {0x11, 0x21},
+        {0x1f, 0x10},
+        {0x20, 0x10},
+        {0x30, 0x30},
+    };
+
+    for (const CHAR * Script : LoweredScripts)
+    {
+        for (const auto & Values : RegisterValues)
+        {
+            GUEST_REGS Regs      = {0};
+            BOOLEAN    HasError  = FALSE;
+            BOOLEAN    IsLowered = FALSE;
+            BOOLEAN    IsScriptConditionMet;
+            BOOLEAN    ArePredicatesMet;
+            UINT64     Result;
+
+            Regs.rcx = Values[0];
+            Regs.rdx = Values[1];
+
+            //
+            // The script doesn't call 'formats' if its condition is not met
+            //
+            Result               = hyperdbg_u_eval_script_locally(Script, &Regs, &HasError);
+            IsScriptConditionMet = !HasError && Result == 1;
+
+            ArePredicatesMet = hyperdbg_u_eval_script_condition_predicates_locally(Script, &Regs, &IsLowered, &HasError);
+
+            if (HasError || !IsLowered)
+            {
+                cout << "[-] Condition of the script is not lowered : " << Script << endl;
+                return FALSE;
+            }
+
+            if (ArePredicatesMet != IsScriptConditionMet)
+            {
+                cout << "[-] Lowered predicates don't match the script : " << Script << " (rcx: 0x" << hex << Values[0]
+                     << ", rdx: 0x" << Values[1] << dec << ", script: " << (UINT32)IsScriptConditionMet
+                     << ", predicates: " << (UINT32)ArePredicatesMet << ")" << endl;
+                return FALSE;
+            }
+        }
+    }
+
+    for (const CHAR * Script : NotLoweredScripts)
+    {
+        BOOLEAN HasError  = FALSE;
+        BOOLEAN IsLowered = FALSE;
+
+        hyperdbg_u_eval_script_condition_predicates_locally(Script, NULL, &IsLowered, &HasError);
+
+        if (HasError || IsLowered)
+        {
+            cout << "[-] Condition of the script should not be lowered : " << Script << endl;
+            return FALSE;
+        }
+    }
+
+    cout << "[+] Lowered predicates match the conditions of the scripts" << endl;
+
+    return TRUE;
+}
+
+/**
+ * @brief Test the (local) evaluation of scripts
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TestScriptEngine()
+{
+    BOOLEAN Result = TRUE;
+
+    if (!TestScriptEngineLargeStack())
+    {
+        Result = FALSE;
+    }
+
+    if (!TestScriptEngineZeroedStack())
+    {
+        Result = FALSE;
+    }
+
+    if (!TestScriptEngineConditionPredicates())
+    {
+        Result = FALSE;
+    }
+
+    return Result;
+}
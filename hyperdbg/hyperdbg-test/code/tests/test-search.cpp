@@ -0,0 +1,366 @@
+/**
+ * @file test-search.cpp
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Perform test on the search of memory blocks
+ * @details The buffer is searched in blocks (same as the 's*' commands in
+ * the kernel) and the results are compared with a simple search, the
+ * throughput is also compared with reading and comparing each element
+ * @version 0.14
+ * @date 2025-06-27
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Size of the searched buffer
+ */
+#define TEST_SEARCH_BUFFER_SIZE (4 * 1024 * 1024)
+
+/**
+ * @brief Size of each block (same as the kernel)
+ */
+#define TEST_SEARCH_BLOCK_SIZE 4096
+
+/**
+ * @brief Number of the copies of each pattern that are put in the buffer
+ */
+#define TEST_SEARCH_COPIES_OF_EACH_PATTERN 64
+
+/**
+ * @brief Number of elements of the patterns
+ */
+static const UINT32 TestSearchPatternLengths[] = {3, 5, 2, 8};
+
+/**
+ * @brief Save a matched address
+ *
+ * @param Context The vector of the results
+ * @param Address
+ * @param PatternIndex
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestSearchSaveMatch(PVOID Context, UINT64 Address, UINT32 PatternIndex)
+{
+    UNREFERENCED_PARAMETER(PatternIndex);
+
+    ((vector<UINT64> *)Context)->push_back(Address);
+
+    return TRUE;
+}
+
+/**
+ * @brief Search the buffer in blocks (same as the kernel)
+ *
+ * @param Patterns
+ * @param Buffer
+ * @param Length
+ * @param Results
+ *
+ * @return VOID
+ */
+static VOID
+TestSearchByBlocks(const SEARCH_PATTERNS * Patterns, const UINT8 * Buffer, UINT32 Length, vector<UINT64> & Results)
+{
+    UINT32 ScanLength;
+    UINT32 ReadLength;
+
+    for (UINT32 Offset = 0; Offset < Length; Offset += ScanLength)
+    {
+        ScanLength = TEST_SEARCH_BLOCK_SIZE;
+
+        if (ScanLength > Length - Offset)
+        {
+            ScanLength = Length - Offset;
+        }
+
+        ReadLength = ScanLength + Patterns->MaximumLength - Patterns->ElementSize;
+
+        if (ReadLength > Length - Offset)
+        {
+            ReadLength = Length - Offset;
+        }
+
+        SearchScanBlock(Patterns, Buffer + Offset, ScanLength, ReadLength, Offset, TestSearchSaveMatch, &Results);
+    }
+}
+
+/**
+ * @brief Search the buffer by comparing all of the patterns in each position
+ *
+ * @param Patterns
+ * @param Buffer
+ * @param Length
+ * @param Results
+ *
+ * @return VOID
+ */
+static VOID
+TestSearchSimple(const SEARCH_PATTERNS * Patterns, const UINT8 * Buffer, UINT32 Length, vector<UINT64> & Results)
+{
+    for (UINT32 Offset = 0; Offset < Length; Offset += Patterns->ElementSize)
+    {
+        for (UINT32 i = 0; i < Patterns->NumberOfPatterns; i++)
+        {
+            if (Patterns->Lengths[i] <= Length - Offset &&
+                memcmp(Buffer + Offset, &Patterns->Bytes[Patterns->Offsets[i]], Patterns->Lengths[i]) == 0)
+            {
+                Results.push_back(Offset);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Read an element (not inlined, as the previous search read
+ * each element through the safe memory routine)
+ *
+ * @param Address
+ * @param Buffer
+ * @param Size
+ *
+ * @return VOID
+ */
+static __declspec(noinline) VOID
+TestSearchReadElement(const UINT8 * Address, UINT64 * Buffer, UINT32 Size)
+{
+    *Buffer = 0;
+    memcpy(Buffer, Address, Size);
+}
+
+/**
+ * @brief Search the first pattern by reading each element (same as the
+ * previous search of the 's*' commands)
+ *
+ * @param Elements
+ * @param NumberOfElements
+ * @param ElementSize
+ * @param Buffer
+ * @param Length
+ *
+ * @return UINT32 Number of matches
+ */
+static UINT32
+TestSearchByElements(const UINT64 * Elements, UINT32 NumberOfElements, UINT32 ElementSize, const UINT8 * Buffer, UINT32 Length)
+{
+    UINT32 CountOfMatches = 0;
+    UINT64 Value;
+    UINT32 i;
+
+    for (UINT32 Offset = 0; Offset + NumberOfElements * ElementSize <= Length; Offset += ElementSize)
+    {
+        for (i = 0; i < NumberOfElements; i++)
+        {
+            TestSearchReadElement(Buffer + Offset + i * ElementSize, &Value, ElementSize);
+
+            if (Value != Elements[i])
+            {
+                break;
+            }
+        }
+
+        if (i == NumberOfElements)
+        {
+            CountOfMatches++;
+        }
+    }
+
+    return CountOfMatches;
+}
+
+/**
+ * @brief Test the search with an element size and number of patterns
+ *
+ * @param Buffer
+ * @param ElementSize
+ * @param NumberOfPatterns
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestSearchCase(UINT8 * Buffer, UINT32 ElementSize, UINT32 NumberOfPatterns)
+{
+    SEARCH_PATTERNS * Patterns = (SEARCH_PATTERNS *)malloc(sizeof(SEARCH_PATTERNS));
+    vector<UINT64>    BlockResults;
+    vector<UINT64>    SimpleResults;
+    UINT64            Elements[8];
+    UINT64            Mask;
+    UINT32            Offset;
+    UINT32            CountOfMatches;
+    LARGE_INTEGER     Frequency;
+    LARGE_INTEGER     Start;
+    LARGE_INTEGER     End;
+    double            BlockTime;
+    double            ElementTime;
+    BOOLEAN           Result = FALSE;
+
+    if (Patterns == NULL || !SearchInitializePatterns(Patterns, ElementSize))
+    {
+        free(Patterns);
+        return FALSE;
+    }
+
+    Mask = ElementSize == sizeof(UINT64) ? MAXUINT64 : ((UINT64)1 << (ElementSize * 8)) - 1;
+
+    //
+    // Make the buffer random (the bytes are limited so the first elements match often)
+    //
+    for (UINT32 i = 0; i < TEST_SEARCH_BUFFER_SIZE; i++)
+    {
+        Buffer[i] = (UINT8)(TestCommonRandom() % 16);
+    }
+
+    for (UINT32 i = 0; i < NumberOfPatterns; i++)
+    {
+        for (UINT32 j = 0; j < TestSearchPatternLengths[i]; j++)
+        {
+            Elements[j] = TestCommonRandom() & Mask;
+        }
+
+        if (!SearchAddPattern(Patterns, Elements, TestSearchPatternLengths[i]))
+        {
+            cout << "[-] Could not add the pattern " << i << endl;
+            goto Exit;
+        }
+
+        //
+        // Put the pattern in random places, also at the end of the blocks and the buffer
+        //
+        for (UINT32 j = 0; j < TEST_SEARCH_COPIES_OF_EACH_PATTERN; j++)
+        {
+            if (j == 0)
+            {
+                Offset = TEST_SEARCH_BLOCK_SIZE - ElementSize;
+            }
+            else if (j == 1)
+            {
+                Offset = TEST_SEARCH_BUFFER_SIZE - Patterns->Lengths[i];
+            }
+            else
+            {
+                Offset = (UINT32)(TestCommonRandom() % (TEST_SEARCH_BUFFER_SIZE - Patterns->Lengths[i]));
+            }
+
+            Offset -= Offset % ElementSize;
+
+            memcpy(Buffer + Offset, &Patterns->Bytes[Patterns->Offsets[i]], Patterns->Lengths[i]);
+        }
+    }
+
+    //
+    // Both of the searches should find the same addresses
+    //
+    QueryPerformanceFrequency(&Frequency);
+    QueryPerformanceCounter(&Start);
+
+    TestSearchByBlocks(Patterns, Buffer, TEST_SEARCH_BUFFER_SIZE, BlockResults);
+
+    QueryPerformanceCounter(&End);
+
+    BlockTime = (double)(End.QuadPart - Start.QuadPart) / Frequency.QuadPart;
+
+    TestSearchSimple(Patterns, Buffer, TEST_SEARCH_BUFFER_SIZE, SimpleResults);
+
+    if (BlockResults != SimpleResults || BlockResults.size() < TEST_SEARCH_COPIES_OF_EACH_PATTERN)
+    {
+        cout << "[-] The results of the search are not correct (element size: " << ElementSize
+             << ", patterns: " << NumberOfPatterns << ")" << endl;
+        goto Exit;
+    }
+
+    //
+    // Only one pattern could be searched by reading each element
+    //
+    if (NumberOfPatterns == 1)
+    {
+        QueryPerformanceCounter(&Start);
+
+        CountOfMatches = TestSearchByElements(Elements, TestSearchPatternLengths[0], ElementSize, Buffer, TEST_SEARCH_BUFFER_SIZE);
+
+        QueryPerformanceCounter(&End);
+
+        ElementTime = (double)(End.QuadPart - Start.QuadPart) / Frequency.QuadPart;
+
+        if (CountOfMatches != SimpleResults.size())
+        {
+            cout << "[-] The results of reading each element are not correct (element size: " << ElementSize << ")" << endl;
+            goto Exit;
+        }
+
+        printf("[*] element size: %u, patterns: %u, blocks: %.1f MB/s, each element: %.1f MB/s, speedup: %.1fx\n",
+               ElementSize,
+               NumberOfPatterns,
+               TEST_SEARCH_BUFFER_SIZE / BlockTime / (1024 * 1024),
+               TEST_SEARCH_BUFFER_SIZE / ElementTime / (1024 * 1024),
+               ElementTime / BlockTime);
+    }
+    else
+    {
+        printf("[*] element size: %u, patterns: %u, blocks: %.1f MB/s\n",
+               ElementSize,
+               NumberOfPatterns,
+               TEST_SEARCH_BUFFER_SIZE / BlockTime / (1024 * 1024));
+    }
+
+    //
+    // Also when the buffer ends in the middle of an element
+    //
+    BlockResults.clear();
+    SimpleResults.clear();
+
+    TestSearchByBlocks(Patterns, Buffer, TEST_SEARCH_BUFFER_SIZE - 3, BlockResults);
+    TestSearchSimple(Patterns, Buffer, TEST_SEARCH_BUFFER_SIZE - 3, SimpleResults);
+
+    if (BlockResults != SimpleResults)
+    {
+        cout << "[-] The results of the search at the end of the buffer are not correct (element size: "
+             << ElementSize << ", patterns: " << NumberOfPatterns << ")" << endl;
+        goto Exit;
+    }
+
+    Result = TRUE;
+
+Exit:
+
+    free(Patterns);
+
+    return Result;
+}
+
+/**
+ * @brief Test the search of memory blocks with different element sizes
+ * and number of patterns
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TestSearch()
+{
+    const UINT32 ElementSizes[] = {sizeof(UINT8), sizeof(UINT32), sizeof(UINT64)};
+    UINT8 *      Buffer         = (UINT8 *)malloc(TEST_SEARCH_BUFFER_SIZE);
+    BOOLEAN      Result         = TRUE;
+
+    if (Buffer == NULL)
+    {
+        return FALSE;
+    }
+
+    TestCommonSetSeed(0x4879706572446267);
+
+    for (UINT32 ElementSize : ElementSizes)
+    {
+        if (!TestSearchCase(Buffer, ElementSize, 1) ||
+            !TestSearchCase(Buffer, ElementSize, _countof(TestSearchPatternLengths)))
+        {
+            Result = FALSE;
+        }
+    }
+
+    free(Buffer);
+
+    return Result;
+}
@@ -0,0 +1,749 @@
+/**
+ * @file test-transport.cpp
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Perform test on the transports of the kernel debugger
+ * @details A simulated debuggee answers the read memory packets of the kernel
+ * debugger over a connected pair of sockets (the socket transport, UNIX
+ * sockets on POSIX and TCP sockets on the loopback on Windows), the packets
+ * are fuzzed and corrupted on the wire, and the throughput of reading the
+ * memory is measured
+ * @version 0.14
+ * @date 2025-06-30
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Size of each page
+ */
+#define TEST_TRANSPORT_PAGE_SIZE 4096
+
+/**
+ * @brief Number of pages that are read in each run
+ */
+#define TEST_TRANSPORT_NUMBER_OF_READS 2048
+
+/**
+ * @brief The window size of the pipelined run
+ */
+#define TEST_TRANSPORT_WINDOW_SIZE 8
+
+/**
+ * @brief Each of these packets is corrupted on the wire
+ */
+#define TEST_TRANSPORT_CORRUPTION_INTERVAL 64
+
+/**
+ * @brief The time (in milliseconds) to wait for the next response before
+ * sending the outstanding requests again
+ */
+#define TEST_TRANSPORT_RESPONSE_TIMEOUT 500
+
+/**
+ * @brief The index of the dropped request if none of the requests are dropped
+ */
+#define TEST_TRANSPORT_NO_DROPPED_REQUEST 0xffffffff
+
+/**
+ * @brief Number of the fuzzed packets
+ */
+#define TEST_TRANSPORT_NUMBER_OF_FUZZED_PACKETS 4096
+
+/**
+ * @brief Address of the first page of the simulated memory
+ */
+#define TEST_TRANSPORT_BASE_ADDRESS 0xfffff80000000000
+
+/**
+ * @brief Maximum size of a packet (a response of reading a page)
+ */
+#define TEST_TRANSPORT_MAXIMUM_PACKET_SIZE \
+    (sizeof(DEBUGGER_REMOTE_PACKET) + sizeof(DEBUGGER_READ_MEMORY) + TEST_TRANSPORT_PAGE_SIZE)
+
+/**
+ * @brief One side of the loopback
+ *
+ */
+typedef struct _TEST_TRANSPORT_SIDE
+{
+    TEST_COMMON_CHANNEL Channel;
+    FRAMING_TRANSPORT   Framing;
+    UINT8               RetransmissionBuffer[TEST_TRANSPORT_MAXIMUM_PACKET_SIZE + sizeof(FRAMING_HEADER)];
+    volatile UINT32     CorruptionInterval;      // The simulated debuggee corrupts each of these responses (zero if not)
+    volatile UINT32     NumberOfAnsweredPackets; // Read packets that the simulated debuggee answered
+    volatile UINT32     NumberOfRejectedPackets; // Packets that the simulated debuggee didn't accept
+
+} TEST_TRANSPORT_SIDE, *PTEST_TRANSPORT_SIDE;
+
+/**
+ * @brief The state of the debugger side
+ *
+ */
+typedef struct _TEST_TRANSPORT_DEBUGGER
+{
+    TEST_TRANSPORT_SIDE Side;
+    PIPELINE_WINDOW     Window;
+    UINT8 *             Pages;
+    UINT8 *             Buffer;             // The received packet
+    UINT32              CorruptionInterval; // Each of these requests is corrupted (zero if not)
+    UINT32              DroppedRequest;     // The request at this index is not sent the first time
+    UINT32              NumberOfSentRequests;
+    UINT32              NumberOfStaleResponses;
+
+} TEST_TRANSPORT_DEBUGGER, *PTEST_TRANSPORT_DEBUGGER;
+
+/**
+ * @brief Compute the checksum of a packet (same as the kernel debugger)
+ *
+ * @param Packet
+ * @param Buffer The buffer after the packet
+ * @param Length Length of the buffer
+ *
+ * @return BYTE
+ */
+static BYTE
+TestTransportChecksum(const DEBUGGER_REMOTE_PACKET * Packet, const VOID * Buffer, UINT32 Length)
+{
+    BYTE Checksum = 0;
+
+    for (UINT32 i = 1; i < sizeof(DEBUGGER_REMOTE_PACKET); i++)
+    {
+        Checksum += ((const BYTE *)Packet)[i];
+    }
+
+    for (UINT32 i = 0; i < Length; i++)
+    {
+        Checksum += ((const BYTE *)Buffer)[i];
+    }
+
+    return Checksum;
+}
+
+/**
+ * @brief Send a packet and a buffer as one frame
+ *
+ * @param Side
+ * @param Type
+ * @param RequestedAction
+ * @param Buffer1
+ * @param Length1
+ * @param Buffer2
+ * @param Length2
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestTransportSendPacket(TEST_TRANSPORT_SIDE *                   Side,
+                        DEBUGGER_REMOTE_PACKET_TYPE             Type,
+                        DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION RequestedAction,
+                        const VOID *                            Buffer1,
+                        UINT32                                  Length1,
+                        const VOID *                            Buffer2,
+                        UINT32                                  Length2)
+{
+    DEBUGGER_REMOTE_PACKET Packet;
+    const VOID *           Buffers[3];
+    UINT32                 Lengths[3];
+
+    memset(&Packet, 0, sizeof(DEBUGGER_REMOTE_PACKET));
+
+    Packet.Indicator                  = INDICATOR_OF_HYPERDBG_PACKET;
+    Packet.TypeOfThePacket            = Type;
+    Packet.RequestedActionOfThePacket = RequestedAction;
+    Packet.Checksum                   = TestTransportChecksum(&Packet, Buffer1, Length1) +
+                      TestTransportChecksum(&Packet, Buffer2, Length2) -
+                      TestTransportChecksum(&Packet, NULL, 0);
+
+    Buffers[0] = &Packet;
+    Lengths[0] = sizeof(DEBUGGER_REMOTE_PACKET);
+    Buffers[1] = Buffer1;
+    Lengths[1] = Length1;
+    Buffers[2] = Buffer2;
+    Lengths[2] = Length2;
+
+    return FramingSendBuffers(&Side->Framing, Buffers, Lengths, 3);
+}
+
+/**
+ * @brief Check a received packet
+ *
+ * @param Buffer
+ * @param Length
+ * @param Type The expected type
+ * @param RequestedAction The expected action
+ *
+ * @return DEBUGGER_READ_MEMORY * The read memory structure of the packet
+ * or NULL if the packet is not valid
+ */
+static DEBUGGER_READ_MEMORY *
+TestTransportCheckPacket(UINT8 *                                 Buffer,
+                         UINT32                                  Length,
+                         DEBUGGER_REMOTE_PACKET_TYPE             Type,
+                         DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION RequestedAction)
+{
+    DEBUGGER_REMOTE_PACKET * Packet  = (DEBUGGER_REMOTE_PACKET *)Buffer;
+    DEBUGGER_READ_MEMORY *   ReadMem = (DEBUGGER_READ_MEMORY *)(Buffer + sizeof(DEBUGGER_REMOTE_PACKET));
+
+    if (Length < sizeof(DEBUGGER_REMOTE_PACKET) + sizeof(DEBUGGER_READ_MEMORY) ||
+        Packet->Indicator != INDICATOR_OF_HYPERDBG_PACKET ||
+        Packet->TypeOfThePacket != Type ||
+        Packet->RequestedActionOfThePacket != RequestedAction ||
+        Packet->Checksum != TestTransportChecksum(Packet, ReadMem, Length - sizeof(DEBUGGER_REMOTE_PACKET)) ||
+        ReadMem->Size > TEST_TRANSPORT_PAGE_SIZE)
+    {
+        return NULL;
+    }
+
+    return ReadMem;
+}
+
+/**
+ * @brief The thread of the simulated debuggee
+ * @details The read memory packets are answered in order, as the debuggee
+ * does while it's halted, and other packets are ignored
+ *
+ * @param Debuggee The side of the debuggee
+ *
+ * @return VOID
+ */
+static VOID
+TestTransportDebuggeeThread(TEST_TRANSPORT_SIDE * Debuggee)
+{
+    UINT8 *                Buffer = (UINT8 *)malloc(TEST_TRANSPORT_MAXIMUM_PACKET_SIZE);
+    UINT8 *                Page   = (UINT8 *)malloc(TEST_TRANSPORT_PAGE_SIZE);
+    DEBUGGER_READ_MEMORY * ReadMem;
+    UINT32                 Length;
+    FRAMING_STATUS         Status;
+
+    while (Buffer != NULL && Page != NULL)
+    {
+        Status = FramingReceive(&Debuggee->Framing, Buffer, TEST_TRANSPORT_MAXIMUM_PACKET_SIZE, &Length);
+
+        if (Status == FRAMING_STATUS_CONNECTION_CLOSED)
+        {
+            break;
+        }
+        else if (Status != FRAMING_STATUS_SUCCESS)
+        {
+            //
+            // A NAK is sent, so the next frame is the retransmitted one
+            //
+            continue;
+        }
+
+        ReadMem = TestTransportCheckPacket(Buffer,
+                                           Length,
+                                           DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGER_TO_DEBUGGEE_EXECUTE_ON_VMX_ROOT,
+                                           DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_READ_MEMORY);
+
+        if (ReadMem == NULL || Length != sizeof(DEBUGGER_REMOTE_PACKET) + sizeof(DEBUGGER_READ_MEMORY))
+        {
+            Debuggee->NumberOfRejectedPackets++;
+            continue;
+        }
+
+        ReadMem->ReturnLength = ReadMem->Size;
+        ReadMem->KernelStatus = DEBUGGER_OPERATION_WAS_SUCCESSFUL;
+
+        TestCommonFillPage((UINT32)((ReadMem->Address - TEST_TRANSPORT_BASE_ADDRESS) / TEST_TRANSPORT_PAGE_SIZE), Page, ReadMem->Size);
+
+        Debuggee->NumberOfAnsweredPackets++;
+
+        if (Debuggee->CorruptionInterval != 0 &&
+            Debuggee->NumberOfAnsweredPackets % Debuggee->CorruptionInterval == 0)
+        {
+            Debuggee->Channel.CorruptNextWrite = TRUE;
+        }
+
+        if (!TestTransportSendPacket(Debuggee,
+                                     DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
+                                     DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_READING_MEMORY,
+                                     ReadMem,
+                                     sizeof(DEBUGGER_READ_MEMORY),
+                                     Page,
+                                     ReadMem->Size))
+        {
+            break;
+        }
+    }
+
+    free(Buffer);
+    free(Page);
+}
+
+/**
+ * @brief Send a read memory packet to the simulated debuggee
+ *
+ * @param Debugger
+ * @param Address
+ * @param Size
+ * @param RequestId
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestTransportSendRead(TEST_TRANSPORT_DEBUGGER * Debugger, UINT64 Address, UINT32 Size, UINT32 RequestId)
+{
+    DEBUGGER_READ_MEMORY ReadMem;
+
+    memset(&ReadMem, 0, sizeof(DEBUGGER_READ_MEMORY));
+
+    ReadMem.Address     = Address;
+    ReadMem.Size        = Size;
+    ReadMem.MemoryType  = DEBUGGER_READ_VIRTUAL_ADDRESS;
+    ReadMem.ReadingType = READ_FROM_KERNEL;
+    ReadMem.RequestId   = RequestId;
+
+    return TestTransportSendPacket(&Debugger->Side,
+                                   DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGER_TO_DEBUGGEE_EXECUTE_ON_VMX_ROOT,
+                                   DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_READ_MEMORY,
+                                   &ReadMem,
+                                   sizeof(DEBUGGER_READ_MEMORY),
+                                   NULL,
+                                   0);
+}
+
+/**
+ * @brief Receive the response of a read memory packet
+ * @details The corrupted frames are requested again (by a NAK), but the
+ * other side only sends its last frame again, so the older ones are lost
+ *
+ * @param Debugger
+ * @param IsCorrupted Whether the received frame is corrupted
+ *
+ * @return DEBUGGER_READ_MEMORY * The response (followed by the memory) or
+ * NULL if the connection is closed or the response is not valid
+ */
+static DEBUGGER_READ_MEMORY *
+TestTransportReceiveRead(TEST_TRANSPORT_DEBUGGER * Debugger, BOOLEAN * IsCorrupted)
+{
+    DEBUGGER_READ_MEMORY * ReadMem;
+    UINT32                 Length;
+    FRAMING_STATUS         Status;
+
+    Status       = FramingReceive(&Debugger->Side.Framing, Debugger->Buffer, TEST_TRANSPORT_MAXIMUM_PACKET_SIZE, &Length);
+    *IsCorrupted = Status == FRAMING_STATUS_INVALID_CHECKSUM;
+
+    if (Status != FRAMING_STATUS_SUCCESS)
+    {
+        return NULL;
+    }
+
+    ReadMem = TestTransportCheckPacket(Debugger->Buffer,
+                                       Length,
+                                       DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
+                                       DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_READING_MEMORY);
+
+    if (ReadMem == NULL ||
+        ReadMem->KernelStatus != DEBUGGER_OPERATION_WAS_SUCCESSFUL ||
+        Length != sizeof(DEBUGGER_REMOTE_PACKET) + sizeof(DEBUGGER_READ_MEMORY) + ReadMem->ReturnLength)
+    {
+        return NULL;
+    }
+
+    return ReadMem;
+}
+
+/**
+ * @brief Send routine of the window
+ * @details The request is corrupted on the wire or dropped (as if it's lost
+ * without a NAK) if it's requested
+ *
+ * @param Context The state of the debugger
+ * @param Index
+ * @param RequestId
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestTransportPipelineSend(PVOID Context, UINT32 Index, UINT32 RequestId)
+{
+    TEST_TRANSPORT_DEBUGGER * Debugger = (TEST_TRANSPORT_DEBUGGER *)Context;
+
+    if (Index == Debugger->DroppedRequest)
+    {
+        Debugger->DroppedRequest = TEST_TRANSPORT_NO_DROPPED_REQUEST;
+        return TRUE;
+    }
+
+    //
+    // The sent requests are counted (not the indexes), so the resent requests
+    // are not corrupted again
+    //
+    Debugger->NumberOfSentRequests++;
+
+    Debugger->Side.Channel.CorruptNextWrite = Debugger->CorruptionInterval != 0 &&
+                                              Debugger->NumberOfSentRequests % Debugger->CorruptionInterval == Debugger->CorruptionInterval / 2;
+
+    return TestTransportSendRead(Debugger,
+                                 TEST_TRANSPORT_BASE_ADDRESS + (UINT64)Index * TEST_TRANSPORT_PAGE_SIZE,
+                                 TEST_TRANSPORT_PAGE_SIZE,
+                                 RequestId);
+}
+
+/**
+ * @brief Wait routine of the window
+ * @details The responses are received on the same thread, one frame
+ * is received in each call
+ *
+ * @param Context The state of the debugger
+ * @param Timeout
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestTransportPipelineWait(PVOID Context, UINT32 Timeout)
+{
+    TEST_TRANSPORT_DEBUGGER * Debugger = (TEST_TRANSPORT_DEBUGGER *)Context;
+    DEBUGGER_READ_MEMORY *    ReadMem;
+    BOOLEAN                   IsCorrupted;
+    UINT32                    Index;
+
+    //
+    // The window sends the outstanding requests again once the timeout is expired
+    //
+    if (!TransportPoll(&Debugger->Side.Channel.Transport, Timeout))
+    {
+        return TRUE;
+    }
+
+    ReadMem = TestTransportReceiveRead(Debugger, &IsCorrupted);
+
+    if (ReadMem == NULL)
+    {
+        //
+        // A corrupted frame is either sent again or detected as a lost one
+        //
+        return IsCorrupted;
+    }
+
+    if (!PipelineMatchResponse(&Debugger->Window, ReadMem->RequestId, &Index))
+    {
+        Debugger->NumberOfStaleResponses++;
+        return TRUE;
+    }
+
+    memcpy(Debugger->Pages + (SIZE_T)Index * TEST_TRANSPORT_PAGE_SIZE,
+           (UINT8 *)ReadMem + sizeof(DEBUGGER_READ_MEMORY),
+           TEST_TRANSPORT_PAGE_SIZE);
+
+    PipelineCompleteResponse(&Debugger->Window);
+
+    return TRUE;
+}
+
+/**
+ * @brief Read all of the pages from the simulated debuggee
+ *
+ * @param Debugger The state of the debugger
+ * @param WindowSize
+ * @param Milliseconds The time of the run
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestTransportRun(TEST_TRANSPORT_DEBUGGER * Debugger, UINT32 WindowSize, double * Milliseconds)
+{
+    return TestPipelineReadPages(&Debugger->Window,
+                                 WindowSize,
+                                 TestTransportPipelineSend,
+                                 TestTransportPipelineWait,
+                                 Debugger,
+                                 Debugger->Pages,
+                                 TEST_TRANSPORT_NUMBER_OF_READS,
+                                 TEST_TRANSPORT_PAGE_SIZE,
+                                 TestCommonFillPage,
+                                 Milliseconds);
+}
+
+/**
+ * @brief Send the fuzzed packets to the simulated debuggee
+ * @details Some of the packets are valid read packets with one changed
+ * byte, some of them are random and some random bytes are sent outside of
+ * the frames, none of them should be answered
+ *
+ * @param Debugger The state of the debugger
+ * @param NumberOfInvalidPackets The packets that should be rejected
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TestTransportFuzz(TEST_TRANSPORT_DEBUGGER * Debugger, UINT32 * NumberOfInvalidPackets)
+{
+    DEBUGGER_REMOTE_PACKET Packet;
+    DEBUGGER_READ_MEMORY   ReadMem;
+    UINT8 *                Buffer = Debugger->Buffer;
+    const VOID *           Buffers[1];
+    UINT32                 Lengths[1];
+    UINT32                 Length;
+
+    *NumberOfInvalidPackets = 0;
+
+    for (UINT32 i = 0; i < TEST_TRANSPORT_NUMBER_OF_FUZZED_PACKETS; i++)
+    {
+        switch (TestCommonRandom() % 3)
+        {
+        case 0:
+
+            //
+            // A valid read packet with one changed byte (also changes the checksum)
+            //
+            memset(&Packet, 0, sizeof(DEBUGGER_REMOTE_PACKET));
+            memset(&ReadMem, 0, sizeof(DEBUGGER_READ_MEMORY));
+
+            ReadMem.Address = TEST_TRANSPORT_BASE_ADDRESS;
+            ReadMem.Size    = TEST_TRANSPORT_PAGE_SIZE;
+
+            Packet.Indicator                  = INDICATOR_OF_HYPERDBG_PACKET;
+            Packet.TypeOfThePacket            = DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGER_TO_DEBUGGEE_EXECUTE_ON_VMX_ROOT;
+            Packet.RequestedActionOfThePacket = DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_READ_MEMORY;
+            Packet.Checksum                   = TestTransportChecksum(&Packet, &ReadMem, sizeof(DEBUGGER_READ_MEMORY));
+
+            Length = sizeof(DEBUGGER_REMOTE_PACKET) + sizeof(DEBUGGER_READ_MEMORY);
+
+            memcpy(Buffer, &Packet, sizeof(DEBUGGER_REMOTE_PACKET));
+            memcpy(Buffer + sizeof(DEBUGGER_REMOTE_PACKET), &ReadMem, sizeof(DEBUGGER_READ_MEMORY));
+
+            Buffer[TestCommonRandom() % Length] ^= (UINT8)(TestCommonRandom() % 0xff + 1);
+
+            break;
+
+        case 1:
+
+            //
+            // A random packet
+            //
+            Length = (UINT32)(TestCommonRandom() % TEST_TRANSPORT_MAXIMUM_PACKET_SIZE + 1);
+
+            for (UINT32 j = 0; j < Length; j++)
+            {
+                Buffer[j] = (UINT8)TestCommonRandom();
+            }
+
+            break;
+
+        default:
+
+            //
+            // Random bytes outside of the frames (skipped by the framing)
+            //
+            Length = (UINT32)(TestCommonRandom() % 64 + 1);
+
+            for (UINT32 j = 0; j < Length; j++)
+            {
+                Buffer[j] = (UINT8)TestCommonRandom();
+            }
+
+            if (!TransportSend(&Debugger->Side.Channel.Transport, Buffer, Length))
+            {
+                return FALSE;
+            }
+
+            continue;
+        }
+
+        Buffers[0] = Buffer;
+        Lengths[0] = Length;
+
+        if (!FramingSendBuffers(&Debugger->Side.Framing, Buffers, Lengths, 1))
+        {
+            return FALSE;
+        }
+
+        (*NumberOfInvalidPackets)++;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Test the protocol of the kernel debugger with a simulated debuggee
+ * over the socket transport (fuzzing, corruption on the wire and throughput)
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TestTransport()
+{
+    TEST_TRANSPORT_DEBUGGER * Debugger;
+    TEST_TRANSPORT_SIDE *     Debuggee;
+    std::thread               DebuggeeThread;
+    UINT8 *                   Expected = NULL;
+    DEBUGGER_READ_MEMORY *    ReadMem;
+    BOOLEAN                   IsCorrupted;
+    UINT32                    NumberOfInvalidPackets = 0;
+    double                    CorruptedTime          = 0;
+    double                    CorruptedPipelinedTime = 0;
+    double                    StopAndWaitTime        = 0;
+    double                    PipelinedTime          = 0;
+    double                    Megabytes;
+    BOOLEAN                   Result = FALSE;
+
+    Debugger = (TEST_TRANSPORT_DEBUGGER *)calloc(1, sizeof(TEST_TRANSPORT_DEBUGGER));
+    Debuggee = (TEST_TRANSPORT_SIDE *)calloc(1, sizeof(TEST_TRANSPORT_SIDE));
+    Expected = (UINT8 *)malloc(TEST_TRANSPORT_PAGE_SIZE);
+
+    if (Debugger == NULL || Debuggee == NULL || Expected == NULL)
+    {
+        free(Debugger);
+        free(Debuggee);
+        free(Expected);
+        return FALSE;
+    }
+
+    Debugger->Pages  = (UINT8 *)malloc((SIZE_T)TEST_TRANSPORT_NUMBER_OF_READS * TEST_TRANSPORT_PAGE_SIZE);
+    Debugger->Buffer = (UINT8 *)malloc(TEST_TRANSPORT_MAXIMUM_PACKET_SIZE);
+
+    if (Debugger->Pages == NULL || Debugger->Buffer == NULL ||
+        !TestCommonCreateLoopback(&Debugger->Side.Channel, &Debuggee->Channel))
+    {
+        cout << "[-] Could not create the loopback" << endl;
+        goto Exit;
+    }
+
+    FramingInitialize(&Debugger->Side.Framing,
+                      &Debugger->Side.Channel,
+                      TestCommonRead,
+                      TestCommonWrite,
+                      Debugger->Side.RetransmissionBuffer,
+                      sizeof(Debugger->Side.RetransmissionBuffer));
+
+    FramingInitialize(&Debuggee->Framing,
+                      &Debuggee->Channel,
+                      TestCommonRead,
+                      TestCommonWrite,
+                      Debuggee->RetransmissionBuffer,
+                      sizeof(Debuggee->RetransmissionBuffer));
+
+    PipelineInitialize(&Debugger->Window);
+
+    Debugger->Window.ResponseTimeout = TEST_TRANSPORT_RESPONSE_TIMEOUT;
+    Debugger->DroppedRequest         = TEST_TRANSPORT_NO_DROPPED_REQUEST;
+
+    DebuggeeThread = std::thread(TestTransportDebuggeeThread, Debuggee);
+
+    TestCommonSetSeed(0x4879706572446267);
+
+    //
+    // None of the fuzzed packets should be answered, and the next packet
+    // should be answered correctly
+    //
+    if (!TestTransportFuzz(Debugger, &NumberOfInvalidPackets) ||
+        !TestTransportSendRead(Debugger, TEST_TRANSPORT_BASE_ADDRESS, TEST_TRANSPORT_PAGE_SIZE, PIPELINE_REQUEST_ID_NOT_PIPELINED) ||
+        (ReadMem = TestTransportReceiveRead(Debugger, &IsCorrupted)) == NULL)
+    {
+        cout << "[-] The simulated debuggee didn't answer after the fuzzed packets" << endl;
+        goto Exit;
+    }
+
+    TestCommonFillPage(0, Expected, TEST_TRANSPORT_PAGE_SIZE);
+
+    if (memcmp((UINT8 *)ReadMem + sizeof(DEBUGGER_READ_MEMORY), Expected, TEST_TRANSPORT_PAGE_SIZE) != 0 ||
+        Debuggee->NumberOfRejectedPackets != NumberOfInvalidPackets ||
+        Debuggee->NumberOfAnsweredPackets != 1)
+    {
+        cout << "[-] The fuzzed packets are not rejected correctly (" << Debuggee->NumberOfRejectedPackets
+             << " of " << NumberOfInvalidPackets << ")" << endl;
+        goto Exit;
+    }
+
+    //
+    // Requests and responses are corrupted on the wire, while waiting for each
+    // response, the last frame is sent again (by a NAK)
+    //
+    Debugger->CorruptionInterval = TEST_TRANSPORT_CORRUPTION_INTERVAL;
+    Debuggee->CorruptionInterval = TEST_TRANSPORT_CORRUPTION_INTERVAL;
+
+    if (!TestTransportRun(Debugger, 1, &CorruptedTime))
+    {
+        goto Exit;
+    }
+
+    if (Debugger->Side.Framing.NumberOfRetransmittedFrames == 0 ||
+        Debuggee->Framing.NumberOfRetransmittedFrames == 0)
+    {
+        cout << "[-] The corrupted frames are not sent again" << endl;
+        goto Exit;
+    }
+
+    //
+    // In the pipelined run, the older frames could not be sent again, so the
+    // window sends the lost requests again, and the last request is dropped
+    // (no response is received after it, so it's only sent again on the timeout)
+    //
+    Debugger->DroppedRequest = TEST_TRANSPORT_NUMBER_OF_READS - 1;
+
+    if (!TestTransportRun(Debugger, TEST_TRANSPORT_WINDOW_SIZE, &CorruptedPipelinedTime))
+    {
+        goto Exit;
+    }
+
+    Debugger->CorruptionInterval     = 0;
+    Debuggee->CorruptionInterval     = 0;
+    Debugger->NumberOfStaleResponses = 0;
+
+    if (Debugger->Window.NumberOfResentRequests == 0 ||
+        Debugger->DroppedRequest != TEST_TRANSPORT_NO_DROPPED_REQUEST)
+    {
+        cout << "[-] The lost requests are not sent again" << endl;
+        goto Exit;
+    }
+
+    //
+    // The throughput of the socket transport
+    //
+    if (!TestTransportRun(Debugger, 1, &StopAndWaitTime) ||
+        !TestTransportRun(Debugger, TEST_TRANSPORT_WINDOW_SIZE, &PipelinedTime))
+    {
+        goto Exit;
+    }
+
+    if (Debugger->NumberOfStaleResponses != 0)
+    {
+        cout << "[-] Stale responses are received" << endl;
+        goto Exit;
+    }
+
+    Megabytes = (double)TEST_TRANSPORT_NUMBER_OF_READS * TEST_TRANSPORT_PAGE_SIZE / (1024 * 1024);
+
+    printf("[*] %u fuzzed packets rejected, %llu + %llu frames sent again, %llu requests sent again\n",
+           NumberOfInvalidPackets,
+           Debugger->Side.Framing.NumberOfRetransmittedFrames,
+           Debuggee->Framing.NumberOfRetransmittedFrames,
+           Debugger->Window.NumberOfResentRequests);
+
+    printf("[*] %u pages over sockets, corrupted: %.1f MB/s (window of %u: %.1f MB/s), window of 1: %.1f MB/s, window of %u: %.1f MB/s\n",
+           TEST_TRANSPORT_NUMBER_OF_READS,
+           Megabytes * 1000.0 / CorruptedTime,
+           TEST_TRANSPORT_WINDOW_SIZE,
+           Megabytes * 1000.0 / CorruptedPipelinedTime,
+           Megabytes * 1000.0 / StopAndWaitTime,
+           TEST_TRANSPORT_WINDOW_SIZE,
+           Megabytes * 1000.0 / PipelinedTime);
+
+    Result = TRUE;
+
+Exit:
+
+    //
+    // Closing the socket of the debugger stops the simulated debuggee
+    //
+    TransportClose(&Debugger->Side.Channel.Transport);
+
+    if (DebuggeeThread.joinable())
+    {
+        DebuggeeThread.join();
+    }
+
+    TransportClose(&Debuggee->Channel.Transport);
+
+    free(Debugger->Pages);
+    free(Debugger->Buffer);
+    free(Debugger);
+    free(Debuggee);
+    free(Expected);
+
+    return Result;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file test-common.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief header for the shared routines of the tests (the loopback, the
+ * content of the pages and the pseudo-random generator)
+ * @details
+ * @version 0.14
+ * @date 2025-07-20
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Structures                  //
+//////////////////////////////////////////////////
+
+/**
+ * @brief One side of the loopback (the context of the read and the write
+ * routines of the framing)
+ *
+ */
+typedef struct _TEST_COMMON_CHANNEL
+{
+    TRANSPORT       Transport;
+    BOOLEAN         CorruptNextWrite;       // The last byte of the next write is changed
+    volatile LONG * SendLock;               // If set, the writes should hold this lock
+    UINT32          NumberOfUnlockedWrites; // Writes without holding the send lock
+
+} TEST_COMMON_CHANNEL, *PTEST_COMMON_CHANNEL;
+
+//////////////////////////////////////////////////
+//					 Functions                  //
+//////////////////////////////////////////////////
+
+BOOLEAN
+TestCommonCreateLoopback(TEST_COMMON_CHANNEL * First, TEST_COMMON_CHANNEL * Second);
+
+BOOLEAN
+TestCommonRead(PVOID Context, VOID * Buffer, UINT32 Length);
+
+BOOLEAN
+TestCommonWrite(PVOID Context, const VOID * Buffer, UINT32 Length);
+
+VOID
+TestCommonFillPage(UINT32 Index, UINT8 * Buffer, UINT32 Length);
+
+VOID
+TestCommonSetSeed(UINT64 Seed);
+
+UINT64
+TestCommonRandom();
@@ -0,0 +1,38 @@
+/**
+ * @file test-pipeline.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief header for the shared routines of the pipelined tests
+ * @details
+ * @version 0.14
+ * @date 2025-07-09
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Definitions                 //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Generate the expected content of a page
+ *
+ */
+typedef VOID (*TEST_PIPELINE_FILL_ROUTINE)(UINT32 Index, UINT8 * Buffer, UINT32 Length);
+
+//////////////////////////////////////////////////
+//					 Functions                  //
+//////////////////////////////////////////////////
+
+BOOLEAN
+TestPipelineReadPages(PIPELINE_WINDOW *          Window,
+                      UINT32                     WindowSize,
+                      PIPELINE_SEND_ROUTINE      SendRoutine,
+                      PIPELINE_WAIT_ROUTINE      WaitRoutine,
+                      PVOID                      Context,
+                      UINT8 *                    Pages,
+                      UINT32                     NumberOfPages,
+                      UINT32                     PageSize,
+                      TEST_PIPELINE_FILL_ROUTINE FillRoutine,
+                      double *                   Milliseconds);
@@ -20,3 +20,24 @@ TestCommandParser();
 
 BOOLEAN
 TestSemanticScripts();
+
+BOOLEAN
+TestCompression();
+
+BOOLEAN
+TestFraming();
+
+BOOLEAN
+TestPipeline();
+
+BOOLEAN
+TestSearch();
+
+BOOLEAN
+TestTransport();
+
+BOOLEAN
+TestRing();
+
+BOOLEAN
+TestScriptEngine();
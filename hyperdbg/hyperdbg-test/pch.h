@@ -24,23 +24,44 @@ using namespace std;
 //
 // General Headers
 //
-#include <Windows.h>
+#ifdef ENV_WINDOWS
+#    include <winsock2.h>
+#    include <ws2tcpip.h>
+#    include <Windows.h>
+#    include <conio.h>
+#else
+#    include "platform/user/header/Posix.h"
+#    include <sys/socket.h>
+#    include <sys/ioctl.h>
+#    include <sys/select.h>
+#    include <netinet/in.h>
+#    include <netinet/tcp.h>
+#    include <netdb.h>
+#    include <unistd.h>
+#endif
 #include <iostream>
 #include <string>
-#include <conio.h>
 #include <vector>
 #include <regex>
 #include <sstream>
 #include <iomanip>
 #include <fstream>
 #include <filesystem>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
 
 //
 // Program Defined Headers
 //
 #include "SDK/HyperDbgSdk.h"
 #include "Definition.h"
-#include "../hyperdbg-test/header/namedpipe.h"
+#ifdef ENV_WINDOWS
+#    include "../hyperdbg-test/header/namedpipe.h"
+#endif
 #include "../hyperdbg-test/header/routines.h"
 #include "../hyperdbg-test/header/testcases.h"
 
@@ -50,6 +71,62 @@ using namespace std;
 #include "../hyperdbg-test/header/hwdbg-tests.h"
 
 //
-// import libhyperdbg
+// Cross platform atomic operations and clock of the components
 //
-#include "SDK/imports/user/HyperDbgLibImports.h"
+#include "platform/user/header/Atomic.h"
+#include "platform/user/header/Clock.h"
+
+//
+// Compression component
+//
+#include "components/compression/header/Compression.h"
+
+//
+// Framing component
+//
+#include "components/framing/header/Framing.h"
+
+//
+// Pipeline component
+//
+#include "components/pipeline/header/Pipeline.h"
+
+//
+// Search component
+//
+#include "components/search/header/Search.h"
+
+//
+// Transport component
+//
+#include "components/transport/header/Transport.h"
+#include "components/transport/header/TransportBackends.h"
+
+//
+// Ring component
+//
+#include "components/ring/header/Ring.h"
+
+//
+// Shared routines of the tests
+//
+#include "../hyperdbg-test/header/test-common.h"
+
+//
+// Shared routines of the pipelined tests
+//
+#include "../hyperdbg-test/header/test-pipeline.h"
+
+//
+// Need to link with Ws2_32.lib for the socket transport
+//
+#ifdef ENV_WINDOWS
+#    pragma comment(lib, "Ws2_32.lib")
+#endif
+
+//
+// import libhyperdbg (only available on Windows)
+//
+#ifdef ENV_WINDOWS
+#    include "SDK/imports/user/HyperDbgLibImports.h"
+#endif
@@ -110,6 +110,25 @@ LogCallbackCheckIfBufferIsFull(BOOLEAN Priority)
     return g_Callbacks.LogCallbackCheckIfBufferIsFull(Priority);
 }
 
+/**
+ * @brief routines callback for sending the expired accumulated messages
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+LogCallbackFlushExpiredMessages()
+{
+    if (g_Callbacks.LogCallbackFlushExpiredMessages == NULL)
+    {
+        //
+        // Ignore flushing messages
+        //
+        return FALSE;
+    }
+
+    return g_Callbacks.LogCallbackFlushExpiredMessages();
+}
+
 /**
  * @brief routines callback for sending buffer
  * @param OperationCode
@@ -358,6 +358,12 @@ VmxVmexitHandler(_Inout_ PGUEST_REGS GuestRegs)
         Result = TRUE;
     }
 
+    //
+    // Send the accumulated messages of this core if they waited too long,
+    // vmx-root messages can only be sent by the core itself
+    //
+    LogCallbackFlushExpiredMessages();
+
     //
     // Set indicator of Vmx non root mode to false
     //
@@ -34,6 +34,9 @@ LogCallbackSendMessageToQueue(UINT32  OperationCode,
 BOOLEAN
 LogCallbackCheckIfBufferIsFull(BOOLEAN Priority);
 
+BOOLEAN
+LogCallbackFlushExpiredMessages();
+
 BOOLEAN
 LogCallbackSendBuffer(_In_ UINT32                          OperationCode,
                       _In_reads_bytes_(BufferLength) PVOID Buffer,
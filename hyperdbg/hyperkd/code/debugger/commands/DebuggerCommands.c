@@ -662,6 +662,103 @@ DebuggerCommandEditMemoryVmxRoot(PDEBUGGER_EDIT_MEMORY EditMemRequest)
     return TRUE;
 }
 
+/**
+ * @brief Save (or show) a matched address of searching the memory
+ * @details All of the matches are counted, but only the first
+ * MaximumSearchResults addresses are saved (or shown)
+ *
+ * @param Context The match context (SEARCH_MEMORY_MATCH_CONTEXT)
+ * @param Address The matched address
+ * @param PatternIndex Index of the matched pattern
+ * @return BOOLEAN Whether the search should be continued or not
+ */
+static BOOLEAN
+SearchAddressSaveMatch(PVOID Context, UINT64 Address, UINT32 PatternIndex)
+{
+    PSEARCH_MEMORY_MATCH_CONTEXT MatchContext = (PSEARCH_MEMORY_MATCH_CONTEXT)Context;
+    UINT64                       Result       = Address;
+
+    UNREFERENCED_PARAMETER(PatternIndex);
+
+    if (MatchContext->CountOfMatchedCases < MaximumSearchResults)
+    {
+        if (MatchContext->MemoryType == SEARCH_PHYSICAL_FROM_VIRTUAL_MEMORY)
+        {
+            //
+            // It's a physical memory
+            //
+            Result = VirtualAddressToPhysicalAddress((PVOID)Address);
+        }
+
+        if (MatchContext->IsDebuggeePaused)
+        {
+            Log("%llx\n", Result);
+        }
+        else
+        {
+            MatchContext->AddressToSaveResults[MatchContext->CountOfMatchedCases] = Result;
+        }
+    }
+
+    MatchContext->CountOfMatchedCases++;
+
+    return TRUE;
+}
+
+/**
+ * @brief Make the patterns of the search request
+ * @details The chunks of the request are divided between the patterns
+ * based on the length of each pattern, if there is no pattern length
+ * then all of the chunks are one pattern
+ *
+ * @param Patterns The patterns to fill
+ * @param SearchMemRequest request structure of searching memory
+ * @param LengthOfEachChunk Size of each element
+ * @return BOOLEAN Whether the patterns are valid or not
+ */
+static BOOLEAN
+SearchAddressBuildPatterns(SEARCH_PATTERNS *       Patterns,
+                           PDEBUGGER_SEARCH_MEMORY SearchMemRequest,
+                           UINT32                  LengthOfEachChunk)
+{
+    UINT64 * Chunks        = (UINT64 *)((UINT64)SearchMemRequest + SIZEOF_DEBUGGER_SEARCH_MEMORY);
+    UINT32   CountOfChunks = 0;
+    UINT32   PatternLength = 0;
+
+    if (!SearchInitializePatterns(Patterns, LengthOfEachChunk))
+    {
+        return FALSE;
+    }
+
+    if (SearchMemRequest->CountOfPatterns == 0)
+    {
+        return SearchAddPattern(Patterns, Chunks, SearchMemRequest->CountOf64Chunks);
+    }
+
+    if (SearchMemRequest->CountOfPatterns > MaximumSearchPatterns)
+    {
+        return FALSE;
+    }
+
+    for (UINT32 i = 0; i < SearchMemRequest->CountOfPatterns; i++)
+    {
+        PatternLength = SearchMemRequest->PatternLengths[i];
+
+        if (PatternLength > SearchMemRequest->CountOf64Chunks - CountOfChunks ||
+            !SearchAddPattern(Patterns, &Chunks[CountOfChunks], PatternLength))
+        {
+            return FALSE;
+        }
+
+        CountOfChunks += PatternLength;
+    }
+
+    //
+    // All of the chunks should be used by the patterns
+    //
+    return CountOfChunks == SearchMemRequest->CountOf64Chunks;
+}
+
 /**
  * @brief Search on virtual memory (not work on physical memory)
  *
@@ -671,13 +768,18 @@ DebuggerCommandEditMemoryVmxRoot(PDEBUGGER_EDIT_MEMORY EditMemRequest)
  * instead call : SearchAddressWrapper
  * the address between StartAddress and EndAddress should be contiguous
  *
+ * The memory is read in blocks (plus the bytes after each block that
+ * might be a part of a pattern) and each block is searched for all of
+ * the patterns at once
+ *
  * @param AddressToSaveResults Address to save the search results
  * @param SearchMemRequest request structure of searching memory
  * @param StartAddress valid start address based on target process
  * @param EndAddress valid end address based on target process
  * @param IsDebuggeePaused Set to true when the search is performed in
  * the debugger mode
- * @param CountOfMatchedCases Number of matched cases
+ * @param CountOfMatchedCases Number of matched cases (might be more
+ * than the saved results)
  * @return BOOLEAN Whether the search was successful or not
  */
 BOOLEAN
@@ -688,15 +790,15 @@ PerformSearchAddress(UINT64 *                AddressToSaveResults,
                      BOOLEAN                 IsDebuggeePaused,
                      PUINT32                 CountOfMatchedCases)
 {
-    UINT32   CountOfOccurance      = 0;
-    UINT64   Cmp64                 = 0;
-    UINT32   IndexToArrayOfResults = 0;
-    UINT32   LengthOfEachChunk     = 0;
-    PVOID    TempSourceAddress     = 0;
-    PVOID    SourceAddress         = 0;
-    BOOLEAN  StillMatch            = FALSE;
-    UINT64   TempValue             = (UINT64)NULL;
-    CR3_TYPE CurrentProcessCr3     = {0};
+    SEARCH_MEMORY_MATCH_CONTEXT MatchContext      = {0};
+    PSEARCH_MEMORY_WORKSPACE    Workspace         = NULL;
+    UINT32                      LengthOfEachChunk = 0;
+    UINT64                      CurrentAddress    = 0;
+    UINT64                      ReadableEnd       = 0;
+    UINT32                      ScanLength        = 0;
+    UINT32                      ReadLength        = 0;
+    BOOLEAN                     Result            = FALSE;
+    CR3_TYPE                    CurrentProcessCr3 = {0};
 
     //
     // set chunk size in each modification
@@ -724,229 +826,163 @@ PerformSearchAddress(UINT64 *                AddressToSaveResults,
     //
     // Check if address is virtual address or physical address
     //
-    if (SearchMemRequest->MemoryType == SEARCH_VIRTUAL_MEMORY ||
-        SearchMemRequest->MemoryType == SEARCH_PHYSICAL_FROM_VIRTUAL_MEMORY)
+    if (SearchMemRequest->MemoryType == SEARCH_PHYSICAL_MEMORY)
     {
         //
-        // Search the memory
+        // That's an error, the physical memory is handled like virtual memory and
+        // thus we should never reach here
         //
+        LogError("Err, searching physical memory is not allowed without virtual address");
 
+        return FALSE;
+    }
+    else if (SearchMemRequest->MemoryType != SEARCH_VIRTUAL_MEMORY &&
+             SearchMemRequest->MemoryType != SEARCH_PHYSICAL_FROM_VIRTUAL_MEMORY)
+    {
         //
-        // Change the memory layout (cr3), if the user specified a
-        // special process
+        // Invalid parameter
         //
-        if (IsDebuggeePaused)
-        {
-            //
-            // Switch to target process memory layout
-            //
-            CurrentProcessCr3 = SwitchToProcessMemoryLayoutByCr3(LayoutGetCurrentProcessCr3());
-        }
-        else
+        return FALSE;
+    }
+
+    //
+    // Nothing could be allocated while the debuggee is paused, so the
+    // preallocated workspace is used
+    //
+    if (IsDebuggeePaused)
+    {
+        Workspace = g_SearchMemoryWorkspace;
+    }
+    else
+    {
+        Workspace = PlatformMemAllocateNonPagedPool(sizeof(SEARCH_MEMORY_WORKSPACE));
+    }
+
+    if (Workspace == NULL)
+    {
+        return FALSE;
+    }
+
+    if (!SearchAddressBuildPatterns(&Workspace->Patterns, SearchMemRequest, LengthOfEachChunk))
+    {
+        //
+        // Invalid patterns
+        //
+        goto Exit;
+    }
+
+    MatchContext.AddressToSaveResults = AddressToSaveResults;
+    MatchContext.MemoryType           = SearchMemRequest->MemoryType;
+    MatchContext.IsDebuggeePaused     = IsDebuggeePaused;
+
+    //
+    // Change the memory layout (cr3), if the user specified a
+    // special process
+    //
+    if (IsDebuggeePaused)
+    {
+        //
+        // Switch to target process memory layout
+        //
+        CurrentProcessCr3 = SwitchToProcessMemoryLayoutByCr3(LayoutGetCurrentProcessCr3());
+    }
+    else
+    {
+        if (SearchMemRequest->ProcessId != HANDLE_TO_UINT32(PsGetCurrentProcessId()))
         {
-            if (SearchMemRequest->ProcessId != HANDLE_TO_UINT32(PsGetCurrentProcessId()))
-            {
-                CurrentProcessCr3 = SwitchToProcessMemoryLayout(SearchMemRequest->ProcessId);
-            }
+            CurrentProcessCr3 = SwitchToProcessMemoryLayout(SearchMemRequest->ProcessId);
         }
+    }
 
+    //
+    // The bytes after the end address are read (for the patterns that start
+    // before it) until the end of its page, the lengths are computed as the
+    // differences so the end of the address space is not a problem
+    //
+    if (StartAddress < EndAddress)
+    {
+        ReadableEnd = (UINT64)PAGE_ALIGN(EndAddress - 1) + PAGE_SIZE;
+    }
+
+    for (CurrentAddress = StartAddress; CurrentAddress < EndAddress; CurrentAddress += ScanLength)
+    {
         //
-        // Here we iterate through the buffer we received from
-        // user-mode
+        // The block size is a multiple of all of the chunk sizes, so the patterns are
+        // still checked on the same positions as the previous blocks
         //
-        SourceAddress = (PVOID)((UINT64)SearchMemRequest + SIZEOF_DEBUGGER_SEARCH_MEMORY);
+        ScanLength = SEARCH_MEMORY_BLOCK_SIZE;
 
-        for (size_t BaseIterator = (size_t)StartAddress; BaseIterator < ((UINT64)EndAddress); BaseIterator += LengthOfEachChunk)
+        if (ScanLength > EndAddress - CurrentAddress)
         {
-            //
-            // *** Search the memory ***
-            //
+            ScanLength = (UINT32)(EndAddress - CurrentAddress);
+        }
 
-            //
-            // Copy 64bit, 32bit or one byte value into Cmp64 buffer and then compare it
-            // Check if we should access the memory directly, or through safe memory
-            // routine from vmx-root
-            //
-            if (IsDebuggeePaused)
-            {
-                MemoryMapperReadMemorySafe((UINT64)BaseIterator, &Cmp64, LengthOfEachChunk);
-            }
-            else
-            {
-                RtlCopyMemory(&Cmp64, (PVOID)BaseIterator, LengthOfEachChunk);
-            }
+        ReadLength = ScanLength + Workspace->Patterns.MaximumLength - LengthOfEachChunk;
 
-            //
-            // Get the searching bytes
-            //
-            TempValue = *(UINT64 *)SourceAddress;
+        if (ReadLength > ReadableEnd - CurrentAddress)
+        {
+            ReadLength = (UINT32)(ReadableEnd - CurrentAddress);
+        }
 
-            //
-            // Check whether the byte matches the source or not
-            //
-            if (Cmp64 == TempValue)
+        //
+        // Check if we should access the memory directly, or through safe memory
+        // routine from vmx-root
+        //
+        if (IsDebuggeePaused)
+        {
+            if (!MemoryMapperReadMemorySafe(CurrentAddress, Workspace->Buffer, ReadLength))
             {
                 //
-                // Indicate that it matches until now
+                // The bytes after the block are not valid, only the block is searched
                 //
-                StillMatch = TRUE;
+                ReadLength = ScanLength;
 
-                //
-                // Try to check each element (we don't start from the very first element as
-                // it checked before )
-                //
-                for (size_t i = LengthOfEachChunk; i < SearchMemRequest->CountOf64Chunks; i++)
+                if (!MemoryMapperReadMemorySafe(CurrentAddress, Workspace->Buffer, ReadLength))
                 {
                     //
-                    // I know, we have a double check here ;)
+                    // The search stops at the first invalid page
                     //
-                    TempSourceAddress = (PVOID)((UINT64)SearchMemRequest + SIZEOF_DEBUGGER_SEARCH_MEMORY + (i * sizeof(UINT64)));
-
-                    //
-                    // Add i to BaseIterator and recompute the Cmp64
-                    // Check if we should access the memory directly, or through safe memory
-                    // routine from vmx-root
-                    //
-                    if (IsDebuggeePaused)
-                    {
-                        MemoryMapperReadMemorySafe((UINT64)(BaseIterator + (LengthOfEachChunk * i)), &Cmp64, LengthOfEachChunk);
-                    }
-                    else
-                    {
-                        RtlCopyMemory(&Cmp64, (PVOID)(BaseIterator + (LengthOfEachChunk * i)), LengthOfEachChunk);
-                    }
-
-                    //
-                    // Check if we should access the memory directly,
-                    // or through safe memory routine from vmx-root
-                    //
-                    if (IsDebuggeePaused)
-                    {
-                        MemoryMapperReadMemorySafe((UINT64)TempSourceAddress, &TempValue, sizeof(UINT64));
-                    }
-                    else
-                    {
-                        TempValue = *(UINT64 *)TempSourceAddress;
-                    }
-
-                    if (!(Cmp64 == TempValue))
-                    {
-                        //
-                        // One thing didn't match so this is not the pattern
-                        //
-                        StillMatch = FALSE;
-
-                        //
-                        // Break from the loop
-                        //
-                        break;
-                    }
-                }
-
-                //
-                // Check if we find the pattern or not
-                //
-                if (StillMatch)
-                {
-                    //
-                    // We found the a matching address, let's save the
-                    // address for future use
-                    //
-                    CountOfOccurance++;
-
-                    if (IsDebuggeePaused)
-                    {
-                        if (SearchMemRequest->MemoryType == SEARCH_PHYSICAL_FROM_VIRTUAL_MEMORY)
-                        {
-                            //
-                            // It's a physical memory
-                            //
-                            Log("%llx\n", VirtualAddressToPhysicalAddress((PVOID)BaseIterator));
-                        }
-                        else
-                        {
-                            //
-                            // It's a virtual memory
-                            //
-                            Log("%llx\n", BaseIterator);
-                        }
-                    }
-                    else
-                    {
-                        if (SearchMemRequest->MemoryType == SEARCH_PHYSICAL_FROM_VIRTUAL_MEMORY)
-                        {
-                            //
-                            // It's a physical memory
-                            //
-                            AddressToSaveResults[IndexToArrayOfResults] = VirtualAddressToPhysicalAddress((PVOID)BaseIterator);
-                        }
-                        else
-                        {
-                            //
-                            // It's a virtual memory
-                            //
-                            AddressToSaveResults[IndexToArrayOfResults] = BaseIterator;
-                        }
-                    }
-
-                    //
-                    // Increase the array pointer if it doesn't exceed the limitation
-                    //
-                    if (MaximumSearchResults > IndexToArrayOfResults)
-                    {
-                        IndexToArrayOfResults++;
-                    }
-                    else
-                    {
-                        //
-                        // The result buffer is full!
-                        //
-                        *CountOfMatchedCases = CountOfOccurance;
-                        return TRUE;
-                    }
+                    break;
                 }
             }
-            else
-            {
-                //
-                // Not found in the place
-                //
-                continue;
-            }
         }
-
-        //
-        // Restore the previous memory layout (cr3), if the user specified a
-        // special process
-        //
-        if (IsDebuggeePaused || SearchMemRequest->ProcessId != HANDLE_TO_UINT32(PsGetCurrentProcessId()))
+        else
         {
-            SwitchToPreviousProcess(CurrentProcessCr3);
+            RtlCopyMemory(Workspace->Buffer, (PVOID)CurrentAddress, ReadLength);
         }
-    }
-    else if (SearchMemRequest->MemoryType == SEARCH_PHYSICAL_MEMORY)
-    {
-        //
-        // That's an error, the physical memory is handled like virtual memory and
-        // thus we should never reach here
-        //
-        LogError("Err, searching physical memory is not allowed without virtual address");
 
-        return FALSE;
+        SearchScanBlock(&Workspace->Patterns,
+                        Workspace->Buffer,
+                        ScanLength,
+                        ReadLength,
+                        CurrentAddress,
+                        SearchAddressSaveMatch,
+                        &MatchContext);
     }
-    else
+
+    //
+    // Restore the previous memory layout (cr3), if the user specified a
+    // special process
+    //
+    if (IsDebuggeePaused || SearchMemRequest->ProcessId != HANDLE_TO_UINT32(PsGetCurrentProcessId()))
     {
-        //
-        // Invalid parameter
-        //
-        return FALSE;
+        SwitchToPreviousProcess(CurrentProcessCr3);
     }
 
     //
     // As we're here the search is finished without error
     //
-    *CountOfMatchedCases = CountOfOccurance;
-    return TRUE;
+    *CountOfMatchedCases = MatchContext.CountOfMatchedCases;
+    Result               = TRUE;
+
+Exit:
+
+    if (!IsDebuggeePaused)
+    {
+        PlatformMemFreePool(Workspace);
+    }
+
+    return Result;
 }
 
 /**
@@ -1057,6 +1093,14 @@ SearchAddressWrapper(PUINT64                 AddressToSaveResults,
         //
         SwitchToPreviousProcess(CurrentProcessCr3);
 
+        //
+        // The search is stopped at the first page that is not valid
+        //
+        if (StartAddress < EndAddress)
+        {
+            EndAddress = StartAddress;
+        }
+
         //
         // All of the address chunk was valid
         //
@@ -1191,11 +1235,19 @@ DebuggerCommandSearchMemory(PDEBUGGER_SEARCH_MEMORY SearchMemRequest)
     // In this point, we to store the results (if any) to the user-mode
     // buffer SearchMemRequest itself is the user-mode buffer and we also
     // checked from the previous function that the output buffer is at
-    // least SearchMemRequest bigger or equal to MaximumSearchResults * sizeof(UINT64)
+    // least SearchMemRequest bigger or equal to SIZEOF_DEBUGGER_SEARCH_MEMORY_RESULTS
     // so we need to clear everything here, and also we should keep in mind that
     // SearchMemRequest is no longer valid
     //
-    RtlZeroMemory(SearchMemRequest, MaximumSearchResults * sizeof(UINT64));
+    RtlZeroMemory(SearchMemRequest, SIZEOF_DEBUGGER_SEARCH_MEMORY_RESULTS);
+
+    //
+    // The number of all of the matched addresses is saved after the results,
+    // so the user-mode knows whether the results are truncated or not, the
+    // caller should allocate MaximumSearchResults + 1 entries (the size of
+    // the output buffer is checked against SIZEOF_DEBUGGER_SEARCH_MEMORY_RESULTS)
+    //
+    UsermodeBuffer[MaximumSearchResults] = CountOfResults;
 
     //
     // It's time to move the results from our temporary buffer to the user-mode
@@ -1382,6 +1434,13 @@ DebuggerCommandReservePreallocatedPools(PDEBUGGER_PREALLOC_COMMAND PreallocReque
                                      PreallocRequest->Count,
                                      INSTANT_REGULAR_EVENT_ACTION_BUFFER);
 
+        //
+        // Request pages to be allocated for publishing the dispatch tables of events
+        //
+        PoolManagerRequestAllocation(INSTANT_EVENT_DISPATCH_TABLE_BUFFER,
+                                     PreallocRequest->Count * INSTANT_EVENT_DISPATCH_TABLES_PER_EVENT,
+                                     INSTANT_EVENT_DISPATCH_TABLE);
+
         break;
 
     case DEBUGGER_PREALLOC_COMMAND_TYPE_BIG_EVENT:
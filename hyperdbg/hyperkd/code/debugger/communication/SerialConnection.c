@@ -11,6 +11,139 @@
  */
 #include "pch.h"
 
+//////////////////////////////////////////////////
+//				   UART Transport				//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Send bytes to the UART
+ *
+ * @param Transport
+ * @param Buffer
+ * @param Length
+ * @return BOOLEAN
+ */
+static BOOLEAN
+SerialConnectionTransportSend(TRANSPORT * Transport, const VOID * Buffer, UINT32 Length)
+{
+    const UCHAR * Bytes = (const UCHAR *)Buffer;
+
+    UNREFERENCED_PARAMETER(Transport);
+
+    for (UINT32 i = 0; i < Length; i++)
+    {
+        KdHyperDbgSendByte(Bytes[i], TRUE);
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Receive the bytes that are available on the UART
+ * @details The UART only provides one byte at a time, BytesReceived is zero
+ * if no byte is available
+ *
+ * @param Transport
+ * @param Buffer
+ * @param Length
+ * @param BytesReceived
+ * @return BOOLEAN
+ */
+static BOOLEAN
+SerialConnectionTransportReceive(TRANSPORT * Transport, VOID * Buffer, UINT32 Length, UINT32 * BytesReceived)
+{
+    UCHAR * Bytes = (UCHAR *)Buffer;
+    UINT32  Index = 0;
+
+    UNREFERENCED_PARAMETER(Transport);
+
+    while (Index < Length && KdHyperDbgRecvByte(&Bytes[Index]))
+    {
+        Index++;
+    }
+
+    *BytesReceived = Index;
+
+    return TRUE;
+}
+
+/**
+ * @brief Discard the bytes that are available on the UART
+ *
+ * @param Transport
+ * @return VOID
+ */
+static VOID
+SerialConnectionTransportFlush(TRANSPORT * Transport)
+{
+    UCHAR Byte;
+
+    UNREFERENCED_PARAMETER(Transport);
+
+    while (KdHyperDbgRecvByte(&Byte))
+    {
+    }
+}
+
+/**
+ * @brief Wait until a byte becomes available on the UART
+ *
+ * @param Transport
+ * @param Timeout In milliseconds (or TRANSPORT_WAIT_INFINITE)
+ * @return BOOLEAN
+ */
+static BOOLEAN
+SerialConnectionTransportPoll(TRANSPORT * Transport, UINT32 Timeout)
+{
+    UINT32 Elapsed = 0;
+
+    UNREFERENCED_PARAMETER(Transport);
+
+    while (!KdHyperDbgRecvReady())
+    {
+        if (Timeout != TRANSPORT_WAIT_INFINITE)
+        {
+            if (Elapsed == Timeout)
+            {
+                return FALSE;
+            }
+
+            KeStallExecutionProcessor(1000);
+            Elapsed++;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Close the UART (the port remains prepared for the next connection)
+ *
+ * @param Transport
+ * @return VOID
+ */
+static VOID
+SerialConnectionTransportClose(TRANSPORT * Transport)
+{
+    UNREFERENCED_PARAMETER(Transport);
+}
+
+/**
+ * @brief The routines of the UART
+ *
+ */
+static const TRANSPORT_ROUTINES SerialConnectionTransportRoutines = {
+    SerialConnectionTransportSend,
+    SerialConnectionTransportReceive,
+    SerialConnectionTransportFlush,
+    SerialConnectionTransportPoll,
+    SerialConnectionTransportClose,
+};
+
+//////////////////////////////////////////////////
+//					 Functions					//
+//////////////////////////////////////////////////
+
 /**
  * @brief A simple connection test
  *
@@ -33,13 +166,71 @@ SerialConnectionTest()
 VOID
 SerialConnectionSendEndOfBuffer()
 {
+    const UCHAR EndOfBuffer[SERIAL_END_OF_BUFFER_CHARS_COUNT] = {SERIAL_END_OF_BUFFER_CHAR_1,
+                                                                 SERIAL_END_OF_BUFFER_CHAR_2,
+                                                                 SERIAL_END_OF_BUFFER_CHAR_3,
+                                                                 SERIAL_END_OF_BUFFER_CHAR_4};
+
     //
     // Send the end buffer
     //
-    KdHyperDbgSendByte(SERIAL_END_OF_BUFFER_CHAR_1, TRUE);
-    KdHyperDbgSendByte(SERIAL_END_OF_BUFFER_CHAR_2, TRUE);
-    KdHyperDbgSendByte(SERIAL_END_OF_BUFFER_CHAR_3, TRUE);
-    KdHyperDbgSendByte(SERIAL_END_OF_BUFFER_CHAR_4, TRUE);
+    TransportSend(&g_KdTransport, EndOfBuffer, sizeof(EndOfBuffer));
+}
+
+/**
+ * @brief Read bytes from the serial port (used as the read routine of framing)
+ * @details The whole length is read without checking each byte for the end
+ * of buffer characters
+ *
+ * @param Context The transport
+ * @param Buffer
+ * @param Length
+ * @return BOOLEAN
+ */
+static BOOLEAN
+SerialConnectionReadBytes(PVOID Context, VOID * Buffer, UINT32 Length)
+{
+    return TransportReceiveAll((TRANSPORT *)Context, Buffer, Length);
+}
+
+/**
+ * @brief Write bytes to the serial port (used as the write routine of framing)
+ *
+ * @param Context The transport
+ * @param Buffer
+ * @param Length
+ * @return BOOLEAN
+ */
+static BOOLEAN
+SerialConnectionWriteBytes(PVOID Context, const VOID * Buffer, UINT32 Length)
+{
+    return TransportSend((TRANSPORT *)Context, Buffer, Length);
+}
+
+/**
+ * @brief Send up to 3 buffers as one frame
+ * @details Should be called while DebuggerResponseLock is held
+ *
+ * @param Buffer1 buffer to send
+ * @param Length1 length of buffer to send
+ * @param Buffer2 buffer to send (optional)
+ * @param Length2 length of buffer to send
+ * @param Buffer3 buffer to send (optional)
+ * @param Length3 length of buffer to send
+ * @return BOOLEAN
+ */
+static BOOLEAN
+SerialConnectionSendFrame(CHAR * Buffer1,
+                          UINT32 Length1,
+                          CHAR * Buffer2,
+                          UINT32 Length2,
+                          CHAR * Buffer3,
+                          UINT32 Length3)
+{
+    const VOID * Buffers[3] = {Buffer1, Buffer2, Buffer3};
+    UINT32       Lengths[3] = {Length1, Length2, Length3};
+
+    return FramingSendBuffers(&g_KdFramingTransport, Buffers, Lengths, 3);
 }
 
 /**
@@ -101,14 +292,40 @@ SerialConnectionRecvBuffer(CHAR *   BufferToSave,
 {
     UINT32 Loop = 0;
 
+    //
+    // In the framed protocol, the header is read and then the whole payload
+    //
+    if (g_KdFramedPackets)
+    {
+        FRAMING_STATUS Status;
+
+        //
+        // A NAK is sent for a corrupted frame, so the next frame is the retransmitted one
+        //
+        do
+        {
+            Status = FramingReceive(&g_KdFramingTransport, BufferToSave, MaxSerialPacketSize, LengthReceived);
+
+        } while (Status == FRAMING_STATUS_INVALID_CHECKSUM);
+
+        if (Status != FRAMING_STATUS_SUCCESS)
+        {
+            LogError("Err, invalid frame received in debuggee");
+            return FALSE;
+        }
+
+        return TRUE;
+    }
+
     //
     // Read data and store in a buffer
     //
     while (TRUE)
     {
-        UCHAR RecvChar = NULL_ZERO;
+        UCHAR  RecvChar      = NULL_ZERO;
+        UINT32 BytesReceived = 0;
 
-        if (!KdHyperDbgRecvByte(&RecvChar))
+        if (!TransportReceive(&g_KdTransport, &RecvChar, sizeof(RecvChar), &BytesReceived) || BytesReceived == 0)
         {
             continue;
         }
@@ -166,11 +383,13 @@ SerialConnectionSend(CHAR * Buffer, UINT32 Length)
         return FALSE;
     }
 
-    for (size_t i = 0; i < Length; i++)
+    if (g_KdFramedPackets)
     {
-        KdHyperDbgSendByte(Buffer[i], TRUE);
+        return SerialConnectionSendFrame(Buffer, Length, NULL, 0, NULL, 0);
     }
 
+    TransportSend(&g_KdTransport, Buffer, Length);
+
     //
     // Send the end buffer
     //
@@ -203,21 +422,20 @@ SerialConnectionSendTwoBuffers(CHAR * Buffer1, UINT32 Length1, CHAR * Buffer2, U
         return FALSE;
     }
 
+    if (g_KdFramedPackets)
+    {
+        return SerialConnectionSendFrame(Buffer1, Length1, Buffer2, Length2, NULL, 0);
+    }
+
     //
     // Send first buffer
     //
-    for (size_t i = 0; i < Length1; i++)
-    {
-        KdHyperDbgSendByte(Buffer1[i], TRUE);
-    }
+    TransportSend(&g_KdTransport, Buffer1, Length1);
 
     //
     // Send second buffer
     //
-    for (size_t i = 0; i < Length2; i++)
-    {
-        KdHyperDbgSendByte(Buffer2[i], TRUE);
-    }
+    TransportSend(&g_KdTransport, Buffer2, Length2);
 
     //
     // Send the end buffer
@@ -227,6 +445,40 @@ SerialConnectionSendTwoBuffers(CHAR * Buffer1, UINT32 Length1, CHAR * Buffer2, U
     return TRUE;
 }
 
+/**
+ * @brief Check whether a buffer contains the end of buffer characters or not
+ * @details Buffers that contain these characters can't be sent over serial
+ * as the debugger considers them as the end of the packet (unless the packets
+ * are framed)
+ *
+ * @param Buffer
+ * @param Length
+ * @return BOOLEAN
+ */
+BOOLEAN
+SerialConnectionCheckBufferForEndOfBuffer(CHAR * Buffer, UINT32 Length)
+{
+    BYTE * Bytes = (BYTE *)Buffer;
+
+    if (g_KdFramedPackets)
+    {
+        return FALSE;
+    }
+
+    for (UINT32 i = 0; i + SERIAL_END_OF_BUFFER_CHARS_COUNT <= Length; i++)
+    {
+        if (Bytes[i] == SERIAL_END_OF_BUFFER_CHAR_1 &&
+            Bytes[i + 1] == SERIAL_END_OF_BUFFER_CHAR_2 &&
+            Bytes[i + 2] == SERIAL_END_OF_BUFFER_CHAR_3 &&
+            Bytes[i + 3] == SERIAL_END_OF_BUFFER_CHAR_4)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
 /**
  * @brief Perform sending 3 not appended buffers over serial
  *
@@ -258,29 +510,25 @@ SerialConnectionSendThreeBuffers(CHAR * Buffer1,
         return FALSE;
     }
 
+    if (g_KdFramedPackets)
+    {
+        return SerialConnectionSendFrame(Buffer1, Length1, Buffer2, Length2, Buffer3, Length3);
+    }
+
     //
     // Send first buffer
     //
-    for (size_t i = 0; i < Length1; i++)
-    {
-        KdHyperDbgSendByte(Buffer1[i], TRUE);
-    }
+    TransportSend(&g_KdTransport, Buffer1, Length1);
 
     //
     // Send second buffer
     //
-    for (size_t i = 0; i < Length2; i++)
-    {
-        KdHyperDbgSendByte(Buffer2[i], TRUE);
-    }
+    TransportSend(&g_KdTransport, Buffer2, Length2);
 
     //
     // Send third buffer
     //
-    for (size_t i = 0; i < Length3; i++)
-    {
-        KdHyperDbgSendByte(Buffer3[i], TRUE);
-    }
+    TransportSend(&g_KdTransport, Buffer3, Length3);
 
     //
     // Send the end buffer
@@ -340,6 +588,8 @@ SerialConnectionCheckPort(UINT32 SerialPort)
 NTSTATUS
 SerialConnectionPrepare(PDEBUGGER_PREPARE_DEBUGGEE DebuggeeRequest)
 {
+    UINT8 * RetransmissionBuffer = NULL;
+
     //
     // Check if baud rate is valid or not
     //
@@ -369,18 +619,81 @@ SerialConnectionPrepare(PDEBUGGER_PREPARE_DEBUGGEE DebuggeeRequest)
     //
     KdHyperDbgPrepareDebuggeeConnectionPort(DebuggeeRequest->PortAddress, DebuggeeRequest->Baudrate);
 
+    //
+    // The packets are sent and received through the transport of the UART
+    //
+    TransportInitialize(&g_KdTransport, &SerialConnectionTransportRoutines, TRANSPORT_TYPE_UART, NULL, NULL, NULL);
+
     //
     // Initialize kernel debugger
     //
     KdInitializeKernelDebugger();
 
+    //
+    // Compress the messages if the debugger accepts compressed messages
+    //
+    if (DebuggeeRequest->CompressLogs)
+    {
+        KdInitializeLogCompression();
+    }
+
     //
     // Send "Start" packet along with Windows Name
     //
     KdResponsePacketToDebugger(DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
                                DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_STARTED,
                                (CHAR *)DebuggeeRequest,
-                               MAXIMUM_CHARACTER_FOR_OS_NAME);
+                               SIZEOF_DEBUGGER_PREPARE_DEBUGGEE);
+
+    //
+    // The "Start" packet is the last packet that is not framed, the debugger
+    // switches to the framed packets once it receives it
+    //
+    if (DebuggeeRequest->UseFramedPackets)
+    {
+        //
+        // The last frame is kept to be sent again if the debugger receives it
+        // corrupted, if the allocation fails, frames are not retransmitted
+        //
+        RetransmissionBuffer = PlatformMemAllocateNonPagedPool(MaxSerialPacketSize + sizeof(FRAMING_HEADER));
+
+        if (RetransmissionBuffer == NULL)
+        {
+            LogWarning("Warning, unable to allocate the retransmission buffer, corrupted frames are not sent again");
+        }
+
+        SpinlockLock(&DebuggerResponseLock);
+
+        FramingInitialize(&g_KdFramingTransport,
+                          &g_KdTransport,
+                          SerialConnectionReadBytes,
+                          SerialConnectionWriteBytes,
+                          RetransmissionBuffer,
+                          MaxSerialPacketSize + sizeof(FRAMING_HEADER));
+
+        //
+        // NAKs (and retransmissions) of the receiver are serialized with the frames
+        // that are sent (while DebuggerResponseLock is held) by this lock
+        //
+        FramingSetSendLock(&g_KdFramingTransport, &g_KdFramingSendLock, SpinlockLock, SpinlockUnlock);
+
+        g_KdFramedPackets = TRUE;
+
+        SpinlockUnlock(&DebuggerResponseLock);
+
+        //
+        // The pages of the dump could be streamed as the frames are binary-safe
+        //
+        KdInitializeDumpStreaming();
+
+        //
+        // The context of the core is sent along with the pause packet if the debugger accepts it
+        //
+        if (DebuggeeRequest->SendBreakContext)
+        {
+            KdInitializeBreakContext(DebuggeeRequest->BreakContextCodeBytes, DebuggeeRequest->BreakContextStackQwords);
+        }
+    }
 
     //
     // Set status to successful
@@ -389,3 +702,33 @@ SerialConnectionPrepare(PDEBUGGER_PREPARE_DEBUGGEE DebuggeeRequest)
 
     return STATUS_SUCCESS;
 }
+
+/**
+ * @brief Switch back to the packets that are not framed
+ *
+ * @return VOID
+ */
+VOID
+SerialConnectionUninitializeFraming()
+{
+    UINT8 * RetransmissionBuffer;
+
+    //
+    // Make sure, nobody is in the middle of sending a frame
+    //
+    SpinlockLock(&DebuggerResponseLock);
+
+    g_KdFramedPackets    = FALSE;
+    RetransmissionBuffer = g_KdFramingTransport.RetransmissionBuffer;
+
+    g_KdFramingTransport.RetransmissionBuffer     = NULL;
+    g_KdFramingTransport.RetransmissionBufferSize = 0;
+    g_KdFramingTransport.RetransmissionLength     = 0;
+
+    SpinlockUnlock(&DebuggerResponseLock);
+
+    if (RetransmissionBuffer != NULL)
+    {
+        PlatformMemFreePool(RetransmissionBuffer);
+    }
+}
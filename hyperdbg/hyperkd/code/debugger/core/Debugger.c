@@ -112,6 +112,16 @@ DebuggerInitialize()
     InitializeListHead(&g_Events->ControlRegister3ModifiedEventsHead);
     InitializeListHead(&g_Events->ControlRegisterModifiedEventsHead);
 
+    //
+    // Initialize the publication of events to the VMX-root readers
+    //
+    EventPublicationInitialize();
+
+    //
+    // Initialize the groups of events
+    //
+    EventGroupsInitialize();
+
     //
     // Enabled Debugger Events
     //
@@ -148,6 +158,19 @@ DebuggerInitialize()
     //
     RtlZeroMemory(g_ScriptGlobalVariables, MAX_VAR_COUNT * sizeof(UINT64));
 
+    //
+    // Initialize the workspace of searching the memory in the debugger mode
+    //
+    if (!g_SearchMemoryWorkspace)
+    {
+        g_SearchMemoryWorkspace = PlatformMemAllocateZeroedNonPagedPool(sizeof(SEARCH_MEMORY_WORKSPACE));
+    }
+
+    if (!g_SearchMemoryWorkspace)
+    {
+        return FALSE;
+    }
+
     //
     // Zero the TRAP FLAG state memory
     //
@@ -269,6 +292,11 @@ DebuggerUninitialize()
     //
     VmFuncVmxBroadcastUninitialize();
 
+    //
+    // Free the published tables and the removed events
+    //
+    EventPublicationUninitialize();
+
     //
     // Free g_Events
     //
@@ -283,6 +311,15 @@ DebuggerUninitialize()
         g_ScriptGlobalVariables = NULL;
     }
 
+    //
+    // Free g_SearchMemoryWorkspace
+    //
+    if (g_SearchMemoryWorkspace != NULL)
+    {
+        PlatformMemFreePool(g_SearchMemoryWorkspace);
+        g_SearchMemoryWorkspace = NULL;
+    }
+
     //
     // Free core specific local and temp variables
     //
@@ -437,12 +474,14 @@ DebuggerCreateEvent(BOOLEAN                           Enabled,
         }
     }
 
-    Event->CoreId         = CoreId;
-    Event->ProcessId      = ProcessId;
-    Event->Enabled        = Enabled;
-    Event->EventType      = EventType;
-    Event->Tag            = Tag;
-    Event->CountOfActions = 0; // currently there is no action
+    Event->CoreId                      = CoreId;
+    Event->ProcessId                   = ProcessId;
+    Event->Enabled                     = Enabled;
+    Event->EventType                   = EventType;
+    Event->Tag                         = Tag;
+    Event->CountOfActions              = 0; // currently there is no action
+    Event->NumberOfConditionPredicates = 0; // currently there is no predicate
+    Event->GroupsBitmap                = 0; // currently it doesn't belong to any group
 
     //
     // Copy Options
@@ -620,7 +659,8 @@ DebuggerAddActionToEvent(PDEBUGGER_EVENT                                 Event,
 {
     PDEBUGGER_EVENT_ACTION Action;
     SIZE_T                 ActionBufferSize;
-    PVOID                  RequestedBuffer = NULL;
+    PVOID                  RequestedBuffer   = NULL;
+    PVOID                  ScriptStackBuffer = NULL;
 
     //
     // Allocate action + allocate code for custom code
@@ -748,6 +788,12 @@ DebuggerAddActionToEvent(PDEBUGGER_EVENT                                 Event,
         }
     }
 
+    //
+    // Buffers from the pool manager might be reused, so the dedicated script
+    // stack is not assumed to be null
+    //
+    Action->ScriptStackBuffer = NULL;
+
     //
     // If the user needs a buffer to be passed to the debugger then
     // we should allocate it here (Requested buffer is only available for custom code types)
@@ -985,6 +1031,70 @@ DebuggerAddActionToEvent(PDEBUGGER_EVENT                                 Event,
         Action->ScriptConfiguration.ScriptLength                = InTheCaseOfRunScript->ScriptLength;
         Action->ScriptConfiguration.ScriptPointer               = InTheCaseOfRunScript->ScriptPointer;
         Action->ScriptConfiguration.OptionalRequestedBufferSize = InTheCaseOfRunScript->OptionalRequestedBufferSize;
+        Action->ScriptConfiguration.StackFootprint              = InTheCaseOfRunScript->StackFootprint;
+
+        //
+        // If the stack footprint of the script (computed by the compiler) doesn't fit into the
+        // per-core stack buffer, a dedicated stack is allocated for this action (one slice per core),
+        // one extra slot is needed as the stack index points to the next free slot
+        //
+        if (InTheCaseOfRunScript->StackFootprint >= MAX_STACK_BUFFER_COUNT)
+        {
+            Action->ScriptStackSize = InTheCaseOfRunScript->StackFootprint + 1;
+
+            ScriptStackBuffer = DebuggerAllocateSafeRequestedBuffer((SIZE_T)Action->ScriptStackSize * sizeof(UINT64) * KeQueryActiveProcessorCount(0),
+                                                                    ResultsToReturn,
+                                                                    InputFromVmxRoot);
+
+            if (!ScriptStackBuffer)
+            {
+                //
+                // There was an error in allocation
+                //
+                if (InputFromVmxRoot)
+                {
+                    PoolManagerFreePool((UINT64)Action);
+
+                    if (RequestedBuffer != NULL)
+                    {
+                        PoolManagerFreePool((UINT64)RequestedBuffer);
+                    }
+                }
+                else
+                {
+                    PlatformMemFreePool(Action);
+
+                    if (RequestedBuffer != NULL)
+                    {
+                        PlatformMemFreePool(RequestedBuffer);
+                    }
+                }
+
+                //
+                // Not need to set error as the above function already adjust the error
+                //
+                return NULL;
+            }
+
+            Action->ScriptStackBuffer = (UINT64 *)ScriptStackBuffer;
+        }
+        else
+        {
+            Action->ScriptStackSize = MAX_STACK_BUFFER_COUNT;
+        }
+
+        //
+        // Only the region that the script uses is zeroed before each run, if the footprint
+        // is not known (e.g., user-defined functions), the entire stack is zeroed
+        //
+        if (InTheCaseOfRunScript->StackFootprint != 0)
+        {
+            Action->ScriptStackZeroingSize = InTheCaseOfRunScript->StackFootprint;
+        }
+        else
+        {
+            Action->ScriptStackZeroingSize = Action->ScriptStackSize;
+        }
     }
 
     //
@@ -994,6 +1104,23 @@ DebuggerAddActionToEvent(PDEBUGGER_EVENT                                 Event,
     Event->CountOfActions++;
     Action->ActionOrderCode = Event->CountOfActions;
 
+    //
+    // If the script is the only action of the event, its condition might be lowered
+    // (by the script engine) into predicates that are evaluated without running the
+    // script, but once another action is added, the predicates are no longer valid for
+    // the entire event
+    //
+    if (ActionType == RUN_SCRIPT && Event->CountOfActions == 1)
+    {
+        ScriptEngineSetConditionPredicates(Event,
+                                           InTheCaseOfRunScript->ConditionPredicates,
+                                           InTheCaseOfRunScript->NumberOfConditionPredicates);
+    }
+    else
+    {
+        InterlockedExchange(&Event->NumberOfConditionPredicates, 0);
+    }
+
     //
     // Fill other parts of the action
     //
@@ -1029,6 +1156,15 @@ DebuggerRegisterEvent(PDEBUGGER_EVENT Event)
     {
         InsertHeadList(TargetEventList, &(Event->EventsOfSameTypeList));
 
+        //
+        // Publish the new list of events to the VMX-root readers
+        //
+        if (!EventPublicationPublishEventList(Event->EventType))
+        {
+            RemoveEntryList(&(Event->EventsOfSameTypeList));
+            return FALSE;
+        }
+
         return TRUE;
     }
     else
@@ -1061,8 +1197,8 @@ DebuggerTriggerEvents(VMM_EVENT_TYPE_ENUM                   EventType,
     DebuggerCheckForCondition *      ConditionFunc;
     DEBUGGER_TRIGGERED_EVENT_DETAILS EventTriggerDetail = {0};
     PEPT_HOOKS_CONTEXT               EptContext;
+    PDEBUGGER_EVENT_DISPATCH_TABLE   DispatchTable   = NULL;
     PLIST_ENTRY                      TempList        = 0;
-    PLIST_ENTRY                      TempList2       = 0;
     const PVOID                      OriginalContext = Context;
 
     //
@@ -1087,20 +1223,25 @@ DebuggerTriggerEvents(VMM_EVENT_TYPE_ENUM                   EventType,
     DbgState->Regs = Regs;
 
     //
-    // Find the debugger events list base on the type of the event
+    // Check whether the type of the event is valid or not
     //
-    TempList  = DebuggerGetEventListByEventType(EventType);
-    TempList2 = TempList;
+    TempList = DebuggerGetEventListByEventType(EventType);
 
     if (TempList == NULL)
     {
         return VMM_CALLBACK_TRIGGERING_EVENT_STATUS_INVALID_EVENT_TYPE;
     }
 
-    while (TempList2 != TempList->Flink)
+    //
+    // Get the published (immutable) dispatch table of this type, the lists of
+    // events are not read here as they might be modified by the writers, the
+    // table remains valid until this core leaves the read-side
+    //
+    DispatchTable = EventPublicationReaderEnter(DbgState, EventType);
+
+    for (UINT32 i = 0; DispatchTable != NULL && i < DispatchTable->NumberOfEvents; i++)
     {
-        TempList                     = TempList->Flink;
-        PDEBUGGER_EVENT CurrentEvent = CONTAINING_RECORD(TempList, DEBUGGER_EVENT, EventsOfSameTypeList);
+        PDEBUGGER_EVENT CurrentEvent = DispatchTable->Events[i];
 
         //
         // check if the event is enabled or not
@@ -1110,6 +1251,14 @@ DebuggerTriggerEvents(VMM_EVENT_TYPE_ENUM                   EventType,
             continue;
         }
 
+        //
+        // check if any of the groups of the event is disabled
+        //
+        if (EVENT_GROUPS_IS_EVENT_DISABLED(CurrentEvent))
+        {
+            continue;
+        }
+
         //
         // Check if this event is for this core or not
         //
@@ -1451,12 +1600,27 @@ DebuggerTriggerEvents(VMM_EVENT_TYPE_ENUM                   EventType,
         EventTriggerDetail.Tag     = CurrentEvent->Tag;
         EventTriggerDetail.Stage   = CallingStage;
 
+        //
+        // Check the predicates that are lowered from the condition of the script (if any),
+        // if they're not met, then the script has nothing to perform and we avoid running it
+        //
+        if (CurrentEvent->NumberOfConditionPredicates != 0 &&
+            !ScriptEngineCheckConditionPredicates(DbgState, CurrentEvent, &EventTriggerDetail))
+        {
+            continue;
+        }
+
         //
         // perform the actions
         //
         DebuggerPerformActions(DbgState, CurrentEvent, &EventTriggerDetail);
     }
 
+    //
+    // Leave the read-side (quiescent point for this core)
+    //
+    EventPublicationReaderExit(DbgState);
+
     //
     // Check if the event should be ignored or not
     //
@@ -1558,6 +1722,8 @@ DebuggerPerformRunScript(PROCESSOR_DEBUGGING_STATE *        DbgState,
     ACTION_BUFFER                   ActionBuffer           = {0};
     SYMBOL                          ErrorSymbol            = {0};
     SCRIPT_ENGINE_GENERAL_REGISTERS ScriptGeneralRegisters = {0};
+    UINT64                          StackSize              = MAX_STACK_BUFFER_COUNT;
+    UINT64                          StackZeroingSize       = MAX_STACK_BUFFER_COUNT;
 
     if (Action != NULL)
     {
@@ -1587,6 +1753,12 @@ DebuggerPerformRunScript(PROCESSOR_DEBUGGING_STATE *        DbgState,
         CodeBuffer.Head    = (PSYMBOL)Action->ScriptConfiguration.ScriptBuffer;
         CodeBuffer.Size    = Action->ScriptConfiguration.ScriptLength;
         CodeBuffer.Pointer = Action->ScriptConfiguration.ScriptPointer;
+
+        //
+        // Use the stack that is sized for this action
+        //
+        StackSize        = Action->ScriptStackSize;
+        StackZeroingSize = Action->ScriptStackZeroingSize;
     }
     else if (ScriptDetails != NULL)
     {
@@ -1626,11 +1798,24 @@ DebuggerPerformRunScript(PROCESSOR_DEBUGGING_STATE *        DbgState,
     }
 
     //
-    // Fill the stack buffer for this run
+    // Fill the stack buffer for this run, scripts that don't fit into the per-core
+    // stack buffer use their own slice of the action's dedicated stack
     //
-    ScriptGeneralRegisters.StackBuffer         = DbgState->ScriptEngineCoreSpecificStackBuffer;
+    if (Action != NULL && Action->ScriptStackBuffer != NULL)
+    {
+        ScriptGeneralRegisters.StackBuffer = Action->ScriptStackBuffer + ((UINT64)DbgState->CoreId * StackSize);
+    }
+    else
+    {
+        ScriptGeneralRegisters.StackBuffer = DbgState->ScriptEngineCoreSpecificStackBuffer;
+    }
+
     ScriptGeneralRegisters.GlobalVariablesList = g_ScriptGlobalVariables;
-    RtlZeroMemory(ScriptGeneralRegisters.StackBuffer, MAX_STACK_BUFFER_COUNT * sizeof(UINT64));
+
+    //
+    // Only zero the region of the stack that is used by the script
+    //
+    RtlZeroMemory(ScriptGeneralRegisters.StackBuffer, StackZeroingSize * sizeof(UINT64));
 
     UINT64 EXECUTENUMBER = 0;
 
@@ -1651,7 +1836,7 @@ DebuggerPerformRunScript(PROCESSOR_DEBUGGING_STATE *        DbgState,
                     FunctionNames[ErrorSymbol.Value]);
             break;
         }
-        else if (ScriptGeneralRegisters.StackIndx >= MAX_STACK_BUFFER_COUNT)
+        else if (ScriptGeneralRegisters.StackIndx >= StackSize)
         {
             LogInfo("Err, stack buffer overflow (more information: https://docs.hyperdbg.org/tips-and-tricks/misc/customize-build/change-script-engine-limitations)\n");
             break;
@@ -2320,6 +2505,8 @@ DebuggerDisableEvent(UINT64 Tag)
 BOOLEAN
 DebuggerClearEvent(UINT64 Tag, BOOLEAN InputFromVmxRoot, BOOLEAN PoolManagerAllocatedMemory)
 {
+    BOOLEAN Result;
+
     //
     // Because we want to delete all the objects and buffers (pools)
     // after we finished termination, the debugger might still use
@@ -2342,7 +2529,14 @@ DebuggerClearEvent(UINT64 Tag, BOOLEAN InputFromVmxRoot, BOOLEAN PoolManagerAllo
     //
     // Third, remove it from the list
     //
-    return DebuggerRemoveEvent(Tag, PoolManagerAllocatedMemory);
+    Result = DebuggerRemoveEvent(Tag, PoolManagerAllocatedMemory);
+
+    //
+    // Free the removed events that are no longer used by the readers
+    //
+    EventPublicationReclaim();
+
+    return Result;
 }
 
 /**
@@ -2380,6 +2574,11 @@ DebuggerClearAllEvents(BOOLEAN InputFromVmxRoot, BOOLEAN PoolManagerAllocatedMem
     // Third, remove all events
     //
     DebuggerRemoveAllEvents(PoolManagerAllocatedMemory);
+
+    //
+    // Free the removed events that are no longer used by the readers
+    //
+    EventPublicationReclaim();
 }
 
 /**
@@ -2437,7 +2636,7 @@ DebuggerQueryDebuggerStatus()
  *
  * @param Tag Target events tag
  * @return BOOLEAN If the event was removed then TRUE and FALSE
- * if not found
+ * if not found (or it could not be unpublished)
  */
 BOOLEAN
 DebuggerRemoveEventFromEventList(UINT64 Tag)
@@ -2463,10 +2662,23 @@ DebuggerRemoveEventFromEventList(UINT64 Tag)
             //
             if (CurrentEvent->Tag == Tag)
             {
+                PLIST_ENTRY PreviousEntry = CurrentEvent->EventsOfSameTypeList.Blink;
+
                 //
                 // We have to remove the event from the list
                 //
                 RemoveEntryList(&CurrentEvent->EventsOfSameTypeList);
+
+                //
+                // Publish a table without the event to the VMX-root readers, if it's
+                // not possible, the event is put back to its place and remains disabled
+                //
+                if (!EventPublicationUnpublishEvent(CurrentEvent))
+                {
+                    InsertHeadList(PreviousEntry, &CurrentEvent->EventsOfSameTypeList);
+                    return FALSE;
+                }
+
                 return TRUE;
             }
         }
@@ -2527,6 +2739,21 @@ DebuggerRemoveAllActionsFromEvent(PDEBUGGER_EVENT Event, BOOLEAN PoolManagerAllo
             }
         }
 
+        //
+        // Check if it has a dedicated stack for the script
+        //
+        if (CurrentAction->ScriptStackBuffer != NULL)
+        {
+            if (PoolManagerAllocatedMemory)
+            {
+                PoolManagerFreePool((UINT64)CurrentAction->ScriptStackBuffer);
+            }
+            else
+            {
+                PlatformMemFreePool(CurrentAction->ScriptStackBuffer);
+            }
+        }
+
         //
         // Remove the action and free the pool,
         // if it's a custom buffer then the buffer
@@ -2592,6 +2819,30 @@ DebuggerRemoveEvent(UINT64 Tag, BOOLEAN PoolManagerAllocatedMemory)
         return FALSE;
     }
 
+    //
+    // The event might still be used by the VMX-root readers on other cores,
+    // so it's freed once all of them passed a quiescent point
+    //
+    EventPublicationRetireEvent(Event, PoolManagerAllocatedMemory);
+
+    return TRUE;
+}
+
+/**
+ * @brief De-allocate the event and its actions
+ *
+ * @details the event should be removed from the event list and should not
+ * be used by any reader anymore
+ *
+ * @param Event Event Object
+ * @param PoolManagerAllocatedMemory Whether the pools are allocated from the
+ * pool manager or original OS pools
+ *
+ * @return VOID
+ */
+VOID
+DebuggerFreeEvent(PDEBUGGER_EVENT Event, BOOLEAN PoolManagerAllocatedMemory)
+{
     //
     // Remove all of the actions and free its pools
     //
@@ -2612,8 +2863,6 @@ DebuggerRemoveEvent(UINT64 Tag, BOOLEAN PoolManagerAllocatedMemory)
     {
         PlatformMemFreePool(Event);
     }
-
-    return TRUE;
 }
 
 /**
@@ -3107,10 +3356,27 @@ DebuggerParseEvent(PDEBUGGER_GENERAL_EVENT_DETAIL    EventDetails,
         return FALSE;
     }
 
+    //
+    // The event is enabled once its actions are added, unless it's explicitly
+    // restored as disabled (e.g., a disabled event that is restored from a session)
+    //
+    Event->EnableOnAction = !EventDetails->IsRestoredAsDisabled;
+
     //
     // Register the event
     //
-    DebuggerRegisterEvent(Event);
+    if (!DebuggerRegisterEvent(Event))
+    {
+        //
+        // The event is not published, so it can be freed directly
+        //
+        ResultsToReturn->IsSuccessful = FALSE;
+        ResultsToReturn->Error        = DEBUGGER_ERROR_INSTANT_EVENT_PREALLOCATED_BUFFER_NOT_FOUND_FOR_DISPATCH_TABLE;
+
+        DebuggerFreeEvent(Event, InputFromVmxRoot);
+
+        return FALSE;
+    }
 
     //
     // ----------------------------------------------------------------------------------
@@ -3277,6 +3543,9 @@ DebuggerParseAction(PDEBUGGER_GENERAL_ACTION          ActionDetails,
         UserScriptConfig.ScriptLength                                   = ActionDetails->ScriptBufferSize;
         UserScriptConfig.ScriptPointer                                  = ActionDetails->ScriptBufferPointer;
         UserScriptConfig.OptionalRequestedBufferSize                    = ActionDetails->PreAllocatedBuffer;
+        UserScriptConfig.StackFootprint                                 = ActionDetails->ScriptStackFootprint;
+        UserScriptConfig.NumberOfConditionPredicates                    = ActionDetails->ScriptNumberOfConditionPredicates;
+        UserScriptConfig.ConditionPredicates                            = ActionDetails->ScriptConditionPredicates;
 
         Action = DebuggerAddActionToEvent(Event,
                                           RUN_SCRIPT,
@@ -3330,9 +3599,12 @@ DebuggerParseAction(PDEBUGGER_GENERAL_ACTION          ActionDetails,
     }
 
     //
-    // Enable the event
+    // Enable the event (if it's not registered as disabled)
     //
-    DebuggerEnableEvent(Event->Tag);
+    if (Event->EnableOnAction)
+    {
+        DebuggerEnableEvent(Event->Tag);
+    }
 
     ResultsToReturn->IsSuccessful = TRUE;
     ResultsToReturn->Error        = 0;
@@ -3595,6 +3867,14 @@ DebuggerParseEventsModification(PDEBUGGER_MODIFY_EVENTS DebuggerEventModificatio
 {
     BOOLEAN IsForAllEvents = FALSE;
 
+    //
+    // Check if it's a modification of the groups of events
+    //
+    if (EventGroupsIsGroupModification(DebuggerEventModificationRequest->TypeOfAction))
+    {
+        return EventGroupsPerformModification(DebuggerEventModificationRequest);
+    }
+
     //
     // Check if the tag is valid or not
     //
@@ -0,0 +1,174 @@
+/**
+ * @file EventGroups.c
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Groups of events (enabling and disabling a set of events)
+ * @details Each event holds a bitmap of the groups that it belongs to (each
+ * bit is a group id), and there is a global bitmap of the disabled groups,
+ * so a whole group is enabled or disabled by a single atomic operation on
+ * the global bitmap and the event trigger routine only needs a single test
+ * to check whether any of the groups of the event is disabled
+ *
+ * @version 0.14
+ * @date 2025-06-07
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Initialize the groups of events
+ *
+ * @return VOID
+ */
+VOID
+EventGroupsInitialize()
+{
+    //
+    // All of the groups are initially enabled
+    //
+    InterlockedExchange64(&g_EventGroupsDisabledBitmap, 0);
+}
+
+/**
+ * @brief Check whether the modification request is related to the groups of events
+ *
+ * @param TypeOfAction Type of the modification
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+EventGroupsIsGroupModification(DEBUGGER_MODIFY_EVENTS_TYPE TypeOfAction)
+{
+    return TypeOfAction == DEBUGGER_MODIFY_EVENTS_ADD_TO_GROUP ||
+           TypeOfAction == DEBUGGER_MODIFY_EVENTS_REMOVE_FROM_GROUP ||
+           TypeOfAction == DEBUGGER_MODIFY_EVENTS_ENABLE_GROUP ||
+           TypeOfAction == DEBUGGER_MODIFY_EVENTS_DISABLE_GROUP;
+}
+
+/**
+ * @brief Remove all of the events from a group
+ *
+ * @param GroupId The target group
+ *
+ * @return VOID
+ */
+static VOID
+EventGroupsRemoveAllEventsFromGroup(UINT32 GroupId)
+{
+    PLIST_ENTRY TempList  = 0;
+    PLIST_ENTRY TempList2 = 0;
+
+    //
+    // We have to iterate through all events
+    //
+    for (size_t i = 0; i < sizeof(DEBUGGER_CORE_EVENTS) / sizeof(LIST_ENTRY); i++)
+    {
+        TempList  = (PLIST_ENTRY)((UINT64)(g_Events) + (i * sizeof(LIST_ENTRY)));
+        TempList2 = TempList;
+
+        while (TempList2 != TempList->Flink)
+        {
+            TempList                     = TempList->Flink;
+            PDEBUGGER_EVENT CurrentEvent = CONTAINING_RECORD(TempList, DEBUGGER_EVENT, EventsOfSameTypeList);
+
+            InterlockedBitTestAndReset64(&CurrentEvent->GroupsBitmap, GroupId);
+        }
+    }
+}
+
+/**
+ * @brief Perform the modifications of the groups of events
+ * @details The results are put in the KernelStatus of the request
+ *
+ * @param ModifyEventRequest The modification request
+ *
+ * @return BOOLEAN TRUE if it was successful and FALSE if not successful
+ */
+BOOLEAN
+EventGroupsPerformModification(PDEBUGGER_MODIFY_EVENTS ModifyEventRequest)
+{
+    PDEBUGGER_EVENT Event = NULL;
+
+    //
+    // Check if the group is valid or not
+    //
+    if (ModifyEventRequest->GroupId >= DEBUGGER_MAXIMUM_EVENT_GROUPS)
+    {
+        ModifyEventRequest->KernelStatus = DEBUGGER_ERROR_MODIFY_EVENTS_INVALID_GROUP;
+        return FALSE;
+    }
+
+    switch (ModifyEventRequest->TypeOfAction)
+    {
+    case DEBUGGER_MODIFY_EVENTS_ADD_TO_GROUP:
+    case DEBUGGER_MODIFY_EVENTS_REMOVE_FROM_GROUP:
+
+        if (ModifyEventRequest->TypeOfAction == DEBUGGER_MODIFY_EVENTS_REMOVE_FROM_GROUP &&
+            ModifyEventRequest->Tag == DEBUGGER_MODIFY_EVENTS_APPLY_TO_ALL_TAG)
+        {
+            //
+            // The group is removed, so none of the events belongs to it anymore
+            // and it's enabled again to be reused by another group
+            //
+            EventGroupsRemoveAllEventsFromGroup(ModifyEventRequest->GroupId);
+            InterlockedBitTestAndReset64(&g_EventGroupsDisabledBitmap, ModifyEventRequest->GroupId);
+
+            break;
+        }
+
+        Event = DebuggerGetEventByTag(ModifyEventRequest->Tag);
+
+        if (Event == NULL)
+        {
+            //
+            // Tag is invalid
+            //
+            ModifyEventRequest->KernelStatus = DEBUGGER_ERROR_MODIFY_EVENTS_INVALID_TAG;
+            return FALSE;
+        }
+
+        if (ModifyEventRequest->TypeOfAction == DEBUGGER_MODIFY_EVENTS_ADD_TO_GROUP)
+        {
+            InterlockedBitTestAndSet64(&Event->GroupsBitmap, ModifyEventRequest->GroupId);
+        }
+        else
+        {
+            InterlockedBitTestAndReset64(&Event->GroupsBitmap, ModifyEventRequest->GroupId);
+        }
+
+        break;
+
+    case DEBUGGER_MODIFY_EVENTS_ENABLE_GROUP:
+
+        //
+        // All of the events of the group are enabled by a single atomic operation
+        //
+        InterlockedBitTestAndReset64(&g_EventGroupsDisabledBitmap, ModifyEventRequest->GroupId);
+
+        break;
+
+    case DEBUGGER_MODIFY_EVENTS_DISABLE_GROUP:
+
+        //
+        // All of the events of the group are disabled by a single atomic operation
+        //
+        InterlockedBitTestAndSet64(&g_EventGroupsDisabledBitmap, ModifyEventRequest->GroupId);
+
+        break;
+
+    default:
+
+        //
+        // Invalid parameter specified in TypeOfAction
+        //
+        ModifyEventRequest->KernelStatus = DEBUGGER_ERROR_MODIFY_EVENTS_INVALID_TYPE_OF_ACTION;
+        return FALSE;
+    }
+
+    //
+    // The function was successful
+    //
+    ModifyEventRequest->KernelStatus = DEBUGGER_OPERATION_WAS_SUCCESSFUL;
+    return TRUE;
+}
@@ -0,0 +1,523 @@
+/**
+ * @file EventPublication.c
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief RCU-style publication of events to VMX-root readers
+ * @details The lists of events (g_Events) are only touched by the writers,
+ * the readers (DebuggerTriggerEvents) only walk an immutable dispatch table
+ * for each event type which is published by a single pointer swap. Retired
+ * tables and removed events are freed once every core passed a quiescent
+ * point (leaving the event trigger routine) after the retirement, either by
+ * the writer or by the core that ends the grace period
+ *
+ * @version 0.14
+ * @date 2025-06-02
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Initialize the event publication mechanism
+ *
+ * @return VOID
+ */
+VOID
+EventPublicationInitialize()
+{
+    ULONG ProcessorsCount = KeQueryActiveProcessorCount(0);
+
+    //
+    // No table is published yet (no event)
+    //
+    for (UINT32 i = 0; i < EVENT_PUBLICATION_NUMBER_OF_EVENT_LISTS; i++)
+    {
+        g_EventDispatchTables[i] = NULL;
+    }
+
+    //
+    // All of the cores are initially in the quiescent state
+    //
+    for (UINT32 i = 0; i < ProcessorsCount; i++)
+    {
+        g_DbgState[i].EventPublicationEpoch         = EVENT_PUBLICATION_QUIESCENT_EPOCH;
+        g_DbgState[i].EventPublicationReaderNesting = 0;
+    }
+
+    //
+    // The epoch starts from one as zero is the quiescent epoch
+    //
+    g_EventPublicationEpoch                  = 1;
+    g_EventPublicationLock                   = 0;
+    g_EventPublicationNumberOfRetiredObjects = 0;
+
+    InitializeListHead(&g_RetiredEventDispatchTablesHead);
+    InitializeListHead(&g_RetiredEventsHead);
+}
+
+/**
+ * @brief Get the index of dispatch table based on event type
+ *
+ * @param EventType type of event
+ * @param Index The index of the dispatch table
+ *
+ * @return BOOLEAN Returns FALSE if the event type is not valid
+ */
+BOOLEAN
+EventPublicationGetIndexByEventType(VMM_EVENT_TYPE_ENUM EventType, UINT32 * Index)
+{
+    PLIST_ENTRY TargetEventList = DebuggerGetEventListByEventType(EventType);
+
+    if (TargetEventList == NULL)
+    {
+        return FALSE;
+    }
+
+    //
+    // Dispatch tables are in the same order as the lists of events
+    //
+    *Index = (UINT32)(TargetEventList - (PLIST_ENTRY)g_Events);
+
+    return TRUE;
+}
+
+/**
+ * @brief Get the oldest epoch that is still used by a reader
+ *
+ * @return UINT64 The oldest active epoch or MAXULONG64 if no core
+ * is reading the dispatch tables
+ */
+UINT64
+EventPublicationGetOldestReaderEpoch()
+{
+    ULONG  ProcessorsCount = KeQueryActiveProcessorCount(0);
+    UINT64 OldestEpoch     = MAXULONG64;
+    UINT64 CoreEpoch;
+
+    for (UINT32 i = 0; i < ProcessorsCount; i++)
+    {
+        CoreEpoch = (UINT64)InterlockedCompareExchange64(&g_DbgState[i].EventPublicationEpoch, 0, 0);
+
+        if (CoreEpoch != EVENT_PUBLICATION_QUIESCENT_EPOCH && CoreEpoch < OldestEpoch)
+        {
+            OldestEpoch = CoreEpoch;
+        }
+    }
+
+    return OldestEpoch;
+}
+
+/**
+ * @brief Wait (bounded) for the readers of the target epoch and the previous
+ * epochs to pass a quiescent point
+ *
+ * @param Epoch The target epoch
+ *
+ * @return BOOLEAN Returns FALSE if the readers did not leave in time
+ */
+BOOLEAN
+EventPublicationWaitForReaders(UINT64 Epoch)
+{
+    for (UINT32 i = 0; i < EVENT_PUBLICATION_MAXIMUM_GRACE_PERIOD_SPINS; i++)
+    {
+        if (EventPublicationGetOldestReaderEpoch() >= Epoch)
+        {
+            return TRUE;
+        }
+
+        _mm_pause();
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief Allocate a dispatch table
+ * @details In VMX-root mode, the tables are allocated from the pre-allocated
+ * pools of the pool manager
+ *
+ * @param NumberOfEvents Number of events that should be stored in the table
+ *
+ * @return PDEBUGGER_EVENT_DISPATCH_TABLE NULL if the allocation was not successful
+ */
+PDEBUGGER_EVENT_DISPATCH_TABLE
+EventPublicationAllocateDispatchTable(UINT32 NumberOfEvents)
+{
+    PDEBUGGER_EVENT_DISPATCH_TABLE Table = NULL;
+
+    if (VmFuncVmxGetCurrentExecutionMode() == TRUE)
+    {
+        if (NumberOfEvents > MAXIMUM_EVENTS_IN_INSTANT_EVENT_DISPATCH_TABLE)
+        {
+            return NULL;
+        }
+
+        Table = (PDEBUGGER_EVENT_DISPATCH_TABLE)PoolManagerRequestPool(INSTANT_EVENT_DISPATCH_TABLE, TRUE, INSTANT_EVENT_DISPATCH_TABLE_BUFFER);
+
+        if (Table != NULL)
+        {
+            Table->PoolManagerAllocatedMemory = TRUE;
+        }
+    }
+    else
+    {
+        Table = PlatformMemAllocateNonPagedPool(EVENT_PUBLICATION_DISPATCH_TABLE_SIZE(NumberOfEvents));
+
+        if (Table != NULL)
+        {
+            Table->PoolManagerAllocatedMemory = FALSE;
+        }
+    }
+
+    if (Table != NULL)
+    {
+        Table->NumberOfEvents = NumberOfEvents;
+        Table->RetiredEpoch   = 0;
+    }
+
+    return Table;
+}
+
+/**
+ * @brief Free a dispatch table
+ *
+ * @param Table The target table
+ *
+ * @return VOID
+ */
+VOID
+EventPublicationFreeDispatchTable(PDEBUGGER_EVENT_DISPATCH_TABLE Table)
+{
+    if (Table->PoolManagerAllocatedMemory)
+    {
+        PoolManagerFreePool((UINT64)Table);
+    }
+    else
+    {
+        PlatformMemFreePool(Table);
+    }
+}
+
+/**
+ * @brief Free the retired tables and events that are no longer used by any reader
+ * @details should be called while holding the publication lock
+ *
+ * @return VOID
+ */
+VOID
+EventPublicationReclaimLocked()
+{
+    UINT64      OldestEpoch = EventPublicationGetOldestReaderEpoch();
+    BOOLEAN     IsVmxRoot   = VmFuncVmxGetCurrentExecutionMode();
+    PLIST_ENTRY TempList    = 0;
+
+    //
+    // Reclaim retired dispatch tables
+    //
+    TempList = g_RetiredEventDispatchTablesHead.Flink;
+
+    while (TempList != &g_RetiredEventDispatchTablesHead)
+    {
+        PDEBUGGER_EVENT_DISPATCH_TABLE CurrentTable = CONTAINING_RECORD(TempList, DEBUGGER_EVENT_DISPATCH_TABLE, RetiredTablesList);
+        TempList                                    = TempList->Flink;
+
+        //
+        // Readers that announced an older epoch might still hold this table,
+        // also the OS pools cannot be freed from VMX-root
+        //
+        if (CurrentTable->RetiredEpoch > OldestEpoch || (IsVmxRoot && !CurrentTable->PoolManagerAllocatedMemory))
+        {
+            continue;
+        }
+
+        RemoveEntryList(&CurrentTable->RetiredTablesList);
+        EventPublicationFreeDispatchTable(CurrentTable);
+
+        InterlockedDecrement(&g_EventPublicationNumberOfRetiredObjects);
+    }
+
+    //
+    // Reclaim removed events (and their actions)
+    //
+    TempList = g_RetiredEventsHead.Flink;
+
+    while (TempList != &g_RetiredEventsHead)
+    {
+        PDEBUGGER_EVENT CurrentEvent = CONTAINING_RECORD(TempList, DEBUGGER_EVENT, RetiredEventsList);
+        TempList                     = TempList->Flink;
+
+        if (CurrentEvent->RetiredEpoch > OldestEpoch || (IsVmxRoot && !CurrentEvent->PoolManagerAllocatedMemory))
+        {
+            continue;
+        }
+
+        RemoveEntryList(&CurrentEvent->RetiredEventsList);
+        DebuggerFreeEvent(CurrentEvent, CurrentEvent->PoolManagerAllocatedMemory);
+
+        InterlockedDecrement(&g_EventPublicationNumberOfRetiredObjects);
+    }
+}
+
+/**
+ * @brief Free the retired tables and events that are no longer used by any reader
+ * @details In VMX non-root, it waits (bounded) for the readers of the retired
+ * objects, the objects that remain are reclaimed once their readers leave
+ *
+ * @return VOID
+ */
+VOID
+EventPublicationReclaim()
+{
+    if (!VmFuncVmxGetCurrentExecutionMode())
+    {
+        EventPublicationWaitForReaders((UINT64)InterlockedCompareExchange64(&g_EventPublicationEpoch, 0, 0));
+    }
+
+    SpinlockLock(&g_EventPublicationLock);
+
+    EventPublicationReclaimLocked();
+
+    SpinlockUnlock(&g_EventPublicationLock);
+}
+
+/**
+ * @brief Swap the published table of an event type and retire the old one
+ * @details should be called while holding the publication lock
+ *
+ * @param Index Index of the dispatch table
+ * @param NewTable The new table (NULL if there is no event)
+ *
+ * @return VOID
+ */
+VOID
+EventPublicationSwapDispatchTable(UINT32 Index, PDEBUGGER_EVENT_DISPATCH_TABLE NewTable)
+{
+    PDEBUGGER_EVENT_DISPATCH_TABLE OldTable;
+    UINT64                         NewEpoch;
+
+    //
+    // Publish the new table by a single pointer swap
+    //
+    OldTable = InterlockedExchangePointer((PVOID volatile *)&g_EventDispatchTables[Index], NewTable);
+
+    //
+    // Readers that announce the new epoch are guaranteed to see the new table
+    //
+    NewEpoch = (UINT64)InterlockedIncrement64(&g_EventPublicationEpoch);
+
+    if (OldTable != NULL)
+    {
+        OldTable->RetiredEpoch = NewEpoch;
+        InsertTailList(&g_RetiredEventDispatchTablesHead, &OldTable->RetiredTablesList);
+
+        InterlockedIncrement(&g_EventPublicationNumberOfRetiredObjects);
+    }
+}
+
+/**
+ * @brief Build a new dispatch table from the list of events and publish it
+ * @details should be called after each modification to the list of events
+ *
+ * @param EventType Type of events
+ *
+ * @return BOOLEAN Returns FALSE if the dispatch table could not be allocated
+ * (the previous table remains published)
+ */
+BOOLEAN
+EventPublicationPublishEventList(VMM_EVENT_TYPE_ENUM EventType)
+{
+    PDEBUGGER_EVENT_DISPATCH_TABLE NewTable = NULL;
+    PLIST_ENTRY                    TargetEventList;
+    PLIST_ENTRY                    TempList = 0;
+    UINT32                         NumberOfEvents;
+    UINT32                         Index;
+    UINT32                         i = 0;
+
+    if (!EventPublicationGetIndexByEventType(EventType, &Index))
+    {
+        return FALSE;
+    }
+
+    TargetEventList = DebuggerGetEventListByEventType(EventType);
+
+    SpinlockLock(&g_EventPublicationLock);
+
+    //
+    // Reuse the memory of the old tables (if possible) before allocating new ones
+    //
+    EventPublicationReclaimLocked();
+
+    NumberOfEvents = DebuggerEventListCount(TargetEventList);
+
+    if (NumberOfEvents != 0)
+    {
+        NewTable = EventPublicationAllocateDispatchTable(NumberOfEvents);
+
+        if (NewTable == NULL)
+        {
+            SpinlockUnlock(&g_EventPublicationLock);
+            return FALSE;
+        }
+
+        //
+        // Keep the same order as of the list of events
+        //
+        TempList = TargetEventList;
+
+        while (TargetEventList != TempList->Flink)
+        {
+            TempList               = TempList->Flink;
+            NewTable->Events[i++] = CONTAINING_RECORD(TempList, DEBUGGER_EVENT, EventsOfSameTypeList);
+        }
+    }
+
+    EventPublicationSwapDispatchTable(Index, NewTable);
+
+    SpinlockUnlock(&g_EventPublicationLock);
+
+    return TRUE;
+}
+
+/**
+ * @brief Unpublish an event that is removed from the list of events
+ * @details The published tables are never modified, a new table without the
+ * event is published instead, the event itself should be retired afterward
+ *
+ * @param Event The removed event
+ *
+ * @return BOOLEAN Returns FALSE if the new table could not be allocated (e.g.,
+ * no pre-allocated pool in VMX-root), the event remains published
+ */
+BOOLEAN
+EventPublicationUnpublishEvent(PDEBUGGER_EVENT Event)
+{
+    return EventPublicationPublishEventList(Event->EventType);
+}
+
+/**
+ * @brief Retire a removed (and unpublished) event
+ * @details The event and its actions are freed once all of the readers
+ * that might hold a reference to it are finished
+ *
+ * @param Event The removed event
+ * @param PoolManagerAllocatedMemory Whether the pools are allocated from the
+ * pool manager or original OS pools
+ *
+ * @return VOID
+ */
+VOID
+EventPublicationRetireEvent(PDEBUGGER_EVENT Event, BOOLEAN PoolManagerAllocatedMemory)
+{
+    SpinlockLock(&g_EventPublicationLock);
+
+    Event->PoolManagerAllocatedMemory = PoolManagerAllocatedMemory;
+    Event->RetiredEpoch               = (UINT64)InterlockedIncrement64(&g_EventPublicationEpoch);
+
+    InsertTailList(&g_RetiredEventsHead, &Event->RetiredEventsList);
+
+    InterlockedIncrement(&g_EventPublicationNumberOfRetiredObjects);
+
+    SpinlockUnlock(&g_EventPublicationLock);
+}
+
+/**
+ * @brief Enter the read-side of the published events
+ * @details Should be paired with EventPublicationReaderExit, the returned
+ * table remains valid until then
+ *
+ * @param DbgState The state of the debugger on the current core
+ * @param EventType Type of events
+ *
+ * @return PDEBUGGER_EVENT_DISPATCH_TABLE The published table or NULL if there
+ * is no event of this type
+ */
+PDEBUGGER_EVENT_DISPATCH_TABLE
+EventPublicationReaderEnter(PROCESSOR_DEBUGGING_STATE * DbgState, VMM_EVENT_TYPE_ENUM EventType)
+{
+    UINT32 Index;
+
+    //
+    // Announce the current epoch (the full barrier of the interlocked operation
+    // guarantees that the table is read after the announcement)
+    //
+    if (DbgState->EventPublicationReaderNesting++ == 0)
+    {
+        InterlockedExchange64(&DbgState->EventPublicationEpoch,
+                              InterlockedCompareExchange64(&g_EventPublicationEpoch, 0, 0));
+    }
+
+    if (!EventPublicationGetIndexByEventType(EventType, &Index))
+    {
+        return NULL;
+    }
+
+    return (PDEBUGGER_EVENT_DISPATCH_TABLE)ReadPointerAcquire((PVOID volatile *)&g_EventDispatchTables[Index]);
+}
+
+/**
+ * @brief Leave the read-side of the published events (quiescent point)
+ * @details The retired objects whose grace period is ended by this core are
+ * reclaimed here, the lock is only tried as the writer might be interrupted
+ * by this core while holding it
+ *
+ * @param DbgState The state of the debugger on the current core
+ *
+ * @return VOID
+ */
+VOID
+EventPublicationReaderExit(PROCESSOR_DEBUGGING_STATE * DbgState)
+{
+    if (--DbgState->EventPublicationReaderNesting != 0)
+    {
+        return;
+    }
+
+    InterlockedExchange64(&DbgState->EventPublicationEpoch, EVENT_PUBLICATION_QUIESCENT_EPOCH);
+
+    if (g_EventPublicationNumberOfRetiredObjects != 0 && SpinlockTryLock(&g_EventPublicationLock))
+    {
+        EventPublicationReclaimLocked();
+
+        SpinlockUnlock(&g_EventPublicationLock);
+    }
+}
+
+/**
+ * @brief Uninitialize the event publication mechanism
+ * @details should be called after all of the events are removed and the
+ * cores are resumed (not halted in the debugger)
+ *
+ * @return VOID
+ */
+VOID
+EventPublicationUninitialize()
+{
+    SpinlockLock(&g_EventPublicationLock);
+
+    for (UINT32 i = 0; i < EVENT_PUBLICATION_NUMBER_OF_EVENT_LISTS; i++)
+    {
+        if (g_EventDispatchTables[i] != NULL)
+        {
+            EventPublicationSwapDispatchTable(i, NULL);
+        }
+    }
+
+    SpinlockUnlock(&g_EventPublicationLock);
+
+    //
+    // Wait for the readers that might still use the retired objects, the
+    // objects of a reader that never leaves are not freed (rather than freeing
+    // them under its feet)
+    //
+    if (!EventPublicationWaitForReaders((UINT64)InterlockedCompareExchange64(&g_EventPublicationEpoch, 0, 0)))
+    {
+        LogWarning("Warning, the events are still in use by a core, %d retired object(s) are not freed",
+                   g_EventPublicationNumberOfRetiredObjects);
+    }
+
+    SpinlockLock(&g_EventPublicationLock);
+
+    EventPublicationReclaimLocked();
+
+    SpinlockUnlock(&g_EventPublicationLock);
+}
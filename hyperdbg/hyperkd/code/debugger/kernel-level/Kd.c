@@ -106,6 +106,190 @@ KdUninitializeKernelDebugger()
         // so, not intercept #DBs and #BP by changing exception bitmap (one core)
         //
         BroadcastDisableDbAndBpExitingAllCores();
+
+        //
+        // Stop compressing the messages
+        //
+        KdUninitializeLogCompression();
+
+        //
+        // Free the buffers of streaming the dump
+        //
+        KdUninitializeDumpStreaming();
+
+        //
+        // Free the buffer of the break context
+        //
+        KdUninitializeBreakContext();
+
+        //
+        // The next connection starts without framing
+        //
+        SerialConnectionUninitializeFraming();
+    }
+}
+
+/**
+ * @brief Initialize the compression of the messages that are sent to the debugger
+ * @details If the allocation fails, messages are sent without compression
+ *
+ * @return VOID
+ */
+VOID
+KdInitializeLogCompression()
+{
+    KD_LOG_COMPRESSION * LogCompression;
+
+    if (g_KdLogCompression != NULL)
+    {
+        return;
+    }
+
+    LogCompression = PlatformMemAllocateNonPagedPool(sizeof(KD_LOG_COMPRESSION));
+
+    if (LogCompression == NULL)
+    {
+        LogWarning("Warning, unable to allocate the compression buffer, messages are sent without compression");
+        return;
+    }
+
+    //
+    // The first message resets the stream of the debugger
+    //
+    CompressionResetStream(&LogCompression->Stream);
+    LogCompression->NumberOfMessagesSinceReset = 0;
+
+    g_KdLogCompression = LogCompression;
+}
+
+/**
+ * @brief Uninitialize the compression of the messages that are sent to the debugger
+ *
+ * @details this function should be called on vmx non-root
+ *
+ * @return VOID
+ */
+VOID
+KdUninitializeLogCompression()
+{
+    KD_LOG_COMPRESSION * LogCompression;
+
+    //
+    // Make sure, nobody is in the middle of sending a compressed message
+    //
+    SpinlockLock(&DebuggerResponseLock);
+
+    LogCompression     = g_KdLogCompression;
+    g_KdLogCompression = NULL;
+
+    SpinlockUnlock(&DebuggerResponseLock);
+
+    if (LogCompression != NULL)
+    {
+        PlatformMemFreePool(LogCompression);
+    }
+}
+
+/**
+ * @brief Initialize the buffers of streaming the dump to the debugger
+ * @details If the allocation fails, the debugger reads the dump page by page
+ *
+ * @return VOID
+ */
+VOID
+KdInitializeDumpStreaming()
+{
+    KD_DUMP_MEMORY_STREAM * DumpStream;
+
+    if (g_KdDumpMemoryStream != NULL)
+    {
+        return;
+    }
+
+    DumpStream = PlatformMemAllocateNonPagedPool(sizeof(KD_DUMP_MEMORY_STREAM));
+
+    if (DumpStream == NULL)
+    {
+        LogWarning("Warning, unable to allocate the buffers of streaming the dump, the dump is read page by page");
+        return;
+    }
+
+    g_KdDumpMemoryStream = DumpStream;
+}
+
+/**
+ * @brief Uninitialize the buffers of streaming the dump to the debugger
+ *
+ * @details this function should be called on vmx non-root
+ *
+ * @return VOID
+ */
+VOID
+KdUninitializeDumpStreaming()
+{
+    KD_DUMP_MEMORY_STREAM * DumpStream;
+
+    DumpStream           = g_KdDumpMemoryStream;
+    g_KdDumpMemoryStream = NULL;
+
+    if (DumpStream != NULL)
+    {
+        PlatformMemFreePool(DumpStream);
+    }
+}
+
+/**
+ * @brief Initialize the buffer of sending the context of the core along
+ * with the pause packet
+ * @details If the allocation fails, only the pause packet is sent
+ *
+ * @param CodeBytes Number of the bytes at RIP
+ * @param StackQwords Number of the qwords at RSP
+ *
+ * @return VOID
+ */
+VOID
+KdInitializeBreakContext(UINT32 CodeBytes, UINT32 StackQwords)
+{
+    KD_BREAK_CONTEXT * BreakContext;
+
+    if (g_KdBreakContext != NULL)
+    {
+        return;
+    }
+
+    BreakContext = PlatformMemAllocateNonPagedPool(sizeof(KD_BREAK_CONTEXT));
+
+    if (BreakContext == NULL)
+    {
+        LogWarning("Warning, unable to allocate the buffer of the break context, only the pause packet is sent");
+        return;
+    }
+
+    BreakContext->CodeBytes   = CodeBytes <= DEBUGGEE_BREAK_CONTEXT_MAXIMUM_CODE_BYTES ? CodeBytes : DEBUGGEE_BREAK_CONTEXT_MAXIMUM_CODE_BYTES;
+    BreakContext->StackQwords = StackQwords <= DEBUGGEE_BREAK_CONTEXT_MAXIMUM_STACK_QWORDS ? StackQwords : DEBUGGEE_BREAK_CONTEXT_MAXIMUM_STACK_QWORDS;
+
+    g_KdBreakContext = BreakContext;
+}
+
+/**
+ * @brief Uninitialize the buffer of sending the context of the core
+ *
+ * @details this function should be called on vmx non-root
+ *
+ * @return VOID
+ */
+VOID
+KdUninitializeBreakContext()
+{
+    KD_BREAK_CONTEXT * BreakContext;
+
+    BreakContext     = g_KdBreakContext;
+    g_KdBreakContext = NULL;
+
+    if (BreakContext != NULL)
+    {
+        PlatformMemFreePool(BreakContext);
     }
 }
 
@@ -140,6 +324,13 @@ KdInitializeInstantEventPools()
     //
     PoolManagerRequestAllocation(REGULAR_INSTANT_EVENT_ACTION_BUFFER, MAXIMUM_REGULAR_INSTANT_EVENTS, INSTANT_REGULAR_EVENT_ACTION_BUFFER);
 
+    //
+    // Request pages to be allocated for publishing the dispatch tables of events
+    //
+    PoolManagerRequestAllocation(INSTANT_EVENT_DISPATCH_TABLE_BUFFER,
+                                 MAXIMUM_REGULAR_INSTANT_EVENTS * INSTANT_EVENT_DISPATCH_TABLES_PER_EVENT,
+                                 INSTANT_EVENT_DISPATCH_TABLE);
+
 #if MAXIMUM_BIG_INSTANT_EVENTS >= 1
 
     //
@@ -401,19 +592,356 @@ KdLoggingResponsePacketToDebugger(
     // Check if we're in Vmx-root, if it is then we use our customized HIGH_IRQL Spinlock,
     // if not we use the windows spinlock
     //
+    SpinlockLock(&DebuggerResponseLock);
 
-    ScopedSpinlock(
-        DebuggerResponseLock,
+    //
+    // Try to send the message in the compressed form, if it's not possible,
+    // then the message is sent as it is
+    //
+    Result = KdCompressedLoggingResponsePacketToDebugger(OptionalBuffer, OptionalBufferLength, OperationCode);
+
+    if (!Result)
+    {
         Result = SerialConnectionSendThreeBuffers((CHAR *)&Packet,
                                                   sizeof(DEBUGGER_REMOTE_PACKET),
                                                   (CHAR *)&OperationCode,
                                                   sizeof(UINT32),
                                                   OptionalBuffer,
-                                                  OptionalBufferLength));
+                                                  OptionalBufferLength);
+    }
+
+    SpinlockUnlock(&DebuggerResponseLock);
 
     return Result;
 }
 
+/**
+ * @brief Sends a compressed message to the debugger
+ * @details Should be called while DebuggerResponseLock is held. The message
+ * is compressed against the previous messages, if it's not compressible, then
+ * it's stored in the packet without compression (it's still added to the stream)
+ *
+ * @param OptionalBuffer The message
+ * @param OptionalBufferLength Length of the message
+ * @param OperationCode Operation code of the message
+ *
+ * @return BOOLEAN FALSE if the message is not sent (it should be sent without
+ * compression)
+ */
+static BOOLEAN
+KdCompressedLoggingResponsePacketToDebugger(CHAR * OptionalBuffer,
+                                            UINT32 OptionalBufferLength,
+                                            UINT32 OperationCode)
+{
+    DEBUGGER_REMOTE_PACKET               Packet = {0};
+    KD_LOG_COMPRESSION *                 LogCompression;
+    DEBUGGEE_COMPRESSED_MESSAGE_PACKET * Header;
+    UINT8 *                              Block;
+    UINT32                               CompressedLength;
+    UINT32                               PacketLength;
+
+    LogCompression = g_KdLogCompression;
+
+    if (LogCompression == NULL || OptionalBufferLength == 0 || OptionalBufferLength > PacketChunkSize)
+    {
+        return FALSE;
+    }
+
+    //
+    // Reset the stream periodically, so the debugger can decompress the
+    // next messages if a packet is lost
+    //
+    if (LogCompression->NumberOfMessagesSinceReset >= DEBUGGEE_COMPRESSION_RESET_INTERVAL)
+    {
+        CompressionResetStream(&LogCompression->Stream);
+        LogCompression->NumberOfMessagesSinceReset = 0;
+    }
+
+    Header = (DEBUGGEE_COMPRESSED_MESSAGE_PACKET *)LogCompression->Packet;
+    Block  = LogCompression->Packet + sizeof(DEBUGGEE_COMPRESSED_MESSAGE_PACKET);
+
+    Header->StreamOffset       = LogCompression->Stream.StreamOffset;
+    Header->OperationCode      = OperationCode;
+    Header->UncompressedLength = OptionalBufferLength;
+
+    //
+    // The compressed block should be smaller than the message
+    //
+    CompressedLength = CompressionCompress(&LogCompression->Stream,
+                                           OptionalBuffer,
+                                           OptionalBufferLength,
+                                           Block,
+                                           OptionalBufferLength - 1);
+
+    LogCompression->NumberOfMessagesSinceReset++;
+
+    PacketLength = sizeof(DEBUGGEE_COMPRESSED_MESSAGE_PACKET) + CompressedLength;
+
+    //
+    // The compressed block might contain the end of buffer characters (if the
+    // packets are not framed), in that case (or if it's not compressible), the
+    // message is stored without compression
+    //
+    if (CompressedLength == 0 ||
+        SerialConnectionCheckBufferForEndOfBuffer((CHAR *)LogCompression->Packet, PacketLength))
+    {
+        CompressedLength = OptionalBufferLength;
+        memcpy(Block, OptionalBuffer, OptionalBufferLength);
+
+        PacketLength = sizeof(DEBUGGEE_COMPRESSED_MESSAGE_PACKET) + CompressedLength;
+    }
+
+    Header->CompressedLength = CompressedLength;
+
+    //
+    // Make the packet's structure
+    //
+    Packet.Indicator                  = INDICATOR_OF_HYPERDBG_PACKET;
+    Packet.TypeOfThePacket            = DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER;
+    Packet.RequestedActionOfThePacket = DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_COMPRESSED_LOGGING_MECHANISM;
+
+    //
+    // Calculate checksum
+    //
+    Packet.Checksum = KdComputeDataChecksum((PVOID)((UINT64)&Packet + 1),
+                                            sizeof(DEBUGGER_REMOTE_PACKET) - sizeof(BYTE));
+
+    Packet.Checksum += KdComputeDataChecksum((PVOID)LogCompression->Packet, PacketLength);
+
+    return SerialConnectionSendTwoBuffers((CHAR *)&Packet,
+                                          sizeof(DEBUGGER_REMOTE_PACKET),
+                                          (CHAR *)LogCompression->Packet,
+                                          PacketLength);
+}
+
+/**
+ * @brief Check whether a buffer is filled with one byte or not
+ *
+ * @param Buffer
+ * @param Length
+ * @param Fill The byte that the buffer is filled with
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+KdDumpMemoryIsFilled(UINT8 * Buffer, UINT32 Length, UINT8 * Fill)
+{
+    UINT64 Pattern;
+    UINT64 Word;
+    UINT32 i = 0;
+
+    Pattern = Buffer[0] * (UINT64)0x0101010101010101;
+
+    for (; i + sizeof(UINT64) <= Length; i += sizeof(UINT64))
+    {
+        memcpy(&Word, &Buffer[i], sizeof(UINT64));
+
+        if (Word != Pattern)
+        {
+            return FALSE;
+        }
+    }
+
+    for (; i < Length; i++)
+    {
+        if (Buffer[i] != Buffer[0])
+        {
+            return FALSE;
+        }
+    }
+
+    *Fill = Buffer[0];
+
+    return TRUE;
+}
+
+/**
+ * @brief Stream a range of memory to the debugger ('.dump' command)
+ * @details The range is read page by page and the pages are packed into
+ * chunks of several pages (up to the maximum size of the serial packets).
+ * Consecutive pages that are filled with the same byte (e.g., zero pages)
+ * or couldn't be read are sent as one record, and the other pages are
+ * compressed against the previous pages of the same chunk if the debugger
+ * asked for it. The result is saved in the packet (it's sent after the chunks)
+ *
+ * @param DumpPacket
+ *
+ * @return VOID
+ */
+static VOID
+KdDumpMemoryToDebugger(PDEBUGGEE_DUMP_MEMORY_PACKET DumpPacket)
+{
+    KD_DUMP_MEMORY_STREAM *             DumpStream = g_KdDumpMemoryStream;
+    DEBUGGEE_DUMP_MEMORY_CHUNK_PACKET * Chunk;
+    DEBUGGEE_DUMP_MEMORY_RECORD *       Record;
+    DEBUGGEE_DUMP_MEMORY_RECORD *       LastRecord  = NULL;
+    DEBUGGER_READ_MEMORY                ReadMem     = {0};
+    UINT32                              ChunkLength = 0;
+    UINT32                              Offset;
+    UINT32                              UnitLength;
+    UINT32                              ReturnSize;
+    UINT32                              StoredLength;
+    UINT8                               Type;
+    UINT8                               Fill = 0;
+
+    DumpPacket->NumberOfChunks    = 0;
+    DumpPacket->TransferredLength = 0;
+
+    //
+    // The pages are not safe to be sent if the packets are not framed
+    // (they might contain the end of buffer characters)
+    //
+    if (DumpStream == NULL || !g_KdFramedPackets)
+    {
+        DumpPacket->KernelStatus = DEBUGGER_ERROR_DUMP_STREAMING_IS_NOT_AVAILABLE;
+        return;
+    }
+
+    if (DumpPacket->MemoryType != DEBUGGER_READ_PHYSICAL_ADDRESS &&
+        DumpPacket->MemoryType != DEBUGGER_READ_VIRTUAL_ADDRESS)
+    {
+        DumpPacket->KernelStatus = DEBUGGER_ERROR_MEMORY_TYPE_INVALID;
+        return;
+    }
+
+    Chunk = (DEBUGGEE_DUMP_MEMORY_CHUNK_PACKET *)DumpStream->Chunk;
+
+    ReadMem.MemoryType  = DumpPacket->MemoryType;
+    ReadMem.ReadingType = READ_FROM_KERNEL;
+
+    for (Offset = 0; Offset < DumpPacket->Length; Offset += UnitLength)
+    {
+        UnitLength = DumpPacket->Length - Offset >= PAGE_SIZE ? PAGE_SIZE : DumpPacket->Length - Offset;
+
+        //
+        // Send the chunk if the next page might not fit in it
+        //
+        if (ChunkLength != 0 && ChunkLength + sizeof(DEBUGGEE_DUMP_MEMORY_RECORD) + UnitLength > KD_DUMP_MEMORY_CHUNK_SIZE)
+        {
+            KdResponsePacketToDebugger(DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
+                                       DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_DUMP_MEMORY_CHUNK,
+                                       (CHAR *)DumpStream->Chunk,
+                                       ChunkLength);
+
+            DumpPacket->NumberOfChunks++;
+            DumpPacket->TransferredLength += ChunkLength;
+
+            ChunkLength = 0;
+        }
+
+        //
+        // Each chunk starts a new compression stream, so the debugger
+        // could decode the next chunks if a chunk is lost
+        //
+        if (ChunkLength == 0)
+        {
+            Chunk->ChunkIndex      = DumpPacket->NumberOfChunks;
+            Chunk->Offset          = Offset;
+            Chunk->Length          = 0;
+            Chunk->NumberOfRecords = 0;
+
+            ChunkLength = sizeof(DEBUGGEE_DUMP_MEMORY_CHUNK_PACKET);
+            LastRecord  = NULL;
+
+            CompressionResetStream(&DumpStream->Stream);
+        }
+
+        //
+        // Read the page (the bytes of the breakpoints are also restored)
+        //
+        ReadMem.Address = DumpPacket->Address + Offset;
+        ReadMem.Size    = UnitLength;
+
+        if (!DebuggerCommandReadMemoryVmxRoot(&ReadMem, DumpStream->Page, &ReturnSize))
+        {
+            Type = DEBUGGEE_DUMP_MEMORY_RECORD_INVALID;
+        }
+        else if (KdDumpMemoryIsFilled(DumpStream->Page, UnitLength, &Fill))
+        {
+            Type = DEBUGGEE_DUMP_MEMORY_RECORD_FILL;
+        }
+        else
+        {
+            Type = DEBUGGEE_DUMP_MEMORY_RECORD_RAW;
+        }
+
+        Chunk->Length += UnitLength;
+
+        //
+        // Extend the previous record if it's the same run
+        //
+        if (LastRecord != NULL &&
+            LastRecord->Type == Type &&
+            (Type == DEBUGGEE_DUMP_MEMORY_RECORD_INVALID || (Type == DEBUGGEE_DUMP_MEMORY_RECORD_FILL && LastRecord->Fill == Fill)))
+        {
+            LastRecord->Length += UnitLength;
+            continue;
+        }
+
+        Record = (DEBUGGEE_DUMP_MEMORY_RECORD *)(DumpStream->Chunk + ChunkLength);
+
+        Record->Length       = UnitLength;
+        Record->StoredLength = 0;
+        Record->Type         = Type;
+        Record->Fill         = Type == DEBUGGEE_DUMP_MEMORY_RECORD_FILL ? Fill : 0;
+        Record->Reserved     = 0;
+
+        ChunkLength += sizeof(DEBUGGEE_DUMP_MEMORY_RECORD);
+
+        if (Type == DEBUGGEE_DUMP_MEMORY_RECORD_RAW)
+        {
+            StoredLength = 0;
+
+            //
+            // The compressed page should be smaller than the page
+            //
+            if (DumpPacket->Compress)
+            {
+                StoredLength = CompressionCompress(&DumpStream->Stream,
+                                                   DumpStream->Page,
+                                                   UnitLength,
+                                                   DumpStream->Chunk + ChunkLength,
+                                                   UnitLength - 1);
+            }
+
+            if (StoredLength != 0)
+            {
+                Record->Type = DEBUGGEE_DUMP_MEMORY_RECORD_COMPRESSED;
+            }
+            else
+            {
+                //
+                // The page is stored without compression (it's still added to the stream)
+                //
+                memcpy(DumpStream->Chunk + ChunkLength, DumpStream->Page, UnitLength);
+                StoredLength = UnitLength;
+            }
+
+            Record->StoredLength = StoredLength;
+            ChunkLength += StoredLength;
+        }
+
+        Chunk->NumberOfRecords++;
+        LastRecord = Record;
+    }
+
+    //
+    // Send the last chunk
+    //
+    if (ChunkLength != 0)
+    {
+        KdResponsePacketToDebugger(DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
+                                   DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_DUMP_MEMORY_CHUNK,
+                                   (CHAR *)DumpStream->Chunk,
+                                   ChunkLength);
+
+        DumpPacket->NumberOfChunks++;
+        DumpPacket->TransferredLength += ChunkLength;
+    }
+
+    DumpPacket->KernelStatus = DEBUGGER_OPERATION_WAS_SUCCESSFUL;
+}
+
 /**
  * @brief Handles debug events when kernel-debugger is attached
  *
@@ -627,6 +1155,26 @@ KdContinueDebuggeeJustCurrentCore(PROCESSOR_DEBUGGING_STATE * DbgState)
     SpinlockUnlock(&DbgState->Lock);
 }
 
+/**
+ * @brief read the segment registers, rflags and rip of the current core
+ * @param ExtraRegs
+ *
+ * @return VOID
+ */
+_Use_decl_annotations_
+VOID
+KdReadExtraRegisters(PGUEST_EXTRA_REGISTERS ExtraRegs)
+{
+    ExtraRegs->CS     = (UINT16)DebuggerGetRegValueWrapper(NULL, REGISTER_CS);
+    ExtraRegs->SS     = (UINT16)DebuggerGetRegValueWrapper(NULL, REGISTER_SS);
+    ExtraRegs->DS     = (UINT16)DebuggerGetRegValueWrapper(NULL, REGISTER_DS);
+    ExtraRegs->ES     = (UINT16)DebuggerGetRegValueWrapper(NULL, REGISTER_ES);
+    ExtraRegs->FS     = (UINT16)DebuggerGetRegValueWrapper(NULL, REGISTER_FS);
+    ExtraRegs->GS     = (UINT16)DebuggerGetRegValueWrapper(NULL, REGISTER_GS);
+    ExtraRegs->RFLAGS = DebuggerGetRegValueWrapper(NULL, REGISTER_RFLAGS);
+    ExtraRegs->RIP    = DebuggerGetRegValueWrapper(NULL, REGISTER_RIP);
+}
+
 /**
  * @brief read registers
  * @param DbgState The state of the debugger on the current core
@@ -652,14 +1200,7 @@ KdReadRegisters(PROCESSOR_DEBUGGING_STATE * DbgState, PDEBUGGEE_REGISTER_READ_DE
         //
         // Read Extra registers
         //
-        ERegs.CS     = (UINT16)DebuggerGetRegValueWrapper(NULL, REGISTER_CS);
-        ERegs.SS     = (UINT16)DebuggerGetRegValueWrapper(NULL, REGISTER_SS);
-        ERegs.DS     = (UINT16)DebuggerGetRegValueWrapper(NULL, REGISTER_DS);
-        ERegs.ES     = (UINT16)DebuggerGetRegValueWrapper(NULL, REGISTER_ES);
-        ERegs.FS     = (UINT16)DebuggerGetRegValueWrapper(NULL, REGISTER_FS);
-        ERegs.GS     = (UINT16)DebuggerGetRegValueWrapper(NULL, REGISTER_GS);
-        ERegs.RFLAGS = DebuggerGetRegValueWrapper(NULL, REGISTER_RFLAGS);
-        ERegs.RIP    = DebuggerGetRegValueWrapper(NULL, REGISTER_RIP);
+        KdReadExtraRegisters(&ERegs);
 
         //
         // copy at the end of ReadRegisterRequest structure
@@ -812,8 +1353,8 @@ KdCheckUserModePriorityBuffers()
     //
     if (LogCallbackCheckIfBufferIsFull(TRUE))
     {
-        LogWarning("Warning, the user-mode priority buffers are full, thus the new action replaces "
-                   "previously unserviced actions. As the result, some functionalities might not work correctly!\n"
+        LogWarning("Warning, the user-mode priority buffers are full, thus the new action is discarded "
+                   "until previously unserviced actions are served. As the result, some functionalities might not work correctly!\n"
                    "For more information please visit: https://docs.hyperdbg.org/tips-and-tricks/misc/instant-events\n");
     }
 }
@@ -2086,6 +2627,16 @@ KdPerformEventQueryAndModification(PDEBUGGER_MODIFY_EVENTS ModifyAndQueryEvent)
     BOOLEAN IsForAllEvents   = FALSE;
     BOOLEAN ContinueDebugger = FALSE;
 
+    //
+    // Check if it's a modification of the groups of events (the debuggee
+    // is not continued for these modifications)
+    //
+    if (EventGroupsIsGroupModification(ModifyAndQueryEvent->TypeOfAction))
+    {
+        EventGroupsPerformModification(ModifyAndQueryEvent);
+        return FALSE;
+    }
+
     //
     // Check if the tag is valid or not
     //
@@ -2301,6 +2852,7 @@ KdDispatchAndPerformCommandsFromDebugger(PROCESSOR_DEBUGGING_STATE * DbgState)
     PDEBUGGEE_REGISTER_WRITE_DESCRIPTION                WriteRegisterPacket;
     PDEBUGGER_READ_MEMORY                               ReadMemoryPacket;
     PDEBUGGER_EDIT_MEMORY                               EditMemoryPacket;
+    PDEBUGGEE_DUMP_MEMORY_PACKET                        DumpMemoryPacket;
     PDEBUGGEE_DETAILS_AND_SWITCH_PROCESS_PACKET         ChangeProcessPacket;
     PDEBUGGEE_DETAILS_AND_SWITCH_THREAD_PACKET          ChangeThreadPacket;
     PDEBUGGEE_SCRIPT_PACKET                             ScriptPacket;
@@ -2728,6 +3280,25 @@ KdDispatchAndPerformCommandsFromDebugger(PROCESSOR_DEBUGGING_STATE * DbgState)
 
                 break;
 
+            case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_DUMP_MEMORY:
+
+                DumpMemoryPacket = (DEBUGGEE_DUMP_MEMORY_PACKET *)(((CHAR *)TheActualPacket) + sizeof(DEBUGGER_REMOTE_PACKET));
+
+                //
+                // Send the range as chunks
+                //
+                KdDumpMemoryToDebugger(DumpMemoryPacket);
+
+                //
+                // Send the result of the dump back to the debugger (after the chunks)
+                //
+                KdResponsePacketToDebugger(DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
+                                           DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_DUMP_MEMORY,
+                                           (CHAR *)DumpMemoryPacket,
+                                           sizeof(DEBUGGEE_DUMP_MEMORY_PACKET));
+
+                break;
+
             case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_MODE_CHANGE_PROCESS:
 
                 ChangeProcessPacket = (DEBUGGEE_DETAILS_AND_SWITCH_PROCESS_PACKET *)(((CHAR *)TheActualPacket) + sizeof(DEBUGGER_REMOTE_PACKET));
@@ -3230,6 +3801,107 @@ KdIsGuestOnUsermode32Bit()
     return FALSE;
 }
 
+/**
+ * @brief Read the memory of the break context
+ * @details If the range is not available, only the bytes till the end of
+ * the first page are read (e.g., the end of the stack or the code)
+ *
+ * @param Address
+ * @param Buffer
+ * @param Length
+ * @param AddressMode The mode of the address (NULL if it's not needed)
+ *
+ * @return UINT32 The number of the read bytes
+ */
+static UINT32
+KdBreakContextReadMemory(UINT64 Address, UINT8 * Buffer, UINT32 Length, DEBUGGER_READ_MEMORY_ADDRESS_MODE * AddressMode)
+{
+    DEBUGGER_READ_MEMORY ReadMem    = {0};
+    UINT32               ReturnSize = 0;
+    UINT32               LengthOfFirstPage;
+
+    if (Length == 0)
+    {
+        return 0;
+    }
+
+    ReadMem.Address        = Address;
+    ReadMem.Size           = Length;
+    ReadMem.MemoryType     = DEBUGGER_READ_VIRTUAL_ADDRESS;
+    ReadMem.ReadingType    = READ_FROM_KERNEL;
+    ReadMem.GetAddressMode = AddressMode != NULL;
+
+    //
+    // The bytes of the breakpoints are also restored (same as the 'u' and 'd*' commands)
+    //
+    if (!DebuggerCommandReadMemoryVmxRoot(&ReadMem, Buffer, &ReturnSize))
+    {
+        LengthOfFirstPage = PAGE_SIZE - (UINT32)(Address & (PAGE_SIZE - 1));
+
+        if (LengthOfFirstPage >= Length)
+        {
+            return 0;
+        }
+
+        ReadMem.Size = LengthOfFirstPage;
+
+        if (!DebuggerCommandReadMemoryVmxRoot(&ReadMem, Buffer, &ReturnSize))
+        {
+            return 0;
+        }
+    }
+
+    if (AddressMode != NULL)
+    {
+        *AddressMode = ReadMem.AddressMode;
+    }
+
+    return ReturnSize;
+}
+
+/**
+ * @brief Fill the pause packet along with the context of the core
+ * @details The registers, the bytes at RIP and the qwords at RSP are sent
+ * with the pause packet, so the debugger doesn't need to request them
+ * after each break (e.g., for showing the registers or the stack)
+ *
+ * @param DbgState The state of the debugger on the current core
+ * @param PausePacket
+ *
+ * @return UINT32 Length of the packet (in g_KdBreakContext)
+ */
+static UINT32
+KdBreakContextFillPacket(PROCESSOR_DEBUGGING_STATE * DbgState, DEBUGGEE_KD_PAUSED_PACKET * PausePacket)
+{
+    KD_BREAK_CONTEXT *                BreakContext = g_KdBreakContext;
+    DEBUGGEE_KD_BREAK_CONTEXT *       Context;
+    UINT8 *                           Bytes;
+    DEBUGGER_READ_MEMORY_ADDRESS_MODE AddressMode = DEBUGGER_READ_ADDRESS_MODE_64_BIT;
+
+    memcpy(BreakContext->Packet, PausePacket, sizeof(DEBUGGEE_KD_PAUSED_PACKET));
+
+    Context = (DEBUGGEE_KD_BREAK_CONTEXT *)(BreakContext->Packet + sizeof(DEBUGGEE_KD_PAUSED_PACKET));
+    Bytes   = BreakContext->Packet + sizeof(DEBUGGEE_KD_PAUSED_PACKET) + sizeof(DEBUGGEE_KD_BREAK_CONTEXT);
+
+    //
+    // Same registers as the 'r' command
+    //
+    memcpy(&Context->Regs, DbgState->Regs, sizeof(GUEST_REGS));
+    KdReadExtraRegisters(&Context->ExtraRegs);
+
+    Context->CodeAddress     = PausePacket->Rip;
+    Context->CodeLength      = KdBreakContextReadMemory(Context->CodeAddress, Bytes, BreakContext->CodeBytes, &AddressMode);
+    Context->CodeAddressMode = AddressMode;
+
+    Context->StackAddress = DbgState->Regs->rsp;
+    Context->StackLength  = KdBreakContextReadMemory(Context->StackAddress,
+                                                    Bytes + Context->CodeLength,
+                                                    BreakContext->StackQwords * sizeof(UINT64),
+                                                    NULL);
+
+    return sizeof(DEBUGGEE_KD_PAUSED_PACKET) + sizeof(DEBUGGEE_KD_BREAK_CONTEXT) + Context->CodeLength + Context->StackLength;
+}
+
 /**
  * @brief manage system halt on vmx-root mode
  * @details This function should only be called from KdHandleBreakpointAndDebugBreakpoints
@@ -3247,6 +3919,7 @@ KdManageSystemHaltOnVmxRoot(PROCESSOR_DEBUGGING_STATE *       DbgState,
     ULONG                     ExitInstructionLength = 0;
     RFLAGS                    Rflags                = {0};
     UINT64                    LastVmexitRip         = 0;
+    UINT32                    PacketLength;
 
     //
     // Perform Pre-halt tasks
@@ -3344,10 +4017,25 @@ StartAgain:
         // Send the pause packet, along with RIP and an indication
         // to pause to the debugger
         //
-        KdResponsePacketToDebugger(DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
-                                   DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_PAUSED_AND_CURRENT_INSTRUCTION,
-                                   (CHAR *)&PausePacket,
-                                   sizeof(DEBUGGEE_KD_PAUSED_PACKET));
+        if (g_KdBreakContext != NULL)
+        {
+            //
+            // The context of the core comes after the pause packet
+            //
+            PacketLength = KdBreakContextFillPacket(DbgState, &PausePacket);
+
+            KdResponsePacketToDebugger(DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
+                                       DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_PAUSED_AND_CURRENT_INSTRUCTION,
+                                       (CHAR *)g_KdBreakContext->Packet,
+                                       PacketLength);
+        }
+        else
+        {
+            KdResponsePacketToDebugger(DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
+                                       DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_PAUSED_AND_CURRENT_INSTRUCTION,
+                                       (CHAR *)&PausePacket,
+                                       sizeof(DEBUGGEE_KD_PAUSED_PACKET));
+        }
 
         //
         // Perform Commands from the debugger
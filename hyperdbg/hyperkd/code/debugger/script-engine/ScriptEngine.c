@@ -121,3 +121,132 @@ ScriptEngineGetTargetCoreDate()
     //
     return (UINT64)&DbgState->DateTimeHolder.DateBuffer;
 }
+
+/**
+ * @brief Check whether the predicate is in the form that is lowered by the
+ * script engine (simple operator and operands without side effect)
+ *
+ * @param Predicate The predicate to check
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+ScriptEngineIsConditionPredicateValid(PDEBUGGER_SCRIPT_CONDITION_PREDICATE Predicate)
+{
+    UINT64 OperandTypes[2]  = {Predicate->Operand0Type, Predicate->Operand1Type};
+    UINT64 OperandValues[2] = {Predicate->Operand0Value, Predicate->Operand1Value};
+
+    switch (Predicate->Operator)
+    {
+    case FUNC_GT:
+    case FUNC_LT:
+    case FUNC_EGT:
+    case FUNC_ELT:
+    case FUNC_EQUAL:
+    case FUNC_NEQ:
+    case FUNC_AND:
+        break;
+
+    default:
+        return FALSE;
+    }
+
+    for (UINT32 i = 0; i < 2; i++)
+    {
+        switch (OperandTypes[i])
+        {
+        case SYMBOL_NUM_TYPE:
+        case SYMBOL_REGISTER_TYPE:
+            break;
+
+        case SYMBOL_PSEUDO_REG_TYPE:
+
+            if (OperandValues[i] == PSEUDO_REGISTER_BUFFER)
+            {
+                return FALSE;
+            }
+
+            break;
+
+        default:
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Set the predicates that are lowered from the condition of the script
+ * (by the script engine) to the event
+ * @details If the predicates are not valid, the event has no predicate and the
+ * script is always performed
+ *
+ * @param Event The event that the script action belongs to
+ * @param Predicates The lowered predicates
+ * @param NumberOfPredicates Number of predicates
+ *
+ * @return BOOLEAN whether the predicates are set or not
+ */
+BOOLEAN
+ScriptEngineSetConditionPredicates(PDEBUGGER_EVENT                      Event,
+                                   PDEBUGGER_SCRIPT_CONDITION_PREDICATE Predicates,
+                                   UINT32                               NumberOfPredicates)
+{
+    //
+    // Not lowered by default
+    //
+    InterlockedExchange(&Event->NumberOfConditionPredicates, 0);
+
+    if (Predicates == NULL || NumberOfPredicates == 0 || NumberOfPredicates > MAX_SCRIPT_CONDITION_PREDICATES)
+    {
+        return FALSE;
+    }
+
+    for (UINT32 i = 0; i < NumberOfPredicates; i++)
+    {
+        if (!ScriptEngineIsConditionPredicateValid(&Predicates[i]))
+        {
+            return FALSE;
+        }
+    }
+
+    RtlCopyMemory(Event->ConditionPredicates, Predicates, NumberOfPredicates * sizeof(DEBUGGER_SCRIPT_CONDITION_PREDICATE));
+
+    //
+    // Publish the predicates (the predicates are written before the count)
+    //
+    InterlockedExchange(&Event->NumberOfConditionPredicates, NumberOfPredicates);
+
+    return TRUE;
+}
+
+/**
+ * @brief Check the predicates that are lowered from the condition of the
+ * script of an event
+ *
+ * @param DbgState The state of the debugger on the current core
+ * @param Event The target event
+ * @param EventTriggerDetail Event trigger detail
+ *
+ * @return BOOLEAN TRUE if all of the predicates are met
+ */
+BOOLEAN
+ScriptEngineCheckConditionPredicates(PROCESSOR_DEBUGGING_STATE *        DbgState,
+                                     PDEBUGGER_EVENT                    Event,
+                                     DEBUGGER_TRIGGERED_EVENT_DETAILS * EventTriggerDetail)
+{
+    ACTION_BUFFER ActionBuffer = {0};
+
+    //
+    // Fill the action buffer (used for pseudo-registers)
+    //
+    ActionBuffer.Tag          = EventTriggerDetail->Tag;
+    ActionBuffer.Context      = (UINT64)EventTriggerDetail->Context;
+    ActionBuffer.CallingStage = EventTriggerDetail->Stage == VMM_CALLBACK_CALLING_STAGE_POST_EVENT_EMULATION ? 1 : 0;
+
+    return ScriptEngineEvaluateConditionPredicates(DbgState->Regs,
+                                                   &ActionBuffer,
+                                                   Event->ConditionPredicates,
+                                                   (UINT32)Event->NumberOfConditionPredicates);
+}
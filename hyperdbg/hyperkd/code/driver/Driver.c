@@ -62,6 +62,7 @@ DriverEntry(
         DbgPrint("Setting device major functions");
 
         DriverObject->MajorFunction[IRP_MJ_CLOSE]          = DrvClose;
+        DriverObject->MajorFunction[IRP_MJ_CLEANUP]        = DrvCleanup;
         DriverObject->MajorFunction[IRP_MJ_CREATE]         = DrvCreate;
         DriverObject->MajorFunction[IRP_MJ_READ]           = DrvRead;
         DriverObject->MajorFunction[IRP_MJ_WRITE]          = DrvWrite;
@@ -252,6 +253,36 @@ DrvClose(PDEVICE_OBJECT DeviceObject, PIRP Irp)
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief IRP_MJ_CLEANUP Function handler
+ * @details Called in the context of the process that closes the last
+ * handle, so the log rings (if mapped) can be unmapped from it here
+ *
+ * @param DeviceObject
+ * @param Irp
+ * @return NTSTATUS
+ */
+NTSTATUS
+DrvCleanup(PDEVICE_OBJECT DeviceObject, PIRP Irp)
+{
+    UNREFERENCED_PARAMETER(DeviceObject);
+
+#if !UseDbgPrintInsteadOfUsermodeMessageTracking
+
+    //
+    // Unmap the log rings if they're mapped by this handle
+    //
+    LogUnmapRingsFromUserMode(IoGetCurrentIrpStackLocation(Irp)->FileObject);
+
+#endif
+
+    Irp->IoStatus.Status      = STATUS_SUCCESS;
+    Irp->IoStatus.Information = 0;
+    IoCompleteRequest(Irp, IO_NO_INCREMENT);
+
+    return STATUS_SUCCESS;
+}
+
 /**
  * @brief Unsupported message for all other IRP_MJ_* handlers
  *
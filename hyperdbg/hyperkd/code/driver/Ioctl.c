@@ -43,6 +43,8 @@ DrvDispatchIoControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
     PDEBUGGER_PREACTIVATE_COMMAND                           DebuggerPreactivationRequest;
     PDEBUGGER_APIC_REQUEST                                  DebuggerApicRequest;
     PINTERRUPT_DESCRIPTOR_TABLE_ENTRIES_PACKETS             DebuggerQueryIdtRequest;
+    PDEBUGGER_SHARED_LOG_RINGS                              DebuggerSharedLogRingsRequest;
+    PDEBUGGER_LOG_BUFFER_STATISTICS                         DebuggerLogBufferStatisticsRequest;
     PDEBUGGER_UD_COMMAND_PACKET                             DebuggerUdCommandRequest;
     PUSERMODE_LOADED_MODULE_DETAILS                         DebuggerUsermodeModulesRequest;
     PDEBUGGER_QUERY_ACTIVE_PROCESSES_OR_THREADS             DebuggerUsermodeProcessOrThreadQueryRequest;
@@ -98,6 +100,8 @@ DrvDispatchIoControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
             switch (RegisterEventRequest->Type)
             {
             case IRP_BASED:
+            case IRP_BASED_BATCHED:
+            case IRP_BASED_DOORBELL:
 
                 LogRegisterIrpBasedNotification((PVOID)Irp, &Status);
 
@@ -549,10 +553,10 @@ DrvDispatchIoControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
             OutBuffLength = IrpStack->Parameters.DeviceIoControl.OutputBufferLength;
 
             //
-            // The OutBuffLength should have at least MaximumSearchResults * sizeof(UINT64)
-            // free space to store the results
+            // The OutBuffLength should have at least SIZEOF_DEBUGGER_SEARCH_MEMORY_RESULTS
+            // free space to store the results and the number of matched addresses
             //
-            if (!InBuffLength || OutBuffLength < MaximumSearchResults * sizeof(UINT64))
+            if (!InBuffLength || OutBuffLength < SIZEOF_DEBUGGER_SEARCH_MEMORY_RESULTS)
             {
                 Status = STATUS_INVALID_PARAMETER;
                 break;
@@ -584,14 +588,14 @@ DrvDispatchIoControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
                 // then we're sure that the usermode code won't interpret it's previous
                 // buffer as a valid buffer and will not show it to the user
                 //
-                RtlZeroMemory(DebuggerSearchMemoryRequest, MaximumSearchResults * sizeof(UINT64));
+                RtlZeroMemory(DebuggerSearchMemoryRequest, SIZEOF_DEBUGGER_SEARCH_MEMORY_RESULTS);
             }
 
             //
             // Configure IRP status, and also we send the results
             // buffer, with it's null values (if any)
             //
-            Irp->IoStatus.Information = MaximumSearchResults * sizeof(UINT64);
+            Irp->IoStatus.Information = SIZEOF_DEBUGGER_SEARCH_MEMORY_RESULTS;
             Status                    = STATUS_SUCCESS;
 
             //
@@ -1163,6 +1167,103 @@ DrvDispatchIoControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
 
             break;
 
+        case IOCTL_MAP_SHARED_LOG_RINGS:
+
+            //
+            // First validate the parameters.
+            //
+            if (IrpStack->Parameters.DeviceIoControl.InputBufferLength < SIZEOF_DEBUGGER_SHARED_LOG_RINGS ||
+                IrpStack->Parameters.DeviceIoControl.OutputBufferLength < SIZEOF_DEBUGGER_SHARED_LOG_RINGS ||
+                Irp->AssociatedIrp.SystemBuffer == NULL)
+            {
+                Status = STATUS_INVALID_PARAMETER;
+                LogError("Err, invalid parameter to IOCTL dispatcher");
+                break;
+            }
+
+            //
+            // Both usermode and to send to usermode and the coming buffer are
+            // at the same place
+            //
+            DebuggerSharedLogRingsRequest = (PDEBUGGER_SHARED_LOG_RINGS)Irp->AssociatedIrp.SystemBuffer;
+
+            //
+            // The rings are mapped into (or unmapped from) the current process,
+            // the file object is used for unmapping them on cleanup
+            //
+            if ((DebuggerSharedLogRingsRequest->IsMap && LogMapRingsToUserMode(DebuggerSharedLogRingsRequest, IrpStack->FileObject)) ||
+                (!DebuggerSharedLogRingsRequest->IsMap && LogUnmapRingsFromUserMode(IrpStack->FileObject)))
+            {
+                DebuggerSharedLogRingsRequest->KernelStatus = DEBUGGER_OPERATION_WAS_SUCCESSFUL;
+            }
+            else
+            {
+                DebuggerSharedLogRingsRequest->KernelStatus = DEBUGGER_ERROR_UNABLE_TO_MAP_SHARED_LOG_RINGS;
+            }
+
+            Irp->IoStatus.Information = SIZEOF_DEBUGGER_SHARED_LOG_RINGS;
+            Status                    = STATUS_SUCCESS;
+
+            //
+            // Avoid zeroing it
+            //
+            DoNotChangeInformation = TRUE;
+
+            break;
+
+        case IOCTL_QUERY_LOG_BUFFER_STATISTICS:
+
+            //
+            // First validate the parameters.
+            //
+            if (IrpStack->Parameters.DeviceIoControl.InputBufferLength < SIZEOF_DEBUGGER_LOG_BUFFER_STATISTICS ||
+                IrpStack->Parameters.DeviceIoControl.OutputBufferLength < SIZEOF_DEBUGGER_LOG_BUFFER_STATISTICS ||
+                Irp->AssociatedIrp.SystemBuffer == NULL)
+            {
+                Status = STATUS_INVALID_PARAMETER;
+                LogError("Err, invalid parameter to IOCTL dispatcher");
+                break;
+            }
+
+            //
+            // Both usermode and to send to usermode and the coming buffer are
+            // at the same place
+            //
+            DebuggerLogBufferStatisticsRequest = (PDEBUGGER_LOG_BUFFER_STATISTICS)Irp->AssociatedIrp.SystemBuffer;
+
+            if (DebuggerLogBufferStatisticsRequest->SetPolicy &&
+                !LogSetOverflowPolicy(DebuggerLogBufferStatisticsRequest->Priority, DebuggerLogBufferStatisticsRequest->Policy))
+            {
+                DebuggerLogBufferStatisticsRequest->KernelStatus = DEBUGGER_ERROR_INVALID_LOG_OVERFLOW_POLICY;
+                Irp->IoStatus.Information                        = SIZEOF_DEBUGGER_LOG_BUFFER_STATISTICS;
+            }
+            else if (DebuggerLogBufferStatisticsRequest->SetCoalescing &&
+                     !LogSetCoalescingThresholds(DebuggerLogBufferStatisticsRequest->CoalescingByteThreshold,
+                                                 DebuggerLogBufferStatisticsRequest->CoalescingLatency))
+            {
+                DebuggerLogBufferStatisticsRequest->KernelStatus = DEBUGGER_ERROR_INVALID_LOG_COALESCING_THRESHOLDS;
+                Irp->IoStatus.Information                        = SIZEOF_DEBUGGER_LOG_BUFFER_STATISTICS;
+            }
+            else
+            {
+                //
+                // The drop counters are only copied if the output buffer is large enough
+                //
+                Irp->IoStatus.Information = LogQueryBufferStatistics(DebuggerLogBufferStatisticsRequest,
+                                                                     IrpStack->Parameters.DeviceIoControl.OutputBufferLength);
+
+                DebuggerLogBufferStatisticsRequest->KernelStatus = DEBUGGER_OPERATION_WAS_SUCCESSFUL;
+            }
+
+            Status = STATUS_SUCCESS;
+
+            //
+            // Avoid zeroing it
+            //
+            DoNotChangeInformation = TRUE;
+
+            break;
+
         case IOCTL_SEND_USER_DEBUGGER_COMMANDS:
 
             //
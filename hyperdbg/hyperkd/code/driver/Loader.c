@@ -40,6 +40,7 @@ LoaderInitVmmAndDebugger()
     VmmCallbacks.LogCallbackSendMessageToQueue                  = LogCallbackSendMessageToQueue;
     VmmCallbacks.LogCallbackSendBuffer                          = LogCallbackSendBuffer;
     VmmCallbacks.LogCallbackCheckIfBufferIsFull                 = LogCallbackCheckIfBufferIsFull;
+    VmmCallbacks.LogCallbackFlushExpiredMessages                = LogCallbackFlushExpiredMessages;
 
     //
     // Fill the VMM callbacks
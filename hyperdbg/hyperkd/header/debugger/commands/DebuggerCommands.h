@@ -13,6 +13,48 @@
  */
 #pragma once
 
+//////////////////////////////////////////////////
+//				    Definitions 	      		//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Size of each block of memory that is read and searched
+ * at once by the 's*' commands
+ *
+ */
+#define SEARCH_MEMORY_BLOCK_SIZE PAGE_SIZE
+
+//////////////////////////////////////////////////
+//				     Structures		      		//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The memory that is used for searching the memory
+ * @details The buffer holds a block and the bytes after it that might
+ * be a part of a pattern which starts in the block
+ *
+ */
+typedef struct _SEARCH_MEMORY_WORKSPACE
+{
+    SEARCH_PATTERNS Patterns;
+    UINT8           Buffer[SEARCH_MEMORY_BLOCK_SIZE + SEARCH_MAXIMUM_PATTERN_BYTES];
+
+} SEARCH_MEMORY_WORKSPACE, *PSEARCH_MEMORY_WORKSPACE;
+
+/**
+ * @brief The context that is passed to the routine of the matched
+ * addresses of searching the memory
+ *
+ */
+typedef struct _SEARCH_MEMORY_MATCH_CONTEXT
+{
+    PUINT64                     AddressToSaveResults;
+    DEBUGGER_SEARCH_MEMORY_TYPE MemoryType;
+    BOOLEAN                     IsDebuggeePaused;
+    UINT32                      CountOfMatchedCases;
+
+} SEARCH_MEMORY_MATCH_CONTEXT, *PSEARCH_MEMORY_MATCH_CONTEXT;
+
 //////////////////////////////////////////////////
 //				     Functions		      		//
 //////////////////////////////////////////////////
@@ -27,6 +27,9 @@ KdHyperDbgSendByte(UCHAR Byte, BOOLEAN BusyWait);
 BOOLEAN
 KdHyperDbgRecvByte(PUCHAR RecvByte);
 
+BOOLEAN
+KdHyperDbgRecvReady();
+
 //////////////////////////////////////////////////
 //					 Functions					//
 //////////////////////////////////////////////////
@@ -53,6 +56,9 @@ SerialConnectionRecvBuffer(CHAR *   BufferToSave,
 BOOLEAN
 SerialConnectionSendTwoBuffers(CHAR * Buffer1, UINT32 Length1, CHAR * Buffer2, UINT32 Length2);
 
+BOOLEAN
+SerialConnectionCheckBufferForEndOfBuffer(CHAR * Buffer, UINT32 Length);
+
 BOOLEAN
 SerialConnectionSendThreeBuffers(CHAR * Buffer1,
                                  UINT32 Length1,
@@ -61,6 +67,9 @@ SerialConnectionSendThreeBuffers(CHAR * Buffer1,
                                  CHAR * Buffer3,
                                  UINT32 Length3);
 
+VOID
+SerialConnectionUninitializeFraming();
+
 //////////////////////////////////////////////////
 //					 Constants					//
 //////////////////////////////////////////////////
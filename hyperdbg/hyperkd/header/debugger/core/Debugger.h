@@ -95,6 +95,11 @@ typedef struct _DEBUGGER_EVENT_ACTION
     UINT32 CustomCodeBufferSize;    // if null, means it's not custom code type
     PVOID  CustomCodeBufferAddress; // address of custom code if any
 
+    UINT32   ScriptStackSize;        // Number of stack slots available to the script on each core
+    UINT32   ScriptStackZeroingSize; // Number of stack slots that should be zeroed before each run
+    UINT64 * ScriptStackBuffer;      // Dedicated stack (one slice per core) if the script doesn't fit
+                                     // into the per-core stack buffer, otherwise null
+
 } DEBUGGER_EVENT_ACTION, *PDEBUGGER_EVENT_ACTION;
 
 /* ==============================================================================================
@@ -134,6 +139,17 @@ typedef struct _DEBUGGER_EVENT
     PVOID  ConditionBufferAddress; // Address of the condition buffer (most of the
                                    // time at the end of this buffer)
 
+    volatile LONG                       NumberOfConditionPredicates;                          // if zero, means there is no lowered predicate
+    DEBUGGER_SCRIPT_CONDITION_PREDICATE ConditionPredicates[MAX_SCRIPT_CONDITION_PREDICATES]; // Predicates (all should be met) lowered from the script
+
+    volatile LONG64 GroupsBitmap; // The groups that this event belongs to (each bit is a group id)
+
+    LIST_ENTRY RetiredEventsList;          // Link of the removed events (waiting to be reclaimed)
+    UINT64     RetiredEpoch;               // The epoch that this event is removed in
+    BOOLEAN    PoolManagerAllocatedMemory; // Whether the event is allocated from the pool manager or not
+
+    BOOLEAN EnableOnAction; // Whether the event is enabled once its actions are added (otherwise, it remains disabled)
+
 } DEBUGGER_EVENT, *PDEBUGGER_EVENT;
 
 /* ==============================================================================================
@@ -230,6 +246,9 @@ DebuggerGetEventByTag(UINT64 Tag);
 BOOLEAN
 DebuggerRemoveEvent(UINT64 Tag, BOOLEAN PoolManagerAllocatedMemory);
 
+VOID
+DebuggerFreeEvent(PDEBUGGER_EVENT Event, BOOLEAN PoolManagerAllocatedMemory);
+
 BOOLEAN
 DebuggerQueryDebuggerStatus();
 
@@ -182,6 +182,8 @@ typedef struct _PROCESSOR_DEBUGGING_STATE
     UINT16                                     InstructionLengthHint;
     UINT64                                     HardwareDebugRegisterForStepping;
     UINT64 *                                   ScriptEngineCoreSpecificStackBuffer;
+    volatile LONG64                            EventPublicationEpoch;             // The epoch of published events that this core reads (zero if quiescent)
+    UINT32                                     EventPublicationReaderNesting;     // Nesting level of reading the published events
     PKDPC                                      KdDpcObject;                       // DPC object to be used in kernel debugger
     CHAR                                       KdRecvBuffer[MaxSerialPacketSize]; // Used for debugging buffers (receiving buffers from serial devices)
 
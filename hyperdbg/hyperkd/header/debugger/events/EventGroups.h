@@ -0,0 +1,40 @@
+/**
+ * @file EventGroups.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Headers of the groups of events (enabling and disabling a set of events)
+ * @details
+ *
+ * @version 0.14
+ * @date 2025-06-07
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Check whether the event is disabled by any of its groups
+ *
+ * @details A single test against the bitmap of disabled groups, so it's
+ * safe (and cheap) to be checked by the VMX-root readers
+ *
+ */
+#define EVENT_GROUPS_IS_EVENT_DISABLED(Event) \
+    (((Event)->GroupsBitmap & g_EventGroupsDisabledBitmap) != 0)
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+VOID
+EventGroupsInitialize();
+
+BOOLEAN
+EventGroupsIsGroupModification(DEBUGGER_MODIFY_EVENTS_TYPE TypeOfAction);
+
+BOOLEAN
+EventGroupsPerformModification(PDEBUGGER_MODIFY_EVENTS ModifyEventRequest);
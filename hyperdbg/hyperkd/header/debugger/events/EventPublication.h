@@ -0,0 +1,94 @@
+/**
+ * @file EventPublication.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Headers of the RCU-style publication of events to VMX-root readers
+ * @details
+ *
+ * @version 0.14
+ * @date 2025-06-02
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Number of event lists (types) that have a dispatch table
+ *
+ */
+#define EVENT_PUBLICATION_NUMBER_OF_EVENT_LISTS (sizeof(DEBUGGER_CORE_EVENTS) / sizeof(LIST_ENTRY))
+
+/**
+ * @brief The epoch that shows a core is not reading any dispatch table
+ *
+ */
+#define EVENT_PUBLICATION_QUIESCENT_EPOCH 0
+
+/**
+ * @brief Maximum number of spins (pause) for waiting for the readers to
+ * pass a quiescent point
+ *
+ */
+#define EVENT_PUBLICATION_MAXIMUM_GRACE_PERIOD_SPINS 0x1000000
+
+/**
+ * @brief Size of a dispatch table that holds the target number of events
+ *
+ */
+#define EVENT_PUBLICATION_DISPATCH_TABLE_SIZE(NumberOfEvents) \
+    (FIELD_OFFSET(DEBUGGER_EVENT_DISPATCH_TABLE, Events) + ((NumberOfEvents) * sizeof(PDEBUGGER_EVENT)))
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Immutable array of the events of a same type which is read by
+ * the VMX-root readers (DebuggerTriggerEvents)
+ *
+ * @details Each modification to the list of events builds a new table and
+ * publishes it by a single pointer swap, the old table is retired and freed
+ * once all of the cores passed a quiescent point
+ *
+ */
+typedef struct _DEBUGGER_EVENT_DISPATCH_TABLE
+{
+    LIST_ENTRY               RetiredTablesList;          // Link of the retired tables (waiting to be reclaimed)
+    UINT64                   RetiredEpoch;               // The epoch that this table is retired in
+    BOOLEAN                  PoolManagerAllocatedMemory; // Whether the table is allocated from the pool manager or not
+    UINT32                   NumberOfEvents;             // Count of entries in the Events array
+    PDEBUGGER_EVENT volatile Events[1];                  // Events (in the same order as of the list of events)
+
+} DEBUGGER_EVENT_DISPATCH_TABLE, *PDEBUGGER_EVENT_DISPATCH_TABLE;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+VOID
+EventPublicationInitialize();
+
+VOID
+EventPublicationUninitialize();
+
+PDEBUGGER_EVENT_DISPATCH_TABLE
+EventPublicationReaderEnter(PROCESSOR_DEBUGGING_STATE * DbgState, VMM_EVENT_TYPE_ENUM EventType);
+
+VOID
+EventPublicationReaderExit(PROCESSOR_DEBUGGING_STATE * DbgState);
+
+BOOLEAN
+EventPublicationPublishEventList(VMM_EVENT_TYPE_ENUM EventType);
+
+BOOLEAN
+EventPublicationUnpublishEvent(PDEBUGGER_EVENT Event);
+
+VOID
+EventPublicationRetireEvent(PDEBUGGER_EVENT Event, BOOLEAN PoolManagerAllocatedMemory);
+
+VOID
+EventPublicationReclaim();
@@ -77,6 +77,61 @@ typedef struct _HARDWARE_DEBUG_REGISTER_DETAILS
 
 } HARDWARE_DEBUG_REGISTER_DETAILS, *PHARDWARE_DEBUG_REGISTER_DETAILS;
 
+/**
+ * @brief The state of compressing the messages that are sent to the debugger
+ * @details Only accessed while DebuggerResponseLock is held
+ *
+ */
+typedef struct _KD_LOG_COMPRESSION
+{
+    COMPRESSION_STREAM Stream;
+    UINT32             NumberOfMessagesSinceReset;
+    UINT8              Packet[sizeof(DEBUGGEE_COMPRESSED_MESSAGE_PACKET) + PacketChunkSize];
+
+} KD_LOG_COMPRESSION, *PKD_LOG_COMPRESSION;
+
+/**
+ * @brief Maximum length of a chunk of the streamed dump (the chunk and the
+ * header of the packet should fit in a serial packet)
+ *
+ */
+#define KD_DUMP_MEMORY_CHUNK_SIZE \
+    (MaxSerialPacketSize - sizeof(DEBUGGER_REMOTE_PACKET) - SERIAL_END_OF_BUFFER_CHARS_COUNT)
+
+/**
+ * @brief The buffers of streaming the dump to the debugger
+ * @details Only accessed while the debuggee is halted (in the loop that
+ * dispatches the commands of the debugger)
+ *
+ */
+typedef struct _KD_DUMP_MEMORY_STREAM
+{
+    COMPRESSION_STREAM Stream;
+    UINT8              Page[PAGE_SIZE];
+    UINT8              Chunk[KD_DUMP_MEMORY_CHUNK_SIZE];
+
+} KD_DUMP_MEMORY_STREAM, *PKD_DUMP_MEMORY_STREAM;
+
+/**
+ * @brief Maximum length of the pause packet along with the context of the core
+ *
+ */
+#define KD_BREAK_CONTEXT_PACKET_SIZE \
+    (sizeof(DEBUGGEE_KD_PAUSED_PACKET) + sizeof(DEBUGGEE_KD_BREAK_CONTEXT) + DEBUGGEE_BREAK_CONTEXT_MAXIMUM_CODE_BYTES + DEBUGGEE_BREAK_CONTEXT_MAXIMUM_STACK_QWORDS * sizeof(UINT64))
+
+/**
+ * @brief The buffer of sending the context of the core along with the pause packet
+ * @details Only accessed by the main debugging core before sending the pause packet
+ *
+ */
+typedef struct _KD_BREAK_CONTEXT
+{
+    UINT32 CodeBytes;   // Number of the bytes at RIP
+    UINT32 StackQwords; // Number of the qwords at RSP
+    UINT8  Packet[KD_BREAK_CONTEXT_PACKET_SIZE];
+
+} KD_BREAK_CONTEXT, *PKD_BREAK_CONTEXT;
+
 //////////////////////////////////////////////////
 //				   Functions 	    			//
 //////////////////////////////////////////////////
@@ -112,6 +167,9 @@ KdContinueDebuggee(_Inout_ PROCESSOR_DEBUGGING_STATE *
 static VOID
 KdContinueDebuggeeJustCurrentCore(PROCESSOR_DEBUGGING_STATE * DbgState);
 
+static VOID
+KdReadExtraRegisters(_Out_ PGUEST_EXTRA_REGISTERS ExtraRegs);
+
 static BOOLEAN
 KdReadRegisters(_In_ PROCESSOR_DEBUGGING_STATE *            DbgState,
                 _Inout_ PDEBUGGEE_REGISTER_READ_DESCRIPTION ReadRegisterRequest);
@@ -167,6 +225,23 @@ KdDispatchAndPerformCommandsFromDebugger(PROCESSOR_DEBUGGING_STATE * DbgState);
 static VOID
 KdBroadcastHaltOnAllCores();
 
+static BOOLEAN
+KdCompressedLoggingResponsePacketToDebugger(CHAR * OptionalBuffer,
+                                            UINT32 OptionalBufferLength,
+                                            UINT32 OperationCode);
+
+static BOOLEAN
+KdDumpMemoryIsFilled(UINT8 * Buffer, UINT32 Length, UINT8 * Fill);
+
+static VOID
+KdDumpMemoryToDebugger(PDEBUGGEE_DUMP_MEMORY_PACKET DumpPacket);
+
+static UINT32
+KdBreakContextReadMemory(UINT64 Address, UINT8 * Buffer, UINT32 Length, DEBUGGER_READ_MEMORY_ADDRESS_MODE * AddressMode);
+
+static UINT32
+KdBreakContextFillPacket(PROCESSOR_DEBUGGING_STATE * DbgState, DEBUGGEE_KD_PAUSED_PACKET * PausePacket);
+
 // ----------------------------------------------------------------------------
 // Public Interfaces
 //
@@ -192,6 +267,24 @@ KdInitializeKernelDebugger();
 VOID
 KdUninitializeKernelDebugger();
 
+VOID
+KdInitializeLogCompression();
+
+VOID
+KdUninitializeLogCompression();
+
+VOID
+KdInitializeDumpStreaming();
+
+VOID
+KdUninitializeDumpStreaming();
+
+VOID
+KdInitializeBreakContext(UINT32 CodeBytes, UINT32 StackQwords);
+
+VOID
+KdUninitializeBreakContext();
+
 VOID
 KdInitializeInstantEventPools();
 
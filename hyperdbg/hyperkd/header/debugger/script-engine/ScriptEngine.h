@@ -26,3 +26,13 @@ ScriptEngineGetTargetCoreTime();
 
 UINT64
 ScriptEngineGetTargetCoreDate();
+
+BOOLEAN
+ScriptEngineSetConditionPredicates(PDEBUGGER_EVENT                      Event,
+                                   PDEBUGGER_SCRIPT_CONDITION_PREDICATE Predicates,
+                                   UINT32                               NumberOfPredicates);
+
+BOOLEAN
+ScriptEngineCheckConditionPredicates(PROCESSOR_DEBUGGING_STATE *        DbgState,
+                                     PDEBUGGER_EVENT                    Event,
+                                     DEBUGGER_TRIGGERED_EVENT_DETAILS * EventTriggerDetail);
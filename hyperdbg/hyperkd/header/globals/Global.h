@@ -22,6 +22,13 @@ PROCESSOR_DEBUGGING_STATE * g_DbgState;
  */
 UINT64 * g_ScriptGlobalVariables;
 
+/**
+ * @brief The workspace of searching the memory while the debuggee
+ * is paused (nothing could be allocated in vmx-root)
+ *
+ */
+PSEARCH_MEMORY_WORKSPACE g_SearchMemoryWorkspace;
+
 /**
  * @brief State of the trap-flag
  *
@@ -47,6 +54,49 @@ BOOLEAN g_AllowIOCTLFromUsermode;
  */
 DEBUGGER_CORE_EVENTS * g_Events;
 
+/**
+ * @brief Published (immutable) dispatch tables of events which are read
+ * by the VMX-root readers
+ *
+ */
+PDEBUGGER_EVENT_DISPATCH_TABLE volatile g_EventDispatchTables[EVENT_PUBLICATION_NUMBER_OF_EVENT_LISTS];
+
+/**
+ * @brief Current epoch of the published events
+ *
+ */
+volatile LONG64 g_EventPublicationEpoch;
+
+/**
+ * @brief Lock for serializing the writers of the published events
+ *
+ */
+volatile LONG g_EventPublicationLock;
+
+/**
+ * @brief Bitmap of the disabled groups of events (each bit is a group id)
+ *
+ */
+volatile LONG64 g_EventGroupsDisabledBitmap;
+
+/**
+ * @brief List header of retired dispatch tables (waiting to be reclaimed)
+ *
+ */
+LIST_ENTRY g_RetiredEventDispatchTablesHead;
+
+/**
+ * @brief List header of removed events (waiting to be reclaimed)
+ *
+ */
+LIST_ENTRY g_RetiredEventsHead;
+
+/**
+ * @brief Count of retired tables and events (waiting to be reclaimed)
+ *
+ */
+volatile LONG g_EventPublicationNumberOfRetiredObjects;
+
 /**
  * @brief Holds the requests to pause the break of debuggee until
  * a special event happens
@@ -164,3 +214,51 @@ BOOLEAN g_IsWaitingForUserModeProcessEntryToBeCalled;
  *
  */
 BOOLEAN g_InterceptBreakpointsAndEventsForCommandsInRemoteComputer;
+
+/**
+ * @brief The state of compressing the messages of the debuggee
+ * @details NULL if the debugger doesn't accept compressed messages
+ *
+ */
+KD_LOG_COMPRESSION * g_KdLogCompression;
+
+/**
+ * @brief The buffers of streaming the dump to the debugger
+ * @details NULL if the packets are not framed (the dump is read page by page)
+ *
+ */
+KD_DUMP_MEMORY_STREAM * g_KdDumpMemoryStream;
+
+/**
+ * @brief The buffer of sending the context of the core along with the pause packet
+ * @details NULL if the debugger doesn't accept the context (only the pause packet is sent)
+ *
+ */
+KD_BREAK_CONTEXT * g_KdBreakContext;
+
+/**
+ * @brief Whether the packets are framed (length-prefixed) or not
+ * @details The debuggee switches to the framed packets after sending
+ * the "Start" packet if the debugger supports them
+ *
+ */
+BOOLEAN g_KdFramedPackets;
+
+/**
+ * @brief The transport (the UART) of the connection to the debugger
+ *
+ */
+TRANSPORT g_KdTransport;
+
+/**
+ * @brief The state of the framed connection to the debugger
+ *
+ */
+FRAMING_TRANSPORT g_KdFramingTransport;
+
+/**
+ * @brief The lock that serializes the frames that are sent to the debugger
+ * with the NAKs (and the retransmissions) of the receiver
+ *
+ */
+volatile LONG g_KdFramingSendLock;
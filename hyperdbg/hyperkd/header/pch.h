@@ -81,6 +81,26 @@
 //
 #include "components/spinlock/header/Spinlock.h"
 
+//
+// Compression component
+//
+#include "components/compression/header/Compression.h"
+
+//
+// Framing component
+//
+#include "components/framing/header/Framing.h"
+
+//
+// Transport component
+//
+#include "components/transport/header/Transport.h"
+
+//
+// Search component
+//
+#include "components/search/header/Search.h"
+
 //
 // Platform independent headers
 //
@@ -145,6 +165,8 @@
 #include "header/debugger/events/Termination.h"
 #include "header/debugger/events/DebuggerEvents.h"
 #include "header/debugger/events/ValidateEvents.h"
+#include "header/debugger/events/EventPublication.h"
+#include "header/debugger/events/EventGroups.h"
 #include "header/debugger/meta-events/Tracing.h"
 #include "header/debugger/meta-events/MetaDispatch.h"
 
@@ -88,6 +88,361 @@ BOOLEAN inline LogSendImmediateMessage(CHAR * OptionalBuffer,
     return SendImmediateMessage(OptionalBuffer, OptionalBufferLength, OperationCode);
 }
 
+/**
+ * @brief Get the time stamp of records (used for merging the rings of cores)
+ * @details The raw TSC is used, it's cheap to read and the debugger converts
+ * it to the wall-clock time
+ *
+ * @return UINT64
+ */
+static UINT64
+LogGetTimeStamp()
+{
+    return __rdtsc();
+}
+
+/**
+ * @brief Compute the number of TSC ticks in a microsecond
+ * @details Used for converting the latency threshold of accumulated messages
+ * to TSC ticks, so checking the age of messages is cheap in vmx-root
+ *
+ * @return UINT64
+ */
+static UINT64
+LogCalibrateTimeStamp()
+{
+    LARGE_INTEGER Frequency;
+    LARGE_INTEGER StartCounter;
+    LARGE_INTEGER EndCounter;
+    UINT64        StartTimeStamp;
+    UINT64        EndTimeStamp;
+    UINT64        ElapsedTime;
+
+    StartCounter   = KeQueryPerformanceCounter(&Frequency);
+    StartTimeStamp = LogGetTimeStamp();
+
+    KeStallExecutionProcessor(LogTimeStampCalibrationPeriod);
+
+    EndCounter   = KeQueryPerformanceCounter(NULL);
+    EndTimeStamp = LogGetTimeStamp();
+
+    //
+    // Elapsed time in microseconds
+    //
+    ElapsedTime = ((UINT64)(EndCounter.QuadPart - StartCounter.QuadPart) * 1000000) / (UINT64)Frequency.QuadPart;
+
+    if (ElapsedTime == 0 || EndTimeStamp <= StartTimeStamp + ElapsedTime)
+    {
+        //
+        // Not expected, at least one tick per microsecond
+        //
+        return 1;
+    }
+
+    return (EndTimeStamp - StartTimeStamp) / ElapsedTime;
+}
+
+/**
+ * @brief Compute the size of the ring of each core
+ *
+ * @param BufferSize The total size of the rings
+ * @param MinimumCapacity The minimum number of messages (with the maximum length)
+ * that the ring of each core can hold
+ *
+ * @return UINT32
+ */
+static UINT32
+LogComputeRingSize(UINT32 BufferSize, UINT32 MinimumCapacity)
+{
+    UINT32 RingSize    = (BufferSize / LogNumberOfCores) & ~(RING_RECORD_ALIGNMENT - 1);
+    UINT32 MinimumSize = MinimumCapacity * RingGetRecordSize(PacketChunkSize - 1);
+
+    return RingSize < MinimumSize ? MinimumSize : RingSize;
+}
+
+/**
+ * @brief Get the position of a ring in the arrays of indexes
+ * @details Rings are ordered by mode, then by lane (regular, priority), and then by core
+ *
+ * @param Index Index of the buffer (vmx non-root = 0, vmx-root = 1)
+ * @param Priority Whether the ring is a priority ring or not
+ * @param Core The core that the ring belongs to
+ *
+ * @return UINT32
+ */
+static UINT32
+LogGetRingIndex(UINT32 Index, BOOLEAN Priority, UINT32 Core)
+{
+    return ((Index * 2) + (Priority ? 1 : 0)) * LogNumberOfCores + Core;
+}
+
+/**
+ * @brief Get the size of the arrays of indexes
+ * @details Rounded up to pages, so no other data shares their pages
+ * when they are mapped into user-mode
+ *
+ * @return SIZE_T
+ */
+static SIZE_T
+LogGetIndexesSize()
+{
+    return ROUND_TO_PAGES(sizeof(RING_INDEX) * 4 * LogNumberOfCores);
+}
+
+/**
+ * @brief Get the size of the data of the rings of all cores
+ * @details Rounded up to pages, so no other data shares their pages
+ * when they are mapped into user-mode
+ *
+ * @param Priority Whether the size of priority rings should be returned or not
+ *
+ * @return SIZE_T
+ */
+static SIZE_T
+LogGetRingsBufferSize(BOOLEAN Priority)
+{
+    return ROUND_TO_PAGES((SIZE_T)(Priority ? LogRingSizePriority : LogRingSize) * LogNumberOfCores);
+}
+
+/**
+ * @brief Free a buffer that could be mapped into user-mode
+ *
+ * @param Buffer
+ *
+ * @return VOID
+ */
+static VOID
+LogFreeSharedBuffer(LOG_SHARED_BUFFER * Buffer)
+{
+    if (Buffer->Mdl != NULL)
+    {
+        //
+        // Unlocking the pages also removes their non-paged mapping
+        //
+        MmUnlockPages(Buffer->Mdl);
+        IoFreeMdl(Buffer->Mdl);
+    }
+
+    if (Buffer->SystemView != NULL)
+    {
+        MmUnmapViewInSystemSpace(Buffer->SystemView);
+    }
+
+    if (Buffer->Section != NULL)
+    {
+        ObDereferenceObject(Buffer->Section);
+    }
+
+    if (Buffer->SectionHandle != NULL)
+    {
+        ZwClose(Buffer->SectionHandle);
+    }
+
+    RtlZeroMemory(Buffer, sizeof(LOG_SHARED_BUFFER));
+}
+
+/**
+ * @brief Allocate a buffer that could be mapped into user-mode
+ * @details The buffer is a view of a section that is backed by the paging
+ * file, so its pages are zeroed and no stale data is exposed to user-mode.
+ * The pages are locked, so the buffer is usable at any IRQL (and vmx-root)
+ *
+ * @param Index Index of the buffer in the shared buffers
+ * @param Size Size of the buffer (rounded up to pages)
+ *
+ * @return PVOID The non-paged address of the buffer or NULL if it's not allocated
+ */
+static PVOID
+LogAllocateSharedBuffer(UINT32 Index, SIZE_T Size)
+{
+    LOG_SHARED_BUFFER * Buffer = &g_LogSharedRings.Buffers[Index];
+    OBJECT_ATTRIBUTES   ObjectAttributes;
+    LARGE_INTEGER       MaximumSize;
+    SIZE_T              ViewSize = 0;
+    NTSTATUS            Status;
+
+    RtlZeroMemory(Buffer, sizeof(LOG_SHARED_BUFFER));
+
+    InitializeObjectAttributes(&ObjectAttributes, NULL, OBJ_KERNEL_HANDLE, NULL, NULL);
+
+    MaximumSize.QuadPart = Size;
+
+    Status = ZwCreateSection(&Buffer->SectionHandle,
+                             SECTION_ALL_ACCESS,
+                             &ObjectAttributes,
+                             &MaximumSize,
+                             PAGE_READWRITE,
+                             SEC_COMMIT,
+                             NULL);
+
+    if (!NT_SUCCESS(Status))
+    {
+        Buffer->SectionHandle = NULL;
+        return NULL;
+    }
+
+    Status = ObReferenceObjectByHandle(Buffer->SectionHandle, SECTION_ALL_ACCESS, NULL, KernelMode, &Buffer->Section, NULL);
+
+    if (!NT_SUCCESS(Status))
+    {
+        Buffer->Section = NULL;
+        LogFreeSharedBuffer(Buffer);
+        return NULL;
+    }
+
+    Status = MmMapViewInSystemSpace(Buffer->Section, &Buffer->SystemView, &ViewSize);
+
+    if (!NT_SUCCESS(Status))
+    {
+        Buffer->SystemView = NULL;
+        LogFreeSharedBuffer(Buffer);
+        return NULL;
+    }
+
+    Buffer->Mdl = IoAllocateMdl(Buffer->SystemView, (ULONG)Size, FALSE, FALSE, NULL);
+
+    if (Buffer->Mdl == NULL)
+    {
+        LogFreeSharedBuffer(Buffer);
+        return NULL;
+    }
+
+    //
+    // Locking the pages raises an exception on failure
+    //
+    __try
+    {
+        MmProbeAndLockPages(Buffer->Mdl, KernelMode, IoWriteAccess);
+    }
+    __except (EXCEPTION_EXECUTE_HANDLER)
+    {
+        IoFreeMdl(Buffer->Mdl);
+        Buffer->Mdl = NULL;
+
+        LogFreeSharedBuffer(Buffer);
+        return NULL;
+    }
+
+    Buffer->Address = MmGetSystemAddressForMdlSafe(Buffer->Mdl, NormalPagePriority | MdlMappingNoExecute);
+    Buffer->Size    = Size;
+
+    if (Buffer->Address == NULL)
+    {
+        LogFreeSharedBuffer(Buffer);
+        return NULL;
+    }
+
+    return Buffer->Address;
+}
+
+/**
+ * @brief Get the ring of the current core
+ *
+ * @param IsVmxRoot Whether the ring of vmx-root should be returned or not
+ * @param Priority Whether the priority ring should be returned or not
+ *
+ * @return RING_BUFFER *
+ */
+static RING_BUFFER *
+LogGetCurrentCoreRing(BOOLEAN IsVmxRoot, BOOLEAN Priority)
+{
+    UINT32 Index       = IsVmxRoot ? 1 : 0;
+    ULONG  CurrentCore = KeGetCurrentProcessorNumberEx(NULL);
+
+    if (Priority)
+    {
+        return &MessageBufferInformation[Index].RingsPriority[CurrentCore];
+    }
+    else
+    {
+        return &MessageBufferInformation[Index].Rings[CurrentCore];
+    }
+}
+
+/**
+ * @brief Acquire the lock of the readers of the rings
+ * @details Producers never use this lock
+ *
+ * @param Index Index of the buffer (vmx non-root = 0, vmx-root = 1)
+ *
+ * @return KIRQL The previous IRQL
+ */
+static KIRQL
+LogLockConsumer(UINT32 Index)
+{
+    KIRQL OldIRQL = NULL_ZERO;
+
+    //
+    // In vmx non-root, raise the IRQL to avoid being scheduled while holding the lock
+    //
+    if (!LogCheckVmxOperation())
+    {
+        OldIRQL = KeRaiseIrqlToDpcLevel();
+    }
+
+    SpinlockLock(&MessageBufferInformation[Index].ConsumerLock);
+
+    return OldIRQL;
+}
+
+/**
+ * @brief Release the lock of the readers of the rings
+ *
+ * @param Index Index of the buffer (vmx non-root = 0, vmx-root = 1)
+ * @param OldIRQL The IRQL that is returned from LogLockConsumer
+ *
+ * @return VOID
+ */
+static VOID
+LogUnlockConsumer(UINT32 Index, KIRQL OldIRQL)
+{
+    SpinlockUnlock(&MessageBufferInformation[Index].ConsumerLock);
+
+    if (!LogCheckVmxOperation())
+    {
+        KeLowerIrql(OldIRQL);
+    }
+}
+
+/**
+ * @brief Queue the DPC of the thread that waits for new messages (if any)
+ *
+ * @param IsVmxRoot Whether the reader should check the vmx-root buffers or not
+ *
+ * @return VOID
+ */
+static VOID
+LogNotifyPendingReader(BOOLEAN IsVmxRoot)
+{
+    NOTIFY_RECORD * NotifyRecord;
+
+    if (g_GlobalNotifyRecord == NULL)
+    {
+        //
+        // There is no thread in the IRP Pending state
+        //
+        return;
+    }
+
+    //
+    // Claim the notify record, so only one of the cores queues the DPC
+    //
+    NotifyRecord = InterlockedExchangePointer((PVOID volatile *)&g_GlobalNotifyRecord, NULL);
+
+    if (NotifyRecord != NULL)
+    {
+        //
+        // set the target pool
+        //
+        NotifyRecord->CheckVmxRootMessagePool = IsVmxRoot;
+
+        //
+        // Insert dpc to queue
+        //
+        KeInsertQueueDpc(&NotifyRecord->Dpc, NotifyRecord, NULL);
+    }
+}
+
 /**
  * @brief Initialize the buffer relating to log message tracing
  * @param MsgTracingCallbacks specify the callbacks
@@ -101,6 +456,14 @@ LogInitialize(MESSAGE_TRACING_CALLBACKS * MsgTracingCallbacks)
 
     ProcessorsCount = KeQueryActiveProcessorCount(0);
 
+    //
+    // The timer of accumulated non-immediate messages is initialized first, so it
+    // can be canceled if the initialization fails
+    //
+    KeInitializeTimer(&LogCoalescingTimer);
+    KeInitializeDpc(&LogCoalescingDpc, LogCoalescingTimerCallback, NULL);
+    LogCoalescingTimerArmed = FALSE;
+
     //
     // Initialize buffers for trace message and data messages
     //(we have two buffers one for vmx root and one for vmx non-root)
@@ -140,9 +503,56 @@ LogInitialize(MESSAGE_TRACING_CALLBACKS * MsgTracingCallbacks)
     }
 
     //
-    // Initialize the lock for Vmx-root mode (HIGH_IRQL Spinlock)
+    // Divide the capacity of the buffers between cores
     //
-    VmxRootLoggingLock = 0;
+    LogNumberOfCores    = ProcessorsCount;
+    LogRingSize         = LogComputeRingSize(LogBufferSize, MinimumPacketsCapacityPerCore);
+    LogRingSizePriority = LogComputeRingSize(LogBufferSizePriority, MinimumPacketsCapacityPriorityPerCore);
+
+    //
+    // The rings are not mapped into user-mode by default
+    //
+    ExInitializeFastMutex(&g_LogSharedRings.Lock);
+    g_LogSharedRings.IsShared = FALSE;
+    g_LogSharedRings.Owner    = NULL;
+
+    //
+    // New messages are dropped if the ring is full (unless the user changes the policy)
+    //
+    g_LogOverflowPolicy[0] = LOG_OVERFLOW_POLICY_DROP_NEWEST;
+    g_LogOverflowPolicy[1] = LOG_OVERFLOW_POLICY_DROP_NEWEST;
+
+    //
+    // Non-immediate messages are accumulated until the batch is full or
+    // the oldest message waited for the default latency
+    //
+    LogTimeStampTicksPerMicrosecond = LogCalibrateTimeStamp();
+    LogSetCoalescingThresholds(PacketChunkSize - 1, LogCoalescingDefaultLatency);
+
+    //
+    // Allocate the indexes of all rings (they could be mapped into user-mode)
+    //
+    LogProducerIndexes = LogAllocateSharedBuffer(0, LogGetIndexesSize());
+    LogConsumerIndexes = LogAllocateSharedBuffer(1, LogGetIndexesSize());
+
+    if (!LogProducerIndexes || !LogConsumerIndexes)
+    {
+        LogUnInitialize();
+        return FALSE; // STATUS_INSUFFICIENT_RESOURCES
+    }
+
+    //
+    // Allocate the vmx non-root buffers of cores for formatting messages
+    //
+    NonRootLogMessage   = PlatformMemAllocateZeroedNonPagedPool(PacketChunkSize * ProcessorsCount);
+    NonRootTempMessage  = PlatformMemAllocateZeroedNonPagedPool(PacketChunkSize * ProcessorsCount);
+    NonRootMessageLocks = PlatformMemAllocateZeroedNonPagedPool(sizeof(LONG) * ProcessorsCount);
+
+    if (!NonRootLogMessage || !NonRootTempMessage || !NonRootMessageLocks)
+    {
+        LogUnInitialize();
+        return FALSE; // STATUS_INSUFFICIENT_RESOURCES
+    }
 
     //
     // Allocate buffer for messages and initialize the core buffer information
@@ -150,48 +560,99 @@ LogInitialize(MESSAGE_TRACING_CALLBACKS * MsgTracingCallbacks)
     for (int i = 0; i < 2; i++)
     {
         //
-        // initialize the lock
-        // Actually, only the 0th buffer use this spinlock but let initialize it
-        // for both but the second buffer spinlock is useless
-        // as we use our custom spinlock
+        // initialize the lock of readers
         //
-        KeInitializeSpinLock(&MessageBufferInformation[i].BufferLock);
-        KeInitializeSpinLock(&MessageBufferInformation[i].BufferLockForNonImmMessage);
+        MessageBufferInformation[i].ConsumerLock = 0;
 
         //
-        // allocate the buffer for regular buffers
+        // allocate the buffers of cores for accumulating non-immediate messages
         //
-        MessageBufferInformation[i].BufferStartAddress                   = (UINT64)PlatformMemAllocateNonPagedPool(LogBufferSize);
-        MessageBufferInformation[i].BufferForMultipleNonImmediateMessage = (UINT64)PlatformMemAllocateNonPagedPool(PacketChunkSize);
+        MessageBufferInformation[i].CoalescingBuffers = PlatformMemAllocateZeroedNonPagedPool(sizeof(LOG_COALESCING_BUFFER) * ProcessorsCount);
+        MessageBufferInformation[i].CoalescingData    = PlatformMemAllocateZeroedNonPagedPool(PacketChunkSize * ProcessorsCount);
 
-        if (!MessageBufferInformation[i].BufferStartAddress ||
-            !MessageBufferInformation[i].BufferForMultipleNonImmediateMessage)
-        {
-            return FALSE; // STATUS_INSUFFICIENT_RESOURCES
-        }
+        //
+        // allocate the rings of cores, the data of rings could be mapped into
+        // user-mode (after the indexes, regular and priority rings of each mode)
+        //
+        MessageBufferInformation[i].Rings               = PlatformMemAllocateZeroedNonPagedPool(sizeof(RING_BUFFER) * ProcessorsCount);
+        MessageBufferInformation[i].RingsPriority       = PlatformMemAllocateZeroedNonPagedPool(sizeof(RING_BUFFER) * ProcessorsCount);
+        MessageBufferInformation[i].RingsBuffer         = LogAllocateSharedBuffer(2 + i * 2, LogGetRingsBufferSize(FALSE));
+        MessageBufferInformation[i].RingsPriorityBuffer = LogAllocateSharedBuffer(3 + i * 2, LogGetRingsBufferSize(TRUE));
+
+        //
+        // allocate the drop counters of cores
+        //
+        MessageBufferInformation[i].Statistics         = PlatformMemAllocateZeroedNonPagedPool(sizeof(LOG_RING_STATISTICS) * ProcessorsCount);
+        MessageBufferInformation[i].StatisticsPriority = PlatformMemAllocateZeroedNonPagedPool(sizeof(LOG_RING_STATISTICS) * ProcessorsCount);
 
         //
-        // allocate the buffer for priority buffers
+        // allocate the deficits of cores for draining their rings fairly
         //
-        MessageBufferInformation[i].BufferStartAddressPriority = (UINT64)PlatformMemAllocateNonPagedPool(LogBufferSizePriority);
+        MessageBufferInformation[i].Deficits = PlatformMemAllocateZeroedNonPagedPool(sizeof(UINT32) * 2 * ProcessorsCount);
 
-        if (!MessageBufferInformation[i].BufferStartAddressPriority)
+        if (!MessageBufferInformation[i].CoalescingBuffers ||
+            !MessageBufferInformation[i].CoalescingData ||
+            !MessageBufferInformation[i].Rings ||
+            !MessageBufferInformation[i].RingsPriority ||
+            !MessageBufferInformation[i].RingsBuffer ||
+            !MessageBufferInformation[i].RingsPriorityBuffer ||
+            !MessageBufferInformation[i].Statistics ||
+            !MessageBufferInformation[i].StatisticsPriority ||
+            !MessageBufferInformation[i].Deficits)
         {
+            LogUnInitialize();
             return FALSE; // STATUS_INSUFFICIENT_RESOURCES
         }
 
         //
-        // Zeroing the buffer
+        // each core can send (at least) one record with the maximum length in each round
         //
-        RtlZeroMemory((void *)MessageBufferInformation[i].BufferStartAddress, LogBufferSize);
-        RtlZeroMemory((void *)MessageBufferInformation[i].BufferForMultipleNonImmediateMessage, PacketChunkSize);
-        RtlZeroMemory((void *)MessageBufferInformation[i].BufferStartAddressPriority, LogBufferSizePriority);
+        RingInitializeFairDraining(&MessageBufferInformation[i].Draining,
+                                   MessageBufferInformation[i].Deficits,
+                                   ProcessorsCount,
+                                   RingGetRecordSize(PacketChunkSize - 1));
 
-        //
-        // Set the end address
-        //
-        MessageBufferInformation[i].BufferEndAddress         = (UINT64)MessageBufferInformation[i].BufferStartAddress + LogBufferSize;
-        MessageBufferInformation[i].BufferEndAddressPriority = (UINT64)MessageBufferInformation[i].BufferStartAddressPriority + LogBufferSizePriority;
+        RingInitializeFairDraining(&MessageBufferInformation[i].DrainingPriority,
+                                   MessageBufferInformation[i].Deficits + ProcessorsCount,
+                                   ProcessorsCount,
+                                   RingGetRecordSize(PacketChunkSize - 1));
+
+        for (ULONG j = 0; j < ProcessorsCount; j++)
+        {
+            //
+            // initialize the coalescing buffer of the core
+            //
+            KeInitializeSpinLock(&MessageBufferInformation[i].CoalescingBuffers[j].Lock);
+            MessageBufferInformation[i].CoalescingBuffers[j].Buffer = (CHAR *)MessageBufferInformation[i].CoalescingData + (UINT64)PacketChunkSize * j;
+
+            //
+            // initialize the regular ring of the core
+            //
+            if (!RingInitialize(&MessageBufferInformation[i].Rings[j],
+                                &LogProducerIndexes[LogGetRingIndex(i, FALSE, j)],
+                                &LogConsumerIndexes[LogGetRingIndex(i, FALSE, j)],
+                                (PVOID)((UINT64)MessageBufferInformation[i].RingsBuffer + (UINT64)LogRingSize * j),
+                                LogRingSize,
+                                PacketChunkSize - 1))
+            {
+                LogUnInitialize();
+                return FALSE;
+            }
+
+            //
+            // initialize the priority ring of the core
+            //
+            if (!RingInitialize(&MessageBufferInformation[i].RingsPriority[j],
+                                &LogProducerIndexes[LogGetRingIndex(i, TRUE, j)],
+                                &LogConsumerIndexes[LogGetRingIndex(i, TRUE, j)],
+                                (PVOID)((UINT64)MessageBufferInformation[i].RingsPriorityBuffer + (UINT64)LogRingSizePriority * j),
+                                LogRingSizePriority,
+                                PacketChunkSize - 1))
+            {
+                LogUnInitialize();
+                return FALSE;
+            }
+        }
     }
 
     //
@@ -210,28 +671,107 @@ LogInitialize(MESSAGE_TRACING_CALLBACKS * MsgTracingCallbacks)
 VOID
 LogUnInitialize()
 {
+    if (MessageBufferInformation == NULL)
+    {
+        return;
+    }
+
+    //
+    // The driver is unloaded after all of its handles are closed, so the rings
+    // are already unmapped from user-mode (IRP_MJ_CLEANUP of the owner)
+    //
+    ASSERT(!g_LogSharedRings.IsShared);
+
+    //
+    // Make sure that the timer of accumulated messages is not running anymore,
+    // the latency threshold is disabled first so the timer is not armed again
+    //
+    InterlockedExchange64((volatile LONG64 *)&g_LogCoalescingLatencyTicks, 0);
+
+    KeCancelTimer(&LogCoalescingTimer);
+    KeFlushQueuedDpcs();
+
     //
     // de-allocate buffer for messages and initialize the core buffer information (for vmx-root core)
     //
     for (int i = 0; i < 2; i++)
     {
         //
-        // Free each buffers
+        // Free the rings of cores
         //
-        if (MessageBufferInformation[i].BufferStartAddress != NULL64_ZERO)
+        LogFreeSharedBuffer(&g_LogSharedRings.Buffers[2 + i * 2]);
+        LogFreeSharedBuffer(&g_LogSharedRings.Buffers[3 + i * 2]);
+
+        MessageBufferInformation[i].RingsBuffer         = NULL;
+        MessageBufferInformation[i].RingsPriorityBuffer = NULL;
+
+        //
+        // Free the drop counters of cores
+        //
+        if (MessageBufferInformation[i].Statistics != NULL)
+        {
+            PlatformMemFreePool(MessageBufferInformation[i].Statistics);
+        }
+
+        if (MessageBufferInformation[i].StatisticsPriority != NULL)
+        {
+            PlatformMemFreePool(MessageBufferInformation[i].StatisticsPriority);
+        }
+
+        if (MessageBufferInformation[i].Deficits != NULL)
         {
-            PlatformMemFreePool((PVOID)MessageBufferInformation[i].BufferStartAddress);
+            PlatformMemFreePool(MessageBufferInformation[i].Deficits);
         }
 
-        if (MessageBufferInformation[i].BufferStartAddressPriority != NULL64_ZERO)
+        if (MessageBufferInformation[i].Rings != NULL)
         {
-            PlatformMemFreePool((PVOID)MessageBufferInformation[i].BufferStartAddressPriority);
+            PlatformMemFreePool(MessageBufferInformation[i].Rings);
         }
 
-        if (MessageBufferInformation[i].BufferForMultipleNonImmediateMessage != NULL64_ZERO)
+        if (MessageBufferInformation[i].RingsPriority != NULL)
         {
-            PlatformMemFreePool((PVOID)MessageBufferInformation[i].BufferForMultipleNonImmediateMessage);
+            PlatformMemFreePool(MessageBufferInformation[i].RingsPriority);
         }
+
+        if (MessageBufferInformation[i].CoalescingBuffers != NULL)
+        {
+            PlatformMemFreePool(MessageBufferInformation[i].CoalescingBuffers);
+        }
+
+        if (MessageBufferInformation[i].CoalescingData != NULL)
+        {
+            PlatformMemFreePool(MessageBufferInformation[i].CoalescingData);
+        }
+    }
+
+    //
+    // de-allocate the indexes of rings
+    //
+    LogFreeSharedBuffer(&g_LogSharedRings.Buffers[0]);
+    LogFreeSharedBuffer(&g_LogSharedRings.Buffers[1]);
+
+    LogProducerIndexes = NULL;
+    LogConsumerIndexes = NULL;
+
+    //
+    // de-allocate the buffers of cores for formatting messages
+    //
+    if (NonRootLogMessage != NULL)
+    {
+        PlatformMemFreePool(NonRootLogMessage);
+        NonRootLogMessage = NULL;
+    }
+
+    if (NonRootTempMessage != NULL)
+    {
+        PlatformMemFreePool(NonRootTempMessage);
+        NonRootTempMessage = NULL;
+    }
+
+    if (NonRootMessageLocks != NULL)
+    {
+        PlatformMemFreePool((PVOID)NonRootMessageLocks);
+        NonRootMessageLocks = NULL;
     }
 
     //
@@ -242,7 +782,7 @@ LogUnInitialize()
 }
 
 /**
- * @brief Checks whether the priority or regular buffer is full or not
+ * @brief Checks whether the priority or regular buffer of the current core is full or not
  *
  * @param Priority Whether the buffer has priority
  * @return BOOLEAN Returns true if the buffer is full, otherwise, return false
@@ -250,82 +790,208 @@ LogUnInitialize()
 BOOLEAN
 LogCallbackCheckIfBufferIsFull(BOOLEAN Priority)
 {
-    UINT32  Index;
-    BOOLEAN IsVmxRoot;
-    UINT32  CurrentIndexToWrite         = NULL_ZERO;
-    UINT32  CurrentIndexToWritePriority = NULL_ZERO;
-
     //
-    // Check that if we're in vmx root-mode
+    // If the ring of the current core is full, the next message of this core
+    // won't be saved until the reader consumes the previous (not served) items
     //
-    IsVmxRoot = LogCheckVmxOperation();
+    return RingIsFull(LogGetCurrentCoreRing(LogCheckVmxOperation(), Priority));
+}
 
-    if (IsVmxRoot)
+/**
+ * @brief Count a lost record in the drop counters of a ring
+ *
+ * @param Statistics The drop counters of the ring
+ * @param BufferLength Length of the lost record
+ *
+ * @return VOID
+ */
+static VOID
+LogCountDroppedRecord(LOG_RING_STATISTICS * Statistics, UINT32 BufferLength)
+{
+    Statistics->DroppedRecords++;
+    Statistics->DroppedBytes += BufferLength;
+    Statistics->UnreportedRecords++;
+    Statistics->UnreportedBytes += BufferLength;
+}
+
+/**
+ * @brief Write a record into a ring based on its overflow policy
+ * @details If the policy is LOG_OVERFLOW_POLICY_OVERWRITE_OLDEST, the producer
+ * acts as the consumer (if it can acquire the lock of readers without waiting)
+ * and discards the oldest records until the new record fits. Should be called
+ * from the core that owns the ring
+ *
+ * @param Index Index of the buffer (vmx non-root = 0, vmx-root = 1)
+ * @param Ring The ring of the current core
+ * @param Statistics The drop counters of the ring
+ * @param OverwriteOldest Whether the oldest records can be discarded or not
+ * @param Record The header of the record
+ * @param Buffer The body of the record
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+LogWriteToRing(UINT32                     Index,
+               RING_BUFFER *              Ring,
+               LOG_RING_STATISTICS *      Statistics,
+               BOOLEAN                    OverwriteOldest,
+               const RING_RECORD_HEADER * Record,
+               PVOID                      Buffer)
+{
+    BOOLEAN              Result;
+    RING_RECORD_HEADER * Header;
+
+    Result = RingWrite(Ring, Record, Buffer);
+
+    if (Result || !OverwriteOldest)
     {
-        //
-        // Set the index
-        //
-        Index = 1;
+        return Result;
     }
-    else
+
+    //
+    // We never wait for the lock here, as the reader might be interrupted
+    // by a vm-exit on this core while holding the lock
+    //
+    if (!SpinlockTryLock(&MessageBufferInformation[Index].ConsumerLock))
     {
-        //
-        // Set the index
-        //
-        Index = 0;
+        return FALSE;
     }
 
     //
-    // check if the buffer is filled to it's maximum index or not
+    // If the rings are mapped into user-mode, the debugger is the consumer
     //
-    if (Priority)
+    while (!g_LogSharedRings.IsShared)
     {
-        CurrentIndexToWritePriority = MessageBufferInformation[Index].CurrentIndexToWritePriority;
+        Header = RingPeek(Ring);
 
-        if (MessageBufferInformation[Index].CurrentIndexToWritePriority > MaximumPacketsCapacityPriority - 1)
+        if (Header == NULL)
         {
-            //
-            // start from the beginning
-            //
-            CurrentIndexToWritePriority = 0;
+            break;
+        }
+
+        LogCountDroppedRecord(Statistics, Header->BufferLength);
+        RingConsume(Ring);
+
+        Result = RingWrite(Ring, Record, Buffer);
+
+        if (Result)
+        {
+            break;
         }
     }
+
+    SpinlockUnlock(&MessageBufferInformation[Index].ConsumerLock);
+
+    return Result;
+}
+
+/**
+ * @brief Write a record into the ring of the current core
+ * @details If records of the ring are lost before, a marker that shows the
+ * number of lost records is written first
+ *
+ * @param IsVmxRoot Whether the ring of vmx-root should be used or not
+ * @param Priority Whether the priority ring should be used or not
+ * @param OperationCode The operation code of the record
+ * @param Buffer The body of the record
+ * @param BufferLength Length of the body
+ * @param Flags Flags of the record (LOG_RECORD_FLAG_*)
+ * @param CountDropped Whether the record should be counted as lost if it doesn't fit
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+LogWriteRecord(BOOLEAN IsVmxRoot,
+               BOOLEAN Priority,
+               UINT32  OperationCode,
+               PVOID   Buffer,
+               UINT32  BufferLength,
+               UINT32  Flags,
+               BOOLEAN CountDropped)
+{
+    UINT32                    Index       = IsVmxRoot ? 1 : 0;
+    ULONG                     CurrentCore = KeGetCurrentProcessorNumberEx(NULL);
+    BOOLEAN                   Overwrite   = g_LogOverflowPolicy[Priority ? 1 : 0] == LOG_OVERFLOW_POLICY_OVERWRITE_OLDEST;
+    RING_BUFFER *             Ring;
+    LOG_RING_STATISTICS *     Statistics;
+    RING_RECORD_HEADER        Record;
+    DEBUGGER_LOG_RECORDS_LOST Marker;
+
+    if (Priority)
+    {
+        Ring       = &MessageBufferInformation[Index].RingsPriority[CurrentCore];
+        Statistics = &MessageBufferInformation[Index].StatisticsPriority[CurrentCore];
+    }
     else
     {
-        CurrentIndexToWrite = MessageBufferInformation[Index].CurrentIndexToWrite;
+        Ring       = &MessageBufferInformation[Index].Rings[CurrentCore];
+        Statistics = &MessageBufferInformation[Index].Statistics[CurrentCore];
+    }
+
+    //
+    // The raw TSC is saved as the time stamp and the debugger converts it
+    // to the wall-clock time (if the time should be shown)
+    //
+    Record.TimeStamp = LogGetTimeStamp();
+    Record.CoreId    = CurrentCore;
+    Record.Flags     = IsVmxRoot ? LOG_RECORD_FLAG_VMX_ROOT : 0;
+
+    //
+    // Report the lost records before the new record, so the reader knows
+    // where the gap is
+    //
+    if (Statistics->UnreportedRecords != 0)
+    {
+        Marker.CoreId      = CurrentCore;
+        Marker.IsVmxRoot   = IsVmxRoot;
+        Marker.Priority    = Priority;
+        Marker.LostRecords = Statistics->UnreportedRecords;
+        Marker.LostBytes   = Statistics->UnreportedBytes;
 
-        if (MessageBufferInformation[Index].CurrentIndexToWrite > MaximumPacketsCapacity - 1)
+        Record.OperationNumber = OPERATION_LOG_RECORDS_LOST;
+        Record.BufferLength    = sizeof(Marker);
+
+        if (!LogWriteToRing(Index, Ring, Statistics, Overwrite, &Record, &Marker))
         {
             //
-            // start from the beginning
+            // There is no space for the marker, so there is no space for the record either
             //
-            CurrentIndexToWrite = 0;
+            if (CountDropped)
+            {
+                LogCountDroppedRecord(Statistics, BufferLength);
+            }
+
+            return FALSE;
         }
+
+        //
+        // Records that are overwritten while writing the marker are reported by the next marker
+        //
+        Statistics->UnreportedRecords -= Marker.LostRecords;
+        Statistics->UnreportedBytes -= Marker.LostBytes;
     }
 
-    //
-    // Compute the start of the buffer header
-    //
-    BUFFER_HEADER * Header;
+    Record.OperationNumber = OperationCode;
+    Record.BufferLength    = BufferLength;
+    Record.Flags |= Flags;
 
-    if (Priority)
-    {
-        Header = (BUFFER_HEADER *)((UINT64)MessageBufferInformation[Index].BufferStartAddressPriority + (CurrentIndexToWritePriority * (PacketChunkSize + sizeof(BUFFER_HEADER))));
-    }
-    else
+    if (!LogWriteToRing(Index, Ring, Statistics, Overwrite, &Record, Buffer))
     {
-        Header = (BUFFER_HEADER *)((UINT64)MessageBufferInformation[Index].BufferStartAddress + (CurrentIndexToWrite * (PacketChunkSize + sizeof(BUFFER_HEADER))));
+        if (CountDropped)
+        {
+            LogCountDroppedRecord(Statistics, BufferLength);
+        }
+
+        return FALSE;
     }
 
-    //
-    // If the next item is valid, then it means the buffer is full and the next
-    // item will replace the previous (not served items)
-    //
-    return Header->Valid;
+    return TRUE;
 }
 
 /**
  * @brief Save buffer to the pool
+ * @details The buffer is saved into the ring of the current core, so
+ * no lock is needed
  *
  * @param OperationCode The operation code that will be send to user mode
  * @param Buffer Buffer to be send to user mode
@@ -338,9 +1004,29 @@ _Use_decl_annotations_
 BOOLEAN
 LogCallbackSendBuffer(UINT32 OperationCode, PVOID Buffer, UINT32 BufferLength, BOOLEAN Priority)
 {
-    UINT32  Index;
-    BOOLEAN IsVmxRoot;
-    KIRQL   OldIRQL = NULL_ZERO;
+    return LogSendBuffer(OperationCode, Buffer, BufferLength, Priority, 0);
+}
+
+/**
+ * @brief Save buffer to the pool with the flags of its record
+ *
+ * @param OperationCode The operation code that will be send to user mode
+ * @param Buffer Buffer to be send to user mode
+ * @param BufferLength Length of the buffer
+ * @param Priority Whether the buffer has priority
+ * @param Flags Flags of the record (LOG_RECORD_FLAG_*)
+ * @return BOOLEAN Returns true if the buffer successfully set to be
+ * send to user mode and false if there was an error
+ */
+BOOLEAN
+LogSendBuffer(UINT32 OperationCode, PVOID Buffer, UINT32 BufferLength, BOOLEAN Priority, UINT32 Flags)
+{
+    BOOLEAN       Result;
+    BOOLEAN       IsVmxRoot;
+    BOOLEAN       CanBlock;
+    BOOLEAN       CanWait;
+    LARGE_INTEGER Interval;
+    KIRQL         OldIRQL = NULL_ZERO;
 
     if (BufferLength > PacketChunkSize - 1 || BufferLength == 0)
     {
@@ -399,152 +1085,60 @@ LogCallbackSendBuffer(UINT32 OperationCode, PVOID Buffer, UINT32 BufferLength, B
     }
 
     //
-    // Check if we're in Vmx-root, if it is then we use our customized HIGH_IRQL Spinlock,
-    // if not we use the windows spinlock
+    // Only vmx non-root callers that are allowed to wait can block until
+    // the reader makes some space (otherwise the new message is dropped)
     //
-    if (IsVmxRoot)
-    {
-        //
-        // Set the index
-        //
-        Index = 1;
-        SpinlockLock(&VmxRootLoggingLock);
-    }
-    else
+    CanBlock = !IsVmxRoot &&
+               g_LogOverflowPolicy[Priority ? 1 : 0] == LOG_OVERFLOW_POLICY_BLOCK &&
+               KeGetCurrentIrql() <= APC_LEVEL;
+
+    Interval.QuadPart = -10000LL; // 1 millisecond
+
+    for (UINT32 WaitedTime = 0;; WaitedTime++)
     {
-        //
-        // Set the index
-        //
-        Index = 0;
+        CanWait = CanBlock && WaitedTime < LogOverflowBlockingMaximumWait;
 
         //
-        // Acquire the lock
+        // The current core is the only producer of its ring. In vmx non-root, we raise
+        // the IRQL to DISPATCH_LEVEL so the thread is not scheduled to another core (or
+        // preempted by another producer on this core) while writing to the ring. In
+        // vmx-root RFLAGS.IF is cleared so no interrupt happens
         //
-        KeAcquireSpinLock(&MessageBufferInformation[Index].BufferLock, &OldIRQL);
-    }
-
-    //
-    // check if the buffer is filled to it's maximum index or not
-    //
-    if (Priority)
-    {
-        if (MessageBufferInformation[Index].CurrentIndexToWritePriority > MaximumPacketsCapacityPriority - 1)
-        {
-            //
-            // start from the beginning
-            //
-            MessageBufferInformation[Index].CurrentIndexToWritePriority = 0;
-        }
-    }
-    else
-    {
-        if (MessageBufferInformation[Index].CurrentIndexToWrite > MaximumPacketsCapacity - 1)
+        if (!IsVmxRoot)
         {
-            //
-            // start from the beginning
-            //
-            MessageBufferInformation[Index].CurrentIndexToWrite = 0;
+            OldIRQL = KeRaiseIrqlToDpcLevel();
         }
-    }
-
-    //
-    // Compute the start of the buffer header
-    //
-    BUFFER_HEADER * Header;
-
-    if (Priority)
-    {
-        Header = (BUFFER_HEADER *)((UINT64)MessageBufferInformation[Index].BufferStartAddressPriority + (MessageBufferInformation[Index].CurrentIndexToWritePriority * (PacketChunkSize + sizeof(BUFFER_HEADER))));
-    }
-    else
-    {
-        Header = (BUFFER_HEADER *)((UINT64)MessageBufferInformation[Index].BufferStartAddress + (MessageBufferInformation[Index].CurrentIndexToWrite * (PacketChunkSize + sizeof(BUFFER_HEADER))));
-    }
-
-    //
-    // Set the header
-    //
-    Header->OperationNumber = OperationCode;
-    Header->BufferLength    = BufferLength;
-    Header->Valid           = TRUE;
-
-    //
-    // ******** Now it's time to fill the buffer ********
-    //
-
-    //
-    // compute the saving index
-    //
-    PVOID SavingBuffer;
-
-    if (Priority)
-    {
-        SavingBuffer = (PVOID)((UINT64)MessageBufferInformation[Index].BufferStartAddressPriority + (MessageBufferInformation[Index].CurrentIndexToWritePriority * (PacketChunkSize + sizeof(BUFFER_HEADER))) + sizeof(BUFFER_HEADER));
-    }
-    else
-    {
-        SavingBuffer = (PVOID)((UINT64)MessageBufferInformation[Index].BufferStartAddress + (MessageBufferInformation[Index].CurrentIndexToWrite * (PacketChunkSize + sizeof(BUFFER_HEADER))) + sizeof(BUFFER_HEADER));
-    }
-
-    //
-    // Copy the buffer
-    //
-    RtlCopyBytes(SavingBuffer, Buffer, BufferLength);
-
-    //
-    // Increment the next index to write
-    //
-    if (Priority)
-    {
-        MessageBufferInformation[Index].CurrentIndexToWritePriority = MessageBufferInformation[Index].CurrentIndexToWritePriority + 1;
-    }
-    else
-    {
-        MessageBufferInformation[Index].CurrentIndexToWrite = MessageBufferInformation[Index].CurrentIndexToWrite + 1;
-    }
 
-    //
-    // check if there is any thread in IRP Pending state, so we can complete their request
-    //
-    if (g_GlobalNotifyRecord != NULL)
-    {
         //
-        // there is some threads that needs to be completed
+        // Write and publish the record (it's counted as lost if we can't wait anymore)
         //
+        Result = LogWriteRecord(IsVmxRoot, Priority, OperationCode, Buffer, BufferLength, Flags, !CanWait);
 
         //
-        // set the target pool
+        // check if there is any thread in IRP Pending state, so we can complete their request
         //
-        g_GlobalNotifyRecord->CheckVmxRootMessagePool = IsVmxRoot;
+        if (Result)
+        {
+            LogNotifyPendingReader(IsVmxRoot);
+        }
 
-        //
-        // Insert dpc to queue
-        //
-        KeInsertQueueDpc(&g_GlobalNotifyRecord->Dpc, g_GlobalNotifyRecord, NULL);
+        if (!IsVmxRoot)
+        {
+            KeLowerIrql(OldIRQL);
+        }
 
-        //
-        // set notify routine to null
-        //
-        g_GlobalNotifyRecord = NULL;
-    }
+        if (Result || !CanWait)
+        {
+            break;
+        }
 
-    //
-    // Check if we're in Vmx-root, if it is then we use our customized HIGH_IRQL Spinlock,
-    // if not we use the windows spinlock
-    //
-    if (IsVmxRoot)
-    {
-        SpinlockUnlock(&VmxRootLoggingLock);
-    }
-    else
-    {
         //
-        // Release the lock
+        // Wait for the reader to consume the previous messages
         //
-        KeReleaseSpinLock(&MessageBufferInformation[Index].BufferLock, OldIRQL);
+        KeDelayExecutionThread(KernelMode, FALSE, &Interval);
     }
 
-    return TRUE;
+    return Result;
 }
 
 /**
@@ -557,135 +1151,36 @@ LogCallbackSendBuffer(UINT32 OperationCode, PVOID Buffer, UINT32 BufferLength, B
 UINT32
 LogMarkAllAsRead(BOOLEAN IsVmxRoot)
 {
-    UINT32 Index;
+    UINT32 Index                     = IsVmxRoot ? 1 : 0;
     UINT32 ResultsOfBuffersSetToRead = 0;
-    KIRQL  OldIRQL                   = NULL_ZERO;
+    KIRQL  OldIRQL;
 
     //
-    // Check if we're in Vmx-root, if it is then we use our customized HIGH_IRQL Spinlock,
-    // if not we use the windows spinlock
+    // Acquire the lock of readers
     //
-    if (IsVmxRoot)
-    {
-        //
-        // Set the index
-        //
-        Index = 1;
-
-        //
-        // Acquire the lock
-        //
-        SpinlockLock(&VmxRootLoggingLock);
-    }
-    else
-    {
-        //
-        // Set the index
-        //
-        Index = 0;
-
-        //
-        // Acquire the lock
-        //
-        KeAcquireSpinLock(&MessageBufferInformation[Index].BufferLock, &OldIRQL);
-    }
+    OldIRQL = LogLockConsumer(Index);
 
     //
-    // We have iterate through the all indexes
+    // Consume all the published messages of all cores (if the rings are
+    // mapped into user-mode, the debugger is the consumer of the rings)
     //
-    for (size_t i = 0; i < MaximumPacketsCapacity; i++)
+    for (UINT32 i = 0; i < LogNumberOfCores && !g_LogSharedRings.IsShared; i++)
     {
-        //
-        // Compute the current buffer to read
-        //
-        BUFFER_HEADER * Header = (BUFFER_HEADER *)((UINT64)MessageBufferInformation[Index].BufferStartAddress +
-                                                   (MessageBufferInformation[Index].CurrentIndexToSend *
-                                                    (PacketChunkSize + sizeof(BUFFER_HEADER))));
-
-        if (!Header->Valid)
-        {
-            //
-            // there is nothing to send
-            //
-
-            //
-            // Check if we're in Vmx-root, if it is then we use our customized HIGH_IRQL Spinlock,
-            // if not we use the windows spinlock
-            //
-            if (IsVmxRoot)
-            {
-                SpinlockUnlock(&VmxRootLoggingLock);
-            }
-            else
-            {
-                //
-                // Release the lock
-                //
-                KeReleaseSpinLock(&MessageBufferInformation[Index].BufferLock, OldIRQL);
-            }
-
-            return ResultsOfBuffersSetToRead;
-        }
-
-        //
-        // If we reached here, means that there is sth to send
-        //
-        ResultsOfBuffersSetToRead++;
-
-        //
-        // Second, save the buffer contents
-        //
-        PVOID SendingBuffer = (PVOID)((UINT64)MessageBufferInformation[Index].BufferStartAddress + (MessageBufferInformation[Index].CurrentIndexToSend * (PacketChunkSize + sizeof(BUFFER_HEADER))) + sizeof(BUFFER_HEADER));
-
-        //
-        // Finally, set the current index to invalid as we sent it
-        //
-        Header->Valid = FALSE;
-
-        //
-        // Last step is to clear the current buffer (we can't do it once when CurrentIndexToSend is zero because
-        // there might be multiple messages on the start of the queue that didn't read yet)
-        // we don't free the header
-        //
-        RtlZeroMemory(SendingBuffer, Header->BufferLength);
-
-        //
-        // Check to see whether we passed the index or not
-        //
-        if (MessageBufferInformation[Index].CurrentIndexToSend > MaximumPacketsCapacity - 2)
-        {
-            MessageBufferInformation[Index].CurrentIndexToSend = 0;
-        }
-        else
-        {
-            //
-            // Increment the next index to read
-            //
-            MessageBufferInformation[Index].CurrentIndexToSend = MessageBufferInformation[Index].CurrentIndexToSend + 1;
-        }
+        ResultsOfBuffersSetToRead += RingDiscardAll(&MessageBufferInformation[Index].Rings[i]);
     }
 
     //
-    // Check if we're in Vmx-root, if it is then we use our customized HIGH_IRQL Spinlock,
-    // if not we use the windows spinlock
+    // Release the lock of readers
     //
-    if (IsVmxRoot)
-    {
-        SpinlockUnlock(&VmxRootLoggingLock);
-    }
-    else
-    {
-        //
-        // Release the lock
-        //
-        KeReleaseSpinLock(&MessageBufferInformation[Index].BufferLock, OldIRQL);
-    }
+    LogUnlockConsumer(Index, OldIRQL);
 
     return ResultsOfBuffersSetToRead;
 }
 
 /**
  * @brief Attempt to read the buffer
+ * @details Priority messages are read before regular messages and the rings
+ * of cores are drained fairly (deficit round-robin)
  *
  * @param IsVmxRoot Determine whether you want to read vmx root buffer or vmx non root buffer
  * @param BufferToSaveMessage Target buffer to save the message
@@ -696,85 +1191,54 @@ LogMarkAllAsRead(BOOLEAN IsVmxRoot)
 BOOLEAN
 LogReadBuffer(BOOLEAN IsVmxRoot, PVOID BufferToSaveMessage, UINT32 * ReturnedLength)
 {
-    UINT32  Index;
-    BOOLEAN PriorityMessageIsAvailable = FALSE;
-    KIRQL   OldIRQL                    = NULL_ZERO;
+    UINT32               Index     = IsVmxRoot ? 1 : 0;
+    UINT32               CoreIndex = 0;
+    RING_BUFFER *        Rings;
+    RING_FAIR_DRAINING * Draining;
+    RING_RECORD_HEADER * Header;
+    KIRQL                OldIRQL;
 
     //
-    // Check if we're in Vmx-root, if it is then we use our customized HIGH_IRQL Spinlock,
-    // if not we use the windows spinlock
+    // Acquire the lock of readers
     //
-    if (IsVmxRoot)
-    {
-        //
-        // Set the index
-        //
-        Index = 1;
+    OldIRQL = LogLockConsumer(Index);
 
-        //
-        // Acquire the lock
-        //
-        SpinlockLock(&VmxRootLoggingLock);
-    }
-    else
+    //
+    // If the rings are mapped into user-mode, the debugger reads them directly
+    //
+    if (g_LogSharedRings.IsShared)
     {
-        //
-        // Set the index
-        //
-        Index = 0;
+        LogUnlockConsumer(Index, OldIRQL);
 
-        //
-        // Acquire the lock
-        //
-        KeAcquireSpinLock(&MessageBufferInformation[Index].BufferLock, &OldIRQL);
+        return FALSE;
     }
 
-    //
-    // Compute the current buffer to read
-    //
-    BUFFER_HEADER * Header;
-
     //
     // Check for priority message
     //
-    Header = (BUFFER_HEADER *)((UINT64)MessageBufferInformation[Index].BufferStartAddressPriority + (MessageBufferInformation[Index].CurrentIndexToSendPriority * (PacketChunkSize + sizeof(BUFFER_HEADER))));
+    Rings    = MessageBufferInformation[Index].RingsPriority;
+    Draining = &MessageBufferInformation[Index].DrainingPriority;
+    Header   = RingPeekFair(Rings, LogNumberOfCores, Draining, &CoreIndex);
 
-    if (!Header->Valid)
+    if (Header == NULL)
     {
         //
         // Check for regular message
         //
-        Header = (BUFFER_HEADER *)((UINT64)MessageBufferInformation[Index].BufferStartAddress + (MessageBufferInformation[Index].CurrentIndexToSend * (PacketChunkSize + sizeof(BUFFER_HEADER))));
+        Rings    = MessageBufferInformation[Index].Rings;
+        Draining = &MessageBufferInformation[Index].Draining;
+        Header   = RingPeekFair(Rings, LogNumberOfCores, Draining, &CoreIndex);
 
-        if (!Header->Valid)
+        if (Header == NULL)
         {
             //
             // there is nothing to send
             //
-
-            //
-            // Check if we're in Vmx-root, if it is then we use our customized HIGH_IRQL Spinlock,
-            // if not we use the windows spinlock
-            //
-            if (IsVmxRoot)
-            {
-                SpinlockUnlock(&VmxRootLoggingLock);
-            }
-            else
-            {
-                //
-                // Release the lock
-                //
-                KeReleaseSpinLock(&MessageBufferInformation[Index].BufferLock, OldIRQL);
-            }
+            LogUnlockConsumer(Index, OldIRQL);
 
             return FALSE;
         }
     }
-    else
-    {
-        PriorityMessageIsAvailable = TRUE;
-    }
 
     //
     // If we reached here, means that there is sth to send
@@ -788,16 +1252,7 @@ LogReadBuffer(BOOLEAN IsVmxRoot, PVOID BufferToSaveMessage, UINT32 * ReturnedLen
     //
     // Second, save the buffer contents
     //
-    PVOID SendingBuffer;
-
-    if (PriorityMessageIsAvailable)
-    {
-        SendingBuffer = (PVOID)((UINT64)MessageBufferInformation[Index].BufferStartAddressPriority + (MessageBufferInformation[Index].CurrentIndexToSendPriority * (PacketChunkSize + sizeof(BUFFER_HEADER))) + sizeof(BUFFER_HEADER));
-    }
-    else
-    {
-        SendingBuffer = (PVOID)((UINT64)MessageBufferInformation[Index].BufferStartAddress + (MessageBufferInformation[Index].CurrentIndexToSend * (PacketChunkSize + sizeof(BUFFER_HEADER))) + sizeof(BUFFER_HEADER));
-    }
+    PVOID SendingBuffer = (PVOID)((UINT64)Header + sizeof(RING_RECORD_HEADER));
 
     //
     // Because we want to pass the header of usermode header
@@ -833,80 +1288,180 @@ LogReadBuffer(BOOLEAN IsVmxRoot, PVOID BufferToSaveMessage, UINT32 * ReturnedLen
         }
         else
         {
-            DbgPrint("%s", (char *)SendingBuffer);
+            DbgPrint("%s", (char *)SendingBuffer);
+        }
+    }
+#endif
+
+    //
+    // Set the length to show as the ReturnedByted in usermode ioctl function + size of header
+    //
+    *ReturnedLength = Header->BufferLength + sizeof(UINT32);
+
+    //
+    // Finally, release the slot as we sent it
+    //
+    RingConsumeFair(Rings, Draining, CoreIndex);
+
+    //
+    // Release the lock of readers
+    //
+    LogUnlockConsumer(Index, OldIRQL);
+
+    return TRUE;
+}
+
+/**
+ * @brief Find the next record among the rings of vmx-root and vmx non-root
+ * @details The caller should hold the lock of readers of both modes. Modes are
+ * alternated and the rings of cores in each mode are drained fairly
+ *
+ * @param Priority Whether priority rings should be checked or regular rings
+ * @param Index The mode of the ring that holds the returned record
+ * @param CoreIndex The core of the ring that holds the returned record
+ *
+ * @return RING_RECORD_HEADER * NULL if there is no record
+ */
+static RING_RECORD_HEADER *
+LogPeekNextRecord(BOOLEAN Priority, UINT32 * Index, UINT32 * CoreIndex)
+{
+    RING_RECORD_HEADER * Header;
+    RING_BUFFER *        Rings;
+    RING_FAIR_DRAINING * Draining;
+
+    for (UINT32 i = 0; i < 2; i++)
+    {
+        *Index = (LogDrainingNextMode + i) % 2;
+
+        if (Priority)
+        {
+            Rings    = MessageBufferInformation[*Index].RingsPriority;
+            Draining = &MessageBufferInformation[*Index].DrainingPriority;
+        }
+        else
+        {
+            Rings    = MessageBufferInformation[*Index].Rings;
+            Draining = &MessageBufferInformation[*Index].Draining;
+        }
+
+        Header = RingPeekFair(Rings, LogNumberOfCores, Draining, CoreIndex);
+
+        if (Header != NULL)
+        {
+            return Header;
         }
     }
-#endif
 
-    //
-    // Finally, set the current index to invalid as we sent it
-    //
-    Header->Valid = FALSE;
+    return NULL;
+}
+
+/**
+ * @brief Attempt to read as many messages as fit into the buffer
+ * @details Messages of both vmx-root and vmx non-root are read, priority
+ * messages are read before regular messages and each message is saved
+ * with a DEBUGGER_BATCHED_MESSAGE_HEADER
+ *
+ * @param BufferToSaveMessages Target buffer to save the messages
+ * @param BufferLength Length of the target buffer
+ * @param ReturnedLength The actual length of the buffer that this function used it
+ * @return BOOLEAN return of this function shows whether the read was successful
+ * or not (e.g FALSE shows there's no new buffer available.)
+ */
+BOOLEAN
+LogReadBufferBatch(PVOID BufferToSaveMessages, UINT32 BufferLength, UINT32 * ReturnedLength)
+{
+    UINT32                            Offset = 0;
+    UINT32                            MessageSize;
+    UINT32                            Index;
+    UINT32                            CoreIndex;
+    BOOLEAN                           Priority;
+    RING_RECORD_HEADER *              Header;
+    DEBUGGER_BATCHED_MESSAGE_HEADER * MessageHeader;
+    KIRQL                             OldIRQLVmxNonRoot;
+    KIRQL                             OldIRQLVmxRoot;
 
     //
-    // Set the length to show as the ReturnedByted in usermode ioctl function + size of header
+    // Acquire the lock of readers of both modes (always in the same order)
     //
-    *ReturnedLength = Header->BufferLength + sizeof(UINT32);
+    OldIRQLVmxNonRoot = LogLockConsumer(0);
+    OldIRQLVmxRoot    = LogLockConsumer(1);
 
     //
-    // Last step is to clear the current buffer (we can't do it once when CurrentIndexToSend is zero because
-    // there might be multiple messages on the start of the queue that didn't read yet)
-    // we don't free the header
+    // If the rings are mapped into user-mode, the debugger reads them directly
     //
-    RtlZeroMemory(SendingBuffer, Header->BufferLength);
-
-    if (PriorityMessageIsAvailable)
+    while (!g_LogSharedRings.IsShared)
     {
         //
-        // Check to see whether we passed the index or not
+        // Priority messages are always read first
         //
-        if (MessageBufferInformation[Index].CurrentIndexToSendPriority > MaximumPacketsCapacityPriority - 2)
+        Priority = TRUE;
+        Header   = LogPeekNextRecord(Priority, &Index, &CoreIndex);
+
+        if (Header == NULL)
         {
-            MessageBufferInformation[Index].CurrentIndexToSendPriority = 0;
+            Priority = FALSE;
+            Header   = LogPeekNextRecord(Priority, &Index, &CoreIndex);
+
+            if (Header == NULL)
+            {
+                //
+                // there is nothing else to send
+                //
+                break;
+            }
         }
-        else
+
+        MessageSize = DEBUGGER_BATCHED_MESSAGE_SIZE(Header->BufferLength);
+
+        if (Offset + MessageSize > BufferLength)
         {
             //
-            // Increment the next index to read
+            // The buffer is full, the rest of messages remain for the next read
             //
-            MessageBufferInformation[Index].CurrentIndexToSendPriority = MessageBufferInformation[Index].CurrentIndexToSendPriority + 1;
+            break;
         }
-    }
-    else
-    {
+
         //
-        // Check to see whether we passed the index or not
+        // Save the header and the body (with its null character)
         //
-        if (MessageBufferInformation[Index].CurrentIndexToSend > MaximumPacketsCapacity - 2)
+        MessageHeader = (DEBUGGER_BATCHED_MESSAGE_HEADER *)((UINT64)BufferToSaveMessages + Offset);
+
+        MessageHeader->TimeStamp     = Header->TimeStamp;
+        MessageHeader->OperationCode = Header->OperationNumber;
+        MessageHeader->BufferLength  = Header->BufferLength;
+        MessageHeader->CoreId        = Header->CoreId;
+        MessageHeader->Flags         = Header->Flags;
+
+        RtlCopyBytes((PVOID)((UINT64)MessageHeader + sizeof(DEBUGGER_BATCHED_MESSAGE_HEADER)),
+                     (PVOID)((UINT64)Header + sizeof(RING_RECORD_HEADER)),
+                     Header->BufferLength + 1);
+
+        Offset += MessageSize;
+
+        //
+        // Release the slot as we sent it, and start the next read from the other mode
+        //
+        if (Priority)
         {
-            MessageBufferInformation[Index].CurrentIndexToSend = 0;
+            RingConsumeFair(MessageBufferInformation[Index].RingsPriority, &MessageBufferInformation[Index].DrainingPriority, CoreIndex);
         }
         else
         {
-            //
-            // Increment the next index to read
-            //
-            MessageBufferInformation[Index].CurrentIndexToSend = MessageBufferInformation[Index].CurrentIndexToSend + 1;
+            RingConsumeFair(MessageBufferInformation[Index].Rings, &MessageBufferInformation[Index].Draining, CoreIndex);
         }
+
+        LogDrainingNextMode = (Index + 1) % 2;
     }
 
     //
-    // Check if we're in Vmx-root, if it is then we use our customized HIGH_IRQL Spinlock,
-    // if not we use the windows spinlock
+    // Release the lock of readers
     //
-    if (IsVmxRoot)
-    {
-        SpinlockUnlock(&VmxRootLoggingLock);
-    }
-    else
-    {
-        //
-        // Release the lock
-        //
-        KeReleaseSpinLock(&MessageBufferInformation[Index].BufferLock, OldIRQL);
-    }
+    LogUnlockConsumer(1, OldIRQLVmxRoot);
+    LogUnlockConsumer(0, OldIRQLVmxNonRoot);
 
-    return TRUE;
+    *ReturnedLength = Offset;
+
+    return Offset != 0;
 }
 
 /**
@@ -921,43 +1476,26 @@ LogReadBuffer(BOOLEAN IsVmxRoot, PVOID BufferToSaveMessage, UINT32 * ReturnedLen
 BOOLEAN
 LogCheckForNewMessage(BOOLEAN IsVmxRoot, BOOLEAN Priority)
 {
-    UINT32 Index;
-
-    if (IsVmxRoot)
-    {
-        Index = 1;
-    }
-    else
-    {
-        Index = 0;
-    }
+    UINT32        Index = IsVmxRoot ? 1 : 0;
+    RING_BUFFER * Rings;
 
-    //
-    // Compute the current buffer to read
-    //
-    BUFFER_HEADER * Header;
-
-    if (Priority)
-    {
-        Header = (BUFFER_HEADER *)((UINT64)MessageBufferInformation[Index].BufferStartAddressPriority + (MessageBufferInformation[Index].CurrentIndexToSendPriority * (PacketChunkSize + sizeof(BUFFER_HEADER))));
-    }
-    else
-    {
-        Header = (BUFFER_HEADER *)((UINT64)MessageBufferInformation[Index].BufferStartAddress + (MessageBufferInformation[Index].CurrentIndexToSend * (PacketChunkSize + sizeof(BUFFER_HEADER))));
-    }
+    Rings = Priority ? MessageBufferInformation[Index].RingsPriority : MessageBufferInformation[Index].Rings;
 
-    if (!Header->Valid)
+    for (UINT32 i = 0; i < LogNumberOfCores; i++)
     {
-        //
-        // there is nothing to send
-        //
-        return FALSE;
+        if (!RingIsEmpty(&Rings[i]))
+        {
+            //
+            // If we reached here, means that there is sth to send
+            //
+            return TRUE;
+        }
     }
 
     //
-    // If we reached here, means that there is sth to send
+    // there is nothing to send
     //
-    return TRUE;
+    return FALSE;
 }
 
 /**
@@ -983,17 +1521,26 @@ LogCallbackPrepareAndSendMessageToQueueWrapper(UINT32       OperationCode,
     int     SprintfResult;
     size_t  WrittenSize;
     BOOLEAN IsVmxRootMode;
-    BOOLEAN Result         = FALSE; // by default, we assume error happens
-    char *  LogMessage     = NULL;
-    char *  TempMessage    = NULL;
-    char    TimeBuffer[20] = {0};
-    ULONG   CurrentCore    = KeGetCurrentProcessorNumberEx(NULL);
+    BOOLEAN ShowTimeInDebugger;
+    BOOLEAN IsCoreBufferUsed = FALSE;
+    BOOLEAN Result           = FALSE; // by default, we assume error happens
+    char *  LogMessage       = NULL;
+    char *  TempMessage      = NULL;
+    char    TimeBuffer[20]   = {0};
+    ULONG   CurrentCore      = KeGetCurrentProcessorNumberEx(NULL);
 
     //
     // Set Vmx State
     //
     IsVmxRootMode = LogCheckVmxOperation();
 
+    //
+    // Immediate messages that are saved in the rings carry the TSC and the core in the header
+    // of their records, so the debugger shows the time. Other messages (accumulated non-immediate
+    // messages and messages that are sent to the remote debugger) are formatted here
+    //
+    ShowTimeInDebugger = ShowCurrentSystemTime && IsImmediateMessage && !LogCheckImmediateSend(OperationCode);
+
     //
     // Set the buffer here, we avoid use stack (local variables) because stack might growth
     // and be problematic
@@ -1003,10 +1550,22 @@ LogCallbackPrepareAndSendMessageToQueueWrapper(UINT32       OperationCode,
         LogMessage  = &VmxLogMessage[CurrentCore * PacketChunkSize];
         TempMessage = &VmxTempMessage[CurrentCore * PacketChunkSize];
     }
+    else if (SpinlockTryLock(&NonRootMessageLocks[CurrentCore]))
+    {
+        //
+        // The buffers of the current core are used. We don't raise the IRQL while
+        // formatting (arguments might be paged), so the thread might be moved to
+        // another core and the slot is owned by its lock instead of the core
+        //
+        IsCoreBufferUsed = TRUE;
+        LogMessage       = &NonRootLogMessage[CurrentCore * PacketChunkSize];
+        TempMessage      = &NonRootTempMessage[CurrentCore * PacketChunkSize];
+    }
     else
     {
         //
-        // To avoid buffer collision and buffer re-writing in VMX non-root, allocate pool
+        // The buffers of this core are used by another thread (e.g., it's preempted
+        // while formatting), to avoid buffer collision allocate pool
         //
         LogMessage = PlatformMemAllocateNonPagedPool(PacketChunkSize);
 
@@ -1017,19 +1576,26 @@ LogCallbackPrepareAndSendMessageToQueueWrapper(UINT32       OperationCode,
             //
             return FALSE;
         }
-        TempMessage = PlatformMemAllocateNonPagedPool(PacketChunkSize);
 
-        if (TempMessage == NULL)
+        //
+        // The temporary buffer is only needed if the time is formatted here
+        //
+        if (ShowCurrentSystemTime && !ShowTimeInDebugger)
         {
-            //
-            // Insufficient space
-            //
-            PlatformMemFreePool(LogMessage);
-            return FALSE;
+            TempMessage = PlatformMemAllocateNonPagedPool(PacketChunkSize);
+
+            if (TempMessage == NULL)
+            {
+                //
+                // Insufficient space
+                //
+                PlatformMemFreePool(LogMessage);
+                return FALSE;
+            }
         }
     }
 
-    if (ShowCurrentSystemTime)
+    if (ShowCurrentSystemTime && !ShowTimeInDebugger)
     {
         //
         // It's actually not necessary to use -1 but because user-mode code might assume a null-terminated buffer so
@@ -1138,14 +1704,27 @@ LogCallbackPrepareAndSendMessageToQueueWrapper(UINT32       OperationCode,
     //
     // Send the prepared buffer (with no priority)
     //
-    Result = LogCallbackSendMessageToQueue(OperationCode, IsImmediateMessage, LogMessage, (UINT32)WrittenSize, Priority);
+    Result = LogSendMessageToQueue(OperationCode,
+                                   IsImmediateMessage,
+                                   LogMessage,
+                                   (UINT32)WrittenSize,
+                                   Priority,
+                                   ShowTimeInDebugger ? LOG_RECORD_FLAG_SHOW_TIME : 0);
 
 FreeBufferAndReturn:
 
-    if (!IsVmxRootMode)
+    if (IsCoreBufferUsed)
+    {
+        SpinlockUnlock(&NonRootMessageLocks[CurrentCore]);
+    }
+    else if (!IsVmxRootMode)
     {
         PlatformMemFreePool(LogMessage);
-        PlatformMemFreePool(TempMessage);
+
+        if (TempMessage != NULL)
+        {
+            PlatformMemFreePool(TempMessage);
+        }
     }
 
     return Result;
@@ -1189,23 +1768,326 @@ LogCallbackPrepareAndSendMessageToQueue(UINT32       OperationCode,
 }
 
 /**
- * @brief Send string messages and tracing for logging and monitoring
+ * @brief Send the accumulated messages of a coalescing buffer as one record
+ * @details The caller should own the buffer (hold its lock in vmx non-root)
+ *
+ * @param Coalescing The coalescing buffer
+ * @param Reason The reason of sending the batch
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+LogFlushCoalescingBuffer(LOG_COALESCING_BUFFER * Coalescing, LOG_COALESCING_FLUSH_REASON Reason)
+{
+    BOOLEAN Result;
+
+    if (Coalescing->Length == 0)
+    {
+        return TRUE;
+    }
+
+    //
+    // Accumulated messages don't have priority
+    //
+    Result = LogCallbackSendBuffer(OPERATION_LOG_NON_IMMEDIATE_MESSAGE,
+                                   Coalescing->Buffer,
+                                   Coalescing->Length,
+                                   FALSE);
+
+    //
+    // Count the batch (the counters of a buffer are only updated by its owner)
+    //
+    Coalescing->Statistics.Batches++;
+    Coalescing->Statistics.Messages += Coalescing->NumberOfMessages;
+    Coalescing->Statistics.Bytes += Coalescing->Length;
+
+    switch (Reason)
+    {
+    case LOG_COALESCING_FLUSH_BY_SIZE:
+        Coalescing->Statistics.FlushesBySize++;
+        break;
+    case LOG_COALESCING_FLUSH_BY_LATENCY:
+        Coalescing->Statistics.FlushesByLatency++;
+        break;
+    case LOG_COALESCING_FLUSH_BY_TIMER:
+        Coalescing->Statistics.FlushesByTimer++;
+        break;
+    }
+
+    Coalescing->Length           = 0;
+    Coalescing->NumberOfMessages = 0;
+
+    return Result;
+}
+
+/**
+ * @brief Arm the timer of vmx non-root accumulated messages (if it's not armed)
+ * @details Should be called in vmx non-root at IRQL <= DISPATCH_LEVEL
+ *
+ * @param Delay The delay of the timer (in microseconds)
+ *
+ * @return VOID
+ */
+static VOID
+LogArmCoalescingTimer(UINT64 Delay)
+{
+    LARGE_INTEGER DueTime;
+
+    if (g_LogCoalescingLatencyTicks == 0 ||
+        InterlockedCompareExchange(&LogCoalescingTimerArmed, TRUE, FALSE) != FALSE)
+    {
+        //
+        // There is no latency threshold or the timer is already armed
+        //
+        return;
+    }
+
+    //
+    // Relative time (in 100-nanosecond units)
+    //
+    DueTime.QuadPart = -(LONGLONG)(Delay * 10);
+
+    KeSetTimer(&LogCoalescingTimer, DueTime, &LogCoalescingDpc);
+}
+
+/**
+ * @brief The timer DPC that sends the expired vmx non-root accumulated messages
+ * @details vmx-root accumulated messages are sent by their own core (VM-exit tail),
+ * as only the core itself can write into its vmx-root rings
+ *
+ * @param Dpc
+ * @param DeferredContext
+ * @param SystemArgument1
+ * @param SystemArgument2
+ * @return VOID
+ */
+VOID
+LogCoalescingTimerCallback(PKDPC Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
+{
+    LOG_COALESCING_BUFFER * Coalescing;
+    UINT64                  LatencyTicks;
+    UINT64                  Age;
+    UINT64                  Delay = MAXUINT64;
+
+    UNREFERENCED_PARAMETER(Dpc);
+    UNREFERENCED_PARAMETER(DeferredContext);
+    UNREFERENCED_PARAMETER(SystemArgument1);
+    UNREFERENCED_PARAMETER(SystemArgument2);
+
+    //
+    // Messages that are accumulated from now on arm the timer again
+    //
+    InterlockedExchange(&LogCoalescingTimerArmed, FALSE);
+
+    //
+    // If the latency threshold is disabled, all of the buffers are sent
+    //
+    LatencyTicks = g_LogCoalescingLatencyTicks;
+
+    for (UINT32 i = 0; i < LogNumberOfCores; i++)
+    {
+        Coalescing = &MessageBufferInformation[0].CoalescingBuffers[i];
+
+        KeAcquireSpinLockAtDpcLevel(&Coalescing->Lock);
+
+        if (Coalescing->Length != 0)
+        {
+            Age = LogGetTimeStamp() - Coalescing->FirstMessageTimeStamp;
+
+            if (Age >= LatencyTicks)
+            {
+                LogFlushCoalescingBuffer(Coalescing, LOG_COALESCING_FLUSH_BY_TIMER);
+            }
+            else if (LatencyTicks - Age < Delay)
+            {
+                //
+                // Keep the remaining time of the oldest batch
+                //
+                Delay = LatencyTicks - Age;
+            }
+        }
+
+        KeReleaseSpinLockFromDpcLevel(&Coalescing->Lock);
+    }
+
+    if (Delay != MAXUINT64)
+    {
+        LogArmCoalescingTimer(Delay / LogTimeStampTicksPerMicrosecond + 1);
+    }
+}
+
+/**
+ * @brief Accumulate a non-immediate message into the buffer of the current core
+ * @details The batch is sent once it reaches the byte threshold or its oldest
+ * message reaches the latency threshold
+ *
+ * @param IsVmxRoot Whether the caller is in vmx-root or not
+ * @param LogMessage The message
+ * @param BufferLen Length of the message
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+LogCoalesceMessage(BOOLEAN IsVmxRoot, CHAR * LogMessage, UINT32 BufferLen)
+{
+    LOG_COALESCING_BUFFER * Coalescing;
+    ULONG                   CurrentCore;
+    UINT64                  LatencyTicks;
+    BOOLEAN                 Result   = TRUE;
+    BOOLEAN                 ArmTimer = FALSE;
+    KIRQL                   OldIRQL  = NULL_ZERO;
+
+    if (BufferLen > PacketChunkSize - 1 || BufferLen == 0)
+    {
+        return FALSE;
+    }
+
+    //
+    // In vmx non-root, we raise the IRQL to DISPATCH_LEVEL so the thread is not
+    // scheduled to another core, the lock is still needed as the timer DPC sends
+    // the buffers of all cores. In vmx-root RFLAGS.IF is cleared and only the
+    // core itself accesses its buffer
+    //
+    if (!IsVmxRoot)
+    {
+        OldIRQL = KeRaiseIrqlToDpcLevel();
+    }
+
+    CurrentCore = KeGetCurrentProcessorNumberEx(NULL);
+    Coalescing  = &MessageBufferInformation[IsVmxRoot ? 1 : 0].CoalescingBuffers[CurrentCore];
+
+    if (!IsVmxRoot)
+    {
+        KeAcquireSpinLockAtDpcLevel(&Coalescing->Lock);
+    }
+
+    //
+    // If the message doesn't fit into the buffer then we have to send the previous messages
+    //
+    if (Coalescing->Length + BufferLen > PacketChunkSize - 1)
+    {
+        Result = LogFlushCoalescingBuffer(Coalescing, LOG_COALESCING_FLUSH_BY_SIZE);
+    }
+
+    if (Coalescing->Length == 0)
+    {
+        Coalescing->FirstMessageTimeStamp = LogGetTimeStamp();
+        ArmTimer                          = !IsVmxRoot;
+    }
+
+    //
+    // We have to save the message
+    //
+    RtlCopyBytes(Coalescing->Buffer + Coalescing->Length, LogMessage, BufferLen);
+
+    Coalescing->Length += BufferLen;
+    Coalescing->NumberOfMessages++;
+
+    //
+    // Send the batch if it reached one of the thresholds
+    //
+    LatencyTicks = g_LogCoalescingLatencyTicks;
+
+    if (Coalescing->Length >= g_LogCoalescingByteThreshold)
+    {
+        Result   = LogFlushCoalescingBuffer(Coalescing, LOG_COALESCING_FLUSH_BY_SIZE) && Result;
+        ArmTimer = FALSE;
+    }
+    else if (LatencyTicks != 0 && LogGetTimeStamp() - Coalescing->FirstMessageTimeStamp >= LatencyTicks)
+    {
+        Result   = LogFlushCoalescingBuffer(Coalescing, LOG_COALESCING_FLUSH_BY_LATENCY) && Result;
+        ArmTimer = FALSE;
+    }
+
+    if (!IsVmxRoot)
+    {
+        KeReleaseSpinLockFromDpcLevel(&Coalescing->Lock);
+
+        if (ArmTimer)
+        {
+            LogArmCoalescingTimer(g_LogCoalescingLatency);
+        }
+
+        KeLowerIrql(OldIRQL);
+    }
+
+    return Result;
+}
+
+/**
+ * @brief Send the vmx-root accumulated messages of the current core if the
+ * oldest message reached the latency threshold
+ * @details Called at the tail of VM-exits, so it should be cheap when there
+ * is nothing to send
+ *
+ * @return BOOLEAN TRUE if a batch is sent
+ */
+BOOLEAN
+LogCallbackFlushExpiredMessages()
+{
+    LOG_COALESCING_BUFFER * Coalescing;
+    UINT64                  LatencyTicks = g_LogCoalescingLatencyTicks;
+
+    if (MessageBufferInformation == NULL || LatencyTicks == 0)
+    {
+        return FALSE;
+    }
+
+    Coalescing = &MessageBufferInformation[1].CoalescingBuffers[KeGetCurrentProcessorNumberEx(NULL)];
+
+    if (Coalescing->Length == 0 ||
+        LogGetTimeStamp() - Coalescing->FirstMessageTimeStamp < LatencyTicks ||
+        !LogCheckVmxOperation())
+    {
+        //
+        // Nothing to send (or we're not in vmx-root, the owner of the buffer)
+        //
+        return FALSE;
+    }
+
+    return LogFlushCoalescingBuffer(Coalescing, LOG_COALESCING_FLUSH_BY_LATENCY);
+}
+
+/**
+ * @brief Send string messages and tracing for logging and monitoring
+ *
+ * @param OperationCode Optional operation code
+ * @param IsImmediateMessage Should be sent immediately
+ * @param LogMessage Link of message buffer
+ * @param BufferLen Length of buffer
+ * @param Priority Whether the buffer has priority
+ *
+ * @return BOOLEAN if it was successful then return TRUE, otherwise returns FALSE
+ */
+BOOLEAN
+LogCallbackSendMessageToQueue(UINT32 OperationCode, BOOLEAN IsImmediateMessage, CHAR * LogMessage, UINT32 BufferLen, BOOLEAN Priority)
+{
+    return LogSendMessageToQueue(OperationCode, IsImmediateMessage, LogMessage, BufferLen, Priority, 0);
+}
+
+/**
+ * @brief Send string messages with the flags of their records
+ * @details Non-immediate messages are accumulated into one record, so
+ * their flags are ignored
  *
  * @param OperationCode Optional operation code
  * @param IsImmediateMessage Should be sent immediately
  * @param LogMessage Link of message buffer
  * @param BufferLen Length of buffer
  * @param Priority Whether the buffer has priority
+ * @param Flags Flags of the record (LOG_RECORD_FLAG_*)
  *
  * @return BOOLEAN if it was successful then return TRUE, otherwise returns FALSE
  */
 BOOLEAN
-LogCallbackSendMessageToQueue(UINT32 OperationCode, BOOLEAN IsImmediateMessage, CHAR * LogMessage, UINT32 BufferLen, BOOLEAN Priority)
+LogSendMessageToQueue(UINT32  OperationCode,
+                      BOOLEAN IsImmediateMessage,
+                      CHAR *  LogMessage,
+                      UINT32  BufferLen,
+                      BOOLEAN Priority,
+                      UINT32  Flags)
 {
-    BOOLEAN Result;
-    UINT32  Index;
     BOOLEAN IsVmxRootMode;
-    KIRQL   OldIRQL = NULL_ZERO;
 
     //
     // Set Vmx State
@@ -1250,89 +2132,14 @@ LogCallbackSendMessageToQueue(UINT32 OperationCode, BOOLEAN IsImmediateMessage,
 #else
     if (IsImmediateMessage)
     {
-        return LogCallbackSendBuffer(OperationCode, LogMessage, BufferLen, Priority);
+        return LogSendBuffer(OperationCode, LogMessage, BufferLen, Priority, Flags);
     }
     else
     {
         //
-        // Check if we're in Vmx-root, if it is then we use our customized HIGH_IRQL Spinlock,
-        // if not we use the windows spinlock
-        //
-        if (IsVmxRootMode)
-        {
-            //
-            // Set the index
-            //
-            Index = 1;
-            SpinlockLock(&VmxRootLoggingLockForNonImmBuffers);
-        }
-        else
-        {
-            //
-            // Set the index
-            //
-            Index = 0;
-
-            //
-            // Acquire the lock
-            //
-            KeAcquireSpinLock(&MessageBufferInformation[Index].BufferLockForNonImmMessage, &OldIRQL);
-        }
-        //
-        // Set the result to True
-        //
-        Result = TRUE;
-
-        //
-        // If log message WrittenSize is above the buffer then we have to send the previous buffer
-        //
-        if ((MessageBufferInformation[Index].CurrentLengthOfNonImmBuffer + BufferLen) > PacketChunkSize - 1 && MessageBufferInformation[Index].CurrentLengthOfNonImmBuffer != 0)
-        {
-            //
-            // Send the previous buffer (non-immediate message),
-            // accumulated messages don't have priority
-            //
-            Result = LogCallbackSendBuffer(OPERATION_LOG_NON_IMMEDIATE_MESSAGE,
-                                           (PVOID)MessageBufferInformation[Index].BufferForMultipleNonImmediateMessage,
-                                           MessageBufferInformation[Index].CurrentLengthOfNonImmBuffer,
-                                           FALSE);
-
-            //
-            // Free the immediate buffer
-            //
-            MessageBufferInformation[Index].CurrentLengthOfNonImmBuffer = 0;
-            RtlZeroMemory((void *)MessageBufferInformation[Index].BufferForMultipleNonImmediateMessage, PacketChunkSize);
-        }
-
+        // Accumulate the message into the buffer of the current core
         //
-        // We have to save the message
-        //
-        RtlCopyBytes((void *)(MessageBufferInformation[Index].BufferForMultipleNonImmediateMessage +
-                              MessageBufferInformation[Index].CurrentLengthOfNonImmBuffer),
-                     LogMessage,
-                     BufferLen);
-
-        //
-        // add the length
-        //
-        MessageBufferInformation[Index].CurrentLengthOfNonImmBuffer += BufferLen;
-
-        // Check if we're in Vmx-root, if it is then we use our customized HIGH_IRQL Spinlock,
-        // if not we use the windows spinlock
-        //
-        if (IsVmxRootMode)
-        {
-            SpinlockUnlock(&VmxRootLoggingLockForNonImmBuffers);
-        }
-        else
-        {
-            //
-            // Release the lock
-            //
-            KeReleaseSpinLock(&MessageBufferInformation[Index].BufferLockForNonImmMessage, OldIRQL);
-        }
-
-        return Result;
+        return LogCoalesceMessage(IsVmxRootMode, LogMessage, BufferLen);
     }
 #endif
 }
@@ -1352,6 +2159,7 @@ LogNotifyUsermodeCallback(PKDPC Dpc, PVOID DeferredContext, PVOID SystemArgument
     PNOTIFY_RECORD NotifyRecord;
     PIRP           Irp;
     UINT32         Length;
+    BOOLEAN        Result;
 
     UNREFERENCED_PARAMETER(Dpc);
     UNREFERENCED_PARAMETER(SystemArgument1);
@@ -1365,6 +2173,7 @@ LogNotifyUsermodeCallback(PKDPC Dpc, PVOID DeferredContext, PVOID SystemArgument
     switch (NotifyRecord->Type)
     {
     case IRP_BASED:
+    case IRP_BASED_BATCHED:
         Irp = NotifyRecord->Message.PendingIrp;
 
         if (Irp != NULL)
@@ -1387,7 +2196,8 @@ LogNotifyUsermodeCallback(PKDPC Dpc, PVOID DeferredContext, PVOID SystemArgument
             InBuffLength  = IrpSp->Parameters.DeviceIoControl.InputBufferLength;
             OutBuffLength = IrpSp->Parameters.DeviceIoControl.OutputBufferLength;
 
-            if (!InBuffLength || !OutBuffLength)
+            if (!InBuffLength || !OutBuffLength ||
+                (NotifyRecord->Type == IRP_BASED_BATCHED && OutBuffLength < DEBUGGER_BATCHED_MESSAGE_SIZE(PacketChunkSize)))
             {
                 Irp->IoStatus.Status = STATUS_INVALID_PARAMETER;
                 IoCompleteRequest(Irp, IO_NO_INCREMENT);
@@ -1411,7 +2221,16 @@ LogNotifyUsermodeCallback(PKDPC Dpc, PVOID DeferredContext, PVOID SystemArgument
             //
             // Read Buffer might be empty (nothing to send)
             //
-            if (!LogReadBuffer(NotifyRecord->CheckVmxRootMessagePool, OutBuff, &Length))
+            if (NotifyRecord->Type == IRP_BASED_BATCHED)
+            {
+                Result = LogReadBufferBatch(OutBuff, OutBuffLength, &Length);
+            }
+            else
+            {
+                Result = LogReadBuffer(NotifyRecord->CheckVmxRootMessagePool, OutBuff, &Length);
+            }
+
+            if (!Result)
             {
                 //
                 // we have to return here as there is nothing to send here
@@ -1428,6 +2247,21 @@ LogNotifyUsermodeCallback(PKDPC Dpc, PVOID DeferredContext, PVOID SystemArgument
         }
         break;
 
+    case IRP_BASED_DOORBELL:
+        Irp = NotifyRecord->Message.PendingIrp;
+
+        if (Irp != NULL)
+        {
+            //
+            // The debugger reads the messages from the shared rings, so
+            // the IRP is only completed to notify it
+            //
+            Irp->IoStatus.Information = 0;
+            Irp->IoStatus.Status      = STATUS_SUCCESS;
+            IoCompleteRequest(Irp, IO_NO_INCREMENT);
+        }
+        break;
+
     case EVENT_BASED:
         //
         // Signal the Event created in user-mode.
@@ -1491,7 +2325,7 @@ LogRegisterIrpBasedNotification(PVOID TargetIrp, LONG * Status)
             return FALSE;
         }
 
-        NotifyRecord->Type               = IRP_BASED;
+        NotifyRecord->Type               = RegisterEvent->Type; // IRP_BASED, IRP_BASED_BATCHED, or IRP_BASED_DOORBELL
         NotifyRecord->Message.PendingIrp = Irp;
 
         KeInitializeDpc(&NotifyRecord->Dpc,        // Dpc
@@ -1558,6 +2392,20 @@ LogRegisterIrpBasedNotification(PVOID TargetIrp, LONG * Status)
             // Set the notify routine to the global structure
             //
             g_GlobalNotifyRecord = NotifyRecord;
+
+            //
+            // As producers don't use any lock, a message might be published after the
+            // above checks but before setting the notify routine, so check again to
+            // avoid missing the message
+            //
+            if (LogCheckForNewMessage(FALSE, TRUE) || LogCheckForNewMessage(FALSE, FALSE))
+            {
+                LogNotifyPendingReader(FALSE);
+            }
+            else if (LogCheckForNewMessage(TRUE, TRUE) || LogCheckForNewMessage(TRUE, FALSE))
+            {
+                LogNotifyPendingReader(TRUE);
+            }
         }
         //
         // We will return pending as we have marked the IRP pending
@@ -1634,3 +2482,350 @@ LogRegisterEventBasedNotification(PVOID TargetIrp)
 
     return TRUE;
 }
+
+/**
+ * @brief Map a buffer into the address space of the current process
+ * @details The read-only views are mapped with SEC_NO_CHANGE, so the debugger
+ * can't make them writable
+ *
+ * @param Buffer The buffer
+ * @param IsWritable Whether the user-mode mapping is writable or not
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+LogMapBufferToUserMode(LOG_SHARED_BUFFER * Buffer, BOOLEAN IsWritable)
+{
+    PVOID    BaseAddress = NULL;
+    SIZE_T   ViewSize    = 0;
+    NTSTATUS Status;
+
+    Status = ZwMapViewOfSection(Buffer->SectionHandle,
+                                ZwCurrentProcess(),
+                                &BaseAddress,
+                                0,
+                                Buffer->Size,
+                                NULL,
+                                &ViewSize,
+                                ViewUnmap,
+                                IsWritable ? 0 : SEC_NO_CHANGE,
+                                IsWritable ? PAGE_READWRITE : PAGE_READONLY);
+
+    if (!NT_SUCCESS(Status))
+    {
+        return FALSE;
+    }
+
+    Buffer->UserModeAddress = BaseAddress;
+
+    return TRUE;
+}
+
+/**
+ * @brief Unmap a buffer from the address space of the current process
+ *
+ * @param Buffer The buffer
+ *
+ * @return VOID
+ */
+static VOID
+LogUnmapBufferFromUserMode(LOG_SHARED_BUFFER * Buffer)
+{
+    if (Buffer->UserModeAddress != NULL)
+    {
+        ZwUnmapViewOfSection(ZwCurrentProcess(), Buffer->UserModeAddress);
+        Buffer->UserModeAddress = NULL;
+    }
+}
+
+/**
+ * @brief Map the rings into the debugger process
+ * @details Should be called at PASSIVE_LEVEL in the context of the debugger
+ * process. After mapping, the debugger is the only consumer of the rings and
+ * the kernel only notifies it (IRP_BASED_DOORBELL) about new messages
+ *
+ * @param SharedRingsRequest The request that receives the user-mode addresses
+ * @param Owner The file object of the debugger (used for unmapping on cleanup)
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+LogMapRingsToUserMode(DEBUGGER_SHARED_LOG_RINGS * SharedRingsRequest, PVOID Owner)
+{
+    BOOLEAN IsWritable;
+    KIRQL   OldIRQL;
+
+    if (MessageBufferInformation == NULL)
+    {
+        //
+        // The buffers are not initialized
+        //
+        return FALSE;
+    }
+
+    ExAcquireFastMutex(&g_LogSharedRings.Lock);
+
+    if (g_LogSharedRings.IsShared)
+    {
+        //
+        // The rings are already mapped (possibly into another process)
+        //
+        ExReleaseFastMutex(&g_LogSharedRings.Lock);
+        return FALSE;
+    }
+
+    //
+    // Indexes, then the regular and priority rings of vmx non-root and vmx-root
+    //
+    for (UINT32 i = 0; i < LOG_SHARED_RINGS_NUMBER_OF_MAPPINGS; i++)
+    {
+        //
+        // Only the consumer indexes are writable by the debugger
+        //
+        IsWritable = i == 1;
+
+        if (!LogMapBufferToUserMode(&g_LogSharedRings.Buffers[i], IsWritable))
+        {
+            for (UINT32 j = 0; j < i; j++)
+            {
+                LogUnmapBufferFromUserMode(&g_LogSharedRings.Buffers[j]);
+            }
+
+            ExReleaseFastMutex(&g_LogSharedRings.Lock);
+            return FALSE;
+        }
+    }
+
+    //
+    // Stop the kernel readers, acquiring the locks of readers guarantees that
+    // no reader is still reading the rings after this point
+    //
+    g_LogSharedRings.IsShared = TRUE;
+    g_LogSharedRings.Owner    = Owner;
+
+    OldIRQL = LogLockConsumer(0);
+    LogUnlockConsumer(0, OldIRQL);
+
+    OldIRQL = LogLockConsumer(1);
+    LogUnlockConsumer(1, OldIRQL);
+
+    //
+    // Fill the details of the rings for the debugger
+    //
+    SharedRingsRequest->NumberOfCores           = LogNumberOfCores;
+    SharedRingsRequest->MaximumRecordLength     = PacketChunkSize - 1;
+    SharedRingsRequest->RingSize                = LogRingSize;
+    SharedRingsRequest->RingSizePriority        = LogRingSizePriority;
+    SharedRingsRequest->ProducerIndexesAddress  = (UINT64)g_LogSharedRings.Buffers[0].UserModeAddress;
+    SharedRingsRequest->ConsumerIndexesAddress  = (UINT64)g_LogSharedRings.Buffers[1].UserModeAddress;
+    SharedRingsRequest->RingsAddress[0]         = (UINT64)g_LogSharedRings.Buffers[2].UserModeAddress;
+    SharedRingsRequest->RingsPriorityAddress[0] = (UINT64)g_LogSharedRings.Buffers[3].UserModeAddress;
+    SharedRingsRequest->RingsAddress[1]         = (UINT64)g_LogSharedRings.Buffers[4].UserModeAddress;
+    SharedRingsRequest->RingsPriorityAddress[1] = (UINT64)g_LogSharedRings.Buffers[5].UserModeAddress;
+
+    ExReleaseFastMutex(&g_LogSharedRings.Lock);
+
+    return TRUE;
+}
+
+/**
+ * @brief Unmap the rings from the debugger process
+ * @details Should be called at PASSIVE_LEVEL in the context of the debugger
+ * process. As the consumer indexes were writable by the debugger, they are not
+ * trusted anymore and the unread messages are discarded
+ *
+ * @param Owner The file object that mapped the rings
+ *
+ * @return BOOLEAN FALSE if the rings are not mapped by this owner
+ */
+BOOLEAN
+LogUnmapRingsFromUserMode(PVOID Owner)
+{
+    KIRQL OldIRQLVmxNonRoot;
+    KIRQL OldIRQLVmxRoot;
+
+    if (MessageBufferInformation == NULL)
+    {
+        //
+        // The buffers are not initialized
+        //
+        return FALSE;
+    }
+
+    ExAcquireFastMutex(&g_LogSharedRings.Lock);
+
+    if (!g_LogSharedRings.IsShared || g_LogSharedRings.Owner != Owner)
+    {
+        ExReleaseFastMutex(&g_LogSharedRings.Lock);
+        return FALSE;
+    }
+
+    //
+    // Unmap the buffers, so the debugger can't modify the indexes anymore
+    //
+    for (UINT32 i = 0; i < LOG_SHARED_RINGS_NUMBER_OF_MAPPINGS; i++)
+    {
+        LogUnmapBufferFromUserMode(&g_LogSharedRings.Buffers[i]);
+    }
+
+    //
+    // Move the consumer indexes to a valid position and resume the kernel readers
+    //
+    OldIRQLVmxNonRoot = LogLockConsumer(0);
+    OldIRQLVmxRoot    = LogLockConsumer(1);
+
+    for (UINT32 i = 0; i < 2; i++)
+    {
+        for (UINT32 j = 0; j < LogNumberOfCores; j++)
+        {
+            RingResynchronizeConsumer(&MessageBufferInformation[i].Rings[j]);
+            RingResynchronizeConsumer(&MessageBufferInformation[i].RingsPriority[j]);
+        }
+    }
+
+    g_LogSharedRings.IsShared = FALSE;
+    g_LogSharedRings.Owner    = NULL;
+
+    LogUnlockConsumer(1, OldIRQLVmxRoot);
+    LogUnlockConsumer(0, OldIRQLVmxNonRoot);
+
+    ExReleaseFastMutex(&g_LogSharedRings.Lock);
+
+    return TRUE;
+}
+
+/**
+ * @brief Change the overflow policy of the regular or the priority rings
+ *
+ * @param Priority Whether the policy of priority rings should be changed or not
+ * @param Policy The new policy
+ *
+ * @return BOOLEAN FALSE if the policy is not valid
+ */
+BOOLEAN
+LogSetOverflowPolicy(BOOLEAN Priority, LOG_OVERFLOW_POLICY Policy)
+{
+    if (Policy >= LOG_OVERFLOW_POLICY_MAXIMUM)
+    {
+        return FALSE;
+    }
+
+    //
+    // Producers read the policy each time they write a record
+    //
+    InterlockedExchange((volatile LONG *)&g_LogOverflowPolicy[Priority ? 1 : 0], (LONG)Policy);
+
+    return TRUE;
+}
+
+/**
+ * @brief Change the thresholds of sending accumulated non-immediate messages
+ *
+ * @param ByteThreshold The batch is sent once it reaches this length
+ * (PacketChunkSize - 1 means only full batches are sent)
+ * @param Latency The batch is sent once its oldest message waited for this
+ * time (in microseconds, zero means no limit)
+ *
+ * @return BOOLEAN FALSE if the thresholds are not valid
+ */
+BOOLEAN
+LogSetCoalescingThresholds(UINT32 ByteThreshold, UINT32 Latency)
+{
+    if (ByteThreshold == 0 || ByteThreshold > PacketChunkSize - 1 || Latency > LogCoalescingMaximumLatency)
+    {
+        return FALSE;
+    }
+
+    //
+    // Producers read the thresholds each time they accumulate a message
+    //
+    InterlockedExchange((volatile LONG *)&g_LogCoalescingByteThreshold, (LONG)ByteThreshold);
+    InterlockedExchange((volatile LONG *)&g_LogCoalescingLatency, (LONG)Latency);
+    InterlockedExchange64((volatile LONG64 *)&g_LogCoalescingLatencyTicks, (LONG64)(Latency * LogTimeStampTicksPerMicrosecond));
+
+    return TRUE;
+}
+
+/**
+ * @brief Query the overflow policies, the drop counters, and the occupancy of the rings
+ * @details The counters of rings are only copied if the buffer is large enough
+ * to hold the counters of all cores
+ *
+ * @param Statistics The buffer to save the result
+ * @param BufferLength Length of the buffer
+ *
+ * @return UINT32 Length of the filled buffer
+ */
+UINT32
+LogQueryBufferStatistics(DEBUGGER_LOG_BUFFER_STATISTICS * Statistics, UINT32 BufferLength)
+{
+    DEBUGGER_LOG_RING_STATISTICS *       Entries;
+    LOG_RING_STATISTICS *                Counters;
+    RING_BUFFER *                        Rings;
+    DEBUGGER_LOG_COALESCING_STATISTICS * Coalescing;
+    UINT32                               RequiredLength;
+    UINT32                               EntryIndex = 0;
+
+    Statistics->Policies[0]             = g_LogOverflowPolicy[0];
+    Statistics->Policies[1]             = g_LogOverflowPolicy[1];
+    Statistics->CoalescingByteThreshold = g_LogCoalescingByteThreshold;
+    Statistics->CoalescingLatency       = g_LogCoalescingLatency;
+    Statistics->NumberOfCores           = LogNumberOfCores;
+
+    RtlZeroMemory(&Statistics->Coalescing, sizeof(DEBUGGER_LOG_COALESCING_STATISTICS));
+
+    //
+    // Sum the batch counters of all cores (the counters are only written by
+    // the owner of the buffer, so the values might be slightly behind)
+    //
+    for (UINT32 i = 0; MessageBufferInformation != NULL && i < 2; i++)
+    {
+        for (UINT32 j = 0; j < LogNumberOfCores; j++)
+        {
+            Coalescing = &MessageBufferInformation[i].CoalescingBuffers[j].Statistics;
+
+            Statistics->Coalescing.Batches += Coalescing->Batches;
+            Statistics->Coalescing.Messages += Coalescing->Messages;
+            Statistics->Coalescing.Bytes += Coalescing->Bytes;
+            Statistics->Coalescing.FlushesBySize += Coalescing->FlushesBySize;
+            Statistics->Coalescing.FlushesByLatency += Coalescing->FlushesByLatency;
+            Statistics->Coalescing.FlushesByTimer += Coalescing->FlushesByTimer;
+        }
+    }
+
+    RequiredLength = sizeof(DEBUGGER_LOG_BUFFER_STATISTICS) + (LogNumberOfCores * 4 * sizeof(DEBUGGER_LOG_RING_STATISTICS));
+
+    if (MessageBufferInformation == NULL || BufferLength < RequiredLength)
+    {
+        //
+        // The caller can retry with a larger buffer based on the number of cores
+        //
+        return sizeof(DEBUGGER_LOG_BUFFER_STATISTICS);
+    }
+
+    Entries = (DEBUGGER_LOG_RING_STATISTICS *)((UINT8 *)Statistics + sizeof(DEBUGGER_LOG_BUFFER_STATISTICS));
+
+    for (UINT32 i = 0; i < 2; i++)
+    {
+        for (UINT32 Lane = 0; Lane < 2; Lane++)
+        {
+            Counters = Lane == 0 ? MessageBufferInformation[i].Statistics : MessageBufferInformation[i].StatisticsPriority;
+            Rings    = Lane == 0 ? MessageBufferInformation[i].Rings : MessageBufferInformation[i].RingsPriority;
+
+            //
+            // The counters are only written by their own core and the occupancy
+            // changes while reading it, so the values might be slightly behind
+            //
+            for (UINT32 j = 0; j < LogNumberOfCores; j++)
+            {
+                Entries[EntryIndex].DroppedRecords = Counters[j].DroppedRecords;
+                Entries[EntryIndex].DroppedBytes   = Counters[j].DroppedBytes;
+                Entries[EntryIndex].UsedBytes      = RingGetUsedSize(&Rings[j]);
+                Entries[EntryIndex].Size           = Rings[j].Size;
+                EntryIndex++;
+            }
+        }
+    }
+
+    return RequiredLength;
+}
@@ -12,6 +12,69 @@
 
 #pragma once
 
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Minimum number of regular messages (with the maximum length) that
+ * the ring of each core can hold
+ *
+ */
+#define MinimumPacketsCapacityPerCore 16
+
+/**
+ * @brief Minimum number of priority messages (with the maximum length) that
+ * the ring of each core can hold
+ *
+ */
+#define MinimumPacketsCapacityPriorityPerCore 4
+
+/**
+ * @brief Number of buffers that are mapped into user-mode when the rings are
+ * shared (producer indexes, consumer indexes, and the data of regular and
+ * priority rings of both modes)
+ *
+ */
+#define LOG_SHARED_RINGS_NUMBER_OF_MAPPINGS 6
+
+/**
+ * @brief The protection of a view of a section could not be changed
+ * (not defined in the headers of the WDK)
+ *
+ */
+#ifndef SEC_NO_CHANGE
+#    define SEC_NO_CHANGE 0x00400000
+#endif
+
+/**
+ * @brief Maximum time (in milliseconds) that a vmx non-root caller waits for
+ * the reader when the ring is full and the policy is LOG_OVERFLOW_POLICY_BLOCK
+ * @details The message is dropped after this time, so a missing reader can't
+ * hang the callers forever
+ *
+ */
+#define LogOverflowBlockingMaximumWait 100
+
+/**
+ * @brief Default latency threshold (in microseconds) of accumulated non-immediate
+ * messages, after this time the messages are sent even if the batch is not full
+ *
+ */
+#define LogCoalescingDefaultLatency 10000
+
+/**
+ * @brief Maximum latency threshold (in microseconds) that can be configured
+ *
+ */
+#define LogCoalescingMaximumLatency 1000000
+
+/**
+ * @brief Time (in microseconds) that is used for calibrating the TSC
+ *
+ */
+#define LogTimeStampCalibrationPeriod 1000
+
 //////////////////////////////////////////////////
 //				Global Variables				//
 //////////////////////////////////////////////////
@@ -28,6 +91,26 @@ char * VmxLogMessage;
  */
 char * VmxTempMessage;
 
+/**
+ * @brief vmx non-root buffers for logging messages
+ * @details Each core has a slot of PacketChunkSize bytes which is owned by
+ * the thread that acquires the lock of the slot
+ *
+ */
+char * NonRootLogMessage;
+
+/**
+ * @brief vmx non-root temporary buffers for logging messages
+ *
+ */
+char * NonRootTempMessage;
+
+/**
+ * @brief Locks of the vmx non-root buffers of cores
+ *
+ */
+volatile LONG * NonRootMessageLocks;
+
 //////////////////////////////////////////////////
 //					Structures					//
 //////////////////////////////////////////////////
@@ -51,69 +134,202 @@ typedef struct _NOTIFY_RECORD
 } NOTIFY_RECORD, *PNOTIFY_RECORD;
 
 /**
- * @brief Message buffer structure
+ * @brief Drop counters of a ring
+ * @details Only the core that owns the ring updates its counters
+ *
+ */
+typedef struct _LOG_RING_STATISTICS
+{
+    UINT64 DroppedRecords;    // Number of lost records (dropped or overwritten)
+    UINT64 DroppedBytes;      // Length of lost records
+    UINT64 UnreportedRecords; // Lost records that are not reported by a marker yet
+    UINT64 UnreportedBytes;   // Length of lost records that are not reported by a marker yet
+
+} LOG_RING_STATISTICS, *PLOG_RING_STATISTICS;
+
+/**
+ * @brief The reason of sending a batch of non-immediate messages
+ *
+ */
+typedef enum _LOG_COALESCING_FLUSH_REASON
+{
+    LOG_COALESCING_FLUSH_BY_SIZE,    // The batch reached the byte threshold (or the next message doesn't fit)
+    LOG_COALESCING_FLUSH_BY_LATENCY, // The batch reached the latency threshold (checked by the owner core)
+    LOG_COALESCING_FLUSH_BY_TIMER,   // The batch reached the latency threshold (checked by the timer DPC)
+
+} LOG_COALESCING_FLUSH_REASON;
+
+/**
+ * @brief Per-core buffer for accumulating non-immediate messages
+ * @details vmx-root buffers are only accessed by their own core (RFLAGS.IF is
+ * cleared), vmx non-root buffers are also flushed by the timer DPC on other cores,
+ * so they're protected by the lock
  *
  */
-typedef struct _BUFFER_HEADER
+typedef struct _LOG_COALESCING_BUFFER
 {
-    UINT32  OperationNumber; // Operation ID to user-mode
-    UINT32  BufferLength;    // The actual length
-    BOOLEAN Valid;           // Determine whether the buffer was valid to send or not
-} BUFFER_HEADER, *PBUFFER_HEADER;
+    KSPIN_LOCK Lock;                  // Only used in vmx non-root
+    CHAR *     Buffer;                // The accumulated messages (PacketChunkSize bytes)
+    UINT32     Length;                // Used bytes of the buffer
+    UINT32     NumberOfMessages;      // Number of the accumulated messages
+    UINT64     FirstMessageTimeStamp; // TSC of the oldest accumulated message
+
+    DEBUGGER_LOG_COALESCING_STATISTICS Statistics; // Counters of the sent batches
+
+} LOG_COALESCING_BUFFER, *PLOG_COALESCING_BUFFER;
 
 /**
- * @brief Core-specific buffers
+ * @brief Mode-specific buffers
+ * @details Each core has its own regular and priority rings in each mode, the
+ * producer of a ring is the core itself and the consumer is the reader of the
+ * buffers (LogReadBuffer), so writing messages doesn't need any lock
  *
  */
 typedef struct _LOG_BUFFER_INFORMATION
 {
-    KSPIN_LOCK BufferLock;                 // SpinLock to protect access to the queue
-    KSPIN_LOCK BufferLockForNonImmMessage; // SpinLock to protect access to the queue of non-imm messages
+    //
+    // Per-core buffers for accumulating non-immediate messages
+    //
+    LOG_COALESCING_BUFFER * CoalescingBuffers;
+    PVOID                   CoalescingData; // The accumulated messages of all cores
 
-    UINT64 BufferForMultipleNonImmediateMessage; // Start address of the buffer for accumulating non-immadiate messages
-    UINT32 CurrentLengthOfNonImmBuffer;          // the current size of the buffer for accumulating non-immadiate messages
+    volatile LONG ConsumerLock; // Serializes the readers as each ring only has one consumer
 
     //
-    // Regular buffers
+    // Per-core rings
     //
-    UINT64 BufferStartAddress; // Start address of the buffer
-    UINT64 BufferEndAddress;   // End address of the buffer
+    RING_BUFFER * Rings;         // Regular rings (one for each core)
+    RING_BUFFER * RingsPriority; // Priority rings (one for each core)
 
-    UINT32 CurrentIndexToSend;  // Current buffer index to send to user-mode
-    UINT32 CurrentIndexToWrite; // Current buffer index to write new messages
+    //
+    // Per-core drop counters
+    //
+    LOG_RING_STATISTICS * Statistics;         // Drop counters of regular rings
+    LOG_RING_STATISTICS * StatisticsPriority; // Drop counters of priority rings
 
     //
-    // Priority buffers
+    // The state of draining the rings of cores fairly (protected by the lock of readers)
     //
-    UINT64 BufferStartAddressPriority; // Start address of the buffer
-    UINT64 BufferEndAddressPriority;   // End address of the buffer
+    RING_FAIR_DRAINING Draining;         // Regular rings
+    RING_FAIR_DRAINING DrainingPriority; // Priority rings
+    UINT32 *           Deficits;         // Deficits of regular and priority rings of cores
 
-    UINT32 CurrentIndexToSendPriority;  // Current buffer index to send to user-mode for priority buffers
-    UINT32 CurrentIndexToWritePriority; // Current buffer index to write new messages for priority buffers
+    //
+    // The data of the rings of all cores (contiguous, so they can be mapped at once)
+    //
+    PVOID RingsBuffer;
+    PVOID RingsPriorityBuffer;
 
 } LOG_BUFFER_INFORMATION, *PLOG_BUFFER_INFORMATION;
 
+/**
+ * @brief A buffer that could be mapped into user-mode
+ * @details The buffer is a view of a section, so it's mapped into the
+ * debugger process with its own protection. The pages of the view are
+ * locked and the kernel uses them through a non-paged mapping
+ *
+ */
+typedef struct _LOG_SHARED_BUFFER
+{
+    HANDLE SectionHandle;   // Kernel handle of the section
+    PVOID  Section;         // The section object
+    PVOID  SystemView;      // The view of the section in the system space
+    PMDL   Mdl;             // Locks the pages of the view (NULL if they're not locked)
+    PVOID  Address;         // Non-paged address of the buffer (used by the kernel)
+    SIZE_T Size;            // Rounded up to pages
+    PVOID  UserModeAddress; // The view in the debugger process (NULL if it's not mapped)
+
+} LOG_SHARED_BUFFER, *PLOG_SHARED_BUFFER;
+
+/**
+ * @brief The state of mapping the rings into the debugger process
+ * @details While the rings are shared, the debugger is the only consumer
+ * of the rings and the kernel readers don't read the rings anymore
+ *
+ */
+typedef struct _LOG_SHARED_RINGS_STATE
+{
+    FAST_MUTEX        Lock;     // Serializes mapping and unmapping
+    volatile BOOLEAN  IsShared; // Whether the rings are mapped into user-mode or not
+    PVOID             Owner;    // The file object that mapped the rings
+    LOG_SHARED_BUFFER Buffers[LOG_SHARED_RINGS_NUMBER_OF_MAPPINGS];
+
+} LOG_SHARED_RINGS_STATE, *PLOG_SHARED_RINGS_STATE;
+
 //////////////////////////////////////////////////
 //				Global Variables				//
 //////////////////////////////////////////////////
 
 /**
- * @brief Global Variable for buffer on all cores
+ * @brief Global Variable for buffers of vmx non-root (0) and vmx-root (1)
  *
  */
 LOG_BUFFER_INFORMATION * MessageBufferInformation;
 
 /**
- * @brief Vmx-root lock for logging
+ * @brief Number of cores that have rings
+ *
+ */
+UINT32 LogNumberOfCores;
+
+/**
+ * @brief Size of the regular ring and the priority ring of each core
+ *
+ */
+UINT32 LogRingSize;
+UINT32 LogRingSizePriority;
+
+/**
+ * @brief Overflow policy of the regular (0) and priority (1) rings
+ *
+ */
+LOG_OVERFLOW_POLICY g_LogOverflowPolicy[2];
+
+/**
+ * @brief The mode that is drained first by the next batched read
+ * @details Batched reads alternate between the modes (protected by the lock
+ * of readers of both modes)
+ *
+ */
+UINT32 LogDrainingNextMode;
+
+/**
+ * @brief Published indexes of all rings (ordered by mode, lane, and core)
+ * @details Producer indexes and consumer indexes are kept in separate pages,
+ * so only the consumer indexes are writable when the rings are shared
  *
  */
-volatile LONG VmxRootLoggingLock;
+RING_INDEX * LogProducerIndexes;
+RING_INDEX * LogConsumerIndexes;
 
 /**
- * @brief Vmx-root lock for logging
+ * @brief The state of mapping the rings into user-mode
  *
  */
-volatile LONG VmxRootLoggingLockForNonImmBuffers;
+LOG_SHARED_RINGS_STATE g_LogSharedRings;
+
+/**
+ * @brief Thresholds of sending the accumulated non-immediate messages
+ *
+ */
+UINT32          g_LogCoalescingByteThreshold;
+UINT32          g_LogCoalescingLatency;      // In microseconds (zero means no limit)
+volatile UINT64 g_LogCoalescingLatencyTicks; // The latency threshold in TSC ticks
+
+/**
+ * @brief Number of TSC ticks in a microsecond (calibrated once)
+ *
+ */
+UINT64 LogTimeStampTicksPerMicrosecond;
+
+/**
+ * @brief The timer that sends the expired non-immediate messages of vmx non-root
+ * @details The timer is only armed when a buffer becomes non-empty
+ *
+ */
+KTIMER        LogCoalescingTimer;
+KDPC          LogCoalescingDpc;
+volatile LONG LogCoalescingTimerArmed;
 
 //////////////////////////////////////////////////
 //					Illustration				//
@@ -121,45 +337,50 @@ volatile LONG VmxRootLoggingLockForNonImmBuffers;
 
 /*
 
-A core buffer is like this , it's divided into MaximumPacketsCapacity chucks,
-each chunk has PacketChunkSize + sizeof(BUFFER_HEADER) size
+Each core has a regular and a priority ring for each mode (vmx-root and vmx non-root),
+the LogBufferSize (and LogBufferSizePriority) bytes are divided between the cores.
+Records have variable lengths and are packed contiguously, each record is aligned to
+RING_RECORD_ALIGNMENT and its body is followed by a null character. If a record doesn't
+fit at the end of the ring, a wrap marker is written and the record goes to the start.
+The time stamp of records is the raw TSC (with the core ID in the header), the debugger
+converts it to the wall-clock time when it shows the messages. The reader drains priority
+rings before regular rings, and the rings of cores are drained by deficit round-robin, so a
+core that floods its ring can't starve the messages of other cores. The data of
+the rings and their indexes can also be mapped (read-only, except consumer indexes) into
+the debugger process, then only a doorbell (IRP_BASED_DOORBELL) crosses the kernel boundary.
+If a ring is full, the overflow policy of the ring decides what is lost, the lost records
+are counted per core and an OPERATION_LOG_RECORDS_LOST marker is put into the ring before
+the next record that is written. Non-immediate messages are accumulated in a per-core
+buffer and are written as one OPERATION_LOG_NON_IMMEDIATE_MESSAGE record once the batch
+reaches the byte threshold or its oldest message reaches the latency threshold (checked
+by new messages, the VM-exit tail in vmx-root, and a timer DPC in vmx non-root)
 
              _________________________
-            |      BUFFER_HEADER      |
+            |   RING_RECORD_HEADER    |
             |_________________________|
-            |                         |
-            |           BODY          |
-            |         (Buffer)        |
-            | size = PacketChunkSize  |
-            |                         |
+            |     BODY (20 bytes)     |
             |_________________________|
-            |      BUFFER_HEADER      |
+            |   RING_RECORD_HEADER    |
             |_________________________|
             |                         |
-            |           BODY          |
-            |         (Buffer)        |
-            | size = PacketChunkSize  |
+            |     BODY (300 bytes)    |
             |                         |
             |_________________________|
-            |                         |
-            |                         |
-            |                         |
-            |                         |
+            |   RING_RECORD_HEADER    |
+            |_________________________|
+            |     BODY (64 bytes)     |
+            |_________________________|
             |                         |
             |           .             |
             |           .             |
             |           .             |
-            |                         |
-            |                         |
-            |                         |
             |_________________________|
-            |      BUFFER_HEADER      |
+            |   RING_RECORD_HEADER    |
+            |  (RING_RECORD_WRAP_     |
+            |   MARKER as the length) |
             |_________________________|
             |                         |
-            |           BODY          |
-            |         (Buffer)        |
-            | size = PacketChunkSize  |
-            |                         |
+            |         (unused)        |
             |_________________________|
 
 */
@@ -187,5 +408,22 @@ MESSAGE_TRACING_CALLBACKS g_MsgTracingCallbacks;
 BOOLEAN
 LogReadBuffer(BOOLEAN IsVmxRoot, PVOID BufferToSaveMessage, UINT32 * ReturnedLength);
 
+BOOLEAN
+LogReadBufferBatch(PVOID BufferToSaveMessages, UINT32 BufferLength, UINT32 * ReturnedLength);
+
+BOOLEAN
+LogSendBuffer(UINT32 OperationCode, PVOID Buffer, UINT32 BufferLength, BOOLEAN Priority, UINT32 Flags);
+
+BOOLEAN
+LogSendMessageToQueue(UINT32  OperationCode,
+                      BOOLEAN IsImmediateMessage,
+                      CHAR *  LogMessage,
+                      UINT32  BufferLen,
+                      BOOLEAN Priority,
+                      UINT32  Flags);
+
 VOID
 LogNotifyUsermodeCallback(PKDPC Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2);
+
+VOID
+LogCoalescingTimerCallback(PKDPC Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2);
@@ -43,6 +43,7 @@
 #include "SDK/modules/HyperLog.h"
 #include "SDK/imports/kernel/HyperDbgHyperLogImports.h"
 #include "components/spinlock/header/Spinlock.h"
+#include "components/ring/header/Ring.h"
 #include "Logging.h"
 
 //
@@ -84,6 +84,41 @@
  */
 #define TEST_CASE_PARAMETER_FOR_SCRIPT_SEMANTIC_TEST_CASES "test-script-semantic-test-cases"
 
+/**
+ * @brief Test case parameter for testing the compression of messages
+ */
+#define TEST_CASE_PARAMETER_FOR_COMPRESSION "test-compression"
+
+/**
+ * @brief Test case parameter for testing the framing of the remote packets
+ */
+#define TEST_CASE_PARAMETER_FOR_FRAMING "test-framing"
+
+/**
+ * @brief Test case parameter for testing the pipelined requests
+ */
+#define TEST_CASE_PARAMETER_FOR_PIPELINE "test-pipeline"
+
+/**
+ * @brief Test case parameter for testing the search of memory blocks
+ */
+#define TEST_CASE_PARAMETER_FOR_SEARCH "test-search"
+
+/**
+ * @brief Test case parameter for testing the transports of the kernel debugger
+ */
+#define TEST_CASE_PARAMETER_FOR_TRANSPORT "test-transport"
+
+/**
+ * @brief Test case parameter for testing the rings of the logs
+ */
+#define TEST_CASE_PARAMETER_FOR_RING "test-ring"
+
+/**
+ * @brief Test case parameter for testing the (local) evaluation of scripts
+ */
+#define TEST_CASE_PARAMETER_FOR_SCRIPT_ENGINE "test-script-engine"
+
 /**
  * @brief Test cases file name
  */
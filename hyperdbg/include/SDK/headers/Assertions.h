@@ -29,3 +29,12 @@ static_assert(sizeof(DEBUGGEE_UD_PAUSED_PACKET) < PacketChunkSize,
  */
 static_assert(sizeof(DEBUGGER_UPDATE_SYMBOL_TABLE) < PacketChunkSize,
               "err (static_assert), size of PacketChunkSize should be bigger than DEBUGGER_UPDATE_SYMBOL_TABLE (MODULE_SYMBOL_DETAIL)");
+
+/**
+ * @brief check so the batches of symbol details fit in a serial packet and
+ * their strings could be addressed by 16-bit offsets
+ *
+ */
+static_assert(MAXIMUM_SYMBOL_DETAIL_BATCH_SIZE < MaxSerialPacketSize - sizeof(DEBUGGER_REMOTE_PACKET) &&
+                  MAXIMUM_SYMBOL_DETAIL_BATCH_SIZE <= 0xffff,
+              "err (static_assert), size of MAXIMUM_SYMBOL_DETAIL_BATCH_SIZE should be smaller than a serial packet and 64 KB");
@@ -11,42 +11,53 @@
  */
 #pragma once
 
-#pragma warning(disable : 4201) // Suppress nameless struct/union warning
+#ifdef _MSC_VER
+#    pragma warning(disable : 4201) // Suppress nameless struct/union warning
+#endif
 
 //////////////////////////////////////////////////
 //               Basic Datatypes                //
 //////////////////////////////////////////////////
 
 typedef unsigned long long QWORD;
-typedef unsigned __int64   UINT64, *PUINT64;
-typedef unsigned long      DWORD;
+typedef unsigned long long UINT64, *PUINT64;
 typedef int                BOOL;
 typedef unsigned char      BYTE;
 typedef unsigned short     WORD;
 typedef int                INT;
 typedef unsigned int       UINT;
 typedef unsigned int *     PUINT;
-typedef unsigned __int64   ULONG64, *PULONG64;
-typedef unsigned __int64   DWORD64, *PDWORD64;
+typedef unsigned long long ULONG64, *PULONG64;
+typedef unsigned long long DWORD64, *PDWORD64;
 typedef char               CHAR;
 typedef wchar_t            WCHAR;
 #define VOID void
 
 typedef unsigned char  UCHAR;
 typedef unsigned short USHORT;
-typedef unsigned long  ULONG;
+
+//
+// Both are 32 bits on Windows, 'long' is 64 bits on the other (LP64) platforms
+//
+#ifdef _WIN32
+typedef unsigned long DWORD;
+typedef unsigned long ULONG;
+#else
+typedef unsigned int DWORD;
+typedef unsigned int ULONG;
+#endif
 
 typedef UCHAR     BOOLEAN;  // winnt
 typedef BOOLEAN * PBOOLEAN; // winnt
 
-typedef signed char      INT8, *PINT8;
-typedef signed short     INT16, *PINT16;
-typedef signed int       INT32, *PINT32;
-typedef signed __int64   INT64, *PINT64;
-typedef unsigned char    UINT8, *PUINT8;
-typedef unsigned short   UINT16, *PUINT16;
-typedef unsigned int     UINT32, *PUINT32;
-typedef unsigned __int64 UINT64, *PUINT64;
+typedef signed char        INT8, *PINT8;
+typedef signed short       INT16, *PINT16;
+typedef signed int         INT32, *PINT32;
+typedef signed long long   INT64, *PINT64;
+typedef unsigned char      UINT8, *PUINT8;
+typedef unsigned short     UINT16, *PUINT16;
+typedef unsigned int       UINT32, *PUINT32;
+typedef unsigned long long UINT64, *PUINT64;
 
 #define NULL_ZERO   0
 #define NULL64_ZERO 0ull
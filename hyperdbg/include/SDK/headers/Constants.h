@@ -186,6 +186,14 @@ const unsigned char BuildSignature[] = {
  */
 #define UsermodeBufferSize sizeof(UINT32) + PacketChunkSize + 1
 
+/**
+ * @brief size of user-mode buffer for reading batched messages
+ * @details The buffer should be able to hold at least one message
+ * with the maximum size
+ *
+ */
+#define UsermodeBatchedBufferSize (16 * PacketChunkSize)
+
 /**
  * @brief size of buffer for serial
  * @details the maximum packet size for sending over serial
@@ -195,17 +203,21 @@ const unsigned char BuildSignature[] = {
 
 /**
  * @brief Final storage size of message tracing
+ * @details Messages have variable lengths and are packed in the buffer, so
+ * the buffer holds MaximumPacketsCapacity messages in the worst case
  *
  */
 #define LogBufferSize \
-    MaximumPacketsCapacity *(PacketChunkSize + sizeof(BUFFER_HEADER))
+    MaximumPacketsCapacity *(PacketChunkSize + 0x10)
 
 /**
  * @brief Final storage size of message tracing
+ * @details Messages have variable lengths and are packed in the buffer, so
+ * the buffer holds MaximumPacketsCapacityPriority messages in the worst case
  *
  */
 #define LogBufferSizePriority \
-    MaximumPacketsCapacityPriority *(PacketChunkSize + sizeof(BUFFER_HEADER))
+    MaximumPacketsCapacityPriority *(PacketChunkSize + 0x10)
 
 /**
  * @brief limitation of Windows DbgPrint message size
@@ -311,6 +323,27 @@ const unsigned char BuildSignature[] = {
  */
 #define BIG_INSTANT_EVENT_REQUESTED_SAFE_BUFFER MaxSerialPacketSize
 
+/**
+ * @brief Maximum number of events of a single type that can be published
+ * in VMX-root mode (pre-allocated dispatch tables)
+ *
+ */
+#define MAXIMUM_EVENTS_IN_INSTANT_EVENT_DISPATCH_TABLE 500
+
+/**
+ * @brief Pre-allocated size for a dispatch table of events
+ *
+ */
+#define INSTANT_EVENT_DISPATCH_TABLE_BUFFER EVENT_PUBLICATION_DISPATCH_TABLE_SIZE(MAXIMUM_EVENTS_IN_INSTANT_EVENT_DISPATCH_TABLE)
+
+/**
+ * @brief Number of pre-allocated dispatch tables for each regular instant event
+ * @details each modification to the list of events (in VMX-root mode) consumes
+ * one table, both registering and removing an event modifies the list
+ *
+ */
+#define INSTANT_EVENT_DISPATCH_TABLES_PER_EVENT 2
+
 //////////////////////////////////////////////////
 //               Remote Connection              //
 //////////////////////////////////////////////////
@@ -387,6 +420,21 @@ const unsigned char BuildSignature[] = {
 #define OPERATION_NOTIFICATION_FROM_USER_DEBUGGER_PAUSE \
     15U | OPERATION_MANDATORY_DEBUGGEE_BIT
 
+/**
+ * @brief The marker that hyperlog puts in the stream of messages when
+ * messages are lost (DEBUGGER_LOG_RECORDS_LOST)
+ */
+#define OPERATION_LOG_RECORDS_LOST 16U
+
+/**
+ * @brief Flags of the records of log messages
+ * @details The time stamp of records is the raw TSC of the core that
+ * wrote the record and it's converted to the wall-clock time by the debugger
+ *
+ */
+#define LOG_RECORD_FLAG_SHOW_TIME 0x1 // Show the time and the core of the message
+#define LOG_RECORD_FLAG_VMX_ROOT  0x2 // The message is written in vmx-root
+
 //////////////////////////////////////////////////
 //       Breakpoints & Debug Breakpoints        //
 //////////////////////////////////////////////////
@@ -448,6 +496,35 @@ const unsigned char BuildSignature[] = {
 #define TCP_END_OF_BUFFER_CHAR_3 0x33
 #define TCP_END_OF_BUFFER_CHAR_4 0x44
 
+//////////////////////////////////////////////////
+//         Remote Debugging Capabilities        //
+//////////////////////////////////////////////////
+
+/**
+ * @brief capabilities that the debugger sends after its build
+ * signature in the response of the ping packet
+ */
+#define DEBUGGER_REMOTE_CAPABILITY_COMPRESSED_LOGGING 0x1
+#define DEBUGGER_REMOTE_CAPABILITY_FRAMED_PACKETS     0x2
+#define DEBUGGER_REMOTE_CAPABILITY_BREAK_CONTEXT      0x4
+
+/**
+ * @brief default and maximum number of the bytes at RIP and the qwords
+ * at RSP that the debuggee sends along with the pause packet (the break
+ * context), the default values are the default lengths of 'u' and 'dq'
+ */
+#define DEBUGGEE_BREAK_CONTEXT_DEFAULT_CODE_BYTES   0x40
+#define DEBUGGEE_BREAK_CONTEXT_DEFAULT_STACK_QWORDS 0x10
+#define DEBUGGEE_BREAK_CONTEXT_MAXIMUM_CODE_BYTES   0x400
+#define DEBUGGEE_BREAK_CONTEXT_MAXIMUM_STACK_QWORDS 0x200
+
+/**
+ * @brief the number of compressed messages after which the debuggee
+ * resets the compression stream (the debugger can only decompress the
+ * messages again after a reset if a packet is lost)
+ */
+#define DEBUGGEE_COMPRESSION_RESET_INTERVAL 64
+
 //////////////////////////////////////////////////
 //                 Name of OS                    //
 //////////////////////////////////////////////////
@@ -490,6 +567,13 @@ const unsigned char BuildSignature[] = {
  */
 #define MAXIMUM_GUID_AND_AGE_SIZE 60
 
+/**
+ * @brief maximum size of each batch of symbol details that
+ * is sent from the debuggee to the debugger
+ * @details The strings are addressed by 16-bit offsets
+ */
+#define MAXIMUM_SYMBOL_DETAIL_BATCH_SIZE (12 * NORMAL_PAGE_SIZE)
+
 //////////////////////////////////////////////////
 //            Debuggee Communication            //
 //////////////////////////////////////////////////
@@ -513,6 +597,20 @@ const unsigned char BuildSignature[] = {
  */
 #define MaximumSearchResults 0x1000
 
+/**
+ * @brief maximum patterns that are searched at once by !s* s*
+ * command
+ *
+ */
+#define MaximumSearchPatterns 8
+
+/**
+ * @brief maximum size of all of the patterns of !s* s* command
+ * (in bytes)
+ *
+ */
+#define MaximumSearchPatternsSize 0x400
+
 //////////////////////////////////////////////////
 //                 Script Engine                //
 //////////////////////////////////////////////////
@@ -579,6 +677,12 @@ const unsigned char BuildSignature[] = {
 
 #define MAX_FUNCTION_NAME_LENGTH 32
 
+/**
+ * @brief Maximum number of predicates that the condition of a script can be
+ * lowered to (by the script engine)
+ */
+#define MAX_SCRIPT_CONDITION_PREDICATES 4
+
 //////////////////////////////////////////////////
 //                  Debugger                    //
 //////////////////////////////////////////////////
@@ -589,6 +693,13 @@ const unsigned char BuildSignature[] = {
  */
 #define DEBUGGER_MODIFY_EVENTS_APPLY_TO_ALL_TAG 0xffffffffffffffff
 
+/**
+ * @brief Maximum number of event groups (each group is a bit in the
+ * groups bitmap of events)
+ *
+ */
+#define DEBUGGER_MAXIMUM_EVENT_GROUPS 64
+
 /**
  * @brief Maximum length for a function (to be used in showing distance
  * from symbol functions in the 'u' command)
@@ -59,6 +59,11 @@ typedef enum _POOL_ALLOCATION_INTENTION
     INSTANT_REGULAR_SAFE_BUFFER_FOR_EVENTS,
     INSTANT_BIG_SAFE_BUFFER_FOR_EVENTS,
 
+    //
+    // Use for publishing events to the VMX-root readers
+    //
+    INSTANT_EVENT_DISPATCH_TABLE,
+
 } POOL_ALLOCATION_INTENTION;
 
 //////////////////////////////////////////////////
@@ -218,6 +223,29 @@ typedef struct _DEBUGGEE_KD_PAUSED_PACKET
 
 } DEBUGGEE_KD_PAUSED_PACKET, *PDEBUGGEE_KD_PAUSED_PACKET;
 
+/* ==============================================================================================
+ */
+
+/**
+ * @brief The context of the halted core that comes after the pausing
+ * packet in kHyperDbg (if the debugger accepted it at the time of connection)
+ * @details The bytes at RIP (CodeLength) and the bytes at RSP (StackLength)
+ * come after this structure, the lengths are shorter than the requested
+ * lengths if the next page is not available
+ *
+ */
+typedef struct _DEBUGGEE_KD_BREAK_CONTEXT
+{
+    GUEST_REGS            Regs;
+    GUEST_EXTRA_REGISTERS ExtraRegs;
+    UINT64                CodeAddress;
+    UINT64                StackAddress;
+    UINT32                CodeLength;
+    UINT32                StackLength;
+    UINT32                CodeAddressMode; // DEBUGGER_READ_MEMORY_ADDRESS_MODE of the code
+
+} DEBUGGEE_KD_BREAK_CONTEXT, *PDEBUGGEE_KD_BREAK_CONTEXT;
+
 /* ==============================================================================================
  */
 
@@ -253,9 +281,24 @@ typedef struct _DEBUGGEE_UD_PAUSED_PACKET
 typedef enum _NOTIFY_TYPE
 {
     IRP_BASED,
-    EVENT_BASED
+    EVENT_BASED,
+    IRP_BASED_BATCHED,
+    IRP_BASED_DOORBELL // Only notifies about new messages (used when the log rings are mapped into user-mode)
 } NOTIFY_TYPE;
 
+/**
+ * @brief What hyperlog does when the ring of a core is full
+ *
+ */
+typedef enum _LOG_OVERFLOW_POLICY
+{
+    LOG_OVERFLOW_POLICY_DROP_NEWEST,      // The new message is dropped (default)
+    LOG_OVERFLOW_POLICY_OVERWRITE_OLDEST, // The oldest unread messages are discarded
+    LOG_OVERFLOW_POLICY_BLOCK,            // The caller waits for the reader (only in vmx non-root)
+    LOG_OVERFLOW_POLICY_MAXIMUM
+
+} LOG_OVERFLOW_POLICY;
+
 //////////////////////////////////////////////////
 //                  Structures                  //
 //////////////////////////////////////////////////
@@ -271,6 +314,59 @@ typedef struct _DEBUGGEE_MESSAGE_PACKET
 
 } DEBUGGEE_MESSAGE_PACKET, *PDEBUGGEE_MESSAGE_PACKET;
 
+/**
+ * @brief The header of compressed message packets in HyperDbg
+ * @details The block (compressed or stored) comes after this header. If
+ * the stream offset is zero, then the stream is reset by the debuggee
+ *
+ */
+typedef struct _DEBUGGEE_COMPRESSED_MESSAGE_PACKET
+{
+    UINT64 StreamOffset;       // Offset of the block in the stream of messages
+    UINT32 OperationCode;      // Operation code of the message
+    UINT32 UncompressedLength; // Length of the message
+    UINT32 CompressedLength;   // Equal to UncompressedLength if the block is stored without compression
+
+} DEBUGGEE_COMPRESSED_MESSAGE_PACKET, *PDEBUGGEE_COMPRESSED_MESSAGE_PACKET;
+
+/**
+ * @brief The header of each message in the batched buffers (IRP_BASED_BATCHED)
+ * @details The body of the message (followed by a null character) comes right
+ * after this header and the next message starts at an aligned address
+ *
+ */
+typedef struct _DEBUGGER_BATCHED_MESSAGE_HEADER
+{
+    UINT64 TimeStamp; // Raw TSC of the core that wrote the message
+    UINT32 OperationCode;
+    UINT32 BufferLength;
+    UINT32 CoreId;
+    UINT32 Flags; // LOG_RECORD_FLAG_*
+
+} DEBUGGER_BATCHED_MESSAGE_HEADER, *PDEBUGGER_BATCHED_MESSAGE_HEADER;
+
+/**
+ * @brief Size of each message in the batched buffers
+ *
+ */
+#define DEBUGGER_BATCHED_MESSAGE_SIZE(BufferLength) \
+    ((sizeof(DEBUGGER_BATCHED_MESSAGE_HEADER) + (BufferLength) + 1 + 7) & ~7)
+
+/**
+ * @brief The body of the marker that shows messages of a ring are lost
+ * (OPERATION_LOG_RECORDS_LOST)
+ *
+ */
+typedef struct _DEBUGGER_LOG_RECORDS_LOST
+{
+    UINT32  CoreId;
+    BOOLEAN IsVmxRoot;
+    BOOLEAN Priority;
+    UINT64  LostRecords; // Number of lost messages since the previous marker
+    UINT64  LostBytes;   // Length of lost messages since the previous marker
+
+} DEBUGGER_LOG_RECORDS_LOST, *PDEBUGGER_LOG_RECORDS_LOST;
+
 /**
  * @brief Used to register event for transferring buffer between user-to-kernel
  *
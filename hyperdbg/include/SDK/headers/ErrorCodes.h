@@ -551,6 +551,45 @@
  */
 #define DEBUGGER_ERROR_DEBUGGER_ALREADY_UNHIDE 0xc0000054
 
+/**
+ * @brief error, there is no pre-allocated buffer for publishing the
+ * dispatch table of the event (instant event mechanism)
+ *
+ */
+#define DEBUGGER_ERROR_INSTANT_EVENT_PREALLOCATED_BUFFER_NOT_FOUND_FOR_DISPATCH_TABLE 0xc0000055
+
+/**
+ * @brief error, the group id of the event group is invalid
+ *
+ */
+#define DEBUGGER_ERROR_MODIFY_EVENTS_INVALID_GROUP 0xc0000056
+
+/**
+ * @brief error, unable to map the log rings into the debugger process
+ * (or the rings are already mapped into another process)
+ *
+ */
+#define DEBUGGER_ERROR_UNABLE_TO_MAP_SHARED_LOG_RINGS 0xc0000057
+
+/**
+ * @brief error, the overflow policy of the log rings is invalid
+ *
+ */
+#define DEBUGGER_ERROR_INVALID_LOG_OVERFLOW_POLICY 0xc0000058
+
+/**
+ * @brief error, the coalescing thresholds of the log buffers are invalid
+ *
+ */
+#define DEBUGGER_ERROR_INVALID_LOG_COALESCING_THRESHOLDS 0xc0000059
+
+/**
+ * @brief error, the debuggee is not able to stream the dump (the
+ * packets are not framed or the buffers are not allocated)
+ *
+ */
+#define DEBUGGER_ERROR_DUMP_STREAMING_IS_NOT_AVAILABLE 0xc000005a
+
 //
 // WHEN YOU ADD ANYTHING TO THIS LIST OF ERRORS, THEN
 // MAKE SURE TO ADD AN ERROR MESSAGE TO ShowErrorMessage(UINT32 Error)
@@ -232,6 +232,10 @@ typedef enum _DEBUGGER_MODIFY_EVENTS_TYPE
     DEBUGGER_MODIFY_EVENTS_ENABLE,
     DEBUGGER_MODIFY_EVENTS_DISABLE,
     DEBUGGER_MODIFY_EVENTS_CLEAR,
+    DEBUGGER_MODIFY_EVENTS_ADD_TO_GROUP,
+    DEBUGGER_MODIFY_EVENTS_REMOVE_FROM_GROUP,
+    DEBUGGER_MODIFY_EVENTS_ENABLE_GROUP,
+    DEBUGGER_MODIFY_EVENTS_DISABLE_GROUP,
 } DEBUGGER_MODIFY_EVENTS_TYPE;
 
 /**
@@ -245,6 +249,7 @@ typedef struct _DEBUGGER_MODIFY_EVENTS
     DEBUGGER_MODIFY_EVENTS_TYPE
     TypeOfAction;      // Determines what's the action (enable | disable | clear)
     BOOLEAN IsEnabled; // Determines what's the action (enable | disable | clear)
+    UINT32  GroupId;   // Target group (only used for the group actions)
 
 } DEBUGGER_MODIFY_EVENTS, *PDEBUGGER_MODIFY_EVENTS;
 
@@ -366,6 +371,9 @@ typedef struct _DEBUGGER_GENERAL_EVENT_DETAIL
     BOOLEAN EnableShortCircuiting; // indicates whether the short-circuiting event
                                    // is enabled or not for this event
 
+    BOOLEAN IsRestoredAsDisabled; // the event remains disabled once its actions are
+                                  // registered (e.g., restored from a session as disabled)
+
     VMM_CALLBACK_EVENT_CALLING_STAGE_TYPE EventStage; // reveals the calling stage of the event
     // (whether it's a all- pre- or post- event)
 
@@ -396,6 +404,24 @@ typedef struct _DEBUGGER_GENERAL_EVENT_DETAIL
 
 } DEBUGGER_GENERAL_EVENT_DETAIL, *PDEBUGGER_GENERAL_EVENT_DETAIL;
 
+/**
+ * @brief A simple predicate (e.g., @rcx == X, @rdx & MASK, or $pid == N) that
+ * is lowered from the condition of a script by the script engine
+ * @details The operator is one of the comparison operators of the script
+ * engine (or FUNC_AND) and it's evaluated as 'Operand1 Operator Operand0'
+ * (the same as the script engine), operands are registers, pseudo-registers,
+ * or numbers (SYMBOL_*_TYPE)
+ */
+typedef struct _DEBUGGER_SCRIPT_CONDITION_PREDICATE
+{
+    UINT64 Operator;
+    UINT64 Operand0Type;
+    UINT64 Operand0Value;
+    UINT64 Operand1Type;
+    UINT64 Operand1Value;
+
+} DEBUGGER_SCRIPT_CONDITION_PREDICATE, *PDEBUGGER_SCRIPT_CONDITION_PREDICATE;
+
 /**
  * @brief Each event can have multiple actions
  * @details THIS STRUCTURE IS ONLY USED IN USER MODE
@@ -413,6 +439,11 @@ typedef struct _DEBUGGER_GENERAL_ACTION
     UINT32 ScriptBufferSize;
     UINT32 ScriptBufferPointer;
 
+    UINT32 ScriptStackFootprint; // Stack slots used by the script (zero if unknown)
+
+    UINT32                              ScriptNumberOfConditionPredicates;                          // Zero if the condition is not lowered
+    DEBUGGER_SCRIPT_CONDITION_PREDICATE ScriptConditionPredicates[MAX_SCRIPT_CONDITION_PREDICATES]; // Predicates (all should be met) lowered from the script
+
 } DEBUGGER_GENERAL_ACTION, *PDEBUGGER_GENERAL_ACTION;
 
 /**
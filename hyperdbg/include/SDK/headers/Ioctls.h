@@ -316,3 +316,17 @@
  */
 #define IOCTL_QUERY_IDT_ENTRY \
     CTL_CODE(FILE_DEVICE_UNKNOWN, 0x824, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+/**
+ * @brief ioctl, to map (or unmap) the log rings into the debugger process
+ *
+ */
+#define IOCTL_MAP_SHARED_LOG_RINGS \
+    CTL_CODE(FILE_DEVICE_UNKNOWN, 0x825, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+/**
+ * @brief ioctl, to query the drop counters of the log rings (and set their overflow policy)
+ *
+ */
+#define IOCTL_QUERY_LOG_BUFFER_STATISTICS \
+    CTL_CODE(FILE_DEVICE_UNKNOWN, 0x826, METHOD_BUFFERED, FILE_ANY_ACCESS)
@@ -274,6 +274,7 @@ typedef struct _DEBUGGER_READ_MEMORY
     DEBUGGER_READ_READING_TYPE        ReadingType;
     UINT32                            ReturnLength; // not used in local debugging
     UINT32                            KernelStatus; // not used in local debugging
+    UINT32                            RequestId;    // Debuggee returns it unchanged (used for pipelined requests)
 
     //
     // Here is the target buffer (actual memory)
@@ -281,6 +282,75 @@ typedef struct _DEBUGGER_READ_MEMORY
 
 } DEBUGGER_READ_MEMORY, *PDEBUGGER_READ_MEMORY;
 
+/* ==============================================================================================
+ */
+
+#define SIZEOF_DEBUGGEE_DUMP_MEMORY_PACKET \
+    sizeof(DEBUGGEE_DUMP_MEMORY_PACKET)
+
+/**
+ * @brief request for streaming a range of memory of the debuggee ('.dump' command)
+ * @details The debuggee sends the range as a sequence of chunks and then sends
+ * this structure back as the result
+ *
+ */
+typedef struct _DEBUGGEE_DUMP_MEMORY_PACKET
+{
+    UINT64                    Address;
+    UINT32                    Length;
+    DEBUGGER_READ_MEMORY_TYPE MemoryType;
+    BOOLEAN                   Compress; // Debugger sets whether the pages could be compressed or not
+    UINT32                    KernelStatus;
+    UINT32                    NumberOfChunks;    // Debuggee sets the number of the sent chunks
+    UINT32                    TransferredLength; // Debuggee sets the length of the records of all of the chunks
+
+} DEBUGGEE_DUMP_MEMORY_PACKET, *PDEBUGGEE_DUMP_MEMORY_PACKET;
+
+/**
+ * @brief types of the records of the dump chunks
+ *
+ */
+typedef enum _DEBUGGEE_DUMP_MEMORY_RECORD_TYPE
+{
+    DEBUGGEE_DUMP_MEMORY_RECORD_RAW = 1, // The bytes are stored after the record
+    DEBUGGEE_DUMP_MEMORY_RECORD_COMPRESSED,
+    DEBUGGEE_DUMP_MEMORY_RECORD_FILL,   // The whole range is filled with one byte (e.g., zero pages)
+    DEBUGGEE_DUMP_MEMORY_RECORD_INVALID // The range couldn't be read
+
+} DEBUGGEE_DUMP_MEMORY_RECORD_TYPE;
+
+/**
+ * @brief The header of each chunk of a streamed dump
+ * @details The records come after this header, each record covers the range
+ * right after the previous record. The compression stream is reset at the start
+ * of each chunk, so the chunks could be decoded independently
+ *
+ */
+typedef struct _DEBUGGEE_DUMP_MEMORY_CHUNK_PACKET
+{
+    UINT32 ChunkIndex;
+    UINT32 Offset; // Offset of the first record from the start of the range
+    UINT32 Length; // Length of the range that is covered by the records
+    UINT32 NumberOfRecords;
+
+} DEBUGGEE_DUMP_MEMORY_CHUNK_PACKET, *PDEBUGGEE_DUMP_MEMORY_CHUNK_PACKET;
+
+/**
+ * @brief The header of each record of a dump chunk
+ * @details Raw and compressed records cover one page, fill and invalid records
+ * might cover several pages
+ *
+ */
+typedef struct _DEBUGGEE_DUMP_MEMORY_RECORD
+{
+    UINT32 Length;       // Length of the range that is covered by the record
+    UINT32 StoredLength; // Length of the bytes after the record (raw or compressed)
+    UINT8  Type;         // DEBUGGEE_DUMP_MEMORY_RECORD_TYPE
+    UINT8  Fill;         // The byte of the fill records
+    UINT16 Reserved;
+
+} DEBUGGEE_DUMP_MEMORY_RECORD, *PDEBUGGEE_DUMP_MEMORY_RECORD;
+
 /* ==============================================================================================
  */
 
@@ -299,6 +369,91 @@ typedef struct _DEBUGGER_FLUSH_LOGGING_BUFFERS
 
 } DEBUGGER_FLUSH_LOGGING_BUFFERS, *PDEBUGGER_FLUSH_LOGGING_BUFFERS;
 
+/* ==============================================================================================
+ */
+
+#define SIZEOF_DEBUGGER_SHARED_LOG_RINGS \
+    sizeof(DEBUGGER_SHARED_LOG_RINGS)
+
+/**
+ * @brief request for mapping (or unmapping) the log rings into the debugger process
+ * @details The rings are ordered by mode (vmx non-root, vmx-root), then by lane
+ * (regular, priority), and then by core. The producer indexes and the data of the
+ * rings are mapped as read-only, only the consumer indexes are writable
+ *
+ */
+typedef struct _DEBUGGER_SHARED_LOG_RINGS
+{
+    BOOLEAN IsMap; // TRUE for mapping and FALSE for unmapping
+    UINT32  KernelStatus;
+    UINT32  NumberOfCores;
+    UINT32  MaximumRecordLength;
+    UINT32  RingSize;                // Size of each regular ring
+    UINT32  RingSizePriority;        // Size of each priority ring
+    UINT64  ProducerIndexesAddress;  // Array of RING_INDEX (read-only)
+    UINT64  ConsumerIndexesAddress;  // Array of RING_INDEX (writable)
+    UINT64  RingsAddress[2];         // Regular rings of all cores (vmx non-root = 0, vmx-root = 1)
+    UINT64  RingsPriorityAddress[2]; // Priority rings of all cores (vmx non-root = 0, vmx-root = 1)
+
+} DEBUGGER_SHARED_LOG_RINGS, *PDEBUGGER_SHARED_LOG_RINGS;
+
+/* ==============================================================================================
+ */
+
+#define SIZEOF_DEBUGGER_LOG_BUFFER_STATISTICS \
+    sizeof(DEBUGGER_LOG_BUFFER_STATISTICS)
+
+/**
+ * @brief The drop counters and the occupancy of a ring
+ *
+ */
+typedef struct _DEBUGGER_LOG_RING_STATISTICS
+{
+    UINT64 DroppedRecords;
+    UINT64 DroppedBytes;
+    UINT32 UsedBytes; // Bytes that are used by unread records
+    UINT32 Size;      // Size of the ring
+
+} DEBUGGER_LOG_RING_STATISTICS, *PDEBUGGER_LOG_RING_STATISTICS;
+
+/**
+ * @brief The counters of coalescing non-immediate messages (sum of all cores)
+ *
+ */
+typedef struct _DEBUGGER_LOG_COALESCING_STATISTICS
+{
+    UINT64 Batches;          // Number of sent batches
+    UINT64 Messages;         // Number of messages in the sent batches
+    UINT64 Bytes;            // Length of the sent batches
+    UINT64 FlushesBySize;    // Batches that are sent because of the byte threshold
+    UINT64 FlushesByLatency; // Batches that are sent by a new message or the VM-exit tail because of the latency threshold
+    UINT64 FlushesByTimer;   // Batches that are sent by the timer because of the latency threshold
+
+} DEBUGGER_LOG_COALESCING_STATISTICS, *PDEBUGGER_LOG_COALESCING_STATISTICS;
+
+/**
+ * @brief request for querying the drop counters of the log rings (and
+ * setting their overflow policy or the coalescing thresholds)
+ * @details If the output buffer is large enough, this structure is followed
+ * by (NumberOfCores * 4) DEBUGGER_LOG_RING_STATISTICS, ordered by mode (vmx
+ * non-root, vmx-root), then by lane (regular, priority), and then by core
+ *
+ */
+typedef struct _DEBUGGER_LOG_BUFFER_STATISTICS
+{
+    BOOLEAN                            SetPolicy;               // Whether the policy should be changed or not
+    BOOLEAN                            Priority;                // The lane that its policy is changed
+    LOG_OVERFLOW_POLICY                Policy;                  // The new policy
+    LOG_OVERFLOW_POLICY                Policies[2];             // Current policies of the regular and priority rings
+    BOOLEAN                            SetCoalescing;           // Whether the coalescing thresholds should be changed or not
+    UINT32                             CoalescingByteThreshold; // The new (or current) byte threshold of batches
+    UINT32                             CoalescingLatency;       // The new (or current) latency threshold (in microseconds, zero means no limit)
+    DEBUGGER_LOG_COALESCING_STATISTICS Coalescing;              // Counters of the sent batches
+    UINT32                             NumberOfCores;
+    UINT32                             KernelStatus;
+
+} DEBUGGER_LOG_BUFFER_STATISTICS, *PDEBUGGER_LOG_BUFFER_STATISTICS;
+
 /* ==============================================================================================
  */
 
@@ -496,6 +651,14 @@ typedef struct _DEBUGGER_EDIT_MEMORY
 
 #define SIZEOF_DEBUGGER_SEARCH_MEMORY sizeof(DEBUGGER_SEARCH_MEMORY)
 
+/**
+ * @brief size of the results of searching the memory, up to
+ * MaximumSearchResults addresses followed by the number of all of
+ * the matched addresses
+ *
+ */
+#define SIZEOF_DEBUGGER_SEARCH_MEMORY_RESULTS ((MaximumSearchResults + 1) * sizeof(UINT64))
+
 /**
  * @brief different types of address for searching on memory
  *
@@ -533,6 +696,8 @@ typedef struct _DEBUGGER_SEARCH_MEMORY
     DEBUGGER_SEARCH_MEMORY_BYTE_SIZE ByteSize;   // Modification size
     UINT32                           CountOf64Chunks;
     UINT32                           FinalStructureSize;
+    UINT32                           CountOfPatterns;                       // Zero means all of the chunks are one pattern
+    UINT32                           PatternLengths[MaximumSearchPatterns]; // Count of chunks of each pattern
 
 } DEBUGGER_SEARCH_MEMORY, *PDEBUGGER_SEARCH_MEMORY;
 
@@ -580,11 +745,16 @@ typedef struct _DEBUGGER_HIDE_AND_TRANSPARENT_DEBUGGER_MODE
  */
 typedef struct _DEBUGGER_PREPARE_DEBUGGEE
 {
-    UINT32 PortAddress;
-    UINT32 Baudrate;
-    UINT64 KernelBaseAddress;
-    UINT32 Result; // Result from the kernel
-    CHAR   OsName[MAXIMUM_CHARACTER_FOR_OS_NAME];
+    UINT32  PortAddress;
+    UINT32  Baudrate;
+    UINT64  KernelBaseAddress;
+    UINT32  Result; // Result from the kernel
+    CHAR    OsName[MAXIMUM_CHARACTER_FOR_OS_NAME];
+    BOOLEAN CompressLogs;     // Whether the debugger accepts compressed messages
+    BOOLEAN UseFramedPackets; // Whether the packets are framed after the "Start" packet
+    BOOLEAN SendBreakContext; // Whether the context of the core is sent along with the pause packet
+    UINT32  BreakContextCodeBytes;
+    UINT32  BreakContextStackQwords;
 
 } DEBUGGER_PREPARE_DEBUGGEE, *PDEBUGGER_PREPARE_DEBUGGEE;
 
@@ -828,6 +998,11 @@ typedef struct _DEBUGGER_EVENT_ACTION_RUN_SCRIPT_CONFIGURATION
     UINT32 ScriptPointer;
     UINT32 OptionalRequestedBufferSize;
 
+    UINT32 StackFootprint; // Stack slots used by the script (zero if unknown)
+
+    UINT32                               NumberOfConditionPredicates; // Zero if the condition is not lowered
+    PDEBUGGER_SCRIPT_CONDITION_PREDICATE ConditionPredicates;         // Predicates (all should be met) lowered from the script
+
 } DEBUGGER_EVENT_ACTION_RUN_SCRIPT_CONFIGURATION,
     *PDEBUGGER_EVENT_ACTION_RUN_SCRIPT_CONFIGURATION;
 
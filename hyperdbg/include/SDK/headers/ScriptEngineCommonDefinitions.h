@@ -24,6 +24,7 @@ typedef struct SYMBOL_BUFFER {
     unsigned int Pointer;
     unsigned int Size;
     char* Message;
+    unsigned int StackFootprint;
 } SYMBOL_BUFFER, * PSYMBOL_BUFFER;
 
 typedef struct SYMBOL_MAP
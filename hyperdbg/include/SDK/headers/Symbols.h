@@ -77,6 +77,47 @@ typedef struct _DEBUGGER_UPDATE_SYMBOL_TABLE
 
 } DEBUGGER_UPDATE_SYMBOL_TABLE, *PDEBUGGER_UPDATE_SYMBOL_TABLE;
 
+/**
+ * @brief details of one module in a batch of symbol details
+ * @details The strings are offsets in the strings of the batch, the paths
+ * are split into the directory and the file name, so the shared directories
+ * are sent once in each batch (offset zero is an empty string)
+ *
+ */
+typedef struct _MODULE_SYMBOL_DETAIL_BATCH_ENTRY
+{
+    UINT64  BaseAddress;
+    UINT16  FilePathDirectoryOffset;
+    UINT16  FilePathNameOffset;
+    UINT16  ModuleSymbolPathDirectoryOffset;
+    UINT16  ModuleSymbolPathNameOffset;
+    UINT16  ModuleSymbolGuidAndAgeOffset;
+    BOOLEAN IsSymbolDetailsFound;
+    BOOLEAN IsLocalSymbolPath;
+    BOOLEAN IsSymbolPDBAvaliable;
+    BOOLEAN IsUserMode;
+    BOOLEAN Is32Bit;
+
+} MODULE_SYMBOL_DETAIL_BATCH_ENTRY, *PMODULE_SYMBOL_DETAIL_BATCH_ENTRY;
+
+/**
+ * @brief request to add a batch of symbol details to the symbol table
+ *
+ */
+typedef struct _DEBUGGER_UPDATE_SYMBOL_TABLE_BATCH
+{
+    UINT32 TotalSymbols;
+    UINT32 FirstSymbolIndex;
+    UINT32 NumberOfSymbols;
+    UINT32 StringsLength;
+
+    //
+    // Here is a list of MODULE_SYMBOL_DETAIL_BATCH_ENTRY (appended)
+    // and then the null-terminated strings (StringsLength bytes)
+    //
+
+} DEBUGGER_UPDATE_SYMBOL_TABLE_BATCH, *PDEBUGGER_UPDATE_SYMBOL_TABLE_BATCH;
+
 /*
 ==============================================================================================
  */
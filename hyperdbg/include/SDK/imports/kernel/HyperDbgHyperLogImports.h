@@ -54,6 +54,9 @@ LogCallbackSendBuffer(_In_ UINT32                          OperationCode,
 IMPORT_EXPORT_HYPERLOG BOOLEAN
 LogCallbackCheckIfBufferIsFull(BOOLEAN Priority);
 
+IMPORT_EXPORT_HYPERLOG BOOLEAN
+LogCallbackFlushExpiredMessages();
+
 IMPORT_EXPORT_HYPERLOG BOOLEAN
 LogCallbackSendMessageToQueue(UINT32 OperationCode, BOOLEAN IsImmediateMessage, CHAR * LogMessage, UINT32 BufferLen, BOOLEAN Priority);
 
@@ -62,3 +65,18 @@ LogRegisterEventBasedNotification(PVOID TargetIrp);
 
 IMPORT_EXPORT_HYPERLOG BOOLEAN
 LogRegisterIrpBasedNotification(PVOID TargetIrp, LONG * Status);
+
+IMPORT_EXPORT_HYPERLOG BOOLEAN
+LogMapRingsToUserMode(DEBUGGER_SHARED_LOG_RINGS * SharedRingsRequest, PVOID Owner);
+
+IMPORT_EXPORT_HYPERLOG BOOLEAN
+LogUnmapRingsFromUserMode(PVOID Owner);
+
+IMPORT_EXPORT_HYPERLOG BOOLEAN
+LogSetOverflowPolicy(BOOLEAN Priority, LOG_OVERFLOW_POLICY Policy);
+
+IMPORT_EXPORT_HYPERLOG UINT32
+LogQueryBufferStatistics(DEBUGGER_LOG_BUFFER_STATISTICS * Statistics, UINT32 BufferLength);
+
+IMPORT_EXPORT_HYPERLOG BOOLEAN
+LogSetCoalescingThresholds(UINT32 ByteThreshold, UINT32 Latency);
@@ -119,6 +119,9 @@ hyperdbg_u_connect_remote_debugger_using_com_port(const CHAR * port_name, DWORD
 IMPORT_EXPORT_LIBHYPERDBG BOOLEAN
 hyperdbg_u_connect_remote_debugger_using_named_pipe(const CHAR * named_pipe, BOOLEAN pause_after_connection);
 
+IMPORT_EXPORT_LIBHYPERDBG BOOLEAN
+hyperdbg_u_connect_remote_debugger_using_tcp(const CHAR * address, const CHAR * port, BOOLEAN pause_after_connection);
+
 IMPORT_EXPORT_LIBHYPERDBG BOOLEAN
 hyperdbg_u_connect_current_debugger_using_com_port(const CHAR * port_name, DWORD baudrate);
 
@@ -269,6 +272,16 @@ hyperdbg_u_assemble_get_length(const CHAR * assembly_code, UINT64 start_address,
 IMPORT_EXPORT_LIBHYPERDBG BOOLEAN
 hyperdbg_u_assemble(const CHAR * assembly_code, UINT64 start_address, PVOID buffer_to_store_assembled_data, UINT32 buffer_size);
 
+//
+// Script engine
+// Exported functionality of the (simulated) local evaluation of scripts
+//
+IMPORT_EXPORT_LIBHYPERDBG UINT64
+hyperdbg_u_eval_script_locally(const CHAR * script, GUEST_REGS * regs, BOOLEAN * has_error);
+
+IMPORT_EXPORT_LIBHYPERDBG BOOLEAN
+hyperdbg_u_eval_script_condition_predicates_locally(const CHAR * script, GUEST_REGS * regs, BOOLEAN * is_lowered, BOOLEAN * has_error);
+
 //
 // hwdbg functions
 // Exported functionality of the '!hw' and '!hw_*' commands
@@ -61,6 +61,9 @@ HardwareScriptInterpreterFreeHwdbgShortSymbolBuffer(HWDBG_SHORT_SYMBOL * NewShor
 IMPORT_EXPORT_HYPERDBG_SCRIPT_ENGINE PVOID
 ScriptEngineParse(char * str);
 
+IMPORT_EXPORT_HYPERDBG_SCRIPT_ENGINE UINT32
+ScriptEngineLowerConditionPredicates(PVOID SymbolBuffer, PDEBUGGER_SCRIPT_CONDITION_PREDICATE Predicates);
+
 IMPORT_EXPORT_HYPERDBG_SCRIPT_ENGINE BOOLEAN
 ScriptEngineSetHwdbgInstanceInfo(HWDBG_INSTANCE_INFORMATION * InstancInfo);
 
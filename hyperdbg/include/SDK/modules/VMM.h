@@ -48,6 +48,13 @@ typedef BOOLEAN (*LOG_CALLBACK_SEND_BUFFER)(_In_ UINT32
  */
 typedef BOOLEAN (*LOG_CALLBACK_CHECK_IF_BUFFER_IS_FULL)(BOOLEAN Priority);
 
+/**
+ * @brief A function that sends the accumulated messages of the current core
+ * if they are waited more than the latency threshold
+ *
+ */
+typedef BOOLEAN (*LOG_CALLBACK_FLUSH_EXPIRED_MESSAGES)();
+
 /**
  * @brief A function that handles trigger events
  *
@@ -186,6 +193,7 @@ typedef struct _VMM_CALLBACKS
     LOG_CALLBACK_SEND_MESSAGE_TO_QUEUE             LogCallbackSendMessageToQueue;                  // Fixed
     LOG_CALLBACK_SEND_BUFFER                       LogCallbackSendBuffer;                          // Fixed
     LOG_CALLBACK_CHECK_IF_BUFFER_IS_FULL           LogCallbackCheckIfBufferIsFull;                 // Fixed
+    LOG_CALLBACK_FLUSH_EXPIRED_MESSAGES            LogCallbackFlushExpiredMessages;                // Fixed
 
     //
     // VMM callbacks
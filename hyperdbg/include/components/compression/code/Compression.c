@@ -0,0 +1,499 @@
+/**
+ * @file Compression.c
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Implementation of the streaming compressor (LZ77, LZ4-like sequences)
+ * @details Each compressed block is a list of sequences. A sequence starts with
+ * a token, the high nibble of the token is the number of literals and the low
+ * nibble is the length of the match minus COMPRESSION_MINIMUM_MATCH_LENGTH
+ * (15 means that additional length bytes follow). The literals come after the
+ * token and then the 16-bit offset of the match. The last sequence of a block
+ * only has literals. Blocks that are not compressible are stored without
+ * compression, but they're still added to the history of the stream
+ *
+ * @version 0.14
+ * @date 2025-06-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Read four bytes from an unaligned address
+ *
+ * @param Address
+ *
+ * @return UINT32
+ */
+static UINT32
+CompressionRead32(const UINT8 * Address)
+{
+    UINT32 Value;
+
+    memcpy(&Value, Address, sizeof(UINT32));
+
+    return Value;
+}
+
+/**
+ * @brief Compute the index of a four-byte sequence in the hash table
+ *
+ * @param Address
+ *
+ * @return UINT32
+ */
+static UINT32
+CompressionHash(const UINT8 * Address)
+{
+    return (CompressionRead32(Address) * 2654435761U) >> (32 - COMPRESSION_HASH_BITS);
+}
+
+/**
+ * @brief Make space for a new block in the history of the stream
+ *
+ * @param Stream The stream
+ * @param BlockLength Length of the new block
+ *
+ * @return VOID
+ */
+static VOID
+CompressionPrepareHistory(COMPRESSION_STREAM * Stream, UINT32 BlockLength)
+{
+    if (Stream->HistoryLength + BlockLength <= COMPRESSION_HISTORY_SIZE)
+    {
+        return;
+    }
+
+    //
+    // Keep the last window, older bytes are not reachable anymore
+    //
+    memmove(Stream->History,
+            Stream->History + Stream->HistoryLength - COMPRESSION_WINDOW_SIZE,
+            COMPRESSION_WINDOW_SIZE);
+
+    Stream->HistoryLength = COMPRESSION_WINDOW_SIZE;
+
+    //
+    // Positions in the hash table are not valid anymore
+    //
+    memset(Stream->HashTable, 0, sizeof(Stream->HashTable));
+}
+
+/**
+ * @brief Write a length that doesn't fit in the nibble of the token
+ *
+ * @param Destination Current position of the output
+ * @param End End of the output
+ * @param Length The remaining length (after subtracting 15)
+ *
+ * @return UINT8 * NULL if the output is full
+ */
+static UINT8 *
+CompressionWriteLength(UINT8 * Destination, UINT8 * End, UINT32 Length)
+{
+    while (Length >= 0xff)
+    {
+        if (Destination >= End)
+        {
+            return NULL;
+        }
+
+        *Destination++ = 0xff;
+        Length -= 0xff;
+    }
+
+    if (Destination >= End)
+    {
+        return NULL;
+    }
+
+    *Destination++ = (UINT8)Length;
+
+    return Destination;
+}
+
+/**
+ * @brief Write a sequence into the output
+ *
+ * @param Destination Current position of the output
+ * @param End End of the output
+ * @param Literals Start of the literals
+ * @param LiteralLength Number of literals
+ * @param MatchLength Length of the match (zero for the last sequence)
+ * @param Offset Distance of the match
+ *
+ * @return UINT8 * NULL if the output is full
+ */
+static UINT8 *
+CompressionWriteSequence(UINT8 *       Destination,
+                         UINT8 *       End,
+                         const UINT8 * Literals,
+                         UINT32        LiteralLength,
+                         UINT32        MatchLength,
+                         UINT32        Offset)
+{
+    UINT8 * Token;
+    UINT32  MatchCode = MatchLength != 0 ? MatchLength - COMPRESSION_MINIMUM_MATCH_LENGTH : 0;
+
+    if (Destination >= End)
+    {
+        return NULL;
+    }
+
+    Token  = Destination++;
+    *Token = (UINT8)(((LiteralLength < 15 ? LiteralLength : 15) << 4) | (MatchCode < 15 ? MatchCode : 15));
+
+    if (LiteralLength >= 15)
+    {
+        Destination = CompressionWriteLength(Destination, End, LiteralLength - 15);
+
+        if (Destination == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    if ((UINT32)(End - Destination) < LiteralLength)
+    {
+        return NULL;
+    }
+
+    memcpy(Destination, Literals, LiteralLength);
+    Destination += LiteralLength;
+
+    if (MatchLength == 0)
+    {
+        return Destination;
+    }
+
+    if (End - Destination < 2)
+    {
+        return NULL;
+    }
+
+    *Destination++ = (UINT8)(Offset & 0xff);
+    *Destination++ = (UINT8)(Offset >> 8);
+
+    if (MatchCode >= 15)
+    {
+        Destination = CompressionWriteLength(Destination, End, MatchCode - 15);
+    }
+
+    return Destination;
+}
+
+/**
+ * @brief Read a length that doesn't fit in the nibble of the token
+ *
+ * @param Source Current position of the input (updated)
+ * @param End End of the input
+ * @param Length The length that is read (added to the previous value)
+ *
+ * @return BOOLEAN FALSE if the input is truncated
+ */
+static BOOLEAN
+CompressionReadLength(const UINT8 ** Source, const UINT8 * End, UINT32 * Length)
+{
+    UINT8 Byte;
+
+    do
+    {
+        if (*Source >= End)
+        {
+            return FALSE;
+        }
+
+        Byte = *(*Source)++;
+        *Length += Byte;
+
+    } while (Byte == 0xff);
+
+    return TRUE;
+}
+
+/**
+ * @brief Reset the state of a stream
+ * @details Both sides should reset their streams at the same point
+ *
+ * @param Stream The stream
+ *
+ * @return VOID
+ */
+VOID
+CompressionResetStream(COMPRESSION_STREAM * Stream)
+{
+    Stream->StreamOffset  = 0;
+    Stream->HistoryLength = 0;
+
+    memset(Stream->HashTable, 0, sizeof(Stream->HashTable));
+}
+
+/**
+ * @brief Add a block to the stream without compressing it
+ * @details Used by the decompressor for the blocks that are stored without
+ * compression
+ *
+ * @param Stream The stream
+ * @param Source The block
+ * @param SourceLength Length of the block
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+CompressionStoreBlock(COMPRESSION_STREAM * Stream, const VOID * Source, UINT32 SourceLength)
+{
+    if (SourceLength == 0 || SourceLength > COMPRESSION_MAXIMUM_BLOCK_SIZE)
+    {
+        return FALSE;
+    }
+
+    CompressionPrepareHistory(Stream, SourceLength);
+
+    memcpy(Stream->History + Stream->HistoryLength, Source, SourceLength);
+
+    Stream->HistoryLength += SourceLength;
+    Stream->StreamOffset += SourceLength;
+
+    return TRUE;
+}
+
+/**
+ * @brief Compress a block and append it to the stream
+ * @details The block is added to the stream even if it's not compressible,
+ * in that case the caller should send the block without compression (the
+ * other side adds it to its stream by using CompressionStoreBlock)
+ *
+ * @param Stream The stream
+ * @param Source The block
+ * @param SourceLength Length of the block
+ * @param Destination The output buffer
+ * @param DestinationCapacity Size of the output buffer (the block is not
+ * compressed if the result doesn't fit into this size)
+ *
+ * @return UINT32 Length of the compressed block or zero if it's not compressed
+ * (or it's larger than COMPRESSION_MAXIMUM_BLOCK_SIZE, then it's not added to
+ * the stream)
+ */
+UINT32
+CompressionCompress(COMPRESSION_STREAM * Stream,
+                    const VOID *         Source,
+                    UINT32               SourceLength,
+                    VOID *               Destination,
+                    UINT32               DestinationCapacity)
+{
+    UINT8 *       Output    = (UINT8 *)Destination;
+    UINT8 *       OutputEnd = (UINT8 *)Destination + DestinationCapacity;
+    const UINT8 * Input;
+    const UINT8 * InputEnd;
+    const UINT8 * Anchor;
+    const UINT8 * Match;
+    UINT32        Position;
+    UINT32        Start;
+    UINT32        End;
+    UINT32        Candidate;
+    UINT32        MatchLength;
+    UINT32        Hash;
+
+    if (SourceLength == 0 || SourceLength > COMPRESSION_MAXIMUM_BLOCK_SIZE)
+    {
+        return 0;
+    }
+
+    //
+    // The block is placed after the history, so the matches are searched
+    // in the previous blocks and in the block itself in the same way
+    //
+    CompressionPrepareHistory(Stream, SourceLength);
+
+    Start = Stream->HistoryLength;
+    End   = Start + SourceLength;
+
+    memcpy(Stream->History + Start, Source, SourceLength);
+
+    Stream->HistoryLength = End;
+    Stream->StreamOffset += SourceLength;
+
+    InputEnd = Stream->History + End;
+    Anchor   = Stream->History + Start;
+    Position = Start;
+
+    while (Position + COMPRESSION_MINIMUM_MATCH_LENGTH <= End)
+    {
+        Input     = Stream->History + Position;
+        Hash      = CompressionHash(Input);
+        Candidate = Stream->HashTable[Hash];
+
+        Stream->HashTable[Hash] = Position + 1;
+
+        //
+        // Positions are stored plus one, so zero means an empty entry
+        //
+        if (Candidate == 0 ||
+            Position - (Candidate - 1) > COMPRESSION_WINDOW_SIZE ||
+            CompressionRead32(Stream->History + Candidate - 1) != CompressionRead32(Input))
+        {
+            Position++;
+            continue;
+        }
+
+        Match       = Stream->History + Candidate - 1;
+        MatchLength = COMPRESSION_MINIMUM_MATCH_LENGTH;
+
+        while (Input + MatchLength < InputEnd && Match[MatchLength] == Input[MatchLength])
+        {
+            MatchLength++;
+        }
+
+        Output = CompressionWriteSequence(Output,
+                                          OutputEnd,
+                                          Anchor,
+                                          (UINT32)(Input - Anchor),
+                                          MatchLength,
+                                          (UINT32)(Input - Match));
+
+        if (Output == NULL)
+        {
+            return 0;
+        }
+
+        Position += MatchLength;
+        Anchor = Stream->History + Position;
+    }
+
+    //
+    // The last sequence holds the remaining literals
+    //
+    Output = CompressionWriteSequence(Output, OutputEnd, Anchor, (UINT32)(InputEnd - Anchor), 0, 0);
+
+    if (Output == NULL)
+    {
+        return 0;
+    }
+
+    return (UINT32)(Output - (UINT8 *)Destination);
+}
+
+/**
+ * @brief Decompress a block and append it to the stream
+ * @details The compressed block is fully validated, the block is not added
+ * to the stream if it's invalid
+ *
+ * @param Stream The stream
+ * @param Source The compressed block
+ * @param SourceLength Length of the compressed block
+ * @param Destination The output buffer
+ * @param DestinationLength Length of the block (before compression)
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+CompressionDecompress(COMPRESSION_STREAM * Stream,
+                      const VOID *         Source,
+                      UINT32               SourceLength,
+                      VOID *               Destination,
+                      UINT32               DestinationLength)
+{
+    const UINT8 * Input    = (const UINT8 *)Source;
+    const UINT8 * InputEnd = (const UINT8 *)Source + SourceLength;
+    UINT8 *       Output;
+    UINT8 *       OutputStart;
+    UINT8 *       OutputEnd;
+    const UINT8 * Match;
+    UINT32        LiteralLength;
+    UINT32        MatchLength;
+    UINT32        Offset;
+    UINT8         Token;
+
+    if (DestinationLength == 0 || DestinationLength > COMPRESSION_MAXIMUM_BLOCK_SIZE)
+    {
+        return FALSE;
+    }
+
+    CompressionPrepareHistory(Stream, DestinationLength);
+
+    OutputStart = Stream->History + Stream->HistoryLength;
+    OutputEnd   = OutputStart + DestinationLength;
+    Output      = OutputStart;
+
+    while (TRUE)
+    {
+        if (Input >= InputEnd)
+        {
+            return FALSE;
+        }
+
+        Token         = *Input++;
+        LiteralLength = Token >> 4;
+
+        if (LiteralLength == 15 && !CompressionReadLength(&Input, InputEnd, &LiteralLength))
+        {
+            return FALSE;
+        }
+
+        if ((UINT32)(InputEnd - Input) < LiteralLength || (UINT32)(OutputEnd - Output) < LiteralLength)
+        {
+            return FALSE;
+        }
+
+        memcpy(Output, Input, LiteralLength);
+        Output += LiteralLength;
+        Input += LiteralLength;
+
+        if (Input == InputEnd)
+        {
+            //
+            // It was the last sequence
+            //
+            break;
+        }
+
+        if (InputEnd - Input < 2)
+        {
+            return FALSE;
+        }
+
+        Offset = Input[0] | (Input[1] << 8);
+        Input += 2;
+
+        MatchLength = (Token & 0xf) + COMPRESSION_MINIMUM_MATCH_LENGTH;
+
+        if ((Token & 0xf) == 15 && !CompressionReadLength(&Input, InputEnd, &MatchLength))
+        {
+            return FALSE;
+        }
+
+        if (Offset == 0 ||
+            Offset > (UINT32)(Output - Stream->History) ||
+            (UINT32)(OutputEnd - Output) < MatchLength)
+        {
+            return FALSE;
+        }
+
+        //
+        // The match might overlap the output, so it's copied byte by byte
+        //
+        Match = Output - Offset;
+
+        for (UINT32 i = 0; i < MatchLength; i++)
+        {
+            Output[i] = Match[i];
+        }
+
+        Output += MatchLength;
+    }
+
+    if (Output != OutputEnd)
+    {
+        return FALSE;
+    }
+
+    memcpy(Destination, OutputStart, DestinationLength);
+
+    //
+    // The block is valid, append it to the history
+    //
+    Stream->HistoryLength += DestinationLength;
+    Stream->StreamOffset += DestinationLength;
+
+    return TRUE;
+}
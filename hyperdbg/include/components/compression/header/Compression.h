@@ -0,0 +1,94 @@
+/**
+ * @file Compression.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Headers of the streaming compressor (LZ77, LZ4-like sequences)
+ * @details Each block is compressed against the previous blocks of the same
+ * stream, so repeated format strings of log messages are encoded as matches
+ * to the previous messages. Both sides of the stream should process the same
+ * blocks in the same order. This component doesn't depend on any kernel routine
+ * so it can be also compiled in user-mode
+ *
+ * @version 0.14
+ * @date 2025-06-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum distance of a match (in bytes)
+ *
+ */
+#define COMPRESSION_WINDOW_SIZE 0xffff
+
+/**
+ * @brief Size of the history of the stream
+ * @details Once the history is full, the last window is moved to the start
+ * of the history
+ *
+ */
+#define COMPRESSION_HISTORY_SIZE 0x20000
+
+/**
+ * @brief Maximum length of a block that can be compressed
+ *
+ */
+#define COMPRESSION_MAXIMUM_BLOCK_SIZE (COMPRESSION_HISTORY_SIZE - COMPRESSION_WINDOW_SIZE)
+
+/**
+ * @brief Number of bits of the hash table of the compressor
+ *
+ */
+#define COMPRESSION_HASH_BITS 12
+
+/**
+ * @brief Minimum length of a match
+ *
+ */
+#define COMPRESSION_MINIMUM_MATCH_LENGTH 4
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The state of a compression (or decompression) stream
+ *
+ */
+typedef struct _COMPRESSION_STREAM
+{
+    UINT64 StreamOffset;                          // Total length of the blocks of the stream
+    UINT32 HistoryLength;                         // Used bytes of the history
+    UINT32 HashTable[1 << COMPRESSION_HASH_BITS]; // Positions in the history (plus one), only used by the compressor
+    UINT8  History[COMPRESSION_HISTORY_SIZE];     // The previous blocks of the stream
+
+} COMPRESSION_STREAM, *PCOMPRESSION_STREAM;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+VOID
+CompressionResetStream(COMPRESSION_STREAM * Stream);
+
+BOOLEAN
+CompressionStoreBlock(COMPRESSION_STREAM * Stream, const VOID * Source, UINT32 SourceLength);
+
+UINT32
+CompressionCompress(COMPRESSION_STREAM * Stream,
+                    const VOID *         Source,
+                    UINT32               SourceLength,
+                    VOID *               Destination,
+                    UINT32               DestinationCapacity);
+
+BOOLEAN
+CompressionDecompress(COMPRESSION_STREAM * Stream,
+                      const VOID *         Source,
+                      UINT32               SourceLength,
+                      VOID *               Destination,
+                      UINT32               DestinationLength);
@@ -0,0 +1,564 @@
+/**
+ * @file Framing.c
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Implementation of the length-prefixed framing of the remote packets
+ * @details A frame is a FRAMING_HEADER followed by the payload. The header
+ * is protected by its own checksum, so a corrupted length is detected before
+ * reading the payload. If the header is not valid, the receiver skips one byte
+ * at a time until it finds a valid header. If the payload is corrupted, the
+ * receiver sends a NAK and the sender retransmits its last frame
+ *
+ * @version 0.14
+ * @date 2025-06-24
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#    include <intrin.h>
+#    define FRAMING_HARDWARE_CRC32C
+#endif
+
+/**
+ * @brief The reflected polynomial of CRC32C (Castagnoli)
+ *
+ */
+#define FRAMING_CRC32C_POLYNOMIAL 0x82F63B78
+
+/**
+ * @brief Tables of the slice-by-8 implementation of CRC32C
+ *
+ */
+static UINT32 FramingCrc32cTable[8][256];
+
+/**
+ * @brief Whether the tables are built or not
+ *
+ */
+static BOOLEAN FramingCrc32cTableInitialized;
+
+#ifdef FRAMING_HARDWARE_CRC32C
+
+/**
+ * @brief Whether the processor supports the crc32 instruction (SSE4.2)
+ * @details -1 means not checked yet
+ *
+ */
+static INT32 FramingHardwareCrc32cSupported = -1;
+
+#endif
+
+/**
+ * @brief Build the tables of the slice-by-8 implementation
+ * @details Each entry is only written with its final value, so it's fine
+ * if both sides of a loopback build the tables at the same time
+ *
+ * @return VOID
+ */
+static VOID
+FramingInitializeCrc32cTable()
+{
+    UINT32 Crc;
+
+    for (UINT32 i = 0; i < 256; i++)
+    {
+        Crc = i;
+
+        for (UINT32 j = 0; j < 8; j++)
+        {
+            Crc = (Crc >> 1) ^ (FRAMING_CRC32C_POLYNOMIAL & (0 - (Crc & 1)));
+        }
+
+        FramingCrc32cTable[0][i] = Crc;
+    }
+
+    for (UINT32 i = 0; i < 256; i++)
+    {
+        Crc = FramingCrc32cTable[0][i];
+
+        for (UINT32 j = 1; j < 8; j++)
+        {
+            Crc                      = FramingCrc32cTable[0][Crc & 0xff] ^ (Crc >> 8);
+            FramingCrc32cTable[j][i] = Crc;
+        }
+    }
+
+    FramingCrc32cTableInitialized = TRUE;
+}
+
+/**
+ * @brief Initialize one side of a framed connection
+ * @details If a retransmission buffer is given, the last frame that fits in
+ * the buffer is kept to be sent again if the other side sends a NAK
+ *
+ * @param Transport The state of the connection
+ * @param Context Passed to the read and write routines
+ * @param Read Routine to read from the transport
+ * @param Write Routine to write to the transport
+ * @param RetransmissionBuffer Buffer to keep the last frame (optional)
+ * @param RetransmissionBufferSize Size of the retransmission buffer
+ *
+ * @return VOID
+ */
+VOID
+FramingInitialize(FRAMING_TRANSPORT *   Transport,
+                  PVOID                 Context,
+                  FRAMING_READ_ROUTINE  Read,
+                  FRAMING_WRITE_ROUTINE Write,
+                  UINT8 *               RetransmissionBuffer,
+                  UINT32                RetransmissionBufferSize)
+{
+    memset(Transport, 0, sizeof(FRAMING_TRANSPORT));
+
+    Transport->Context                  = Context;
+    Transport->Read                     = Read;
+    Transport->Write                    = Write;
+    Transport->RetransmissionBuffer     = RetransmissionBuffer;
+    Transport->RetransmissionBufferSize = RetransmissionBuffer != NULL ? RetransmissionBufferSize : 0;
+
+    if (!FramingCrc32cTableInitialized)
+    {
+        FramingInitializeCrc32cTable();
+    }
+}
+
+/**
+ * @brief Set the lock that serializes the writes to the transport
+ * @details Frames are sent by the senders while the NAKs (and the
+ * retransmitted frames) are written by the receiver, if they run on
+ * different threads, the writes should be serialized by this lock
+ *
+ * @param Transport The state of the connection
+ * @param SendLock The lock variable
+ * @param AcquireSendLock Routine to acquire the lock
+ * @param ReleaseSendLock Routine to release the lock
+ *
+ * @return VOID
+ */
+VOID
+FramingSetSendLock(FRAMING_TRANSPORT *  Transport,
+                   volatile LONG *      SendLock,
+                   FRAMING_LOCK_ROUTINE AcquireSendLock,
+                   FRAMING_LOCK_ROUTINE ReleaseSendLock)
+{
+    Transport->SendLock        = SendLock;
+    Transport->AcquireSendLock = AcquireSendLock;
+    Transport->ReleaseSendLock = ReleaseSendLock;
+}
+
+/**
+ * @brief Acquire the send lock of the transport (if any)
+ *
+ * @param Transport The state of the connection
+ *
+ * @return VOID
+ */
+static VOID
+FramingAcquireSendLock(FRAMING_TRANSPORT * Transport)
+{
+    if (Transport->SendLock != NULL)
+    {
+        Transport->AcquireSendLock(Transport->SendLock);
+    }
+}
+
+/**
+ * @brief Release the send lock of the transport (if any)
+ *
+ * @param Transport The state of the connection
+ *
+ * @return VOID
+ */
+static VOID
+FramingReleaseSendLock(FRAMING_TRANSPORT * Transport)
+{
+    if (Transport->SendLock != NULL)
+    {
+        Transport->ReleaseSendLock(Transport->SendLock);
+    }
+}
+
+/**
+ * @brief Compute the checksum (CRC32C) of a buffer
+ * @details The checksum of several buffers is computed by passing the
+ * result of the previous buffer, the first call should pass
+ * FRAMING_CHECKSUM_INITIAL_VALUE. The crc32 instruction is used if the
+ * processor supports it (it only uses general purpose registers, so it's
+ * also safe in the kernel)
+ *
+ * @param Checksum The checksum of the previous buffers
+ * @param Buffer
+ * @param Length
+ *
+ * @return UINT32
+ */
+UINT32
+FramingComputeChecksum(UINT32 Checksum, const VOID * Buffer, UINT32 Length)
+{
+    const UINT8 * Data = (const UINT8 *)Buffer;
+    UINT32        Crc  = ~Checksum;
+    UINT32        Low;
+    UINT32        High;
+
+#ifdef FRAMING_HARDWARE_CRC32C
+
+    if (FramingHardwareCrc32cSupported == -1)
+    {
+        INT32 CpuInfo[4];
+
+        __cpuid(CpuInfo, 1);
+
+        //
+        // CPUID.01H:ECX.SSE4_2[bit 20]
+        //
+        FramingHardwareCrc32cSupported = (CpuInfo[2] >> 20) & 1;
+    }
+
+    if (FramingHardwareCrc32cSupported)
+    {
+        UINT64 Crc64 = Crc;
+
+        for (; Length >= 8; Length -= 8, Data += 8)
+        {
+            Crc64 = _mm_crc32_u64(Crc64, *(const UINT64 *)Data);
+        }
+
+        Crc = (UINT32)Crc64;
+
+        while (Length--)
+        {
+            Crc = _mm_crc32_u8(Crc, *Data++);
+        }
+
+        return ~Crc;
+    }
+
+#endif
+
+    if (!FramingCrc32cTableInitialized)
+    {
+        FramingInitializeCrc32cTable();
+    }
+
+    //
+    // Process eight bytes at a time
+    //
+    for (; Length >= 8; Length -= 8, Data += 8)
+    {
+        Low  = (Data[0] | (Data[1] << 8) | (Data[2] << 16) | ((UINT32)Data[3] << 24)) ^ Crc;
+        High = Data[4] | (Data[5] << 8) | (Data[6] << 16) | ((UINT32)Data[7] << 24);
+
+        Crc = FramingCrc32cTable[7][Low & 0xff] ^
+              FramingCrc32cTable[6][(Low >> 8) & 0xff] ^
+              FramingCrc32cTable[5][(Low >> 16) & 0xff] ^
+              FramingCrc32cTable[4][Low >> 24] ^
+              FramingCrc32cTable[3][High & 0xff] ^
+              FramingCrc32cTable[2][(High >> 8) & 0xff] ^
+              FramingCrc32cTable[1][(High >> 16) & 0xff] ^
+              FramingCrc32cTable[0][High >> 24];
+    }
+
+    while (Length--)
+    {
+        Crc = FramingCrc32cTable[0][(Crc ^ *Data++) & 0xff] ^ (Crc >> 8);
+    }
+
+    return ~Crc;
+}
+
+/**
+ * @brief Check whether a header is valid or not
+ *
+ * @param Header
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+FramingIsHeaderValid(const FRAMING_HEADER * Header)
+{
+    return Header->Magic == FRAMING_MAGIC &&
+           Header->HeaderChecksum == FramingComputeChecksum(FRAMING_CHECKSUM_INITIAL_VALUE,
+                                                            Header,
+                                                            FIELD_OFFSET(FRAMING_HEADER, HeaderChecksum));
+}
+
+/**
+ * @brief Compute the checksum of the header
+ *
+ * @param Header
+ *
+ * @return VOID
+ */
+static VOID
+FramingSealHeader(FRAMING_HEADER * Header)
+{
+    Header->Magic          = FRAMING_MAGIC;
+    Header->HeaderChecksum = FramingComputeChecksum(FRAMING_CHECKSUM_INITIAL_VALUE,
+                                                    Header,
+                                                    FIELD_OFFSET(FRAMING_HEADER, HeaderChecksum));
+}
+
+/**
+ * @brief Request the retransmission of a frame
+ *
+ * @param Transport The state of the connection
+ * @param SequenceNumber Sequence number of the corrupted frame
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+FramingSendNak(FRAMING_TRANSPORT * Transport, UINT32 SequenceNumber)
+{
+    FRAMING_HEADER Header = {0};
+    BOOLEAN        Result;
+
+    Header.Type           = FRAMING_TYPE_NAK;
+    Header.SequenceNumber = SequenceNumber;
+    Header.Checksum       = FRAMING_CHECKSUM_INITIAL_VALUE;
+
+    FramingSealHeader(&Header);
+
+    FramingAcquireSendLock(Transport);
+
+    Result = Transport->Write(Transport->Context, &Header, sizeof(FRAMING_HEADER));
+
+    FramingReleaseSendLock(Transport);
+
+    return Result;
+}
+
+/**
+ * @brief Handle a NAK that is received from the other side
+ * @details Only the last frame is kept, so NAKs of the older frames are
+ * ignored (the other side handles them as lost frames)
+ *
+ * @param Transport The state of the connection
+ * @param SequenceNumber Sequence number of the corrupted frame
+ *
+ * @return VOID
+ */
+static VOID
+FramingHandleNak(FRAMING_TRANSPORT * Transport, UINT32 SequenceNumber)
+{
+    //
+    // The last frame (and its sequence number) is changed by the sender
+    //
+    FramingAcquireSendLock(Transport);
+
+    if (Transport->RetransmissionLength != 0 &&
+        SequenceNumber == Transport->SendSequenceNumber - 1 &&
+        Transport->RetransmissionCount < FRAMING_MAXIMUM_RETRANSMISSIONS)
+    {
+        Transport->RetransmissionCount++;
+
+        if (Transport->Write(Transport->Context, Transport->RetransmissionBuffer, Transport->RetransmissionLength))
+        {
+            Transport->NumberOfRetransmittedFrames++;
+        }
+    }
+
+    FramingReleaseSendLock(Transport);
+}
+
+/**
+ * @brief Send the buffers as the payload of one frame
+ * @details If the transport has no send lock, the caller should make sure
+ * that frames are not sent simultaneously on the same transport (and with the
+ * NAKs of the receiver). If the frame fits in the retransmission buffer, it's
+ * written at once from there
+ *
+ * @param Transport The state of the connection
+ * @param Buffers The buffers of the payload
+ * @param Lengths Length of each buffer
+ * @param NumberOfBuffers
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+FramingSendBuffers(FRAMING_TRANSPORT * Transport,
+                   const VOID **       Buffers,
+                   const UINT32 *      Lengths,
+                   UINT32              NumberOfBuffers)
+{
+    FRAMING_HEADER Header = {0};
+    UINT32         Offset;
+    BOOLEAN        Result = TRUE;
+
+    Header.Type     = FRAMING_TYPE_DATA;
+    Header.Checksum = FRAMING_CHECKSUM_INITIAL_VALUE;
+
+    for (UINT32 i = 0; i < NumberOfBuffers; i++)
+    {
+        Header.Length += Lengths[i];
+        Header.Checksum = FramingComputeChecksum(Header.Checksum, Buffers[i], Lengths[i]);
+    }
+
+    FramingAcquireSendLock(Transport);
+
+    Header.SequenceNumber = Transport->SendSequenceNumber++;
+
+    FramingSealHeader(&Header);
+
+    Transport->RetransmissionLength = 0;
+    Transport->RetransmissionCount  = 0;
+
+    if (Transport->RetransmissionBufferSize >= sizeof(FRAMING_HEADER) &&
+        Header.Length <= Transport->RetransmissionBufferSize - sizeof(FRAMING_HEADER))
+    {
+        //
+        // Keep the frame for a possible retransmission
+        //
+        memcpy(Transport->RetransmissionBuffer, &Header, sizeof(FRAMING_HEADER));
+        Offset = sizeof(FRAMING_HEADER);
+
+        for (UINT32 i = 0; i < NumberOfBuffers; i++)
+        {
+            if (Lengths[i] != 0)
+            {
+                memcpy(Transport->RetransmissionBuffer + Offset, Buffers[i], Lengths[i]);
+                Offset += Lengths[i];
+            }
+        }
+
+        Transport->RetransmissionLength = Offset;
+
+        Result = Transport->Write(Transport->Context, Transport->RetransmissionBuffer, Offset);
+    }
+    else if (!Transport->Write(Transport->Context, &Header, sizeof(FRAMING_HEADER)))
+    {
+        Result = FALSE;
+    }
+    else
+    {
+        for (UINT32 i = 0; i < NumberOfBuffers; i++)
+        {
+            if (Lengths[i] != 0 && !Transport->Write(Transport->Context, Buffers[i], Lengths[i]))
+            {
+                Result = FALSE;
+                break;
+            }
+        }
+    }
+
+    FramingReleaseSendLock(Transport);
+
+    return Result;
+}
+
+/**
+ * @brief Receive the payload of the next frame
+ * @details The header is read at once and then the whole payload is read at
+ * once. Bytes before a valid header (e.g., a partially received frame or the
+ * packets that are not framed) are skipped. NAKs from the other side are
+ * handled here, and a NAK is sent if the payload is corrupted, so the caller
+ * can call this function again to receive the retransmitted frame
+ *
+ * @param Transport The state of the connection
+ * @param Buffer The buffer to save the payload
+ * @param BufferSize Size of the buffer
+ * @param Length Length of the received payload
+ *
+ * @return FRAMING_STATUS
+ */
+FRAMING_STATUS
+FramingReceive(FRAMING_TRANSPORT * Transport,
+               VOID *              Buffer,
+               UINT32              BufferSize,
+               UINT32 *            Length)
+{
+    FRAMING_HEADER Header;
+    UINT8 *        HeaderBytes = (UINT8 *)&Header;
+    UINT32         Remaining;
+    UINT32         ChunkLength;
+
+    *Length = 0;
+
+ReadHeader:
+
+    if (!Transport->Read(Transport->Context, &Header, sizeof(FRAMING_HEADER)))
+    {
+        return FRAMING_STATUS_CONNECTION_CLOSED;
+    }
+
+    //
+    // Find the start of the frame
+    //
+    while (!FramingIsHeaderValid(&Header))
+    {
+        memmove(HeaderBytes, HeaderBytes + 1, sizeof(FRAMING_HEADER) - 1);
+
+        if (!Transport->Read(Transport->Context, HeaderBytes + sizeof(FRAMING_HEADER) - 1, 1))
+        {
+            return FRAMING_STATUS_CONNECTION_CLOSED;
+        }
+
+        Transport->NumberOfDiscardedBytes++;
+    }
+
+    if (Header.Type == FRAMING_TYPE_NAK)
+    {
+        //
+        // NAKs don't have a payload and don't use a sequence number
+        //
+        FramingHandleNak(Transport, Header.SequenceNumber);
+
+        goto ReadHeader;
+    }
+
+    if (Header.SequenceNumber != Transport->ReceiveSequenceNumber)
+    {
+        Transport->NumberOfOutOfSequenceFrames++;
+    }
+
+    Transport->ReceiveSequenceNumber = Header.SequenceNumber + 1;
+
+    if (Header.Length > BufferSize)
+    {
+        //
+        // The payload doesn't fit in the buffer, skip it so the next frame
+        // can be received
+        //
+        Remaining = Header.Length;
+
+        while (Remaining != 0 && BufferSize != 0)
+        {
+            ChunkLength = Remaining < BufferSize ? Remaining : BufferSize;
+
+            if (!Transport->Read(Transport->Context, Buffer, ChunkLength))
+            {
+                return FRAMING_STATUS_CONNECTION_CLOSED;
+            }
+
+            Remaining -= ChunkLength;
+        }
+
+        Transport->NumberOfInvalidFrames++;
+
+        return FRAMING_STATUS_BUFFER_TOO_SMALL;
+    }
+
+    if (Header.Length != 0 && !Transport->Read(Transport->Context, Buffer, Header.Length))
+    {
+        return FRAMING_STATUS_CONNECTION_CLOSED;
+    }
+
+    if (FramingComputeChecksum(FRAMING_CHECKSUM_INITIAL_VALUE, Buffer, Header.Length) != Header.Checksum)
+    {
+        Transport->NumberOfInvalidFrames++;
+
+        //
+        // The retransmitted frame has the same sequence number
+        //
+        Transport->ReceiveSequenceNumber = Header.SequenceNumber;
+
+        FramingSendNak(Transport, Header.SequenceNumber);
+
+        return FRAMING_STATUS_INVALID_CHECKSUM;
+    }
+
+    *Length = Header.Length;
+
+    return FRAMING_STATUS_SUCCESS;
+}
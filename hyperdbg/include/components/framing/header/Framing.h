@@ -0,0 +1,165 @@
+/**
+ * @file Framing.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Headers of the length-prefixed framing of the remote packets
+ * @details Each frame starts with a header that contains the length of the
+ * payload, so the receiver reads the header and then the whole payload at
+ * once, instead of reading byte by byte and looking for the end of buffer
+ * characters. Frames are protected by CRC32C and the receiver requests the
+ * retransmission of a corrupted frame by sending a NAK frame. The bytes are
+ * read and written by the routines of the transport, so this component doesn't
+ * depend on any kernel routine and can be also compiled in user-mode (and tested
+ * over a loopback)
+ *
+ * @version 0.14
+ * @date 2025-06-24
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The magic number at the start of each frame ('HDFR')
+ *
+ */
+#define FRAMING_MAGIC 0x52464448
+
+/**
+ * @brief The initial value of the checksum (CRC32C)
+ *
+ */
+#define FRAMING_CHECKSUM_INITIAL_VALUE 0
+
+/**
+ * @brief Maximum number of times that a frame is retransmitted
+ *
+ */
+#define FRAMING_MAXIMUM_RETRANSMISSIONS 4
+
+/**
+ * @brief Type of a frame that carries a payload
+ *
+ */
+#define FRAMING_TYPE_DATA 0
+
+/**
+ * @brief Type of a frame that requests the retransmission of the frame
+ * with the same sequence number (no payload)
+ *
+ */
+#define FRAMING_TYPE_NAK 1
+
+/**
+ * @brief Reads exactly the given number of bytes from the transport
+ * @details Returns FALSE if the connection is closed
+ *
+ */
+typedef BOOLEAN (*FRAMING_READ_ROUTINE)(PVOID Context, VOID * Buffer, UINT32 Length);
+
+/**
+ * @brief Writes the given bytes to the transport
+ *
+ */
+typedef BOOLEAN (*FRAMING_WRITE_ROUTINE)(PVOID Context, const VOID * Buffer, UINT32 Length);
+
+/**
+ * @brief Acquires or releases the lock that serializes the writes to the transport
+ * @details Same as SpinlockLock and SpinlockUnlock
+ *
+ */
+typedef void (*FRAMING_LOCK_ROUTINE)(volatile LONG * Lock);
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The header of each frame
+ *
+ */
+typedef struct _FRAMING_HEADER
+{
+    UINT32 Magic;          // FRAMING_MAGIC
+    UINT32 Type;           // FRAMING_TYPE_DATA or FRAMING_TYPE_NAK
+    UINT32 Length;         // Length of the payload
+    UINT32 SequenceNumber; // Sequence number of the frame on the sender side
+    UINT32 Checksum;       // Checksum of the payload
+    UINT32 HeaderChecksum; // Checksum of the previous fields of the header
+
+} FRAMING_HEADER, *PFRAMING_HEADER;
+
+/**
+ * @brief The state of one side of a framed connection
+ *
+ */
+typedef struct _FRAMING_TRANSPORT
+{
+    PVOID                 Context;                     // Passed to the read and write routines
+    FRAMING_READ_ROUTINE  Read;                        // Routine to read from the transport
+    FRAMING_WRITE_ROUTINE Write;                       // Routine to write to the transport
+    volatile LONG *       SendLock;                    // Serializes the frames and the NAKs that are written (optional)
+    FRAMING_LOCK_ROUTINE  AcquireSendLock;             // Routine to acquire the send lock
+    FRAMING_LOCK_ROUTINE  ReleaseSendLock;             // Routine to release the send lock
+    UINT32                SendSequenceNumber;          // Sequence number of the next frame that is sent
+    UINT32                ReceiveSequenceNumber;       // Sequence number of the next frame that is expected
+    UINT8 *               RetransmissionBuffer;        // Keeps the last frame that is sent (optional)
+    UINT32                RetransmissionBufferSize;    // Size of the retransmission buffer
+    UINT32                RetransmissionLength;        // Length of the last frame (zero if it's not kept)
+    UINT32                RetransmissionCount;         // Number of times that the last frame is retransmitted
+    UINT64                NumberOfDiscardedBytes;      // Bytes that are skipped to find the start of a frame
+    UINT64                NumberOfInvalidFrames;       // Frames with an invalid checksum or a large length
+    UINT64                NumberOfOutOfSequenceFrames; // Frames that didn't have the expected sequence number
+    UINT64                NumberOfRetransmittedFrames; // Frames that are sent again because of a NAK
+
+} FRAMING_TRANSPORT, *PFRAMING_TRANSPORT;
+
+/**
+ * @brief The result of receiving a frame
+ *
+ */
+typedef enum _FRAMING_STATUS
+{
+    FRAMING_STATUS_SUCCESS = 0,
+    FRAMING_STATUS_CONNECTION_CLOSED,
+    FRAMING_STATUS_INVALID_CHECKSUM,
+    FRAMING_STATUS_BUFFER_TOO_SMALL,
+
+} FRAMING_STATUS;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+VOID
+FramingInitialize(FRAMING_TRANSPORT *   Transport,
+                  PVOID                 Context,
+                  FRAMING_READ_ROUTINE  Read,
+                  FRAMING_WRITE_ROUTINE Write,
+                  UINT8 *               RetransmissionBuffer,
+                  UINT32                RetransmissionBufferSize);
+
+VOID
+FramingSetSendLock(FRAMING_TRANSPORT *  Transport,
+                   volatile LONG *      SendLock,
+                   FRAMING_LOCK_ROUTINE AcquireSendLock,
+                   FRAMING_LOCK_ROUTINE ReleaseSendLock);
+
+UINT32
+FramingComputeChecksum(UINT32 Checksum, const VOID * Buffer, UINT32 Length);
+
+BOOLEAN
+FramingSendBuffers(FRAMING_TRANSPORT * Transport,
+                   const VOID **       Buffers,
+                   const UINT32 *      Lengths,
+                   UINT32              NumberOfBuffers);
+
+FRAMING_STATUS
+FramingReceive(FRAMING_TRANSPORT * Transport,
+               VOID *              Buffer,
+               UINT32              BufferSize,
+               UINT32 *            Length);
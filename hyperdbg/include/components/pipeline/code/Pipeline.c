@@ -0,0 +1,283 @@
+/**
+ * @file Pipeline.c
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Implementation of the window of pipelined requests
+ * @details The remote computer answers the requests in order, so the next
+ * expected response is always the response of the oldest outstanding request
+ * and a newer response means that the oldest request (or its response) is lost
+ *
+ * @version 0.14
+ * @date 2025-06-25
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Initialize a window of pipelined requests
+ *
+ * @param Window
+ *
+ * @return VOID
+ */
+VOID
+PipelineInitialize(PIPELINE_WINDOW * Window)
+{
+    memset(Window, 0, sizeof(PIPELINE_WINDOW));
+
+    Window->NextRequestId       = PIPELINE_REQUEST_ID_NOT_PIPELINED + 1;
+    Window->FirstResentRequest  = PIPELINE_INVALID_INDEX;
+    Window->LastSkippedResponse = PIPELINE_INVALID_INDEX;
+    Window->ResponseTimeout     = PIPELINE_DEFAULT_RESPONSE_TIMEOUT;
+}
+
+/**
+ * @brief Send all of the outstanding requests again (go-back-N)
+ * @details The requests are sent with their previous IDs, so the responses
+ * of the previous sends are still accepted if they're only delayed, and the
+ * duplicated responses are ignored as stale responses
+ *
+ * @param Window
+ * @param Send Routine to send a request
+ * @param Context Passed to the routine
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+PipelineResendOutstandingRequests(PIPELINE_WINDOW * Window, PIPELINE_SEND_ROUTINE Send, PVOID Context)
+{
+    UINT32 FirstIndex = (UINT32)Window->NumberOfCompletedRequests;
+
+    //
+    // Newer responses of the previous sends are received until the response of
+    // the first resent request, they're not counted as another loss
+    //
+    PlatformAtomicExchange(&Window->LastSkippedResponse, PIPELINE_INVALID_INDEX);
+    PlatformAtomicExchange(&Window->FirstResentRequest, (LONG)FirstIndex);
+    PlatformAtomicExchange(&Window->IsLossDetected, FALSE);
+
+    for (UINT32 Index = FirstIndex; Index < (UINT32)Window->NumberOfSentRequests; Index++)
+    {
+        Window->NumberOfResentRequests++;
+
+        if (!Send(Context, Index, Window->FirstRequestId + Index))
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Send the requests and wait for all of their responses
+ * @details At most WindowSize requests are outstanding, a window size
+ * of one is the same as waiting for each response before sending the
+ * next request. The receiver of the responses should call
+ * PipelineMatchResponse and PipelineCompleteResponse for each response.
+ * If no response is completed within the timeout of the window or a loss
+ * is detected, the outstanding requests are sent again, and the run fails
+ * after PIPELINE_MAXIMUM_RETRIES of them without receiving any response
+ *
+ * @param Window
+ * @param NumberOfRequests
+ * @param WindowSize Maximum number of outstanding requests
+ * @param Send Routine to send a request
+ * @param Wait Routine to wait for the responses
+ * @param Context Passed to the routines
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+PipelineRun(PIPELINE_WINDOW *     Window,
+            UINT32                NumberOfRequests,
+            UINT32                WindowSize,
+            PIPELINE_SEND_ROUTINE Send,
+            PIPELINE_WAIT_ROUTINE Wait,
+            PVOID                 Context)
+{
+    BOOLEAN Result                = TRUE;
+    UINT32  NumberOfRetries       = 0;
+    LONG    LastCompletedRequests = 0;
+    UINT64  LastProgressTime;
+    UINT64  ElapsedTime;
+    UINT32  Index;
+
+    if (NumberOfRequests == 0)
+    {
+        return TRUE;
+    }
+
+    if (WindowSize == 0)
+    {
+        WindowSize = 1;
+    }
+    else if (WindowSize > PIPELINE_MAXIMUM_WINDOW_SIZE)
+    {
+        WindowSize = PIPELINE_MAXIMUM_WINDOW_SIZE;
+    }
+
+    //
+    // The IDs of a run never wrap to the ID of the requests that are not pipelined
+    //
+    if (Window->NextRequestId == PIPELINE_REQUEST_ID_NOT_PIPELINED ||
+        Window->NextRequestId + NumberOfRequests < Window->NextRequestId)
+    {
+        Window->NextRequestId = PIPELINE_REQUEST_ID_NOT_PIPELINED + 1;
+    }
+
+    Window->Context                   = Context;
+    Window->FirstRequestId            = Window->NextRequestId;
+    Window->NumberOfRequests          = NumberOfRequests;
+    Window->NumberOfSentRequests      = 0;
+    Window->NumberOfCompletedRequests = 0;
+    Window->FirstResentRequest        = PIPELINE_INVALID_INDEX;
+    Window->LastSkippedResponse       = PIPELINE_INVALID_INDEX;
+    Window->IsLossDetected            = FALSE;
+    Window->NextRequestId += NumberOfRequests;
+
+    PlatformAtomicExchange(&Window->IsActive, TRUE);
+
+    LastProgressTime = PlatformGetTickCount64();
+
+    while ((UINT32)Window->NumberOfCompletedRequests < NumberOfRequests)
+    {
+        //
+        // Fill the window
+        //
+        while ((UINT32)Window->NumberOfSentRequests < NumberOfRequests &&
+               (UINT32)(Window->NumberOfSentRequests - Window->NumberOfCompletedRequests) < WindowSize)
+        {
+            //
+            // The request is counted before sending it, as its response might be
+            // received before the send routine returns
+            //
+            Index = (UINT32)Window->NumberOfSentRequests++;
+
+            if (!Send(Context, Index, Window->FirstRequestId + Index))
+            {
+                Result = FALSE;
+                goto Exit;
+            }
+        }
+
+        if ((UINT32)Window->NumberOfCompletedRequests >= NumberOfRequests)
+        {
+            break;
+        }
+
+        ElapsedTime = PlatformGetTickCount64() - LastProgressTime;
+
+        if (ElapsedTime < Window->ResponseTimeout && !Wait(Context, (UINT32)(Window->ResponseTimeout - ElapsedTime)))
+        {
+            Result = FALSE;
+            goto Exit;
+        }
+
+        if (Window->NumberOfCompletedRequests != LastCompletedRequests)
+        {
+            LastCompletedRequests = Window->NumberOfCompletedRequests;
+            LastProgressTime      = PlatformGetTickCount64();
+            NumberOfRetries       = 0;
+        }
+
+        if (!Window->IsLossDetected && PlatformGetTickCount64() - LastProgressTime < Window->ResponseTimeout)
+        {
+            continue;
+        }
+
+        //
+        // A request or its response is lost (or it's not received in time)
+        //
+        if (++NumberOfRetries > PIPELINE_MAXIMUM_RETRIES ||
+            !PipelineResendOutstandingRequests(Window, Send, Context))
+        {
+            Result = FALSE;
+            goto Exit;
+        }
+
+        LastProgressTime = PlatformGetTickCount64();
+    }
+
+Exit:
+
+    //
+    // The responses that are received after this point are ignored
+    //
+    PlatformAtomicExchange(&Window->IsActive, FALSE);
+
+    return Result;
+}
+
+/**
+ * @brief Check whether a response belongs to the next outstanding request
+ * @details If it belongs, the response should be saved for the request at
+ * Index and then PipelineCompleteResponse should be called. A response of a
+ * newer request means that the next outstanding request (or its response) is
+ * lost, so the sender should be woken up to send the requests again
+ *
+ * @param Window
+ * @param RequestId The ID that is returned in the response
+ * @param Index The index of the request in the current run
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+PipelineMatchResponse(PIPELINE_WINDOW * Window, UINT32 RequestId, UINT32 * Index)
+{
+    UINT32 NextIndex = (UINT32)Window->NumberOfCompletedRequests;
+    UINT32 ResponseIndex;
+
+    if (!Window->IsActive || NextIndex >= (UINT32)Window->NumberOfSentRequests)
+    {
+        return FALSE;
+    }
+
+    if (RequestId != Window->FirstRequestId + NextIndex)
+    {
+        ResponseIndex = RequestId - Window->FirstRequestId;
+
+        if (ResponseIndex <= NextIndex || ResponseIndex >= (UINT32)Window->NumberOfSentRequests)
+        {
+            //
+            // A duplicated response (or a response of another run)
+            //
+            return FALSE;
+        }
+
+        //
+        // Responses of the previous sends are still received (in order) until the
+        // response of the first resent request, so if a newer response is received
+        // again, the first resent request (or its response) is also lost
+        //
+        if (Window->FirstResentRequest != (LONG)NextIndex ||
+            (LONG)ResponseIndex <= Window->LastSkippedResponse)
+        {
+            PlatformAtomicExchange(&Window->IsLossDetected, TRUE);
+        }
+
+        PlatformAtomicExchange(&Window->LastSkippedResponse, (LONG)ResponseIndex);
+
+        return FALSE;
+    }
+
+    *Index = NextIndex;
+
+    return TRUE;
+}
+
+/**
+ * @brief Mark the response of the next outstanding request as received
+ * @details The response should be saved before calling this function,
+ * the sender may reuse the buffer of the request after it
+ *
+ * @param Window
+ *
+ * @return VOID
+ */
+VOID
+PipelineCompleteResponse(PIPELINE_WINDOW * Window)
+{
+    PlatformAtomicIncrement(&Window->NumberOfCompletedRequests);
+}
@@ -0,0 +1,119 @@
+/**
+ * @file Pipeline.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Headers of the window of pipelined requests
+ * @details Instead of waiting for the response of each request before sending
+ * the next one, up to a window of requests are sent and the remote computer
+ * answers them in order. Each request has an ID that is returned with its
+ * response, so the stale responses (e.g., of an aborted window) are ignored.
+ * If a request or its response is lost, the outstanding requests are sent
+ * again (go-back-N). This component is only used in user-mode
+ *
+ * @version 0.14
+ * @date 2025-06-25
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum number of outstanding requests
+ *
+ */
+#define PIPELINE_MAXIMUM_WINDOW_SIZE 64
+
+/**
+ * @brief The request ID of the requests that are not pipelined
+ *
+ */
+#define PIPELINE_REQUEST_ID_NOT_PIPELINED 0
+
+/**
+ * @brief The default time (in milliseconds) to wait for the next response
+ * before sending the outstanding requests again
+ *
+ */
+#define PIPELINE_DEFAULT_RESPONSE_TIMEOUT 5000
+
+/**
+ * @brief Maximum number of times that the outstanding requests are sent
+ * again without receiving any response
+ *
+ */
+#define PIPELINE_MAXIMUM_RETRIES 4
+
+/**
+ * @brief An index that doesn't belong to any of the requests
+ *
+ */
+#define PIPELINE_INVALID_INDEX -1
+
+/**
+ * @brief Sends a request
+ * @details Index is the index of the request in the current run and RequestId
+ * should be returned in the response of the request
+ *
+ */
+typedef BOOLEAN (*PIPELINE_SEND_ROUTINE)(PVOID Context, UINT32 Index, UINT32 RequestId);
+
+/**
+ * @brief Waits (up to Timeout milliseconds) until at least one response is
+ * received
+ * @details Returns FALSE if the connection is closed, the expiration of the
+ * timeout is not an error
+ *
+ */
+typedef BOOLEAN (*PIPELINE_WAIT_ROUTINE)(PVOID Context, UINT32 Timeout);
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The state of a window of pipelined requests
+ * @details The requests are sent by one thread and the responses are
+ * completed by another thread
+ *
+ */
+typedef struct _PIPELINE_WINDOW
+{
+    PVOID         Context;                   // Passed to the routines and used by the receiver of the responses
+    UINT32        NextRequestId;             // The ID of the first request of the next run
+    UINT32        FirstRequestId;            // The ID of the first request of the current run
+    UINT32        NumberOfRequests;          // Number of requests of the current run
+    volatile LONG NumberOfSentRequests;      // Number of requests that are sent
+    volatile LONG NumberOfCompletedRequests; // Number of requests that their response is received
+    volatile LONG FirstResentRequest;        // Index of the first request that is sent again
+    volatile LONG LastSkippedResponse;       // Index of the last newer response that is skipped after sending them again
+    volatile LONG IsLossDetected;            // Whether a newer response is received before the next expected one
+    volatile LONG IsActive;                  // Whether a run is in progress or not
+    UINT32        ResponseTimeout;           // Time (in milliseconds) to wait for the next response
+    UINT64        NumberOfResentRequests;    // Requests that are sent again because of a loss or a timeout
+
+} PIPELINE_WINDOW, *PPIPELINE_WINDOW;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+VOID
+PipelineInitialize(PIPELINE_WINDOW * Window);
+
+BOOLEAN
+PipelineRun(PIPELINE_WINDOW *     Window,
+            UINT32                NumberOfRequests,
+            UINT32                WindowSize,
+            PIPELINE_SEND_ROUTINE Send,
+            PIPELINE_WAIT_ROUTINE Wait,
+            PVOID                 Context);
+
+BOOLEAN
+PipelineMatchResponse(PIPELINE_WINDOW * Window, UINT32 RequestId, UINT32 * Index);
+
+VOID
+PipelineCompleteResponse(PIPELINE_WINDOW * Window);
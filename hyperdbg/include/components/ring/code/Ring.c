@@ -0,0 +1,481 @@
+/**
+ * @file Ring.c
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Implementation of the single-producer single-consumer ring buffer
+ * @details Only one producer and one consumer are allowed to access a ring
+ * at the same time. If more than one consumer might drain the ring, then
+ * the consumers should serialize themselves (the producer never waits)
+ *
+ * @version 0.14
+ * @date 2025-06-12
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Compute the size of a record in the ring
+ *
+ * @param BufferLength Length of the body of the record
+ *
+ * @return UINT32
+ */
+UINT32
+RingGetRecordSize(UINT32 BufferLength)
+{
+    //
+    // The header, the body, and a null character which is aligned
+    //
+    return (sizeof(RING_RECORD_HEADER) + BufferLength + 1 + RING_RECORD_ALIGNMENT - 1) & ~(RING_RECORD_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Compute the address of a record in the ring
+ *
+ * @param Ring The ring buffer
+ * @param Index The free-running index
+ *
+ * @return RING_RECORD_HEADER *
+ */
+static RING_RECORD_HEADER *
+RingGetRecord(RING_BUFFER * Ring, UINT64 Index)
+{
+    return (RING_RECORD_HEADER *)(Ring->Buffer + (Index % Ring->Size));
+}
+
+/**
+ * @brief Attach to a ring without changing its indexes
+ * @details Used for accessing a ring that is initialized before (e.g., by
+ * another address space that shares the ring)
+ *
+ * @param Ring The ring buffer
+ * @param ProducerIndex The published index of the producer
+ * @param ConsumerIndex The published index of the consumer
+ * @param Buffer The buffer to hold the records
+ * @param Size Size of the buffer
+ * @param MaximumRecordLength Maximum length of the body of records
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+RingAttach(RING_BUFFER * Ring,
+           RING_INDEX *  ProducerIndex,
+           RING_INDEX *  ConsumerIndex,
+           PVOID         Buffer,
+           UINT32        Size,
+           UINT32        MaximumRecordLength)
+{
+    if (ProducerIndex == NULL ||
+        ConsumerIndex == NULL ||
+        Buffer == NULL ||
+        Size % RING_RECORD_ALIGNMENT != 0 ||
+        Size < 2 * RingGetRecordSize(MaximumRecordLength))
+    {
+        return FALSE;
+    }
+
+    Ring->ProducerIndex       = ProducerIndex;
+    Ring->ConsumerIndex       = ConsumerIndex;
+    Ring->Buffer              = (UINT8 *)Buffer;
+    Ring->Size                = Size;
+    Ring->MaximumRecordLength = MaximumRecordLength;
+
+    return TRUE;
+}
+
+/**
+ * @brief Initialize an empty ring on a previously allocated buffer
+ * @details The size should be aligned to RING_RECORD_ALIGNMENT and it should
+ * be able to hold at least two records with the maximum length
+ *
+ * @param Ring The ring buffer
+ * @param ProducerIndex The published index of the producer
+ * @param ConsumerIndex The published index of the consumer
+ * @param Buffer The buffer to hold the records
+ * @param Size Size of the buffer
+ * @param MaximumRecordLength Maximum length of the body of records
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+RingInitialize(RING_BUFFER * Ring,
+               RING_INDEX *  ProducerIndex,
+               RING_INDEX *  ConsumerIndex,
+               PVOID         Buffer,
+               UINT32        Size,
+               UINT32        MaximumRecordLength)
+{
+    if (!RingAttach(Ring, ProducerIndex, ConsumerIndex, Buffer, Size, MaximumRecordLength))
+    {
+        return FALSE;
+    }
+
+    ProducerIndex->Value = 0;
+    ConsumerIndex->Value = 0;
+
+    return TRUE;
+}
+
+/**
+ * @brief Write a new record into the ring (producer)
+ * @details The record is not visible to the consumer until the producer
+ * index is published. If the record doesn't fit at the end of the ring,
+ * a wrap marker is written and the record is placed at the start of the ring
+ *
+ * @param Ring The ring buffer
+ * @param Record The header of the record (including the length of the body)
+ * @param Buffer The body of the record
+ *
+ * @return BOOLEAN FALSE if the ring is full or the record is too large
+ */
+BOOLEAN
+RingWrite(RING_BUFFER * Ring, const RING_RECORD_HEADER * Record, const VOID * Buffer)
+{
+    UINT64               ProducerIndex;
+    UINT64               ConsumerIndex;
+    UINT32               RecordSize;
+    UINT32               RemainingSize;
+    UINT32               WrapSize     = 0;
+    UINT32               BufferLength = Record->BufferLength;
+    RING_RECORD_HEADER * Header;
+
+    if (BufferLength > Ring->MaximumRecordLength)
+    {
+        return FALSE;
+    }
+
+    RecordSize = RingGetRecordSize(BufferLength);
+
+    //
+    // The producer index is only modified by us, but the consumer index
+    // should be read with acquire semantics, so the consumer finished
+    // reading the records before we reuse their space
+    //
+    ProducerIndex = Ring->ProducerIndex->Value;
+    ConsumerIndex = RING_LOAD_ACQUIRE(&Ring->ConsumerIndex->Value);
+
+    //
+    // Check whether the record fits at the end of the ring or not
+    //
+    RemainingSize = Ring->Size - (UINT32)(ProducerIndex % Ring->Size);
+
+    if (RemainingSize < RecordSize)
+    {
+        WrapSize = RemainingSize;
+    }
+
+    if ((ProducerIndex - ConsumerIndex) + WrapSize + RecordSize > Ring->Size)
+    {
+        //
+        // The ring is full
+        //
+        return FALSE;
+    }
+
+    if (WrapSize != 0)
+    {
+        //
+        // Mark the rest of the ring as unused
+        //
+        Header               = RingGetRecord(Ring, ProducerIndex);
+        Header->BufferLength = RING_RECORD_WRAP_MARKER;
+
+        ProducerIndex += WrapSize;
+    }
+
+    Header = RingGetRecord(Ring, ProducerIndex);
+
+    Header->TimeStamp       = Record->TimeStamp;
+    Header->OperationNumber = Record->OperationNumber;
+    Header->BufferLength    = BufferLength;
+    Header->CoreId          = Record->CoreId;
+    Header->Flags           = Record->Flags;
+
+    memcpy((UINT8 *)Header + sizeof(RING_RECORD_HEADER), Buffer, BufferLength);
+    ((UINT8 *)Header)[sizeof(RING_RECORD_HEADER) + BufferLength] = '\0';
+
+    //
+    // Publish the record (and the wrap marker)
+    //
+    RING_STORE_RELEASE(&Ring->ProducerIndex->Value, ProducerIndex + RecordSize);
+
+    return TRUE;
+}
+
+/**
+ * @brief Get the oldest unread record of the ring without consuming it (consumer)
+ * @details Wrap markers are skipped
+ *
+ * @param Ring The ring buffer
+ *
+ * @return RING_RECORD_HEADER * NULL if the ring is empty
+ */
+RING_RECORD_HEADER *
+RingPeek(RING_BUFFER * Ring)
+{
+    UINT64               ConsumerIndex = Ring->ConsumerIndex->Value;
+    RING_RECORD_HEADER * Header;
+
+    if (RING_LOAD_ACQUIRE(&Ring->ProducerIndex->Value) == ConsumerIndex)
+    {
+        return NULL;
+    }
+
+    Header = RingGetRecord(Ring, ConsumerIndex);
+
+    if (Header->BufferLength == RING_RECORD_WRAP_MARKER)
+    {
+        //
+        // The producer never publishes a wrap marker without the record
+        // after it, so the next record is at the start of the ring
+        //
+        ConsumerIndex += Ring->Size - (UINT32)(ConsumerIndex % Ring->Size);
+        RING_STORE_RELEASE(&Ring->ConsumerIndex->Value, ConsumerIndex);
+
+        Header = RingGetRecord(Ring, ConsumerIndex);
+    }
+
+    return Header;
+}
+
+/**
+ * @brief Release the record that is previously returned by RingPeek (consumer)
+ *
+ * @param Ring The ring buffer
+ *
+ * @return VOID
+ */
+VOID
+RingConsume(RING_BUFFER * Ring)
+{
+    UINT64               ConsumerIndex = Ring->ConsumerIndex->Value;
+    RING_RECORD_HEADER * Header        = RingGetRecord(Ring, ConsumerIndex);
+
+    RING_STORE_RELEASE(&Ring->ConsumerIndex->Value, ConsumerIndex + RingGetRecordSize(Header->BufferLength));
+}
+
+/**
+ * @brief Consume all of the published records (consumer)
+ *
+ * @param Ring The ring buffer
+ *
+ * @return UINT32 Number of discarded records
+ */
+UINT32
+RingDiscardAll(RING_BUFFER * Ring)
+{
+    UINT32 Count = 0;
+
+    while (RingPeek(Ring) != NULL)
+    {
+        RingConsume(Ring);
+        Count++;
+    }
+
+    return Count;
+}
+
+/**
+ * @brief Discard all of the published records by moving the consumer index
+ * to the producer index (consumer)
+ * @details Unlike RingDiscardAll, this function doesn't read the records or
+ * the previous consumer index, so it can be used when the consumer index is
+ * not trusted (e.g., it was written by another address space)
+ *
+ * @param Ring The ring buffer
+ *
+ * @return VOID
+ */
+VOID
+RingResynchronizeConsumer(RING_BUFFER * Ring)
+{
+    RING_STORE_RELEASE(&Ring->ConsumerIndex->Value, RING_LOAD_ACQUIRE(&Ring->ProducerIndex->Value));
+}
+
+/**
+ * @brief Check whether the ring is full or not
+ * @details The ring is considered as full if a record with the maximum length
+ * might not fit into it. The result is exact for the producer and approximate
+ * for others
+ *
+ * @param Ring The ring buffer
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+RingIsFull(RING_BUFFER * Ring)
+{
+    UINT64 UsedSize = RING_LOAD_ACQUIRE(&Ring->ProducerIndex->Value) - RING_LOAD_ACQUIRE(&Ring->ConsumerIndex->Value);
+
+    //
+    // In the worst case, a wrap marker is also needed before the record
+    //
+    return UsedSize + 2 * RingGetRecordSize(Ring->MaximumRecordLength) > Ring->Size;
+}
+
+/**
+ * @brief Check whether the ring is empty or not
+ * @details The result is exact for the consumer and approximate for others
+ *
+ * @param Ring The ring buffer
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+RingIsEmpty(RING_BUFFER * Ring)
+{
+    return RING_LOAD_ACQUIRE(&Ring->ProducerIndex->Value) == RING_LOAD_ACQUIRE(&Ring->ConsumerIndex->Value);
+}
+
+/**
+ * @brief Find the record with the smallest time stamp among the head of
+ * multiple rings (consumer)
+ * @details Used for merging the rings of different producers (e.g., cores)
+ *
+ * @param Rings Array of rings
+ * @param NumberOfRings Number of rings in the array
+ * @param RingIndex Index of the ring that holds the returned record
+ *
+ * @return RING_RECORD_HEADER * NULL if all of the rings are empty
+ */
+RING_RECORD_HEADER *
+RingPeekOldest(RING_BUFFER * Rings, UINT32 NumberOfRings, UINT32 * RingIndex)
+{
+    RING_RECORD_HEADER * Oldest = NULL;
+    RING_RECORD_HEADER * Header;
+
+    for (UINT32 i = 0; i < NumberOfRings; i++)
+    {
+        Header = RingPeek(&Rings[i]);
+
+        if (Header != NULL && (Oldest == NULL || Header->TimeStamp < Oldest->TimeStamp))
+        {
+            Oldest     = Header;
+            *RingIndex = i;
+        }
+    }
+
+    return Oldest;
+}
+
+/**
+ * @brief Get the number of bytes that are used by the records of the ring
+ * @details The result is exact for the producer and the consumer and
+ * approximate for others
+ *
+ * @param Ring The ring buffer
+ *
+ * @return UINT32
+ */
+UINT32
+RingGetUsedSize(RING_BUFFER * Ring)
+{
+    return (UINT32)(RING_LOAD_ACQUIRE(&Ring->ProducerIndex->Value) - RING_LOAD_ACQUIRE(&Ring->ConsumerIndex->Value));
+}
+
+/**
+ * @brief Initialize the state of draining multiple rings fairly
+ * @details The quantum should be at least the size of the largest record
+ * (RingGetRecordSize of the maximum length), so every ring that has records
+ * can send at least one record in each round
+ *
+ * @param Draining The state of draining
+ * @param Deficits An array to hold the deficits of rings (one for each ring)
+ * @param NumberOfRings Number of rings
+ * @param Quantum Bytes that a ring receives at each visit
+ *
+ * @return VOID
+ */
+VOID
+RingInitializeFairDraining(RING_FAIR_DRAINING * Draining, UINT32 * Deficits, UINT32 NumberOfRings, UINT32 Quantum)
+{
+    Draining->CurrentRing = 0;
+    Draining->Quantum     = Quantum;
+    Draining->Deficits    = Deficits;
+
+    memset(Deficits, 0, sizeof(UINT32) * NumberOfRings);
+}
+
+/**
+ * @brief Get the next record of multiple rings by deficit round-robin (consumer)
+ * @details Used for draining the rings of different producers (e.g., cores)
+ * fairly, the record should be released by RingConsumeFair. Records with an
+ * invalid length are returned immediately, so the caller can drop them
+ *
+ * @param Rings Array of rings
+ * @param NumberOfRings Number of rings in the array
+ * @param Draining The state of draining the rings
+ * @param RingIndex Index of the ring that holds the returned record
+ *
+ * @return RING_RECORD_HEADER * NULL if all of the rings are empty
+ */
+RING_RECORD_HEADER *
+RingPeekFair(RING_BUFFER * Rings, UINT32 NumberOfRings, RING_FAIR_DRAINING * Draining, UINT32 * RingIndex)
+{
+    RING_RECORD_HEADER * Header;
+    UINT32               Current;
+
+    //
+    // A quantum covers the largest record, so once the current ring is passed,
+    // it can send its record when it's visited again (after one round)
+    //
+    for (UINT32 i = 0; i <= NumberOfRings; i++)
+    {
+        Current = Draining->CurrentRing;
+        Header  = RingPeek(&Rings[Current]);
+
+        if (Header == NULL)
+        {
+            //
+            // Idle rings don't keep their deficit
+            //
+            Draining->Deficits[Current] = 0;
+        }
+        else if (Header->BufferLength > Rings[Current].MaximumRecordLength ||
+                 Draining->Deficits[Current] >= RingGetRecordSize(Header->BufferLength))
+        {
+            *RingIndex = Current;
+            return Header;
+        }
+
+        //
+        // Visit the next ring and give it a quantum
+        //
+        Current               = (Current + 1) % NumberOfRings;
+        Draining->CurrentRing = Current;
+        Draining->Deficits[Current] += Draining->Quantum;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Release the record that is previously returned by RingPeekFair (consumer)
+ *
+ * @param Rings Array of rings
+ * @param Draining The state of draining the rings
+ * @param RingIndex Index of the ring that holds the record
+ *
+ * @return VOID
+ */
+VOID
+RingConsumeFair(RING_BUFFER * Rings, RING_FAIR_DRAINING * Draining, UINT32 RingIndex)
+{
+    RING_RECORD_HEADER * Header     = RingGetRecord(&Rings[RingIndex], Rings[RingIndex].ConsumerIndex->Value);
+    UINT32               RecordSize = RingGetRecordSize(Header->BufferLength);
+
+    //
+    // Charge the ring for the size of the record
+    //
+    if (Draining->Deficits[RingIndex] > RecordSize)
+    {
+        Draining->Deficits[RingIndex] -= RecordSize;
+    }
+    else
+    {
+        Draining->Deficits[RingIndex] = 0;
+    }
+
+    RingConsume(&Rings[RingIndex]);
+}
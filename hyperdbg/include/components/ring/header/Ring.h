@@ -0,0 +1,180 @@
+/**
+ * @file Ring.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Headers of the single-producer single-consumer ring buffer
+ * @details The ring doesn't use any lock, the producer and the consumer
+ * only publish their indexes with release semantics and read the index of
+ * the other side with acquire semantics. Records have variable lengths and
+ * are packed contiguously in the ring. This component doesn't depend
+ * on any kernel routine so it can be also compiled in user-mode (e.g., for
+ * testing it on other platforms)
+ *
+ * @version 0.14
+ * @date 2025-06-12
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Size of a cache line (used to avoid false sharing between the indexes)
+ *
+ */
+#define RING_CACHE_LINE_SIZE 64
+
+/**
+ * @brief Alignment of records in the ring
+ * @details Should be at least the end offset of BufferLength in RING_RECORD_HEADER,
+ * so the remaining space at the end of the ring can always hold a wrap marker
+ *
+ */
+#define RING_RECORD_ALIGNMENT 16
+
+/**
+ * @brief The length of the record that shows the rest of the ring is
+ * not used and the next record is at the start of the ring
+ *
+ */
+#define RING_RECORD_WRAP_MARKER 0xffffffff
+
+//
+// Acquire and release primitives
+//
+#if defined(_MSC_VER)
+#    define RING_LOAD_ACQUIRE(Index)         ((UINT64)ReadAcquire64((volatile LONG64 *)(Index)))
+#    define RING_STORE_RELEASE(Index, Value) WriteRelease64((volatile LONG64 *)(Index), (LONG64)(Value))
+#else
+#    define RING_LOAD_ACQUIRE(Index)         __atomic_load_n((Index), __ATOMIC_ACQUIRE)
+#    define RING_STORE_RELEASE(Index, Value) __atomic_store_n((Index), (Value), __ATOMIC_RELEASE)
+#endif
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The header of each record in the ring
+ * @details The body of the record comes right after this header and
+ * it's always followed by a null character. If BufferLength is equal to
+ * RING_RECORD_WRAP_MARKER, then the record is a wrap marker
+ *
+ */
+typedef struct _RING_RECORD_HEADER
+{
+    UINT64 TimeStamp;       // Time stamp of the record (used for merging different rings)
+    UINT32 OperationNumber; // Operation ID of the record
+    UINT32 BufferLength;    // Length of the body
+    UINT32 CoreId;          // The core that wrote the record
+    UINT32 Flags;           // Flags of the record (defined by the user of the ring)
+
+} RING_RECORD_HEADER, *PRING_RECORD_HEADER;
+
+/**
+ * @brief A published index of the ring
+ * @details Each index takes a separate cache line to avoid false sharing
+ *
+ */
+typedef struct _RING_INDEX
+{
+    volatile UINT64 Value;
+    UINT8           Padding[RING_CACHE_LINE_SIZE - sizeof(UINT64)];
+
+} RING_INDEX, *PRING_INDEX;
+
+/**
+ * @brief Single-producer single-consumer ring buffer
+ * @details Indexes are free-running byte counters, the offset of an index
+ * in the buffer is computed by the modulo of the size of the ring. The
+ * indexes are kept apart from the ring, so the caller can place them in
+ * pages that are shared with another address space (e.g., the consumer
+ * index in a page that is writable by user-mode)
+ *
+ */
+typedef struct _RING_BUFFER
+{
+    RING_INDEX * ProducerIndex;       // Only written by the producer
+    RING_INDEX * ConsumerIndex;       // Only written by the consumer
+    UINT8 *      Buffer;              // Start address of the ring
+    UINT32       Size;                // Size of the ring (in bytes)
+    UINT32       MaximumRecordLength; // Maximum length of the body of records
+
+} RING_BUFFER, *PRING_BUFFER;
+
+/**
+ * @brief The state of draining multiple rings fairly (deficit round-robin)
+ * @details Each ring that has records receives a quantum (in bytes) when it's
+ * visited and it can send records as long as its deficit covers their size,
+ * so a ring that is flooded by its producer can't starve the other rings
+ *
+ */
+typedef struct _RING_FAIR_DRAINING
+{
+    UINT32   CurrentRing; // The ring that is being drained
+    UINT32   Quantum;     // Bytes that a ring receives at each visit
+    UINT32 * Deficits;    // Remaining bytes of each ring in the current round
+
+} RING_FAIR_DRAINING, *PRING_FAIR_DRAINING;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+UINT32
+RingGetRecordSize(UINT32 BufferLength);
+
+BOOLEAN
+RingAttach(RING_BUFFER * Ring,
+           RING_INDEX *  ProducerIndex,
+           RING_INDEX *  ConsumerIndex,
+           PVOID         Buffer,
+           UINT32        Size,
+           UINT32        MaximumRecordLength);
+
+BOOLEAN
+RingInitialize(RING_BUFFER * Ring,
+               RING_INDEX *  ProducerIndex,
+               RING_INDEX *  ConsumerIndex,
+               PVOID         Buffer,
+               UINT32        Size,
+               UINT32        MaximumRecordLength);
+
+BOOLEAN
+RingWrite(RING_BUFFER * Ring, const RING_RECORD_HEADER * Record, const VOID * Buffer);
+
+RING_RECORD_HEADER *
+RingPeek(RING_BUFFER * Ring);
+
+VOID
+RingConsume(RING_BUFFER * Ring);
+
+UINT32
+RingDiscardAll(RING_BUFFER * Ring);
+
+VOID
+RingResynchronizeConsumer(RING_BUFFER * Ring);
+
+BOOLEAN
+RingIsFull(RING_BUFFER * Ring);
+
+BOOLEAN
+RingIsEmpty(RING_BUFFER * Ring);
+
+RING_RECORD_HEADER *
+RingPeekOldest(RING_BUFFER * Rings, UINT32 NumberOfRings, UINT32 * RingIndex);
+
+UINT32
+RingGetUsedSize(RING_BUFFER * Ring);
+
+VOID
+RingInitializeFairDraining(RING_FAIR_DRAINING * Draining, UINT32 * Deficits, UINT32 NumberOfRings, UINT32 Quantum);
+
+RING_RECORD_HEADER *
+RingPeekFair(RING_BUFFER * Rings, UINT32 NumberOfRings, RING_FAIR_DRAINING * Draining, UINT32 * RingIndex);
+
+VOID
+RingConsumeFair(RING_BUFFER * Rings, RING_FAIR_DRAINING * Draining, UINT32 RingIndex);
@@ -0,0 +1,262 @@
+/**
+ * @file Search.c
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Implementation of the multi-pattern search of the memory blocks
+ * @details Each eight bytes of the block are compared with the first element
+ * of all of the patterns at once (SWAR), and only the positions that pass this
+ * filter are compared with the whole patterns
+ *
+ * @version 0.14
+ * @date 2025-06-27
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief The lowest bit of each byte
+ *
+ */
+#define SEARCH_LOW_BITS 0x0101010101010101
+
+/**
+ * @brief The highest bit of each byte
+ *
+ */
+#define SEARCH_HIGH_BITS 0x8080808080808080
+
+/**
+ * @brief Initialize the patterns of a search
+ *
+ * @param Patterns
+ * @param ElementSize Size of each element (1, 4 or 8)
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+SearchInitializePatterns(SEARCH_PATTERNS * Patterns, UINT32 ElementSize)
+{
+    if (ElementSize != sizeof(UINT8) && ElementSize != sizeof(UINT32) && ElementSize != sizeof(UINT64))
+    {
+        return FALSE;
+    }
+
+    memset(Patterns, 0, sizeof(SEARCH_PATTERNS));
+
+    Patterns->ElementSize = ElementSize;
+
+    return TRUE;
+}
+
+/**
+ * @brief Add a pattern to the search
+ * @details Each element is saved in a separate UINT64 (same as the buffer
+ * of the 's*' commands), only the low bytes of the element size are used
+ *
+ * @param Patterns
+ * @param Elements
+ * @param NumberOfElements
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+SearchAddPattern(SEARCH_PATTERNS * Patterns, const UINT64 * Elements, UINT32 NumberOfElements)
+{
+    UINT32 Index  = Patterns->NumberOfPatterns;
+    UINT32 Length = NumberOfElements * Patterns->ElementSize;
+
+    if (Index >= SEARCH_MAXIMUM_PATTERNS ||
+        NumberOfElements == 0 ||
+        NumberOfElements > SEARCH_MAXIMUM_PATTERN_BYTES ||
+        Patterns->UsedBytes + Length > SEARCH_MAXIMUM_PATTERN_BYTES)
+    {
+        return FALSE;
+    }
+
+    //
+    // The elements are little-endian in the memory
+    //
+    for (UINT32 i = 0; i < NumberOfElements; i++)
+    {
+        memcpy(&Patterns->Bytes[Patterns->UsedBytes + i * Patterns->ElementSize], &Elements[i], Patterns->ElementSize);
+    }
+
+    if (Patterns->ElementSize == sizeof(UINT8))
+    {
+        Patterns->FirstElements[Index] = (Elements[0] & 0xff) * SEARCH_LOW_BITS;
+    }
+    else if (Patterns->ElementSize == sizeof(UINT32))
+    {
+        Patterns->FirstElements[Index] = Elements[0] & 0xffffffff;
+    }
+    else
+    {
+        Patterns->FirstElements[Index] = Elements[0];
+    }
+
+    Patterns->Offsets[Index] = Patterns->UsedBytes;
+    Patterns->Lengths[Index] = Length;
+    Patterns->UsedBytes += Length;
+    Patterns->NumberOfPatterns++;
+
+    if (Length > Patterns->MaximumLength)
+    {
+        Patterns->MaximumLength = Length;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Find the positions of eight bytes that might be the start of a pattern
+ * @details The highest bit of each candidate byte is set, for bytes a zero
+ * byte of the difference is detected by the borrow of the subtraction (which
+ * might also mark the next bytes, they're removed by the verification)
+ *
+ * @param Patterns
+ * @param Word Eight bytes of the block
+ *
+ * @return UINT64
+ */
+static UINT64
+SearchFilterWord(const SEARCH_PATTERNS * Patterns, UINT64 Word)
+{
+    UINT64 Candidates = 0;
+    UINT64 Difference;
+
+    for (UINT32 i = 0; i < Patterns->NumberOfPatterns; i++)
+    {
+        if (Patterns->ElementSize == sizeof(UINT8))
+        {
+            Difference = Word ^ Patterns->FirstElements[i];
+            Candidates |= (Difference - SEARCH_LOW_BITS) & ~Difference & SEARCH_HIGH_BITS;
+        }
+        else if (Patterns->ElementSize == sizeof(UINT32))
+        {
+            if ((UINT32)Word == (UINT32)Patterns->FirstElements[i])
+            {
+                Candidates |= (UINT64)0x80;
+            }
+
+            if ((UINT32)(Word >> 32) == (UINT32)Patterns->FirstElements[i])
+            {
+                Candidates |= (UINT64)0x80 << 32;
+            }
+        }
+        else if (Word == Patterns->FirstElements[i])
+        {
+            Candidates |= (UINT64)0x80;
+        }
+    }
+
+    return Candidates;
+}
+
+/**
+ * @brief Check whether one of the patterns starts at the position or not
+ * @details Each position is reported once (for the first matching pattern)
+ *
+ * @param Patterns
+ * @param Buffer
+ * @param Position
+ * @param BufferLength
+ * @param BaseAddress
+ * @param Match
+ * @param Context
+ *
+ * @return BOOLEAN FALSE if the search should be stopped
+ */
+static BOOLEAN
+SearchVerifyPosition(const SEARCH_PATTERNS * Patterns,
+                     const UINT8 *           Buffer,
+                     UINT32                  Position,
+                     UINT32                  BufferLength,
+                     UINT64                  BaseAddress,
+                     SEARCH_MATCH_ROUTINE    Match,
+                     PVOID                   Context)
+{
+    for (UINT32 i = 0; i < Patterns->NumberOfPatterns; i++)
+    {
+        if (Patterns->Lengths[i] <= BufferLength - Position &&
+            memcmp(&Buffer[Position], &Patterns->Bytes[Patterns->Offsets[i]], Patterns->Lengths[i]) == 0)
+        {
+            return Match(Context, BaseAddress + Position, i);
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Search a block for all of the patterns
+ * @details The patterns start at the positions before ScanLength that are
+ * multiples of the element size, the bytes after ScanLength are only used
+ * by the patterns that start before it (so the next block could start at
+ * ScanLength)
+ *
+ * @param Patterns
+ * @param Buffer The block
+ * @param ScanLength Length of the positions that are searched
+ * @param BufferLength Length of the block
+ * @param BaseAddress Address of the block (reported to the match routine)
+ * @param Match Routine that is called for each match
+ * @param Context Passed to the match routine
+ *
+ * @return BOOLEAN FALSE if the search is stopped by the match routine
+ */
+BOOLEAN
+SearchScanBlock(const SEARCH_PATTERNS * Patterns,
+                const UINT8 *           Buffer,
+                UINT32                  ScanLength,
+                UINT32                  BufferLength,
+                UINT64                  BaseAddress,
+                SEARCH_MATCH_ROUTINE    Match,
+                PVOID                   Context)
+{
+    UINT32 Position = 0;
+    UINT64 Word;
+    UINT64 Candidates;
+
+    if (ScanLength > BufferLength)
+    {
+        ScanLength = BufferLength;
+    }
+
+    //
+    // Filter eight bytes at once
+    //
+    while (ScanLength - Position >= sizeof(UINT64))
+    {
+        memcpy(&Word, &Buffer[Position], sizeof(UINT64));
+
+        Candidates = SearchFilterWord(Patterns, Word);
+
+        if (Candidates != 0)
+        {
+            for (UINT32 ByteIndex = 0; ByteIndex < sizeof(UINT64); ByteIndex += Patterns->ElementSize)
+            {
+                if ((Candidates & ((UINT64)0x80 << (ByteIndex * 8))) &&
+                    !SearchVerifyPosition(Patterns, Buffer, Position + ByteIndex, BufferLength, BaseAddress, Match, Context))
+                {
+                    return FALSE;
+                }
+            }
+        }
+
+        Position += sizeof(UINT64);
+    }
+
+    //
+    // The remaining positions are verified directly
+    //
+    for (; Position < ScanLength; Position += Patterns->ElementSize)
+    {
+        if (!SearchVerifyPosition(Patterns, Buffer, Position, BufferLength, BaseAddress, Match, Context))
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
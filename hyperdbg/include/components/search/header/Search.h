@@ -0,0 +1,83 @@
+/**
+ * @file Search.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Headers of the multi-pattern search of the memory blocks
+ * @details The memory is read in blocks and each block is scanned for all
+ * of the patterns in one pass. Eight bytes are filtered at once in a general
+ * purpose register (the vmx-root mode doesn't save the XMM registers of the
+ * guest, so SSE is not used) and the candidates are verified afterwards.
+ * This component doesn't depend on any kernel routine and can be also
+ * compiled in user-mode
+ *
+ * @version 0.14
+ * @date 2025-06-27
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum number of patterns that are searched in one pass
+ *
+ */
+#define SEARCH_MAXIMUM_PATTERNS 8
+
+/**
+ * @brief Maximum size of all of the patterns (in bytes)
+ *
+ */
+#define SEARCH_MAXIMUM_PATTERN_BYTES 1024
+
+/**
+ * @brief Called for each position that matches one of the patterns
+ * @details Returns FALSE to stop the search
+ *
+ */
+typedef BOOLEAN (*SEARCH_MATCH_ROUTINE)(PVOID Context, UINT64 Address, UINT32 PatternIndex);
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The patterns of a search
+ * @details Each pattern is a sequence of elements (byte, dword or qword)
+ * and the patterns are only matched on the multiples of the element size
+ *
+ */
+typedef struct _SEARCH_PATTERNS
+{
+    UINT32 ElementSize;                            // 1, 4 or 8
+    UINT32 NumberOfPatterns;                       // Number of the added patterns
+    UINT32 MaximumLength;                          // Length of the longest pattern (in bytes)
+    UINT32 UsedBytes;                              // Used bytes of the Bytes buffer
+    UINT32 Offsets[SEARCH_MAXIMUM_PATTERNS];       // Offset of each pattern in the Bytes buffer
+    UINT32 Lengths[SEARCH_MAXIMUM_PATTERNS];       // Length of each pattern (in bytes)
+    UINT64 FirstElements[SEARCH_MAXIMUM_PATTERNS]; // First element of each pattern (repeated in each byte for bytes)
+    UINT8  Bytes[SEARCH_MAXIMUM_PATTERN_BYTES];    // The bytes of the patterns
+
+} SEARCH_PATTERNS, *PSEARCH_PATTERNS;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+SearchInitializePatterns(SEARCH_PATTERNS * Patterns, UINT32 ElementSize);
+
+BOOLEAN
+SearchAddPattern(SEARCH_PATTERNS * Patterns, const UINT64 * Elements, UINT32 NumberOfElements);
+
+BOOLEAN
+SearchScanBlock(const SEARCH_PATTERNS * Patterns,
+                const UINT8 *           Buffer,
+                UINT32                  ScanLength,
+                UINT32                  BufferLength,
+                UINT64                  BaseAddress,
+                SEARCH_MATCH_ROUTINE    Match,
+                PVOID                   Context);
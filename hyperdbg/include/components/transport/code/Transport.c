@@ -0,0 +1,163 @@
+/**
+ * @file Transport.c
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Implementation of the transports of the kernel debugger
+ * @details The routines of the backends are called through the table of
+ * the transport, this file doesn't depend on the platform
+ *
+ * @version 0.14
+ * @date 2025-06-30
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Initialize a transport
+ * @details Called by the backends, the handle and the contexts are only
+ * used by the routines of the backend
+ *
+ * @param Transport
+ * @param Routines The routines of the backend
+ * @param Type
+ * @param Handle
+ * @param ReadContext
+ * @param WriteContext
+ *
+ * @return VOID
+ */
+VOID
+TransportInitialize(TRANSPORT *                Transport,
+                    const TRANSPORT_ROUTINES * Routines,
+                    TRANSPORT_TYPE             Type,
+                    PVOID                      Handle,
+                    PVOID                      ReadContext,
+                    PVOID                      WriteContext)
+{
+    Transport->Routines     = Routines;
+    Transport->Type         = Type;
+    Transport->Handle       = Handle;
+    Transport->ReadContext  = ReadContext;
+    Transport->WriteContext = WriteContext;
+}
+
+/**
+ * @brief Check whether the transport is open or not
+ *
+ * @param Transport
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TransportIsOpen(const TRANSPORT * Transport)
+{
+    return Transport->Routines != NULL;
+}
+
+/**
+ * @brief Send all of the bytes
+ *
+ * @param Transport
+ * @param Buffer
+ * @param Length
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TransportSend(TRANSPORT * Transport, const VOID * Buffer, UINT32 Length)
+{
+    return Transport->Routines->Send(Transport, Buffer, Length);
+}
+
+/**
+ * @brief Receive up to Length bytes
+ *
+ * @param Transport
+ * @param Buffer
+ * @param Length
+ * @param BytesReceived
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TransportReceive(TRANSPORT * Transport, VOID * Buffer, UINT32 Length, UINT32 * BytesReceived)
+{
+    return Transport->Routines->Receive(Transport, Buffer, Length, BytesReceived);
+}
+
+/**
+ * @brief Receive all of the bytes
+ * @details The reads that return no byte (timeouts) are retried
+ *
+ * @param Transport
+ * @param Buffer
+ * @param Length
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TransportReceiveAll(TRANSPORT * Transport, VOID * Buffer, UINT32 Length)
+{
+    UINT32 Offset = 0;
+    UINT32 BytesReceived;
+
+    while (Offset < Length)
+    {
+        if (!Transport->Routines->Receive(Transport, (CHAR *)Buffer + Offset, Length - Offset, &BytesReceived))
+        {
+            return FALSE;
+        }
+
+        Offset += BytesReceived;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Discard the bytes that are not received yet
+ *
+ * @param Transport
+ *
+ * @return VOID
+ */
+VOID
+TransportFlush(TRANSPORT * Transport)
+{
+    Transport->Routines->Flush(Transport);
+}
+
+/**
+ * @brief Wait until bytes become available
+ *
+ * @param Transport
+ * @param Timeout In milliseconds (or TRANSPORT_WAIT_INFINITE)
+ *
+ * @return BOOLEAN FALSE if the timeout is expired
+ */
+BOOLEAN
+TransportPoll(TRANSPORT * Transport, UINT32 Timeout)
+{
+    return Transport->Routines->Poll(Transport, Timeout);
+}
+
+/**
+ * @brief Close the transport
+ *
+ * @param Transport
+ *
+ * @return VOID
+ */
+VOID
+TransportClose(TRANSPORT * Transport)
+{
+    if (Transport->Routines == NULL)
+    {
+        return;
+    }
+
+    Transport->Routines->Close(Transport);
+
+    TransportInitialize(Transport, NULL, TRANSPORT_TYPE_NONE, NULL, NULL, NULL);
+}
@@ -0,0 +1,368 @@
+/**
+ * @file TransportHandle.c
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief The serial port and the named pipe backends of the transports
+ * @details The serial ports and the named pipes are used through their
+ * handles (overlapped in the debugger and synchronous in the debuggee)
+ *
+ * @version 0.14
+ * @date 2025-07-20
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#ifdef ENV_WINDOWS
+
+/**
+ * @brief Size of the buffer that the discarded bytes are read into
+ *
+ */
+#    define TRANSPORT_FLUSH_BUFFER_SIZE 256
+
+/**
+ * @brief The OVERLAPPED of the reads (NULL for the synchronous handles)
+ *
+ */
+#    define TRANSPORT_READ_OVERLAPPED(Transport) ((OVERLAPPED *)(Transport)->ReadContext)
+
+/**
+ * @brief The OVERLAPPED of the writes (NULL for the synchronous handles)
+ *
+ */
+#    define TRANSPORT_WRITE_OVERLAPPED(Transport) ((OVERLAPPED *)(Transport)->WriteContext)
+
+//////////////////////////////////////////////////
+//		    Serial Ports and Named Pipes		//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Get the number of bytes that are available on a handle
+ *
+ * @param Transport
+ *
+ * @return UINT32
+ */
+static UINT32
+TransportHandleBytesAvailable(TRANSPORT * Transport)
+{
+    COMSTAT Stat           = {0};
+    DWORD   Errors         = 0;
+    DWORD   BytesAvailable = 0;
+
+    if (Transport->Type == TRANSPORT_TYPE_SERIAL)
+    {
+        return ClearCommError(Transport->Handle, &Errors, &Stat) ? Stat.cbInQue : 0;
+    }
+
+    return PeekNamedPipe(Transport->Handle, NULL, 0, NULL, &BytesAvailable, NULL) ? BytesAvailable : 0;
+}
+
+/**
+ * @brief Send bytes to a serial port or a named pipe
+ *
+ * @param Transport
+ * @param Buffer
+ * @param Length
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TransportHandleSend(TRANSPORT * Transport, const VOID * Buffer, UINT32 Length)
+{
+    DWORD   BytesWritten = 0;
+    BOOLEAN Result;
+
+    if (TRANSPORT_WRITE_OVERLAPPED(Transport) == NULL)
+    {
+        return WriteFile(Transport->Handle, Buffer, Length, &BytesWritten, NULL) && BytesWritten == Length;
+    }
+
+    if (WriteFile(Transport->Handle, Buffer, Length, NULL, TRANSPORT_WRITE_OVERLAPPED(Transport)))
+    {
+        //
+        // Write completed
+        //
+        ResetEvent(TRANSPORT_WRITE_OVERLAPPED(Transport)->hEvent);
+        return TRUE;
+    }
+
+    if (GetLastError() != ERROR_IO_PENDING)
+    {
+        return FALSE;
+    }
+
+    //
+    // Wait until write completed
+    //
+    Result = WaitForSingleObject(TRANSPORT_WRITE_OVERLAPPED(Transport)->hEvent, INFINITE) == WAIT_OBJECT_0 &&
+             GetOverlappedResult(Transport->Handle, TRANSPORT_WRITE_OVERLAPPED(Transport), &BytesWritten, FALSE);
+
+    ResetEvent(TRANSPORT_WRITE_OVERLAPPED(Transport)->hEvent);
+
+    return Result;
+}
+
+/**
+ * @brief Receive bytes from a serial port or a named pipe
+ *
+ * @param Transport
+ * @param Buffer
+ * @param Length
+ * @param BytesReceived
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TransportHandleReceive(TRANSPORT * Transport, VOID * Buffer, UINT32 Length, UINT32 * BytesReceived)
+{
+    DWORD NoBytesRead = 0;
+
+    *BytesReceived = 0;
+
+    if (TRANSPORT_READ_OVERLAPPED(Transport) == NULL)
+    {
+        //
+        // Synchronous reads might return no byte because of the timeouts
+        //
+        if (!ReadFile(Transport->Handle, Buffer, Length, &NoBytesRead, NULL))
+        {
+            return FALSE;
+        }
+
+        *BytesReceived = NoBytesRead;
+        return TRUE;
+    }
+
+    if (!ReadFile(Transport->Handle, Buffer, Length, NULL, TRANSPORT_READ_OVERLAPPED(Transport)) &&
+        GetLastError() != ERROR_IO_PENDING)
+    {
+        return FALSE;
+    }
+
+    //
+    // Wait till the bytes become available
+    //
+    WaitForSingleObject(TRANSPORT_READ_OVERLAPPED(Transport)->hEvent, INFINITE);
+
+    //
+    // Messages of named pipes might be read partially
+    //
+    if (!GetOverlappedResult(Transport->Handle, TRANSPORT_READ_OVERLAPPED(Transport), &NoBytesRead, FALSE) &&
+        GetLastError() != ERROR_MORE_DATA)
+    {
+        ResetEvent(TRANSPORT_READ_OVERLAPPED(Transport)->hEvent);
+        return FALSE;
+    }
+
+    //
+    // Reset event for next try
+    //
+    ResetEvent(TRANSPORT_READ_OVERLAPPED(Transport)->hEvent);
+
+    *BytesReceived = NoBytesRead;
+
+    return TRUE;
+}
+
+/**
+ * @brief Discard the bytes of a serial port or a named pipe
+ *
+ * @param Transport
+ *
+ * @return VOID
+ */
+static VOID
+TransportHandleFlush(TRANSPORT * Transport)
+{
+    UINT8  Buffer[TRANSPORT_FLUSH_BUFFER_SIZE];
+    UINT32 BytesAvailable;
+    UINT32 BytesReceived;
+
+    if (Transport->Type == TRANSPORT_TYPE_SERIAL)
+    {
+        PurgeComm(Transport->Handle, PURGE_RXCLEAR | PURGE_TXCLEAR | PURGE_RXABORT | PURGE_TXABORT);
+        return;
+    }
+
+    while ((BytesAvailable = TransportHandleBytesAvailable(Transport)) != 0)
+    {
+        if (!TransportHandleReceive(Transport,
+                                    Buffer,
+                                    BytesAvailable < sizeof(Buffer) ? BytesAvailable : (UINT32)sizeof(Buffer),
+                                    &BytesReceived) ||
+            BytesReceived == 0)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Wait on the read event of an overlapped serial port or named pipe
+ * @details The serial ports wait for a comm event and the named pipes issue a
+ * zero-byte read, both complete once a byte arrives. The read overlapped is
+ * shared with the receive as both are called from the same thread
+ *
+ * @param Transport
+ * @param Timeout In milliseconds
+ *
+ * @return BOOLEAN FALSE if the wait could not be started
+ */
+static BOOLEAN
+TransportHandleWaitForBytes(TRANSPORT * Transport, UINT32 Timeout)
+{
+    OVERLAPPED * Overlapped = TRANSPORT_READ_OVERLAPPED(Transport);
+    DWORD        EventMask  = 0;
+    DWORD        Bytes      = 0;
+    BYTE         Dummy      = 0;
+    BOOL         IsCompleted;
+
+    if (Transport->Type == TRANSPORT_TYPE_SERIAL)
+    {
+        SetCommMask(Transport->Handle, EV_RXCHAR);
+
+        //
+        // The bytes that arrived before the mask is set don't raise an event
+        //
+        if (TransportHandleBytesAvailable(Transport) != 0)
+        {
+            return TRUE;
+        }
+
+        IsCompleted = WaitCommEvent(Transport->Handle, &EventMask, Overlapped);
+    }
+    else
+    {
+        IsCompleted = ReadFile(Transport->Handle, &Dummy, 0, NULL, Overlapped);
+    }
+
+    if (!IsCompleted)
+    {
+        if (GetLastError() != ERROR_IO_PENDING)
+        {
+            return FALSE;
+        }
+
+        if (WaitForSingleObject(Overlapped->hEvent, Timeout == TRANSPORT_WAIT_INFINITE ? INFINITE : Timeout) != WAIT_OBJECT_0)
+        {
+            //
+            // Nothing has arrived, the pending wait should not outlive the call
+            //
+            CancelIoEx(Transport->Handle, Overlapped);
+        }
+
+        //
+        // Wait for the completion (or the cancellation) of the request
+        //
+        GetOverlappedResult(Transport->Handle, Overlapped, &Bytes, TRUE);
+    }
+
+    ResetEvent(Overlapped->hEvent);
+
+    return TRUE;
+}
+
+/**
+ * @brief Wait until bytes become available on a serial port or a named pipe
+ * @details The overlapped handles and the synchronous serial ports wait for
+ * the bytes on events, the synchronous named pipes with a timeout are checked
+ * each millisecond
+ *
+ * @param Transport
+ * @param Timeout In milliseconds
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TransportHandlePoll(TRANSPORT * Transport, UINT32 Timeout)
+{
+    UINT64 StartTime = PlatformGetTickCount64();
+    UINT64 Elapsed   = 0;
+    DWORD  EventMask = 0;
+
+    while (TransportHandleBytesAvailable(Transport) == 0)
+    {
+        if (Timeout != TRANSPORT_WAIT_INFINITE)
+        {
+            Elapsed = PlatformGetTickCount64() - StartTime;
+
+            if (Elapsed >= Timeout)
+            {
+                return FALSE;
+            }
+        }
+
+        if (TRANSPORT_READ_OVERLAPPED(Transport) != NULL)
+        {
+            if (TransportHandleWaitForBytes(Transport,
+                                            Timeout == TRANSPORT_WAIT_INFINITE ? TRANSPORT_WAIT_INFINITE : (UINT32)(Timeout - Elapsed)))
+            {
+                continue;
+            }
+        }
+        else if (Timeout == TRANSPORT_WAIT_INFINITE && Transport->Type == TRANSPORT_TYPE_SERIAL)
+        {
+            //
+            // Errors of the comm events can be ignored (the bytes are read anyway)
+            //
+            SetCommMask(Transport->Handle, EV_RXCHAR);
+            WaitCommEvent(Transport->Handle, &EventMask, NULL);
+
+            return TRUE;
+        }
+
+        Sleep(1);
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Close a serial port or a named pipe
+ *
+ * @param Transport
+ *
+ * @return VOID
+ */
+static VOID
+TransportHandleClose(TRANSPORT * Transport)
+{
+    CloseHandle(Transport->Handle);
+}
+
+/**
+ * @brief The routines of the serial ports and the named pipes
+ *
+ */
+static const TRANSPORT_ROUTINES TransportHandleRoutines = {
+    TransportHandleSend,
+    TransportHandleReceive,
+    TransportHandleFlush,
+    TransportHandlePoll,
+    TransportHandleClose,
+};
+
+/**
+ * @brief Initialize a transport over a serial port or a named pipe
+ *
+ * @param Transport
+ * @param Handle
+ * @param Type TRANSPORT_TYPE_SERIAL or TRANSPORT_TYPE_NAMED_PIPE
+ * @param ReadOverlapped NULL if the handle is synchronous
+ * @param WriteOverlapped NULL if the handle is synchronous
+ *
+ * @return VOID
+ */
+VOID
+TransportInitializeHandle(TRANSPORT *    Transport,
+                          HANDLE         Handle,
+                          TRANSPORT_TYPE Type,
+                          OVERLAPPED *   ReadOverlapped,
+                          OVERLAPPED *   WriteOverlapped)
+{
+    TransportInitialize(Transport, &TransportHandleRoutines, Type, Handle, ReadOverlapped, WriteOverlapped);
+}
+
+#endif // ENV_WINDOWS
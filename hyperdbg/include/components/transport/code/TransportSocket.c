@@ -0,0 +1,416 @@
+/**
+ * @file TransportSocket.c
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief The socket backend of the transports
+ * @details The sockets are used in the blocking mode, so the listening
+ * thread could receive while another thread sends. The same routines are
+ * used for Winsock and the POSIX sockets
+ *
+ * @version 0.14
+ * @date 2025-07-20
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Size of the buffer that the discarded bytes are read into
+ *
+ */
+#define TRANSPORT_FLUSH_BUFFER_SIZE 256
+
+/**
+ * @brief The socket of a transport
+ *
+ */
+#define TRANSPORT_SOCKET_OF(Transport) ((TRANSPORT_SOCKET)(SIZE_T)(Transport)->Handle)
+
+#ifdef ENV_WINDOWS
+
+/**
+ * @brief Flags of the sends
+ *
+ */
+#    define TRANSPORT_SOCKET_SEND_FLAGS 0
+
+/**
+ * @brief Number of the available bytes of a socket
+ *
+ */
+typedef u_long TRANSPORT_SOCKET_BYTES_AVAILABLE;
+
+#else
+
+/**
+ * @brief Flags of the sends (a closed connection fails the send instead of
+ * raising SIGPIPE)
+ *
+ */
+#    define TRANSPORT_SOCKET_SEND_FLAGS MSG_NOSIGNAL
+
+/**
+ * @brief Number of the available bytes of a socket
+ *
+ */
+typedef int TRANSPORT_SOCKET_BYTES_AVAILABLE;
+
+/**
+ * @brief The same names as Winsock
+ *
+ */
+#    define SOCKET_ERROR -1
+#    define SD_BOTH      SHUT_RDWR
+#    define closesocket  close
+#    define ioctlsocket  ioctl
+
+#endif
+
+//////////////////////////////////////////////////
+//					  Sockets					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Take a reference of Winsock
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TransportSocketStartup()
+{
+#ifdef ENV_WINDOWS
+    WSADATA WsaData;
+
+    return WSAStartup(MAKEWORD(2, 2), &WsaData) == 0;
+#else
+    return TRUE;
+#endif
+}
+
+/**
+ * @brief Release a reference of Winsock
+ *
+ * @return VOID
+ */
+static VOID
+TransportSocketCleanup()
+{
+#ifdef ENV_WINDOWS
+    WSACleanup();
+#endif
+}
+
+/**
+ * @brief Send bytes to a socket
+ *
+ * @param Transport
+ * @param Buffer
+ * @param Length
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TransportSocketSend(TRANSPORT * Transport, const VOID * Buffer, UINT32 Length)
+{
+    UINT32 Offset = 0;
+    int    BytesSent;
+
+    while (Offset < Length)
+    {
+        BytesSent = send(TRANSPORT_SOCKET_OF(Transport),
+                         (const CHAR *)Buffer + Offset,
+                         (int)(Length - Offset),
+                         TRANSPORT_SOCKET_SEND_FLAGS);
+
+        if (BytesSent == SOCKET_ERROR)
+        {
+            return FALSE;
+        }
+
+        Offset += BytesSent;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Receive bytes from a socket
+ *
+ * @param Transport
+ * @param Buffer
+ * @param Length
+ * @param BytesReceived
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TransportSocketReceive(TRANSPORT * Transport, VOID * Buffer, UINT32 Length, UINT32 * BytesReceived)
+{
+    int Result = recv(TRANSPORT_SOCKET_OF(Transport), (CHAR *)Buffer, (int)Length, 0);
+
+    //
+    // Zero means that the other side closed the connection
+    //
+    if (Result <= 0)
+    {
+        *BytesReceived = 0;
+        return FALSE;
+    }
+
+    *BytesReceived = Result;
+
+    return TRUE;
+}
+
+/**
+ * @brief Discard the bytes of a socket
+ *
+ * @param Transport
+ *
+ * @return VOID
+ */
+static VOID
+TransportSocketFlush(TRANSPORT * Transport)
+{
+    CHAR                             Buffer[TRANSPORT_FLUSH_BUFFER_SIZE];
+    TRANSPORT_SOCKET_BYTES_AVAILABLE BytesAvailable = 0;
+
+    while (ioctlsocket(TRANSPORT_SOCKET_OF(Transport), FIONREAD, &BytesAvailable) == 0 && BytesAvailable != 0)
+    {
+        if (recv(TRANSPORT_SOCKET_OF(Transport),
+                 Buffer,
+                 (UINT32)BytesAvailable < sizeof(Buffer) ? (int)BytesAvailable : (int)sizeof(Buffer),
+                 0) <= 0)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Wait until bytes become available on a socket
+ *
+ * @param Transport
+ * @param Timeout In milliseconds
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+TransportSocketPoll(TRANSPORT * Transport, UINT32 Timeout)
+{
+    TRANSPORT_SOCKET Socket = TRANSPORT_SOCKET_OF(Transport);
+    fd_set           ReadSet;
+    struct timeval   Time;
+
+    FD_ZERO(&ReadSet);
+    FD_SET(Socket, &ReadSet);
+
+    Time.tv_sec  = Timeout / 1000;
+    Time.tv_usec = (Timeout % 1000) * 1000;
+
+    //
+    // The first parameter is ignored by Winsock
+    //
+    return select((int)Socket + 1, &ReadSet, NULL, NULL, Timeout == TRANSPORT_WAIT_INFINITE ? NULL : &Time) > 0;
+}
+
+/**
+ * @brief Close a socket
+ *
+ * @param Transport
+ *
+ * @return VOID
+ */
+static VOID
+TransportSocketClose(TRANSPORT * Transport)
+{
+    shutdown(TRANSPORT_SOCKET_OF(Transport), SD_BOTH);
+    closesocket(TRANSPORT_SOCKET_OF(Transport));
+
+    TransportSocketCleanup();
+}
+
+/**
+ * @brief The routines of the sockets
+ *
+ */
+static const TRANSPORT_ROUTINES TransportSocketRoutines = {
+    TransportSocketSend,
+    TransportSocketReceive,
+    TransportSocketFlush,
+    TransportSocketPoll,
+    TransportSocketClose,
+};
+
+//////////////////////////////////////////////////
+//					 Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Initialize a transport over a connected socket
+ * @details On Windows, the transport takes a reference of Winsock which is
+ * released when it's closed. Small packets are sent immediately (no Nagle),
+ * as each request waits for its response
+ *
+ * @param Transport
+ * @param Socket
+ *
+ * @return VOID
+ */
+VOID
+TransportInitializeSocket(TRANSPORT * Transport, TRANSPORT_SOCKET Socket)
+{
+    BOOL NoDelay = TRUE;
+
+    TransportSocketStartup();
+
+    //
+    // Fails for the sockets that are not TCP (e.g., the pairs of UNIX sockets)
+    //
+    setsockopt(Socket, IPPROTO_TCP, TCP_NODELAY, (const CHAR *)&NoDelay, sizeof(NoDelay));
+
+    TransportInitialize(Transport, &TransportSocketRoutines, TRANSPORT_TYPE_SOCKET, (PVOID)(SIZE_T)Socket, NULL, NULL);
+}
+
+/**
+ * @brief Connect a transport to a TCP server
+ *
+ * @param Transport
+ * @param Host
+ * @param Port
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TransportConnectSocket(TRANSPORT * Transport, const CHAR * Host, const CHAR * Port)
+{
+    TRANSPORT_SOCKET  Socket  = TRANSPORT_INVALID_SOCKET;
+    struct addrinfo * Result  = NULL;
+    struct addrinfo   Hints   = {0};
+    struct addrinfo * Address = NULL;
+
+    if (!TransportSocketStartup())
+    {
+        return FALSE;
+    }
+
+    Hints.ai_family   = AF_UNSPEC;
+    Hints.ai_socktype = SOCK_STREAM;
+    Hints.ai_protocol = IPPROTO_TCP;
+
+    if (getaddrinfo(Host, Port, &Hints, &Result) != 0)
+    {
+        TransportSocketCleanup();
+        return FALSE;
+    }
+
+    //
+    // Attempt to connect to an address until one succeeds
+    //
+    for (Address = Result; Address != NULL; Address = Address->ai_next)
+    {
+        Socket = socket(Address->ai_family, Address->ai_socktype, Address->ai_protocol);
+
+        if (Socket == TRANSPORT_INVALID_SOCKET)
+        {
+            continue;
+        }
+
+        if (connect(Socket, Address->ai_addr, (int)Address->ai_addrlen) != SOCKET_ERROR)
+        {
+            break;
+        }
+
+        closesocket(Socket);
+        Socket = TRANSPORT_INVALID_SOCKET;
+    }
+
+    freeaddrinfo(Result);
+
+    if (Socket != TRANSPORT_INVALID_SOCKET)
+    {
+        TransportInitializeSocket(Transport, Socket);
+    }
+
+    TransportSocketCleanup();
+
+    return Socket != TRANSPORT_INVALID_SOCKET;
+}
+
+/**
+ * @brief Create a connected pair of sockets
+ * @details A pair of UNIX sockets on POSIX, and a pair of TCP sockets on
+ * the loopback on Windows (Winsock has no socketpair)
+ *
+ * @param First
+ * @param Second
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+TransportCreateSocketPair(TRANSPORT * First, TRANSPORT * Second)
+{
+#ifdef ENV_WINDOWS
+    SOCKET             Listener      = INVALID_SOCKET;
+    SOCKET             Sockets[2]    = {INVALID_SOCKET, INVALID_SOCKET};
+    struct sockaddr_in Address       = {0};
+    int                AddressLength = sizeof(Address);
+
+    if (!TransportSocketStartup())
+    {
+        return FALSE;
+    }
+
+    Listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+    //
+    // Listen on a free port of the loopback
+    //
+    Address.sin_family      = AF_INET;
+    Address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    Address.sin_port        = 0;
+
+    if (Listener != INVALID_SOCKET &&
+        bind(Listener, (struct sockaddr *)&Address, sizeof(Address)) == 0 &&
+        listen(Listener, 1) == 0 &&
+        getsockname(Listener, (struct sockaddr *)&Address, &AddressLength) == 0)
+    {
+        Sockets[0] = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+        if (Sockets[0] != INVALID_SOCKET && connect(Sockets[0], (struct sockaddr *)&Address, sizeof(Address)) == 0)
+        {
+            Sockets[1] = accept(Listener, NULL, NULL);
+        }
+    }
+
+    if (Listener != INVALID_SOCKET)
+    {
+        closesocket(Listener);
+    }
+
+    if (Sockets[1] == INVALID_SOCKET)
+    {
+        if (Sockets[0] != INVALID_SOCKET)
+        {
+            closesocket(Sockets[0]);
+        }
+
+        TransportSocketCleanup();
+        return FALSE;
+    }
+#else
+    int Sockets[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, Sockets) != 0)
+    {
+        return FALSE;
+    }
+#endif
+
+    TransportInitializeSocket(First, Sockets[0]);
+    TransportInitializeSocket(Second, Sockets[1]);
+
+    TransportSocketCleanup();
+
+    return TRUE;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file Transport.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Headers of the transports of the kernel debugger
+ * @details The packets of the kernel debugger are sent and received through
+ * a table of routines (send, receive, flush and poll), so the same protocol
+ * could be used over a serial port, a named pipe or a TCP socket (e.g., the
+ * serial port of a virtual machine that is exposed over TCP, or a simulated
+ * debuggee). This header doesn't depend on the platform, it's used by the
+ * debugger (the backends of TransportBackends.h) and by the debuggee (the
+ * UART of hyperkd)
+ *
+ * @version 0.14
+ * @date 2025-06-30
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Wait until the bytes become available
+ *
+ */
+#define TRANSPORT_WAIT_INFINITE 0xffffffff
+
+/**
+ * @brief Type of the transport
+ *
+ */
+typedef enum _TRANSPORT_TYPE
+{
+    TRANSPORT_TYPE_NONE,
+    TRANSPORT_TYPE_SERIAL,
+    TRANSPORT_TYPE_NAMED_PIPE,
+    TRANSPORT_TYPE_SOCKET,
+    TRANSPORT_TYPE_UART,
+
+} TRANSPORT_TYPE;
+
+typedef struct _TRANSPORT TRANSPORT;
+
+/**
+ * @brief Sends all of the bytes
+ *
+ */
+typedef BOOLEAN (*TRANSPORT_SEND_ROUTINE)(TRANSPORT * Transport, const VOID * Buffer, UINT32 Length);
+
+/**
+ * @brief Receives up to Length bytes
+ * @details Returns FALSE if the connection is closed, BytesReceived might be
+ * zero if a timeout of the device is expired
+ *
+ */
+typedef BOOLEAN (*TRANSPORT_RECEIVE_ROUTINE)(TRANSPORT * Transport, VOID * Buffer, UINT32 Length, UINT32 * BytesReceived);
+
+/**
+ * @brief Discards the bytes that are not received yet
+ *
+ */
+typedef VOID (*TRANSPORT_FLUSH_ROUTINE)(TRANSPORT * Transport);
+
+/**
+ * @brief Waits (up to Timeout milliseconds) until bytes become available
+ *
+ */
+typedef BOOLEAN (*TRANSPORT_POLL_ROUTINE)(TRANSPORT * Transport, UINT32 Timeout);
+
+/**
+ * @brief Closes the transport
+ *
+ */
+typedef VOID (*TRANSPORT_CLOSE_ROUTINE)(TRANSPORT * Transport);
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The routines of a transport
+ *
+ */
+typedef struct _TRANSPORT_ROUTINES
+{
+    TRANSPORT_SEND_ROUTINE    Send;
+    TRANSPORT_RECEIVE_ROUTINE Receive;
+    TRANSPORT_FLUSH_ROUTINE   Flush;
+    TRANSPORT_POLL_ROUTINE    Poll;
+    TRANSPORT_CLOSE_ROUTINE   Close;
+
+} TRANSPORT_ROUTINES, *PTRANSPORT_ROUTINES;
+
+/**
+ * @brief A transport of the kernel debugger
+ * @details The handle and the contexts are only used by the routines of
+ * the backend
+ *
+ */
+typedef struct _TRANSPORT
+{
+    const TRANSPORT_ROUTINES * Routines;     // NULL if the transport is not open
+    TRANSPORT_TYPE             Type;
+    PVOID                      Handle;       // E.g., the serial port, the named pipe or the socket
+    PVOID                      ReadContext;  // E.g., the OVERLAPPED of the reads (NULL for the synchronous handles)
+    PVOID                      WriteContext; // E.g., the OVERLAPPED of the writes (NULL for the synchronous handles)
+
+} TRANSPORT, *PTRANSPORT;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+VOID
+TransportInitialize(TRANSPORT *                Transport,
+                    const TRANSPORT_ROUTINES * Routines,
+                    TRANSPORT_TYPE             Type,
+                    PVOID                      Handle,
+                    PVOID                      ReadContext,
+                    PVOID                      WriteContext);
+
+BOOLEAN
+TransportIsOpen(const TRANSPORT * Transport);
+
+BOOLEAN
+TransportSend(TRANSPORT * Transport, const VOID * Buffer, UINT32 Length);
+
+BOOLEAN
+TransportReceive(TRANSPORT * Transport, VOID * Buffer, UINT32 Length, UINT32 * BytesReceived);
+
+BOOLEAN
+TransportReceiveAll(TRANSPORT * Transport, VOID * Buffer, UINT32 Length);
+
+VOID
+TransportFlush(TRANSPORT * Transport);
+
+BOOLEAN
+TransportPoll(TRANSPORT * Transport, UINT32 Timeout);
+
+VOID
+TransportClose(TRANSPORT * Transport);
@@ -0,0 +1,73 @@
+/**
+ * @file TransportBackends.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Headers of the user-mode backends of the transports
+ * @details The serial ports and the named pipes are only available on
+ * Windows, the sockets (TCP and the connected pairs of sockets) are
+ * available on Windows and POSIX
+ *
+ * @version 0.14
+ * @date 2025-07-20
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+#ifdef ENV_WINDOWS
+
+/**
+ * @brief A socket of the socket backend
+ *
+ */
+typedef SOCKET TRANSPORT_SOCKET;
+
+/**
+ * @brief An invalid socket
+ *
+ */
+#    define TRANSPORT_INVALID_SOCKET INVALID_SOCKET
+
+#else
+
+/**
+ * @brief A socket of the socket backend (file descriptor)
+ *
+ */
+typedef int TRANSPORT_SOCKET;
+
+/**
+ * @brief An invalid socket
+ *
+ */
+#    define TRANSPORT_INVALID_SOCKET -1
+
+#endif
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+#ifdef ENV_WINDOWS
+
+VOID
+TransportInitializeHandle(TRANSPORT *    Transport,
+                          HANDLE         Handle,
+                          TRANSPORT_TYPE Type,
+                          OVERLAPPED *   ReadOverlapped,
+                          OVERLAPPED *   WriteOverlapped);
+
+#endif
+
+VOID
+TransportInitializeSocket(TRANSPORT * Transport, TRANSPORT_SOCKET Socket);
+
+BOOLEAN
+TransportConnectSocket(TRANSPORT * Transport, const CHAR * Host, const CHAR * Port);
+
+BOOLEAN
+TransportCreateSocketPair(TRANSPORT * First, TRANSPORT * Second);
@@ -0,0 +1,51 @@
+/**
+ * @file Atomic.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Cross platform atomic operations of the user-mode components
+ * @details
+ * @version 0.14
+ * @date 2025-07-20
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Functions	        		//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Set the value of a variable and return its previous value
+ *
+ * @param Target
+ * @param Value
+ *
+ * @return LONG
+ */
+static inline LONG
+PlatformAtomicExchange(volatile LONG * Target, LONG Value)
+{
+#ifdef ENV_WINDOWS
+    return InterlockedExchange(Target, Value);
+#else
+    return __atomic_exchange_n(Target, Value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief Increment a variable and return its new value
+ *
+ * @param Target
+ *
+ * @return LONG
+ */
+static inline LONG
+PlatformAtomicIncrement(volatile LONG * Target)
+{
+#ifdef ENV_WINDOWS
+    return InterlockedIncrement(Target);
+#else
+    return __atomic_add_fetch(Target, 1, __ATOMIC_SEQ_CST);
+#endif
+}
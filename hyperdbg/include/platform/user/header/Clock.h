@@ -0,0 +1,40 @@
+/**
+ * @file Clock.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Cross platform clock of the user-mode components
+ * @details
+ * @version 0.14
+ * @date 2025-07-20
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+#ifndef ENV_WINDOWS
+#    include <time.h>
+#endif
+
+//////////////////////////////////////////////////
+//				    Functions	        		//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Get the milliseconds that are elapsed since an unspecified
+ * point of time (the clock is monotonic)
+ *
+ * @return UINT64
+ */
+static inline UINT64
+PlatformGetTickCount64()
+{
+#ifdef ENV_WINDOWS
+    return GetTickCount64();
+#else
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+
+    return (UINT64)Time.tv_sec * 1000 + (UINT64)Time.tv_nsec / 1000000;
+#endif
+}
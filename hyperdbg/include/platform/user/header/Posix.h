@@ -0,0 +1,45 @@
+/**
+ * @file Posix.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief POSIX specific headers
+ * @details The Windows types that are used by the SDK and the user-mode
+ * components (and are not defined in BasicTypes.h), with the same sizes
+ * as Windows, so the structures of the packets have the same layout
+ * @version 0.14
+ * @date 2025-07-20
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+//////////////////////////////////////////////////
+//				    Definitions	        		//
+//////////////////////////////////////////////////
+
+typedef int32_t   LONG, *PLONG;
+typedef void *    PVOID;
+typedef void *    HANDLE;
+typedef size_t    SIZE_T, *PSIZE_T;
+typedef uintptr_t UINT_PTR;
+typedef char *    PCHAR;
+
+#define MAX_PATH 260
+
+#ifndef FIELD_OFFSET
+#    define FIELD_OFFSET(Type, Field) offsetof(Type, Field)
+#endif
+
+#ifndef UNREFERENCED_PARAMETER
+#    define UNREFERENCED_PARAMETER(P) (void)(P)
+#endif
+
+typedef struct _LIST_ENTRY
+{
+    struct _LIST_ENTRY * Flink;
+    struct _LIST_ENTRY * Blink;
+} LIST_ENTRY, *PLIST_ENTRY;
@@ -35,6 +35,10 @@ Uart16550GetByte(
     _Inout_ PCPPORT Port,
     _Out_ PUCHAR    Byte);
 
+BOOLEAN
+Uart16550RxReady(
+    _Inout_ PCPPORT Port);
+
 // ----------------------------------------------- Function Test
 
 //
@@ -131,6 +135,12 @@ KdHyperDbgRecvByte(PUCHAR RecvByte)
     return FALSE;
 }
 
+BOOLEAN
+KdHyperDbgRecvReady()
+{
+    return Uart16550RxReady(&g_PortDetails);
+}
+
 // ------------------------------------------------------------------ Functions
 
 BOOLEAN
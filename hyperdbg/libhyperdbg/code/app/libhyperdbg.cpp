@@ -34,6 +34,7 @@ extern BOOLEAN    g_IsDebuggerModulesLoaded;
 extern BOOLEAN    g_IsReversingMachineModulesLoaded;
 extern BOOLEAN    g_PrivilegesAlreadyAdjusted;
 extern LIST_ENTRY g_OutputSources;
+extern BOOLEAN    g_UseSharedLogRings;
 
 /**
  * @brief Set the function callback that will be called if any message
@@ -161,6 +162,508 @@ ShowMessages(const char * Fmt, ...)
     }
 }
 
+/**
+ * @brief Calibrate TSC against the wall-clock time
+ * @details Called once when the debugger connects to the kernel, the time
+ * stamp of kernel messages is the raw TSC of the core that wrote the message
+ *
+ * @return VOID
+ */
+VOID
+ReadIrpBasedBufferCalibrateTsc()
+{
+    FILETIME StartTime;
+    FILETIME EndTime;
+    FILETIME LocalTime;
+    UINT64   StartTsc;
+    UINT64   EndTsc;
+    UINT64   ElapsedTime;
+
+    GetSystemTimePreciseAsFileTime(&StartTime);
+    StartTsc = __rdtsc();
+
+    Sleep(100);
+
+    GetSystemTimePreciseAsFileTime(&EndTime);
+    EndTsc = __rdtsc();
+
+    ElapsedTime = ((UINT64)EndTime.dwHighDateTime << 32 | EndTime.dwLowDateTime) -
+                  ((UINT64)StartTime.dwHighDateTime << 32 | StartTime.dwLowDateTime);
+
+    if (ElapsedTime == 0 || EndTsc <= StartTsc || !FileTimeToLocalFileTime(&EndTime, &LocalTime))
+    {
+        g_TscCalibration.IsCalibrated = FALSE;
+        return;
+    }
+
+    g_TscCalibration.BaseTsc      = EndTsc;
+    g_TscCalibration.BaseFileTime = (UINT64)LocalTime.dwHighDateTime << 32 | LocalTime.dwLowDateTime;
+    g_TscCalibration.TscFrequency = (EndTsc - StartTsc) * 10000000 / ElapsedTime;
+    g_TscCalibration.IsCalibrated = g_TscCalibration.TscFrequency != 0;
+}
+
+/**
+ * @brief Show a text message of the kernel
+ * @details If the message should be shown with its time, the time stamp (TSC) is
+ * converted to the local time based on the calibration
+ *
+ * @param Message The body of the message (null-terminated)
+ * @param TimeStamp The time stamp of the message (TSC)
+ * @param CoreId The core that wrote the message
+ * @param Flags Flags of the message (LOG_RECORD_FLAG_*)
+ *
+ * @return VOID
+ */
+VOID
+ReadIrpBasedBufferShowTextMessage(CHAR * Message, UINT64 TimeStamp, UINT32 CoreId, UINT32 Flags)
+{
+    INT64      ElapsedTicks;
+    INT64      ElapsedTime;
+    UINT64     MessageFileTime;
+    FILETIME   FileTime;
+    SYSTEMTIME SystemTime;
+
+    if (g_BreakPrintingOutput)
+    {
+        //
+        // means that the user asserts a CTRL+C or CTRL+BREAK Signal
+        // we shouldn't show or save anything in this case
+        //
+        return;
+    }
+
+    if (!(Flags & LOG_RECORD_FLAG_SHOW_TIME) || !g_TscCalibration.IsCalibrated)
+    {
+        ShowMessages("%s", Message);
+        return;
+    }
+
+    //
+    // Convert the ticks to 100-nanosecond intervals (the seconds and the remainder
+    // are converted separately to avoid overflows)
+    //
+    ElapsedTicks = (INT64)(TimeStamp - g_TscCalibration.BaseTsc);
+    ElapsedTime  = (ElapsedTicks / (INT64)g_TscCalibration.TscFrequency) * 10000000 +
+                  (ElapsedTicks % (INT64)g_TscCalibration.TscFrequency) * 10000000 / (INT64)g_TscCalibration.TscFrequency;
+
+    MessageFileTime         = g_TscCalibration.BaseFileTime + ElapsedTime;
+    FileTime.dwLowDateTime  = (DWORD)MessageFileTime;
+    FileTime.dwHighDateTime = (DWORD)(MessageFileTime >> 32);
+
+    if (!FileTimeToSystemTime(&FileTime, &SystemTime))
+    {
+        ShowMessages("%s", Message);
+        return;
+    }
+
+    ShowMessages("(%02hd:%02hd:%02hd.%03hd%03llu - core : %d - vmx-root? %s)\t %s",
+                 SystemTime.wHour,
+                 SystemTime.wMinute,
+                 SystemTime.wSecond,
+                 SystemTime.wMilliseconds,
+                 (MessageFileTime / 10) % 1000,
+                 CoreId,
+                 (Flags & LOG_RECORD_FLAG_VMX_ROOT) ? "yes" : "no",
+                 Message);
+}
+
+/**
+ * @brief Handle a message that is received from the kernel
+ *
+ * @param OperationCode The operation code of the message
+ * @param Message The body of the message (null-terminated)
+ * @param ReturnedLength Length of the body + the size of the operation code
+ * @param TimeStamp The time stamp of the message (TSC)
+ * @param CoreId The core that wrote the message
+ * @param Flags Flags of the message (LOG_RECORD_FLAG_*)
+ *
+ * @return VOID
+ */
+VOID
+ReadIrpBasedBufferHandleMessage(UINT32 OperationCode,
+                                CHAR * Message,
+                                ULONG  ReturnedLength,
+                                UINT64 TimeStamp,
+                                UINT32 CoreId,
+                                UINT32 Flags)
+{
+    switch (OperationCode)
+    {
+    case OPERATION_LOG_NON_IMMEDIATE_MESSAGE:
+
+        ReadIrpBasedBufferShowTextMessage(Message, TimeStamp, CoreId, Flags);
+
+        break;
+    case OPERATION_LOG_INFO_MESSAGE:
+
+        ReadIrpBasedBufferShowTextMessage(Message, TimeStamp, CoreId, Flags);
+
+        break;
+    case OPERATION_LOG_ERROR_MESSAGE:
+        ReadIrpBasedBufferShowTextMessage(Message, TimeStamp, CoreId, Flags);
+
+        break;
+    case OPERATION_LOG_WARNING_MESSAGE:
+
+        ReadIrpBasedBufferShowTextMessage(Message, TimeStamp, CoreId, Flags);
+
+        break;
+
+    case OPERATION_LOG_RECORDS_LOST:
+    {
+        PDEBUGGER_LOG_RECORDS_LOST RecordsLost = (PDEBUGGER_LOG_RECORDS_LOST)Message;
+
+        if (g_BreakPrintingOutput)
+        {
+            //
+            // means that the user asserts a CTRL+C or CTRL+BREAK Signal
+            // we shouldn't show or save anything in this case
+            //
+            return;
+        }
+
+        //
+        // The messages before this marker are lost because the ring was full
+        //
+        ShowMessages("warning, %llu message(s) (%llu bytes) are lost from the %s %s buffer of core %x\n",
+                     RecordsLost->LostRecords,
+                     RecordsLost->LostBytes,
+                     RecordsLost->IsVmxRoot ? "vmx-root" : "vmx non-root",
+                     RecordsLost->Priority ? "priority" : "regular",
+                     RecordsLost->CoreId);
+
+        break;
+    }
+
+    case OPERATION_COMMAND_FROM_DEBUGGER_CLOSE_AND_UNLOAD_VMM:
+
+        KdCloseConnection();
+
+        break;
+
+    case OPERATION_DEBUGGEE_USER_INPUT:
+
+        KdHandleUserInputInDebuggee((DEBUGGEE_USER_INPUT_PACKET *)(Message));
+
+        break;
+
+    case OPERATION_DEBUGGEE_REGISTER_EVENT:
+
+        KdRegisterEventInDebuggee(
+            (PDEBUGGER_GENERAL_EVENT_DETAIL)(Message),
+            ReturnedLength);
+
+        break;
+
+    case OPERATION_DEBUGGEE_ADD_ACTION_TO_EVENT:
+
+        KdAddActionToEventInDebuggee(
+            (PDEBUGGER_GENERAL_ACTION)(Message),
+            ReturnedLength);
+
+        break;
+
+    case OPERATION_DEBUGGEE_CLEAR_EVENTS:
+
+        KdSendModifyEventInDebuggee(
+            (PDEBUGGER_MODIFY_EVENTS)(Message),
+            TRUE);
+
+        break;
+
+    case OPERATION_DEBUGGEE_CLEAR_EVENTS_WITHOUT_NOTIFYING_DEBUGGER:
+
+        KdSendModifyEventInDebuggee(
+            (PDEBUGGER_MODIFY_EVENTS)(Message),
+            FALSE);
+
+        break;
+
+    case OPERATION_HYPERVISOR_DRIVER_IS_SUCCESSFULLY_LOADED:
+
+        //
+        // Indicate that driver (Hypervisor) is loaded successfully
+        //
+        SetEvent(g_IsDriverLoadedSuccessfully);
+
+        break;
+
+    case OPERATION_HYPERVISOR_DRIVER_END_OF_IRPS:
+
+        //
+        // End of receiving messages (IRPs), nothing to do
+        //
+        break;
+
+    case OPERATION_COMMAND_FROM_DEBUGGER_RELOAD_SYMBOL:
+
+        //
+        // Pause debugger after getting the results
+        //
+        KdReloadSymbolsInDebuggee(TRUE,
+                                  ((PDEBUGGEE_SYMBOL_REQUEST_PACKET)(Message))->ProcessId);
+
+        break;
+
+    case OPERATION_NOTIFICATION_FROM_USER_DEBUGGER_PAUSE:
+
+        //
+        // handle pausing packet from user debugger
+        //
+        UdHandleUserDebuggerPausing(
+            (PDEBUGGEE_UD_PAUSED_PACKET)(Message));
+
+        break;
+
+    default:
+
+        //
+        // Check if there are available output sources
+        //
+        if (!g_OutputSourcesInitialized || !ForwardingCheckAndPerformEventForwarding(OperationCode,
+                                                                                     Message,
+                                                                                     ReturnedLength - sizeof(UINT32) - 1))
+        {
+            if (g_BreakPrintingOutput)
+            {
+                //
+                // means that the user asserts a CTRL+C or CTRL+BREAK Signal
+                // we shouldn't show or save anything in this case
+                //
+                return;
+            }
+
+            ShowMessages("%s", Message);
+        }
+
+        break;
+    }
+}
+
+/**
+ * @brief Free the local views of the log rings
+ *
+ * @param SharedRings Local views of the mapped rings
+ *
+ * @return VOID
+ */
+VOID
+ReadIrpBasedBufferFreeSharedRings(LIBHYPERDBG_SHARED_LOG_RINGS * SharedRings)
+{
+    free(SharedRings->Rings);
+    free(SharedRings->RingsPriority);
+    free(SharedRings->Deficits);
+
+    SharedRings->Rings         = NULL;
+    SharedRings->RingsPriority = NULL;
+    SharedRings->Deficits      = NULL;
+    SharedRings->NumberOfRings = 0;
+    SharedRings->IsMapped      = FALSE;
+}
+
+/**
+ * @brief Map the log rings into the current process (or unmap them)
+ * @details The rings are mapped through the handle of the reader thread,
+ * so closing the handle also unmaps them
+ *
+ * @param Handle Driver handle of the reader thread
+ * @param IsMap Whether the rings should be mapped or unmapped
+ * @param SharedRings Local views of the mapped rings
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+ReadIrpBasedBufferMapSharedRings(HANDLE Handle, BOOLEAN IsMap, LIBHYPERDBG_SHARED_LOG_RINGS * SharedRings)
+{
+    BOOL                      Status;
+    ULONG                     ReturnedLength;
+    DEBUGGER_SHARED_LOG_RINGS SharedRingsRequest = {0};
+    RING_INDEX *              ProducerIndexes;
+    RING_INDEX *              ConsumerIndexes;
+    UINT32                    NumberOfCores;
+    UINT32                    KernelIndex;
+
+    SharedRingsRequest.IsMap = IsMap;
+
+    Status = DeviceIoControl(
+        Handle,                           // Handle to device
+        IOCTL_MAP_SHARED_LOG_RINGS,       // IO Control Code (IOCTL)
+        &SharedRingsRequest,              // Input Buffer to driver.
+        SIZEOF_DEBUGGER_SHARED_LOG_RINGS, // Input buffer length
+        &SharedRingsRequest,              // Output Buffer from driver.
+        SIZEOF_DEBUGGER_SHARED_LOG_RINGS, // Length of output buffer in bytes.
+        &ReturnedLength,                  // Bytes placed in buffer.
+        NULL                              // synchronous call
+    );
+
+    if (!IsMap)
+    {
+        //
+        // The views are not valid anymore (even if the request failed)
+        //
+        ReadIrpBasedBufferFreeSharedRings(SharedRings);
+    }
+
+    if (!Status)
+    {
+        ShowMessages("ioctl failed with code 0x%x\n", GetLastError());
+        return FALSE;
+    }
+
+    if (SharedRingsRequest.KernelStatus != DEBUGGER_OPERATION_WAS_SUCCESSFUL)
+    {
+        ShowErrorMessage(SharedRingsRequest.KernelStatus);
+        return FALSE;
+    }
+
+    if (!IsMap)
+    {
+        return TRUE;
+    }
+
+    //
+    // Create local views of the rings, the regular (and priority) rings of both
+    // modes are kept in one array, so they can be drained at once
+    //
+    NumberOfCores   = SharedRingsRequest.NumberOfCores;
+    ProducerIndexes = (RING_INDEX *)SharedRingsRequest.ProducerIndexesAddress;
+    ConsumerIndexes = (RING_INDEX *)SharedRingsRequest.ConsumerIndexesAddress;
+
+    SharedRings->NumberOfRings = NumberOfCores * 2;
+    SharedRings->Rings         = (RING_BUFFER *)malloc(sizeof(RING_BUFFER) * SharedRings->NumberOfRings);
+    SharedRings->RingsPriority = (RING_BUFFER *)malloc(sizeof(RING_BUFFER) * SharedRings->NumberOfRings);
+    SharedRings->Deficits      = (UINT32 *)malloc(sizeof(UINT32) * 2 * SharedRings->NumberOfRings);
+
+    if (SharedRings->Rings == NULL || SharedRings->RingsPriority == NULL || SharedRings->Deficits == NULL)
+    {
+        ReadIrpBasedBufferMapSharedRings(Handle, FALSE, SharedRings);
+        return FALSE;
+    }
+
+    for (UINT32 Mode = 0; Mode < 2; Mode++)
+    {
+        for (UINT32 Core = 0; Core < NumberOfCores; Core++)
+        {
+            //
+            // The kernel orders the indexes by mode, then by lane, and then by core
+            //
+            KernelIndex = (Mode * 2) * NumberOfCores + Core;
+
+            RingAttach(&SharedRings->Rings[Mode * NumberOfCores + Core],
+                       &ProducerIndexes[KernelIndex],
+                       &ConsumerIndexes[KernelIndex],
+                       (PVOID)(SharedRingsRequest.RingsAddress[Mode] + (UINT64)SharedRingsRequest.RingSize * Core),
+                       SharedRingsRequest.RingSize,
+                       SharedRingsRequest.MaximumRecordLength);
+
+            KernelIndex = ((Mode * 2) + 1) * NumberOfCores + Core;
+
+            RingAttach(&SharedRings->RingsPriority[Mode * NumberOfCores + Core],
+                       &ProducerIndexes[KernelIndex],
+                       &ConsumerIndexes[KernelIndex],
+                       (PVOID)(SharedRingsRequest.RingsPriorityAddress[Mode] + (UINT64)SharedRingsRequest.RingSizePriority * Core),
+                       SharedRingsRequest.RingSizePriority,
+                       SharedRingsRequest.MaximumRecordLength);
+        }
+    }
+
+    //
+    // Each ring can send (at least) one record with the maximum length in each round
+    //
+    RingInitializeFairDraining(&SharedRings->Draining,
+                               SharedRings->Deficits,
+                               SharedRings->NumberOfRings,
+                               RingGetRecordSize(SharedRingsRequest.MaximumRecordLength));
+
+    RingInitializeFairDraining(&SharedRings->DrainingPriority,
+                               SharedRings->Deficits + SharedRings->NumberOfRings,
+                               SharedRings->NumberOfRings,
+                               RingGetRecordSize(SharedRingsRequest.MaximumRecordLength));
+
+    SharedRings->IsMapped = TRUE;
+
+    return TRUE;
+}
+
+/**
+ * @brief Handle all of the messages of the mapped log rings
+ * @details Priority messages are handled first and the rings of all cores
+ * are drained fairly (deficit round-robin)
+ *
+ * @param SharedRings Local views of the mapped rings
+ * @param MessageBuffer A buffer to copy the messages that might be modified
+ *
+ * @return VOID
+ */
+VOID
+ReadIrpBasedBufferFromSharedRings(LIBHYPERDBG_SHARED_LOG_RINGS * SharedRings, CHAR * MessageBuffer)
+{
+    RING_BUFFER *        Rings;
+    RING_FAIR_DRAINING * Draining;
+    RING_RECORD_HEADER * Header;
+    UINT32               RingIndex = 0;
+    CHAR *               Message;
+
+    while (TRUE)
+    {
+        Rings    = SharedRings->RingsPriority;
+        Draining = &SharedRings->DrainingPriority;
+        Header   = RingPeekFair(Rings, SharedRings->NumberOfRings, Draining, &RingIndex);
+
+        if (Header == NULL)
+        {
+            Rings    = SharedRings->Rings;
+            Draining = &SharedRings->Draining;
+            Header   = RingPeekFair(Rings, SharedRings->NumberOfRings, Draining, &RingIndex);
+
+            if (Header == NULL)
+            {
+                //
+                // There is nothing else to read
+                //
+                return;
+            }
+        }
+
+        if (Header->BufferLength > Rings[RingIndex].MaximumRecordLength)
+        {
+            //
+            // The consumer index is corrupted, drop the messages of this ring
+            //
+            RingResynchronizeConsumer(&Rings[RingIndex]);
+            continue;
+        }
+
+        if (Header->OperationNumber <= OPERATION_LOG_NON_IMMEDIATE_MESSAGE)
+        {
+            //
+            // Text messages are only shown, so they're read in place
+            //
+            Message = (CHAR *)Header + sizeof(RING_RECORD_HEADER);
+        }
+        else
+        {
+            //
+            // Handlers of other operations might modify the buffer, but the rings are read-only
+            //
+            memcpy(MessageBuffer, (CHAR *)Header + sizeof(RING_RECORD_HEADER), Header->BufferLength + 1);
+            Message = MessageBuffer;
+        }
+
+        ReadIrpBasedBufferHandleMessage(Header->OperationNumber,
+                                        Message,
+                                        Header->BufferLength + sizeof(UINT32),
+                                        Header->TimeStamp,
+                                        Header->CoreId,
+                                        Header->Flags);
+
+        //
+        // Advance the shared consumer index
+        //
+        RingConsumeFair(Rings, Draining, RingIndex);
+    }
+}
+
 /**
  * @brief Read kernel buffers using IRP Pending
  *
@@ -170,15 +673,22 @@ ShowMessages(const char * Fmt, ...)
 VOID
 ReadIrpBasedBuffer()
 {
-    BOOL                   Status;
-    ULONG                  ReturnedLength;
-    REGISTER_NOTIFY_BUFFER RegisterEvent;
-    UINT32                 OperationCode;
-    DWORD                  ErrorNum;
-    HANDLE                 Handle;
+    BOOL                             Status;
+    ULONG                            ReturnedLength;
+    REGISTER_NOTIFY_BUFFER           RegisterEvent;
+    UINT32                           Offset;
+    PDEBUGGER_BATCHED_MESSAGE_HEADER MessageHeader;
+    DWORD                            ErrorNum;
+    HANDLE                           Handle;
+    LIBHYPERDBG_SHARED_LOG_RINGS     SharedRings = {0};
 
     RegisterEvent.hEvent = NULL;
-    RegisterEvent.Type   = IRP_BASED;
+    RegisterEvent.Type   = IRP_BASED_BATCHED;
+
+    //
+    // Messages only carry the TSC, so calibrate it once before reading them
+    //
+    ReadIrpBasedBufferCalibrateTsc();
 
     //
     // Create another handle to be used in for reading kernel messages,
@@ -225,7 +735,7 @@ ReadIrpBasedBuffer()
     //
     // allocate buffer for transferring messages
     //
-    char * OutputBuffer = (char *)malloc(UsermodeBufferSize);
+    char * OutputBuffer = (char *)malloc(UsermodeBatchedBufferSize);
 
     try
     {
@@ -234,9 +744,18 @@ ReadIrpBasedBuffer()
             if (!g_IsVmxOffProcessStart)
             {
                 //
-                // Clear the buffer
+                // Map (or unmap) the log rings if the user changed the settings
                 //
-                ZeroMemory(OutputBuffer, UsermodeBufferSize);
+                if (g_UseSharedLogRings != SharedRings.IsMapped &&
+                    !ReadIrpBasedBufferMapSharedRings(Handle, g_UseSharedLogRings, &SharedRings))
+                {
+                    g_UseSharedLogRings = SharedRings.IsMapped;
+                }
+
+                //
+                // If the rings are mapped, the kernel only notifies us (doorbell)
+                //
+                RegisterEvent.Type = SharedRings.IsMapped ? IRP_BASED_DOORBELL : IRP_BASED_BATCHED;
 
                 Sleep(DefaultSpeedOfReadingKernelMessages); // we're not trying to eat all of the CPU ;)
 
@@ -247,7 +766,7 @@ ReadIrpBasedBuffer()
                     SIZEOF_REGISTER_EVENT * 2, // Length of input buffer in bytes. (x 2 is bcuz as the
                                                // driver is x64 and has 64 bit values)
                     OutputBuffer,              // Output Buffer from driver.
-                    UsermodeBufferSize,        // Length of output buffer in bytes.
+                    UsermodeBatchedBufferSize, // Length of output buffer in bytes.
                     &ReturnedLength,           // Bytes placed in buffer.
                     NULL                       // synchronous call
                 );
@@ -266,177 +785,37 @@ ReadIrpBasedBuffer()
                     continue;
                 }
 
-                //
-                // Compute the received buffer's operation code
-                //
-                OperationCode = 0;
-                memcpy(&OperationCode, OutputBuffer, sizeof(UINT32));
-
-                /*
-        ShowMessages("Returned Length : 0x%x \n", ReturnedLength);
-        ShowMessages("Operation Code : 0x%x \n", OperationCode);
-                */
-
-                switch (OperationCode)
+                if (SharedRings.IsMapped)
                 {
-                case OPERATION_LOG_NON_IMMEDIATE_MESSAGE:
-
-                    if (g_BreakPrintingOutput)
-                    {
-                        //
-                        // means that the user asserts a CTRL+C or CTRL+BREAK Signal
-                        // we shouldn't show or save anything in this case
-                        //
-                        continue;
-                    }
-
-                    ShowMessages("%s", OutputBuffer + sizeof(UINT32));
-
-                    break;
-                case OPERATION_LOG_INFO_MESSAGE:
-
-                    if (g_BreakPrintingOutput)
-                    {
-                        //
-                        // means that the user asserts a CTRL+C or CTRL+BREAK Signal
-                        // we shouldn't show or save anything in this case
-                        //
-                        continue;
-                    }
-
-                    ShowMessages("%s", OutputBuffer + sizeof(UINT32));
-
-                    break;
-                case OPERATION_LOG_ERROR_MESSAGE:
-                    if (g_BreakPrintingOutput)
-                    {
-                        //
-                        // means that the user asserts a CTRL+C or CTRL+BREAK Signal
-                        // we shouldn't show or save anything in this case
-                        //
-                        continue;
-                    }
-
-                    ShowMessages("%s", OutputBuffer + sizeof(UINT32));
-
-                    break;
-                case OPERATION_LOG_WARNING_MESSAGE:
-
-                    if (g_BreakPrintingOutput)
-                    {
-                        //
-                        // means that the user asserts a CTRL+C or CTRL+BREAK Signal
-                        // we shouldn't show or save anything in this case
-                        //
-                        continue;
-                    }
-
-                    ShowMessages("%s", OutputBuffer + sizeof(UINT32));
-
-                    break;
-
-                case OPERATION_COMMAND_FROM_DEBUGGER_CLOSE_AND_UNLOAD_VMM:
-
-                    KdCloseConnection();
-
-                    break;
-
-                case OPERATION_DEBUGGEE_USER_INPUT:
-
-                    KdHandleUserInputInDebuggee((DEBUGGEE_USER_INPUT_PACKET *)(OutputBuffer + sizeof(UINT32)));
-
-                    break;
-
-                case OPERATION_DEBUGGEE_REGISTER_EVENT:
-
-                    KdRegisterEventInDebuggee(
-                        (PDEBUGGER_GENERAL_EVENT_DETAIL)(OutputBuffer + sizeof(UINT32)),
-                        ReturnedLength);
-
-                    break;
-
-                case OPERATION_DEBUGGEE_ADD_ACTION_TO_EVENT:
-
-                    KdAddActionToEventInDebuggee(
-                        (PDEBUGGER_GENERAL_ACTION)(OutputBuffer + sizeof(UINT32)),
-                        ReturnedLength);
-
-                    break;
-
-                case OPERATION_DEBUGGEE_CLEAR_EVENTS:
-
-                    KdSendModifyEventInDebuggee(
-                        (PDEBUGGER_MODIFY_EVENTS)(OutputBuffer + sizeof(UINT32)),
-                        TRUE);
-
-                    break;
-
-                case OPERATION_DEBUGGEE_CLEAR_EVENTS_WITHOUT_NOTIFYING_DEBUGGER:
-
-                    KdSendModifyEventInDebuggee(
-                        (PDEBUGGER_MODIFY_EVENTS)(OutputBuffer + sizeof(UINT32)),
-                        FALSE);
-
-                    break;
-
-                case OPERATION_HYPERVISOR_DRIVER_IS_SUCCESSFULLY_LOADED:
-
-                    //
-                    // Indicate that driver (Hypervisor) is loaded successfully
-                    //
-                    SetEvent(g_IsDriverLoadedSuccessfully);
-
-                    break;
-
-                case OPERATION_HYPERVISOR_DRIVER_END_OF_IRPS:
-
-                    //
-                    // End of receiving messages (IRPs), nothing to do
-                    //
-                    break;
-
-                case OPERATION_COMMAND_FROM_DEBUGGER_RELOAD_SYMBOL:
-
                     //
-                    // Pause debugger after getting the results
+                    // Read the messages directly from the mapped rings
                     //
-                    KdReloadSymbolsInDebuggee(TRUE,
-                                              ((PDEBUGGEE_SYMBOL_REQUEST_PACKET)(OutputBuffer + sizeof(UINT32)))->ProcessId);
-
-                    break;
+                    ReadIrpBasedBufferFromSharedRings(&SharedRings, OutputBuffer);
+                    continue;
+                }
 
-                case OPERATION_NOTIFICATION_FROM_USER_DEBUGGER_PAUSE:
+                //
+                // Handle all of the messages in the batch in one pass
+                //
+                Offset = 0;
 
-                    //
-                    // handle pausing packet from user debugger
-                    //
-                    UdHandleUserDebuggerPausing(
-                        (PDEBUGGEE_UD_PAUSED_PACKET)(OutputBuffer + sizeof(UINT32)));
+                while (Offset + sizeof(DEBUGGER_BATCHED_MESSAGE_HEADER) <= ReturnedLength)
+                {
+                    MessageHeader = (PDEBUGGER_BATCHED_MESSAGE_HEADER)(OutputBuffer + Offset);
 
-                    break;
+                    /*
+        ShowMessages("Returned Length : 0x%x \n", MessageHeader->BufferLength);
+        ShowMessages("Operation Code : 0x%x \n", MessageHeader->OperationCode);
+                    */
 
-                default:
+                    ReadIrpBasedBufferHandleMessage(MessageHeader->OperationCode,
+                                                    (CHAR *)MessageHeader + sizeof(DEBUGGER_BATCHED_MESSAGE_HEADER),
+                                                    MessageHeader->BufferLength + sizeof(UINT32),
+                                                    MessageHeader->TimeStamp,
+                                                    MessageHeader->CoreId,
+                                                    MessageHeader->Flags);
 
-                    //
-                    // Check if there are available output sources
-                    //
-                    if (!g_OutputSourcesInitialized || !ForwardingCheckAndPerformEventForwarding(OperationCode,
-                                                                                                 OutputBuffer + sizeof(UINT32),
-                                                                                                 ReturnedLength - sizeof(UINT32) - 1))
-                    {
-                        if (g_BreakPrintingOutput)
-                        {
-                            //
-                            // means that the user asserts a CTRL+C or CTRL+BREAK Signal
-                            // we shouldn't show or save anything in this case
-                            //
-                            continue;
-                        }
-
-                        ShowMessages("%s", OutputBuffer + sizeof(UINT32));
-                    }
-
-                    break;
+                    Offset += DEBUGGER_BATCHED_MESSAGE_SIZE(MessageHeader->BufferLength);
                 }
             }
             else
@@ -446,6 +825,11 @@ ReadIrpBasedBuffer()
                 //
                 free(OutputBuffer);
 
+                //
+                // Closing the handle also unmaps the log rings (if mapped)
+                //
+                ReadIrpBasedBufferFreeSharedRings(&SharedRings);
+
                 //
                 // closeHandle
                 //
@@ -464,6 +848,7 @@ ReadIrpBasedBuffer()
     }
 
     free(OutputBuffer);
+    ReadIrpBasedBufferFreeSharedRings(&SharedRings);
 
     //
     // closeHandle
@@ -23,6 +23,8 @@ extern BOOLEAN    g_IsSerialConnectedToRemoteDebuggee;
 extern BOOLEAN    g_IsSerialConnectedToRemoteDebugger;
 extern UINT64     g_EventTag;
 
+extern DEBUGGER_EVENT_GROUP g_EventGroups[DEBUGGER_MAXIMUM_EVENT_GROUPS];
+
 /**
  * @brief help of the events command
  *
@@ -36,13 +38,19 @@ CommandEventsHelp()
     ShowMessages("syntax : \tevents\n");
     ShowMessages("syntax : \tevents [e|d|c all|EventNumber (hex)]\n");
     ShowMessages("syntax : \tevents [sc State (on|off)]\n");
+    ShowMessages("syntax : \tevents [g]\n");
+    ShowMessages("syntax : \tevents [g add|remove GroupName (string) EventNumber (hex) ...]\n");
+    ShowMessages("syntax : \tevents [g e|d|c GroupName (string)]\n");
 
     ShowMessages("e : enable\n");
     ShowMessages("d : disable\n");
     ShowMessages("c : clear\n");
+    ShowMessages("g : event groups\n");
 
     ShowMessages("note : If you specify 'all' then e, d, or c will be applied to "
-                 "all of the events.\n\n");
+                 "all of the events.\n");
+    ShowMessages("note : An event is triggered only if it's enabled and none of its groups "
+                 "is disabled, clearing a group doesn't clear its events.\n\n");
 
     ShowMessages("\n");
     ShowMessages("\te.g : events \n");
@@ -52,6 +60,239 @@ CommandEventsHelp()
     ShowMessages("\te.g : events c all\n");
     ShowMessages("\te.g : events sc on\n");
     ShowMessages("\te.g : events sc off\n");
+    ShowMessages("\te.g : events g\n");
+    ShowMessages("\te.g : events g add ModuleHooks 1 2 3\n");
+    ShowMessages("\te.g : events g remove ModuleHooks 2\n");
+    ShowMessages("\te.g : events g d ModuleHooks\n");
+    ShowMessages("\te.g : events g e ModuleHooks\n");
+    ShowMessages("\te.g : events g c ModuleHooks\n");
+}
+
+/**
+ * @brief Find the id of an event group by its name
+ *
+ * @param GroupName Name of the group
+ * @param GroupId The id of the group (if found)
+ *
+ * @return BOOLEAN whether the group is found or not
+ */
+BOOLEAN
+CommandEventsFindEventGroup(const string & GroupName, UINT32 * GroupId)
+{
+    for (UINT32 i = 0; i < DEBUGGER_MAXIMUM_EVENT_GROUPS; i++)
+    {
+        if (!g_EventGroups[i].Name.empty() && g_EventGroups[i].Name == GroupName)
+        {
+            *GroupId = i;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief Show the groups of events
+ *
+ * @return VOID
+ */
+VOID
+CommandEventsShowEventGroups()
+{
+    BOOLEAN IsThereAnyGroups = FALSE;
+
+    for (UINT32 i = 0; i < DEBUGGER_MAXIMUM_EVENT_GROUPS; i++)
+    {
+        if (g_EventGroups[i].Name.empty())
+        {
+            continue;
+        }
+
+        IsThereAnyGroups = TRUE;
+
+        ShowMessages("%s\t(%s)\t    events:",
+                     g_EventGroups[i].Name.c_str(),
+                     g_EventGroups[i].IsDisabled ? "disabled" : "enabled");
+
+        for (auto Tag : g_EventGroups[i].Tags)
+        {
+            ShowMessages(" %llx", Tag - DebuggerEventTagStartSeed);
+        }
+
+        ShowMessages("\n");
+    }
+
+    if (!IsThereAnyGroups)
+    {
+        ShowMessages("no event groups\n");
+    }
+}
+
+/**
+ * @brief Handle the event groups (events g) command
+ *
+ * @param CommandTokens
+ *
+ * @return VOID
+ */
+VOID
+CommandEventsGroup(vector<CommandToken> CommandTokens)
+{
+    UINT32 GroupId = 0;
+    UINT64 Tag;
+    string GroupName;
+
+    if (CommandTokens.size() == 2)
+    {
+        CommandEventsShowEventGroups();
+        return;
+    }
+
+    if (CommandTokens.size() < 4)
+    {
+        ShowMessages("incorrect use of the '%s'\n\n",
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str());
+        CommandEventsHelp();
+        return;
+    }
+
+    GroupName = GetCaseSensitiveStringFromCommandToken(CommandTokens.at(3));
+
+    if (CompareLowerCaseStrings(CommandTokens.at(2), "add") ||
+        CompareLowerCaseStrings(CommandTokens.at(2), "remove"))
+    {
+        BOOLEAN IsAdd = CompareLowerCaseStrings(CommandTokens.at(2), "add");
+
+        if (CommandTokens.size() < 5)
+        {
+            ShowMessages("please specify at least one event number\n\n");
+            CommandEventsHelp();
+            return;
+        }
+
+        if (!CommandEventsFindEventGroup(GroupName, &GroupId))
+        {
+            if (!IsAdd)
+            {
+                ShowMessages("err, group not found\n");
+                return;
+            }
+
+            //
+            // Create a new group on the first free group id
+            //
+            for (GroupId = 0; GroupId < DEBUGGER_MAXIMUM_EVENT_GROUPS; GroupId++)
+            {
+                if (g_EventGroups[GroupId].Name.empty())
+                {
+                    break;
+                }
+            }
+
+            if (GroupId == DEBUGGER_MAXIMUM_EVENT_GROUPS)
+            {
+                ShowMessages("err, maximum number of event groups (%d) is reached\n", DEBUGGER_MAXIMUM_EVENT_GROUPS);
+                return;
+            }
+
+            //
+            // Make sure that the group is enabled in the kernel (it might be left
+            // disabled by a previous group with the same id)
+            //
+            if (!CommandEventsModifyEventGroup(DEBUGGER_MODIFY_EVENTS_APPLY_TO_ALL_TAG, DEBUGGER_MODIFY_EVENTS_REMOVE_FROM_GROUP, GroupId))
+            {
+                return;
+            }
+
+            g_EventGroups[GroupId].Name       = GroupName;
+            g_EventGroups[GroupId].IsDisabled = FALSE;
+            g_EventGroups[GroupId].Tags.clear();
+        }
+
+        for (size_t i = 4; i < CommandTokens.size(); i++)
+        {
+            if (!ConvertTokenToUInt64(CommandTokens.at(i), &Tag))
+            {
+                ShowMessages("please specify a correct hex value for tag id (event number)\n\n");
+                CommandEventsHelp();
+                return;
+            }
+
+            Tag = Tag + DebuggerEventTagStartSeed;
+
+            if (!IsTagExist(Tag))
+            {
+                ShowMessages("err, tag id is invalid (%llx)\n", Tag - DebuggerEventTagStartSeed);
+                continue;
+            }
+
+            auto Position = std::find(g_EventGroups[GroupId].Tags.begin(), g_EventGroups[GroupId].Tags.end(), Tag);
+
+            if (IsAdd && Position == g_EventGroups[GroupId].Tags.end())
+            {
+                if (CommandEventsModifyEventGroup(Tag, DEBUGGER_MODIFY_EVENTS_ADD_TO_GROUP, GroupId))
+                {
+                    g_EventGroups[GroupId].Tags.push_back(Tag);
+                }
+            }
+            else if (!IsAdd && Position != g_EventGroups[GroupId].Tags.end())
+            {
+                if (CommandEventsModifyEventGroup(Tag, DEBUGGER_MODIFY_EVENTS_REMOVE_FROM_GROUP, GroupId))
+                {
+                    g_EventGroups[GroupId].Tags.erase(Position);
+                }
+            }
+        }
+
+        return;
+    }
+
+    if (CommandTokens.size() != 4)
+    {
+        ShowMessages("incorrect use of the '%s'\n\n",
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str());
+        CommandEventsHelp();
+        return;
+    }
+
+    if (!CommandEventsFindEventGroup(GroupName, &GroupId))
+    {
+        ShowMessages("err, group not found\n");
+        return;
+    }
+
+    if (CompareLowerCaseStrings(CommandTokens.at(2), "e"))
+    {
+        if (CommandEventsModifyEventGroup(NULL64_ZERO, DEBUGGER_MODIFY_EVENTS_ENABLE_GROUP, GroupId))
+        {
+            g_EventGroups[GroupId].IsDisabled = FALSE;
+        }
+    }
+    else if (CompareLowerCaseStrings(CommandTokens.at(2), "d"))
+    {
+        if (CommandEventsModifyEventGroup(NULL64_ZERO, DEBUGGER_MODIFY_EVENTS_DISABLE_GROUP, GroupId))
+        {
+            g_EventGroups[GroupId].IsDisabled = TRUE;
+        }
+    }
+    else if (CompareLowerCaseStrings(CommandTokens.at(2), "c"))
+    {
+        //
+        // Remove all of the events from the group (the group is enabled again in the kernel)
+        //
+        if (CommandEventsModifyEventGroup(DEBUGGER_MODIFY_EVENTS_APPLY_TO_ALL_TAG, DEBUGGER_MODIFY_EVENTS_REMOVE_FROM_GROUP, GroupId))
+        {
+            g_EventGroups[GroupId].Name.clear();
+            g_EventGroups[GroupId].IsDisabled = FALSE;
+            g_EventGroups[GroupId].Tags.clear();
+        }
+    }
+    else
+    {
+        ShowMessages("incorrect use of the '%s'\n\n",
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str());
+        CommandEventsHelp();
+    }
 }
 
 /**
@@ -68,6 +309,15 @@ CommandEvents(vector<CommandToken> CommandTokens, string Command)
     DEBUGGER_MODIFY_EVENTS_TYPE RequestedAction;
     UINT64                      RequestedTag;
 
+    //
+    // Check if it's about the groups of events
+    //
+    if (CommandTokens.size() >= 2 && CompareLowerCaseStrings(CommandTokens.at(1), "g"))
+    {
+        CommandEventsGroup(CommandTokens);
+        return;
+    }
+
     //
     // Validate the parameters (size)
     //
@@ -406,6 +656,20 @@ CommandEventClearEvent(UINT64 Tag)
             //
             free(CommandDetail->CommandStringBuffer);
 
+            //
+            // Remove the saved actions of the event (used for sessions)
+            //
+            SessionRemoveEventActions(CommandDetail->Tag);
+
+            //
+            // Remove the event from the groups
+            //
+            for (UINT32 i = 0; i < DEBUGGER_MAXIMUM_EVENT_GROUPS; i++)
+            {
+                auto & GroupTags = g_EventGroups[i].Tags;
+                GroupTags.erase(std::remove(GroupTags.begin(), GroupTags.end(), CommandDetail->Tag), GroupTags.end());
+            }
+
             if (!Result)
             {
                 Result = TRUE;
@@ -488,6 +752,16 @@ CommandEventsClearAllEventsAndResetTags()
         // Reset tag numbering mechanism
         //
         g_EventTag = DebuggerEventTagStartSeed;
+
+        //
+        // Reset the groups of events
+        //
+        for (UINT32 i = 0; i < DEBUGGER_MAXIMUM_EVENT_GROUPS; i++)
+        {
+            g_EventGroups[i].Name.clear();
+            g_EventGroups[i].IsDisabled = FALSE;
+            g_EventGroups[i].Tags.clear();
+        }
     }
 }
 
@@ -745,3 +1019,75 @@ CommandEventsModifyAndQueryEvents(UINT64                      Tag,
     //
     return TRUE;
 }
+
+/**
+ * @brief modify the groups of events (add/remove events or enable/disable
+ * an entire group) and send the request to the kernel
+ *
+ * @param Tag the tag of the target event (if any)
+ * @param TypeOfAction type of the group modification
+ * @param GroupId the target group id
+ * @return BOOLEAN whether the modification was successful or not
+ */
+BOOLEAN
+CommandEventsModifyEventGroup(UINT64                      Tag,
+                              DEBUGGER_MODIFY_EVENTS_TYPE TypeOfAction,
+                              UINT32                      GroupId)
+{
+    BOOLEAN                Status;
+    ULONG                  ReturnedLength;
+    DEBUGGER_MODIFY_EVENTS ModifyEventRequest = {0};
+
+    if (g_IsSerialConnectedToRemoteDebuggee)
+    {
+        //
+        // Remote debuggee Debugger Mode
+        //
+        return KdSendEventGroupModificationPacketToDebuggee(Tag, TypeOfAction, GroupId);
+    }
+
+    //
+    // Local debugging VMI-Mode
+    //
+
+    //
+    // Check if debugger is loaded or not
+    //
+    AssertShowMessageReturnStmt(g_DeviceHandle, ASSERT_MESSAGE_DRIVER_NOT_LOADED, AssertReturnFalse);
+
+    //
+    // Fill the structure to send it to the kernel
+    //
+    ModifyEventRequest.Tag          = Tag;
+    ModifyEventRequest.TypeOfAction = TypeOfAction;
+    ModifyEventRequest.GroupId      = GroupId;
+
+    //
+    // Send the request to the kernel
+    //
+    Status =
+        DeviceIoControl(g_DeviceHandle,                // Handle to device
+                        IOCTL_DEBUGGER_MODIFY_EVENTS,  // IO Control Code (IOCTL)
+                        &ModifyEventRequest,           // Input Buffer to driver.
+                        SIZEOF_DEBUGGER_MODIFY_EVENTS, // Input buffer length
+                        &ModifyEventRequest,           // Output Buffer from driver.
+                        SIZEOF_DEBUGGER_MODIFY_EVENTS, // Length of output
+                                                       // buffer in bytes.
+                        &ReturnedLength,               // Bytes placed in buffer.
+                        NULL                           // synchronous call
+        );
+
+    if (!Status)
+    {
+        ShowMessages("ioctl failed with code 0x%x\n", GetLastError());
+        return FALSE;
+    }
+
+    if (ModifyEventRequest.KernelStatus != DEBUGGER_OPERATION_WAS_SUCCESSFUL)
+    {
+        ShowErrorMessage((UINT32)ModifyEventRequest.KernelStatus);
+        return FALSE;
+    }
+
+    return TRUE;
+}
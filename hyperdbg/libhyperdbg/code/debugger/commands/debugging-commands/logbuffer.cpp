@@ -0,0 +1,403 @@
+/**
+ * @file logbuffer.cpp
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief logbuffer command
+ * @details
+ * @version 0.14
+ * @date 2025-06-15
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+//
+// Global Variables
+//
+extern BOOLEAN g_IsSerialConnectedToRemoteDebuggee;
+
+/**
+ * @brief help of the logbuffer command
+ *
+ * @return VOID
+ */
+VOID
+CommandLogBufferHelp()
+{
+    ShowMessages("logbuffer : shows the overflow policies, the occupancy, the number of lost messages, and the batches of "
+                 "non-immediate messages of kernel-mode buffers, or changes the overflow policy of the buffers "
+                 "or the thresholds of sending the batches.\n\n");
+
+    ShowMessages("syntax : \tlogbuffer \n");
+    ShowMessages("syntax : \tlogbuffer policy [regular|priority] [overwrite|drop|block]\n");
+    ShowMessages("syntax : \tlogbuffer coalesce [ByteThreshold (hex)] [Latency (hex)]\n");
+
+    ShowMessages("\n");
+    ShowMessages("\t\te.g : logbuffer\n");
+    ShowMessages("\t\te.g : logbuffer policy regular overwrite\n");
+    ShowMessages("\t\te.g : logbuffer policy priority block\n");
+    ShowMessages("\t\te.g : logbuffer coalesce 0x800 0n5000\n");
+    ShowMessages("\t\te.g : logbuffer coalesce 0xfff 0\n");
+
+    ShowMessages("\n");
+    ShowMessages("policies:\n");
+    ShowMessages("\tdrop : the new message is dropped if the buffer is full (default)\n");
+    ShowMessages("\toverwrite : the oldest messages are removed to make space for the new message\n");
+    ShowMessages("\tblock : the sender waits for the reader (only in vmx non-root, otherwise the "
+                 "new message is dropped)\n");
+
+    ShowMessages("\n");
+    ShowMessages("coalescing:\n");
+    ShowMessages("\tnon-immediate messages of each core are sent as one batch once the batch reaches "
+                 "the byte threshold (up to 0x%x bytes) or its oldest message waited for the latency "
+                 "(in microseconds, up to 0n1000000, zero means no limit)\n",
+                 PacketChunkSize - 1);
+}
+
+/**
+ * @brief Convert an overflow policy to string
+ *
+ * @param Policy
+ *
+ * @return const CHAR *
+ */
+static const CHAR *
+CommandLogBufferGetPolicyName(LOG_OVERFLOW_POLICY Policy)
+{
+    switch (Policy)
+    {
+    case LOG_OVERFLOW_POLICY_DROP_NEWEST:
+        return "drop";
+    case LOG_OVERFLOW_POLICY_OVERWRITE_OLDEST:
+        return "overwrite";
+    case LOG_OVERFLOW_POLICY_BLOCK:
+        return "block";
+    default:
+        return "unknown";
+    }
+}
+
+/**
+ * @brief Send the logbuffer request to the kernel
+ *
+ * @param Request The request (it's also used for holding the result)
+ * @param RequestLength Length of the request buffer
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+CommandLogBufferSendRequest(PDEBUGGER_LOG_BUFFER_STATISTICS Request, UINT32 RequestLength)
+{
+    BOOL  Status;
+    ULONG ReturnedLength;
+
+    Status = DeviceIoControl(
+        g_DeviceHandle,                        // Handle to device
+        IOCTL_QUERY_LOG_BUFFER_STATISTICS,     // IO Control Code (IOCTL)
+        Request,                               // Input Buffer to driver.
+        SIZEOF_DEBUGGER_LOG_BUFFER_STATISTICS, // Input buffer length
+        Request,                               // Output Buffer from driver.
+        RequestLength,                         // Length of output buffer in
+                                               // bytes.
+        &ReturnedLength,                       // Bytes placed in buffer.
+        NULL                                   // synchronous call
+    );
+
+    if (!Status)
+    {
+        ShowMessages("ioctl failed with code 0x%x\n", GetLastError());
+        return FALSE;
+    }
+
+    if (Request->KernelStatus != DEBUGGER_OPERATION_WAS_SUCCESSFUL)
+    {
+        ShowErrorMessage(Request->KernelStatus);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Show the overflow policies, the drop counters, and the occupancy of the buffers
+ *
+ * @return VOID
+ */
+static VOID
+CommandLogBufferShowStatistics()
+{
+    DEBUGGER_LOG_BUFFER_STATISTICS  Query = {0};
+    PDEBUGGER_LOG_BUFFER_STATISTICS Result;
+    PDEBUGGER_LOG_RING_STATISTICS   Entries;
+    PDEBUGGER_LOG_RING_STATISTICS   Entry;
+    UINT32                          ResultLength;
+    UINT32                          EntryIndex          = 0;
+    UINT64                          TotalDroppedRecords = 0;
+    UINT64                          UsedBytes;
+    UINT64                          TotalSize;
+    UINT32                          Usage;
+    UINT32                          BusiestCore;
+    UINT32                          BusiestCoreUsage;
+    const CHAR *                    ModeNames[]         = {"vmx non-root", "vmx-root"};
+    const CHAR *                    LaneNames[]         = {"regular", "priority"};
+
+    //
+    // First, get the number of cores to allocate the buffer for the counters
+    //
+    if (!CommandLogBufferSendRequest(&Query, SIZEOF_DEBUGGER_LOG_BUFFER_STATISTICS))
+    {
+        return;
+    }
+
+    ResultLength = SIZEOF_DEBUGGER_LOG_BUFFER_STATISTICS + (Query.NumberOfCores * 4 * sizeof(DEBUGGER_LOG_RING_STATISTICS));
+
+    Result = (PDEBUGGER_LOG_BUFFER_STATISTICS)malloc(ResultLength);
+
+    if (Result == NULL)
+    {
+        ShowMessages("err, unable to allocate memory for the statistics of buffers\n");
+        return;
+    }
+
+    RtlZeroMemory(Result, ResultLength);
+
+    if (!CommandLogBufferSendRequest(Result, ResultLength))
+    {
+        free(Result);
+        return;
+    }
+
+    if (Result->NumberOfCores != Query.NumberOfCores)
+    {
+        ShowMessages("err, the number of cores is changed, please try again\n");
+        free(Result);
+        return;
+    }
+
+    ShowMessages("overflow policy of regular buffers: %s\n", CommandLogBufferGetPolicyName(Result->Policies[0]));
+    ShowMessages("overflow policy of priority buffers: %s\n\n", CommandLogBufferGetPolicyName(Result->Policies[1]));
+
+    //
+    // Show the batches of non-immediate messages
+    //
+    if (Result->CoalescingLatency == 0)
+    {
+        ShowMessages("non-immediate messages are sent at 0x%x bytes (no latency limit)\n",
+                     Result->CoalescingByteThreshold);
+    }
+    else
+    {
+        ShowMessages("non-immediate messages are sent at 0x%x bytes or after %u microseconds\n",
+                     Result->CoalescingByteThreshold,
+                     Result->CoalescingLatency);
+    }
+
+    if (Result->Coalescing.Batches != 0)
+    {
+        ShowMessages("sent batches: %llu, average batch: %.2f messages (%.1f bytes)\n",
+                     Result->Coalescing.Batches,
+                     (double)Result->Coalescing.Messages / (double)Result->Coalescing.Batches,
+                     (double)Result->Coalescing.Bytes / (double)Result->Coalescing.Batches);
+
+        ShowMessages("sent by size: %llu, by latency: %llu, by timer: %llu\n",
+                     Result->Coalescing.FlushesBySize,
+                     Result->Coalescing.FlushesByLatency,
+                     Result->Coalescing.FlushesByTimer);
+    }
+
+    ShowMessages("\n");
+
+    Entries = (PDEBUGGER_LOG_RING_STATISTICS)((UINT8 *)Result + SIZEOF_DEBUGGER_LOG_BUFFER_STATISTICS);
+
+    //
+    // Show the occupancy of each lane (and its busiest core)
+    //
+    for (UINT32 i = 0; i < 2; i++)
+    {
+        for (UINT32 Lane = 0; Lane < 2; Lane++)
+        {
+            UsedBytes        = 0;
+            TotalSize        = 0;
+            BusiestCore      = 0;
+            BusiestCoreUsage = 0;
+
+            for (UINT32 j = 0; j < Result->NumberOfCores; j++)
+            {
+                Entry = &Entries[((i * 2) + Lane) * Result->NumberOfCores + j];
+                Usage = Entry->Size == 0 ? 0 : (UINT32)(((UINT64)Entry->UsedBytes * 100) / Entry->Size);
+
+                UsedBytes += Entry->UsedBytes;
+                TotalSize += Entry->Size;
+
+                if (Usage > BusiestCoreUsage)
+                {
+                    BusiestCore      = j;
+                    BusiestCoreUsage = Usage;
+                }
+            }
+
+            ShowMessages("%s %s buffers : %llu%% used (busiest core : %x, %u%% used)\n",
+                         ModeNames[i],
+                         LaneNames[Lane],
+                         TotalSize == 0 ? 0 : (UsedBytes * 100) / TotalSize,
+                         BusiestCore,
+                         BusiestCoreUsage);
+        }
+    }
+
+    ShowMessages("\n");
+
+    for (UINT32 i = 0; i < 2; i++)
+    {
+        for (UINT32 Lane = 0; Lane < 2; Lane++)
+        {
+            for (UINT32 j = 0; j < Result->NumberOfCores; j++)
+            {
+                //
+                // Only show the buffers that lost any message
+                //
+                if (Entries[EntryIndex].DroppedRecords != 0)
+                {
+                    ShowMessages("core : %x, %s %s buffer, lost messages : %llu (%llu bytes)\n",
+                                 j,
+                                 ModeNames[i],
+                                 LaneNames[Lane],
+                                 Entries[EntryIndex].DroppedRecords,
+                                 Entries[EntryIndex].DroppedBytes);
+
+                    TotalDroppedRecords += Entries[EntryIndex].DroppedRecords;
+                }
+
+                EntryIndex++;
+            }
+        }
+    }
+
+    ShowMessages("total lost messages: %llu\n", TotalDroppedRecords);
+
+    free(Result);
+}
+
+/**
+ * @brief logbuffer command handler
+ *
+ * @param CommandTokens
+ * @param Command
+ *
+ * @return VOID
+ */
+VOID
+CommandLogBuffer(vector<CommandToken> CommandTokens, string Command)
+{
+    DEBUGGER_LOG_BUFFER_STATISTICS Request = {0};
+
+    if (CommandTokens.size() != 1 &&
+        !(CommandTokens.size() == 4 && CompareLowerCaseStrings(CommandTokens.at(1), "policy")) &&
+        !(CommandTokens.size() == 4 && CompareLowerCaseStrings(CommandTokens.at(1), "coalesce")))
+    {
+        ShowMessages("incorrect use of the '%s'\n\n",
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str());
+        CommandLogBufferHelp();
+        return;
+    }
+
+    if (g_IsSerialConnectedToRemoteDebuggee)
+    {
+        //
+        // The buffers of the debuggee are sent over the serial
+        //
+        ShowMessages("err, the buffers of the debuggee are not available in the debugger mode\n");
+        return;
+    }
+
+    AssertShowMessageReturnStmt(g_DeviceHandle, ASSERT_MESSAGE_DRIVER_NOT_LOADED, AssertReturn);
+
+    if (CommandTokens.size() == 1)
+    {
+        CommandLogBufferShowStatistics();
+        return;
+    }
+
+    if (CompareLowerCaseStrings(CommandTokens.at(1), "coalesce"))
+    {
+        //
+        // Set the thresholds of sending non-immediate messages
+        //
+        if (!ConvertTokenToUInt32(CommandTokens.at(2), &Request.CoalescingByteThreshold))
+        {
+            ShowMessages("err, couldn't resolve error at '%s'\n\n",
+                         GetCaseSensitiveStringFromCommandToken(CommandTokens.at(2)).c_str());
+            CommandLogBufferHelp();
+            return;
+        }
+
+        if (!ConvertTokenToUInt32(CommandTokens.at(3), &Request.CoalescingLatency))
+        {
+            ShowMessages("err, couldn't resolve error at '%s'\n\n",
+                         GetCaseSensitiveStringFromCommandToken(CommandTokens.at(3)).c_str());
+            CommandLogBufferHelp();
+            return;
+        }
+
+        Request.SetCoalescing = TRUE;
+
+        if (CommandLogBufferSendRequest(&Request, SIZEOF_DEBUGGER_LOG_BUFFER_STATISTICS))
+        {
+            ShowMessages("set the byte threshold of non-immediate messages to 0x%x and the latency "
+                         "threshold to %u microseconds%s\n",
+                         Request.CoalescingByteThreshold,
+                         Request.CoalescingLatency,
+                         Request.CoalescingLatency == 0 ? " (no limit)" : "");
+        }
+
+        return;
+    }
+
+    //
+    // Set the policy of the buffers
+    //
+    if (CompareLowerCaseStrings(CommandTokens.at(2), "regular"))
+    {
+        Request.Priority = FALSE;
+    }
+    else if (CompareLowerCaseStrings(CommandTokens.at(2), "priority"))
+    {
+        Request.Priority = TRUE;
+    }
+    else
+    {
+        ShowMessages("err, couldn't resolve error at '%s'\n\n",
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(2)).c_str());
+        CommandLogBufferHelp();
+        return;
+    }
+
+    if (CompareLowerCaseStrings(CommandTokens.at(3), "overwrite"))
+    {
+        Request.Policy = LOG_OVERFLOW_POLICY_OVERWRITE_OLDEST;
+    }
+    else if (CompareLowerCaseStrings(CommandTokens.at(3), "drop"))
+    {
+        Request.Policy = LOG_OVERFLOW_POLICY_DROP_NEWEST;
+    }
+    else if (CompareLowerCaseStrings(CommandTokens.at(3), "block"))
+    {
+        Request.Policy = LOG_OVERFLOW_POLICY_BLOCK;
+    }
+    else
+    {
+        ShowMessages("err, couldn't resolve error at '%s'\n\n",
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(3)).c_str());
+        CommandLogBufferHelp();
+        return;
+    }
+
+    Request.SetPolicy = TRUE;
+
+    if (CommandLogBufferSendRequest(&Request, SIZEOF_DEBUGGER_LOG_BUFFER_STATISTICS))
+    {
+        ShowMessages("set the overflow policy of %s buffers to %s\n",
+                     Request.Priority ? "priority" : "regular",
+                     CommandLogBufferGetPolicyName(Request.Policy));
+    }
+}
@@ -178,6 +178,14 @@ HyperDbgReadAllRegisters(GUEST_REGS * GuestRegisters, GUEST_EXTRA_REGISTERS * Ex
     DEBUGGEE_REGISTER_READ_DESCRIPTION * RegState       = NULL;
     UINT32                               SizeOfRegState = 0;
 
+    //
+    // The registers might be received along with the pause packet
+    //
+    if (KdMemoryCacheReadRegisters(GuestRegisters, ExtraRegisters))
+    {
+        return TRUE;
+    }
+
     //
     // Calculate the size of the register state
     //
@@ -35,9 +35,13 @@ CommandSearchMemoryHelp()
         "\n If you want to search in physical (address) memory then add '!' "
         "at the start of the command\n");
 
-    ShowMessages("syntax : \tsb [StartAddress (hex)] [l Length (hex)] [BytePattern (hex)] [pid ProcessId (hex)]\n");
-    ShowMessages("syntax : \tsd [StartAddress (hex)] [l Length (hex)] [BytePattern (hex)] [pid ProcessId (hex)]\n");
-    ShowMessages("syntax : \tsq [StartAddress (hex)] [l Length (hex)] [BytePattern (hex)] [pid ProcessId (hex)]\n");
+    ShowMessages(
+        "\n Up to %d patterns could be searched at once by separating them with 'or'\n",
+        MaximumSearchPatterns);
+
+    ShowMessages("syntax : \tsb [StartAddress (hex)] [l Length (hex)] [BytePattern (hex)] [or BytePattern (hex)]* [pid ProcessId (hex)]\n");
+    ShowMessages("syntax : \tsd [StartAddress (hex)] [l Length (hex)] [BytePattern (hex)] [or BytePattern (hex)]* [pid ProcessId (hex)]\n");
+    ShowMessages("syntax : \tsq [StartAddress (hex)] [l Length (hex)] [BytePattern (hex)] [or BytePattern (hex)]* [pid ProcessId (hex)]\n");
 
     ShowMessages("\n");
     ShowMessages("\t\te.g : sb nt!ExAllocatePoolWithTag 90 85 95 l ffff \n");
@@ -45,6 +49,7 @@ CommandSearchMemoryHelp()
     ShowMessages("\t\te.g : sb @rcx+5 90 85 95 l ffff \n");
     ShowMessages("\t\te.g : sb fffff8077356f010 90 85 95 l ffff \n");
     ShowMessages("\t\te.g : sd fffff8077356f010 90423580 l ffff pid 1c0 \n");
+    ShowMessages("\t\te.g : sb nt!ExAllocatePoolWithTag 90 85 or cc cc or 48 89 l ffff \n");
     ShowMessages("\t\te.g : !sq 100000 9090909090909090 l ffff\n");
     ShowMessages("\t\te.g : !sq @rdx+r12 9090909090909090 l ffff\n");
     ShowMessages("\t\te.g : !sq 100000 9090909090909090 9090909090909090 "
@@ -63,32 +68,33 @@ CommandSearchSendRequest(UINT64 * BufferToSendAsIoctl, UINT32 BufferToSendAsIoct
 {
     BOOL    Status;
     UINT64  CurrentValue;
+    UINT64  CountOfResults;
     PUINT64 ResultsBuffer = NULL;
 
     //
-    // Allocate a buffer to store the results
+    // Allocate a buffer to store the results (and the number of
+    // all of the matched addresses after them)
     //
-    ResultsBuffer = (PUINT64)malloc(MaximumSearchResults * sizeof(UINT64));
+    ResultsBuffer = (PUINT64)malloc(SIZEOF_DEBUGGER_SEARCH_MEMORY_RESULTS);
 
     //
     // Also it's better to Zero the memory; however it's not necessary
     // as we zero the buffer in the search routines
     //
-    ZeroMemory(ResultsBuffer, MaximumSearchResults * sizeof(UINT64));
+    ZeroMemory(ResultsBuffer, SIZEOF_DEBUGGER_SEARCH_MEMORY_RESULTS);
 
     //
     // Fire the IOCTL
     //
     Status =
-        DeviceIoControl(g_DeviceHandle,               // Handle to device
-                        IOCTL_DEBUGGER_SEARCH_MEMORY, // IO Control Code (IOCTL)
-                        BufferToSendAsIoctl,          // Input Buffer to driver.
-                        BufferToSendAsIoctlSize,      // Input buffer length
-                        ResultsBuffer,                // Output Buffer from driver.
-                        MaximumSearchResults *
-                            sizeof(UINT64), // Length of output buffer in bytes.
-                        NULL,               // Bytes placed in buffer.
-                        NULL                // synchronous call
+        DeviceIoControl(g_DeviceHandle,                        // Handle to device
+                        IOCTL_DEBUGGER_SEARCH_MEMORY,          // IO Control Code (IOCTL)
+                        BufferToSendAsIoctl,                   // Input Buffer to driver.
+                        BufferToSendAsIoctlSize,               // Input buffer length
+                        ResultsBuffer,                         // Output Buffer from driver.
+                        SIZEOF_DEBUGGER_SEARCH_MEMORY_RESULTS, // Length of output buffer in bytes.
+                        NULL,                                  // Bytes placed in buffer.
+                        NULL                                   // synchronous call
         );
 
     if (!Status)
@@ -121,6 +127,17 @@ CommandSearchSendRequest(UINT64 * BufferToSendAsIoctl, UINT32 BufferToSendAsIoct
         ShowMessages("%llx\n", CurrentValue);
     }
 
+    //
+    // Check whether the results are truncated or not (the kernel counts all
+    // of the matched addresses)
+    //
+    CountOfResults = ResultsBuffer[MaximumSearchResults];
+
+    if (CountOfResults > MaximumSearchResults)
+    {
+        ShowMessages("only the first %d results (of %llu) are shown\n", MaximumSearchResults, CountOfResults);
+    }
+
     //
     // Free buffer
     //
@@ -151,6 +168,9 @@ CommandSearchMemory(vector<CommandToken> CommandTokens, string Command)
     UINT64                 Length              = 0;
     UINT32                 ProcId              = 0;
     UINT32                 CountOfValues       = 0;
+    UINT32                 LengthOfPattern     = 0;
+    UINT32                 SizeOfEachValue     = sizeof(UINT64);
+    vector<UINT32>         PatternLengths;
     UINT32                 FinalSize           = 0;
     UINT64 *               FinalBuffer         = NULL;
     BOOLEAN                IsFirstCommand      = TRUE;
@@ -287,6 +307,23 @@ CommandSearchMemory(vector<CommandToken> CommandTokens, string Command)
             continue;
         }
 
+        //
+        // Check if it's the start of another pattern or not
+        //
+        if (SetAddress && CompareLowerCaseStrings(Section, "or"))
+        {
+            if (LengthOfPattern == 0)
+            {
+                ShowMessages("please specify a pattern before and after 'or'\n\n");
+                CommandSearchMemoryHelp();
+                return;
+            }
+
+            PatternLengths.push_back(LengthOfPattern);
+            LengthOfPattern = 0;
+            continue;
+        }
+
         if (!SetAddress)
         {
             if (!SymbolConvertNameOrExprToAddress(GetCaseSensitiveStringFromCommandToken(Section), &Address))
@@ -368,6 +405,7 @@ CommandSearchMemory(vector<CommandToken> CommandTokens, string Command)
                 // Keep track of values to modify
                 //
                 CountOfValues++;
+                LengthOfPattern++;
 
                 if (!SetValue)
                 {
@@ -436,6 +474,44 @@ CommandSearchMemory(vector<CommandToken> CommandTokens, string Command)
         CommandSearchMemoryHelp();
         return;
     }
+    if (LengthOfPattern == 0)
+    {
+        ShowMessages("please specify a pattern before and after 'or'\n\n");
+        CommandSearchMemoryHelp();
+        return;
+    }
+
+    //
+    // Add the last pattern
+    //
+    PatternLengths.push_back(LengthOfPattern);
+
+    if (PatternLengths.size() > MaximumSearchPatterns)
+    {
+        ShowMessages("err, up to %d patterns could be searched at once\n\n", MaximumSearchPatterns);
+        return;
+    }
+
+    if (SearchMemoryRequest.ByteSize == SEARCH_BYTE)
+    {
+        SizeOfEachValue = sizeof(BYTE);
+    }
+    else if (SearchMemoryRequest.ByteSize == SEARCH_DWORD)
+    {
+        SizeOfEachValue = sizeof(DWORD);
+    }
+
+    if (CountOfValues * SizeOfEachValue > MaximumSearchPatternsSize)
+    {
+        ShowMessages("err, the patterns could not be more than 0x%x bytes\n\n", MaximumSearchPatternsSize);
+        return;
+    }
+
+    //
+    // Set the patterns
+    //
+    SearchMemoryRequest.CountOfPatterns = (UINT32)PatternLengths.size();
+    std::copy(PatternLengths.begin(), PatternLengths.end(), SearchMemoryRequest.PatternLengths);
 
     //
     // Now it's time to put everything together in one structure
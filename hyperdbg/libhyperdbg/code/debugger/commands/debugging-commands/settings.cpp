@@ -16,9 +16,15 @@
 //
 extern BOOLEAN g_AutoUnpause;
 extern BOOLEAN g_AutoFlush;
+extern BOOLEAN g_UseSharedLogRings;
+extern BOOLEAN g_CompressRemoteLogs;
 extern BOOLEAN g_AddressConversion;
 extern BOOLEAN g_IsConnectedToRemoteDebuggee;
 extern UINT32  g_DisassemblerSyntax;
+extern UINT32  g_KdRequestWindowSize;
+extern BOOLEAN g_KdSendBreakContext;
+extern UINT32  g_KdBreakContextCodeBytes;
+extern UINT32  g_KdBreakContextStackQwords;
 
 /**
  * @brief help of the settings command
@@ -35,6 +41,7 @@ CommandSettingsHelp()
     ShowMessages("syntax : \tsettings [OptionName (string)] [Value (hex)]\n");
     ShowMessages("syntax : \tsettings [OptionName (string)] [Value (string)]\n");
     ShowMessages("syntax : \tsettings [OptionName (string)] [on|off]\n");
+    ShowMessages("syntax : \tsettings breakcontext [CodeBytes (hex)] [StackQwords (hex)]\n");
 
     ShowMessages("\n");
     ShowMessages("\t\te.g : settings autounpause\n");
@@ -44,6 +51,16 @@ CommandSettingsHelp()
     ShowMessages("\t\te.g : settings addressconversion off\n");
     ShowMessages("\t\te.g : settings autoflush on\n");
     ShowMessages("\t\te.g : settings autoflush off\n");
+    ShowMessages("\t\te.g : settings sharedlogs on\n");
+    ShowMessages("\t\te.g : settings sharedlogs off\n");
+    ShowMessages("\t\te.g : settings compression on\n");
+    ShowMessages("\t\te.g : settings compression off\n");
+    ShowMessages("\t\te.g : settings requestwindow\n");
+    ShowMessages("\t\te.g : settings requestwindow 8\n");
+    ShowMessages("\t\te.g : settings breakcontext\n");
+    ShowMessages("\t\te.g : settings breakcontext on\n");
+    ShowMessages("\t\te.g : settings breakcontext off\n");
+    ShowMessages("\t\te.g : settings breakcontext 40 10\n");
     ShowMessages("\t\te.g : settings syntax intel\n");
     ShowMessages("\t\te.g : settings syntax att\n");
     ShowMessages("\t\te.g : settings syntax masm\n");
@@ -240,6 +257,128 @@ CommandSettingsLoadDefaultValuesFromConfigFile()
         }
     }
 
+    //
+    // Set the shared log rings
+    //
+    if (CommandSettingsGetValueFromConfigFile("SharedLogs", OptionValue))
+    {
+        if (!OptionValue.compare("on"))
+        {
+            g_UseSharedLogRings = TRUE;
+        }
+        else if (!OptionValue.compare("off"))
+        {
+            g_UseSharedLogRings = FALSE;
+        }
+        else
+        {
+            //
+            // Sth is incorrect
+            //
+            ShowMessages("err, incorrect shared logs settings\n");
+        }
+    }
+
+    //
+    // Set the compression of the messages of the debuggee
+    //
+    if (CommandSettingsGetValueFromConfigFile("Compression", OptionValue))
+    {
+        if (!OptionValue.compare("on"))
+        {
+            g_CompressRemoteLogs = TRUE;
+        }
+        else if (!OptionValue.compare("off"))
+        {
+            g_CompressRemoteLogs = FALSE;
+        }
+        else
+        {
+            //
+            // Sth is incorrect
+            //
+            ShowMessages("err, incorrect compression settings\n");
+        }
+    }
+
+    //
+    // Set the number of outstanding requests of the kernel debugger
+    //
+    if (CommandSettingsGetValueFromConfigFile("RequestWindow", OptionValue))
+    {
+        UINT32 WindowSize = 0;
+
+        if (ConvertStringToUInt32(OptionValue, &WindowSize) &&
+            WindowSize != 0 &&
+            WindowSize <= PIPELINE_MAXIMUM_WINDOW_SIZE)
+        {
+            g_KdRequestWindowSize = WindowSize;
+        }
+        else
+        {
+            //
+            // Sth is incorrect
+            //
+            ShowMessages("err, incorrect request window settings\n");
+        }
+    }
+
+    //
+    // Set the context of the core that is sent along with the pause packet
+    //
+    if (CommandSettingsGetValueFromConfigFile("BreakContext", OptionValue))
+    {
+        if (!OptionValue.compare("on"))
+        {
+            g_KdSendBreakContext = TRUE;
+        }
+        else if (!OptionValue.compare("off"))
+        {
+            g_KdSendBreakContext = FALSE;
+        }
+        else
+        {
+            //
+            // Sth is incorrect
+            //
+            ShowMessages("err, incorrect break context settings\n");
+        }
+    }
+
+    if (CommandSettingsGetValueFromConfigFile("BreakContextCodeBytes", OptionValue))
+    {
+        UINT32 CodeBytes = 0;
+
+        if (ConvertStringToUInt32(OptionValue, &CodeBytes) && CodeBytes <= DEBUGGEE_BREAK_CONTEXT_MAXIMUM_CODE_BYTES)
+        {
+            g_KdBreakContextCodeBytes = CodeBytes;
+        }
+        else
+        {
+            //
+            // Sth is incorrect
+            //
+            ShowMessages("err, incorrect break context code bytes settings\n");
+        }
+    }
+
+    if (CommandSettingsGetValueFromConfigFile("BreakContextStackQwords", OptionValue))
+    {
+        UINT32 StackQwords = 0;
+
+        if (ConvertStringToUInt32(OptionValue, &StackQwords) && StackQwords <= DEBUGGEE_BREAK_CONTEXT_MAXIMUM_STACK_QWORDS)
+        {
+            g_KdBreakContextStackQwords = StackQwords;
+        }
+        else
+        {
+            //
+            // Sth is incorrect
+            //
+            ShowMessages("err, incorrect break context stack qwords settings\n");
+        }
+    }
+
     //
     // Set the address conversion
     //
@@ -396,6 +535,294 @@ CommandSettingsAutoFlush(vector<CommandToken> CommandTokens)
     }
 }
 
+/**
+ * @brief set the shared log rings mode to enabled and disabled
+ * and query the status of this mode
+ * @details In this mode, the log rings are mapped (read-only) into the
+ * debugger process and messages are read from them in place
+ *
+ * @param CommandTokens
+ * @return VOID
+ */
+VOID
+CommandSettingsSharedLogs(vector<CommandToken> CommandTokens)
+{
+    if (CommandTokens.size() == 2)
+    {
+        //
+        // It's a query
+        //
+        if (g_UseSharedLogRings)
+        {
+            ShowMessages("shared-logs is enabled\n");
+        }
+        else
+        {
+            ShowMessages("shared-logs is disabled\n");
+        }
+    }
+    else if (CommandTokens.size() == 3)
+    {
+        //
+        // The user tries to set a value as the sharedlogs, the reader
+        // thread maps (or unmaps) the rings before reading the next messages
+        //
+        if (CompareLowerCaseStrings(CommandTokens.at(2), "on"))
+        {
+            g_UseSharedLogRings = TRUE;
+            CommandSettingsSetValueFromConfigFile("SharedLogs", "on");
+
+            ShowMessages("set shared-logs to enabled\n");
+        }
+        else if (CompareLowerCaseStrings(CommandTokens.at(2), "off"))
+        {
+            g_UseSharedLogRings = FALSE;
+            CommandSettingsSetValueFromConfigFile("SharedLogs", "off");
+
+            ShowMessages("set shared-logs to disabled\n");
+        }
+        else
+        {
+            //
+            // Sth is incorrect
+            //
+            ShowMessages("incorrect use of the '%s', please use 'help %s' for more information\n",
+                         GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str(),
+                         GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str());
+            return;
+        }
+    }
+    else
+    {
+        //
+        // Sth is incorrect
+        //
+        ShowMessages("incorrect use of the '%s', please use 'help %s' for more information\n",
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str(),
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str());
+        return;
+    }
+}
+
+/**
+ * @brief set the compression of the messages of the debuggee to enabled
+ * and disabled and query the status of this mode
+ * @details The debuggee is informed at the time of connection, so the
+ * new value is applied on the next connection
+ *
+ * @param CommandTokens
+ * @return VOID
+ */
+VOID
+CommandSettingsCompression(vector<CommandToken> CommandTokens)
+{
+    if (CommandTokens.size() == 2)
+    {
+        //
+        // It's a query
+        //
+        if (g_CompressRemoteLogs)
+        {
+            ShowMessages("compression is enabled\n");
+        }
+        else
+        {
+            ShowMessages("compression is disabled\n");
+        }
+    }
+    else if (CommandTokens.size() == 3)
+    {
+        //
+        // The user tries to set a value as the compression
+        //
+        if (CompareLowerCaseStrings(CommandTokens.at(2), "on"))
+        {
+            g_CompressRemoteLogs = TRUE;
+            CommandSettingsSetValueFromConfigFile("Compression", "on");
+
+            ShowMessages("set compression to enabled (applied on the next connection)\n");
+        }
+        else if (CompareLowerCaseStrings(CommandTokens.at(2), "off"))
+        {
+            g_CompressRemoteLogs = FALSE;
+            CommandSettingsSetValueFromConfigFile("Compression", "off");
+
+            ShowMessages("set compression to disabled (applied on the next connection)\n");
+        }
+        else
+        {
+            //
+            // Sth is incorrect
+            //
+            ShowMessages("incorrect use of the '%s', please use 'help %s' for more information\n",
+                         GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str(),
+                         GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str());
+            return;
+        }
+    }
+    else
+    {
+        //
+        // Sth is incorrect
+        //
+        ShowMessages("incorrect use of the '%s', please use 'help %s' for more information\n",
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str(),
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str());
+        return;
+    }
+}
+
+/**
+ * @brief set the number of outstanding requests of the kernel debugger
+ * and query it
+ * @details One means that the debugger waits for the response of each
+ * request before sending the next one
+ *
+ * @param CommandTokens
+ * @return VOID
+ */
+VOID
+CommandSettingsRequestWindow(vector<CommandToken> CommandTokens)
+{
+    UINT32 WindowSize           = 0;
+    CHAR   WindowSizeString[16] = {0};
+
+    if (CommandTokens.size() == 2)
+    {
+        //
+        // It's a query
+        //
+        ShowMessages("request window is %x\n", g_KdRequestWindowSize);
+    }
+    else if (CommandTokens.size() == 3)
+    {
+        //
+        // The user tries to set a value as the request window
+        //
+        if (!ConvertTokenToUInt32(CommandTokens.at(2), &WindowSize) ||
+            WindowSize == 0 ||
+            WindowSize > PIPELINE_MAXIMUM_WINDOW_SIZE)
+        {
+            ShowMessages("err, the request window should be between 1 and %x\n", PIPELINE_MAXIMUM_WINDOW_SIZE);
+            return;
+        }
+
+        //
+        // Values are saved in hex
+        //
+        sprintf_s(WindowSizeString, sizeof(WindowSizeString), "%x", WindowSize);
+
+        g_KdRequestWindowSize = WindowSize;
+        CommandSettingsSetValueFromConfigFile("RequestWindow", WindowSizeString);
+
+        ShowMessages("set request window to %x\n", WindowSize);
+    }
+    else
+    {
+        //
+        // Sth is incorrect
+        //
+        ShowMessages("incorrect use of the '%s', please use 'help %s' for more information\n",
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str(),
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str());
+        return;
+    }
+}
+
+/**
+ * @brief set the context of the core that the debuggee sends along with
+ * the pause packet (registers, the bytes at RIP and the qwords at RSP)
+ * and query it
+ * @details The debuggee is informed at the time of connection, so the
+ * new value is applied on the next connection
+ *
+ * @param CommandTokens
+ * @return VOID
+ */
+VOID
+CommandSettingsBreakContext(vector<CommandToken> CommandTokens)
+{
+    UINT32 CodeBytes       = 0;
+    UINT32 StackQwords     = 0;
+    CHAR   ValueString[16] = {0};
+
+    if (CommandTokens.size() == 2)
+    {
+        //
+        // It's a query
+        //
+        if (g_KdSendBreakContext)
+        {
+            ShowMessages("break context is enabled (code bytes: %x, stack qwords: %x)\n",
+                         g_KdBreakContextCodeBytes,
+                         g_KdBreakContextStackQwords);
+        }
+        else
+        {
+            ShowMessages("break context is disabled\n");
+        }
+    }
+    else if (CommandTokens.size() == 3 && CompareLowerCaseStrings(CommandTokens.at(2), "on"))
+    {
+        g_KdSendBreakContext = TRUE;
+        CommandSettingsSetValueFromConfigFile("BreakContext", "on");
+
+        ShowMessages("set break context to enabled (applied on the next connection)\n");
+    }
+    else if (CommandTokens.size() == 3 && CompareLowerCaseStrings(CommandTokens.at(2), "off"))
+    {
+        g_KdSendBreakContext = FALSE;
+        CommandSettingsSetValueFromConfigFile("BreakContext", "off");
+
+        ShowMessages("set break context to disabled (applied on the next connection)\n");
+    }
+    else if (CommandTokens.size() == 4)
+    {
+        //
+        // The user tries to set the sizes of the context
+        //
+        if (!ConvertTokenToUInt32(CommandTokens.at(2), &CodeBytes) ||
+            CodeBytes > DEBUGGEE_BREAK_CONTEXT_MAXIMUM_CODE_BYTES)
+        {
+            ShowMessages("err, the code bytes should not be greater than %x\n", DEBUGGEE_BREAK_CONTEXT_MAXIMUM_CODE_BYTES);
+            return;
+        }
+
+        if (!ConvertTokenToUInt32(CommandTokens.at(3), &StackQwords) ||
+            StackQwords > DEBUGGEE_BREAK_CONTEXT_MAXIMUM_STACK_QWORDS)
+        {
+            ShowMessages("err, the stack qwords should not be greater than %x\n", DEBUGGEE_BREAK_CONTEXT_MAXIMUM_STACK_QWORDS);
+            return;
+        }
+
+        g_KdBreakContextCodeBytes   = CodeBytes;
+        g_KdBreakContextStackQwords = StackQwords;
+
+        //
+        // Values are saved in hex
+        //
+        sprintf_s(ValueString, sizeof(ValueString), "%x", CodeBytes);
+        CommandSettingsSetValueFromConfigFile("BreakContextCodeBytes", ValueString);
+
+        sprintf_s(ValueString, sizeof(ValueString), "%x", StackQwords);
+        CommandSettingsSetValueFromConfigFile("BreakContextStackQwords", ValueString);
+
+        ShowMessages("set break context to code bytes: %x, stack qwords: %x (applied on the next connection)\n",
+                     CodeBytes,
+                     StackQwords);
+    }
+    else
+    {
+        //
+        // Sth is incorrect
+        //
+        ShowMessages("incorrect use of the '%s', please use 'help %s' for more information\n",
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str(),
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str());
+        return;
+    }
+}
+
 /**
  * @brief set auto-unpause mode to enabled or disabled
  *
@@ -606,6 +1033,34 @@ CommandSettings(vector<CommandToken> CommandTokens, string Command)
             CommandSettingsAutoFlush(CommandTokens);
         }
     }
+    else if (CompareLowerCaseStrings(CommandTokens.at(1), "sharedlogs"))
+    {
+        //
+        // The rings of the local machine are mapped, so it's not sent to the remote debugger
+        //
+        CommandSettingsSharedLogs(CommandTokens);
+    }
+    else if (CompareLowerCaseStrings(CommandTokens.at(1), "compression"))
+    {
+        //
+        // It's negotiated by the debugger side of the serial connection
+        //
+        CommandSettingsCompression(CommandTokens);
+    }
+    else if (CompareLowerCaseStrings(CommandTokens.at(1), "requestwindow"))
+    {
+        //
+        // It's used by the debugger side of the serial connection
+        //
+        CommandSettingsRequestWindow(CommandTokens);
+    }
+    else if (CompareLowerCaseStrings(CommandTokens.at(1), "breakcontext"))
+    {
+        //
+        // It's negotiated by the debugger side of the serial connection
+        //
+        CommandSettingsBreakContext(CommandTokens);
+    }
     else if (CompareLowerCaseStrings(CommandTokens.at(1), "addressconversion"))
     {
         //
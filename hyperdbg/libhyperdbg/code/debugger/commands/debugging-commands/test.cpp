@@ -123,6 +123,67 @@ CommandTestAllFunctionalities()
         ShowMessages("err, start HyperDbg test process for testing semantic tests\n");
         return;
     }
+
+    // Test the compression of messages
+    if (!OpenHyperDbgTestProcess(&ThreadHandle, &ProcessHandle, (CHAR *)TEST_CASE_PARAMETER_FOR_COMPRESSION))
+    {
+        ShowMessages("err, start HyperDbg test process for testing compression\n");
+        return;
+    }
+
+    //
+    // Test the framing of the remote packets
+    //
+    if (!OpenHyperDbgTestProcess(&ThreadHandle, &ProcessHandle, (CHAR *)TEST_CASE_PARAMETER_FOR_FRAMING))
+    {
+        ShowMessages("err, start HyperDbg test process for testing framing\n");
+        return;
+    }
+
+    //
+    // Test the pipelined requests
+    //
+    if (!OpenHyperDbgTestProcess(&ThreadHandle, &ProcessHandle, (CHAR *)TEST_CASE_PARAMETER_FOR_PIPELINE))
+    {
+        ShowMessages("err, start HyperDbg test process for testing pipelined requests\n");
+        return;
+    }
+
+    //
+    // Test the search of memory blocks
+    //
+    if (!OpenHyperDbgTestProcess(&ThreadHandle, &ProcessHandle, (CHAR *)TEST_CASE_PARAMETER_FOR_SEARCH))
+    {
+        ShowMessages("err, start HyperDbg test process for testing search\n");
+        return;
+    }
+
+    //
+    // Test the transports of the kernel debugger
+    //
+    if (!OpenHyperDbgTestProcess(&ThreadHandle, &ProcessHandle, (CHAR *)TEST_CASE_PARAMETER_FOR_TRANSPORT))
+    {
+        ShowMessages("err, start HyperDbg test process for testing transports\n");
+        return;
+    }
+
+    //
+    // Test the rings of the logs
+    //
+    if (!OpenHyperDbgTestProcess(&ThreadHandle, &ProcessHandle, (CHAR *)TEST_CASE_PARAMETER_FOR_RING))
+    {
+        ShowMessages("err, start HyperDbg test process for testing rings\n");
+        return;
+    }
+
+    //
+    // Test the (local) evaluation of scripts
+    //
+    if (!OpenHyperDbgTestProcess(&ThreadHandle, &ProcessHandle, (CHAR *)TEST_CASE_PARAMETER_FOR_SCRIPT_ENGINE))
+    {
+        ShowMessages("err, start HyperDbg test process for testing script engine\n");
+        return;
+    }
 }
 
 /**
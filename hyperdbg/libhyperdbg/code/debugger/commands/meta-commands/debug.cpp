@@ -15,7 +15,6 @@
 // Global Variables
 //
 extern HANDLE  g_SerialListeningThreadHandle;
-extern HANDLE  g_SerialRemoteComPortHandle;
 extern BOOLEAN g_IsSerialConnectedToRemoteDebuggee;
 extern BOOLEAN g_IsSerialConnectedToRemoteDebugger;
 extern BOOLEAN g_IsDebuggeeRunning;
@@ -33,6 +32,8 @@ CommandDebugHelp()
 
     ShowMessages(
         "syntax : \t.debug [remote] [serial|namedpipe] [pause] [Baudrate (decimal)] [Address (string)]\n");
+    ShowMessages(
+        "syntax : \t.debug [remote] [tcp] [pause] [Address (string)] [Port (decimal)]\n");
     ShowMessages(
         "syntax : \t.debug [prepare] [serial] [Baudrate (decimal)] [Address (string)]\n");
     ShowMessages("syntax : \t.debug [close]\n");
@@ -43,6 +44,8 @@ CommandDebugHelp()
     ShowMessages("\t\te.g : .debug remote namedpipe \\\\.\\pipe\\HyperDbgPipe\n");
     ShowMessages("\t\te.g : .debug remote pause namedpipe \\\\.\\pipe\\HyperDbgPipe\n");
     ShowMessages("\t\te.g : .debug remote namedpipe \"\\\\.\\pipe\\HyperDbg Pipe\"\n");
+    ShowMessages("\t\te.g : .debug remote tcp 127.0.0.1 50001\n");
+    ShowMessages("\t\te.g : .debug remote pause tcp 192.168.1.10 50001\n");
     ShowMessages("\t\te.g : .debug prepare serial 115200 com1\n");
     ShowMessages("\t\te.g : .debug prepare serial 115200 com2\n");
     ShowMessages("\t\te.g : .debug close\n");
@@ -163,6 +166,23 @@ HyperDbgDebugRemoteDeviceUsingNamedPipe(const CHAR * NamedPipe, BOOLEAN PauseAft
     return KdPrepareAndConnectDebugPort(NamedPipe, NULL, NULL, FALSE, TRUE, PauseAfterConnection);
 }
 
+/**
+ * @brief Connect to a remote debuggee over TCP (Debugger)
+ * @details The serial port of the debuggee is exposed over TCP (e.g., by
+ * the virtual machine)
+ *
+ * @param Address
+ * @param Port
+ * @param PauseAfterConnection
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+HyperDbgDebugRemoteDeviceUsingTcp(const CHAR * Address, const CHAR * Port, BOOLEAN PauseAfterConnection)
+{
+    return KdPrepareAndConnectDebugSocket(Address, Port, PauseAfterConnection);
+}
+
 /**
  * @brief Connect to a remote serial device (Debuggee)
  *
@@ -245,9 +265,14 @@ CommandDebug(vector<CommandToken> CommandTokens, string Command)
     BOOLEAN IsPrepare               = FALSE;
     BOOLEAN IsSerial                = FALSE;
     BOOLEAN IsNamedPipe             = FALSE;
+    BOOLEAN IsTcp                   = FALSE;
     BOOLEAN IsPause                 = FALSE;
     BOOLEAN IsNamedPipeAddressKnown = FALSE;
     string  NamedPipeAddress;
+    BOOLEAN IsTcpAddressKnown = FALSE;
+    string  TcpAddress;
+    BOOLEAN IsTcpPortKnown = FALSE;
+    string  TcpPort;
     BOOLEAN IsComPortAddressKnown = FALSE;
     string  ComAddress;
     BOOLEAN IsComPortBaudrateKnown = FALSE;
@@ -299,6 +324,11 @@ CommandDebug(vector<CommandToken> CommandTokens, string Command)
             IsNamedPipe = TRUE;
             continue;
         }
+        else if (!IsTcp && CompareLowerCaseStrings(Section, "tcp"))
+        {
+            IsTcp = TRUE;
+            continue;
+        }
         else if (!IsPause && CompareLowerCaseStrings(Section, "pause"))
         {
             IsPause = TRUE;
@@ -310,6 +340,18 @@ CommandDebug(vector<CommandToken> CommandTokens, string Command)
             NamedPipeAddress        = GetCaseSensitiveStringFromCommandToken(Section);
             continue;
         }
+        else if (!IsTcpAddressKnown && IsTcp)
+        {
+            IsTcpAddressKnown = TRUE;
+            TcpAddress        = GetCaseSensitiveStringFromCommandToken(Section);
+            continue;
+        }
+        else if (!IsTcpPortKnown && IsTcp && IsNumber(GetCaseSensitiveStringFromCommandToken(Section)))
+        {
+            IsTcpPortKnown = TRUE;
+            TcpPort        = GetCaseSensitiveStringFromCommandToken(Section);
+            continue;
+        }
         else if (!IsComPortBaudrateKnown && IsSerial && IsNumber(GetCaseSensitiveStringFromCommandToken(Section)))
         {
             IsComPortBaudrateKnown = TRUE;
@@ -396,6 +438,26 @@ CommandDebug(vector<CommandToken> CommandTokens, string Command)
         return;
     }
 
+    //
+    // TCP cannot be used with the 'prepare' (the debuggee always uses a serial port)
+    //
+    if (IsTcp && IsPrepare)
+    {
+        ShowMessages("err, tcp cannot be used with 'prepare'\n\n");
+        CommandDebugHelp();
+        return;
+    }
+
+    //
+    // If it's TCP, the address and the port should be known
+    //
+    if (IsTcp && (!IsTcpAddressKnown || !IsTcpPortKnown))
+    {
+        ShowMessages("err, TCP address or port is unknown\n\n");
+        CommandDebugHelp();
+        return;
+    }
+
     //
     // Check if named pipe is empty or not if it's a named pipe
     //
@@ -435,6 +497,10 @@ CommandDebug(vector<CommandToken> CommandTokens, string Command)
         {
             HyperDbgDebugRemoteDeviceUsingNamedPipe(NamedPipeAddress.c_str(), IsPause);
         }
+        else if (IsTcp)
+        {
+            HyperDbgDebugRemoteDeviceUsingTcp(TcpAddress.c_str(), TcpPort.c_str(), IsPause);
+        }
         else if (IsSerial)
         {
             HyperDbgDebugRemoteDeviceUsingComPort(ComAddress.c_str(), Baudrate, IsPause);
@@ -15,6 +15,7 @@
 // Global Variables
 //
 extern BOOLEAN                  g_IsSerialConnectedToRemoteDebuggee;
+extern BOOLEAN                  g_KdFramedPackets;
 extern ACTIVE_DEBUGGING_PROCESS g_ActiveProcessDebuggingState;
 
 //
@@ -27,6 +28,19 @@ extern ACTIVE_DEBUGGING_PROCESS g_ActiveProcessDebuggingState;
  */
 HANDLE DumpFileHandle;
 
+/**
+ * @brief Holds the state of the streamed dump
+ * @details NULL if the dump is not streamed
+ *
+ */
+DUMP_STREAM_STATE * DumpStreamState = NULL;
+
+/**
+ * @brief Maximum number of pages that are requested at once from the debuggee
+ *
+ */
+#define DUMP_MAXIMUM_PIPELINED_PAGES 64
+
 /**
  * @brief help of the .dump command
  *
@@ -49,6 +63,622 @@ CommandDumpHelp()
     ShowMessages("\t\te.g : .dump 00007ff8349f2000 00007ff8349f8000 path c:\\rev\\dump5.dmp\n");
     ShowMessages("\t\te.g : .dump @rax+@rcx @rax+@rcx+1000 path c:\\rev\\dump6.dmp\n");
     ShowMessages("\t\te.g : !dump 1000 2100 path c:\\rev\\dump7.dmp\n");
+
+    ShowMessages("\nIn the debugger mode, the debuggee streams the range in large chunks "
+                 "(the pages are compressed and the pages that are filled with one byte are "
+                 "sent as runs), the pages that couldn't be read are filled with zeros\n");
+}
+
+/**
+ * @brief Dump the memory of the debuggee by pipelined read requests
+ * @details The pages are requested in batches, and in each batch up to the
+ * window size ('settings requestwindow') of requests are outstanding
+ *
+ * @param StartAddress
+ * @param Length
+ * @param MemoryType
+ * @param Pid
+ * @param KeepOffsets Whether the invalid pages are left as zeros or skipped
+ *
+ * @return VOID
+ */
+static VOID
+CommandDumpFromDebuggee(UINT64                    StartAddress,
+                        UINT32                    Length,
+                        DEBUGGER_READ_MEMORY_TYPE MemoryType,
+                        UINT32                    Pid,
+                        BOOLEAN                   KeepOffsets)
+{
+    PDEBUGGER_READ_MEMORY Requests[DUMP_MAXIMUM_PIPELINED_PAGES] = {0};
+    UINT32                RequestSizes[DUMP_MAXIMUM_PIPELINED_PAGES];
+    UINT32                NumberOfRequests;
+    UINT32                ActualLength;
+    LARGE_INTEGER         Distance;
+    UINT64                Address = StartAddress;
+
+    //
+    // Allocate the buffers of a batch
+    //
+    for (UINT32 i = 0; i < DUMP_MAXIMUM_PIPELINED_PAGES; i++)
+    {
+        Requests[i] = (PDEBUGGER_READ_MEMORY)malloc(sizeof(DEBUGGER_READ_MEMORY) + PAGE_SIZE);
+
+        if (Requests[i] == NULL)
+        {
+            ShowMessages("err, unable to allocate the buffers of the requests\n");
+            goto FreeBuffers;
+        }
+    }
+
+    while (Length != 0)
+    {
+        NumberOfRequests = 0;
+
+        while (Length != 0 && NumberOfRequests < DUMP_MAXIMUM_PIPELINED_PAGES)
+        {
+            ActualLength = Length >= PAGE_SIZE ? PAGE_SIZE : Length;
+
+            ZeroMemory(Requests[NumberOfRequests], sizeof(DEBUGGER_READ_MEMORY));
+
+            Requests[NumberOfRequests]->Address     = Address;
+            Requests[NumberOfRequests]->Pid         = Pid;
+            Requests[NumberOfRequests]->Size        = ActualLength;
+            Requests[NumberOfRequests]->MemoryType  = MemoryType;
+            Requests[NumberOfRequests]->ReadingType = READ_FROM_KERNEL;
+
+            RequestSizes[NumberOfRequests] = sizeof(DEBUGGER_READ_MEMORY) + ActualLength;
+
+            Address += ActualLength;
+            Length -= ActualLength;
+            NumberOfRequests++;
+        }
+
+        if (!KdSendPipelinedReadMemoryPacketsToDebuggee(Requests, RequestSizes, NumberOfRequests))
+        {
+            ShowMessages("err, unable to read the memory of the debuggee\n");
+            break;
+        }
+
+        //
+        // The pages are saved in order
+        //
+        for (UINT32 i = 0; i < NumberOfRequests; i++)
+        {
+            if (Requests[i]->KernelStatus != DEBUGGER_OPERATION_WAS_SUCCESSFUL)
+            {
+                ShowErrorMessage(Requests[i]->KernelStatus);
+                ShowMessages("HyperDbg attempted to access an invalid target address: 0x%llx\n"
+                             "the page may be paged out, you can use the '.pagein' command to bring it into memory\n\n",
+                             Requests[i]->Address);
+
+                //
+                // The pages of the other ranges are at their offsets, so the
+                // invalid page is left as zeros
+                //
+                if (KeepOffsets)
+                {
+                    Distance.QuadPart = Requests[i]->Size;
+                    SetFilePointerEx(DumpFileHandle, Distance, NULL, FILE_CURRENT);
+                }
+
+                continue;
+            }
+
+            CommandDumpSaveIntoFile((CHAR *)Requests[i] + sizeof(DEBUGGER_READ_MEMORY), Requests[i]->Size);
+        }
+    }
+
+FreeBuffers:
+
+    for (UINT32 i = 0; i < DUMP_MAXIMUM_PIPELINED_PAGES; i++)
+    {
+        free(Requests[i]);
+    }
+}
+
+/**
+ * @brief Write a buffer at an offset of the dump file
+ *
+ * @param Offset
+ * @param Buffer
+ * @param Length
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+CommandDumpWriteAt(UINT64 Offset, PVOID Buffer, UINT32 Length)
+{
+    OVERLAPPED Overlapped = {0};
+    DWORD      BytesWritten;
+
+    //
+    // The handle is not opened for overlapped I/O, so the write is
+    // synchronous and only the offset is used
+    //
+    Overlapped.Offset     = (DWORD)Offset;
+    Overlapped.OffsetHigh = (DWORD)(Offset >> 32);
+
+    return WriteFile(DumpFileHandle, Buffer, Length, &BytesWritten, &Overlapped) && BytesWritten == Length;
+}
+
+/**
+ * @brief The thread that writes the decoded pages of the streamed dump
+ *
+ * @param Param The state of the streamed dump
+ *
+ * @return DWORD
+ */
+static DWORD WINAPI
+CommandDumpStreamWriterThread(LPVOID Param)
+{
+    DUMP_STREAM_STATE * State = (DUMP_STREAM_STATE *)Param;
+    DUMP_STREAM_WRITE   Write;
+    UINT8               FillBuffer[PAGE_SIZE];
+    UINT32              WriteLength;
+    BOOLEAN             IsFinished = FALSE;
+
+    while (!IsFinished)
+    {
+        WaitForSingleObject(State->WritesEvent, INFINITE);
+
+        while (TRUE)
+        {
+            SpinlockLock(&State->WritesLock);
+
+            if (State->Writes.empty())
+            {
+                IsFinished = State->IsFinished;
+                SpinlockUnlock(&State->WritesLock);
+                break;
+            }
+
+            Write = State->Writes.front();
+            State->Writes.pop_front();
+
+            SpinlockUnlock(&State->WritesLock);
+
+            //
+            // Once a write fails, the next buffers are only freed
+            //
+            if (!State->WriteFailed && Write.Buffer != NULL)
+            {
+                State->WriteFailed = !CommandDumpWriteAt(Write.Offset, Write.Buffer, Write.Length);
+            }
+            else if (!State->WriteFailed)
+            {
+                //
+                // The range is filled with one byte
+                //
+                memset(FillBuffer, Write.Fill, sizeof(FillBuffer));
+
+                for (UINT32 Written = 0; Written < Write.Length && !State->WriteFailed; Written += WriteLength)
+                {
+                    WriteLength = Write.Length - Written >= PAGE_SIZE ? PAGE_SIZE : Write.Length - Written;
+
+                    State->WriteFailed = !CommandDumpWriteAt(Write.Offset + Written, FillBuffer, WriteLength);
+                }
+            }
+
+            free(Write.Buffer);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Queue a range of the streamed dump to be written by the writer thread
+ *
+ * @param State
+ * @param Offset Offset of the range in the dump
+ * @param Length
+ * @param Fill The byte of the range (if there is no buffer)
+ * @param Buffer The bytes of the range (freed by the writer thread)
+ *
+ * @return VOID
+ */
+static VOID
+CommandDumpQueueWrite(DUMP_STREAM_STATE * State, UINT32 Offset, UINT32 Length, UINT8 Fill, UINT8 * Buffer)
+{
+    DUMP_STREAM_WRITE Write = {0};
+
+    Write.Offset = Offset;
+    Write.Length = Length;
+    Write.Fill   = Fill;
+    Write.Buffer = Buffer;
+
+    SpinlockLock(&State->WritesLock);
+
+    State->Writes.push_back(Write);
+
+    SpinlockUnlock(&State->WritesLock);
+
+    SetEvent(State->WritesEvent);
+}
+
+/**
+ * @brief Decode a raw or compressed page of a chunk of the streamed dump
+ *
+ * @param State
+ * @param Record
+ * @param StoredBytes The bytes after the record
+ * @param Offset Offset of the page in the dump
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+CommandDumpDecodePage(DUMP_STREAM_STATE * State, PDEBUGGEE_DUMP_MEMORY_RECORD Record, UINT8 * StoredBytes, UINT32 Offset)
+{
+    UINT8 * Buffer;
+    BOOLEAN Result;
+
+    if (Record->Length > PAGE_SIZE ||
+        (Record->Type == DEBUGGEE_DUMP_MEMORY_RECORD_RAW && Record->StoredLength != Record->Length) ||
+        (Record->Type == DEBUGGEE_DUMP_MEMORY_RECORD_COMPRESSED && Record->StoredLength >= Record->Length))
+    {
+        return FALSE;
+    }
+
+    Buffer = (UINT8 *)malloc(Record->Length);
+
+    if (Buffer == NULL)
+    {
+        return FALSE;
+    }
+
+    if (Record->Type == DEBUGGEE_DUMP_MEMORY_RECORD_RAW)
+    {
+        //
+        // The page is stored without compression (it's still added to the stream)
+        //
+        memcpy(Buffer, StoredBytes, Record->Length);
+
+        Result = CompressionStoreBlock(State->Stream, StoredBytes, Record->Length);
+    }
+    else
+    {
+        Result = CompressionDecompress(State->Stream, StoredBytes, Record->StoredLength, Buffer, Record->Length);
+    }
+
+    if (!Result)
+    {
+        free(Buffer);
+        return FALSE;
+    }
+
+    CommandDumpQueueWrite(State, Offset, Record->Length, 0, Buffer);
+
+    return TRUE;
+}
+
+/**
+ * @brief Handle a chunk of the streamed dump
+ * @details Called by the listening thread, the pages are decoded and queued
+ * for the writer thread. The ranges of the lost or invalid chunks are read
+ * again once the stream is finished
+ *
+ * @param Chunk
+ * @param ChunkLength Length of the chunk (including its header)
+ *
+ * @return VOID
+ */
+VOID
+CommandDumpHandleStreamedChunk(PDEBUGGEE_DUMP_MEMORY_CHUNK_PACKET Chunk, UINT32 ChunkLength)
+{
+    DUMP_STREAM_STATE *          State = DumpStreamState;
+    PDEBUGGEE_DUMP_MEMORY_RECORD Record;
+    DUMP_STREAM_GAP              Gap;
+    UINT32                       Position;
+    UINT32                       Offset;
+    UINT32                       EndOffset;
+    BOOLEAN                      IsValid = TRUE;
+
+    //
+    // The chunk doesn't belong to a streamed dump
+    //
+    if (State == NULL)
+    {
+        return;
+    }
+
+    if (ChunkLength < sizeof(DEBUGGEE_DUMP_MEMORY_CHUNK_PACKET))
+    {
+        ShowMessages("err, invalid chunk of the dump is received\n");
+        return;
+    }
+
+    //
+    // The chunk is already received (e.g., its frame is sent again)
+    //
+    if (Chunk->ChunkIndex < State->NextChunkIndex)
+    {
+        State->NumberOfDuplicatedChunks++;
+        return;
+    }
+
+    //
+    // The offset should match the index (the offset of the chunk right
+    // after the previous one is the expected offset)
+    //
+    if (Chunk->Offset < State->ExpectedOffset ||
+        (Chunk->ChunkIndex == State->NextChunkIndex && Chunk->Offset != State->ExpectedOffset) ||
+        Chunk->Offset > State->Length ||
+        Chunk->Length > State->Length - Chunk->Offset)
+    {
+        ShowMessages("err, invalid chunk of the dump is received\n");
+        return;
+    }
+
+    //
+    // The previous chunks are lost (their range is read again)
+    //
+    State->NumberOfLostChunks += Chunk->ChunkIndex - State->NextChunkIndex;
+
+    State->NextChunkIndex = Chunk->ChunkIndex + 1;
+
+    if (Chunk->Offset != State->ExpectedOffset)
+    {
+        Gap.Offset = State->ExpectedOffset;
+        Gap.Length = Chunk->Offset - State->ExpectedOffset;
+
+        State->Gaps.push_back(Gap);
+    }
+
+    EndOffset             = Chunk->Offset + Chunk->Length;
+    State->ExpectedOffset = EndOffset;
+
+    //
+    // Each chunk starts a new compression stream
+    //
+    CompressionResetStream(State->Stream);
+
+    Position = sizeof(DEBUGGEE_DUMP_MEMORY_CHUNK_PACKET);
+    Offset   = Chunk->Offset;
+
+    for (UINT32 i = 0; i < Chunk->NumberOfRecords && IsValid; i++)
+    {
+        if (ChunkLength - Position < sizeof(DEBUGGEE_DUMP_MEMORY_RECORD))
+        {
+            IsValid = FALSE;
+            break;
+        }
+
+        Record = (PDEBUGGEE_DUMP_MEMORY_RECORD)((UINT8 *)Chunk + Position);
+        Position += sizeof(DEBUGGEE_DUMP_MEMORY_RECORD);
+
+        if (Record->Length == 0 ||
+            Record->Length > EndOffset - Offset ||
+            Record->StoredLength > ChunkLength - Position)
+        {
+            IsValid = FALSE;
+            break;
+        }
+
+        switch (Record->Type)
+        {
+        case DEBUGGEE_DUMP_MEMORY_RECORD_RAW:
+        case DEBUGGEE_DUMP_MEMORY_RECORD_COMPRESSED:
+
+            IsValid = CommandDumpDecodePage(State, Record, (UINT8 *)Chunk + Position, Offset);
+
+            break;
+
+        case DEBUGGEE_DUMP_MEMORY_RECORD_FILL:
+
+            //
+            // The zero ranges are not written (the file is extended to
+            // the length of the dump at the end)
+            //
+            if (Record->Fill != 0)
+            {
+                CommandDumpQueueWrite(State, Offset, Record->Length, Record->Fill, NULL);
+            }
+
+            State->FilledLength += Record->Length;
+
+            break;
+
+        case DEBUGGEE_DUMP_MEMORY_RECORD_INVALID:
+
+            ShowMessages("HyperDbg attempted to access an invalid target address: 0x%llx, "
+                         "0x%x bytes of the dump are filled with zeros\n",
+                         State->Address + Offset,
+                         Record->Length);
+
+            State->InvalidLength += Record->Length;
+
+            break;
+
+        default:
+
+            IsValid = FALSE;
+
+            break;
+        }
+
+        Position += Record->StoredLength;
+        Offset += Record->Length;
+    }
+
+    //
+    // The whole range of the chunk is read again
+    //
+    if (!IsValid || Offset != EndOffset)
+    {
+        ShowMessages("err, invalid chunk of the dump is received, its pages are read again\n");
+
+        Gap.Offset = Chunk->Offset;
+        Gap.Length = Chunk->Length;
+
+        State->Gaps.push_back(Gap);
+    }
+}
+
+/**
+ * @brief Dump the memory of the debuggee by streaming the range
+ * @details The debuggee sends the range in chunks of several pages, the
+ * chunks are decoded by the listening thread and written into the file by
+ * a separate thread, so the transfer is not blocked by the disk
+ *
+ * @param StartAddress
+ * @param Length
+ * @param MemoryType
+ * @param Pid Used if the ranges of the lost chunks are read again
+ *
+ * @return BOOLEAN FALSE if the range is not streamed (it should be read page by page)
+ */
+static BOOLEAN
+CommandDumpStreamFromDebuggee(UINT64 StartAddress, UINT32 Length, DEBUGGER_READ_MEMORY_TYPE MemoryType, UINT32 Pid)
+{
+    DEBUGGEE_DUMP_MEMORY_PACKET DumpPacket   = {0};
+    DUMP_STREAM_STATE *         State        = new DUMP_STREAM_STATE();
+    HANDLE                      WriterThread = NULL;
+    LARGE_INTEGER               FileLength;
+    DUMP_STREAM_GAP             Gap;
+    BOOLEAN                     Result = TRUE;
+
+    State->Address     = StartAddress;
+    State->Length      = Length;
+    State->Stream      = (COMPRESSION_STREAM *)malloc(sizeof(COMPRESSION_STREAM));
+    State->WritesEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+    if (State->Stream != NULL && State->WritesEvent != NULL)
+    {
+        WriterThread = CreateThread(NULL, 0, CommandDumpStreamWriterThread, State, 0, NULL);
+    }
+
+    if (WriterThread == NULL)
+    {
+        Result = FALSE;
+        goto Free;
+    }
+
+    DumpPacket.Address    = StartAddress;
+    DumpPacket.Length     = Length;
+    DumpPacket.MemoryType = MemoryType;
+    DumpPacket.Compress   = TRUE;
+
+    //
+    // The chunks are handled by the listening thread until the result is received
+    //
+    DumpStreamState = State;
+
+    if (!KdSendDumpMemoryPacketToDebuggee(&DumpPacket))
+    {
+        DumpPacket.KernelStatus = DEBUGGER_ERROR_DUMP_STREAMING_IS_NOT_AVAILABLE;
+    }
+
+    DumpStreamState = NULL;
+
+    //
+    // Wait for the writer thread to write the queued pages
+    //
+    SpinlockLock(&State->WritesLock);
+
+    State->IsFinished = TRUE;
+
+    SpinlockUnlock(&State->WritesLock);
+
+    SetEvent(State->WritesEvent);
+    WaitForSingleObject(WriterThread, INFINITE);
+    CloseHandle(WriterThread);
+
+    //
+    // The debuggee is not able to stream the range, nothing is written yet
+    //
+    if (DumpPacket.KernelStatus == DEBUGGER_ERROR_DUMP_STREAMING_IS_NOT_AVAILABLE)
+    {
+        Result = FALSE;
+        goto Free;
+    }
+
+    if (DumpPacket.KernelStatus != DEBUGGER_OPERATION_WAS_SUCCESSFUL)
+    {
+        ShowErrorMessage(DumpPacket.KernelStatus);
+        goto Free;
+    }
+
+    if (State->WriteFailed)
+    {
+        ShowMessages("err, unable to write buffer into the dump\n");
+        goto Free;
+    }
+
+    //
+    // The last chunks are lost
+    //
+    if (DumpPacket.NumberOfChunks > State->NextChunkIndex)
+    {
+        State->NumberOfLostChunks += DumpPacket.NumberOfChunks - State->NextChunkIndex;
+    }
+
+    if (State->NumberOfLostChunks != 0 || State->NumberOfDuplicatedChunks != 0)
+    {
+        ShowMessages("%d chunk(s) of the dump are lost and %d chunk(s) are received again\n",
+                     State->NumberOfLostChunks,
+                     State->NumberOfDuplicatedChunks);
+    }
+
+    if (State->ExpectedOffset != Length)
+    {
+        Gap.Offset = State->ExpectedOffset;
+        Gap.Length = Length - State->ExpectedOffset;
+
+        State->Gaps.push_back(Gap);
+    }
+
+    //
+    // Read the ranges of the lost chunks page by page
+    //
+    for (DUMP_STREAM_GAP & CurrentGap : State->Gaps)
+    {
+        ShowMessages("reading 0x%x bytes at 0x%llx again, as its chunks are lost\n",
+                     CurrentGap.Length,
+                     StartAddress + CurrentGap.Offset);
+
+        FileLength.QuadPart = CurrentGap.Offset;
+
+        if (DumpFileHandle == NULL || !SetFilePointerEx(DumpFileHandle, FileLength, NULL, FILE_BEGIN))
+        {
+            break;
+        }
+
+        CommandDumpFromDebuggee(StartAddress + CurrentGap.Offset, CurrentGap.Length, MemoryType, Pid, TRUE);
+    }
+
+    //
+    // The zero ranges (and the invalid pages) are not written, so the file
+    // is extended to the length of the range
+    //
+    FileLength.QuadPart = Length;
+
+    if (DumpFileHandle == NULL ||
+        !SetFilePointerEx(DumpFileHandle, FileLength, NULL, FILE_BEGIN) ||
+        !SetEndOfFile(DumpFileHandle))
+    {
+        ShowMessages("err, unable to set the length of the dump\n");
+        goto Free;
+    }
+
+    ShowMessages("the range is streamed in %d chunk(s), 0x%x bytes are transferred for 0x%x bytes of memory "
+                 "(0x%x bytes are filled with one byte and 0x%x bytes are invalid)\n",
+                 DumpPacket.NumberOfChunks,
+                 DumpPacket.TransferredLength,
+                 Length,
+                 State->FilledLength,
+                 State->InvalidLength);
+
+Free:
+
+    if (State->WritesEvent != NULL)
+    {
+        CloseHandle(State->WritesEvent);
+    }
+
+    free(State->Stream);
+    delete State;
+
+    return Result;
 }
 
 /**
@@ -246,36 +876,51 @@ CommandDump(vector<CommandToken> CommandTokens, string Command)
     //
     Length = (UINT32)(EndAddress - StartAddress);
 
-    ActualLength = NULL;
-    Iterator     = Length / PAGE_SIZE;
-
-    for (size_t i = 0; i <= Iterator; i++)
+    //
+    // In the debugger mode, the debuggee streams the range if the packets are
+    // framed, otherwise the pages are requested without waiting for the response
+    // of each page
+    //
+    if (g_IsSerialConnectedToRemoteDebuggee)
     {
-        UINT64 Address = StartAddress + (i * PAGE_SIZE);
-
-        if (Length >= PAGE_SIZE)
+        if (!g_KdFramedPackets || !CommandDumpStreamFromDebuggee(StartAddress, Length, MemoryType, Pid))
         {
-            ActualLength = PAGE_SIZE;
+            CommandDumpFromDebuggee(StartAddress, Length, MemoryType, Pid, FALSE);
         }
-        else
+    }
+    else
+    {
+        ActualLength = NULL;
+        Iterator     = Length / PAGE_SIZE;
+
+        for (size_t i = 0; i <= Iterator; i++)
         {
-            ActualLength = Length;
-        }
+            UINT64 Address = StartAddress + (i * PAGE_SIZE);
 
-        Length -= ActualLength;
+            if (Length >= PAGE_SIZE)
+            {
+                ActualLength = PAGE_SIZE;
+            }
+            else
+            {
+                ActualLength = Length;
+            }
 
-        if (ActualLength != 0)
-        {
-            // ShowMessages("address: 0x%llx | actual length: 0x%llx\n", Address, ActualLength);
-
-            HyperDbgShowMemoryOrDisassemble(
-                DEBUGGER_SHOW_COMMAND_DUMP,
-                Address,
-                MemoryType,
-                READ_FROM_KERNEL,
-                Pid,
-                ActualLength,
-                NULL);
+            Length -= ActualLength;
+
+            if (ActualLength != 0)
+            {
+                // ShowMessages("address: 0x%llx | actual length: 0x%llx\n", Address, ActualLength);
+
+                HyperDbgShowMemoryOrDisassemble(
+                    DEBUGGER_SHOW_COMMAND_DUMP,
+                    Address,
+                    MemoryType,
+                    READ_FROM_KERNEL,
+                    Pid,
+                    ActualLength,
+                    NULL);
+            }
         }
     }
 
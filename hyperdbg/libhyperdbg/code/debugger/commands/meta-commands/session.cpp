@@ -0,0 +1,611 @@
+/**
+ * @file session.cpp
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief .session command
+ * @details
+ * @version 0.14
+ * @date 2025-06-04
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+using namespace std;
+
+//
+// Global Variables
+//
+extern BOOLEAN                                          g_EventTraceInitialized;
+extern LIST_ENTRY                                       g_EventTrace;
+extern BOOLEAN                                          g_OutputSourcesInitialized;
+extern LIST_ENTRY                                       g_OutputSources;
+extern BOOLEAN                                          g_IsSerialConnectedToRemoteDebuggee;
+extern std::map<UINT64, std::vector<std::vector<BYTE>>> g_SessionEventActions;
+
+/**
+ * @brief help of the .session command
+ *
+ * @return VOID
+ */
+VOID
+CommandSessionHelp()
+{
+    ShowMessages(".session : saves or restores the events, actions (including compiled scripts), "
+                 "output bindings and the state of events in a binary session file.\n\n");
+
+    ShowMessages("syntax : \t.session [save|load] [FilePath (string)]\n");
+
+    ShowMessages("\n");
+    ShowMessages("\t\te.g : .session save c:\\users\\sina\\desktop\\events.hds\n");
+    ShowMessages("\t\te.g : .session load \"c:\\users\\sina\\desktop\\session with space.hds\"\n");
+}
+
+/**
+ * @brief Keep a copy of the action buffers of an event
+ * @details called before the action buffers are freed after
+ * registering them to the event
+ *
+ * @param Tag the tag of the target event
+ * @param ActionBreakToDebugger the action of breaking into the debugger
+ * @param ActionBreakToDebuggerLength the action of breaking into the debugger (length)
+ * @param ActionCustomCode the action of custom code
+ * @param ActionCustomCodeLength the action of custom code (length)
+ * @param ActionScript the action of script buffer
+ * @param ActionScriptLength the action of script buffer (length)
+ *
+ * @return VOID
+ */
+VOID
+SessionRecordEventActions(UINT64                   Tag,
+                          PDEBUGGER_GENERAL_ACTION ActionBreakToDebugger,
+                          UINT32                   ActionBreakToDebuggerLength,
+                          PDEBUGGER_GENERAL_ACTION ActionCustomCode,
+                          UINT32                   ActionCustomCodeLength,
+                          PDEBUGGER_GENERAL_ACTION ActionScript,
+                          UINT32                   ActionScriptLength)
+{
+    std::vector<std::vector<BYTE>> & Actions = g_SessionEventActions[Tag];
+
+    if (ActionBreakToDebugger != NULL)
+    {
+        Actions.emplace_back((BYTE *)ActionBreakToDebugger, (BYTE *)ActionBreakToDebugger + ActionBreakToDebuggerLength);
+    }
+
+    if (ActionCustomCode != NULL)
+    {
+        Actions.emplace_back((BYTE *)ActionCustomCode, (BYTE *)ActionCustomCode + ActionCustomCodeLength);
+    }
+
+    if (ActionScript != NULL)
+    {
+        Actions.emplace_back((BYTE *)ActionScript, (BYTE *)ActionScript + ActionScriptLength);
+    }
+}
+
+/**
+ * @brief Remove the saved copy of the action buffers of an event
+ *
+ * @param Tag the tag of the target event (or DEBUGGER_MODIFY_EVENTS_APPLY_TO_ALL_TAG)
+ *
+ * @return VOID
+ */
+VOID
+SessionRemoveEventActions(UINT64 Tag)
+{
+    if (Tag == DEBUGGER_MODIFY_EVENTS_APPLY_TO_ALL_TAG)
+    {
+        g_SessionEventActions.clear();
+    }
+    else
+    {
+        g_SessionEventActions.erase(Tag);
+    }
+}
+
+/**
+ * @brief Find an output source based on its tag or its name
+ *
+ * @param OutputSourceTag the tag of the output source (if name is NULL)
+ * @param Name the name of the output source
+ *
+ * @return PDEBUGGER_EVENT_FORWARDING the output source or NULL if not found
+ */
+static PDEBUGGER_EVENT_FORWARDING
+SessionFindOutputSource(UINT64 OutputSourceTag, const CHAR * Name)
+{
+    PLIST_ENTRY TempList = 0;
+
+    if (!g_OutputSourcesInitialized)
+    {
+        return NULL;
+    }
+
+    TempList = &g_OutputSources;
+
+    while (&g_OutputSources != TempList->Flink)
+    {
+        TempList = TempList->Flink;
+
+        PDEBUGGER_EVENT_FORWARDING CurrentOutputSourceDetails = CONTAINING_RECORD(TempList, DEBUGGER_EVENT_FORWARDING, OutputSourcesList);
+
+        if (Name != NULL)
+        {
+            if (strcmp(CurrentOutputSourceDetails->Name, Name) == 0)
+            {
+                return CurrentOutputSourceDetails;
+            }
+        }
+        else if (CurrentOutputSourceDetails->OutputUniqueTag == OutputSourceTag)
+        {
+            return CurrentOutputSourceDetails;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Save the events and actions into a binary session file
+ *
+ * @param FilePath the path of the session file
+ *
+ * @return BOOLEAN whether the session is saved successfully or not
+ */
+BOOLEAN
+SessionSaveToFile(const string & FilePath)
+{
+    PLIST_ENTRY         TempList   = 0;
+    SESSION_FILE_HEADER FileHeader = {0};
+    ofstream            SessionFile;
+
+    FileHeader.Magic             = SESSION_FILE_MAGIC;
+    FileHeader.Version           = SESSION_FILE_VERSION;
+    FileHeader.SizeOfEventDetail = sizeof(DEBUGGER_GENERAL_EVENT_DETAIL);
+    FileHeader.SizeOfAction      = sizeof(DEBUGGER_GENERAL_ACTION);
+    FileHeader.KernelBaseAddress = DebuggerGetKernelBase();
+
+    if (g_EventTraceInitialized)
+    {
+        TempList = &g_EventTrace;
+        while (&g_EventTrace != TempList->Flink)
+        {
+            TempList = TempList->Flink;
+            FileHeader.NumberOfEvents++;
+        }
+    }
+
+    SessionFile.open(FilePath.c_str(), ios::out | ios::binary | ios::trunc);
+
+    if (!SessionFile.is_open())
+    {
+        ShowMessages("unable to open file : %s\n", FilePath.c_str());
+        return FALSE;
+    }
+
+    SessionFile.write((const char *)&FileHeader, sizeof(SESSION_FILE_HEADER));
+
+    if (FileHeader.NumberOfEvents != 0)
+    {
+        //
+        // Events are inserted to the head of the list, so we traverse it
+        // backward to save (and later restore) them in the order of creation
+        //
+        TempList = &g_EventTrace;
+        while (&g_EventTrace != TempList->Blink)
+        {
+            TempList = TempList->Blink;
+
+            PDEBUGGER_GENERAL_EVENT_DETAIL CommandDetail = CONTAINING_RECORD(TempList, DEBUGGER_GENERAL_EVENT_DETAIL, CommandsEventList);
+            SESSION_FILE_EVENT_RECORD      Record        = {0};
+            vector<string>                 OutputSourceNames;
+
+            //
+            // Resolve the output sources to their names as the tags are not
+            // valid among different instances of the debugger
+            //
+            if (CommandDetail->HasCustomOutput)
+            {
+                for (UINT32 i = 0; i < DebuggerOutputSourceMaximumRemoteSourceForSingleEvent; i++)
+                {
+                    if (CommandDetail->OutputSourceTags[i] == NULL)
+                    {
+                        break;
+                    }
+
+                    PDEBUGGER_EVENT_FORWARDING OutputSource = SessionFindOutputSource(CommandDetail->OutputSourceTags[i], NULL);
+
+                    if (OutputSource == NULL)
+                    {
+                        ShowMessages("warning, output source of event %llx is not found, the binding is not saved\n",
+                                     CommandDetail->Tag - DebuggerEventTagStartSeed);
+                        continue;
+                    }
+
+                    OutputSourceNames.push_back(OutputSource->Name);
+                }
+            }
+
+            std::vector<std::vector<BYTE>> & Actions = g_SessionEventActions[CommandDetail->Tag];
+
+            Record.EventBufferLength     = sizeof(DEBUGGER_GENERAL_EVENT_DETAIL) + CommandDetail->ConditionBufferSize;
+            Record.CommandStringLength   = CommandDetail->CommandStringBuffer == NULL ? 0 : (UINT32)strlen((const char *)CommandDetail->CommandStringBuffer) + 1;
+            Record.NumberOfOutputSources = (UINT32)OutputSourceNames.size();
+            Record.NumberOfActions       = (UINT32)Actions.size();
+
+            SessionFile.write((const char *)&Record, sizeof(SESSION_FILE_EVENT_RECORD));
+            SessionFile.write((const char *)CommandDetail, Record.EventBufferLength);
+
+            if (Record.CommandStringLength != 0)
+            {
+                SessionFile.write((const char *)CommandDetail->CommandStringBuffer, Record.CommandStringLength);
+            }
+
+            for (auto & Name : OutputSourceNames)
+            {
+                CHAR NameBuffer[MAXIMUM_CHARACTERS_FOR_EVENT_FORWARDING_NAME] = {0};
+
+                strncpy_s(NameBuffer, Name.c_str(), MAXIMUM_CHARACTERS_FOR_EVENT_FORWARDING_NAME - 1);
+                SessionFile.write(NameBuffer, MAXIMUM_CHARACTERS_FOR_EVENT_FORWARDING_NAME);
+            }
+
+            for (auto & Action : Actions)
+            {
+                UINT32 ActionLength = (UINT32)Action.size();
+
+                SessionFile.write((const char *)&ActionLength, sizeof(UINT32));
+                SessionFile.write((const char *)Action.data(), ActionLength);
+            }
+        }
+    }
+
+    SessionFile.close();
+
+    if (SessionFile.fail())
+    {
+        ShowMessages("err, unable to write the session file\n");
+        return FALSE;
+    }
+
+    ShowMessages("%d event(s) saved into the session file : %s\n", FileHeader.NumberOfEvents, FilePath.c_str());
+
+    return TRUE;
+}
+
+/**
+ * @brief Take a chunk of the session file buffer
+ *
+ * @param FileBuffer the buffer of the session file
+ * @param Offset the current offset (will be moved forward)
+ * @param Length the length of the chunk
+ *
+ * @return BYTE* the chunk or NULL if the file is truncated
+ */
+static BYTE *
+SessionTakeChunk(vector<BYTE> & FileBuffer, SIZE_T * Offset, SIZE_T Length)
+{
+    BYTE * Chunk;
+
+    if (Length > FileBuffer.size() || *Offset > FileBuffer.size() - Length)
+    {
+        return NULL;
+    }
+
+    Chunk = FileBuffer.data() + *Offset;
+    *Offset += Length;
+
+    return Chunk;
+}
+
+/**
+ * @brief Restore the events and actions from a binary session file
+ * @details The saved event and action buffers are sent to the kernel
+ * as-is, so neither the interpreter nor the script engine is involved,
+ * thus, the session is only restored on the same boot of the target
+ *
+ * @param FilePath the path of the session file
+ *
+ * @return BOOLEAN whether all of the events are restored or not
+ */
+BOOLEAN
+SessionLoadFromFile(const string & FilePath)
+{
+    ifstream             SessionFile;
+    vector<BYTE>         FileBuffer;
+    SIZE_T               Offset = 0;
+    PSESSION_FILE_HEADER FileHeader;
+    UINT32               NumberOfRestoredEvents = 0;
+
+    SessionFile.open(FilePath.c_str(), ios::in | ios::binary);
+
+    if (!SessionFile.is_open())
+    {
+        ShowMessages("unable to open file : %s\n", FilePath.c_str());
+        return FALSE;
+    }
+
+    FileBuffer.assign(istreambuf_iterator<char>(SessionFile), istreambuf_iterator<char>());
+    SessionFile.close();
+
+    FileHeader = (PSESSION_FILE_HEADER)SessionTakeChunk(FileBuffer, &Offset, sizeof(SESSION_FILE_HEADER));
+
+    if (FileHeader == NULL || FileHeader->Magic != SESSION_FILE_MAGIC)
+    {
+        ShowMessages("err, the file is not a valid session file\n");
+        return FALSE;
+    }
+
+    if (FileHeader->Version != SESSION_FILE_VERSION ||
+        FileHeader->SizeOfEventDetail != sizeof(DEBUGGER_GENERAL_EVENT_DETAIL) ||
+        FileHeader->SizeOfAction != sizeof(DEBUGGER_GENERAL_ACTION))
+    {
+        ShowMessages("err, the session file is saved by an incompatible version of HyperDbg (version: %d)\n",
+                     FileHeader->Version);
+        return FALSE;
+    }
+
+    //
+    // The saved events contain resolved addresses and compiled scripts, which
+    // are only valid in the same boot of the same kernel (KASLR randomizes the
+    // kernel base on each boot)
+    //
+    if (FileHeader->KernelBaseAddress == NULL || FileHeader->KernelBaseAddress != DebuggerGetKernelBase())
+    {
+        ShowMessages("err, the session file is saved on a different boot of the target (kernel base: %llx), "
+                     "the resolved addresses and the compiled scripts are not valid anymore\n",
+                     FileHeader->KernelBaseAddress);
+        return FALSE;
+    }
+
+    //
+    // Check if list is initialized or not
+    //
+    if (!g_EventTraceInitialized)
+    {
+        InitializeListHead(&g_EventTrace);
+        g_EventTraceInitialized = TRUE;
+    }
+
+    for (UINT32 EventIndex = 0; EventIndex < FileHeader->NumberOfEvents; EventIndex++)
+    {
+        PSESSION_FILE_EVENT_RECORD     Record;
+        PDEBUGGER_GENERAL_EVENT_DETAIL SavedEvent;
+        PDEBUGGER_GENERAL_EVENT_DETAIL Event                       = NULL;
+        PDEBUGGER_GENERAL_ACTION       ActionBreakToDebugger       = NULL;
+        PDEBUGGER_GENERAL_ACTION       ActionCustomCode            = NULL;
+        PDEBUGGER_GENERAL_ACTION       ActionScript                = NULL;
+        UINT32                         ActionBreakToDebuggerLength = 0;
+        UINT32                         ActionCustomCodeLength      = 0;
+        UINT32                         ActionScriptLength          = 0;
+        BYTE *                         CommandString               = NULL;
+        UINT64                         Tag;
+
+        Record = (PSESSION_FILE_EVENT_RECORD)SessionTakeChunk(FileBuffer, &Offset, sizeof(SESSION_FILE_EVENT_RECORD));
+
+        if (Record == NULL ||
+            Record->EventBufferLength < sizeof(DEBUGGER_GENERAL_EVENT_DETAIL) ||
+            Record->NumberOfOutputSources > DebuggerOutputSourceMaximumRemoteSourceForSingleEvent)
+        {
+            goto FileCorrupted;
+        }
+
+        SavedEvent = (PDEBUGGER_GENERAL_EVENT_DETAIL)SessionTakeChunk(FileBuffer, &Offset, Record->EventBufferLength);
+
+        if (SavedEvent == NULL ||
+            Record->EventBufferLength != sizeof(DEBUGGER_GENERAL_EVENT_DETAIL) + SavedEvent->ConditionBufferSize)
+        {
+            goto FileCorrupted;
+        }
+
+        if (Record->CommandStringLength != 0)
+        {
+            CommandString = SessionTakeChunk(FileBuffer, &Offset, Record->CommandStringLength);
+
+            if (CommandString == NULL || CommandString[Record->CommandStringLength - 1] != '\0')
+            {
+                goto FileCorrupted;
+            }
+        }
+
+        //
+        // Create a new instance of the event with a new tag
+        //
+        Event = (PDEBUGGER_GENERAL_EVENT_DETAIL)malloc(Record->EventBufferLength);
+
+        if (Event == NULL)
+        {
+            ShowMessages("err, unable to allocate memory for the event\n");
+            return FALSE;
+        }
+
+        memcpy(Event, SavedEvent, Record->EventBufferLength);
+
+        Tag = GetNewDebuggerEventTag();
+
+        Event->CommandsEventList.Flink = NULL;
+        Event->CommandsEventList.Blink = NULL;
+        Event->CreationTime            = time(0);
+        Event->Tag                     = Tag;
+        Event->CommandStringBuffer     = NULL;
+        Event->HasCustomOutput         = FALSE;
+        Event->IsRestoredAsDisabled    = !Event->IsEnabled;
+
+        RtlZeroMemory(Event->OutputSourceTags, sizeof(Event->OutputSourceTags));
+
+        if (CommandString != NULL)
+        {
+            Event->CommandStringBuffer = malloc(Record->CommandStringLength);
+
+            if (Event->CommandStringBuffer == NULL)
+            {
+                ShowMessages("err, unable to allocate memory for the event\n");
+                FreeEventsAndActionsMemory(Event, NULL, NULL, NULL);
+                return FALSE;
+            }
+
+            memcpy(Event->CommandStringBuffer, CommandString, Record->CommandStringLength);
+        }
+
+        //
+        // Bind the event to the output sources of this instance (by their names)
+        //
+        for (UINT32 i = 0; i < Record->NumberOfOutputSources; i++)
+        {
+            CHAR * Name = (CHAR *)SessionTakeChunk(FileBuffer, &Offset, MAXIMUM_CHARACTERS_FOR_EVENT_FORWARDING_NAME);
+
+            if (Name == NULL || Name[MAXIMUM_CHARACTERS_FOR_EVENT_FORWARDING_NAME - 1] != '\0')
+            {
+                FreeEventsAndActionsMemory(Event, NULL, NULL, NULL);
+                goto FileCorrupted;
+            }
+
+            PDEBUGGER_EVENT_FORWARDING OutputSource = SessionFindOutputSource(NULL, Name);
+
+            if (OutputSource == NULL || OutputSource->State == EVENT_FORWARDING_CLOSED)
+            {
+                ShowMessages("err, the output source '%s' is either not found or already closed. Did you use "
+                             "'output' command to create it?\n",
+                             Name);
+                FreeEventsAndActionsMemory(Event, NULL, NULL, NULL);
+                return FALSE;
+            }
+
+            Event->OutputSourceTags[i] = OutputSource->OutputUniqueTag;
+            Event->HasCustomOutput     = TRUE;
+        }
+
+        //
+        // Create the actions (they're already compiled, so just copy them)
+        //
+        for (UINT32 i = 0; i < Record->NumberOfActions; i++)
+        {
+            UINT32 *                 ActionLength;
+            PDEBUGGER_GENERAL_ACTION SavedAction;
+            PDEBUGGER_GENERAL_ACTION Action;
+
+            ActionLength = (UINT32 *)SessionTakeChunk(FileBuffer, &Offset, sizeof(UINT32));
+            SavedAction  = ActionLength == NULL ? NULL : (PDEBUGGER_GENERAL_ACTION)SessionTakeChunk(FileBuffer, &Offset, *ActionLength);
+
+            if (SavedAction == NULL || *ActionLength < sizeof(DEBUGGER_GENERAL_ACTION))
+            {
+                FreeEventsAndActionsMemory(Event, ActionBreakToDebugger, ActionCustomCode, ActionScript);
+                goto FileCorrupted;
+            }
+
+            Action = (PDEBUGGER_GENERAL_ACTION)malloc(*ActionLength);
+
+            if (Action == NULL)
+            {
+                ShowMessages("err, unable to allocate memory for the action\n");
+                FreeEventsAndActionsMemory(Event, ActionBreakToDebugger, ActionCustomCode, ActionScript);
+                return FALSE;
+            }
+
+            memcpy(Action, SavedAction, *ActionLength);
+            Action->EventTag = Tag;
+
+            if (Action->ActionType == BREAK_TO_DEBUGGER && ActionBreakToDebugger == NULL)
+            {
+                ActionBreakToDebugger       = Action;
+                ActionBreakToDebuggerLength = *ActionLength;
+            }
+            else if (Action->ActionType == RUN_CUSTOM_CODE && ActionCustomCode == NULL)
+            {
+                ActionCustomCode       = Action;
+                ActionCustomCodeLength = *ActionLength;
+            }
+            else if (Action->ActionType == RUN_SCRIPT && ActionScript == NULL)
+            {
+                ActionScript       = Action;
+                ActionScriptLength = *ActionLength;
+            }
+            else
+            {
+                free(Action);
+                FreeEventsAndActionsMemory(Event, ActionBreakToDebugger, ActionCustomCode, ActionScript);
+                goto FileCorrupted;
+            }
+        }
+
+        //
+        // It's not possible to break to debugger in VMI-mode
+        //
+        if (!g_IsSerialConnectedToRemoteDebuggee && ActionBreakToDebugger != NULL)
+        {
+            ShowMessages("err, the session contains events that break to the debugger, "
+                         "which is not possible in the VMI Mode\n");
+            FreeEventsAndActionsMemory(Event, ActionBreakToDebugger, ActionCustomCode, ActionScript);
+            return FALSE;
+        }
+
+        //
+        // Send the ioctl to the kernel for event registration
+        //
+        if (!SendEventToKernel(Event, Record->EventBufferLength))
+        {
+            FreeEventsAndActionsMemory(Event, ActionBreakToDebugger, ActionCustomCode, ActionScript);
+            return FALSE;
+        }
+
+        //
+        // Add the event to the kernel
+        //
+        if (!RegisterActionToEvent(Event,
+                                   ActionBreakToDebugger,
+                                   ActionBreakToDebuggerLength,
+                                   ActionCustomCode,
+                                   ActionCustomCodeLength,
+                                   ActionScript,
+                                   ActionScriptLength))
+        {
+            FreeEventsAndActionsMemory(Event, ActionBreakToDebugger, ActionCustomCode, ActionScript);
+            return FALSE;
+        }
+
+        NumberOfRestoredEvents++;
+    }
+
+    ShowMessages("%d event(s) restored from the session file : %s\n", NumberOfRestoredEvents, FilePath.c_str());
+
+    return TRUE;
+
+FileCorrupted:
+
+    ShowMessages("err, the session file is corrupted (%d event(s) restored)\n", NumberOfRestoredEvents);
+    return FALSE;
+}
+
+/**
+ * @brief .session command handler
+ *
+ * @param CommandTokens
+ * @param Command
+ *
+ * @return VOID
+ */
+VOID
+CommandSession(vector<CommandToken> CommandTokens, string Command)
+{
+    if (CommandTokens.size() != 3)
+    {
+        ShowMessages("incorrect use of the '%s'\n\n",
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(0)).c_str());
+        CommandSessionHelp();
+        return;
+    }
+
+    if (CompareLowerCaseStrings(CommandTokens.at(1), "save"))
+    {
+        SessionSaveToFile(GetCaseSensitiveStringFromCommandToken(CommandTokens.at(2)));
+    }
+    else if (CompareLowerCaseStrings(CommandTokens.at(1), "load"))
+    {
+        SessionLoadFromFile(GetCaseSensitiveStringFromCommandToken(CommandTokens.at(2)));
+    }
+    else
+    {
+        ShowMessages("err, couldn't resolve error at '%s'\n\n",
+                     GetCaseSensitiveStringFromCommandToken(CommandTokens.at(1)).c_str());
+        CommandSessionHelp();
+    }
+}
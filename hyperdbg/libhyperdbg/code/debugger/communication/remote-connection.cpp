@@ -2,7 +2,9 @@
  * @file remote-connection.cpp
  * @author Sina Karvandi (sina@hyperdbg.org)
  * @brief handle remote connections command
- * @details
+ * @details The messages of the remote connection are length-prefixed frames,
+ * the sockets of the debuggee are handled by an event loop so more than one
+ * debugger could be connected to the same debuggee
  * @version 0.1
  * @date 2020-08-21
  *
@@ -14,20 +16,785 @@
 //
 // Global Variables
 //
-extern BYTE g_EndOfBufferCheckTcp[TCP_END_OF_BUFFER_CHARS_COUNT];
+extern BOOLEAN g_IsConnectedToHyperDbgLocally;
+extern BOOLEAN g_IsConnectedToRemoteDebuggee;
+extern BOOLEAN g_IsConnectedToRemoteDebugger;
+extern BOOLEAN g_BreakPrintingOutput;
+
+extern SOCKET                   g_ClientConnectSocket;
+extern REMOTE_CONNECTION_SERVER g_RemoteConnectionServer;
+extern volatile LONG            g_RemoteConnectionLastCommandId;
+extern volatile LONG            g_RemoteConnectionPendingCommands;
+
+extern HANDLE g_RemoteDebuggeeListeningThread;
+extern HANDLE g_EndOfMessageReceivedEvent;
+
+/**
+ * @brief Set the options of the sockets of the remote connection
+ * @details The commands and the end of the outputs are small and should not
+ * be delayed, the output is already coalesced into large frames
+ *
+ * @param Socket
+ * @return VOID
+ */
+static VOID
+RemoteConnectionSetSocketOptions(SOCKET Socket)
+{
+    BOOL NoDelay    = TRUE;
+    int  BufferSize = REMOTE_CONNECTION_SOCKET_BUFFER_SIZE;
+
+    setsockopt(Socket, IPPROTO_TCP, TCP_NODELAY, (const char *)&NoDelay, sizeof(NoDelay));
+    setsockopt(Socket, SOL_SOCKET, SO_SNDBUF, (const char *)&BufferSize, sizeof(BufferSize));
+    setsockopt(Socket, SOL_SOCKET, SO_RCVBUF, (const char *)&BufferSize, sizeof(BufferSize));
+}
+
+/**
+ * @brief Append a frame (the header and the payload) to a buffer
+ *
+ * @param Buffer
+ * @param Type
+ * @param Id
+ * @param Payload
+ * @param Length
+ * @return VOID
+ */
+static VOID
+RemoteConnectionBuildFrame(std::vector<CHAR> &         Buffer,
+                           REMOTE_CONNECTION_FRAME_TYPE Type,
+                           UINT32                       Id,
+                           const CHAR *                 Payload,
+                           UINT32                       Length)
+{
+    REMOTE_CONNECTION_FRAME_HEADER Header = {0};
+
+    Header.Type   = Type;
+    Header.Id     = Id;
+    Header.Length = Length;
+
+    Buffer.insert(Buffer.end(), (const CHAR *)&Header, (const CHAR *)&Header + sizeof(Header));
+
+    if (Length != 0)
+    {
+        Buffer.insert(Buffer.end(), Payload, Payload + Length);
+    }
+}
+
+//////////////////////////////////////////
+//		    Server (debuggee)           //
+//////////////////////////////////////////
+
+/**
+ * @brief Queue a frame for a debugger
+ * @details The lock of the server should be held by the caller, if too many
+ * frames are buffered for the debugger, its frames are discarded and it's
+ * disconnected by the event loop
+ *
+ * @param Client
+ * @param Type
+ * @param Id
+ * @param Payload
+ * @param Length
+ * @return VOID
+ */
+static VOID
+RemoteConnectionServerQueueFrame(REMOTE_CONNECTION_CLIENT &   Client,
+                                 REMOTE_CONNECTION_FRAME_TYPE Type,
+                                 UINT32                       Id,
+                                 const CHAR *                 Payload,
+                                 UINT32                       Length)
+{
+    if (Client.IsStalled)
+    {
+        return;
+    }
+
+    if (Client.SendBuffer.size() - Client.SendOffset + sizeof(REMOTE_CONNECTION_FRAME_HEADER) + Length > REMOTE_CONNECTION_MAXIMUM_PENDING_SIZE)
+    {
+        Client.IsStalled = TRUE;
+        Client.IsClosing = TRUE;
+
+        //
+        // Release the memory of the buffered frames
+        //
+        std::vector<CHAR>().swap(Client.SendBuffer);
+        Client.SendOffset = 0;
+
+        return;
+    }
+
+    RemoteConnectionBuildFrame(Client.SendBuffer, Type, Id, Payload, Length);
+}
+
+/**
+ * @brief Frame the buffered output and queue it for all of the debuggers
+ * @details The lock of the server should be held by the caller
+ *
+ * @return VOID
+ */
+static VOID
+RemoteConnectionServerFrameOutput()
+{
+    std::vector<CHAR> & Output = g_RemoteConnectionServer.Output;
+    UINT32              Length;
+
+    for (SIZE_T Offset = 0; Offset < Output.size(); Offset += Length)
+    {
+        Length = (UINT32)(Output.size() - Offset > REMOTE_CONNECTION_MAXIMUM_FRAME_SIZE ? REMOTE_CONNECTION_MAXIMUM_FRAME_SIZE : Output.size() - Offset);
+
+        for (auto & Client : g_RemoteConnectionServer.Clients)
+        {
+            if (Client.IsHandshakeDone && !Client.IsClosing)
+            {
+                RemoteConnectionServerQueueFrame(Client,
+                                                 REMOTE_CONNECTION_FRAME_TYPE_OUTPUT,
+                                                 REMOTE_CONNECTION_ID_BROADCAST,
+                                                 Output.data() + Offset,
+                                                 Length);
+            }
+        }
+    }
+
+    Output.clear();
+}
+
+/**
+ * @brief Handle a frame that is received from a debugger
+ *
+ * @param Client
+ * @param Header
+ * @param Payload
+ * @param IsSignatureMismatched set if the build signature of the debugger
+ * doesn't match
+ *
+ * @return BOOLEAN FALSE if the debugger should be disconnected
+ */
+static BOOLEAN
+RemoteConnectionServerHandleFrame(REMOTE_CONNECTION_CLIENT &             Client,
+                                  const REMOTE_CONNECTION_FRAME_HEADER * Header,
+                                  const CHAR *                           Payload,
+                                  BOOLEAN *                              IsSignatureMismatched)
+{
+    REMOTE_CONNECTION_COMMAND Command;
+    BOOLEAN                   IsMatched;
+
+    //
+    // Nothing but the handshake is accepted before the handshake
+    //
+    if (!Client.IsHandshakeDone)
+    {
+        if (Header->Type != REMOTE_CONNECTION_FRAME_TYPE_HANDSHAKE)
+        {
+            return FALSE;
+        }
+
+        //
+        // Check whether the signature of debuggee and debugger match or not
+        //
+        IsMatched = Header->Length == sizeof(BuildSignature) &&
+                    memcmp(Payload, BuildSignature, sizeof(BuildSignature)) == 0;
+
+        SpinlockLock(&g_RemoteConnectionServer.Lock);
+
+        RemoteConnectionServerQueueFrame(Client,
+                                         REMOTE_CONNECTION_FRAME_TYPE_HANDSHAKE_RESULT,
+                                         0,
+                                         IsMatched ? "OK" : "NO",
+                                         3);
+
+        if (IsMatched)
+        {
+            Client.IsHandshakeDone = TRUE;
+        }
+        else
+        {
+            //
+            // Only this debugger is rejected, it's closed once the
+            // result is sent
+            //
+            Client.IsClosing       = TRUE;
+            *IsSignatureMismatched = TRUE;
+        }
+
+        SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+
+        return TRUE;
+    }
+
+    if (Header->Type != REMOTE_CONNECTION_FRAME_TYPE_COMMAND)
+    {
+        return FALSE;
+    }
+
+    //
+    // Queue the command for the thread of the '.listen' command
+    //
+    Command.ClientTag = Client.Tag;
+    Command.Id        = Header->Id;
+    Command.Command.assign(Payload, Payload + Header->Length);
+    Command.Command.push_back('\0');
+
+    SpinlockLock(&g_RemoteConnectionServer.Lock);
+    g_RemoteConnectionServer.Commands.push_back(std::move(Command));
+    SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+
+    SetEvent(g_RemoteConnectionServer.CommandEvent);
+
+    return TRUE;
+}
+
+/**
+ * @brief Receive the available bytes from a debugger and handle the
+ * complete frames
+ *
+ * @param Client
+ * @param IsSignatureMismatched
+ *
+ * @return BOOLEAN FALSE if the debugger should be disconnected
+ */
+static BOOLEAN
+RemoteConnectionServerReceiveFromClient(REMOTE_CONNECTION_CLIENT & Client, BOOLEAN * IsSignatureMismatched)
+{
+    std::vector<CHAR> &            Buffer = Client.ReceiveBuffer;
+    REMOTE_CONNECTION_FRAME_HEADER Header;
+    SIZE_T                         Size;
+    SIZE_T                         Offset   = 0;
+    BOOLEAN                        IsClosed = FALSE;
+    int                            Result;
+
+    //
+    // Receive until there is no more bytes (the socket is non-blocking)
+    //
+    while (TRUE)
+    {
+        Size = Buffer.size();
+        Buffer.resize(Size + COMMUNICATION_BUFFER_SIZE);
+
+        Result = recv(Client.Socket, Buffer.data() + Size, COMMUNICATION_BUFFER_SIZE, 0);
+
+        if (Result == SOCKET_ERROR)
+        {
+            Buffer.resize(Size);
+
+            IsClosed = WSAGetLastError() != WSAEWOULDBLOCK;
+            break;
+        }
+        else if (Result == 0)
+        {
+            //
+            // The debugger closed the connection (the received frames are
+            // still handled)
+            //
+            Buffer.resize(Size);
+            IsClosed = TRUE;
+            break;
+        }
+
+        Buffer.resize(Size + Result);
+
+        if (Result < COMMUNICATION_BUFFER_SIZE)
+        {
+            break;
+        }
+    }
+
+    //
+    // Handle the complete frames
+    //
+    while (Buffer.size() - Offset >= sizeof(Header))
+    {
+        memcpy(&Header, Buffer.data() + Offset, sizeof(Header));
+
+        if (Header.Length > REMOTE_CONNECTION_MAXIMUM_FRAME_SIZE)
+        {
+            return FALSE;
+        }
+
+        if (Buffer.size() - Offset - sizeof(Header) < Header.Length)
+        {
+            //
+            // The rest of the frame is not received yet
+            //
+            break;
+        }
+
+        if (!RemoteConnectionServerHandleFrame(Client, &Header, Buffer.data() + Offset + sizeof(Header), IsSignatureMismatched))
+        {
+            return FALSE;
+        }
+
+        Offset += sizeof(Header) + Header.Length;
+    }
+
+    Buffer.erase(Buffer.begin(), Buffer.begin() + Offset);
+
+    return !IsClosed;
+}
+
+/**
+ * @brief Send the buffered frames of a debugger (as much as the socket accepts)
+ * @details The lock of the server should be held by the caller
+ *
+ * @param Client
+ *
+ * @return BOOLEAN FALSE if the debugger should be disconnected
+ */
+static BOOLEAN
+RemoteConnectionServerSendToClient(REMOTE_CONNECTION_CLIENT & Client)
+{
+    SIZE_T Remaining;
+    int    Result;
+
+    while (Client.SendOffset < Client.SendBuffer.size())
+    {
+        Remaining = Client.SendBuffer.size() - Client.SendOffset;
+
+        Result = send(Client.Socket,
+                      Client.SendBuffer.data() + Client.SendOffset,
+                      (int)(Remaining > INT_MAX ? INT_MAX : Remaining),
+                      0);
+
+        if (Result == SOCKET_ERROR)
+        {
+            //
+            // The rest is sent once the socket becomes writable (FD_WRITE)
+            //
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+        }
+
+        Client.SendOffset += Result;
+    }
+
+    Client.SendBuffer.clear();
+    Client.SendOffset = 0;
+
+    return TRUE;
+}
+
+/**
+ * @brief Accept the pending debuggers
+ *
+ * @param Notices the messages that should be shown (after releasing the lock)
+ *
+ * @return VOID
+ */
+static VOID
+RemoteConnectionServerAcceptClients(std::vector<std::string> & Notices)
+{
+    REMOTE_CONNECTION_CLIENT Client = {0};
+    CHAR                     Address[INET_ADDRSTRLEN + 8];
+    SOCKET                   Socket;
+    WSAEVENT                 Event;
+
+    while (CommunicationServerAcceptClient(g_RemoteConnectionServer.ListenSocket, &Socket, Address, sizeof(Address)) == 0)
+    {
+        if (g_RemoteConnectionServer.Clients.size() >= REMOTE_CONNECTION_MAXIMUM_CLIENTS)
+        {
+            Notices.push_back(std::string("err, maximum number of debuggers are connected, rejecting : ") + Address + "\n");
+            CommunicationServerCloseClient(Socket);
+            continue;
+        }
+
+        Event = WSACreateEvent();
+
+        if (Event == WSA_INVALID_EVENT ||
+            WSAEventSelect(Socket, Event, FD_READ | FD_WRITE | FD_CLOSE) == SOCKET_ERROR)
+        {
+            Notices.push_back(std::string("err, unable to handle the debugger : ") + Address + "\n");
+
+            if (Event != WSA_INVALID_EVENT)
+            {
+                WSACloseEvent(Event);
+            }
+
+            CommunicationServerCloseClient(Socket);
+            continue;
+        }
+
+        RemoteConnectionSetSocketOptions(Socket);
+
+        Client.Socket = Socket;
+        Client.Event  = Event;
+        Client.Tag    = ++g_RemoteConnectionServer.NextClientTag;
+        strcpy_s(Client.Address, sizeof(Client.Address), Address);
+
+        SpinlockLock(&g_RemoteConnectionServer.Lock);
+        g_RemoteConnectionServer.Clients.push_back(Client);
+        SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+
+        Notices.push_back(std::string("connected to : ") + Address + "\n");
+    }
+}
+
+/**
+ * @brief Send the remaining frames and close all of the debuggers
+ * @details Called by the event loop once the server is stopping
+ *
+ * @return VOID
+ */
+static VOID
+RemoteConnectionServerCloseClients()
+{
+    std::list<REMOTE_CONNECTION_CLIENT> Clients;
+    u_long                              NonBlocking = 0;
+
+    SpinlockLock(&g_RemoteConnectionServer.Lock);
+
+    RemoteConnectionServerFrameOutput();
+    Clients.swap(g_RemoteConnectionServer.Clients);
+
+    SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+
+    for (auto & Client : Clients)
+    {
+        //
+        // Make the socket blocking to send the rest of the frames
+        //
+        WSAEventSelect(Client.Socket, NULL, 0);
+        ioctlsocket(Client.Socket, FIONBIO, &NonBlocking);
+
+        RemoteConnectionServerSendToClient(Client);
+
+        CommunicationServerCloseClient(Client.Socket);
+        WSACloseEvent(Client.Event);
+    }
+}
+
+/**
+ * @brief The event loop that handles the sockets of the debuggers
+ *
+ * @param lpParam
+ * @return DWORD
+ */
+static DWORD WINAPI
+RemoteConnectionServerThread(LPVOID lpParam)
+{
+    WSAEVENT                 Events[REMOTE_CONNECTION_MAXIMUM_CLIENTS + 2];
+    WSANETWORKEVENTS         NetworkEvents;
+    std::vector<std::string> Notices;
+    std::vector<UINT64>      DroppedClients;
+    DWORD                    NumberOfEvents;
+    DWORD                    Timeout;
+    DWORD                    WaitResult;
+    BOOLEAN                  IsSignatureMismatched;
+    BOOLEAN                  IsAnyClientConnected = FALSE;
+
+    UNREFERENCED_PARAMETER(lpParam);
+
+    while (TRUE)
+    {
+        //
+        // Wait for the sockets, the buffered output or stopping the server
+        //
+        NumberOfEvents           = 0;
+        Events[NumberOfEvents++] = g_RemoteConnectionServer.WakeEvent;
+        Events[NumberOfEvents++] = g_RemoteConnectionServer.ListenEvent;
+
+        for (auto & Client : g_RemoteConnectionServer.Clients)
+        {
+            Events[NumberOfEvents++] = Client.Event;
+        }
+
+        SpinlockLock(&g_RemoteConnectionServer.Lock);
+        Timeout = g_RemoteConnectionServer.Output.empty() ? WSA_INFINITE : REMOTE_CONNECTION_OUTPUT_FLUSH_INTERVAL;
+        SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+
+        WaitResult = WSAWaitForMultipleEvents(NumberOfEvents, Events, FALSE, Timeout, FALSE);
+
+        if (WaitResult == WSA_WAIT_FAILED || g_RemoteConnectionServer.IsStopping)
+        {
+            break;
+        }
+
+        //
+        // Accept the new debuggers
+        //
+        if (WSAEnumNetworkEvents(g_RemoteConnectionServer.ListenSocket, g_RemoteConnectionServer.ListenEvent, &NetworkEvents) == 0 &&
+            (NetworkEvents.lNetworkEvents & FD_ACCEPT))
+        {
+            RemoteConnectionServerAcceptClients(Notices);
+        }
+
+        //
+        // Receive the frames of the debuggers
+        //
+        for (auto & Client : g_RemoteConnectionServer.Clients)
+        {
+            if (WSAEnumNetworkEvents(Client.Socket, Client.Event, &NetworkEvents) != 0)
+            {
+                DroppedClients.push_back(Client.Tag);
+                continue;
+            }
+
+            if (NetworkEvents.lNetworkEvents & (FD_READ | FD_CLOSE))
+            {
+                IsSignatureMismatched = FALSE;
+
+                if (!RemoteConnectionServerReceiveFromClient(Client, &IsSignatureMismatched))
+                {
+                    DroppedClients.push_back(Client.Tag);
+                }
+
+                if (IsSignatureMismatched)
+                {
+                    Notices.push_back(ASSERT_MESSAGE_BUILD_SIGNATURE_DOESNT_MATCH);
+                }
+                else if (Client.IsHandshakeDone && !IsAnyClientConnected)
+                {
+                    //
+                    // The first debugger is connected, start executing the commands
+                    //
+                    IsAnyClientConnected = TRUE;
+                    SetEvent(g_RemoteConnectionServer.ConnectedEvent);
+                }
+            }
+        }
+
+        SpinlockLock(&g_RemoteConnectionServer.Lock);
+
+        //
+        // Frame the output if enough output is buffered or it's buffered for a while
+        //
+        if (!g_RemoteConnectionServer.Output.empty() &&
+            (WaitResult == WSA_WAIT_TIMEOUT ||
+             g_RemoteConnectionServer.Output.size() >= REMOTE_CONNECTION_OUTPUT_COALESCING_SIZE ||
+             GetTickCount64() - g_RemoteConnectionServer.OutputTime >= REMOTE_CONNECTION_OUTPUT_FLUSH_INTERVAL))
+        {
+            RemoteConnectionServerFrameOutput();
+        }
+
+        //
+        // Send the buffered frames and remove the disconnected debuggers
+        //
+        for (auto Client = g_RemoteConnectionServer.Clients.begin(); Client != g_RemoteConnectionServer.Clients.end();)
+        {
+            if (std::find(DroppedClients.begin(), DroppedClients.end(), Client->Tag) == DroppedClients.end() &&
+                RemoteConnectionServerSendToClient(*Client) &&
+                !(Client->IsClosing && Client->SendBuffer.empty()))
+            {
+                Client++;
+                continue;
+            }
+
+            if (Client->IsStalled)
+            {
+                Notices.push_back(std::string("err, the debugger is not receiving the output, disconnecting : ") + Client->Address + "\n");
+            }
+            else
+            {
+                Notices.push_back(std::string("disconnected from : ") + Client->Address + "\n");
+            }
+
+            CommunicationServerCloseClient(Client->Socket);
+            WSACloseEvent(Client->Event);
+
+            Client = g_RemoteConnectionServer.Clients.erase(Client);
+        }
+
+        if (IsAnyClientConnected && g_RemoteConnectionServer.Clients.empty())
+        {
+            g_RemoteConnectionServer.IsFinished = TRUE;
+        }
+
+        SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+
+        DroppedClients.clear();
+
+        //
+        // The messages are shown without holding the lock as they might be
+        // sent to the debuggers too
+        //
+        for (auto & Notice : Notices)
+        {
+            ShowMessages("%s", Notice.c_str());
+        }
+
+        Notices.clear();
+
+        if (g_RemoteConnectionServer.IsFinished)
+        {
+            break;
+        }
+    }
+
+    //
+    // Wake up the thread of the '.listen' command
+    //
+    SpinlockLock(&g_RemoteConnectionServer.Lock);
+    g_RemoteConnectionServer.IsFinished = TRUE;
+    SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+
+    SetEvent(g_RemoteConnectionServer.ConnectedEvent);
+    SetEvent(g_RemoteConnectionServer.CommandEvent);
+
+    RemoteConnectionServerCloseClients();
+
+    return 0;
+}
+
+/**
+ * @brief Create the listening socket and start the event loop
+ *
+ * @param Port
+ * @return BOOLEAN
+ */
+static BOOLEAN
+RemoteConnectionServerStart(PCSTR Port)
+{
+    HANDLE Thread;
+    DWORD  ThreadId;
+
+    g_RemoteConnectionServer.Lock             = 0;
+    g_RemoteConnectionServer.IsStopping       = FALSE;
+    g_RemoteConnectionServer.IsFinished       = FALSE;
+    g_RemoteConnectionServer.CommandClientTag = 0;
+    g_RemoteConnectionServer.CommandId        = 0;
+    g_RemoteConnectionServer.Clients.clear();
+    g_RemoteConnectionServer.Commands.clear();
+    g_RemoteConnectionServer.Output.clear();
+
+    if (CommunicationServerCreateListeningSocket(Port, &g_RemoteConnectionServer.ListenSocket) != 0)
+    {
+        return FALSE;
+    }
+
+    g_RemoteConnectionServer.ListenEvent = WSACreateEvent();
+
+    if (g_RemoteConnectionServer.ListenEvent == WSA_INVALID_EVENT ||
+        WSAEventSelect(g_RemoteConnectionServer.ListenSocket, g_RemoteConnectionServer.ListenEvent, FD_ACCEPT) == SOCKET_ERROR)
+    {
+        ShowMessages("err, unable to listen for the debuggers (%d)\n", WSAGetLastError());
+
+        if (g_RemoteConnectionServer.ListenEvent != WSA_INVALID_EVENT)
+        {
+            WSACloseEvent(g_RemoteConnectionServer.ListenEvent);
+        }
+
+        CommunicationServerCleanup(g_RemoteConnectionServer.ListenSocket);
+        return FALSE;
+    }
+
+    g_RemoteConnectionServer.WakeEvent      = CreateEvent(NULL, FALSE, FALSE, NULL);
+    g_RemoteConnectionServer.CommandEvent   = CreateEvent(NULL, FALSE, FALSE, NULL);
+    g_RemoteConnectionServer.ConnectedEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+    Thread = CreateThread(NULL, 0, RemoteConnectionServerThread, NULL, 0, &ThreadId);
+
+    SpinlockLock(&g_RemoteConnectionServer.Lock);
+    g_RemoteConnectionServer.Thread = Thread;
+    SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+
+    return TRUE;
+}
 
-extern BOOLEAN g_IsConnectedToHyperDbgLocally;
-extern BOOLEAN g_IsConnectedToRemoteDebuggee;
-extern BOOLEAN g_IsConnectedToRemoteDebugger;
-extern BOOLEAN g_BreakPrintingOutput;
-extern BOOLEAN g_IsEndOfMessageReceived;
+/**
+ * @brief Stop the event loop (after sending the buffered frames) and close
+ * the listening socket
+ *
+ * @return VOID
+ */
+static VOID
+RemoteConnectionServerStop()
+{
+    HANDLE Thread;
 
-extern SOCKET g_SeverSocket;
-extern SOCKET g_ServerListenSocket;
-extern SOCKET g_ClientConnectSocket;
+    SpinlockLock(&g_RemoteConnectionServer.Lock);
+    g_RemoteConnectionServer.IsStopping = TRUE;
+    Thread                              = g_RemoteConnectionServer.Thread;
+    SpinlockUnlock(&g_RemoteConnectionServer.Lock);
 
-extern HANDLE g_RemoteDebuggeeListeningThread;
-extern HANDLE g_EndOfMessageReceivedEvent;
+    SetEvent(g_RemoteConnectionServer.WakeEvent);
+    WaitForSingleObject(Thread, INFINITE);
+
+    //
+    // No more output is buffered once the thread is removed
+    //
+    SpinlockLock(&g_RemoteConnectionServer.Lock);
+    g_RemoteConnectionServer.Thread = NULL;
+    SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+
+    CloseHandle(Thread);
+    CloseHandle(g_RemoteConnectionServer.WakeEvent);
+    CloseHandle(g_RemoteConnectionServer.CommandEvent);
+    CloseHandle(g_RemoteConnectionServer.ConnectedEvent);
+    WSACloseEvent(g_RemoteConnectionServer.ListenEvent);
+
+    CommunicationServerCleanup(g_RemoteConnectionServer.ListenSocket);
+}
+
+/**
+ * @brief Wait for the next command of the debuggers
+ *
+ * @param Command
+ * @return BOOLEAN FALSE if all of the debuggers are disconnected
+ */
+static BOOLEAN
+RemoteConnectionServerWaitForCommand(REMOTE_CONNECTION_COMMAND * Command)
+{
+    BOOLEAN IsFinished;
+
+    while (TRUE)
+    {
+        SpinlockLock(&g_RemoteConnectionServer.Lock);
+
+        if (!g_RemoteConnectionServer.Commands.empty())
+        {
+            *Command = std::move(g_RemoteConnectionServer.Commands.front());
+            g_RemoteConnectionServer.Commands.pop_front();
+
+            g_RemoteConnectionServer.CommandClientTag = Command->ClientTag;
+            g_RemoteConnectionServer.CommandId        = Command->Id;
+
+            SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+            return TRUE;
+        }
+
+        IsFinished = g_RemoteConnectionServer.IsFinished;
+
+        SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+
+        if (IsFinished)
+        {
+            return FALSE;
+        }
+
+        WaitForSingleObject(g_RemoteConnectionServer.CommandEvent, INFINITE);
+    }
+}
+
+/**
+ * @brief Send the rest of the output and the end of the output of the
+ * executed command
+ * @details The debugger that sent the command receives the ID of the command,
+ * the other debuggers receive the broadcast ID
+ *
+ * @return VOID
+ */
+static VOID
+RemoteConnectionServerFinishCommand()
+{
+    SpinlockLock(&g_RemoteConnectionServer.Lock);
+
+    RemoteConnectionServerFrameOutput();
+
+    for (auto & Client : g_RemoteConnectionServer.Clients)
+    {
+        if (Client.IsHandshakeDone && !Client.IsClosing)
+        {
+            RemoteConnectionServerQueueFrame(Client,
+                                             REMOTE_CONNECTION_FRAME_TYPE_END_OF_OUTPUT,
+                                             Client.Tag == g_RemoteConnectionServer.CommandClientTag ? g_RemoteConnectionServer.CommandId : REMOTE_CONNECTION_ID_BROADCAST,
+                                             NULL,
+                                             0);
+        }
+    }
+
+    g_RemoteConnectionServer.CommandClientTag = 0;
+    g_RemoteConnectionServer.CommandId        = 0;
+
+    SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+
+    SetEvent(g_RemoteConnectionServer.WakeEvent);
+}
 
 /**
  * @brief Listen of a port and wait for a client connection
@@ -39,7 +806,7 @@ extern HANDLE g_EndOfMessageReceivedEvent;
 VOID
 RemoteConnectionListen(PCSTR Port)
 {
-    char recvbuf[COMMUNICATION_BUFFER_SIZE] = {0};
+    REMOTE_CONNECTION_COMMAND Command;
 
     //
     // Check if the debugger or debuggee is already active
@@ -50,154 +817,216 @@ RemoteConnectionListen(PCSTR Port)
     }
 
     //
-    // Start server and wait for client
-    //
-    CommunicationServerCreateServerAndWaitForClient(Port, &g_SeverSocket, &g_ServerListenSocket);
-
-    //
-    // Check the version of debuggee and debugger
+    // Start server and wait for the first debugger (more debuggers
+    // could connect later)
     //
-    if (CommunicationServerReceiveMessage(g_SeverSocket, recvbuf, COMMUNICATION_BUFFER_SIZE) != 0)
+    if (!RemoteConnectionServerStart(Port))
     {
-        //
-        // Failed
-        //
-        ShowMessages("err, unable to handshake with the remote debugger\n");
-
-        //
-        // Close the connection
-        //
-        CommunicationServerShutdownAndCleanupConnection(g_SeverSocket, g_ServerListenSocket);
-
         return;
     }
 
-    //
-    // Check whether the signature of debuggee and debugger match or not
-    //
-    if (strcmp((const char *)BuildSignature, recvbuf) != 0)
-    {
-        //
-        // Build version not matched
-        //
-        ShowMessages(ASSERT_MESSAGE_BUILD_SIGNATURE_DOESNT_MATCH);
+    WaitForSingleObject(g_RemoteConnectionServer.ConnectedEvent, INFINITE);
 
+    if (!g_RemoteConnectionServer.IsFinished)
+    {
         //
-        // Send unsuccessful handshake (version match) message
+        // Indicate that it's a remote debugger
         //
-        if (CommunicationServerSendMessage(g_SeverSocket, "NO", 3) != 0)
-        {
-            //
-            // Failed
-            //
-            ShowMessages("err, unable to handshake with the remote debugger\n");
-        }
+        g_IsConnectedToRemoteDebugger = TRUE;
 
         //
-        // Close the connection
+        // And also, make it a local debugger
         //
-        CommunicationServerShutdownAndCleanupConnection(g_SeverSocket, g_ServerListenSocket);
+        g_IsConnectedToHyperDbgLocally = TRUE;
 
-        return;
-    }
-    else
-    {
         //
-        // Send successful handshake (version match) message
+        // This loop works as a command executer, the results are sent to the
+        // debuggers by the event loop
         //
-        if (CommunicationServerSendMessage(g_SeverSocket, "OK", 3) != 0)
+        while (RemoteConnectionServerWaitForCommand(&Command))
         {
             //
-            // Failed
+            // Execute the command
             //
-            ShowMessages("err, unable to handshake with the remote debugger\n");
+            int CommandExecutionResult = HyperDbgInterpreter(Command.Command.data());
 
             //
-            // Close the connection
+            // Send end of the output
             //
-            CommunicationServerShutdownAndCleanupConnection(g_SeverSocket, g_ServerListenSocket);
+            RemoteConnectionServerFinishCommand();
 
-            return;
+            //
+            // if the debugger encounters an exit state then the return will be 1
+            //
+            if (CommandExecutionResult == 1)
+            {
+                //
+                // Send the rest of the frames and exit from the debugger
+                //
+                RemoteConnectionServerStop();
+                exit(0);
+            }
         }
+
+        //
+        // Indicate that debugger is not connected
+        //
+        g_IsConnectedToHyperDbgLocally = FALSE;
+
+        //
+        // Indicate that it's note a remote debugger
+        //
+        g_IsConnectedToRemoteDebugger = FALSE;
     }
 
     //
-    // Indicate that it's a remote debugger
+    // Indicate that we're not in remote debugger anymore
     //
-    g_IsConnectedToRemoteDebugger = TRUE;
+    ShowMessages("closing the conntection...\n");
 
     //
-    // And also, make it a local debugger
+    // Close the connection
     //
-    g_IsConnectedToHyperDbgLocally = TRUE;
+    RemoteConnectionServerStop();
+}
 
-    //
-    // Zero the buffer for next command
-    //
-    RtlZeroMemory(recvbuf, COMMUNICATION_BUFFER_SIZE);
+/**
+ * @brief Send the results of executing a command from deubggee (server, guest)
+ * to the debugger (client, host)
+ * @details The output is buffered and sent in large frames, once enough
+ * output is buffered, a command is finished, or after a short interval
+ *
+ * @param sendbuf buffer address
+ * @param len length of buffer
+ * @return int returning 0 means that there was no error in
+ * executing the function and 1 shows there was an error
+ */
+int
+RemoteConnectionSendResultsToHost(const char * sendbuf, int len)
+{
+    BOOLEAN Wake = FALSE;
 
-    while (true)
+    if (len <= 0)
     {
-        //
-        // Receive message (this loop works as a command executer,
-        // we don't send the results to the remote machine by using
-        // this tools
-        //
-        if (CommunicationServerReceiveMessage(g_SeverSocket, recvbuf, COMMUNICATION_BUFFER_SIZE) != 0)
-        {
-            //
-            // Failed, break
-            //
-            break;
-        }
+        return 1;
+    }
 
-        //
-        // Execute the command
-        //
-        int CommandExecutionResult = HyperDbgInterpreter(recvbuf);
+    SpinlockLock(&g_RemoteConnectionServer.Lock);
 
-        //
-        // Send end of buffer
-        //
-        RemoteConnectionSendResultsToHost((const char *)g_EndOfBufferCheckTcp, sizeof(g_EndOfBufferCheckTcp));
+    if (g_RemoteConnectionServer.Thread == NULL)
+    {
+        SpinlockUnlock(&g_RemoteConnectionServer.Lock);
+        return 1;
+    }
 
+    if (g_RemoteConnectionServer.Output.empty())
+    {
         //
-        // if the debugger encounters an exit state then the return will be 1
+        // The event loop should flush it after the interval
         //
-        if (CommandExecutionResult == 1)
-        {
-            //
-            // Exit from the debugger
-            //
-            exit(0);
-        }
+        g_RemoteConnectionServer.OutputTime = GetTickCount64();
+        Wake                                = TRUE;
+    }
 
-        //
-        // Zero the buffer for next command
-        //
-        RtlZeroMemory(recvbuf, COMMUNICATION_BUFFER_SIZE);
+    g_RemoteConnectionServer.Output.insert(g_RemoteConnectionServer.Output.end(), sendbuf, sendbuf + len);
+
+    if (g_RemoteConnectionServer.Output.size() >= REMOTE_CONNECTION_OUTPUT_COALESCING_SIZE)
+    {
+        RemoteConnectionServerFrameOutput();
+        Wake = TRUE;
     }
 
-    //
-    // Indicate that debugger is not connected
-    //
-    g_IsConnectedToHyperDbgLocally = FALSE;
+    SpinlockUnlock(&g_RemoteConnectionServer.Lock);
 
-    //
-    // Indicate that it's note a remote debugger
-    //
-    g_IsConnectedToRemoteDebugger = FALSE;
+    if (Wake)
+    {
+        SetEvent(g_RemoteConnectionServer.WakeEvent);
+    }
 
-    //
-    // Indicate that we're not in remote debugger anymore
-    //
-    ShowMessages("closing the conntection...\n");
+    return 0;
+}
+
+//////////////////////////////////////////
+//		    Client (debugger)           //
+//////////////////////////////////////////
+
+/**
+ * @brief Send a frame to the debuggee
+ *
+ * @param Type
+ * @param Id
+ * @param Payload
+ * @param Length
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+RemoteConnectionSendFrameToDebuggee(REMOTE_CONNECTION_FRAME_TYPE Type, UINT32 Id, const CHAR * Payload, UINT32 Length)
+{
+    std::vector<CHAR> Frame;
 
     //
-    // Close the connection
+    // The header and the payload are sent at once
     //
-    CommunicationServerShutdownAndCleanupConnection(g_SeverSocket,
-                                                    g_ServerListenSocket);
+    Frame.reserve(sizeof(REMOTE_CONNECTION_FRAME_HEADER) + Length);
+    RemoteConnectionBuildFrame(Frame, Type, Id, Payload, Length);
+
+    return CommunicationClientSendMessage(g_ClientConnectSocket, Frame.data(), (int)Frame.size()) == 0;
+}
+
+/**
+ * @brief Receive a frame from the debuggee
+ *
+ * @param Header
+ * @param Payload
+ *
+ * @return BOOLEAN FALSE if the connection is closed
+ */
+static BOOLEAN
+RemoteConnectionReceiveFrameFromDebuggee(REMOTE_CONNECTION_FRAME_HEADER * Header, std::vector<CHAR> & Payload)
+{
+    if (CommunicationClientReceiveMessage(g_ClientConnectSocket, (CHAR *)Header, sizeof(REMOTE_CONNECTION_FRAME_HEADER)) != 0)
+    {
+        return FALSE;
+    }
+
+    if (Header->Length > REMOTE_CONNECTION_MAXIMUM_FRAME_SIZE)
+    {
+        ShowMessages("err, invalid frame is received from the debuggee\n");
+        return FALSE;
+    }
+
+    Payload.resize(Header->Length);
+
+    if (Header->Length != 0 &&
+        CommunicationClientReceiveMessage(g_ClientConnectSocket, Payload.data(), Header->Length) != 0)
+    {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Show the output of the debuggee
+ * @details The output is shown in pieces that fit in the buffer of ShowMessages
+ *
+ * @param Output
+ * @param Length
+ *
+ * @return VOID
+ */
+static VOID
+RemoteConnectionShowOutput(const CHAR * Output, UINT32 Length)
+{
+    UINT32 Size;
+
+    for (UINT32 Offset = 0; Offset < Length; Offset += Size)
+    {
+        Size = Length - Offset > COMMUNICATION_BUFFER_SIZE - 1 ? COMMUNICATION_BUFFER_SIZE - 1 : Length - Offset;
+
+        ShowMessages("%.*s", (int)Size, Output + Offset);
+    }
 }
 
 /**
@@ -210,15 +1039,15 @@ RemoteConnectionListen(PCSTR Port)
 DWORD WINAPI
 RemoteConnectionThreadListeningToDebuggee(LPVOID lpParam)
 {
-    char   RecvBuf[COMMUNICATION_BUFFER_SIZE + TCP_END_OF_BUFFER_CHARS_COUNT] = {0};
-    UINT32 BuffLenReceived                                                    = 0;
+    REMOTE_CONNECTION_FRAME_HEADER Header;
+    std::vector<CHAR>              Payload;
 
     while (g_IsConnectedToRemoteDebuggee)
     {
         //
-        // Receive message
+        // Receive frame
         //
-        if (CommunicationClientReceiveMessage(g_ClientConnectSocket, RecvBuf, COMMUNICATION_BUFFER_SIZE, &BuffLenReceived) != 0)
+        if (!RemoteConnectionReceiveFrameFromDebuggee(&Header, Payload))
         {
             //
             // Failed, break
@@ -226,58 +1055,37 @@ RemoteConnectionThreadListeningToDebuggee(LPVOID lpParam)
             break;
         }
 
-        //
-        // Check if it's end of the buffer
-        //
-        for (size_t i = 0; i < BuffLenReceived; i++)
+        if (Header.Type == REMOTE_CONNECTION_FRAME_TYPE_OUTPUT)
         {
-            if (RecvBuf[i] == g_EndOfBufferCheckTcp[0] &&
-                RecvBuf[i + 1] == g_EndOfBufferCheckTcp[1] &&
-                RecvBuf[i + 2] == g_EndOfBufferCheckTcp[2] &&
-                RecvBuf[i + 3] == g_EndOfBufferCheckTcp[3])
+            //
+            // This is just because we want to show a correct signature
+            //
+            if (!g_BreakPrintingOutput)
             {
-                g_IsEndOfMessageReceived = TRUE;
-
                 //
-                // Cut the last string using \x00 \x00
+                // Show message from remote debuggee
                 //
-                RecvBuf[i]     = '\x00';
-                RecvBuf[i + 1] = '\x00';
-                break;
+                RemoteConnectionShowOutput(Payload.data(), Header.Length);
             }
         }
-
-        //
-        // This is just because we want to show a correct signature
-        //
-        if (!g_BreakPrintingOutput)
-        {
-            //
-            // Show message from remote debuggee
-            //
-            ShowMessages("%s", RecvBuf);
-        }
-
-        //
-        // Show the signature
-        //
-        if (g_IsEndOfMessageReceived)
+        else if (Header.Type == REMOTE_CONNECTION_FRAME_TYPE_END_OF_OUTPUT)
         {
-            //
-            // it's not end of message anymore
-            //
-            g_IsEndOfMessageReceived = FALSE;
-
-            //
-            // Trigger the event
-            //
-            SetEvent(g_EndOfMessageReceivedEvent);
+            if (Header.Id != REMOTE_CONNECTION_ID_BROADCAST)
+            {
+                //
+                // Our command is executed, trigger the event
+                //
+                InterlockedDecrement(&g_RemoteConnectionPendingCommands);
+                SetEvent(g_EndOfMessageReceivedEvent);
+            }
+            else if (g_RemoteConnectionPendingCommands == 0)
+            {
+                //
+                // A command of another debugger is executed, show the signature
+                //
+                HyperDbgShowSignature();
+            }
         }
-
-        //
-        // Clear the buffer
-        //
-        RtlZeroMemory(RecvBuf, COMMUNICATION_BUFFER_SIZE);
     }
 
     //
@@ -314,9 +1122,9 @@ RemoteConnectionThreadListeningToDebuggee(LPVOID lpParam)
 VOID
 RemoteConnectionConnect(PCSTR Ip, PCSTR Port)
 {
-    DWORD  ThreadId;
-    CHAR   Recv[3]  = {0};
-    UINT32 BuffRecv = 0;
+    DWORD                          ThreadId;
+    REMOTE_CONNECTION_FRAME_HEADER Header;
+    std::vector<CHAR>              Payload;
 
     //
     // Check if the debugger or debuggee is already active
@@ -360,40 +1168,48 @@ RemoteConnectionConnect(PCSTR Ip, PCSTR Port)
         //
         // Connection was successful
         //
+        RemoteConnectionSetSocketOptions(g_ClientConnectSocket);
 
         //
         // Check to see whether the version of debugger and debuggee matches together or not
         //
-        if (CommunicationClientSendMessage(g_ClientConnectSocket, (const char *)BuildSignature, sizeof(BuildSignature)) != 0)
+        if (!RemoteConnectionSendFrameToDebuggee(REMOTE_CONNECTION_FRAME_TYPE_HANDSHAKE,
+                                                 0,
+                                                 (const CHAR *)BuildSignature,
+                                                 sizeof(BuildSignature)))
         {
             //
             // Failed
             //
             ShowMessages("err, failed to communicate with debuggee\n");
+            RemoteConnectionCloseTheConnectionWithDebuggee();
             return;
         }
 
         //
         // Receive the handshake results
         //
-        if (CommunicationClientReceiveMessage(g_ClientConnectSocket, Recv, sizeof(Recv), &BuffRecv) != 0)
+        if (!RemoteConnectionReceiveFrameFromDebuggee(&Header, Payload) ||
+            Header.Type != REMOTE_CONNECTION_FRAME_TYPE_HANDSHAKE_RESULT)
         {
             //
             // Failed, break
             //
             ShowMessages("err, failed to receive message from debuggee\n");
+            RemoteConnectionCloseTheConnectionWithDebuggee();
             return;
         }
 
         //
         // Check if the handshake was successful or not
         //
-        if (strcmp((const char *)"OK", Recv) != 0)
+        if (Header.Length != 3 || strcmp((const char *)"OK", Payload.data()) != 0)
         {
             //
             // Build version not matched
             //
             ShowMessages(ASSERT_MESSAGE_BUILD_SIGNATURE_DOESNT_MATCH);
+            RemoteConnectionCloseTheConnectionWithDebuggee();
             return;
         }
 
@@ -444,14 +1260,29 @@ RemoteConnectionConnect(PCSTR Ip, PCSTR Port)
 int
 RemoteConnectionSendCommand(const char * sendbuf, int len)
 {
+    UINT32 Id;
+
+    //
+    // The ID of the command is echoed in the end of its output (zero is
+    // used for the commands of the other debuggers)
+    //
+    do
+    {
+        Id = (UINT32)InterlockedIncrement(&g_RemoteConnectionLastCommandId);
+
+    } while (Id == REMOTE_CONNECTION_ID_BROADCAST);
+
+    InterlockedIncrement(&g_RemoteConnectionPendingCommands);
+
     //
     // Send Message
     //
-    if (CommunicationClientSendMessage(g_ClientConnectSocket, sendbuf, len) != 0)
+    if (!RemoteConnectionSendFrameToDebuggee(REMOTE_CONNECTION_FRAME_TYPE_COMMAND, Id, sendbuf, (UINT32)len))
     {
         //
         // Failed
         //
+        InterlockedDecrement(&g_RemoteConnectionPendingCommands);
         return 1;
     }
 
@@ -468,32 +1299,6 @@ RemoteConnectionSendCommand(const char * sendbuf, int len)
     return 0;
 }
 
-/**
- * @brief Send the results of executing a command from deubggee (server, guest)
- * to the debugger (client, host)
- *
- * @param sendbuf buffer address
- * @param len length of buffer
- * @return int returning 0 means that there was no error in
- * executing the function and 1 shows there was an error
- */
-int
-RemoteConnectionSendResultsToHost(const char * sendbuf, int len)
-{
-    //
-    // Send the message
-    //
-    if (CommunicationServerSendMessage(g_SeverSocket, sendbuf, len) != 0)
-    {
-        //
-        // Failed
-        //
-        return 1;
-    }
-
-    return 0;
-}
-
 /**
  * @brief Close the connect from client side to the debuggee
  *
@@ -506,5 +1311,7 @@ RemoteConnectionCloseTheConnectionWithDebuggee()
     CommunicationClientShutdownConnection(g_ClientConnectSocket);
     CommunicationClientCleanup(g_ClientConnectSocket);
 
+    g_RemoteConnectionPendingCommands = 0;
+
     return 0;
 }
@@ -101,6 +101,7 @@ CommunicationClientConnectToServer(PCSTR Ip, PCSTR Port, SOCKET * ConnectSocketA
 
 /**
  * @brief Send message a client
+ * @details the whole buffer is sent
  *
  * @param ConnectSocket
  * @param sendbuf
@@ -112,16 +113,17 @@ CommunicationClientSendMessage(SOCKET ConnectSocket, const char * sendbuf, int b
 {
     int iResult;
 
-    //
-    // Send an initial buffer
-    //
-    iResult = send(ConnectSocket, sendbuf, buflen, 0);
-    if (iResult == SOCKET_ERROR)
+    while (buflen > 0)
     {
-        ShowMessages("err, send failed (%x)\n", WSAGetLastError());
-        closesocket(ConnectSocket);
-        WSACleanup();
-        return 1;
+        iResult = send(ConnectSocket, sendbuf, buflen, 0);
+        if (iResult == SOCKET_ERROR)
+        {
+            ShowMessages("err, send failed (%x)\n", WSAGetLastError());
+            return 1;
+        }
+
+        sendbuf += iResult;
+        buflen -= iResult;
     }
 
     return 0;
@@ -162,45 +164,35 @@ CommunicationClientShutdownConnection(SOCKET ConnectSocket)
 
 /**
  * @brief Receive message as a client
+ * @details exactly BuffLen bytes are received
  *
  * @param ConnectSocket
  * @param RecvBuf
- * @param MaxBuffLen
- * @param BuffLenRecvd
+ * @param BuffLen
  * @return int
  */
 int
-CommunicationClientReceiveMessage(SOCKET ConnectSocket, CHAR * RecvBuf, UINT32 MaxBuffLen, PUINT32 BuffLenRecvd)
+CommunicationClientReceiveMessage(SOCKET ConnectSocket, CHAR * RecvBuf, UINT32 BuffLen)
 {
     int Result;
 
-    //
-    // Receive until the peer closes the connection
-    //
-    Result = recv(ConnectSocket, RecvBuf, MaxBuffLen, 0);
-    if (Result > 0)
-    {
-        //
-        // Set recvd buff len
-        //
-        *BuffLenRecvd = Result;
-
-        /*
-    ShowMessages("bytes received: %d\n", iResult);
-        */
-    }
-    else if (Result == 0)
-    {
-        //
-        // Last packet
-        //
-    }
-    else
+    while (BuffLen > 0)
     {
-        ShowMessages("\nrecv failed with error: %d\n", WSAGetLastError());
-        ShowMessages("the remote system closes the connection.\n\n");
+        Result = recv(ConnectSocket, RecvBuf, BuffLen, 0);
+        if (Result == 0)
+        {
+            ShowMessages("the remote system closes the connection.\n\n");
+            return 1;
+        }
+        else if (Result < 0)
+        {
+            ShowMessages("\nrecv failed with error: %d\n", WSAGetLastError());
+            ShowMessages("the remote system closes the connection.\n\n");
+            return 1;
+        }
 
-        return 1;
+        RecvBuf += Result;
+        BuffLen -= Result;
     }
 
     return 0;
@@ -19,24 +19,21 @@
 #pragma warning(disable : 4996)
 
 /**
- * @brief Create server and wait for a client to connect
- * @details this function only accepts one client not multiple clients
+ * @brief Create the server socket that listens for the clients
+ * @details several clients could connect to the server, they're
+ * accepted by CommunicationServerAcceptClient
  *
  * @param Port
- * @param ClientSocketArg
  * @param ListenSocketArg
  * @return int
  */
 int
-CommunicationServerCreateServerAndWaitForClient(PCSTR    Port,
-                                                SOCKET * ClientSocketArg,
-                                                SOCKET * ListenSocketArg)
+CommunicationServerCreateListeningSocket(PCSTR Port, SOCKET * ListenSocketArg)
 {
     WSADATA wsaData;
     int     iResult;
 
     SOCKET ListenSocket = INVALID_SOCKET;
-    SOCKET ClientSocket = INVALID_SOCKET;
 
     struct addrinfo * result = NULL;
     struct addrinfo   hints;
@@ -105,204 +102,93 @@ CommunicationServerCreateServerAndWaitForClient(PCSTR    Port,
         return 1;
     }
 
-    //
-    // Accept a client socket
-    //
-    sockaddr_in name    = {0};
-    int         addrlen = sizeof(name);
-
-    ClientSocket = accept(ListenSocket, (struct sockaddr *)&name, &addrlen);
-
-    if (ClientSocket == INVALID_SOCKET)
-    {
-        ShowMessages("err, accept failed (%x)\n", WSAGetLastError());
-        closesocket(ListenSocket);
-        WSACleanup();
-        return 1;
-    }
-
-    //
-    // Show that we connected to a client
-    //
-    ShowMessages("connected to : %s:%d\n", inet_ntoa(name.sin_addr), ntohs(name.sin_port));
-
     //
     // Set the argument
     //
-    *ClientSocketArg = ClientSocket;
     *ListenSocketArg = ListenSocket;
 
     return 0;
 }
 
 /**
- * @brief listen and receive message as the server
+ * @brief Accept a client that is connected to the server
  *
- * @param ClientSocket
- * @param recvbuf
- * @param recvbuflen
+ * @param ListenSocket
+ * @param ClientSocketArg
+ * @param Address Buffer to save the address of the client (ip:port)
+ * @param AddressLength
  * @return int
  */
 int
-CommunicationServerReceiveMessage(SOCKET ClientSocket, char * recvbuf, int recvbuflen)
+CommunicationServerAcceptClient(SOCKET ListenSocket, SOCKET * ClientSocketArg, CHAR * Address, UINT32 AddressLength)
 {
-    int iResult;
+    SOCKET      ClientSocket = INVALID_SOCKET;
+    sockaddr_in name         = {0};
+    int         addrlen      = sizeof(name);
 
     //
-    // Receive until the peer shuts down the connection
+    // Accept a client socket
     //
-    iResult = recv(ClientSocket, recvbuf, recvbuflen, 0);
-    if (iResult > 0)
-    {
-        //
-        // ShowMessages("bytes received: %d\n", iResult);
-        //
-    }
-    else if (iResult == 0)
-    {
-        //
-        // ShowMessages("connection closing...\n");
-        //
-    }
-    else
-    {
-        ShowMessages("err, recv failed (%x)\n", WSAGetLastError());
-        closesocket(ClientSocket);
-        WSACleanup();
+    ClientSocket = accept(ListenSocket, (struct sockaddr *)&name, &addrlen);
 
+    if (ClientSocket == INVALID_SOCKET)
+    {
         return 1;
     }
 
+    sprintf_s(Address, AddressLength, "%s:%d", inet_ntoa(name.sin_addr), ntohs(name.sin_port));
+
+    //
+    // Set the argument
+    //
+    *ClientSocketArg = ClientSocket;
+
     return 0;
 }
 
 /**
- * @brief send message as the server
+ * @brief Shutdown and close the connection of a client as server
  *
  * @param ClientSocket
- * @param sendbuf
- * @param length
  * @return int
  */
 int
-CommunicationServerSendMessage(SOCKET ClientSocket, const char * sendbuf, int length)
+CommunicationServerCloseClient(SOCKET ClientSocket)
 {
-    int iSendResult;
+    int iResult;
 
     //
-    // Echo the buffer back to the sender
+    // shutdown the connection since we're done
+    //
+    iResult = shutdown(ClientSocket, SD_SEND);
+
+    //
+    // We don't show the error of shutdown because the connection
+    // might be removed
     //
-    iSendResult = send(ClientSocket, sendbuf, length, 0);
-    if (iSendResult == SOCKET_ERROR)
-    {
-        /*
-    ShowMessages("err, send failed (%x)\n", WSAGetLastError());
     closesocket(ClientSocket);
-    WSACleanup();
-        */
-        return 1;
-    }
-    return 0;
+
+    return iResult == SOCKET_ERROR ? 1 : 0;
 }
 
 /**
- * @brief Shutdown and cleanup connection as server
+ * @brief Close the listening socket and cleanup as server
  *
- * @param ClientSocket
  * @param ListenSocket
  * @return int
  */
 int
-CommunicationServerShutdownAndCleanupConnection(SOCKET ClientSocket,
-                                                SOCKET ListenSocket)
+CommunicationServerCleanup(SOCKET ListenSocket)
 {
-    int iResult;
-
     //
     // No longer need server socket
     //
     closesocket(ListenSocket);
 
-    //
-    // shutdown the connection since we're done
-    //
-    iResult = shutdown(ClientSocket, SD_SEND);
-    if (iResult == SOCKET_ERROR)
-    {
-        //
-        // We comment this line because the connection might be removed;
-        // thus, we don't need to show error
-        //
-
-        /*
-    ShowMessages("err, shutdown failed (%x)\n", WSAGetLastError());
-    */
-
-        closesocket(ClientSocket);
-        WSACleanup();
-        return 1;
-    }
-
     //
     // cleanup
     //
-    closesocket(ClientSocket);
     WSACleanup();
 
     return 0;
 }
-
-//
-// int __cdecl main(void) {
-//
-//   SOCKET ClientSocket;
-//   SOCKET ListenSocket;
-//
-//   char recvbuf[DEFAULT_BUFLEN] = {0};
-//   char sendbuf[DEFAULT_BUFLEN] = "hello, I love taylor";
-//
-//   //
-//   // Start server and wait for client
-//   //
-//   CommunicationServerCreateServerAndWaitForClient(DEFAULT_PORT,
-//   &ClientSocket,
-//   &ListenSocket);
-//
-//   while (true) {
-//
-//     //
-//     // Receive message
-//     //
-//     if (CommunicationServerReceiveMessage(ClientSocket, recvbuf,
-//                                           DEFAULT_BUFLEN) != 0) {
-//       //
-//       // Failed, break
-//       //
-//       break;
-//     }
-//
-//     ShowMessages("%s\n", recvbuf);
-//
-//     //
-//     // Send the message
-//     //
-//     if (CommunicationServerSendMessage(ClientSocket, sendbuf,
-//                                        strlen(sendbuf)) != 0) {
-//       //
-//       // Failed, break
-//       //
-//       break;
-//     }
-//   }
-//
-//   ShowMessages("close conntection\n");
-//
-//   //
-//   // Close the connection
-//   //
-//   CommunicationServerShutdownAndCleanupConnection(ClientSocket,
-//   ListenSocket);
-//
-//   return 0;
-// }
-//
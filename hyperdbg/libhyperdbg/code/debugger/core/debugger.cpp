@@ -544,6 +544,40 @@ ShowErrorMessage(UINT32 Error)
                      Error);
         break;
 
+    case DEBUGGER_ERROR_INSTANT_EVENT_PREALLOCATED_BUFFER_NOT_FOUND_FOR_DISPATCH_TABLE:
+        ShowMessages("err, not enough pre-allocated buffer exists for publishing the event. You can use the 'prealloc' "
+                     "command to fix this issue by pre-allocating more regular event buffers (%x)\nfor more information "
+                     "please visit: https://docs.hyperdbg.org/tips-and-tricks/misc/instant-events\n",
+                     Error);
+        break;
+
+    case DEBUGGER_ERROR_MODIFY_EVENTS_INVALID_GROUP:
+        ShowMessages("err, the event group is invalid (%x)\n",
+                     Error);
+        break;
+
+    case DEBUGGER_ERROR_UNABLE_TO_MAP_SHARED_LOG_RINGS:
+        ShowMessages("err, unable to map the log rings into the debugger process, "
+                     "they might be already mapped into another process (%x)\n",
+                     Error);
+        break;
+
+    case DEBUGGER_ERROR_INVALID_LOG_OVERFLOW_POLICY:
+        ShowMessages("err, the overflow policy of the log buffers is invalid (%x)\n",
+                     Error);
+        break;
+
+    case DEBUGGER_ERROR_INVALID_LOG_COALESCING_THRESHOLDS:
+        ShowMessages("err, the coalescing thresholds of the log buffers are invalid (%x)\n",
+                     Error);
+        break;
+
+    case DEBUGGER_ERROR_DUMP_STREAMING_IS_NOT_AVAILABLE:
+        ShowMessages("err, the debuggee is not able to stream the dump, the packets "
+                     "are not framed or the buffers are not allocated (%x)\n",
+                     Error);
+        break;
+
     default:
         ShowMessages("err, error not found (%x)\n",
                      Error);
@@ -1548,6 +1582,18 @@ RegisterActionToEvent(PDEBUGGER_GENERAL_EVENT_DETAIL Event,
         }
     }
 
+    //
+    // Keep a copy of the actions (the script buffers are already compiled)
+    // so the event can be saved into a session file later
+    //
+    SessionRecordEventActions(Event->Tag,
+                              ActionBreakToDebugger,
+                              ActionBreakToDebuggerLength,
+                              ActionCustomCode,
+                              ActionCustomCodeLength,
+                              ActionScript,
+                              ActionScriptLength);
+
     //
     // As we're not needing any of action buffer, we'll free all of the
     // here in the case of a successful registration of action, however
@@ -2160,6 +2206,17 @@ InterpretGeneralEventAndActionsFields(
         TempActionScript->ScriptBufferSize    = ScriptBufferLength;
         TempActionScript->ScriptBufferPointer = ScriptBufferPointer;
 
+        //
+        // Set the stack footprint that is computed by the compiler
+        //
+        TempActionScript->ScriptStackFootprint = ScriptEngineWrapperGetStackFootprint((PVOID)ScriptCodeBuffer);
+
+        //
+        // Set the predicates that the compiler lowered from the condition of the script (if any)
+        //
+        TempActionScript->ScriptNumberOfConditionPredicates = ScriptEngineWrapperLowerConditionPredicates((PVOID)ScriptCodeBuffer,
+                                                                                                          TempActionScript->ScriptConditionPredicates);
+
         //
         // Increase the count of actions
         //
@@ -1415,6 +1415,8 @@ InitializeCommandsDictionary()
 
     g_CommandsList["flush"] = {&CommandFlush, &CommandFlushHelp, DEBUGGER_COMMAND_FLUSH_ATTRIBUTES};
 
+    g_CommandsList["logbuffer"] = {&CommandLogBuffer, &CommandLogBufferHelp, DEBUGGER_COMMAND_LOGBUFFER_ATTRIBUTES};
+
     g_CommandsList["pause"]  = {&CommandPause, &CommandPauseHelp, DEBUGGER_COMMAND_PAUSE_ATTRIBUTES};
     g_CommandsList[".pause"] = {&CommandPause, &CommandPauseHelp, DEBUGGER_COMMAND_PAUSE_ATTRIBUTES};
 
@@ -1435,6 +1437,8 @@ InitializeCommandsDictionary()
 
     g_CommandsList[".logclose"] = {&CommandLogclose, &CommandLogcloseHelp, DEBUGGER_COMMAND_LOGCLOSE_ATTRIBUTES};
 
+    g_CommandsList[".session"] = {&CommandSession, &CommandSessionHelp, DEBUGGER_COMMAND_SESSION_ATTRIBUTES};
+
     g_CommandsList[".pagein"] = {&CommandPagein, &CommandPageinHelp, DEBUGGER_COMMAND_PAGEIN_ATTRIBUTES};
     g_CommandsList["pagein"]  = {&CommandPagein, &CommandPageinHelp, DEBUGGER_COMMAND_PAGEIN_ATTRIBUTES};
 
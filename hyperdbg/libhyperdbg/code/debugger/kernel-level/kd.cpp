@@ -17,8 +17,9 @@
 extern PMODULE_SYMBOL_DETAIL g_SymbolTable;
 extern UINT32                g_SymbolTableSize;
 extern UINT32                g_SymbolTableCurrentIndex;
+extern UINT32                g_KdRequestWindowSize;
 extern HANDLE                g_SerialListeningThreadHandle;
-extern HANDLE                g_SerialRemoteComPortHandle;
+extern TRANSPORT             g_KdTransport;
 extern HANDLE                g_DebuggeeStopCommandEventHandle;
 extern DEBUGGER_SYNCRONIZATION_EVENTS_STATE
                                         g_KernelSyncronizationObjectsHandleTable[DEBUGGER_MAXIMUM_SYNCRONIZATION_KERNEL_DEBUGGER_OBJECTS];
@@ -26,7 +27,10 @@ extern BYTE                             g_CurrentRunningInstruction[MAXIMUM_INST
 extern BOOLEAN                          g_IsConnectedToHyperDbgLocally;
 extern OVERLAPPED                       g_OverlappedIoStructureForReadDebugger;
 extern OVERLAPPED                       g_OverlappedIoStructureForWriteDebugger;
-extern OVERLAPPED                       g_OverlappedIoStructureForReadDebuggee;
+extern FRAMING_TRANSPORT                g_KdFramingTransport;
+extern volatile LONG                    g_KdFramingSendLock;
+extern PIPELINE_WINDOW                  g_KdReadMemoryPipeline;
+extern UINT8                            g_KdFramingRetransmissionBuffer[MaxSerialPacketSize + sizeof(FRAMING_HEADER)];
 extern DEBUGGER_EVENT_AND_ACTION_RESULT g_DebuggeeResultOfRegisteringEvent;
 extern DEBUGGER_EVENT_AND_ACTION_RESULT
                g_DebuggeeResultOfAddingActionsToEvent;
@@ -41,6 +45,16 @@ extern BOOLEAN g_SharedEventStatus;
 extern BOOLEAN g_IsRunningInstruction32Bit;
 extern BOOLEAN g_IgnorePauseRequests;
 extern BOOLEAN g_IsDebuggeeInHandshakingPhase;
+extern BOOLEAN g_CompressRemoteLogs;
+extern BOOLEAN g_DebuggerAcceptsCompressedLogs;
+extern BOOLEAN g_DebuggerAcceptsFramedPackets;
+extern BOOLEAN g_DebuggerAcceptsBreakContext;
+extern UINT32  g_DebuggerBreakContextCodeBytes;
+extern UINT32  g_DebuggerBreakContextStackQwords;
+extern BOOLEAN g_KdSendBreakContext;
+extern UINT32  g_KdBreakContextCodeBytes;
+extern UINT32  g_KdBreakContextStackQwords;
+extern BOOLEAN g_KdFramedPackets;
 extern BOOLEAN g_ShouldPreviousCommandBeContinued;
 extern BYTE    g_EndOfBufferCheckSerial[4];
 extern ULONG   g_CurrentRemoteCore;
@@ -159,6 +173,11 @@ KdSendContinuePacketToDebuggee()
     //
     g_CurrentRemoteCore = DEBUGGER_DEBUGGEE_IS_RUNNING_NO_CORE;
 
+    //
+    // The memory might be changed once the debuggee runs
+    //
+    KdMemoryCacheInvalidate();
+
     //
     // Send 'g' as continue packet
     //
@@ -196,6 +215,11 @@ KdSendSwitchCorePacketToDebuggee(UINT32 NewCore)
         return FALSE;
     }
 
+    //
+    // The new core might be in another process
+    //
+    KdMemoryCacheInvalidate();
+
     //
     // Send '~' as switch packet
     //
@@ -305,6 +329,52 @@ KdSendEventQueryAndModifyPacketToDebuggee(
     return TRUE;
 }
 
+/**
+ * @brief Sends a modification of the groups of events packet to the debuggee
+ *
+ * @param Tag The target event (if any)
+ * @param TypeOfAction Type of the group modification
+ * @param GroupId The target group
+ *
+ * @return BOOLEAN whether the modification was successful or not
+ */
+BOOLEAN
+KdSendEventGroupModificationPacketToDebuggee(
+    UINT64                      Tag,
+    DEBUGGER_MODIFY_EVENTS_TYPE TypeOfAction,
+    UINT32                      GroupId)
+{
+    DEBUGGER_MODIFY_EVENTS ModifyEventGroupPacket = {0};
+
+    g_SharedEventStatus = FALSE;
+
+    //
+    // Fill the structure of packet
+    //
+    ModifyEventGroupPacket.Tag          = Tag;
+    ModifyEventGroupPacket.TypeOfAction = TypeOfAction;
+    ModifyEventGroupPacket.GroupId      = GroupId;
+
+    //
+    // Send the packet (groups are modified through the query and modify event packet)
+    //
+    if (!KdCommandPacketAndBufferToDebuggee(
+            DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGER_TO_DEBUGGEE_EXECUTE_ON_VMX_ROOT,
+            DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_QUERY_AND_MODIFY_EVENT,
+            (CHAR *)&ModifyEventGroupPacket,
+            sizeof(DEBUGGER_MODIFY_EVENTS)))
+    {
+        return FALSE;
+    }
+
+    //
+    // Wait until the result of the modification is received
+    //
+    DbgWaitForKernelResponse(DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_MODIFY_AND_QUERY_EVENT);
+
+    return g_SharedEventStatus;
+}
+
 /**
  * @brief Send a flush request to the debuggee
  *
@@ -561,6 +631,11 @@ KdSendReadRegisterPacketToDebuggee(PDEBUGGEE_REGISTER_READ_DESCRIPTION RegDes, U
 BOOLEAN
 KdSendWriteRegisterPacketToDebuggee(PDEBUGGEE_REGISTER_WRITE_DESCRIPTION RegDes)
 {
+    //
+    // The registers that are received along with the pause packet are not valid anymore
+    //
+    KdMemoryCacheInvalidateRegisters();
+
     //
     // Set the request data
     //
@@ -596,6 +671,8 @@ KdSendWriteRegisterPacketToDebuggee(PDEBUGGEE_REGISTER_WRITE_DESCRIPTION RegDes)
 BOOLEAN
 KdSendReadMemoryPacketToDebuggee(PDEBUGGER_READ_MEMORY ReadMem, UINT32 RequestSize)
 {
+    ReadMem->RequestId = PIPELINE_REQUEST_ID_NOT_PIPELINED;
+
     //
     // Set the request data
     //
@@ -622,6 +699,177 @@ KdSendReadMemoryPacketToDebuggee(PDEBUGGER_READ_MEMORY ReadMem, UINT32 RequestSi
     return TRUE;
 }
 
+/**
+ * @brief Send one of the pipelined read memory requests
+ *
+ * @param Context The buffers of the requests
+ * @param Index Index of the request
+ * @param RequestId The ID that the debuggee returns in the response
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+KdPipelinedReadMemorySend(PVOID Context, UINT32 Index, UINT32 RequestId)
+{
+    KD_PIPELINED_READ_MEMORY * PipelinedReads = (KD_PIPELINED_READ_MEMORY *)Context;
+    PDEBUGGER_READ_MEMORY      ReadMem        = PipelinedReads->Requests[Index];
+
+    ReadMem->RequestId = RequestId;
+
+    //
+    // Only the header is enough, no need to send the entire buffer
+    //
+    return KdCommandPacketAndBufferToDebuggee(
+        DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGER_TO_DEBUGGEE_EXECUTE_ON_VMX_ROOT,
+        DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_READ_MEMORY,
+        (CHAR *)ReadMem,
+        sizeof(DEBUGGER_READ_MEMORY));
+}
+
+/**
+ * @brief Wait for the responses of the pipelined read memory requests
+ * @details The listening thread also wakes up the sender if a lost request
+ * is detected
+ *
+ * @param Context The buffers of the requests
+ * @param Timeout Maximum time to wait (in milliseconds)
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+KdPipelinedReadMemoryWait(PVOID Context, UINT32 Timeout)
+{
+    UNREFERENCED_PARAMETER(Context);
+
+    DbgWaitForKernelResponseWithTimeout(DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_PIPELINED_READ_MEMORY, Timeout);
+
+    return g_IsSerialConnectedToRemoteDebuggee;
+}
+
+/**
+ * @brief Send several read memory packets to the debuggee without waiting
+ * for the response of each one before sending the next one
+ * @details At most g_KdRequestWindowSize requests are outstanding and the
+ * debuggee answers them in order, the result of each request is saved in
+ * its own buffer
+ *
+ * @param Requests The buffers of the requests
+ * @param RequestSizes Size of each buffer
+ * @param NumberOfRequests
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+KdSendPipelinedReadMemoryPacketsToDebuggee(PDEBUGGER_READ_MEMORY * Requests,
+                                           UINT32 *                RequestSizes,
+                                           UINT32                  NumberOfRequests)
+{
+    KD_PIPELINED_READ_MEMORY PipelinedReads = {0};
+
+    PipelinedReads.Requests     = Requests;
+    PipelinedReads.RequestSizes = RequestSizes;
+
+    if (!PipelineRun(&g_KdReadMemoryPipeline,
+                     NumberOfRequests,
+                     g_KdRequestWindowSize,
+                     KdPipelinedReadMemorySend,
+                     KdPipelinedReadMemoryWait,
+                     &PipelinedReads))
+    {
+        if (g_IsSerialConnectedToRemoteDebuggee)
+        {
+            ShowMessages("err, the debuggee didn't answer the read memory requests (%u of %u are received)\n",
+                         (UINT32)g_KdReadMemoryPipeline.NumberOfCompletedRequests,
+                         NumberOfRequests);
+        }
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Save the result of a pipelined read memory request
+ * @details Called by the listening thread, stale responses (e.g., of an
+ * aborted window or the duplicated responses of the resent requests) are ignored
+ *
+ * @param Result The response of the debuggee
+ *
+ * @return BOOLEAN whether the response belongs to a pipelined request or not
+ */
+BOOLEAN
+KdCompletePipelinedReadMemory(PDEBUGGER_READ_MEMORY Result)
+{
+    KD_PIPELINED_READ_MEMORY * PipelinedReads;
+    UINT32                     Index;
+
+    if (Result->RequestId == PIPELINE_REQUEST_ID_NOT_PIPELINED)
+    {
+        return FALSE;
+    }
+
+    if (PipelineMatchResponse(&g_KdReadMemoryPipeline, Result->RequestId, &Index))
+    {
+        PipelinedReads = (KD_PIPELINED_READ_MEMORY *)g_KdReadMemoryPipeline.Context;
+
+        memcpy(PipelinedReads->Requests[Index], Result, PipelinedReads->RequestSizes[Index]);
+
+        PipelineCompleteResponse(&g_KdReadMemoryPipeline);
+
+        //
+        // Wake up the sender to fill the window
+        //
+        DbgReceivedKernelResponse(DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_PIPELINED_READ_MEMORY);
+    }
+    else if (g_KdReadMemoryPipeline.IsLossDetected)
+    {
+        //
+        // Wake up the sender to send the lost requests again
+        //
+        DbgReceivedKernelResponse(DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_PIPELINED_READ_MEMORY);
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Send a request of streaming a range of memory to the debuggee
+ * @details The chunks of the range are handled by the listening thread
+ * and this function returns once the result (after the last chunk) is received
+ *
+ * @param DumpPacket
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+KdSendDumpMemoryPacketToDebuggee(PDEBUGGEE_DUMP_MEMORY_PACKET DumpPacket)
+{
+    //
+    // Set the request data
+    //
+    DbgWaitSetRequestData(DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_DUMP_MEMORY, DumpPacket, sizeof(DEBUGGEE_DUMP_MEMORY_PACKET));
+
+    //
+    // Send the dump memory packet
+    //
+    if (!KdCommandPacketAndBufferToDebuggee(
+            DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGER_TO_DEBUGGEE_EXECUTE_ON_VMX_ROOT,
+            DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_DUMP_MEMORY,
+            (CHAR *)DumpPacket,
+            sizeof(DEBUGGEE_DUMP_MEMORY_PACKET)))
+    {
+        return FALSE;
+    }
+
+    //
+    // Wait until the result of the dump is received
+    //
+    DbgWaitForKernelResponse(DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_DUMP_MEMORY);
+
+    return TRUE;
+}
+
 /**
  * @brief Send an Edit memory packet to the debuggee
  * @param EditMem
@@ -637,6 +885,11 @@ KdSendEditMemoryPacketToDebuggee(PDEBUGGER_EDIT_MEMORY EditMem, UINT32 Size)
     //
     DbgWaitSetRequestData(DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_EDIT_MEMORY, EditMem, sizeof(DEBUGGER_EDIT_MEMORY));
 
+    //
+    // The cached pages are no longer valid
+    //
+    KdMemoryCacheInvalidate();
+
     //
     // Send d command as read memory packet
     //
@@ -824,6 +1077,14 @@ KdSendSwitchProcessPacketToDebuggee(DEBUGGEE_DETAILS_AND_SWITCH_PROCESS_TYPE Act
         memcpy(&ProcessChangePacket.ProcessListSymDetails, SymDetailsForProcessList, sizeof(DEBUGGEE_PROCESS_LIST_NEEDED_DETAILS));
     }
 
+    //
+    // The virtual addresses are read from the layout of the new process
+    //
+    if (ActionType == DEBUGGEE_DETAILS_AND_SWITCH_PROCESS_PERFORM_SWITCH)
+    {
+        KdMemoryCacheInvalidate();
+    }
+
     //
     // Send '.process' as switch packet
     //
@@ -877,6 +1138,14 @@ KdSendSwitchThreadPacketToDebuggee(DEBUGGEE_DETAILS_AND_SWITCH_THREAD_TYPE Actio
         memcpy(&ThreadChangePacket.ThreadListSymDetails, SymDetailsForThreadList, sizeof(DEBUGGEE_THREAD_LIST_NEEDED_DETAILS));
     }
 
+    //
+    // The new thread might be in another process
+    //
+    if (ActionType == DEBUGGEE_DETAILS_AND_SWITCH_THREAD_PERFORM_SWITCH)
+    {
+        KdMemoryCacheInvalidate();
+    }
+
     //
     // Send '.thread' as switch packet
     //
@@ -935,6 +1204,11 @@ KdSendPtePacketToDebuggee(PDEBUGGER_READ_PAGE_TABLE_ENTRIES_DETAILS PtePacket)
 BOOLEAN
 KdSendPageinPacketToDebuggee(PDEBUGGER_PAGE_IN_REQUEST PageinPacket)
 {
+    //
+    // The debuggee continues to bring the pages in
+    //
+    KdMemoryCacheInvalidate();
+
     //
     // Send the '.pagein' packet
     //
@@ -1148,6 +1422,11 @@ KdSendScriptPacketToDebuggee(UINT64 BufferAddress, UINT32 BufferLength, UINT32 P
            (PVOID)BufferAddress,
            BufferLength);
 
+    //
+    // The script might modify the memory (e.g., by 'eb' or 'memcpy')
+    //
+    KdMemoryCacheInvalidate();
+
     //
     // Send script packet
     //
@@ -1328,6 +1607,11 @@ KdSendStepPacketToDebuggee(DEBUGGER_REMOTE_STEPPING_REQUEST StepRequestType)
         g_IsDebuggeeRunning = TRUE;
     }
 
+    //
+    // The memory might be changed once the instruction is executed
+    //
+    KdMemoryCacheInvalidate();
+
     //
     // Send step packet to the serial
     //
@@ -1441,6 +1725,66 @@ KdGetWindowVersion(CHAR * BufferToSave)
     return TRUE;
 }
 
+/**
+ * @brief Read bytes from the remote computer (used as the read routine of framing)
+ * @details The whole length is requested at once, the reads of the debuggee
+ * might return before all the bytes are available because of the timeouts
+ *
+ * @param Context The transport
+ * @param Buffer
+ * @param Length
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+KdFramingReadFromRemote(PVOID Context, VOID * Buffer, UINT32 Length)
+{
+    return TransportReceiveAll((TRANSPORT *)Context, Buffer, Length);
+}
+
+/**
+ * @brief Write bytes to the remote computer (used as the write routine of framing)
+ *
+ * @param Context Not used
+ * @param Buffer
+ * @param Length
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+KdFramingWriteToRemote(PVOID Context, const VOID * Buffer, UINT32 Length)
+{
+    UNREFERENCED_PARAMETER(Context);
+
+    return KdSendPacketToDebuggee((const CHAR *)Buffer, Length, FALSE);
+}
+
+/**
+ * @brief Switch to the framed (length-prefixed) packets
+ * @details Both of the debugger and the debuggee switch after the
+ * "Start" packet
+ *
+ * @return VOID
+ */
+VOID
+KdEnableFramedPackets()
+{
+    FramingInitialize(&g_KdFramingTransport,
+                      &g_KdTransport,
+                      KdFramingReadFromRemote,
+                      KdFramingWriteToRemote,
+                      g_KdFramingRetransmissionBuffer,
+                      sizeof(g_KdFramingRetransmissionBuffer));
+
+    //
+    // Commands send frames while the listening thread sends NAKs (and retransmits
+    // the last frame), so the writes are serialized
+    //
+    FramingSetSendLock(&g_KdFramingTransport, &g_KdFramingSendLock, SpinlockLock, SpinlockUnlock);
+
+    g_KdFramedPackets = TRUE;
+}
+
 /**
  * @brief Receive packet from the debuggee
  *
@@ -1453,50 +1797,58 @@ BOOLEAN
 KdReceivePacketFromDebuggee(CHAR *   BufferToSave,
                             UINT32 * LengthReceived)
 {
-    char   ReadData    = NULL; /* temperory Character */
-    DWORD  NoBytesRead = 0;    /* Bytes read by ReadFile() */
-    UINT32 Loop        = 0;
+    char           ReadData    = NULL; /* temperory Character */
+    UINT32         NoBytesRead = 0;    /* Bytes read by the transport */
+    UINT32         Loop        = 0;
+    FRAMING_STATUS FramingStatus;
 
     //
-    // Read data and store in a buffer
+    // In the framed protocol, the header is read and then the whole payload
     //
-    do
+    if (g_KdFramedPackets)
     {
         //
-        // It's in the debugger
+        // Corrupted frames are requested again (by a NAK) and frames that don't fit
+        // are skipped, so only return once a frame is received or the connection is
+        // closed, otherwise the caller treats the empty buffer as a closed connection
         //
-
-        //
-        // Try to read one byte in overlapped I/O (in debugger)
-        //
-        if (!ReadFile(g_SerialRemoteComPortHandle, &ReadData, sizeof(ReadData), NULL, &g_OverlappedIoStructureForReadDebugger))
+        do
         {
-            DWORD e = GetLastError();
+            FramingStatus = FramingReceive(&g_KdFramingTransport, BufferToSave, MaxSerialPacketSize, LengthReceived);
 
-            if (e != ERROR_IO_PENDING)
-            {
-                return FALSE;
-            }
+        } while (FramingStatus == FRAMING_STATUS_INVALID_CHECKSUM || FramingStatus == FRAMING_STATUS_BUFFER_TOO_SMALL);
+
+        if (FramingStatus == FRAMING_STATUS_CONNECTION_CLOSED)
+        {
+            //
+            // Indicate that the connection is closed
+            //
+            *LengthReceived = 0;
+            BufferToSave[0] = NULL;
         }
 
-        //
-        // Wait till one packet becomes available
-        //
-        WaitForSingleObject(g_OverlappedIoStructureForReadDebugger.hEvent,
-                            INFINITE);
+        return FramingStatus == FRAMING_STATUS_SUCCESS;
+    }
 
+    //
+    // Read data and store in a buffer
+    //
+    do
+    {
         //
-        // Get the result
+        // It's in the debugger, read one byte as the bytes after the end
+        // of the buffer belong to the next packet
         //
-        GetOverlappedResult(g_SerialRemoteComPortHandle,
-                            &g_OverlappedIoStructureForReadDebugger,
-                            &NoBytesRead,
-                            FALSE);
+        if (!TransportReceive(&g_KdTransport, &ReadData, sizeof(ReadData), &NoBytesRead))
+        {
+            //
+            // Indicate that the connection is closed
+            //
+            *LengthReceived = 0;
+            BufferToSave[0] = NULL;
 
-        //
-        // Reset event for next try
-        //
-        ResetEvent(g_OverlappedIoStructureForReadDebugger.hEvent);
+            return FALSE;
+        }
 
         //
         // We already now that the maximum packet size is MaxSerialPacketSize
@@ -1544,7 +1896,7 @@ KdReceivePacketFromDebugger(CHAR *   BufferToSave,
                             UINT32 * LengthReceived)
 {
     char   ReadData    = NULL; /* temperory Character */
-    DWORD  NoBytesRead = 0;    /* Bytes read by ReadFile() */
+    UINT32 NoBytesRead = 0;    /* Bytes read by the transport */
     UINT32 Loop        = 0;
 
     //
@@ -1553,16 +1905,17 @@ KdReceivePacketFromDebugger(CHAR *   BufferToSave,
     DWORD ReadTimeout = 5000;
 
     //
-    // Set the read timeout using SetCommTimeouts
+    // Set the read timeout using SetCommTimeouts (the debuggee is always
+    // connected to a serial port)
     //
     COMMTIMEOUTS Timeouts;
-    GetCommTimeouts(g_SerialRemoteComPortHandle, &Timeouts);
+    GetCommTimeouts(g_KdTransport.Handle, &Timeouts);
     Timeouts.ReadIntervalTimeout         = MAXDWORD;
     Timeouts.ReadTotalTimeoutConstant    = ReadTimeout;
     Timeouts.ReadTotalTimeoutMultiplier  = 0;
     Timeouts.WriteTotalTimeoutConstant   = 0;
     Timeouts.WriteTotalTimeoutMultiplier = 0;
-    SetCommTimeouts(g_SerialRemoteComPortHandle, &Timeouts);
+    SetCommTimeouts(g_KdTransport.Handle, &Timeouts);
 
     //
     // Read data and store in a buffer
@@ -1570,41 +1923,14 @@ KdReceivePacketFromDebugger(CHAR *   BufferToSave,
     do
     {
         //
-        // It's in the debuggee
-        //
-
-        //
-        // Try to read one byte in overlapped I/O (in debugger)
+        // It's in the debuggee, try to read one byte (returns no byte
+        // if the timeout is expired)
         //
-        if (!ReadFile(g_SerialRemoteComPortHandle, &ReadData, sizeof(ReadData), NULL, &g_OverlappedIoStructureForReadDebuggee))
+        if (!TransportReceive(&g_KdTransport, &ReadData, sizeof(ReadData), &NoBytesRead))
         {
-            DWORD e = GetLastError();
-
-            if (e != ERROR_IO_PENDING)
-            {
-                return FALSE;
-            }
+            return FALSE;
         }
 
-        //
-        // Wait till one packet becomes available
-        //
-        WaitForSingleObject(g_OverlappedIoStructureForReadDebuggee.hEvent,
-                            INFINITE);
-
-        //
-        // Get the result
-        //
-        GetOverlappedResult(g_SerialRemoteComPortHandle,
-                            &g_OverlappedIoStructureForReadDebuggee,
-                            &NoBytesRead,
-                            FALSE);
-
-        //
-        // Reset event for next try
-        //
-        ResetEvent(g_OverlappedIoStructureForReadDebuggee.hEvent);
-
         //
         // We already now that the maximum packet size is MaxSerialPacketSize
         // Check to make sure that we don't pass the boundaries
@@ -1648,10 +1974,6 @@ KdReceivePacketFromDebugger(CHAR *   BufferToSave,
 BOOLEAN
 KdSendPacketToDebuggee(const CHAR * Buffer, UINT32 Length, BOOLEAN SendEndOfBuffer)
 {
-    BOOL  Status;
-    DWORD BytesWritten  = 0;
-    DWORD LastErrorCode = 0;
-
     //
     // Start getting debuggee messages again
     //
@@ -1672,79 +1994,27 @@ KdSendPacketToDebuggee(const CHAR * Buffer, UINT32 Length, BOOLEAN SendEndOfBuff
     //
     // Check if the remote code's handle found or not
     //
-    if (g_SerialRemoteComPortHandle == NULL)
+    if (!TransportIsOpen(&g_KdTransport))
     {
         ShowMessages("err, handle to remote debuggee's com port is not found\n");
         return FALSE;
     }
 
-    if (g_IsSerialConnectedToRemoteDebugger || g_IsDebuggeeInHandshakingPhase)
+    //
+    // The debuggee writes synchronously and the debugger uses overlapped I/O
+    // (or a socket), so the listening thread could read at the same time
+    //
+    if (!TransportSend(&g_KdTransport, Buffer, Length))
     {
-        //
-        // It's for a debuggee
-        //
-        Status = WriteFile(g_SerialRemoteComPortHandle, // Handle to the Serialport
-                           Buffer,                      // Data to be written to the port
-                           Length,                      // No of bytes to write into the port
-                           &BytesWritten,               // No of bytes written to the port
-                           NULL);
-
-        if (Status == FALSE)
+        if (g_IsSerialConnectedToRemoteDebugger || g_IsDebuggeeInHandshakingPhase)
         {
             ShowMessages("err, fail to write to com port or named pipe (error %x).\n",
                          GetLastError());
-            return FALSE;
-        }
-
-        //
-        // Check if message delivered successfully
-        //
-        if (BytesWritten != Length)
-        {
-            return FALSE;
-        }
-    }
-    else
-    {
-        //
-        // It's a debugger
-        //
-
-        if (WriteFile(g_SerialRemoteComPortHandle, Buffer, Length, NULL, &g_OverlappedIoStructureForWriteDebugger))
-        {
-            //
-            // Write Completed
-            //
-            goto Out;
-        }
-
-        LastErrorCode = GetLastError();
-        if (LastErrorCode != ERROR_IO_PENDING)
-        {
-            //
-            // Error
-            //
-            // ShowMessages("err, on sending serial packets (%x)", LastErrorCode);
-            return FALSE;
-        }
-
-        //
-        // Wait until write completed
-        //
-        if (WaitForSingleObject(g_OverlappedIoStructureForWriteDebugger.hEvent,
-                                INFINITE) != WAIT_OBJECT_0)
-        {
-            // ShowMessages("err, on sending serial packets (signal error)");
-            return FALSE;
         }
 
-        //
-        // Reset event
-        //
-        ResetEvent(g_OverlappedIoStructureForWriteDebugger.hEvent);
+        return FALSE;
     }
 
-Out:
     if (SendEndOfBuffer)
     {
         //
@@ -1764,6 +2034,29 @@ Out:
     return TRUE;
 }
 
+/**
+ * @brief Sends a packet and a buffer as one frame to the remote computer
+ *
+ * @param Packet
+ * @param PacketLength
+ * @param Buffer
+ * @param BufferLength
+ * @return BOOLEAN
+ */
+BOOLEAN
+KdSendFrameToDebuggee(const CHAR * Packet, UINT32 PacketLength, const CHAR * Buffer, UINT32 BufferLength)
+{
+    const VOID * Buffers[2] = {Packet, Buffer};
+    UINT32       Lengths[2] = {PacketLength, BufferLength};
+
+    //
+    // Start getting debuggee messages again
+    //
+    g_IgnoreNewLoggingMessages = FALSE;
+
+    return FramingSendBuffers(&g_KdFramingTransport, Buffers, Lengths, 2);
+}
+
 /**
  * @brief Sends a HyperDbg packet to the debuggee
  *
@@ -1800,6 +2093,11 @@ KdCommandPacketToDebuggee(
         KdComputeDataChecksum((PVOID)((UINT64)&Packet + 1),
                               sizeof(DEBUGGER_REMOTE_PACKET) - sizeof(BYTE));
 
+    if (g_KdFramedPackets)
+    {
+        return KdSendFrameToDebuggee((const CHAR *)&Packet, sizeof(DEBUGGER_REMOTE_PACKET), NULL, 0);
+    }
+
     if (!KdSendPacketToDebuggee((const CHAR *)&Packet,
                                 sizeof(DEBUGGER_REMOTE_PACKET),
                                 TRUE))
@@ -1860,6 +2158,11 @@ KdCommandPacketAndBufferToDebuggee(
 
     Packet.Checksum += KdComputeDataChecksum((PVOID)Buffer, BufferLength);
 
+    if (g_KdFramedPackets)
+    {
+        return KdSendFrameToDebuggee((const CHAR *)&Packet, sizeof(DEBUGGER_REMOTE_PACKET), Buffer, BufferLength);
+    }
+
     //
     // Send the first buffer (without ending buffer indication)
     //
@@ -1965,25 +2268,48 @@ KdBreakControlCheckAndContinueDebugger()
 
 /**
  * @brief Respond to the debuggee with the version and build date of the debugger
+ * @details The capabilities of the debugger come after the build signature,
+ * and then the number of the bytes at RIP and the qwords at RSP that are
+ * sent along with the pause packet
  *
  * @return BOOLEAN
  */
 BOOLEAN
 KdSendResponseOfThePingPacket()
 {
+    CHAR   Response[sizeof(BuildSignature) + sizeof(UINT32) * 3] = {0};
+    UINT32 Capabilities                                          = 0;
+
     //
     // For logging purposes
     //
     // ShowMessages("the ping request is received\n");
 
+    if (g_CompressRemoteLogs)
+    {
+        Capabilities |= DEBUGGER_REMOTE_CAPABILITY_COMPRESSED_LOGGING;
+    }
+
+    Capabilities |= DEBUGGER_REMOTE_CAPABILITY_FRAMED_PACKETS;
+
+    if (g_KdSendBreakContext)
+    {
+        Capabilities |= DEBUGGER_REMOTE_CAPABILITY_BREAK_CONTEXT;
+    }
+
+    memcpy(Response, BuildSignature, sizeof(BuildSignature));
+    memcpy(Response + sizeof(BuildSignature), &Capabilities, sizeof(UINT32));
+    memcpy(Response + sizeof(BuildSignature) + sizeof(UINT32), &g_KdBreakContextCodeBytes, sizeof(UINT32));
+    memcpy(Response + sizeof(BuildSignature) + sizeof(UINT32) * 2, &g_KdBreakContextStackQwords, sizeof(UINT32));
+
     //
     // Send the handshake packet to debuggee
     //
     if (!KdCommandPacketAndBufferToDebuggee(
             DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGER_TO_DEBUGGEE_EXECUTE_ON_USER_MODE,
             DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_USER_MODE_DEBUGGER_VERSION,
-            (CHAR *)BuildSignature,
-            sizeof(BuildSignature)))
+            Response,
+            sizeof(Response)))
     {
         ShowMessages("err, unable to send response to the ping packet\n");
         return FALSE;
@@ -2014,56 +2340,33 @@ KdTheRemoteSystemIsRunning()
 
 /**
  * @brief Prepare serial to connect to the remote server
- * @details wait to connect to debuggee (this is debugger)
+ * @details wait to connect to debuggee (this is debugger), the transport
+ * should be already opened
  *
- * @param SerialHandle
  * @param IsNamedPipe
  * @param PauseAfterConnection
  *
  * @return BOOLEAN
  */
 BOOLEAN
-KdPrepareSerialConnectionToRemoteSystem(HANDLE  SerialHandle,
-                                        BOOLEAN IsNamedPipe,
+KdPrepareSerialConnectionToRemoteSystem(BOOLEAN IsNamedPipe,
                                         BOOLEAN PauseAfterConnection)
 {
-    BOOL  Status;        /* Status */
-    DWORD EventMask = 0; /* Event mask to trigger */
-
     //
     // Show an indication to connect the debugger
     //
     ShowMessages("waiting for debuggee to connect...\n");
 
-    if (!IsNamedPipe)
-    {
-        //
-        // Setting Receive Mask
-        //
-        Status = SetCommMask(SerialHandle, EV_RXCHAR);
-        if (Status == FALSE)
-        {
-            //
-            // Can be ignored
-            //
-            // ShowMessages("err, in setting CommMask\n");
-            // return FALSE;
-        }
-
-        //
-        // Setting WaitComm() Event
-        //
-        Status = WaitCommEvent(SerialHandle, &EventMask, NULL); /* Wait for the character to be received */
+    //
+    // Wait for the first bytes of the debuggee
+    //
+    TransportPoll(&g_KdTransport, TRANSPORT_WAIT_INFINITE);
 
-        if (Status == FALSE)
-        {
-            //
-            // Can be ignored
-            //
-            // ShowMessages("err, in setting WaitCommEvent\n");
-            // return FALSE;
-        }
-    }
+    //
+    // No read memory request is outstanding and nothing is cached
+    //
+    PipelineInitialize(&g_KdReadMemoryPipeline);
+    KdMemoryCacheInvalidate();
 
     //
     // Initialize the handle table
@@ -2122,11 +2425,6 @@ KdPrepareSerialConnectionToRemoteSystem(HANDLE  SerialHandle,
         //
         g_IsDebuggeeRunning = TRUE;
 
-        //
-        // Save the handler
-        //
-        g_SerialRemoteComPortHandle = SerialHandle;
-
         //
         // Is serial handle for a named pipe
         //
@@ -2178,6 +2476,7 @@ KdCheckIfDebuggerIsListening(HANDLE ComPortHandle)
     CHAR *                  ReceivedPingBuildVersionBuffer       = NULL;
     PDEBUGGER_REMOTE_PACKET TheActualPacket                      = NULL;
     UINT32                  LengthReceived                       = 0;
+    UINT32                  Capabilities                         = 0;
     BOOLEAN                 Result                               = FALSE;
 
     //
@@ -2274,6 +2573,30 @@ StartAgain:
                 // Build version matched
                 //
                 Result = TRUE;
+
+                //
+                // Check the capabilities of the debugger
+                //
+                if (LengthReceived >= sizeof(DEBUGGER_REMOTE_PACKET) + sizeof(BuildSignature) + sizeof(UINT32))
+                {
+                    memcpy(&Capabilities, ReceivedPingBuildVersionBuffer + sizeof(BuildSignature), sizeof(UINT32));
+                }
+
+                g_DebuggerAcceptsCompressedLogs = (Capabilities & DEBUGGER_REMOTE_CAPABILITY_COMPRESSED_LOGGING) != 0;
+                g_DebuggerAcceptsFramedPackets  = (Capabilities & DEBUGGER_REMOTE_CAPABILITY_FRAMED_PACKETS) != 0;
+                g_DebuggerAcceptsBreakContext   = FALSE;
+
+                //
+                // The sizes of the context of the core come after the capabilities
+                //
+                if ((Capabilities & DEBUGGER_REMOTE_CAPABILITY_BREAK_CONTEXT) &&
+                    LengthReceived >= sizeof(DEBUGGER_REMOTE_PACKET) + sizeof(BuildSignature) + sizeof(UINT32) * 3)
+                {
+                    memcpy(&g_DebuggerBreakContextCodeBytes, ReceivedPingBuildVersionBuffer + sizeof(BuildSignature) + sizeof(UINT32), sizeof(UINT32));
+                    memcpy(&g_DebuggerBreakContextStackQwords, ReceivedPingBuildVersionBuffer + sizeof(BuildSignature) + sizeof(UINT32) * 2, sizeof(UINT32));
+
+                    g_DebuggerAcceptsBreakContext = TRUE;
+                }
             }
             else
             {
@@ -2374,12 +2697,6 @@ KdPrepareAndConnectDebugPort(const CHAR * PortName,
                               OPEN_EXISTING,                // Open existing port only
                               0,                            // Non Overlapped I/O
                               NULL);                        // Null for Comm Devices
-
-            //
-            // Create event for overlapped I/O (Read)
-            //
-            g_OverlappedIoStructureForReadDebuggee.hEvent =
-                CreateEvent(NULL, TRUE, FALSE, NULL);
         }
         else
         {
@@ -2498,17 +2815,16 @@ KdPrepareAndConnectDebugPort(const CHAR * PortName,
         g_IsDebuggeeInHandshakingPhase = TRUE;
 
         //
-        // Set handle to serial device
+        // Set handle to serial device (synchronous I/O)
         //
-        g_SerialRemoteComPortHandle = Comm;
+        TransportInitializeHandle(&g_KdTransport, Comm, TRANSPORT_TYPE_SERIAL, NULL, NULL);
 
         //
         // Check if debuggee is listening before loading module
         //
         if (!KdCheckIfDebuggerIsListening(Comm))
         {
-            CloseHandle(Comm);
-            g_SerialRemoteComPortHandle    = NULL;
+            TransportClose(&g_KdTransport);
             g_IsDebuggeeInHandshakingPhase = FALSE;
 
             return FALSE;
@@ -2532,8 +2848,7 @@ KdPrepareAndConnectDebugPort(const CHAR * PortName,
         //
         if (HyperDbgInstallVmmDriver() == 1 || HyperDbgLoadVmmModule() == 1)
         {
-            CloseHandle(Comm);
-            g_SerialRemoteComPortHandle    = NULL;
+            TransportClose(&g_KdTransport);
             g_IsConnectedToHyperDbgLocally = FALSE;
 
             ShowMessages("failed to install or load the driver\n");
@@ -2546,8 +2861,7 @@ KdPrepareAndConnectDebugPort(const CHAR * PortName,
         //
         if (!g_DeviceHandle)
         {
-            CloseHandle(Comm);
-            g_SerialRemoteComPortHandle    = NULL;
+            TransportClose(&g_KdTransport);
             g_IsConnectedToHyperDbgLocally = FALSE;
 
             AssertShowMessageReturnStmt(g_DeviceHandle, ASSERT_MESSAGE_DRIVER_NOT_LOADED, AssertReturnFalse);
@@ -2561,8 +2875,7 @@ KdPrepareAndConnectDebugPort(const CHAR * PortName,
 
         if (DebuggeeRequest == NULL)
         {
-            CloseHandle(Comm);
-            g_SerialRemoteComPortHandle    = NULL;
+            TransportClose(&g_KdTransport);
             g_IsConnectedToHyperDbgLocally = FALSE;
 
             ShowMessages("err, unable to allocate memory for request packet");
@@ -2574,8 +2887,14 @@ KdPrepareAndConnectDebugPort(const CHAR * PortName,
         //
         // Prepare the details structure
         //
-        DebuggeeRequest->PortAddress = Port;
-        DebuggeeRequest->Baudrate    = Baudrate;
+        DebuggeeRequest->PortAddress      = Port;
+        DebuggeeRequest->Baudrate         = Baudrate;
+        DebuggeeRequest->CompressLogs     = g_DebuggerAcceptsCompressedLogs;
+        DebuggeeRequest->UseFramedPackets = g_DebuggerAcceptsFramedPackets;
+
+        DebuggeeRequest->SendBreakContext        = g_DebuggerAcceptsBreakContext;
+        DebuggeeRequest->BreakContextCodeBytes   = g_DebuggerBreakContextCodeBytes;
+        DebuggeeRequest->BreakContextStackQwords = g_DebuggerBreakContextStackQwords;
 
         //
         // Get base address of ntoskrnl
@@ -2611,8 +2930,7 @@ KdPrepareAndConnectDebugPort(const CHAR * PortName,
 
         if (!StatusIoctl)
         {
-            CloseHandle(Comm);
-            g_SerialRemoteComPortHandle    = NULL;
+            TransportClose(&g_KdTransport);
             g_IsConnectedToHyperDbgLocally = FALSE;
 
             ShowMessages("ioctl failed with code 0x%x\n", GetLastError());
@@ -2627,6 +2945,14 @@ KdPrepareAndConnectDebugPort(const CHAR * PortName,
 
         if (DebuggeeRequest->Result == DEBUGGER_OPERATION_WAS_SUCCESSFUL)
         {
+            //
+            // The "Start" packet is sent, the next packets are framed
+            //
+            if (DebuggeeRequest->UseFramedPackets)
+            {
+                KdEnableFramedPackets();
+            }
+
             //
             // Ignore handling CTRL+C breaks
             //
@@ -2644,8 +2970,7 @@ KdPrepareAndConnectDebugPort(const CHAR * PortName,
         }
         else
         {
-            CloseHandle(Comm);
-            g_SerialRemoteComPortHandle    = NULL;
+            TransportClose(&g_KdTransport);
             g_IsConnectedToHyperDbgLocally = FALSE;
 
             ShowErrorMessage(DebuggeeRequest->Result);
@@ -2732,15 +3057,19 @@ KdPrepareAndConnectDebugPort(const CHAR * PortName,
     else
     {
         //
-        // Save the handler
+        // Save the handler (overlapped I/O)
         //
-        g_SerialRemoteComPortHandle = Comm;
+        TransportInitializeHandle(&g_KdTransport,
+                                  Comm,
+                                  IsNamedPipe ? TRANSPORT_TYPE_NAMED_PIPE : TRANSPORT_TYPE_SERIAL,
+                                  &g_OverlappedIoStructureForReadDebugger,
+                                  &g_OverlappedIoStructureForWriteDebugger);
 
         //
         // If we are here, then it's a debugger (not debuggee)
         // let's prepare the debuggee
         //
-        KdPrepareSerialConnectionToRemoteSystem(Comm, IsNamedPipe, PauseAfterConnection);
+        KdPrepareSerialConnectionToRemoteSystem(IsNamedPipe, PauseAfterConnection);
     }
 
     //
@@ -2749,6 +3078,47 @@ KdPrepareAndConnectDebugPort(const CHAR * PortName,
     return TRUE;
 }
 
+/**
+ * @brief Connect to the debuggee over TCP (this is debugger)
+ * @details E.g., the serial port of a virtual machine that is exposed over
+ * TCP by the hypervisor, or a simulated debuggee
+ *
+ * @param Host
+ * @param Port
+ * @param PauseAfterConnection
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+KdPrepareAndConnectDebugSocket(const CHAR * Host,
+                               const CHAR * Port,
+                               BOOLEAN      PauseAfterConnection)
+{
+    //
+    // Check if the debugger or debuggee is already active
+    //
+    if (IsConnectedToAnyInstanceOfDebuggerOrDebuggee())
+    {
+        return FALSE;
+    }
+
+    if (!TransportConnectSocket(&g_KdTransport, Host, Port))
+    {
+        ShowMessages("err, unable to connect to %s:%s\n", Host, Port);
+        return FALSE;
+    }
+
+    //
+    // Discard the bytes that are buffered before the connection
+    //
+    TransportFlush(&g_KdTransport);
+
+    //
+    // The socket is used the same as a named pipe, let's prepare the debuggee
+    //
+    return KdPrepareSerialConnectionToRemoteSystem(FALSE, PauseAfterConnection);
+}
+
 /**
  * @brief Send general buffer from debuggee to debugger
  * @param RequestedAction
@@ -3264,54 +3634,30 @@ KdSendUsermodePrints(CHAR * Input, UINT32 Length)
 }
 
 /**
- * @brief Send each packet of debugging information (PDB) to the debugger
- * @param SymbolDetailPacket
- * @param CurrentSymbolInfoIndex
- * @param TotalSymbols
+ * @brief Send a batch of debugging information (PDB) details of the modules
+ * to the debugger
+ * @param Batch The batch (with the entries and the strings)
+ * @param Length Length of the batch
  *
- * @return VOID
+ * @return BOOLEAN
  */
-VOID
-KdSendSymbolDetailPacket(PMODULE_SYMBOL_DETAIL SymbolDetailPacket, UINT32 CurrentSymbolInfoIndex, UINT32 TotalSymbols)
+BOOLEAN
+KdSendSymbolDetailBatchPacket(PDEBUGGER_UPDATE_SYMBOL_TABLE_BATCH Batch, UINT32 Length)
 {
-    BOOLEAN                       Result;
-    PDEBUGGER_UPDATE_SYMBOL_TABLE UsermodeSymDetailRequest;
-
-    UsermodeSymDetailRequest =
-        (DEBUGGER_UPDATE_SYMBOL_TABLE *)malloc(sizeof(DEBUGGER_UPDATE_SYMBOL_TABLE));
-
-    RtlZeroMemory(UsermodeSymDetailRequest, sizeof(DEBUGGER_UPDATE_SYMBOL_TABLE));
-
-    //
-    // Set other parameters for the symbol details
-    //
-    UsermodeSymDetailRequest->CurrentSymbolIndex = CurrentSymbolInfoIndex;
-    UsermodeSymDetailRequest->TotalSymbols       = TotalSymbols;
-
-    //
-    // Move the user message buffer at the bottom of the structure packet
-    //
-    memcpy((PVOID)((UINT64)&UsermodeSymDetailRequest->SymbolDetailPacket),
-           (PVOID)SymbolDetailPacket,
-           sizeof(MODULE_SYMBOL_DETAIL));
-
     //
     // Send the symbol update buffer to the debugger
     //
-    Result = KdSendGeneralBuffersFromDebuggeeToDebugger(
-        DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_UPDATE_SYMBOL_INFO,
-        UsermodeSymDetailRequest,
-        sizeof(DEBUGGER_UPDATE_SYMBOL_TABLE),
-        FALSE);
-
-    if (!Result)
+    if (!KdSendGeneralBuffersFromDebuggeeToDebugger(
+            DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_UPDATE_SYMBOL_INFO_BATCH,
+            Batch,
+            Length,
+            FALSE))
     {
         ShowMessages("err, sending symbol packets failed in debuggee");
-        free(UsermodeSymDetailRequest);
-        return;
+        return FALSE;
     }
 
-    free(UsermodeSymDetailRequest);
+    return TRUE;
 }
 
 /**
@@ -3338,11 +3684,6 @@ KdUninitializeConnection()
         CloseHandle(g_OverlappedIoStructureForReadDebugger.hEvent);
     }
 
-    if (g_OverlappedIoStructureForReadDebuggee.hEvent != NULL)
-    {
-        CloseHandle(g_OverlappedIoStructureForReadDebuggee.hEvent);
-    }
-
     if (g_OverlappedIoStructureForWriteDebugger.hEvent != NULL)
     {
         CloseHandle(g_OverlappedIoStructureForWriteDebugger.hEvent);
@@ -3414,13 +3755,9 @@ KdUninitializeConnection()
     g_ShouldPreviousCommandBeContinued = FALSE;
 
     //
-    // Clear the handler
+    // Close the transport
     //
-    if (g_SerialRemoteComPortHandle != NULL)
-    {
-        CloseHandle(g_SerialRemoteComPortHandle);
-        g_SerialRemoteComPortHandle = NULL;
-    }
+    TransportClose(&g_KdTransport);
 
     //
     // Start getting debuggee messages on next try
@@ -3431,6 +3768,11 @@ KdUninitializeConnection()
     // Is serial handle for a named pipe
     //
     g_IsDebuggerConntectedToNamedPipe = FALSE;
+
+    //
+    // The next connection starts without framing
+    //
+    g_KdFramedPackets = FALSE;
 }
 
 /**
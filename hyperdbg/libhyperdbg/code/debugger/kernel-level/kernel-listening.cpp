@@ -20,7 +20,7 @@ extern DEBUGGER_SYNCRONIZATION_EVENTS_STATE
 extern BYTE                             g_CurrentRunningInstruction[MAXIMUM_INSTR_SIZE];
 extern OVERLAPPED                       g_OverlappedIoStructureForReadDebugger;
 extern OVERLAPPED                       g_OverlappedIoStructureForWriteDebugger;
-extern HANDLE                           g_SerialRemoteComPortHandle;
+extern TRANSPORT                        g_KdTransport;
 extern BOOLEAN                          g_IsSerialConnectedToRemoteDebuggee;
 extern BOOLEAN                          g_IsDebuggeeRunning;
 extern BOOLEAN                          g_IgnoreNewLoggingMessages;
@@ -33,6 +33,112 @@ extern DEBUGGER_EVENT_AND_ACTION_RESULT g_DebuggeeResultOfAddingActionsToEvent;
 extern UINT64                           g_ResultOfEvaluatedExpression;
 extern UINT32                           g_ErrorStateOfResultOfEvaluatedExpression;
 extern UINT64                           g_KernelBaseAddress;
+extern COMPRESSION_STREAM *             g_RemoteLogsDecompressionStream;
+extern BOOLEAN                          g_KdFramedPackets;
+extern FRAMING_TRANSPORT                g_KdFramingTransport;
+
+/**
+ * @brief Decompress and show a compressed message of the debuggee
+ *
+ * @param CompressedPacket The compressed message
+ * @param PacketLength Length of the compressed message (including its header)
+ *
+ * @return VOID
+ */
+static VOID
+ListeningSerialHandleCompressedMessage(PDEBUGGEE_COMPRESSED_MESSAGE_PACKET CompressedPacket, UINT32 PacketLength)
+{
+    CHAR    Message[PacketChunkSize + 1] = {0};
+    UINT8 * Block                        = (UINT8 *)CompressedPacket + sizeof(DEBUGGEE_COMPRESSED_MESSAGE_PACKET);
+    BOOLEAN Result;
+
+    if (PacketLength < sizeof(DEBUGGEE_COMPRESSED_MESSAGE_PACKET) ||
+        CompressedPacket->CompressedLength != PacketLength - sizeof(DEBUGGEE_COMPRESSED_MESSAGE_PACKET) ||
+        CompressedPacket->UncompressedLength > PacketChunkSize ||
+        CompressedPacket->CompressedLength > CompressedPacket->UncompressedLength)
+    {
+        ShowMessages("\nerr, invalid compressed message is received\n");
+        return;
+    }
+
+    if (g_RemoteLogsDecompressionStream == NULL)
+    {
+        g_RemoteLogsDecompressionStream = (COMPRESSION_STREAM *)malloc(sizeof(COMPRESSION_STREAM));
+
+        if (g_RemoteLogsDecompressionStream == NULL)
+        {
+            ShowMessages("err, unable to allocate memory for decompressing messages\n");
+            return;
+        }
+
+        CompressionResetStream(g_RemoteLogsDecompressionStream);
+    }
+
+    //
+    // The debuggee resets the stream periodically
+    //
+    if (CompressedPacket->StreamOffset == 0)
+    {
+        CompressionResetStream(g_RemoteLogsDecompressionStream);
+    }
+
+    if (CompressedPacket->StreamOffset != g_RemoteLogsDecompressionStream->StreamOffset)
+    {
+        //
+        // A previous message is lost, the next messages can't be decompressed
+        // until the stream is reset (the error is only shown once)
+        //
+        if (g_RemoteLogsDecompressionStream->StreamOffset != MAXUINT64)
+        {
+            ShowMessages("\nerr, compressed messages of the debuggee are lost\n");
+            g_RemoteLogsDecompressionStream->StreamOffset = MAXUINT64;
+        }
+
+        return;
+    }
+
+    if (CompressedPacket->CompressedLength == CompressedPacket->UncompressedLength)
+    {
+        //
+        // The message is stored without compression
+        //
+        memcpy(Message, Block, CompressedPacket->UncompressedLength);
+
+        Result = CompressionStoreBlock(g_RemoteLogsDecompressionStream, Block, CompressedPacket->UncompressedLength);
+    }
+    else
+    {
+        Result = CompressionDecompress(g_RemoteLogsDecompressionStream,
+                                       Block,
+                                       CompressedPacket->CompressedLength,
+                                       Message,
+                                       CompressedPacket->UncompressedLength);
+    }
+
+    if (!Result)
+    {
+        ShowMessages("\nerr, unable to decompress the message of the debuggee\n");
+        g_RemoteLogsDecompressionStream->StreamOffset = MAXUINT64;
+        return;
+    }
+
+    //
+    // Check if there are available output sources
+    //
+    if (!g_OutputSourcesInitialized || !ForwardingCheckAndPerformEventForwarding(CompressedPacket->OperationCode,
+                                                                                 Message,
+                                                                                 (UINT32)strlen(Message)))
+    {
+        //
+        // We check g_IgnoreNewLoggingMessages here because we want to
+        // avoid messages when the debuggee is halted
+        //
+        if (!g_IgnoreNewLoggingMessages)
+        {
+            ShowMessages("%s", Message);
+        }
+    }
+}
 
 /**
  * @brief Check if the remote debuggee needs to pause the system
@@ -66,6 +172,7 @@ ListeningSerialPortInDebugger()
     PDEBUGGER_APIC_REQUEST                       ApicRequestPacket;
     PDEBUGGER_READ_MEMORY                        ReadMemoryPacket;
     PDEBUGGER_EDIT_MEMORY                        EditMemoryPacket;
+    PDEBUGGEE_DUMP_MEMORY_PACKET                 DumpMemoryPacket;
     PDEBUGGEE_BP_PACKET                          BpPacket;
     PDEBUGGER_SHORT_CIRCUITING_EVENT             ShortCircuitingPacket;
     PDEBUGGER_READ_PAGE_TABLE_ENTRIES_DETAILS    PtePacket;
@@ -186,6 +293,16 @@ StartAgain:
 
             ShowMessages("connected to debuggee %s\n", InitPacket->OsName);
 
+            //
+            // The debuggee sends the next packets as frames (the debugger
+            // always supports the framed packets)
+            //
+            if (LengthReceived >= sizeof(DEBUGGER_REMOTE_PACKET) + SIZEOF_DEBUGGER_PREPARE_DEBUGGEE &&
+                InitPacket->UseFramedPackets)
+            {
+                KdEnableFramedPackets();
+            }
+
             //
             // Signal the event that the debugger started
             //
@@ -216,6 +333,14 @@ StartAgain:
 
             break;
 
+        case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_COMPRESSED_LOGGING_MECHANISM:
+
+            ListeningSerialHandleCompressedMessage(
+                (DEBUGGEE_COMPRESSED_MESSAGE_PACKET *)(((CHAR *)TheActualPacket) + sizeof(DEBUGGER_REMOTE_PACKET)),
+                LengthReceived - sizeof(DEBUGGER_REMOTE_PACKET));
+
+            break;
+
         case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_PAUSED_AND_CURRENT_INSTRUCTION:
 
             //
@@ -230,6 +355,21 @@ StartAgain:
             //
             g_IsDebuggeeRunning = FALSE;
 
+            //
+            // The pages that are cached before running the debuggee are not valid
+            //
+            KdMemoryCacheInvalidate();
+
+            //
+            // The context of the core (registers, the bytes at RIP and RSP) might
+            // come after the pause packet
+            //
+            if (LengthReceived > sizeof(DEBUGGER_REMOTE_PACKET) + sizeof(DEBUGGEE_KD_PAUSED_PACKET))
+            {
+                KdMemoryCacheSaveBreakContext((DEBUGGEE_KD_BREAK_CONTEXT *)(((CHAR *)PausePacket) + sizeof(DEBUGGEE_KD_PAUSED_PACKET)),
+                                              LengthReceived - sizeof(DEBUGGER_REMOTE_PACKET) - sizeof(DEBUGGEE_KD_PAUSED_PACKET));
+            }
+
             //
             // Set the current core
             //
@@ -502,6 +642,12 @@ StartAgain:
                 {
                     ShowMessages("not found\n");
                 }
+                else if (SearchResultsPacket->CountOfResults > MaximumSearchResults)
+                {
+                    ShowMessages("only the first %d results (of %d) are shown\n",
+                                 MaximumSearchResults,
+                                 SearchResultsPacket->CountOfResults);
+                }
             }
             else
             {
@@ -750,6 +896,16 @@ StartAgain:
                 //
                 g_SharedEventStatus = EventModifyAndQueryPacket->IsEnabled;
             }
+            else if (EventModifyAndQueryPacket->TypeOfAction == DEBUGGER_MODIFY_EVENTS_ADD_TO_GROUP ||
+                     EventModifyAndQueryPacket->TypeOfAction == DEBUGGER_MODIFY_EVENTS_REMOVE_FROM_GROUP ||
+                     EventModifyAndQueryPacket->TypeOfAction == DEBUGGER_MODIFY_EVENTS_ENABLE_GROUP ||
+                     EventModifyAndQueryPacket->TypeOfAction == DEBUGGER_MODIFY_EVENTS_DISABLE_GROUP)
+            {
+                //
+                // The groups are updated by the caller (the modification was successful)
+                //
+                g_SharedEventStatus = TRUE;
+            }
             else
             {
                 CommandEventsHandleModifiedEvent(EventModifyAndQueryPacket->Tag,
@@ -881,6 +1037,14 @@ StartAgain:
 
             ReadMemoryPacket = (DEBUGGER_READ_MEMORY *)(((CHAR *)TheActualPacket) + sizeof(DEBUGGER_REMOTE_PACKET));
 
+            //
+            // Check if it's the response of a pipelined request
+            //
+            if (KdCompletePipelinedReadMemory(ReadMemoryPacket))
+            {
+                break;
+            }
+
             //
             // Get the address and size of the caller
             //
@@ -898,6 +1062,38 @@ StartAgain:
 
             break;
 
+        case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_DUMP_MEMORY_CHUNK:
+
+            //
+            // Decode the chunk and queue its pages to be written into the dump file
+            //
+            CommandDumpHandleStreamedChunk(
+                (DEBUGGEE_DUMP_MEMORY_CHUNK_PACKET *)(((CHAR *)TheActualPacket) + sizeof(DEBUGGER_REMOTE_PACKET)),
+                LengthReceived - sizeof(DEBUGGER_REMOTE_PACKET));
+
+            break;
+
+        case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_DUMP_MEMORY:
+
+            DumpMemoryPacket = (DEBUGGEE_DUMP_MEMORY_PACKET *)(((CHAR *)TheActualPacket) + sizeof(DEBUGGER_REMOTE_PACKET));
+
+            //
+            // Get the address and size of the caller
+            //
+            DbgWaitGetRequestData(DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_DUMP_MEMORY, &CallerAddress, &CallerSize);
+
+            //
+            // Copy the result for the caller
+            //
+            memcpy(CallerAddress, DumpMemoryPacket, CallerSize);
+
+            //
+            // Signal the event relating to receiving result of the dump
+            //
+            DbgReceivedKernelResponse(DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_DUMP_MEMORY);
+
+            break;
+
         case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_EDITING_MEMORY:
 
             EditMemoryPacket = (DEBUGGER_EDIT_MEMORY *)(((CHAR *)TheActualPacket) + sizeof(DEBUGGER_REMOTE_PACKET));
@@ -1068,6 +1264,18 @@ StartAgain:
 
             break;
 
+        case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_UPDATE_SYMBOL_INFO_BATCH:
+
+            //
+            // Add the batch of symbol details to the symbol table (the symbols are
+            // loaded once the reload is finished)
+            //
+            SymbolUpdateSymbolTableFromBatch(
+                (DEBUGGER_UPDATE_SYMBOL_TABLE_BATCH *)(((CHAR *)TheActualPacket) + sizeof(DEBUGGER_REMOTE_PACKET)),
+                LengthReceived - sizeof(DEBUGGER_REMOTE_PACKET));
+
+            break;
+
         case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_PCITREE:
 
             PcitreePacket = (DEBUGGEE_PCITREE_REQUEST_RESPONSE_PACKET *)(((CHAR *)TheActualPacket) + sizeof(DEBUGGER_REMOTE_PACKET));
@@ -1377,38 +1585,38 @@ StartAgain:
     BOOL Status; /* Status */
     char SerialBuffer[MaxSerialPacketSize] = {
         0};                                         /* Buffer to send and receive data */
-    DWORD                   EventMask       = 0;    /* Event mask to trigger */
     char                    ReadData        = NULL; /* temperory Character */
-    DWORD                   NoBytesRead     = 0;    /* Bytes read by ReadFile() */
+    UINT32                  NoBytesRead     = 0;    /* Bytes read by the transport */
     UINT32                  Loop            = 0;
     PDEBUGGER_REMOTE_PACKET TheActualPacket = (PDEBUGGER_REMOTE_PACKET)SerialBuffer;
+    FRAMING_STATUS          FramingStatus;
 
     //
-    // Setting Receive Mask
+    // Wait for the character to be received
     //
-    Status = SetCommMask(g_SerialRemoteComPortHandle, EV_RXCHAR);
-    if (Status == FALSE)
-    {
-        // ShowMessages("warning, there is an error in setting CommMask\n");
-
-        //
-        // Sometimes, this error happens
-        //
-        // return FALSE;
-    }
+    TransportPoll(&g_KdTransport, TRANSPORT_WAIT_INFINITE);
 
     //
-    // Setting WaitComm() Event
+    // In the framed protocol, the header is read and then the whole payload
     //
-    Status = WaitCommEvent(g_SerialRemoteComPortHandle, &EventMask, NULL); /* Wait for the character to be received */
-
-    if (Status == FALSE)
+    if (g_KdFramedPackets)
     {
-        //
-        // Can be ignored
-        //
-        // ShowMessages("err, in setting WaitCommEvent\n");
-        // return FALSE;
+        FramingStatus = FramingReceive(&g_KdFramingTransport, SerialBuffer, MaxSerialPacketSize, &Loop);
+
+        if (FramingStatus == FRAMING_STATUS_INVALID_CHECKSUM)
+        {
+            //
+            // A NAK is sent, so the next frame is the retransmitted one
+            //
+            goto StartAgain;
+        }
+        else if (FramingStatus != FRAMING_STATUS_SUCCESS)
+        {
+            ShowMessages("err, invalid frame received in debuggee\n");
+            goto StartAgain;
+        }
+
+        goto PacketReceived;
     }
 
     //
@@ -1416,7 +1624,7 @@ StartAgain:
     //
     do
     {
-        Status = ReadFile(g_SerialRemoteComPortHandle, &ReadData, sizeof(ReadData), &NoBytesRead, NULL);
+        Status = TransportReceive(&g_KdTransport, &ReadData, sizeof(ReadData), &NoBytesRead);
 
         //
         // Check to make sure that we don't pass the boundaries
@@ -1454,6 +1662,8 @@ StartAgain:
         goto StartAgain;
     }
 
+PacketReceived:
+
     //
     // Get actual length of received data
     //
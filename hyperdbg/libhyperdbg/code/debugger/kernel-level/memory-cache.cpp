@@ -0,0 +1,482 @@
+/**
+ * @file memory-cache.cpp
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Cache of the memory of the halted debuggee
+ * @details While the debuggee is halted, commands like 'd*', 'u' and 'dt'
+ * read the same pages over and over, each of them costs a round-trip over
+ * the serial. The pages are read as a whole (plus a few next pages if the
+ * memory is accessed sequentially) and kept until the debuggee runs again
+ * or its memory or the current process is changed. The registers and the
+ * bytes around RIP and RSP that come with the pause packet are also kept
+ *
+ * @version 0.14
+ * @date 2025-06-26
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+//
+// Global Variables
+//
+extern std::map<KD_MEMORY_CACHE_KEY, KD_MEMORY_CACHE_PAGE> g_KdMemoryCache;
+extern volatile LONG                                        g_KdMemoryCacheLock;
+extern volatile LONG                                        g_KdMemoryCacheGeneration;
+extern LONG                                                 g_KdMemoryCacheValidGeneration;
+extern KD_MEMORY_CACHE_KEY                                  g_KdMemoryCacheNextSequentialPage;
+extern KD_MEMORY_CACHE_BREAK_CONTEXT                        g_KdMemoryCacheBreakContext;
+
+/**
+ * @brief Invalidate all of the cached pages
+ * @details Called once the debuggee continues, steps, its memory is
+ * edited or the current process, thread or core is changed. It only
+ * changes the generation, so it could be called from any thread and
+ * the pages are removed on the next read
+ *
+ * @return VOID
+ */
+VOID
+KdMemoryCacheInvalidate()
+{
+    InterlockedIncrement(&g_KdMemoryCacheGeneration);
+}
+
+/**
+ * @brief Save the context of the core that is received along with the pause packet
+ * @details Called after the cache is invalidated for the pause packet, so
+ * the context is valid until the next invalidation
+ *
+ * @param Context
+ * @param Length Length of the context and the bytes after it
+ *
+ * @return VOID
+ */
+VOID
+KdMemoryCacheSaveBreakContext(PDEBUGGEE_KD_BREAK_CONTEXT Context, UINT32 Length)
+{
+    BYTE * Bytes = (BYTE *)Context + sizeof(DEBUGGEE_KD_BREAK_CONTEXT);
+
+    SpinlockLock(&g_KdMemoryCacheLock);
+
+    g_KdMemoryCacheBreakContext.IsValid = FALSE;
+
+    if (Length >= sizeof(DEBUGGEE_KD_BREAK_CONTEXT) &&
+        (UINT64)Context->CodeLength + Context->StackLength <= Length - sizeof(DEBUGGEE_KD_BREAK_CONTEXT))
+    {
+        g_KdMemoryCacheBreakContext.Generation      = g_KdMemoryCacheGeneration;
+        g_KdMemoryCacheBreakContext.IsValid         = TRUE;
+        g_KdMemoryCacheBreakContext.HasRegisters    = TRUE;
+        g_KdMemoryCacheBreakContext.Regs            = Context->Regs;
+        g_KdMemoryCacheBreakContext.ExtraRegs       = Context->ExtraRegs;
+        g_KdMemoryCacheBreakContext.CodeAddress     = Context->CodeAddress;
+        g_KdMemoryCacheBreakContext.CodeAddressMode = (DEBUGGER_READ_MEMORY_ADDRESS_MODE)Context->CodeAddressMode;
+        g_KdMemoryCacheBreakContext.StackAddress    = Context->StackAddress;
+
+        g_KdMemoryCacheBreakContext.Code.assign(Bytes, Bytes + Context->CodeLength);
+        g_KdMemoryCacheBreakContext.Stack.assign(Bytes + Context->CodeLength, Bytes + Context->CodeLength + Context->StackLength);
+    }
+
+    SpinlockUnlock(&g_KdMemoryCacheLock);
+}
+
+/**
+ * @brief Check whether the context of the core is still valid or not
+ * @details The lock of the cached pages should be held
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+KdMemoryCacheIsBreakContextValid()
+{
+    return g_KdMemoryCacheBreakContext.IsValid &&
+           g_KdMemoryCacheBreakContext.Generation == g_KdMemoryCacheGeneration;
+}
+
+/**
+ * @brief Invalidate the registers of the context of the core
+ * @details Called once a register is changed (the memory is still valid)
+ *
+ * @return VOID
+ */
+VOID
+KdMemoryCacheInvalidateRegisters()
+{
+    SpinlockLock(&g_KdMemoryCacheLock);
+
+    g_KdMemoryCacheBreakContext.HasRegisters = FALSE;
+
+    SpinlockUnlock(&g_KdMemoryCacheLock);
+}
+
+/**
+ * @brief Read all registers from the context of the core
+ *
+ * @param GuestRegisters
+ * @param ExtraRegisters
+ *
+ * @return BOOLEAN FALSE if the registers should be read from the debuggee
+ */
+BOOLEAN
+KdMemoryCacheReadRegisters(GUEST_REGS * GuestRegisters, GUEST_EXTRA_REGISTERS * ExtraRegisters)
+{
+    BOOLEAN Result = FALSE;
+
+    SpinlockLock(&g_KdMemoryCacheLock);
+
+    if (KdMemoryCacheIsBreakContextValid() && g_KdMemoryCacheBreakContext.HasRegisters)
+    {
+        if (GuestRegisters != NULL)
+        {
+            memcpy(GuestRegisters, &g_KdMemoryCacheBreakContext.Regs, sizeof(GUEST_REGS));
+        }
+
+        if (ExtraRegisters != NULL)
+        {
+            memcpy(ExtraRegisters, &g_KdMemoryCacheBreakContext.ExtraRegs, sizeof(GUEST_EXTRA_REGISTERS));
+        }
+
+        Result = TRUE;
+    }
+
+    SpinlockUnlock(&g_KdMemoryCacheLock);
+
+    return Result;
+}
+
+/**
+ * @brief Read the memory from the bytes of the context of the core
+ * @details The lock of the cached pages should be held
+ *
+ * @param ReadMem
+ * @param Address Address of the bytes
+ * @param Bytes The bytes at RIP or RSP
+ *
+ * @return BOOLEAN FALSE if the request is not in the range of the bytes
+ */
+static BOOLEAN
+KdMemoryCacheReadBreakContext(PDEBUGGER_READ_MEMORY ReadMem, UINT64 Address, const std::vector<BYTE> & Bytes)
+{
+    UINT64 Offset;
+
+    if (ReadMem->Address < Address)
+    {
+        return FALSE;
+    }
+
+    Offset = ReadMem->Address - Address;
+
+    if (Offset > Bytes.size() || ReadMem->Size > Bytes.size() - Offset)
+    {
+        return FALSE;
+    }
+
+    memcpy((BYTE *)ReadMem + sizeof(DEBUGGER_READ_MEMORY), Bytes.data() + Offset, ReadMem->Size);
+
+    ReadMem->ReturnLength = ReadMem->Size;
+    ReadMem->KernelStatus = DEBUGGER_OPERATION_WAS_SUCCESSFUL;
+
+    return TRUE;
+}
+
+/**
+ * @brief Get the key of a page of the request
+ *
+ * @param ReadMem
+ * @param Page The address of the page
+ *
+ * @return KD_MEMORY_CACHE_KEY
+ */
+static KD_MEMORY_CACHE_KEY
+KdMemoryCacheGetKey(PDEBUGGER_READ_MEMORY ReadMem, UINT64 Page)
+{
+    return KD_MEMORY_CACHE_KEY(ReadMem->MemoryType, ReadMem->ReadingType, ReadMem->Pid, Page);
+}
+
+/**
+ * @brief Read the pages from the debuggee
+ * @details The pages are requested through the window of pipelined
+ * requests, the pages that couldn't be read have a non-successful
+ * kernel status
+ *
+ * @param ReadMem The original request
+ * @param Pages The address of pages
+ * @param Results The buffer of each page (a DEBUGGER_READ_MEMORY followed by the page)
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+KdMemoryCacheFillPages(PDEBUGGER_READ_MEMORY                ReadMem,
+                       const std::vector<UINT64> &          Pages,
+                       std::vector<PDEBUGGER_READ_MEMORY> & Results)
+{
+    std::vector<UINT32> ResultSizes;
+    UINT32              ResultSize = sizeof(DEBUGGER_READ_MEMORY) + PAGE_SIZE;
+
+    for (UINT64 Page : Pages)
+    {
+        PDEBUGGER_READ_MEMORY Result = (PDEBUGGER_READ_MEMORY)malloc(ResultSize);
+
+        if (Result == NULL)
+        {
+            return FALSE;
+        }
+
+        ZeroMemory(Result, ResultSize);
+
+        Result->Pid            = ReadMem->Pid;
+        Result->Address        = Page;
+        Result->Size           = PAGE_SIZE;
+        Result->MemoryType     = ReadMem->MemoryType;
+        Result->ReadingType    = ReadMem->ReadingType;
+        Result->GetAddressMode = ReadMem->GetAddressMode && Page == (ReadMem->Address & ~((UINT64)PAGE_SIZE - 1));
+
+        Results.push_back(Result);
+        ResultSizes.push_back(ResultSize);
+    }
+
+    return KdSendPipelinedReadMemoryPacketsToDebuggee(Results.data(), ResultSizes.data(), (UINT32)Results.size());
+}
+
+/**
+ * @brief Read memory of the debuggee through the cache
+ * @details Same as KdSendReadMemoryPacketToDebuggee, the result is saved
+ * in the header and the buffer after it
+ *
+ * @param ReadMem
+ * @param RequestSize
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+KdMemoryCacheReadMemory(PDEBUGGER_READ_MEMORY ReadMem, UINT32 RequestSize)
+{
+    BOOLEAN                            Result      = TRUE;
+    BOOLEAN                            SendRequest = FALSE;
+    UINT32                             CopiedSize  = 0;
+    UINT64                             FirstPage;
+    UINT64                             LastPage;
+    UINT64                             Page;
+    UINT64                             Offset;
+    UINT32                             CopySize;
+    UINT32                             NumberOfPages;
+    LONG                               Generation;
+    PKD_MEMORY_CACHE_PAGE              CachedPage;
+    std::vector<UINT64>                MissingPages;
+    std::vector<PDEBUGGER_READ_MEMORY> FilledPages;
+
+    //
+    // Large (or wrapped) requests are not cached
+    //
+    if (ReadMem->Size == 0 ||
+        ReadMem->Size > KD_MEMORY_CACHE_MAXIMUM_PAGES_PER_READ * PAGE_SIZE ||
+        ReadMem->Address + ReadMem->Size - 1 < ReadMem->Address)
+    {
+        return KdSendReadMemoryPacketToDebuggee(ReadMem, RequestSize);
+    }
+
+    FirstPage     = ReadMem->Address & ~((UINT64)PAGE_SIZE - 1);
+    LastPage      = (ReadMem->Address + ReadMem->Size - 1) & ~((UINT64)PAGE_SIZE - 1);
+    NumberOfPages = (UINT32)((LastPage - FirstPage) / PAGE_SIZE) + 1;
+
+    SpinlockLock(&g_KdMemoryCacheLock);
+
+    //
+    // Remove the pages that are read before the last invalidation
+    //
+    Generation = g_KdMemoryCacheGeneration;
+
+    if (Generation != g_KdMemoryCacheValidGeneration)
+    {
+        g_KdMemoryCache.clear();
+        g_KdMemoryCacheNextSequentialPage = KD_MEMORY_CACHE_KEY();
+        g_KdMemoryCacheValidGeneration    = Generation;
+    }
+
+    //
+    // The bytes around RIP and RSP might be received along with the pause
+    // packet (the address mode is only known for the bytes at RIP)
+    //
+    if (ReadMem->MemoryType == DEBUGGER_READ_VIRTUAL_ADDRESS && KdMemoryCacheIsBreakContextValid())
+    {
+        if (KdMemoryCacheReadBreakContext(ReadMem, g_KdMemoryCacheBreakContext.CodeAddress, g_KdMemoryCacheBreakContext.Code))
+        {
+            ReadMem->AddressMode = g_KdMemoryCacheBreakContext.CodeAddressMode;
+            goto Exit;
+        }
+
+        if (!ReadMem->GetAddressMode &&
+            KdMemoryCacheReadBreakContext(ReadMem, g_KdMemoryCacheBreakContext.StackAddress, g_KdMemoryCacheBreakContext.Stack))
+        {
+            goto Exit;
+        }
+    }
+
+    //
+    // Find the pages that are not cached, the address mode is
+    // only needed for the first page
+    //
+    for (UINT32 i = 0; i < NumberOfPages; i++)
+    {
+        Page          = FirstPage + (UINT64)i * PAGE_SIZE;
+        auto Iterator = g_KdMemoryCache.find(KdMemoryCacheGetKey(ReadMem, Page));
+
+        if (Iterator == g_KdMemoryCache.end() ||
+            (i == 0 && ReadMem->GetAddressMode && !Iterator->second.HasAddressMode))
+        {
+            MissingPages.push_back(Page);
+        }
+    }
+
+    if (!MissingPages.empty())
+    {
+        //
+        // Read ahead the next pages if the previous read ended at the
+        // first missing page
+        //
+        if (g_KdMemoryCacheNextSequentialPage == KdMemoryCacheGetKey(ReadMem, MissingPages.front()))
+        {
+            for (UINT32 i = 1; i <= KD_MEMORY_CACHE_READ_AHEAD_PAGES; i++)
+            {
+                Page = LastPage + (UINT64)i * PAGE_SIZE;
+
+                if (Page < LastPage)
+                {
+                    break;
+                }
+
+                if (g_KdMemoryCache.find(KdMemoryCacheGetKey(ReadMem, Page)) == g_KdMemoryCache.end())
+                {
+                    MissingPages.push_back(Page);
+                }
+            }
+        }
+
+        //
+        // Once the cache is full, only the pages of this request are kept
+        //
+        if (g_KdMemoryCache.size() + MissingPages.size() > KD_MEMORY_CACHE_MAXIMUM_PAGES)
+        {
+            for (auto Iterator = g_KdMemoryCache.begin(); Iterator != g_KdMemoryCache.end();)
+            {
+                if (Iterator->first >= KdMemoryCacheGetKey(ReadMem, FirstPage) &&
+                    Iterator->first <= KdMemoryCacheGetKey(ReadMem, LastPage))
+                {
+                    Iterator++;
+                }
+                else
+                {
+                    Iterator = g_KdMemoryCache.erase(Iterator);
+                }
+            }
+        }
+
+        //
+        // The lock is not held while the pages are read, as the listening thread
+        // takes it to save the context of a pause packet
+        //
+        SpinlockUnlock(&g_KdMemoryCacheLock);
+
+        if (!KdMemoryCacheFillPages(ReadMem, MissingPages, FilledPages))
+        {
+            Result = FALSE;
+            goto FreePages;
+        }
+
+        SpinlockLock(&g_KdMemoryCacheLock);
+
+        //
+        // If the cache is invalidated while the pages were read (e.g., the debuggee
+        // is continued by another thread), the request is sent as it is
+        //
+        if (g_KdMemoryCacheGeneration != Generation)
+        {
+            SendRequest = TRUE;
+            goto Exit;
+        }
+
+        g_KdMemoryCacheNextSequentialPage = KdMemoryCacheGetKey(ReadMem, MissingPages.back() + PAGE_SIZE);
+
+        for (PDEBUGGER_READ_MEMORY FilledPage : FilledPages)
+        {
+            if (FilledPage->KernelStatus != DEBUGGER_OPERATION_WAS_SUCCESSFUL)
+            {
+                //
+                // The whole request fails if one of its pages is not valid (the
+                // read ahead pages are just ignored)
+                //
+                if (FilledPage->Address <= LastPage)
+                {
+                    ReadMem->KernelStatus = FilledPage->KernelStatus;
+                    ReadMem->ReturnLength = 0;
+                    goto Exit;
+                }
+
+                continue;
+            }
+
+            CachedPage = &g_KdMemoryCache[KdMemoryCacheGetKey(ReadMem, FilledPage->Address)];
+
+            CachedPage->HasAddressMode = FilledPage->GetAddressMode;
+            CachedPage->AddressMode    = FilledPage->AddressMode;
+            memcpy(CachedPage->Buffer, (BYTE *)FilledPage + sizeof(DEBUGGER_READ_MEMORY), PAGE_SIZE);
+        }
+    }
+
+    //
+    // Copy the requested bytes from the pages
+    //
+    for (UINT32 i = 0; i < NumberOfPages; i++)
+    {
+        Page          = FirstPage + (UINT64)i * PAGE_SIZE;
+        auto Iterator = g_KdMemoryCache.find(KdMemoryCacheGetKey(ReadMem, Page));
+
+        //
+        // The page might be removed by another thread while the lock was not held
+        //
+        if (Iterator == g_KdMemoryCache.end())
+        {
+            SendRequest = TRUE;
+            goto Exit;
+        }
+
+        CachedPage = &Iterator->second;
+        Offset     = i == 0 ? ReadMem->Address - FirstPage : 0;
+        CopySize   = PAGE_SIZE - (UINT32)Offset;
+
+        if (CopySize > ReadMem->Size - CopiedSize)
+        {
+            CopySize = ReadMem->Size - CopiedSize;
+        }
+
+        memcpy((BYTE *)ReadMem + sizeof(DEBUGGER_READ_MEMORY) + CopiedSize, CachedPage->Buffer + Offset, CopySize);
+
+        if (i == 0)
+        {
+            ReadMem->AddressMode = CachedPage->AddressMode;
+        }
+
+        CopiedSize += CopySize;
+    }
+
+    ReadMem->ReturnLength = CopiedSize;
+    ReadMem->KernelStatus = DEBUGGER_OPERATION_WAS_SUCCESSFUL;
+
+Exit:
+
+    SpinlockUnlock(&g_KdMemoryCacheLock);
+
+    if (SendRequest)
+    {
+        Result = KdSendReadMemoryPacketToDebuggee(ReadMem, RequestSize);
+    }
+
+FreePages:
+
+    for (PDEBUGGER_READ_MEMORY FilledPage : FilledPages)
+    {
+        free(FilledPage);
+    }
+
+    return Result;
+}
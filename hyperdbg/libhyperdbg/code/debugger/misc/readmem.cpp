@@ -93,9 +93,9 @@ HyperDbgReadMemory(UINT64                              TargetAddress,
     if (g_IsSerialConnectedToRemoteDebuggee)
     {
         //
-        // It's on Debugger mode
+        // It's on Debugger mode, the pages are cached while the debuggee is halted
         //
-        if (!KdSendReadMemoryPacketToDebuggee(MemReadRequest, SizeOfTargetBuffer))
+        if (!KdMemoryCacheReadMemory(MemReadRequest, SizeOfTargetBuffer))
         {
             std::free(MemReadRequest);
             return FALSE;
@@ -20,6 +20,7 @@
 //
 extern UINT64 * g_ScriptGlobalVariables;
 extern UINT64 * g_ScriptStackBuffer;
+extern UINT32   g_ScriptStackBufferSize;
 extern UINT64   g_CurrentExprEvalResult;
 extern BOOLEAN  g_CurrentExprEvalResultHasError;
 extern UINT64 * g_HwdbgPinsStatus;
@@ -317,6 +318,7 @@ ScriptEngineEvalWrapper(PGUEST_REGS GuestRegs,
                         string      Expr)
 {
     SCRIPT_ENGINE_GENERAL_REGISTERS ScriptGeneralRegisters = {0};
+    UINT32                          StackSize;
 
     //
     // Allocate global variables holder
@@ -335,29 +337,51 @@ ScriptEngineEvalWrapper(PGUEST_REGS GuestRegs,
         RtlZeroMemory(g_ScriptGlobalVariables, MAX_VAR_COUNT * sizeof(UINT64));
     }
 
+    //
+    // Run Parser
+    //
+    PSYMBOL_BUFFER CodeBuffer = (PSYMBOL_BUFFER)ScriptEngineParse((char *)Expr.c_str());
+
+    //
+    // The stack is sized from the footprint of the script (the same as the actions
+    // in the kernel), one extra slot is needed as the stack index points to the next
+    // free slot
+    //
+    if (CodeBuffer->StackFootprint >= MAX_STACK_BUFFER_COUNT)
+    {
+        StackSize = CodeBuffer->StackFootprint + 1;
+    }
+    else
+    {
+        StackSize = MAX_STACK_BUFFER_COUNT;
+    }
+
     //
     // Allocate stack buffer holder, actually in reality each core should
     // have its own set of stack buffer but as we never run multi-core scripts
     // in user-mode, thus, it's okay to just have one buffer for stack buffer
     //
-    if (!g_ScriptStackBuffer)
+    if (!g_ScriptStackBuffer || g_ScriptStackBufferSize < StackSize)
     {
-        g_ScriptStackBuffer = (UINT64 *)malloc(MAX_STACK_BUFFER_COUNT * sizeof(UINT64));
+        free(g_ScriptStackBuffer);
+
+        g_ScriptStackBufferSize = 0;
+        g_ScriptStackBuffer     = (UINT64 *)malloc(StackSize * sizeof(UINT64));
 
         if (g_ScriptStackBuffer == NULL)
         {
-            free(g_ScriptGlobalVariables);
-
             ShowMessages("err, could not allocate memory for user-mode stack buffer");
 
+            g_CurrentExprEvalResultHasError = TRUE;
+            g_CurrentExprEvalResult         = NULL;
+
+            RemoveSymbolBuffer(CodeBuffer);
+
             return;
         }
-    }
 
-    //
-    // Run Parser
-    //
-    PSYMBOL_BUFFER CodeBuffer = (PSYMBOL_BUFFER)ScriptEngineParse((char *)Expr.c_str());
+        g_ScriptStackBufferSize = StackSize;
+    }
 
 #ifdef _SCRIPT_ENGINE_IR_PRINT_EN
     //
@@ -373,7 +397,7 @@ ScriptEngineEvalWrapper(PGUEST_REGS GuestRegs,
 
     ScriptGeneralRegisters.StackBuffer         = g_ScriptStackBuffer;
     ScriptGeneralRegisters.GlobalVariablesList = g_ScriptGlobalVariables;
-    RtlZeroMemory(g_ScriptStackBuffer, MAX_STACK_BUFFER_COUNT * sizeof(UINT64));
+    RtlZeroMemory(g_ScriptStackBuffer, StackSize * sizeof(UINT64));
 
     if (CodeBuffer->Message == NULL)
     {
@@ -427,7 +451,7 @@ ScriptEngineEvalWrapper(PGUEST_REGS GuestRegs,
                 g_CurrentExprEvalResult         = NULL;
                 break;
             }
-            else if (ScriptGeneralRegisters.StackIndx >= MAX_STACK_BUFFER_COUNT)
+            else if (ScriptGeneralRegisters.StackIndx >= StackSize)
             {
                 ShowMessages("err, stack buffer overflow (more information: https://docs.hyperdbg.org/tips-and-tricks/misc/customize-build/change-script-engine-limitations)\n");
                 g_CurrentExprEvalResultHasError = TRUE;
@@ -743,19 +767,26 @@ ScriptEngineWrapperTestParserForHwdbg(const string & Expr)
  * @brief In the local debugging (VMI mode) environment, this function computes the expressions
  * @details for example, if the user u ExAllocatePoolWithTag+0x10 this will evaluate the expr
  * @param Expr
+ * @param GuestRegs Registers of the script (if null, all of the registers are zero)
  * @param HasError
  *
  * @return UINT64
  */
 UINT64
-ScriptEngineEvalUInt64StyleExpressionWrapper(const string & Expr, PBOOLEAN HasError)
+ScriptEngineEvalUInt64StyleExpressionWrapper(const string & Expr, PGUEST_REGS GuestRegs, PBOOLEAN HasError)
 {
     //
     // In VMI-mode we'll form all registers as zero
     //
-    GUEST_REGS GuestRegs = {0};
+    GUEST_REGS ZeroGuestRegs = {0};
 
-    ScriptEngineEvalWrapper(&GuestRegs, Expr);
+    //
+    // The result is only set by the 'formats' function of the script
+    //
+    g_CurrentExprEvalResult         = NULL;
+    g_CurrentExprEvalResultHasError = TRUE;
+
+    ScriptEngineEvalWrapper(GuestRegs != NULL ? GuestRegs : &ZeroGuestRegs, Expr);
 
     //
     // Set the results and return the value
@@ -764,6 +795,65 @@ ScriptEngineEvalUInt64StyleExpressionWrapper(const string & Expr, PBOOLEAN HasEr
     return g_CurrentExprEvalResult;
 }
 
+/**
+ * @brief Evaluate the predicates that are lowered from the condition of a script
+ * @details The same predicates are sent to the kernel (if the script is the only
+ * action of the event) and evaluated there instead of running the script
+ * @param Expr
+ * @param GuestRegs Registers of the script (if null, all of the registers are zero)
+ * @param IsLowered Whether the condition of the script is lowered or not
+ * @param HasError
+ *
+ * @return BOOLEAN TRUE if all of the predicates are met
+ */
+BOOLEAN
+ScriptEngineEvalConditionPredicatesWrapper(const string & Expr, PGUEST_REGS GuestRegs, PBOOLEAN IsLowered, PBOOLEAN HasError)
+{
+    GUEST_REGS                          ZeroGuestRegs                               = {0};
+    ACTION_BUFFER                       ActionBuffer                                = {0};
+    DEBUGGER_SCRIPT_CONDITION_PREDICATE Predicates[MAX_SCRIPT_CONDITION_PREDICATES] = {0};
+    UINT32                              NumberOfPredicates;
+
+    *IsLowered = FALSE;
+
+    //
+    // Run Parser
+    //
+    PSYMBOL_BUFFER CodeBuffer = (PSYMBOL_BUFFER)ScriptEngineParse((char *)Expr.c_str());
+
+    if (CodeBuffer->Message != NULL)
+    {
+        ShowMessages("%s\n", CodeBuffer->Message);
+
+        *HasError = TRUE;
+
+        RemoveSymbolBuffer(CodeBuffer);
+
+        return FALSE;
+    }
+
+    *HasError = FALSE;
+
+    NumberOfPredicates = ScriptEngineLowerConditionPredicates(CodeBuffer, Predicates);
+
+    RemoveSymbolBuffer(CodeBuffer);
+
+    if (NumberOfPredicates == 0)
+    {
+        return FALSE;
+    }
+
+    *IsLowered = TRUE;
+
+    //
+    // There is no action in user-mode, thus the action buffer is empty
+    //
+    return ScriptEngineEvaluateConditionPredicates(GuestRegs != NULL ? GuestRegs : &ZeroGuestRegs,
+                                                   &ActionBuffer,
+                                                   Predicates,
+                                                   NumberOfPredicates);
+}
+
 /**
  * @brief wrapper for getting head
  * @param SymbolBuffer
@@ -802,6 +892,33 @@ ScriptEngineWrapperGetPointer(PVOID SymbolBuffer)
     return (UINT32)((PSYMBOL_BUFFER)SymbolBuffer)->Pointer;
 }
 
+/**
+ * @brief wrapper for getting the stack footprint of the script
+ * @details zero means that the footprint is not known at compile time
+ * @param SymbolBuffer
+ *
+ * @return UINT32
+ */
+UINT32
+ScriptEngineWrapperGetStackFootprint(PVOID SymbolBuffer)
+{
+    return (UINT32)((PSYMBOL_BUFFER)SymbolBuffer)->StackFootprint;
+}
+
+/**
+ * @brief wrapper for lowering the condition of the script into predicates
+ * @details zero means that the condition can't be lowered
+ * @param SymbolBuffer
+ * @param Predicates
+ *
+ * @return UINT32
+ */
+UINT32
+ScriptEngineWrapperLowerConditionPredicates(PVOID SymbolBuffer, PDEBUGGER_SCRIPT_CONDITION_PREDICATE Predicates)
+{
+    return ScriptEngineLowerConditionPredicates(SymbolBuffer, Predicates);
+}
+
 /**
  * @brief wrapper for removing symbol buffer
  * @param SymbolBuffer
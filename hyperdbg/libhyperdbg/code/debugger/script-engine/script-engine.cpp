@@ -113,7 +113,7 @@ ScriptEngineEvalSingleExpression(string Expr, PBOOLEAN HasError)
         // It's in vmi-mode,
         // execute it locally with regs set to ZERO
         //
-        Result = ScriptEngineEvalUInt64StyleExpressionWrapper(Expr, HasError);
+        Result = ScriptEngineEvalUInt64StyleExpressionWrapper(Expr, NULL, HasError);
     }
 
     //
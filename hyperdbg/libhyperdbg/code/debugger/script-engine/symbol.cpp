@@ -776,16 +776,6 @@ SymbolBuildSymbolTable(PMODULE_SYMBOL_DETAIL * BufferToStoreDetails,
             {
                 ModuleSymDetailArray[i].IsSymbolDetailsFound = FALSE;
             }
-
-            //
-            // Check if it should be send to the remote debugger over serial
-            // and also make sure that we're connected to the remote debugger
-            // and this is a debuggee
-            //
-            if (SendOverSerial)
-            {
-                KdSendSymbolDetailPacket(&ModuleSymDetailArray[i], i, ModuleInfo->NumberOfModules + ModulesCount);
-            }
         }
     }
 
@@ -867,22 +857,22 @@ SymbolBuildSymbolTable(PMODULE_SYMBOL_DETAIL * BufferToStoreDetails,
         {
             ModuleSymDetailArray[IndexInSymbolBuffer].IsSymbolDetailsFound = FALSE;
         }
-
-        //
-        // Check if it should be send to the remote debugger over serial
-        // and also make sure that we're connected to the remote debugger
-        // and this is a debuggee
-        //
-        if (SendOverSerial)
-        {
-            KdSendSymbolDetailPacket(&ModuleSymDetailArray[IndexInSymbolBuffer], i, ModuleInfo->NumberOfModules + ModulesCount);
-        }
     }
 
     //
     // ----------------------------------------------------------------------------------
     //
 
+    //
+    // Check if it should be send to the remote debugger over serial
+    // and also make sure that we're connected to the remote debugger
+    // and this is a debuggee
+    //
+    if (SendOverSerial)
+    {
+        SymbolSendSymbolDetailsInBatches(ModuleSymDetailArray, ModuleInfo->NumberOfModules + ModulesCount);
+    }
+
     //
     // Store the buffer and length of module symbols details
     //
@@ -966,6 +956,321 @@ SymbolBuildAndUpdateSymbolTable(PMODULE_SYMBOL_DETAIL SymbolDetail)
     return TRUE;
 }
 
+/**
+ * @brief Split a path into the directory (with the last separator) and
+ * the file name
+ *
+ * @param Path
+ * @param Directory
+ * @param Name
+ *
+ * @return VOID
+ */
+static VOID
+SymbolSplitPath(const char * Path, std::string & Directory, std::string & Name)
+{
+    std::string PathString(Path, strnlen(Path, MAX_PATH));
+    size_t      Separator = PathString.find_last_of("\\/");
+
+    if (Separator == std::string::npos)
+    {
+        Directory.clear();
+        Name = std::move(PathString);
+    }
+    else
+    {
+        Directory = PathString.substr(0, Separator + 1);
+        Name      = PathString.substr(Separator + 1);
+    }
+}
+
+/**
+ * @brief Add a string to the strings of a batch of symbol details
+ * @details Each string is added once in each batch
+ *
+ * @param Offsets The offsets of the strings that are already added
+ * @param Strings The strings of the batch
+ * @param String
+ *
+ * @return UINT16 Offset of the string
+ */
+static UINT16
+SymbolAddStringToBatch(std::map<std::string, UINT16> & Offsets, std::vector<CHAR> & Strings, const std::string & String)
+{
+    UINT16 Offset;
+
+    //
+    // The first byte is the empty string
+    //
+    if (String.empty())
+    {
+        return 0;
+    }
+
+    auto Found = Offsets.find(String);
+
+    if (Found != Offsets.end())
+    {
+        return Found->second;
+    }
+
+    Offset = (UINT16)Strings.size();
+
+    Strings.insert(Strings.end(), String.begin(), String.end());
+    Strings.push_back('\0');
+
+    Offsets.emplace(String, Offset);
+
+    return Offset;
+}
+
+/**
+ * @brief Send a batch of symbol details to the debugger
+ *
+ * @param Entries
+ * @param Strings
+ * @param FirstSymbolIndex
+ * @param TotalSymbols
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+SymbolSendSymbolDetailBatch(std::vector<MODULE_SYMBOL_DETAIL_BATCH_ENTRY> & Entries,
+                            std::vector<CHAR> &                             Strings,
+                            UINT32                                          FirstSymbolIndex,
+                            UINT32                                          TotalSymbols)
+{
+    DEBUGGER_UPDATE_SYMBOL_TABLE_BATCH Batch       = {0};
+    UINT32                             EntriesSize = (UINT32)(Entries.size() * sizeof(MODULE_SYMBOL_DETAIL_BATCH_ENTRY));
+    std::vector<UINT8>                 PacketBuffer;
+
+    PacketBuffer.resize(sizeof(DEBUGGER_UPDATE_SYMBOL_TABLE_BATCH) + EntriesSize + Strings.size());
+
+    Batch.TotalSymbols     = TotalSymbols;
+    Batch.FirstSymbolIndex = FirstSymbolIndex;
+    Batch.NumberOfSymbols  = (UINT32)Entries.size();
+    Batch.StringsLength    = (UINT32)Strings.size();
+
+    memcpy(PacketBuffer.data(), &Batch, sizeof(DEBUGGER_UPDATE_SYMBOL_TABLE_BATCH));
+    memcpy(PacketBuffer.data() + sizeof(DEBUGGER_UPDATE_SYMBOL_TABLE_BATCH), Entries.data(), EntriesSize);
+    memcpy(PacketBuffer.data() + sizeof(DEBUGGER_UPDATE_SYMBOL_TABLE_BATCH) + EntriesSize, Strings.data(), Strings.size());
+
+    return KdSendSymbolDetailBatchPacket((PDEBUGGER_UPDATE_SYMBOL_TABLE_BATCH)PacketBuffer.data(), (UINT32)PacketBuffer.size());
+}
+
+/**
+ * @brief Send the details of the modules to the debugger in batches
+ * @details Many modules are packed into each packet instead of sending
+ * one packet per module, and the directories of the paths (which are
+ * mostly the same) are sent once in each batch
+ *
+ * @param Details
+ * @param NumberOfDetails
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+SymbolSendSymbolDetailsInBatches(PMODULE_SYMBOL_DETAIL Details, UINT32 NumberOfDetails)
+{
+    std::vector<MODULE_SYMBOL_DETAIL_BATCH_ENTRY> Entries;
+    std::vector<CHAR>                             Strings(1, '\0');
+    std::map<std::string, UINT16>                 Offsets;
+    std::string                                   FileDirectory, FileName, SymbolDirectory, SymbolName, GuidAndAge;
+    MODULE_SYMBOL_DETAIL_BATCH_ENTRY              Entry;
+    UINT32                                        FirstSymbolIndex = 0;
+    SIZE_T                                        MaximumNewStringsLength;
+
+    for (UINT32 i = 0; i < NumberOfDetails; i++)
+    {
+        SymbolSplitPath(Details[i].FilePath, FileDirectory, FileName);
+        SymbolSplitPath(Details[i].ModuleSymbolPath, SymbolDirectory, SymbolName);
+
+        GuidAndAge.assign(Details[i].ModuleSymbolGuidAndAge,
+                          strnlen(Details[i].ModuleSymbolGuidAndAge, MAXIMUM_GUID_AND_AGE_SIZE));
+
+        //
+        // Send the current batch if this module might not fit in it
+        //
+        MaximumNewStringsLength = FileDirectory.size() + FileName.size() + SymbolDirectory.size() +
+                                  SymbolName.size() + GuidAndAge.size() + 5;
+
+        if (!Entries.empty() &&
+            sizeof(DEBUGGER_UPDATE_SYMBOL_TABLE_BATCH) + (Entries.size() + 1) * sizeof(MODULE_SYMBOL_DETAIL_BATCH_ENTRY) +
+                    Strings.size() + MaximumNewStringsLength >
+                MAXIMUM_SYMBOL_DETAIL_BATCH_SIZE)
+        {
+            if (!SymbolSendSymbolDetailBatch(Entries, Strings, FirstSymbolIndex, NumberOfDetails))
+            {
+                return FALSE;
+            }
+
+            Entries.clear();
+            Strings.assign(1, '\0');
+            Offsets.clear();
+
+            FirstSymbolIndex = i;
+        }
+
+        RtlZeroMemory(&Entry, sizeof(MODULE_SYMBOL_DETAIL_BATCH_ENTRY));
+
+        Entry.BaseAddress                     = Details[i].BaseAddress;
+        Entry.IsSymbolDetailsFound            = Details[i].IsSymbolDetailsFound;
+        Entry.IsLocalSymbolPath               = Details[i].IsLocalSymbolPath;
+        Entry.IsSymbolPDBAvaliable            = Details[i].IsSymbolPDBAvaliable;
+        Entry.IsUserMode                      = Details[i].IsUserMode;
+        Entry.Is32Bit                         = Details[i].Is32Bit;
+        Entry.FilePathDirectoryOffset         = SymbolAddStringToBatch(Offsets, Strings, FileDirectory);
+        Entry.FilePathNameOffset              = SymbolAddStringToBatch(Offsets, Strings, FileName);
+        Entry.ModuleSymbolPathDirectoryOffset = SymbolAddStringToBatch(Offsets, Strings, SymbolDirectory);
+        Entry.ModuleSymbolPathNameOffset      = SymbolAddStringToBatch(Offsets, Strings, SymbolName);
+        Entry.ModuleSymbolGuidAndAgeOffset    = SymbolAddStringToBatch(Offsets, Strings, GuidAndAge);
+
+        Entries.push_back(Entry);
+    }
+
+    if (!Entries.empty())
+    {
+        return SymbolSendSymbolDetailBatch(Entries, Strings, FirstSymbolIndex, NumberOfDetails);
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Build a string of a batch of symbol details from its parts
+ *
+ * @param Strings The strings of the batch
+ * @param StringsLength
+ * @param FirstOffset Offset of the first part (the directory)
+ * @param SecondOffset Offset of the second part (the file name)
+ * @param Buffer The buffer to store the string
+ * @param BufferSize
+ *
+ * @return BOOLEAN shows whether the string is valid or not
+ */
+static BOOLEAN
+SymbolGetStringFromBatch(const CHAR * Strings,
+                         UINT32       StringsLength,
+                         UINT16       FirstOffset,
+                         UINT16       SecondOffset,
+                         CHAR *       Buffer,
+                         UINT32       BufferSize)
+{
+    SIZE_T FirstLength;
+    SIZE_T SecondLength;
+
+    if (FirstOffset >= StringsLength || SecondOffset >= StringsLength)
+    {
+        return FALSE;
+    }
+
+    //
+    // The strings are null-terminated (the last byte is checked by the caller)
+    //
+    FirstLength  = strlen(&Strings[FirstOffset]);
+    SecondLength = strlen(&Strings[SecondOffset]);
+
+    if (FirstLength + SecondLength >= BufferSize)
+    {
+        return FALSE;
+    }
+
+    memcpy(Buffer, &Strings[FirstOffset], FirstLength);
+    memcpy(Buffer + FirstLength, &Strings[SecondOffset], SecondLength);
+
+    Buffer[FirstLength + SecondLength] = '\0';
+
+    return TRUE;
+}
+
+/**
+ * @brief Add a batch of symbol details that is received from the debuggee
+ * to the symbol table in debugger mode
+ * @details The symbols are loaded (and the symbol map of the disassembler
+ * is built) once after all of the batches are received
+ *
+ * @param Batch
+ * @param Length Length of the batch (with the entries and the strings)
+ *
+ * @return BOOLEAN shows whether the operation was successful or not
+ */
+BOOLEAN
+SymbolUpdateSymbolTableFromBatch(PDEBUGGER_UPDATE_SYMBOL_TABLE_BATCH Batch, UINT32 Length)
+{
+    PMODULE_SYMBOL_DETAIL_BATCH_ENTRY Entries;
+    const CHAR *                      Strings;
+    MODULE_SYMBOL_DETAIL              SymbolDetail;
+
+    //
+    // Check the size of the batch
+    //
+    if (Length < sizeof(DEBUGGER_UPDATE_SYMBOL_TABLE_BATCH) ||
+        Batch->NumberOfSymbols > MAXIMUM_SUPPORTED_SYMBOLS ||
+        Batch->StringsLength == 0 ||
+        Batch->StringsLength > MAXIMUM_SYMBOL_DETAIL_BATCH_SIZE ||
+        Length != sizeof(DEBUGGER_UPDATE_SYMBOL_TABLE_BATCH) +
+                      Batch->NumberOfSymbols * sizeof(MODULE_SYMBOL_DETAIL_BATCH_ENTRY) +
+                      Batch->StringsLength)
+    {
+        ShowMessages("err, invalid batch of symbol details is received\n");
+        return FALSE;
+    }
+
+    Entries = (PMODULE_SYMBOL_DETAIL_BATCH_ENTRY)((UINT8 *)Batch + sizeof(DEBUGGER_UPDATE_SYMBOL_TABLE_BATCH));
+    Strings = (const CHAR *)&Entries[Batch->NumberOfSymbols];
+
+    if (Strings[Batch->StringsLength - 1] != '\0')
+    {
+        ShowMessages("err, invalid batch of symbol details is received\n");
+        return FALSE;
+    }
+
+    for (UINT32 i = 0; i < Batch->NumberOfSymbols; i++)
+    {
+        RtlZeroMemory(&SymbolDetail, sizeof(MODULE_SYMBOL_DETAIL));
+
+        SymbolDetail.BaseAddress          = Entries[i].BaseAddress;
+        SymbolDetail.IsSymbolDetailsFound = Entries[i].IsSymbolDetailsFound;
+        SymbolDetail.IsLocalSymbolPath    = Entries[i].IsLocalSymbolPath;
+        SymbolDetail.IsSymbolPDBAvaliable = Entries[i].IsSymbolPDBAvaliable;
+        SymbolDetail.IsUserMode           = Entries[i].IsUserMode;
+        SymbolDetail.Is32Bit              = Entries[i].Is32Bit;
+
+        //
+        // The GUID and age is not split, so its first part is the empty string
+        //
+        if (!SymbolGetStringFromBatch(Strings,
+                                      Batch->StringsLength,
+                                      Entries[i].FilePathDirectoryOffset,
+                                      Entries[i].FilePathNameOffset,
+                                      SymbolDetail.FilePath,
+                                      MAX_PATH) ||
+            !SymbolGetStringFromBatch(Strings,
+                                      Batch->StringsLength,
+                                      Entries[i].ModuleSymbolPathDirectoryOffset,
+                                      Entries[i].ModuleSymbolPathNameOffset,
+                                      SymbolDetail.ModuleSymbolPath,
+                                      MAX_PATH) ||
+            !SymbolGetStringFromBatch(Strings,
+                                      Batch->StringsLength,
+                                      0,
+                                      Entries[i].ModuleSymbolGuidAndAgeOffset,
+                                      SymbolDetail.ModuleSymbolGuidAndAge,
+                                      MAXIMUM_GUID_AND_AGE_SIZE))
+        {
+            ShowMessages("err, invalid batch of symbol details is received\n");
+            return FALSE;
+        }
+
+        if (!SymbolBuildAndUpdateSymbolTable(&SymbolDetail))
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
 /**
  * @brief Update the symbol table from remote debuggee in debugger mode
  * @param ProcessId
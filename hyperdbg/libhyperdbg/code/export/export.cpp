@@ -522,6 +522,21 @@ hyperdbg_u_connect_remote_debugger_using_named_pipe(const CHAR * named_pipe, BOO
     return HyperDbgDebugRemoteDeviceUsingNamedPipe(named_pipe, pause_after_connection);
 }
 
+/**
+ * @brief Connect to the remote debugger using TCP
+ *
+ * @param address The address of the server
+ * @param port The port of the server
+ * @param pause_after_connection Pause after connection
+ *
+ * @return BOOLEAN Returns true if it was successful
+ */
+BOOLEAN
+hyperdbg_u_connect_remote_debugger_using_tcp(const CHAR * address, const CHAR * port, BOOLEAN pause_after_connection)
+{
+    return HyperDbgDebugRemoteDeviceUsingTcp(address, port, pause_after_connection);
+}
+
 /**
  * @brief Close the remote debugger
  *
@@ -611,6 +626,38 @@ hyperdbg_u_assemble(const CHAR * assembly_code, UINT64 start_address, PVOID buff
     return HyperDbgAssemble(assembly_code, start_address, buffer_to_store_assembled_data, buffer_size);
 }
 
+/**
+ * @brief Evaluate a script locally (simulated)
+ *
+ * @param script The script (the result is the value that is passed to 'formats')
+ * @param regs The registers of the script (if null, all of the registers are zero)
+ * @param has_error Whether the evaluation has an error or not
+ *
+ * @return UINT64 The result of the script
+ */
+UINT64
+hyperdbg_u_eval_script_locally(const CHAR * script, GUEST_REGS * regs, BOOLEAN * has_error)
+{
+    return ScriptEngineEvalUInt64StyleExpressionWrapper(script, regs, has_error);
+}
+
+/**
+ * @brief Evaluate the predicates that are lowered from the condition of a
+ * script locally (simulated)
+ *
+ * @param script The script
+ * @param regs The registers of the script (if null, all of the registers are zero)
+ * @param is_lowered Whether the condition of the script is lowered or not
+ * @param has_error Whether the script has an error or not
+ *
+ * @return BOOLEAN TRUE if all of the predicates are met
+ */
+BOOLEAN
+hyperdbg_u_eval_script_condition_predicates_locally(const CHAR * script, GUEST_REGS * regs, BOOLEAN * is_lowered, BOOLEAN * has_error)
+{
+    return ScriptEngineEvalConditionPredicatesWrapper(script, regs, is_lowered, has_error);
+}
+
 /**
  * @brief Setip the path for the filename
  *
@@ -284,6 +284,9 @@ typedef std::map<std::string, COMMAND_DETAIL> CommandType;
 #define DEBUGGER_COMMAND_FLUSH_ATTRIBUTES \
     DEBUGGER_COMMAND_ATTRIBUTE_LOCAL_COMMAND_IN_DEBUGGER_MODE
 
+#define DEBUGGER_COMMAND_LOGBUFFER_ATTRIBUTES \
+    DEBUGGER_COMMAND_ATTRIBUTE_LOCAL_COMMAND_IN_DEBUGGER_MODE
+
 #define DEBUGGER_COMMAND_PAUSE_ATTRIBUTES \
     DEBUGGER_COMMAND_ATTRIBUTE_ABSOLUTE_LOCAL
 
@@ -307,6 +310,9 @@ typedef std::map<std::string, COMMAND_DETAIL> CommandType;
 #define DEBUGGER_COMMAND_LOGCLOSE_ATTRIBUTES \
     DEBUGGER_COMMAND_ATTRIBUTE_ABSOLUTE_LOCAL
 
+#define DEBUGGER_COMMAND_SESSION_ATTRIBUTES \
+    DEBUGGER_COMMAND_ATTRIBUTE_LOCAL_COMMAND_IN_DEBUGGER_MODE
+
 #define DEBUGGER_COMMAND_TEST_ATTRIBUTES DEBUGGER_COMMAND_ATTRIBUTE_LOCAL_COMMAND_IN_DEBUGGER_MODE
 
 #define DEBUGGER_COMMAND_CPU_ATTRIBUTES NULL
@@ -577,6 +583,9 @@ CommandLogopen(vector<CommandToken> CommandTokens, string Command);
 VOID
 CommandLogclose(vector<CommandToken> CommandTokens, string Command);
 
+VOID
+CommandSession(vector<CommandToken> CommandTokens, string Command);
+
 VOID
 CommandVa2pa(vector<CommandToken> CommandTokens, string Command);
 
@@ -613,6 +622,9 @@ CommandSettings(vector<CommandToken> CommandTokens, string Command);
 VOID
 CommandFlush(vector<CommandToken> CommandTokens, string Command);
 
+VOID
+CommandLogBuffer(vector<CommandToken> CommandTokens, string Command);
+
 VOID
 CommandPause(vector<CommandToken> CommandTokens, string Command);
 
@@ -20,24 +20,163 @@
 #define COM3_PORT 0x03E8
 #define COM4_PORT 0x02E8
 
+//////////////////////////////////////////
+//	     Remote Connection Constants       //
+//////////////////////////////////////////
+
+/**
+ * @brief Maximum number of debuggers that could be connected to
+ * one debuggee
+ * @details Each client and the listening socket need an event and
+ * the wait is limited to WSA_MAXIMUM_WAIT_EVENTS events
+ *
+ */
+#define REMOTE_CONNECTION_MAXIMUM_CLIENTS 16
+
+/**
+ * @brief Maximum size of the payload of a frame
+ *
+ */
+#define REMOTE_CONNECTION_MAXIMUM_FRAME_SIZE (64 * 1024)
+
+/**
+ * @brief The output is sent once this size of output is buffered
+ *
+ */
+#define REMOTE_CONNECTION_OUTPUT_COALESCING_SIZE (16 * 1024)
+
+/**
+ * @brief The buffered output (of the messages that are not the result of
+ * a command) is sent after this time (in milliseconds)
+ *
+ */
+#define REMOTE_CONNECTION_OUTPUT_FLUSH_INTERVAL 5
+
+/**
+ * @brief Size of the send and receive buffers of the sockets
+ *
+ */
+#define REMOTE_CONNECTION_SOCKET_BUFFER_SIZE (512 * 1024)
+
+/**
+ * @brief Maximum size of the frames that are buffered for one debugger
+ * @details A debugger that doesn't receive its frames is disconnected once
+ * this size is buffered, so a stalled debugger doesn't make the debuggee
+ * buffer the output without limit
+ *
+ */
+#define REMOTE_CONNECTION_MAXIMUM_PENDING_SIZE (32 * 1024 * 1024)
+
+/**
+ * @brief The ID of the end of the output that is sent to the debuggers
+ * that didn't send the command
+ *
+ */
+#define REMOTE_CONNECTION_ID_BROADCAST 0
+
+//////////////////////////////////////////
+//	     Remote Connection Structures      //
+//////////////////////////////////////////
+
+/**
+ * @brief Type of the frames of the remote connection
+ *
+ */
+typedef enum _REMOTE_CONNECTION_FRAME_TYPE
+{
+    REMOTE_CONNECTION_FRAME_TYPE_HANDSHAKE = 1,    // The build signature (debugger to debuggee)
+    REMOTE_CONNECTION_FRAME_TYPE_HANDSHAKE_RESULT, // "OK" or "NO" (debuggee to debugger)
+    REMOTE_CONNECTION_FRAME_TYPE_COMMAND,          // Command (debugger to debuggee)
+    REMOTE_CONNECTION_FRAME_TYPE_OUTPUT,           // Output of the debuggee (debuggee to debugger)
+    REMOTE_CONNECTION_FRAME_TYPE_END_OF_OUTPUT,    // The command is executed (debuggee to debugger)
+
+} REMOTE_CONNECTION_FRAME_TYPE;
+
+/**
+ * @brief The header of each frame of the remote connection
+ *
+ */
+typedef struct _REMOTE_CONNECTION_FRAME_HEADER
+{
+    UINT32 Type;   // REMOTE_CONNECTION_FRAME_TYPE
+    UINT32 Id;     // ID of the command (echoed in the end of its output)
+    UINT32 Length; // Length of the payload after the header
+
+} REMOTE_CONNECTION_FRAME_HEADER, *PREMOTE_CONNECTION_FRAME_HEADER;
+
+/**
+ * @brief A debugger that is connected to the debuggee
+ *
+ */
+typedef struct _REMOTE_CONNECTION_CLIENT
+{
+    SOCKET            Socket;
+    WSAEVENT          Event;
+    UINT64            Tag; // Unique number of the client
+    BOOLEAN           IsHandshakeDone;
+    BOOLEAN           IsClosing;     // Closed once the buffered frames are sent
+    BOOLEAN           IsStalled;     // Too many frames are buffered, closed without sending them
+    std::vector<CHAR> ReceiveBuffer; // Bytes of the frames that are not complete yet
+    std::vector<CHAR> SendBuffer;    // Frames that are not sent yet (protected by the lock of the server)
+    SIZE_T            SendOffset;    // Bytes of the send buffer that are already sent
+    CHAR              Address[INET_ADDRSTRLEN + 8];
+
+} REMOTE_CONNECTION_CLIENT, *PREMOTE_CONNECTION_CLIENT;
+
+/**
+ * @brief A command that is received from one of the debuggers
+ *
+ */
+typedef struct _REMOTE_CONNECTION_COMMAND
+{
+    UINT64            ClientTag;
+    UINT32            Id;
+    std::vector<CHAR> Command; // Null-terminated
+
+} REMOTE_CONNECTION_COMMAND, *PREMOTE_CONNECTION_COMMAND;
+
+/**
+ * @brief The state of the server in the debuggee
+ * @details The sockets are handled by one thread (an event loop) and the
+ * commands are executed by the thread of the '.listen' command
+ *
+ */
+typedef struct _REMOTE_CONNECTION_SERVER
+{
+    SOCKET                                ListenSocket;
+    WSAEVENT                              ListenEvent;
+    HANDLE                                WakeEvent;      // The event loop should check the buffered output or stop
+    HANDLE                                CommandEvent;   // A command is queued or the session is finished
+    HANDLE                                ConnectedEvent; // The first debugger is connected or the session is finished
+    HANDLE                                Thread;
+    volatile LONG                         Lock; // Protects the output, send buffers and commands
+    BOOLEAN                               IsStopping;
+    BOOLEAN                               IsFinished; // All of the debuggers are disconnected
+    UINT64                                NextClientTag;
+    UINT64                                CommandClientTag; // The debugger that sent the running command
+    UINT32                                CommandId;        // ID of the running command
+    std::list<REMOTE_CONNECTION_CLIENT>   Clients;
+    std::deque<REMOTE_CONNECTION_COMMAND> Commands;
+    std::vector<CHAR>                     Output;     // Output that is not framed yet
+    UINT64                                OutputTime; // Tick count of the first byte of the output that is not framed yet
+
+} REMOTE_CONNECTION_SERVER, *PREMOTE_CONNECTION_SERVER;
+
 //////////////////////////////////////////
 //			   	Server 		            //
 //////////////////////////////////////////
 
 int
-CommunicationServerCreateServerAndWaitForClient(PCSTR    Port,
-                                                SOCKET * ClientSocketArg,
-                                                SOCKET * ListenSocketArg);
+CommunicationServerCreateListeningSocket(PCSTR Port, SOCKET * ListenSocketArg);
 
 int
-CommunicationServerReceiveMessage(SOCKET ClientSocket, char * recvbuf, int recvbuflen);
+CommunicationServerAcceptClient(SOCKET ListenSocket, SOCKET * ClientSocketArg, CHAR * Address, UINT32 AddressLength);
 
 int
-CommunicationServerSendMessage(SOCKET ClientSocket, const char * sendbuf, int length);
+CommunicationServerCloseClient(SOCKET ClientSocket);
 
 int
-CommunicationServerShutdownAndCleanupConnection(SOCKET ClientSocket,
-                                                SOCKET ListenSocket);
+CommunicationServerCleanup(SOCKET ListenSocket);
 
 //////////////////////////////////////////
 //                Client                //
@@ -53,7 +192,7 @@ int
 CommunicationClientShutdownConnection(SOCKET ConnectSocket);
 
 int
-CommunicationClientReceiveMessage(SOCKET ConnectSocket, CHAR * RecvBuf, UINT32 MaxBuffLen, PUINT32 BuffLenRecvd);
+CommunicationClientReceiveMessage(SOCKET ConnectSocket, CHAR * RecvBuf, UINT32 BuffLen);
 
 int
 CommunicationClientCleanup(SOCKET ConnectSocket);
@@ -60,6 +60,8 @@
 #define DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_APIC_ACTIONS                        0x1c
 #define DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_PCIDEVINFO_RESULT                   0x1d
 #define DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_IDT_ENTRIES                         0x1e
+#define DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_PIPELINED_READ_MEMORY               0x1f
+#define DEBUGGER_SYNCRONIZATION_OBJECT_KERNEL_DEBUGGER_DUMP_MEMORY                         0x20
 
 //////////////////////////////////////////////////
 //               Event Details                  //
@@ -119,6 +121,20 @@ typedef struct _DEBUGGER_SYNCRONIZATION_EVENTS_STATE
 
 } DEBUGGER_SYNCRONIZATION_EVENTS_STATE, *PDEBUGGER_SYNCRONIZATION_EVENTS_STATE;
 
+/**
+ * @brief Holds the details of a group of events
+ * @details the index of the group in g_EventGroups is the group id
+ * that is used in the kernel
+ *
+ */
+typedef struct _DEBUGGER_EVENT_GROUP
+{
+    std::string         Name;       // Name of the group (empty if this group id is free)
+    BOOLEAN             IsDisabled; // Whether the group is disabled or not
+    std::vector<UINT64> Tags;       // Tags of the events that belong to this group
+
+} DEBUGGER_EVENT_GROUP, *PDEBUGGER_EVENT_GROUP;
+
 //////////////////////////////////////////////////
 //				    Functions                   //
 //////////////////////////////////////////////////
@@ -213,6 +229,11 @@ CommandEventsHandleModifiedEvent(
 VOID
 CommandEventsClearAllEventsAndResetTags();
 
+BOOLEAN
+CommandEventsModifyEventGroup(UINT64                      Tag,
+                              DEBUGGER_MODIFY_EVENTS_TYPE TypeOfAction,
+                              UINT32                      GroupId);
+
 VOID
 CommandFlushRequestFlush();
 
@@ -286,6 +307,9 @@ HyperDbgDebugRemoteDeviceUsingComPort(const CHAR * PortName, DWORD Baudrate, BOO
 BOOLEAN
 HyperDbgDebugRemoteDeviceUsingNamedPipe(const CHAR * NamedPipe, BOOLEAN PauseAfterConnection);
 
+BOOLEAN
+HyperDbgDebugRemoteDeviceUsingTcp(const CHAR * Address, const CHAR * Port, BOOLEAN PauseAfterConnection);
+
 BOOLEAN
 HyperDbgDebugCurrentDeviceUsingComPort(const CHAR * PortName, DWORD Baudrate);
 
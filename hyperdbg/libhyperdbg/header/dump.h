@@ -0,0 +1,73 @@
+/**
+ * @file dump.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief headers of streaming the dump of the debuggee
+ * @details
+ * @version 0.14
+ * @date 2025-06-28
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//		    	   Structures                   //
+//////////////////////////////////////////////////
+
+/**
+ * @brief A write of the dump file that is queued for the writer thread
+ *
+ */
+typedef struct _DUMP_STREAM_WRITE
+{
+    UINT64  Offset; // Offset in the dump file
+    UINT32  Length;
+    UINT8   Fill;   // The byte of the range if there is no buffer
+    UINT8 * Buffer; // Freed by the writer thread (NULL for the filled ranges)
+
+} DUMP_STREAM_WRITE, *PDUMP_STREAM_WRITE;
+
+/**
+ * @brief A range of the dump that is not received (lost or corrupted chunks)
+ *
+ */
+typedef struct _DUMP_STREAM_GAP
+{
+    UINT32 Offset;
+    UINT32 Length;
+
+} DUMP_STREAM_GAP, *PDUMP_STREAM_GAP;
+
+/**
+ * @brief The state of a streamed dump
+ * @details The chunks are decoded by the listening thread and the pages
+ * are written into the file by the writer thread
+ *
+ */
+typedef struct _DUMP_STREAM_STATE
+{
+    UINT64                        Address;
+    UINT32                        Length;
+    UINT32                        ExpectedOffset;           // Offset of the next chunk
+    UINT32                        NextChunkIndex;           // Index of the next chunk
+    UINT32                        NumberOfLostChunks;       // Chunks that are skipped in the stream
+    UINT32                        NumberOfDuplicatedChunks; // Chunks that are received again
+    UINT32                        InvalidLength;            // Length of the ranges that couldn't be read
+    UINT32                        FilledLength;             // Length of the ranges that are filled with one byte
+    COMPRESSION_STREAM *          Stream;
+    std::vector<DUMP_STREAM_GAP>  Gaps;
+    std::deque<DUMP_STREAM_WRITE> Writes; // Protected by WritesLock
+    volatile LONG                 WritesLock;
+    HANDLE                        WritesEvent;
+    BOOLEAN                       IsFinished; // No more writes are queued
+    BOOLEAN                       WriteFailed;
+
+} DUMP_STREAM_STATE, *PDUMP_STREAM_STATE;
+
+//////////////////////////////////////////////////
+//            	    Functions                   //
+//////////////////////////////////////////////////
+
+VOID
+CommandDumpHandleStreamedChunk(PDEBUGGEE_DUMP_MEMORY_CHUNK_PACKET Chunk, UINT32 ChunkLength);
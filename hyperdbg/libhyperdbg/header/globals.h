@@ -50,15 +50,6 @@ UINT32 g_InterpreterCountOfOpenCurlyBrackets = 0;
 //		 Remote and Local Connection            //
 //////////////////////////////////////////////////
 
-/**
- * @brief the buffer that we set at the end of buffers for tcp connection
- */
-BYTE g_EndOfBufferCheckTcp[TCP_END_OF_BUFFER_CHARS_COUNT] = {
-    TCP_END_OF_BUFFER_CHAR_1,
-    TCP_END_OF_BUFFER_CHAR_2,
-    TCP_END_OF_BUFFER_CHAR_3,
-    TCP_END_OF_BUFFER_CHAR_4};
-
 /**
  * @brief Shows whether the user is allowed to use 'load' command
  * to load modules locally in VMI (virtual machine introspection) mode
@@ -89,18 +80,25 @@ BOOLEAN g_IsConnectedToRemoteDebugger = FALSE;
 SOCKET g_ClientConnectSocket = {0};
 
 /**
- * @brief The socket object of guest debuggee (not debugger)
+ * @brief The state of the server in guest debuggee (not debugger)
  * it is because in HyperDbg, debugger is client and debuggee
- * is a server
+ * is a server (several debuggers could be connected to it)
+ *
+ */
+REMOTE_CONNECTION_SERVER g_RemoteConnectionServer;
+
+/**
+ * @brief ID of the last command that is sent to the remote debuggee
  *
  */
-SOCKET g_SeverSocket = {0};
+volatile LONG g_RemoteConnectionLastCommandId = 0;
 
 /**
- * @brief Server in debuggee needs an extra socket
+ * @brief Number of the commands that are sent to the remote debuggee
+ * and their output is not finished yet
  *
  */
-SOCKET g_ServerListenSocket = {0};
+volatile LONG g_RemoteConnectionPendingCommands = 0;
 
 /**
  * @brief In debugger (not debuggee), we save the port of server
@@ -136,13 +134,6 @@ HANDLE g_IsDriverLoadedSuccessfully = NULL;
  */
 HANDLE g_EndOfMessageReceivedEvent = NULL;
 
-/**
- * @brief variable to keep track if the end of the message received
- * (for showing signature)
- *
- */
-BOOLEAN g_IsEndOfMessageReceived = FALSE;
-
 /**
  * @brief In both debuggee and debugger we save the state of
  * the closed connection to avoid double close
@@ -217,11 +208,11 @@ BOOLEAN g_IsRunningInstruction32Bit = FALSE;
 HANDLE g_SerialListeningThreadHandle = NULL;
 
 /**
- * @brief In debugger (not debuggee), we save the handle
- * of the user-mode listening thread for remote system here
+ * @brief The transport (serial port, named pipe or socket) that the
+ * packets of the kernel debugger are sent and received through
  *
  */
-HANDLE g_SerialRemoteComPortHandle = NULL;
+TRANSPORT g_KdTransport = {0};
 
 /**
  * @brief Shows if the debugger was connected to
@@ -298,8 +289,6 @@ DEBUGGER_EVENT_AND_ACTION_RESULT g_DebuggeeResultOfAddingActionsToEvent = {
 OVERLAPPED g_OverlappedIoStructureForReadDebugger  = {0};
 OVERLAPPED g_OverlappedIoStructureForWriteDebugger = {0};
 
-OVERLAPPED g_OverlappedIoStructureForReadDebuggee = {0};
-
 /**
  * @brief Shows whether the queried event is enabled or disabled
  *
@@ -335,6 +324,12 @@ UINT64 * g_ScriptGlobalVariables;
  */
 UINT64 * g_ScriptStackBuffer;
 
+/**
+ * @brief Number of slots in the stack buffer for script engine
+ *
+ */
+UINT32 g_ScriptStackBufferSize;
+
 /**
  * @brief Is list of command initialized
  *
@@ -393,6 +388,22 @@ BOOLEAN g_EventTraceInitialized = FALSE;
  */
 LIST_ENTRY g_EventTrace = {0};
 
+/**
+ * @brief Holds the groups of events (indexed by the group id)
+ *
+ */
+DEBUGGER_EVENT_GROUP g_EventGroups[DEBUGGER_MAXIMUM_EVENT_GROUPS];
+
+/**
+ * @brief Holds a copy of the action buffers (including the compiled
+ * script buffers) of each event, indexed by the event tag
+ *
+ * @details these buffers are freed after registering the actions, so
+ * we keep a copy of them to be able to save the session (.session)
+ *
+ */
+std::map<UINT64, std::vector<std::vector<BYTE>>> g_SessionEventActions;
+
 /**
  * @brief it shows whether the debugger started using
  * output sources or not or in other words, is g_OutputSources
@@ -589,6 +600,172 @@ BOOLEAN g_AddressConversion = TRUE;
  */
 BOOLEAN g_AutoFlush = FALSE;
 
+/**
+ * @brief Whether the log rings are mapped into the debugger process or not
+ * @details it is disabled by default
+ *
+ */
+BOOLEAN g_UseSharedLogRings = FALSE;
+
+/**
+ * @brief Whether the debuggee is allowed to compress its messages or not
+ * @details it is enabled by default
+ *
+ */
+BOOLEAN g_CompressRemoteLogs = TRUE;
+
+/**
+ * @brief Whether the debugger accepted the compressed messages or not
+ * @details Only used in the debuggee, it's set at the time of connection
+ *
+ */
+BOOLEAN g_DebuggerAcceptsCompressedLogs = FALSE;
+
+/**
+ * @brief Whether the debugger accepted the framed packets or not
+ * @details Only used in the debuggee, it's set at the time of connection
+ *
+ */
+BOOLEAN g_DebuggerAcceptsFramedPackets = FALSE;
+
+/**
+ * @brief Whether the debugger accepted the context of the core along with
+ * the pause packet or not
+ * @details Only used in the debuggee, it's set at the time of connection
+ *
+ */
+BOOLEAN g_DebuggerAcceptsBreakContext = FALSE;
+
+/**
+ * @brief Number of the bytes at RIP that the debugger asked for
+ * @details Only used in the debuggee, it's set at the time of connection
+ *
+ */
+UINT32 g_DebuggerBreakContextCodeBytes = 0;
+
+/**
+ * @brief Number of the qwords at RSP that the debugger asked for
+ * @details Only used in the debuggee, it's set at the time of connection
+ *
+ */
+UINT32 g_DebuggerBreakContextStackQwords = 0;
+
+/**
+ * @brief Whether the debuggee is asked to send the context of the core
+ * (registers, the bytes at RIP and the qwords at RSP) along with the pause
+ * packet or not
+ * @details it is enabled by default, it's sent at the time of connection
+ *
+ */
+BOOLEAN g_KdSendBreakContext = TRUE;
+
+/**
+ * @brief Number of the bytes at RIP in the context of the core
+ *
+ */
+UINT32 g_KdBreakContextCodeBytes = DEBUGGEE_BREAK_CONTEXT_DEFAULT_CODE_BYTES;
+
+/**
+ * @brief Number of the qwords at RSP in the context of the core
+ *
+ */
+UINT32 g_KdBreakContextStackQwords = DEBUGGEE_BREAK_CONTEXT_DEFAULT_STACK_QWORDS;
+
+/**
+ * @brief Whether the packets of the kernel debugger are framed (length-prefixed)
+ * @details Both of the debugger and the debuggee switch to the framed packets
+ * after the "Start" packet
+ *
+ */
+BOOLEAN g_KdFramedPackets = FALSE;
+
+/**
+ * @brief The state of the framed connection of the kernel debugger
+ *
+ */
+FRAMING_TRANSPORT g_KdFramingTransport = {0};
+
+/**
+ * @brief The lock that serializes the frames that are sent by the commands
+ * with the NAKs (and the retransmissions) of the listening thread
+ *
+ */
+volatile LONG g_KdFramingSendLock = 0;
+
+/**
+ * @brief Keeps the last frame that is sent to the remote computer
+ * @details The frame is sent again if the remote computer sends a NAK
+ *
+ */
+UINT8 g_KdFramingRetransmissionBuffer[MaxSerialPacketSize + sizeof(FRAMING_HEADER)] = {0};
+
+/**
+ * @brief Maximum number of outstanding read memory requests
+ * @details One means waiting for each response before sending the next
+ * request, the serial port of a physical machine might drop the requests
+ * that are received while the debuggee is sending a response, so it's
+ * the default value
+ *
+ */
+UINT32 g_KdRequestWindowSize = 1;
+
+/**
+ * @brief The window of the pipelined read memory requests
+ *
+ */
+PIPELINE_WINDOW g_KdReadMemoryPipeline = {0};
+
+/**
+ * @brief The cached pages of the halted debuggee
+ *
+ */
+std::map<KD_MEMORY_CACHE_KEY, KD_MEMORY_CACHE_PAGE> g_KdMemoryCache;
+
+/**
+ * @brief The lock of the cached pages
+ *
+ */
+volatile LONG g_KdMemoryCacheLock = 0;
+
+/**
+ * @brief The generation of the memory of the debuggee, it's
+ * increased each time that the cache is invalidated
+ *
+ */
+volatile LONG g_KdMemoryCacheGeneration = 0;
+
+/**
+ * @brief The generation of the cached pages
+ *
+ */
+LONG g_KdMemoryCacheValidGeneration = 0;
+
+/**
+ * @brief The page after the last read of the cache (used for
+ * detecting the sequential reads)
+ *
+ */
+KD_MEMORY_CACHE_KEY g_KdMemoryCacheNextSequentialPage;
+
+/**
+ * @brief The context of the core that is received along with the
+ * last pause packet (protected by the lock of the cached pages)
+ *
+ */
+KD_MEMORY_CACHE_BREAK_CONTEXT g_KdMemoryCacheBreakContext;
+
+/**
+ * @brief The stream for decompressing the messages of the debuggee
+ *
+ */
+COMPRESSION_STREAM * g_RemoteLogsDecompressionStream = NULL;
+
+/**
+ * @brief The calibration of TSC for showing the time of kernel messages
+ *
+ */
+LIBHYPERDBG_TSC_CALIBRATION g_TscCalibration = {0};
+
 /**
  * @brief Shows the syntax used in !u !u2 u u2 commands
  * @details INTEL = 1, ATT = 2, MASM = 3
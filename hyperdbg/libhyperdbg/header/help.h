@@ -129,6 +129,9 @@ CommandLogopenHelp();
 VOID
 CommandLogcloseHelp();
 
+VOID
+CommandSessionHelp();
+
 VOID
 CommandVa2paHelp();
 
@@ -168,6 +171,9 @@ CommandSettingsHelp();
 VOID
 CommandFlushHelp();
 
+VOID
+CommandLogBufferHelp();
+
 VOID
 CommandPauseHelp();
 
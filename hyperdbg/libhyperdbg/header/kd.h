@@ -26,6 +26,18 @@
                                                                            \
     } while (FALSE);
 
+#define DbgWaitForKernelResponseWithTimeout(KernelSyncObjectId, Timeout)   \
+    do                                                                     \
+    {                                                                      \
+        DEBUGGER_SYNCRONIZATION_EVENTS_STATE * SyncronizationObject =      \
+            &g_KernelSyncronizationObjectsHandleTable[KernelSyncObjectId]; \
+                                                                           \
+        SyncronizationObject->IsOnWaitingState = TRUE;                     \
+        WaitForSingleObject(SyncronizationObject->EventHandle, Timeout);   \
+        SyncronizationObject->IsOnWaitingState = FALSE;                    \
+                                                                           \
+    } while (FALSE);
+
 #define DbgWaitSetRequestData(KernelSyncObjectId, ReqData, ReqSize)        \
     do                                                                     \
     {                                                                      \
@@ -60,6 +72,22 @@
         SetEvent(SyncronizationObject->EventHandle);                       \
     } while (FALSE);
 
+//////////////////////////////////////////////////
+//		    	   Structures                   //
+//////////////////////////////////////////////////
+
+/**
+ * @brief The buffers of the pipelined read memory requests
+ * @details The result of each request is saved in its own buffer
+ *
+ */
+typedef struct _KD_PIPELINED_READ_MEMORY
+{
+    PDEBUGGER_READ_MEMORY * Requests;     // Each buffer is a DEBUGGER_READ_MEMORY followed by the memory
+    UINT32 *                RequestSizes; // Size of each buffer
+
+} KD_PIPELINED_READ_MEMORY, *PKD_PIPELINED_READ_MEMORY;
+
 //////////////////////////////////////////////////
 //		    Display Windows Details             //
 //////////////////////////////////////////////////
@@ -104,8 +132,7 @@ KdCommandPacketAndBufferToDebuggee(
     UINT32                                  BufferLength);
 
 BOOLEAN
-KdPrepareSerialConnectionToRemoteSystem(HANDLE  SerialHandle,
-                                        BOOLEAN IsNamedPipe,
+KdPrepareSerialConnectionToRemoteSystem(BOOLEAN IsNamedPipe,
                                         BOOLEAN PauseAfterConnection);
 
 BOOLEAN
@@ -116,9 +143,20 @@ KdPrepareAndConnectDebugPort(const CHAR * PortName,
                              BOOLEAN      IsNamedPipe,
                              BOOLEAN      PauseAfterConnection);
 
+BOOLEAN
+KdPrepareAndConnectDebugSocket(const CHAR * Host,
+                               const CHAR * Port,
+                               BOOLEAN      PauseAfterConnection);
+
 BOOLEAN
 KdSendPacketToDebuggee(const CHAR * Buffer, UINT32 Length, BOOLEAN SendEndOfBuffer);
 
+BOOLEAN
+KdSendFrameToDebuggee(const CHAR * Packet, UINT32 PacketLength, const CHAR * Buffer, UINT32 BufferLength);
+
+VOID
+KdEnableFramedPackets();
+
 BOOLEAN
 KdReceivePacketFromDebuggee(CHAR * BufferToSave, UINT32 * LengthReceived);
 
@@ -140,6 +178,12 @@ KdSendEventQueryAndModifyPacketToDebuggee(
     DEBUGGER_MODIFY_EVENTS_TYPE TypeOfAction,
     BOOLEAN *                   IsEnabled);
 
+BOOLEAN
+KdSendEventGroupModificationPacketToDebuggee(
+    UINT64                      Tag,
+    DEBUGGER_MODIFY_EVENTS_TYPE TypeOfAction,
+    UINT32                      GroupId);
+
 BOOLEAN
 KdSendFlushPacketToDebuggee();
 
@@ -167,6 +211,17 @@ KdSendWriteRegisterPacketToDebuggee(PDEBUGGEE_REGISTER_WRITE_DESCRIPTION RegDes)
 BOOLEAN
 KdSendReadMemoryPacketToDebuggee(PDEBUGGER_READ_MEMORY ReadMem, UINT32 RequestSize);
 
+BOOLEAN
+KdSendPipelinedReadMemoryPacketsToDebuggee(PDEBUGGER_READ_MEMORY * Requests,
+                                           UINT32 *                RequestSizes,
+                                           UINT32                  NumberOfRequests);
+
+BOOLEAN
+KdCompletePipelinedReadMemory(PDEBUGGER_READ_MEMORY Result);
+
+BOOLEAN
+KdSendDumpMemoryPacketToDebuggee(PDEBUGGEE_DUMP_MEMORY_PACKET DumpPacket);
+
 BOOLEAN
 KdSendEditMemoryPacketToDebuggee(PDEBUGGER_EDIT_MEMORY EditMem, UINT32 Size);
 
@@ -262,10 +317,8 @@ KdUninitializeConnection();
 VOID
 KdSendUsermodePrints(CHAR * Input, UINT32 Length);
 
-VOID
-KdSendSymbolDetailPacket(PMODULE_SYMBOL_DETAIL SymbolDetailPacket,
-                         UINT32                CurrentSymbolInfoIndex,
-                         UINT32                TotalSymbols);
+BOOLEAN
+KdSendSymbolDetailBatchPacket(PDEBUGGER_UPDATE_SYMBOL_TABLE_BATCH Batch, UINT32 Length);
 
 VOID
 KdHandleUserInputInDebuggee(DEBUGGEE_USER_INPUT_PACKET * Descriptor);
@@ -11,6 +11,43 @@
  */
 #pragma once
 
+//////////////////////////////////////////////////
+//            	    Structures                  //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Local views of the log rings that are mapped into the debugger process
+ * @details The regular (and priority) rings of vmx non-root cores come first
+ * and then the rings of vmx-root cores
+ *
+ */
+typedef struct _LIBHYPERDBG_SHARED_LOG_RINGS
+{
+    BOOLEAN            IsMapped;
+    UINT32             NumberOfRings; // Number of regular (or priority) rings
+    RING_BUFFER *      Rings;
+    RING_BUFFER *      RingsPriority;
+    RING_FAIR_DRAINING Draining;         // The state of draining regular rings fairly
+    RING_FAIR_DRAINING DrainingPriority; // The state of draining priority rings fairly
+    UINT32 *           Deficits;         // Deficits of regular and priority rings
+
+} LIBHYPERDBG_SHARED_LOG_RINGS, *PLIBHYPERDBG_SHARED_LOG_RINGS;
+
+/**
+ * @brief The calibration of TSC against the wall-clock time
+ * @details Used for converting the time stamp of kernel messages (raw TSC)
+ * to the local time
+ *
+ */
+typedef struct _LIBHYPERDBG_TSC_CALIBRATION
+{
+    BOOLEAN IsCalibrated;
+    UINT64  BaseTsc;      // TSC at the time of calibration
+    UINT64  BaseFileTime; // Local time at the time of calibration (100-nanosecond intervals)
+    UINT64  TscFrequency; // Ticks per second
+
+} LIBHYPERDBG_TSC_CALIBRATION, *PLIBHYPERDBG_TSC_CALIBRATION;
+
 //////////////////////////////////////////////////
 //            	    Functions                   //
 //////////////////////////////////////////////////
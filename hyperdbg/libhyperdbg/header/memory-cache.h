@@ -0,0 +1,103 @@
+/**
+ * @file memory-cache.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief headers of the cache of the memory of the halted debuggee
+ * @details
+ * @version 0.14
+ * @date 2025-06-26
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//		            Definitions                 //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum number of pages that are kept in the cache
+ * @details The cache is emptied once it's full
+ *
+ */
+#define KD_MEMORY_CACHE_MAXIMUM_PAGES 1024
+
+/**
+ * @brief Maximum number of pages of a request that is served by the cache,
+ * larger requests are directly sent to the debuggee
+ *
+ */
+#define KD_MEMORY_CACHE_MAXIMUM_PAGES_PER_READ 16
+
+/**
+ * @brief Number of the next pages that are read when the memory is
+ * accessed sequentially
+ *
+ */
+#define KD_MEMORY_CACHE_READ_AHEAD_PAGES 4
+
+//////////////////////////////////////////////////
+//		    	   Structures                   //
+//////////////////////////////////////////////////
+
+/**
+ * @brief The key of a cached page (memory type, reading type, process id
+ * and the address of the page)
+ * @details The debuggee reads the virtual addresses from the layout of the
+ * current process, so the cache is invalidated once the process or the
+ * core is changed
+ *
+ */
+typedef std::tuple<UINT32, UINT32, UINT32, UINT64> KD_MEMORY_CACHE_KEY;
+
+/**
+ * @brief A cached page of the debuggee
+ *
+ */
+typedef struct _KD_MEMORY_CACHE_PAGE
+{
+    BOOLEAN                           HasAddressMode; // Whether the page is read with the address mode or not
+    DEBUGGER_READ_MEMORY_ADDRESS_MODE AddressMode;
+    BYTE                              Buffer[PAGE_SIZE];
+
+} KD_MEMORY_CACHE_PAGE, *PKD_MEMORY_CACHE_PAGE;
+
+/**
+ * @brief The context of the core that is received along with the pause packet
+ * @details It's valid until the cache is invalidated, the registers are also
+ * not valid once a register is changed
+ *
+ */
+typedef struct _KD_MEMORY_CACHE_BREAK_CONTEXT
+{
+    LONG                              Generation; // The generation of the memory that the context belongs to
+    BOOLEAN                           IsValid;
+    BOOLEAN                           HasRegisters;
+    GUEST_REGS                        Regs;
+    GUEST_EXTRA_REGISTERS             ExtraRegs;
+    UINT64                            CodeAddress;
+    DEBUGGER_READ_MEMORY_ADDRESS_MODE CodeAddressMode;
+    std::vector<BYTE>                 Code;
+    UINT64                            StackAddress;
+    std::vector<BYTE>                 Stack;
+
+} KD_MEMORY_CACHE_BREAK_CONTEXT, *PKD_MEMORY_CACHE_BREAK_CONTEXT;
+
+//////////////////////////////////////////////////
+//            	    Functions                   //
+//////////////////////////////////////////////////
+
+VOID
+KdMemoryCacheInvalidate();
+
+BOOLEAN
+KdMemoryCacheReadMemory(PDEBUGGER_READ_MEMORY ReadMem, UINT32 RequestSize);
+
+VOID
+KdMemoryCacheSaveBreakContext(PDEBUGGEE_KD_BREAK_CONTEXT Context, UINT32 Length);
+
+VOID
+KdMemoryCacheInvalidateRegisters();
+
+BOOLEAN
+KdMemoryCacheReadRegisters(GUEST_REGS * GuestRegisters, GUEST_EXTRA_REGISTERS * ExtraRegisters);
@@ -96,11 +96,20 @@ ScriptEngineWrapperGetSize(PVOID SymbolBuffer);
 UINT32
 ScriptEngineWrapperGetPointer(PVOID SymbolBuffer);
 
+UINT32
+ScriptEngineWrapperGetStackFootprint(PVOID SymbolBuffer);
+
+UINT32
+ScriptEngineWrapperLowerConditionPredicates(PVOID SymbolBuffer, PDEBUGGER_SCRIPT_CONDITION_PREDICATE Predicates);
+
 VOID
 ScriptEngineWrapperRemoveSymbolBuffer(PVOID SymbolBuffer);
 
 UINT64
-ScriptEngineEvalUInt64StyleExpressionWrapper(const string & Expr, PBOOLEAN HasError);
+ScriptEngineEvalUInt64StyleExpressionWrapper(const string & Expr, PGUEST_REGS GuestRegs, PBOOLEAN HasError);
+
+BOOLEAN
+ScriptEngineEvalConditionPredicatesWrapper(const string & Expr, PGUEST_REGS GuestRegs, PBOOLEAN IsLowered, PBOOLEAN HasError);
 
 //////////////////////////////////////////////////
 //          Script Engine Functions             //
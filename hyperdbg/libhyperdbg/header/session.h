@@ -0,0 +1,89 @@
+/**
+ * @file session.h
+ * @author Sina Karvandi (sina@hyperdbg.org)
+ * @brief Headers for saving and restoring the binary session of events
+ * @details
+ * @version 0.14
+ * @date 2025-06-04
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Constants                   //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Magic number of the session files ("HDSS")
+ *
+ */
+#define SESSION_FILE_MAGIC 0x53534448
+
+/**
+ * @brief Version of the session file format
+ * @details Should be increased whenever the layout of the records
+ * (or the layout of DEBUGGER_GENERAL_EVENT_DETAIL and DEBUGGER_GENERAL_ACTION)
+ * is changed
+ *
+ */
+#define SESSION_FILE_VERSION 4
+
+//////////////////////////////////////////////////
+//					Structures                  //
+//////////////////////////////////////////////////
+
+/**
+ * @brief The header of the session file
+ *
+ */
+typedef struct _SESSION_FILE_HEADER
+{
+    UINT32 Magic;
+    UINT32 Version;
+    UINT32 SizeOfEventDetail; // sizeof(DEBUGGER_GENERAL_EVENT_DETAIL) of the saver
+    UINT32 SizeOfAction;      // sizeof(DEBUGGER_GENERAL_ACTION) of the saver
+    UINT32 NumberOfEvents;
+    UINT64 KernelBaseAddress; // Base address of ntoskrnl.exe of the saver (identifies the boot, as it's randomized by KASLR)
+
+} SESSION_FILE_HEADER, *PSESSION_FILE_HEADER;
+
+/**
+ * @brief The header of each event record in the session file
+ * @details This structure is followed by the event buffer (event detail and
+ * its condition buffer), the null-terminated command string, the names of the
+ * output sources (each MAXIMUM_CHARACTERS_FOR_EVENT_FORWARDING_NAME bytes), and
+ * the actions (each one is a UINT32 length followed by the action buffer)
+ *
+ */
+typedef struct _SESSION_FILE_EVENT_RECORD
+{
+    UINT32 EventBufferLength;
+    UINT32 CommandStringLength;
+    UINT32 NumberOfOutputSources;
+    UINT32 NumberOfActions;
+
+} SESSION_FILE_EVENT_RECORD, *PSESSION_FILE_EVENT_RECORD;
+
+//////////////////////////////////////////////////
+//					Functions                   //
+//////////////////////////////////////////////////
+
+VOID
+SessionRecordEventActions(UINT64                   Tag,
+                          PDEBUGGER_GENERAL_ACTION ActionBreakToDebugger,
+                          UINT32                   ActionBreakToDebuggerLength,
+                          PDEBUGGER_GENERAL_ACTION ActionCustomCode,
+                          UINT32                   ActionCustomCodeLength,
+                          PDEBUGGER_GENERAL_ACTION ActionScript,
+                          UINT32                   ActionScriptLength);
+
+VOID
+SessionRemoveEventActions(UINT64 Tag);
+
+BOOLEAN
+SessionSaveToFile(const string & FilePath);
+
+BOOLEAN
+SessionLoadFromFile(const string & FilePath);
@@ -60,6 +60,12 @@ SymbolBuildSymbolTable(PMODULE_SYMBOL_DETAIL * BufferToStoreDetails,
 BOOLEAN
 SymbolBuildAndUpdateSymbolTable(PMODULE_SYMBOL_DETAIL SymbolDetail);
 
+BOOLEAN
+SymbolSendSymbolDetailsInBatches(PMODULE_SYMBOL_DETAIL Details, UINT32 NumberOfDetails);
+
+BOOLEAN
+SymbolUpdateSymbolTableFromBatch(PDEBUGGER_UPDATE_SYMBOL_TABLE_BATCH Batch, UINT32 Length);
+
 VOID
 SymbolInitialReload();
 
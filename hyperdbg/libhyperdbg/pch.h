@@ -95,8 +95,10 @@ typedef const wchar_t *LPCWCHAR, *PCWCHAR;
 #include <sstream>
 #include <fstream>
 #include <map>
+#include <tuple>
 #include <numeric>
 #include <list>
+#include <deque>
 #include <locale>
 #include <memory>
 #include <cctype>
@@ -135,6 +137,38 @@ typedef const wchar_t *LPCWCHAR, *PCWCHAR;
 //
 #include "../script-eval/header/ScriptEngineHeader.h"
 
+//
+// Ring component (used for reading the shared log rings)
+//
+#include "components/ring/header/Ring.h"
+
+//
+// Cross platform atomic operations and clock of the components
+//
+#include "platform/user/header/Atomic.h"
+#include "platform/user/header/Clock.h"
+
+//
+// Compression component (used for decompressing the messages of the debuggee)
+//
+#include "components/compression/header/Compression.h"
+
+//
+// Framing component (used for the length-prefixed packets of the kernel debugger)
+//
+#include "components/framing/header/Framing.h"
+
+//
+// Pipeline component (used for the pipelined requests of the kernel debugger)
+//
+#include "components/pipeline/header/Pipeline.h"
+
+//
+// Transport component (used for the serial ports, named pipes and sockets of the kernel debugger)
+//
+#include "components/transport/header/Transport.h"
+#include "components/transport/header/TransportBackends.h"
+
 //
 // Imports/Exports
 //
@@ -156,6 +190,7 @@ typedef const wchar_t *LPCWCHAR, *PCWCHAR;
 #include "header/common.h"
 #include "header/symbol.h"
 #include "header/debugger.h"
+#include "header/session.h"
 #include "header/script-engine.h"
 #include "header/help.h"
 #include "header/install.h"
@@ -166,6 +201,8 @@ typedef const wchar_t *LPCWCHAR, *PCWCHAR;
 #include "header/namedpipe.h"
 #include "header/forwarding.h"
 #include "header/kd.h"
+#include "header/memory-cache.h"
+#include "header/dump.h"
 #include "header/pe-parser.h"
 #include "header/ud.h"
 #include "header/objects.h"
@@ -582,6 +582,21 @@ ScriptEngineParse(char * str)
         //
         Symbol        = CodeBuffer->Head + 1;
         Symbol->Value = CurrentUserDefinedFunction->MaxTempNumber + CurrentUserDefinedFunction->LocalVariableNumber;
+
+        //
+        // record the stack footprint of the script, if there is no user-defined
+        // function, the script never pushes anything, so the stack only holds the
+        // temps and the local variables of the main body, otherwise the footprint
+        // depends on the depth of the calls and it's left unknown (zero)
+        //
+        if (UserDefinedFunctionHead->NextNode == NULL)
+        {
+            CodeBuffer->StackFootprint = (unsigned int)Symbol->Value;
+        }
+        else
+        {
+            CodeBuffer->StackFootprint = 0;
+        }
     }
     CodeBuffer->Message = ErrorMessage;
 
@@ -624,6 +639,185 @@ ScriptEngineParse(char * str)
     return (PVOID)CodeBuffer;
 }
 
+/**
+ * @brief Check whether the symbol is a simple operand for the predicates
+ * @details Simple operands are registers, pseudo-registers (except $buffer
+ * which needs the action) and numbers, evaluating them has no side effect
+ *
+ * @param Symbol
+ * @return BOOLEAN
+ */
+static BOOLEAN
+ScriptEngineIsConditionPredicateOperand(PSYMBOL Symbol)
+{
+    switch (Symbol->Type)
+    {
+    case SYMBOL_NUM_TYPE:
+    case SYMBOL_REGISTER_TYPE:
+        return TRUE;
+
+    case SYMBOL_PSEUDO_REG_TYPE:
+        return Symbol->Value != PSEUDO_REGISTER_BUFFER;
+
+    default:
+        return FALSE;
+    }
+}
+
+/**
+ * @brief Lower the condition of a compiled script into simple predicates
+ * @details The whole script should be in the form of 'if (CONDITION) { ... }'
+ * (without else), where the condition is a simple predicate (e.g., @rcx == X,
+ * @rdx & MASK, $pid == N) or a conjunction of the simple comparisons, thus,
+ * if the predicates are not met, the script performs nothing
+ *
+ * The compiled buffer should exactly be:
+ *
+ *     FUNC_ADD NUM(STACK_FOOTPRINT) STACK_INDEX STACK_INDEX
+ *     OPERATOR OPERAND0 OPERAND1 TEMP                          (one or more)
+ *     FUNC_JZ NUM(POINTER) TEMP(RESULT)
+ *     ...                                                      (the body)
+ *     FUNC_JMP NUM(POINTER)
+ *
+ * @param SymbolBuffer The buffer that is returned by ScriptEngineParse
+ * @param Predicates Array of MAX_SCRIPT_CONDITION_PREDICATES predicates
+ * to store the lowered condition
+ *
+ * @return UINT32 number of predicates, zero if the condition can't be lowered
+ */
+UINT32
+ScriptEngineLowerConditionPredicates(PVOID SymbolBuffer, PDEBUGGER_SCRIPT_CONDITION_PREDICATE Predicates)
+{
+    PSYMBOL_BUFFER CodeBuffer                                           = (PSYMBOL_BUFFER)SymbolBuffer;
+    PSYMBOL        Head                                                 = CodeBuffer->Head;
+    UINT64         Pointer                                              = CodeBuffer->Pointer;
+    UINT64         Index                                                = 4; // Skip the prologue
+    UINT32         NumberOfPredicates                                   = 0;
+    UINT32         NumberOfPendingTemps                                 = 0;
+    UINT64         PendingTemps[MAX_SCRIPT_CONDITION_PREDICATES]        = {0};
+    BOOLEAN        PendingTempsBoolean[MAX_SCRIPT_CONDITION_PREDICATES] = {0};
+
+    //
+    // The script should be compiled without error, and its stack footprint should be
+    // known (which means that there is no user-defined function)
+    //
+    if (CodeBuffer->Message != NULL || CodeBuffer->StackFootprint == 0 || Pointer < 4)
+    {
+        return 0;
+    }
+
+    //
+    // Check the prologue (adding the size of temps and local variables to the stack index)
+    //
+    if (Head[0].Type != SYMBOL_SEMANTIC_RULE_TYPE || Head[0].Value != FUNC_ADD ||
+        Head[1].Type != SYMBOL_NUM_TYPE || Head[1].Value != CodeBuffer->StackFootprint ||
+        Head[2].Type != SYMBOL_STACK_INDEX_TYPE || Head[3].Type != SYMBOL_STACK_INDEX_TYPE)
+    {
+        return 0;
+    }
+
+    //
+    // Each operator of the condition is in the form of 'OPERATOR Src0 Src1 Des'
+    //
+    while (Index + 3 < Pointer && Head[Index].Type == SYMBOL_SEMANTIC_RULE_TYPE && Head[Index].Value != FUNC_JZ)
+    {
+        PSYMBOL Operator = &Head[Index];
+        PSYMBOL Src0     = &Head[Index + 1];
+        PSYMBOL Src1     = &Head[Index + 2];
+        PSYMBOL Des      = &Head[Index + 3];
+
+        if (Des->Type != SYMBOL_TEMP_TYPE)
+        {
+            return 0;
+        }
+
+        switch (Operator->Value)
+        {
+        case FUNC_GT:
+        case FUNC_LT:
+        case FUNC_EGT:
+        case FUNC_ELT:
+        case FUNC_EQUAL:
+        case FUNC_NEQ:
+        case FUNC_AND:
+            break;
+
+        default:
+            return 0;
+        }
+
+        if (ScriptEngineIsConditionPredicateOperand(Src0) && ScriptEngineIsConditionPredicateOperand(Src1))
+        {
+            //
+            // A simple predicate
+            //
+            if (NumberOfPredicates == MAX_SCRIPT_CONDITION_PREDICATES)
+            {
+                return 0;
+            }
+
+            Predicates[NumberOfPredicates].Operator      = Operator->Value;
+            Predicates[NumberOfPredicates].Operand0Type  = Src0->Type;
+            Predicates[NumberOfPredicates].Operand0Value = Src0->Value;
+            Predicates[NumberOfPredicates].Operand1Type  = Src1->Type;
+            Predicates[NumberOfPredicates].Operand1Value = Src1->Value;
+            NumberOfPredicates++;
+
+            PendingTemps[NumberOfPendingTemps]        = Des->Value;
+            PendingTempsBoolean[NumberOfPendingTemps] = Operator->Value != FUNC_AND;
+            NumberOfPendingTemps++;
+        }
+        else if (Operator->Value == FUNC_AND &&
+                 Src0->Type == SYMBOL_TEMP_TYPE &&
+                 Src1->Type == SYMBOL_TEMP_TYPE &&
+                 NumberOfPendingTemps >= 2 &&
+                 PendingTempsBoolean[NumberOfPendingTemps - 1] &&
+                 PendingTempsBoolean[NumberOfPendingTemps - 2] &&
+                 ((Src0->Value == PendingTemps[NumberOfPendingTemps - 1] && Src1->Value == PendingTemps[NumberOfPendingTemps - 2]) ||
+                  (Src1->Value == PendingTemps[NumberOfPendingTemps - 1] && Src0->Value == PendingTemps[NumberOfPendingTemps - 2])))
+        {
+            //
+            // A conjunction of two boolean results (0 or 1), it's met only if both of them are met
+            //
+            NumberOfPendingTemps--;
+            PendingTemps[NumberOfPendingTemps - 1]        = Des->Value;
+            PendingTempsBoolean[NumberOfPendingTemps - 1] = TRUE;
+        }
+        else
+        {
+            return 0;
+        }
+
+        Index += 4;
+    }
+
+    //
+    // The condition should be followed by 'JZ END_OF_SCRIPT RESULT', which means that
+    // nothing is performed by the script if the condition is not met
+    //
+    if (NumberOfPredicates == 0 ||
+        NumberOfPendingTemps != 1 ||
+        Index + 3 > Pointer ||
+        Head[Index].Type != SYMBOL_SEMANTIC_RULE_TYPE || Head[Index].Value != FUNC_JZ ||
+        Head[Index + 1].Type != SYMBOL_NUM_TYPE || Head[Index + 1].Value != Pointer ||
+        Head[Index + 2].Type != SYMBOL_TEMP_TYPE || Head[Index + 2].Value != PendingTemps[0])
+    {
+        return 0;
+    }
+
+    //
+    // The body of the 'if' should be the last statement of the script ('JMP END_OF_SCRIPT')
+    //
+    if (Index + 5 > Pointer ||
+        Head[Pointer - 2].Type != SYMBOL_SEMANTIC_RULE_TYPE || Head[Pointer - 2].Value != FUNC_JMP ||
+        Head[Pointer - 1].Type != SYMBOL_NUM_TYPE || Head[Pointer - 1].Value != Pointer)
+    {
+        return 0;
+    }
+
+    return NumberOfPredicates;
+}
+
 /**
  * @brief Script Engine code generator
  *
@@ -2880,6 +3074,8 @@ NewSymbolBuffer(void)
     SymbolBuffer->Size    = SYMBOL_BUFFER_INIT_SIZE;
     SymbolBuffer->Head    = (PSYMBOL)malloc(SymbolBuffer->Size * sizeof(SYMBOL));
     SymbolBuffer->Message = NULL;
+
+    SymbolBuffer->StackFootprint = 0;
     return SymbolBuffer;
 }
 
@@ -2293,3 +2293,87 @@ ScriptEngineExecute(PGUEST_REGS                      GuestRegs,
     //
     return HasError;
 }
+
+/**
+ * @brief Evaluate the predicates that are lowered from the condition of a
+ * script (by ScriptEngineLowerConditionPredicates of the script engine)
+ * @details Operators have the same semantics as ScriptEngineExecute, thus,
+ * the result is the same as the condition of the original script
+ *
+ * @param GuestRegs General purpose registers
+ * @param ActionDetail Detail of the specific action (used for pseudo-registers)
+ * @param Predicates The lowered predicates
+ * @param NumberOfPredicates Number of predicates
+ * @return BOOLEAN TRUE if all of the predicates are met
+ */
+BOOLEAN
+ScriptEngineEvaluateConditionPredicates(PGUEST_REGS                          GuestRegs,
+                                        ACTION_BUFFER *                      ActionDetail,
+                                        PDEBUGGER_SCRIPT_CONDITION_PREDICATE Predicates,
+                                        UINT32                               NumberOfPredicates)
+{
+    SYMBOL  Operand = {0};
+    UINT64  SrcVal0;
+    UINT64  SrcVal1;
+    BOOLEAN Result;
+
+    for (UINT32 i = 0; i < NumberOfPredicates; i++)
+    {
+        //
+        // Operands are registers, pseudo-registers, or numbers, so the (script)
+        // general registers are not needed
+        //
+        Operand.Type  = Predicates[i].Operand0Type;
+        Operand.Value = Predicates[i].Operand0Value;
+        SrcVal0       = GetValue(GuestRegs, ActionDetail, NULL, &Operand, FALSE);
+
+        Operand.Type  = Predicates[i].Operand1Type;
+        Operand.Value = Predicates[i].Operand1Value;
+        SrcVal1       = GetValue(GuestRegs, ActionDetail, NULL, &Operand, FALSE);
+
+        switch (Predicates[i].Operator)
+        {
+        case FUNC_GT:
+            Result = (INT64)SrcVal1 > (INT64)SrcVal0;
+            break;
+
+        case FUNC_LT:
+            Result = (INT64)SrcVal1 < (INT64)SrcVal0;
+            break;
+
+        case FUNC_EGT:
+            Result = (INT64)SrcVal1 >= (INT64)SrcVal0;
+            break;
+
+        case FUNC_ELT:
+            Result = (INT64)SrcVal1 <= (INT64)SrcVal0;
+            break;
+
+        case FUNC_EQUAL:
+            Result = SrcVal1 == SrcVal0;
+            break;
+
+        case FUNC_NEQ:
+            Result = SrcVal1 != SrcVal0;
+            break;
+
+        case FUNC_AND:
+            Result = (SrcVal1 & SrcVal0) != 0;
+            break;
+
+        default:
+            //
+            // Not a lowered operator, the script should decide
+            //
+            Result = TRUE;
+            break;
+        }
+
+        if (!Result)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
@@ -39,6 +39,12 @@ ScriptEngineExecute(PGUEST_REGS                      GuestRegs,
                     UINT64 *                         Indx,
                     SYMBOL *                         ErrorOperator);
 
+BOOLEAN
+ScriptEngineEvaluateConditionPredicates(PGUEST_REGS                          GuestRegs,
+                                        ACTION_BUFFER *                      ActionDetail,
+                                        PDEBUGGER_SCRIPT_CONDITION_PREDICATE Predicates,
+                                        UINT32                               NumberOfPredicates);
+
 UINT64
 GetRegValue(PGUEST_REGS GuestRegs, REGS_ENUM RegId);
 